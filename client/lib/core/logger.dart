@@ -1,48 +1,97 @@
 import 'dart:developer' as developer;
 import 'package:flutter/foundation.dart';
 
+/// Log levels, lowest first. The values match SC_LOG_* in
+/// windows/runner/native/sc_native_api.h.
+class LogLevel {
+  static const int debug = 0;
+  static const int info = 1;
+  static const int warn = 2;
+  static const int error = 3;
+}
+
+/// Where formatted lines go besides the console, e.g. NativeLogSink, which
+/// writes them to a rotating file off the UI thread.
+abstract class LogSink {
+  /// Takes one line, "TAG: message - data", without a timestamp; the sink
+  /// adds its own.
+  void write(int level, String line);
+  void flush();
+  void close();
+}
+
 /// Lightweight app logger with level support and optional tagging.
-/// Uses debugPrint in debug/profile and developer.log in release.
+/// Uses debugPrint in debug/profile and developer.log in release, and also
+/// writes to [sink] when one is installed.
+///
+/// A call below [level] returns before anything is formatted. `data` may be
+/// a function returning the data, so that hot paths do not even build it:
+///
+///     _logger.d('chunk', () => {'offset': offset});
 class AppLogger {
   final String tag;
   const AppLogger(this.tag);
 
   static const bool enableInRelease = true; // set false to silence in release
 
-  void _emit(String level, String message, [Object? data, StackTrace? st]) {
-    final ts = DateTime.now().toIso8601String();
+  /// Lowest level that is logged.
+  static int level = kReleaseMode ? LogLevel.info : LogLevel.debug;
+
+  static LogSink? sink;
+
+  /// Whether calls at [at] are logged; lets callers skip work that only
+  /// feeds a log line.
+  static bool isEnabled(int at) => at >= level;
+
+  /// Flushes and closes [sink], for app exit.
+  static void closeSink() {
+    final current = sink;
+    sink = null;
+    current?.close();
+  }
+
+  void _emit(int at, String message, [Object? data, StackTrace? st]) {
+    if (at < level) return;
+    if (data is Object? Function()) data = data();
     final payload = data != null ? ' - $data' : '';
-    final line = '[$ts] $tag: $message$payload';
+    final line = '$tag: $message$payload';
+    final out = sink;
+    if (out != null) {
+      out.write(at, line);
+      if (st != null) out.write(at, '$tag: $st');
+    }
     if (kReleaseMode) {
-      if (enableInRelease) {
-        developer.log(line, name: tag, error: data, stackTrace: st, level: _levelToInt(level));
+      // The sink already has it, with a timestamp.
+      if (enableInRelease && out == null) {
+        developer.log(line, name: tag, error: data, stackTrace: st, level: _levelToInt(at));
       }
     } else {
-      debugPrint(line);
+      final ts = DateTime.now().toIso8601String();
+      debugPrint('[$ts] $line');
       if (st != null) {
         debugPrint(st.toString());
       }
     }
   }
 
-  int _levelToInt(String level) {
-    switch (level) {
-      case 'E':
+  int _levelToInt(int at) {
+    switch (at) {
+      case LogLevel.error:
         return 1000;
-      case 'W':
+      case LogLevel.warn:
         return 900;
-      case 'D':
+      case LogLevel.debug:
         return 500;
-      case 'I':
+      case LogLevel.info:
       default:
         return 800;
     }
   }
 
-  void i(String message, [Object? data]) => _emit('I', message, data);
-  void d(String message, [Object? data]) => _emit('D', message, data);
-  void w(String message, [Object? data]) => _emit('W', message, data);
-  void e(String message, [Object? data, StackTrace? st]) => _emit('E', message, data, st);
+  void i(String message, [Object? data]) => _emit(LogLevel.info, message, data);
+  void d(String message, [Object? data]) => _emit(LogLevel.debug, message, data);
+  void w(String message, [Object? data]) => _emit(LogLevel.warn, message, data);
+  void e(String message, [Object? data, StackTrace? st]) => _emit(LogLevel.error, message, data, st);
 }
 
 /// Convenience factory for tagged loggers
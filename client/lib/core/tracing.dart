@@ -0,0 +1,105 @@
+import 'dart:ffi';
+import 'dart:io' show pid;
+import 'dart:math';
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+
+/// Spans timing how long a share takes to set up, kept in sc::SpanTracer's
+/// lock-free ring (windows/runner/native/span_tracer.h) and exported as
+/// Chrome trace JSON for chrome://tracing or Perfetto.
+///
+/// One share is one trace. The requester makes its id and sends it with
+/// request-share; the server passes it on in share-request and the sharer
+/// in its offer, so the spans both devices and server.js record for it can
+/// be stitched together by args.trace.
+///
+///     final span = Tracing.start('webrtc.create-offer', traceId);
+///     ...
+///     span.end();
+///
+/// Without sc_native, or before [open], every call is a cheap no-op.
+class Tracing {
+  /// Longest span name kept; matches sc::SpanTracer::kMaxNameSize.
+  static const int maxNameBytes = 47;
+
+  static ScNative? _native;
+  static Pointer<ScTracer> _handle = nullptr;
+  static Pointer<Uint8> _name = nullptr;
+  static String? _exportPath;
+  static final Random _random = Random();
+
+  static bool get enabled => _handle != nullptr;
+
+  /// Starts keeping the last [capacity] spans (0 for the default), to be
+  /// written to [exportPath], if given, by [close].
+  static void open({String? exportPath, int capacity = 0}) {
+    if (_handle != nullptr) return;
+    _exportPath = exportPath;
+    final native = ScNative.instance;
+    if (native == null) return;
+    _native = native;
+    _handle = native.tracerCreate(capacity);
+    _name = calloc<Uint8>(maxNameBytes);
+  }
+
+  /// Nanoseconds on the tracer's monotonic clock, or 0 when disabled.
+  static int now() => _handle == nullptr ? 0 : _native!.tracerNowNs();
+
+  /// A new trace id: 16 hex digits.
+  static String newTraceId() {
+    final id = (_random.nextInt(1 << 31) << 32) | _random.nextInt(1 << 32);
+    return id.toRadixString(16).padLeft(16, '0');
+  }
+
+  static TraceSpan start(String name, [String? traceId]) => TraceSpan._(name, traceId, now());
+
+  /// Records [name] from [startNs] to [endNs] (now if null), both from
+  /// [now], in trace [traceId].
+  static void record(String name, String? traceId, int startNs, [int? endNs]) {
+    if (_handle == nullptr || startNs == 0) return;
+    final end = endNs ?? _native!.tracerNowNs();
+    final units = name.codeUnits;
+    final length = units.length < maxNameBytes ? units.length : maxNameBytes;
+    final bytes = _name.asTypedList(maxNameBytes);
+    for (var i = 0; i < length; i++) {
+      bytes[i] = units[i] & 0x7f;
+    }
+    final id = traceId == null ? 0 : (int.tryParse(traceId, radix: 16) ?? 0);
+    _native!.tracerRecord(_handle, _name, length, id, startNs, end);
+  }
+
+  /// Writes the spans held to [path] as Chrome trace JSON. Returns false
+  /// when disabled or on failure.
+  static bool exportTo(String path) {
+    if (_handle == nullptr) return false;
+    final nativePath = path.toNativeUtf8();
+    try {
+      return _native!.tracerWriteChromeTrace(_handle, nativePath, pid) == 0;
+    } finally {
+      calloc.free(nativePath);
+    }
+  }
+
+  /// Exports to the path given to [open], if any, and stops tracing.
+  static void close() {
+    if (_handle == nullptr) return;
+    final path = _exportPath;
+    if (path != null) exportTo(path);
+    _native!.tracerDestroy(_handle);
+    _handle = nullptr;
+    calloc.free(_name);
+    _name = nullptr;
+  }
+}
+
+/// A span started by [Tracing.start]; [end] records it.
+class TraceSpan {
+  final String name;
+  final String? traceId;
+  final int startNs;
+
+  TraceSpan._(this.name, this.traceId, this.startNs);
+
+  void end() => Tracing.record(name, traceId, startNs);
+}
@@ -5,12 +5,29 @@ import 'package:shared_clipboard/services/notification_service.dart';
 import 'package:shared_clipboard/core/constants.dart';
 import 'package:window_manager/window_manager.dart';
 import 'package:shared_clipboard/services/settings_service.dart';
+import 'package:shared_clipboard/services/file_transfer_service.dart';
 import 'package:shared_clipboard/core/navigation.dart';
+import 'package:shared_clipboard/core/logger.dart';
+import 'package:shared_clipboard/core/tracing.dart';
+import 'package:shared_clipboard/native/native_log_sink.dart';
+import 'package:path_provider/path_provider.dart';
 import 'dart:io' show Platform;
 
 void main() async {
   WidgetsFlutterBinding.ensureInitialized();
   // hotkey_manager does not require explicit ensureInitialized on desktop
+
+  // Write logs to a rotating file in the app support directory, off the UI
+  // thread, when sc_native is bundled, and trace share setup.
+  try {
+    final dir = await getApplicationSupportDirectory();
+    await dir.create(recursive: true);
+    AppLogger.sink = NativeLogSink.open('${dir.path}${Platform.pathSeparator}shared_clipboard.log');
+    // Share setup spans, written as Chrome trace JSON on exit
+    Tracing.open(exportPath: '${dir.path}${Platform.pathSeparator}shared_clipboard.trace.json');
+  } catch (_) {
+    // Console logging only.
+  }
   
   // Initialize window manager
   await windowManager.ensureInitialized();
@@ -44,6 +61,9 @@ void main() async {
 
   // Initialize settings service (persistent settings)
   await SettingsService.instance.init();
+
+  // Check copied files as they are copied, ahead of a share (Windows)
+  FileTransferService.watchClipboard();
   
   // Run the app
   runApp(const BackgroundApp());
@@ -0,0 +1,190 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/native/content_chunker.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+import 'package:shared_clipboard/native/sha256_hasher.dart';
+
+/// Serves a file to the sender chunk by chunk, so it is never read into
+/// memory as a whole.
+///
+/// Uses sc_native's memory-mapped chunk source when it is loaded and a
+/// [RandomAccessFile] otherwise. Either way, memory use is bounded by the
+/// chunk size and the send window, not by the file size.
+class FileChunkSource {
+  final ScNative? _native;
+  Pointer<ScChunkSource> _handle = nullptr;
+  Pointer<Uint32> _outLength = nullptr;
+  RandomAccessFile? _file;
+  Uint8List _readBuffer = Uint8List(0);
+
+  // Fallback path: running hash over the bytes served in order so far.
+  StreamingSha256? _hasher;
+  int _hashed = 0;
+
+  /// Total size of the file in bytes.
+  final int length;
+
+  FileChunkSource._native(ScNative native, this._handle)
+      : _native = native,
+        length = native.chunkSourceSize(_handle) {
+    _outLength = calloc<Uint32>();
+  }
+
+  FileChunkSource._file(RandomAccessFile file)
+      : _native = null,
+        _file = file,
+        length = file.lengthSync(),
+        _hasher = StreamingSha256();
+
+  /// Opens [path] for chunked reading. Throws a [FileSystemException] if the
+  /// file cannot be opened.
+  factory FileChunkSource.open(String path) {
+    final native = ScNative.instance;
+    if (native != null) {
+      final nativePath = path.toNativeUtf8();
+      try {
+        final handle = native.chunkSourceOpen(nativePath, 0);
+        if (handle != nullptr) {
+          return FileChunkSource._native(native, handle);
+        }
+      } finally {
+        calloc.free(nativePath);
+      }
+    }
+    return FileChunkSource._file(File(path).openSync());
+  }
+
+  /// Returns up to [size] bytes starting at [offset]; shorter at end of
+  /// file and empty past it.
+  ///
+  /// The returned list is a view that is only valid until the next call to
+  /// [read] or [close]. Copy it to keep it.
+  Uint8List read(int offset, int size) {
+    final native = _native;
+    if (native != null) {
+      if (_handle == nullptr) throw StateError('FileChunkSource is closed');
+      final view = native.chunkSourceView(_handle, offset, size, _outLength);
+      if (view == nullptr) {
+        if (offset < length) {
+          throw FileSystemException('Failed to read chunk at offset $offset');
+        }
+        return Uint8List(0);
+      }
+      return view.asTypedList(_outLength.value);
+    }
+    final file = _file;
+    if (file == null) throw StateError('FileChunkSource is closed');
+    if (_readBuffer.length < size) {
+      _readBuffer = Uint8List(size);
+    }
+    _catchUpHash(offset);
+    file.setPositionSync(offset);
+    final read = file.readIntoSync(_readBuffer, 0, size);
+    final chunk = Uint8List.sublistView(_readBuffer, 0, read);
+    if (_hashed >= offset && _hashed < offset + read) {
+      _hasher!.add(Uint8List.sublistView(chunk, _hashed - offset));
+      _hashed = offset + read;
+    }
+    return chunk;
+  }
+
+  /// Hex SHA-256 of the whole file. Bytes already served by [read] in order
+  /// are not read again, so after a sequential send this is nearly free.
+  /// Consumes the running hash; call once, after the last [read].
+  String digestHex() {
+    final native = _native;
+    if (native != null) {
+      if (_handle == nullptr) throw StateError('FileChunkSource is closed');
+      final out = calloc<Uint8>(ScNative.sha256DigestSize);
+      try {
+        if (native.chunkSourceDigest(_handle, out) != 0) {
+          throw const FileSystemException('Failed to hash file');
+        }
+        return StreamingSha256.digestToHex(out.asTypedList(ScNative.sha256DigestSize));
+      } finally {
+        calloc.free(out);
+      }
+    }
+    if (_file == null) throw StateError('FileChunkSource is closed');
+    _catchUpHash(length);
+    final digest = _hasher!.close();
+    _hasher = null;
+    return digest;
+  }
+
+  /// Splits the whole file into content-defined chunks with their SHA-256s.
+  /// Reads the file once, in order, so the running file hash is complete
+  /// afterwards and [digestHex] does not read it again.
+  List<ContentChunk> contentChunks() {
+    final chunks = <ContentChunk>[];
+    final native = _native;
+    if (native != null) {
+      if (_handle == nullptr) throw StateError('FileChunkSource is closed');
+      final chunker = native.contentChunkerCreate(0, 0, 0);
+      final digest = calloc<Uint8>(ScNative.sha256DigestSize);
+      try {
+        var offset = 0;
+        while (true) {
+          final result = native.contentChunkerNext(chunker, _handle, offset, _outLength, digest);
+          if (result == 0) break;
+          if (result < 0) throw FileSystemException('Failed to read chunk at offset $offset');
+          final length = _outLength.value;
+          chunks.add(ContentChunk(
+              offset, length, StreamingSha256.digestToHex(digest.asTypedList(ScNative.sha256DigestSize))));
+          offset += length;
+        }
+      } finally {
+        calloc.free(digest);
+        native.contentChunkerDestroy(chunker);
+      }
+      return chunks;
+    }
+    final chunker = DartContentChunker();
+    var offset = 0;
+    while (offset < length) {
+      final data = read(offset, chunker.maxSize);
+      if (data.isEmpty) throw FileSystemException('Failed to read chunk at offset $offset');
+      final cut = chunker.cut(data);
+      final hasher = StreamingSha256()..add(Uint8List.sublistView(data, 0, cut));
+      chunks.add(ContentChunk(offset, cut, hasher.close()));
+      offset += cut;
+    }
+    return chunks;
+  }
+
+  // Hashes the bytes between the running hash and [offset] so the digest
+  // stays correct when reads skip ahead (for example on resume).
+  void _catchUpHash(int offset) {
+    final file = _file!;
+    final hasher = _hasher;
+    if (hasher == null || _hashed >= offset) return;
+    const step = 1 << 20;
+    final buffer = Uint8List(step);
+    while (_hashed < offset && _hashed < length) {
+      file.setPositionSync(_hashed);
+      final want = (offset - _hashed) < step ? offset - _hashed : step;
+      final read = file.readIntoSync(buffer, 0, want);
+      if (read <= 0) break;
+      hasher.add(Uint8List.sublistView(buffer, 0, read));
+      _hashed += read;
+    }
+  }
+
+  void close() {
+    if (_handle != nullptr) {
+      _native!.chunkSourceClose(_handle);
+      _handle = nullptr;
+    }
+    if (_outLength != nullptr) {
+      calloc.free(_outLength);
+      _outLength = nullptr;
+    }
+    _file?.closeSync();
+    _file = null;
+    _hasher?.dispose();
+    _hasher = null;
+  }
+}
@@ -0,0 +1,251 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+import 'package:shared_clipboard/native/sha256_hasher.dart';
+
+/// Persistent, content-addressed store of received file chunks.
+///
+/// Chunks are kept by SHA-256 so that when the same or a slightly edited file
+/// is shared again, the sender can skip the chunks already here. The store
+/// is bounded; the least recently used chunks are evicted first, except
+/// pinned ones. See
+/// sc::ChunkStore in windows/runner/native/chunk_store.h; without sc_native
+/// the same on-disk layout is managed in Dart.
+class ChunkStore {
+  static const int defaultCapacity = 1024 * 1024 * 1024;
+
+  final ScNative? _native;
+  Pointer<ScChunkStore> _handle = nullptr;
+  Pointer<Uint8> _digest = nullptr;
+  Pointer<Uint8> _buffer = nullptr;
+  int _bufferSize = 0;
+
+  // Dart fallback state.
+  final Directory? _root;
+  final int _capacity;
+  final Map<String, int> _sizes = {};
+  final Map<String, int> _pins = {};
+  int _sizeBytes = 0;
+
+  ChunkStore._native(ScNative native, this._handle)
+      : _native = native,
+        _root = null,
+        _capacity = 0 {
+    _digest = calloc<Uint8>(ScNative.sha256DigestSize);
+  }
+
+  ChunkStore._dart(Directory root, this._capacity)
+      : _native = null,
+        _root = root;
+
+  /// Opens (creating if needed) the store in [path]. Returns null if it
+  /// cannot be opened.
+  static ChunkStore? open(String path, {int capacity = defaultCapacity}) {
+    final native = ScNative.instance;
+    if (native != null) {
+      final nativePath = path.toNativeUtf8();
+      try {
+        final handle = native.chunkStoreOpen(nativePath, capacity);
+        return handle == nullptr ? null : ChunkStore._native(native, handle);
+      } finally {
+        calloc.free(nativePath);
+      }
+    }
+    try {
+      final root = Directory(path)..createSync(recursive: true);
+      return ChunkStore._dart(root, capacity).._index();
+    } on FileSystemException {
+      return null;
+    }
+  }
+
+  bool contains(String digestHex) {
+    final native = _native;
+    if (native != null) {
+      return native.chunkStoreContains(_handle, _digestPointer(digestHex)) != 0;
+    }
+    return _sizes.containsKey(digestHex);
+  }
+
+  /// Keeps the chunk under [digestHex] from eviction until a matching
+  /// [unpin]; pins nest. Returns false if it is not stored.
+  bool pin(String digestHex) {
+    final native = _native;
+    if (native != null) {
+      return native.chunkStorePin(_handle, _digestPointer(digestHex)) != 0;
+    }
+    if (!_sizes.containsKey(digestHex)) return false;
+    try {
+      _fileFor(digestHex).setLastModifiedSync(DateTime.now());
+    } on FileSystemException {
+      // Still pinned; only its recency is lost
+    }
+    _pins[digestHex] = (_pins[digestHex] ?? 0) + 1;
+    return true;
+  }
+
+  void unpin(String digestHex) {
+    final native = _native;
+    if (native != null) {
+      native.chunkStoreUnpin(_handle, _digestPointer(digestHex));
+      return;
+    }
+    final pins = _pins[digestHex];
+    if (pins == null) return;
+    if (pins > 1) {
+      _pins[digestHex] = pins - 1;
+    } else {
+      _pins.remove(digestHex);
+    }
+  }
+
+  /// Stores [data] under [digestHex] after checking the digest. Returns false
+  /// if it does not match or the chunk cannot be written.
+  bool put(String digestHex, Uint8List data) {
+    final native = _native;
+    if (native != null) {
+      final digest = _digestPointer(digestHex);
+      final buffer = _scratch(data.length);
+      buffer.asTypedList(data.length).setAll(0, data);
+      return native.chunkStorePut(_handle, digest, buffer, data.length) == 0;
+    }
+    if (_sizes.containsKey(digestHex)) return true;
+    if ((StreamingSha256()..add(data)).close() != digestHex) return false;
+    try {
+      final file = _fileFor(digestHex);
+      file.parent.createSync(recursive: true);
+      final temp = File('${file.path}.tmp')..writeAsBytesSync(data, flush: true);
+      temp.renameSync(file.path);
+    } on FileSystemException {
+      return false;
+    }
+    _sizes[digestHex] = data.length;
+    _sizeBytes += data.length;
+    if (_sizeBytes > _capacity) trim();
+    return true;
+  }
+
+  /// Returns the chunk stored under [digestHex], or null if it is missing or
+  /// damaged. [length] is the expected chunk length.
+  Uint8List? get(String digestHex, int length) {
+    final native = _native;
+    if (native != null) {
+      final digest = _digestPointer(digestHex);
+      final buffer = _scratch(length);
+      final read = native.chunkStoreGet(_handle, digest, buffer, length);
+      if (read != length) return null;
+      return Uint8List.fromList(buffer.asTypedList(length));
+    }
+    if (!_sizes.containsKey(digestHex)) return null;
+    final file = _fileFor(digestHex);
+    try {
+      final data = file.readAsBytesSync();
+      if (data.length == length && (StreamingSha256()..add(data)).close() == digestHex) {
+        file.setLastModifiedSync(DateTime.now());
+        return data;
+      }
+    } on FileSystemException {
+      // Treated as damaged below
+    }
+    _remove(digestHex);
+    return null;
+  }
+
+  /// Evicts least recently used unpinned chunks until the store fits its
+  /// capacity.
+  void trim() {
+    final native = _native;
+    if (native != null) {
+      native.chunkStoreTrim(_handle);
+      return;
+    }
+    if (_sizeBytes <= _capacity) return;
+    final byAge = _sizes.keys.where((digestHex) => !_pins.containsKey(digestHex)).toList()
+      ..sort((a, b) => _modified(a).compareTo(_modified(b)));
+    for (final digestHex in byAge) {
+      if (_sizeBytes <= _capacity) break;
+      _remove(digestHex);
+    }
+  }
+
+  void close() {
+    if (_handle != nullptr) {
+      _native!.chunkStoreClose(_handle);
+      _handle = nullptr;
+    }
+    if (_digest != nullptr) {
+      calloc.free(_digest);
+      _digest = nullptr;
+    }
+    if (_buffer != nullptr) {
+      calloc.free(_buffer);
+      _buffer = nullptr;
+      _bufferSize = 0;
+    }
+  }
+
+  Pointer<Uint8> _digestPointer(String digestHex) {
+    if (_handle == nullptr) throw StateError('ChunkStore is closed');
+    final digest = _digest.asTypedList(ScNative.sha256DigestSize);
+    for (var i = 0; i < digest.length; i++) {
+      digest[i] = int.parse(digestHex.substring(2 * i, 2 * i + 2), radix: 16);
+    }
+    return _digest;
+  }
+
+  Pointer<Uint8> _scratch(int size) {
+    if (_bufferSize < size) {
+      if (_buffer != nullptr) calloc.free(_buffer);
+      _buffer = calloc<Uint8>(size);
+      _bufferSize = size;
+    }
+    return _buffer;
+  }
+
+  File _fileFor(String digestHex) =>
+      File('${_root!.path}${Platform.pathSeparator}${digestHex.substring(0, 2)}${Platform.pathSeparator}$digestHex');
+
+  DateTime _modified(String digestHex) {
+    try {
+      return _fileFor(digestHex).lastModifiedSync();
+    } on FileSystemException {
+      return DateTime.fromMillisecondsSinceEpoch(0);
+    }
+  }
+
+  void _remove(String digestHex) {
+    final size = _sizes.remove(digestHex);
+    if (size == null) return;
+    _sizeBytes -= size;
+    try {
+      _fileFor(digestHex).deleteSync();
+    } on FileSystemException {
+      // Already gone
+    }
+  }
+
+  void _index() {
+    final hexDigest = RegExp(r'^[0-9a-f]{64}$');
+    for (final entity in _root!.listSync(recursive: true)) {
+      if (entity is! File) continue;
+      final name = entity.uri.pathSegments.last;
+      if (name.endsWith('.tmp')) {
+        // Left behind by an interrupted put
+        try {
+          entity.deleteSync();
+        } on FileSystemException {
+          // Ignore
+        }
+        continue;
+      }
+      if (!hexDigest.hasMatch(name)) continue;
+      final size = entity.lengthSync();
+      _sizes[name] = size;
+      _sizeBytes += size;
+    }
+    trim();
+  }
+}
@@ -0,0 +1,92 @@
+import 'dart:typed_data';
+
+/// One content-defined chunk of a file: its byte range and SHA-256.
+class ContentChunk {
+  final int offset;
+  final int length;
+  final String digestHex;
+
+  const ContentChunk(this.offset, this.length, this.digestHex);
+
+  int get end => offset + length;
+}
+
+/// Dart port of sc::ContentChunker (FastCDC with normalized chunking), used
+/// when sc_native is not loaded. Cut points must match the native chunker
+/// exactly, or a receiver's stored chunks would never be found again.
+class DartContentChunker {
+  static const int defaultMinSize = 16 * 1024;
+  static const int defaultAverageSize = 64 * 1024;
+  static const int defaultMaxSize = 256 * 1024;
+
+  static final List<int> _gear = _makeGearTable();
+
+  final int minSize;
+  final int averageSize;
+  final int maxSize;
+  final int _maskSmall;
+  final int _maskLarge;
+
+  factory DartContentChunker({
+    int minSize = defaultMinSize,
+    int averageSize = defaultAverageSize,
+    int maxSize = defaultMaxSize,
+  }) {
+    final min = minSize < 64 ? 64 : minSize;
+    final average = averageSize < min ? min : averageSize;
+    final max = maxSize < average ? average : maxSize;
+    return DartContentChunker._(min, average, max);
+  }
+
+  DartContentChunker._(this.minSize, this.averageSize, this.maxSize)
+      : _maskSmall = _maskWithBits(_log2(averageSize) + 2),
+        _maskLarge = _maskWithBits(_log2(averageSize) - 2);
+
+  /// Length of the chunk that starts at the beginning of [data]. Pass at
+  /// least [maxSize] bytes unless the data ends sooner.
+  int cut(Uint8List data) {
+    final length = data.length;
+    if (length <= minSize) return length;
+    final end = length < maxSize ? length : maxSize;
+    final normal = end < averageSize ? end : averageSize;
+    var hash = 0;
+    var i = minSize;
+    for (; i < normal; i++) {
+      hash = (hash << 1) + _gear[data[i]]; // wraps at 64 bits
+      if (hash & _maskSmall == 0) return i + 1;
+    }
+    for (; i < end; i++) {
+      hash = (hash << 1) + _gear[data[i]];
+      if (hash & _maskLarge == 0) return i + 1;
+    }
+    return end;
+  }
+
+  static int _log2(int value) {
+    var bits = 0;
+    while (value > 1) {
+      value >>= 1;
+      bits++;
+    }
+    return bits;
+  }
+
+  static int _maskWithBits(int bits) {
+    final n = bits.clamp(1, 48);
+    return ((1 << n) - 1) << (63 - n);
+  }
+
+  // Same splitmix64 sequence and seed as the native table.
+  static List<int> _makeGearTable() {
+    var state = 0x5C0C11B0A4D;
+    final table = List<int>.filled(256, 0);
+    for (var i = 0; i < table.length; i++) {
+      state += 0x9E3779B97F4A7C15;
+      var z = state;
+      z = (z ^ (z >>> 30)) * 0xBF58476D1CE4E5B9;
+      z = (z ^ (z >>> 27)) * 0x94D049BB133111EB;
+      table[i] = z ^ (z >>> 31);
+    }
+    return table;
+  }
+}
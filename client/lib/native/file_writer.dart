@@ -0,0 +1,174 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+
+/// Writes a received file chunk by chunk.
+///
+/// With sc_native, [write] copies the chunk into a bounded native pool and a
+/// background thread stores it at its offset with positional writes, into
+/// space reserved up front for the whole file. [takeWritten] reports what
+/// has reached the disk, so receive credit is released no faster than the
+/// disk keeps up and a slow disk holds back the sender instead of filling
+/// memory. See sc::FileWriter in windows/runner/native/file_writer.h.
+///
+/// Without sc_native the chunks go to an [IOSink] and count as written at
+/// once; they must then arrive in order.
+class FileWriter {
+  final ScNative? _native;
+  Pointer<ScFileWriter> _handle = nullptr;
+  Pointer<Uint8> _buffer = nullptr;
+  int _bufferSize = 0;
+  final IOSink? _sink;
+
+  /// File being written.
+  final File file;
+  int _submitted = 0;
+  int _written = 0;
+  int _reported = 0;
+  bool _closed = false;
+  Future<void>? _closing;
+
+  FileWriter._native(ScNative native, this._handle, this.file)
+      : _native = native,
+        _sink = null;
+
+  FileWriter._dart(IOSink sink, this.file)
+      : _native = null,
+        _sink = sink;
+
+  /// Opens [file] for a transfer of [size] bytes whose first [keep] bytes are
+  /// already there (see TransferJournal); anything after them is replaced.
+  /// With a [worker], the writes share its thread and pool; it must then be
+  /// disposed of only after this writer is closed. Throws a
+  /// [FileSystemException] if the file cannot be opened.
+  static Future<FileWriter> open(File file, int size, {int keep = 0, WriteWorker? worker}) async {
+    final native = ScNative.instance;
+    if (native != null) {
+      final path = file.path.toNativeUtf8();
+      try {
+        final handle = worker != null && worker._handle != nullptr
+            ? native.fileWriterOpenOn(worker._handle, path, size, keep)
+            : native.fileWriterOpen(path, size, keep, 0);
+        if (handle == nullptr) {
+          throw FileSystemException('Cannot open file for writing', file.path);
+        }
+        return FileWriter._native(native, handle, file);
+      } finally {
+        calloc.free(path);
+      }
+    }
+    if (keep > 0) {
+      final raf = await file.open(mode: FileMode.append);
+      try {
+        await raf.truncate(keep);
+      } finally {
+        await raf.close();
+      }
+    }
+    return FileWriter._dart(file.openWrite(mode: keep > 0 ? FileMode.append : FileMode.write), file);
+  }
+
+  /// Queues [data] to be written at [offset]. Throws a [FileSystemException]
+  /// if an earlier write failed, or a [StateError] if the sender overran the
+  /// pool.
+  void write(int offset, Uint8List data) {
+    if (_closing != null) throw StateError('FileWriter is closed');
+    final native = _native;
+    if (native == null) {
+      _sink!.add(data);
+      _submitted += data.length;
+      _written = _submitted;
+      return;
+    }
+    if (data.isEmpty) return;
+    if (_bufferSize < data.length) {
+      if (_buffer != nullptr) calloc.free(_buffer);
+      _buffer = calloc<Uint8>(data.length);
+      _bufferSize = data.length;
+    }
+    _buffer.asTypedList(data.length).setAll(0, data);
+    if (native.fileWriterWrite(_handle, offset, _buffer, data.length) != 0) {
+      if (native.fileWriterFailed(_handle) != 0) {
+        throw FileSystemException('Write failed', file.path);
+      }
+      throw StateError('Receive buffer full at offset $offset of ${file.path}');
+    }
+    _submitted += data.length;
+  }
+
+  /// Bytes that reached the file since the last call.
+  int takeWritten() {
+    final native = _native;
+    if (native != null && !_closed) _written = native.fileWriterWritten(_handle);
+    final bytes = _written - _reported;
+    _reported = _written;
+    return bytes;
+  }
+
+  /// Bytes passed to [write] that are not on disk yet.
+  int get queued {
+    final native = _native;
+    if (native != null && !_closed) _written = native.fileWriterWritten(_handle);
+    return _submitted - _written;
+  }
+
+  /// Whether a write failed. The transfer cannot complete.
+  bool get failed {
+    final native = _native;
+    return native != null && !_closed && native.fileWriterFailed(_handle) != 0;
+  }
+
+  /// Waits for queued writes and closes the file. Throws a
+  /// [FileSystemException] if any write failed. Safe to call more than once.
+  Future<void> close() => _closing ??= _close();
+
+  Future<void> _close() async {
+    final native = _native;
+    if (native == null) {
+      _closed = true;
+      await _sink!.flush();
+      await _sink!.close();
+      return;
+    }
+    // Wait here rather than in the native close, which would block the
+    // isolate while the disk catches up.
+    while (queued > 0 && !failed) {
+      await Future.delayed(const Duration(milliseconds: 2));
+    }
+    _written = native.fileWriterWritten(_handle);
+    _closed = true;
+    final ok = native.fileWriterClose(_handle) == 0;
+    _handle = nullptr;
+    if (_buffer != nullptr) calloc.free(_buffer);
+    _buffer = nullptr;
+    _bufferSize = 0;
+    if (!ok) throw FileSystemException('Write failed', file.path);
+  }
+}
+
+/// The thread and bounded buffer pool behind the writers of one session, so
+/// a transfer of many files does not cost a thread and a pool per file. See
+/// sc::WriteWorker in windows/runner/native/file_writer.h.
+class WriteWorker {
+  Pointer<ScWriteWorker> _handle;
+
+  WriteWorker._(this._handle);
+
+  /// Returns null without sc_native, whose writers need no worker.
+  static WriteWorker? create() {
+    final native = ScNative.instance;
+    if (native == null) return null;
+    final handle = native.writeWorkerCreate(0);
+    return handle == nullptr ? null : WriteWorker._(handle);
+  }
+
+  /// Stops the thread. Every writer opened on this worker must be closed.
+  void dispose() {
+    if (_handle == nullptr) return;
+    ScNative.instance!.writeWorkerDestroy(_handle);
+    _handle = nullptr;
+  }
+}
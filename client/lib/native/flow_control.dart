@@ -0,0 +1,245 @@
+import 'dart:ffi';
+import 'dart:math' as math;
+
+import 'package:shared_clipboard/native/sc_native.dart';
+
+/// Monotonic microsecond clock shared by the flow control windows.
+final Stopwatch _clock = Stopwatch()..start();
+int _nowUs() => _clock.elapsedMicroseconds;
+
+/// Sender half of the credit-based sliding window for file streams.
+///
+/// The receiver grants credit as a cumulative byte limit for the session.
+/// Within it the sender keeps a window of about twice the measured
+/// bandwidth-delay product, capped so the data channel's bufferedAmount stays
+/// well below libwebrtc's 16 MiB limit. See sc::CreditSender in
+/// windows/runner/native/flow_control.h; without sc_native the same algorithm
+/// runs in Dart.
+class SendWindow {
+  final ScNative? _native;
+  Pointer<ScCreditSender> _handle = nullptr;
+  final _DartCreditSender? _dart;
+
+  SendWindow._native(ScNative native)
+      : _native = native,
+        _dart = null {
+    _handle = native.creditSenderCreate();
+  }
+
+  SendWindow._dart()
+      : _native = null,
+        _dart = _DartCreditSender();
+
+  factory SendWindow() {
+    final native = ScNative.instance;
+    return native != null ? SendWindow._native(native) : SendWindow._dart();
+  }
+
+  /// Bytes that may be sent now given the channel's [bufferedAmount].
+  int available(int bufferedAmount) {
+    final native = _native;
+    if (native != null) return native.creditSenderAvailable(_handle, bufferedAmount);
+    return _dart!.available(bufferedAmount);
+  }
+
+  void onSent(int bytes) {
+    final native = _native;
+    if (native != null) {
+      native.creditSenderOnSent(_handle, bytes, _nowUs());
+    } else {
+      _dart!.onSent(bytes, _nowUs());
+    }
+  }
+
+  /// Applies a grant: [consumed] bytes processed, up to [limit] may be sent.
+  void onCredit(int consumed, int limit) {
+    final native = _native;
+    if (native != null) {
+      native.creditSenderOnCredit(_handle, consumed, limit, _nowUs());
+    } else {
+      _dart!.onCredit(consumed, limit, _nowUs());
+    }
+  }
+
+  int get window {
+    final native = _native;
+    if (native != null) return native.creditSenderWindow(_handle);
+    return _dart!.window;
+  }
+
+  int get rttUs {
+    final native = _native;
+    if (native != null) return native.creditSenderRttUs(_handle);
+    return _dart!.srttUs;
+  }
+
+  void dispose() {
+    if (_handle != nullptr) {
+      _native!.creditSenderDestroy(_handle);
+      _handle = nullptr;
+    }
+  }
+}
+
+/// Receiver half: counts bytes consumed and released, and says when to send a
+/// grant.
+///
+/// Bytes are consumed when they come off the data channel and released once
+/// they have been written out. The advertised limit follows released bytes, so
+/// data held for reordering counts against the window.
+class ReceiveWindow {
+  static const int defaultWindow = 16 * 1024 * 1024;
+  static const int defaultGrantInterval = 128 * 1024;
+
+  final ScNative? _native;
+  Pointer<ScCreditReceiver> _handle = nullptr;
+  final int _window;
+  final int _grantInterval;
+  int _consumed = 0;
+  int _released = 0;
+  int _grantedConsumed = 0;
+  int _grantedReleased = 0;
+
+  ReceiveWindow({int window = defaultWindow, int grantInterval = defaultGrantInterval})
+      : _native = ScNative.instance,
+        _window = window,
+        _grantInterval = grantInterval {
+    _handle = _native?.creditReceiverCreate(window, grantInterval) ?? nullptr;
+  }
+
+  /// Records [bytes] consumed; returns true when a grant should be sent.
+  bool onConsumed(int bytes) {
+    final native = _native;
+    if (native != null) return native.creditReceiverOnConsumed(_handle, bytes) != 0;
+    _consumed += bytes;
+    return _shouldGrant();
+  }
+
+  /// Records [bytes] released; returns true when a grant should be sent.
+  bool onReleased(int bytes) {
+    final native = _native;
+    if (native != null) return native.creditReceiverOnReleased(_handle, bytes) != 0;
+    _released += bytes;
+    return _shouldGrant();
+  }
+
+  bool _shouldGrant() {
+    if (_consumed - _grantedConsumed < _grantInterval && _released - _grantedReleased < _grantInterval) {
+      return false;
+    }
+    _grantedConsumed = _consumed;
+    _grantedReleased = _released;
+    return true;
+  }
+
+  int get consumed {
+    final native = _native;
+    if (native != null) return native.creditReceiverConsumed(_handle);
+    return _consumed;
+  }
+
+  /// Cumulative byte limit to advertise in a grant.
+  int get limit {
+    final native = _native;
+    if (native != null) return native.creditReceiverLimit(_handle);
+    return _released + _window;
+  }
+
+  void dispose() {
+    if (_handle != nullptr) {
+      _native!.creditReceiverDestroy(_handle);
+      _handle = nullptr;
+    }
+  }
+}
+
+// Dart port of sc::CreditSender, used when sc_native is not loaded.
+class _DartCreditSender {
+  static const int initialWindow = 512 * 1024;
+  static const int minWindow = 256 * 1024;
+  static const int maxWindow = 16 * 1024 * 1024;
+  static const int maxBuffered = 8 * 1024 * 1024;
+  static const double windowGain = 2.0;
+  static const int rateSamples = 8;
+  static const int minRttExpiryUs = 10 * 1000 * 1000;
+
+  int sent = 0;
+  int consumed = 0;
+  int limit = 0;
+  int window = initialWindow;
+  final List<List<int>> _records = []; // [end, timeUs]
+  int _recordsHead = 0;
+
+  int srttUs = 0;
+  int minRttUs = 0;
+  int _minRttStampUs = 0;
+
+  int? _rateStampUs;
+  int _rateConsumed = 0;
+  final List<double> _rates = List<double>.filled(rateSamples, 0);
+  int _nextRate = 0;
+
+  int available(int bufferedAmount) {
+    final credit = math.max(0, limit - sent);
+    final room = math.max(0, window - (sent - consumed));
+    final buffer = math.max(0, maxBuffered - bufferedAmount);
+    return math.min(credit, math.min(room, buffer));
+  }
+
+  void onSent(int bytes, int nowUs) {
+    if (bytes <= 0) return;
+    sent += bytes;
+    _records.add([sent, nowUs]);
+  }
+
+  void onCredit(int newConsumed, int newLimit, int nowUs) {
+    limit = math.max(limit, newLimit);
+    if (newConsumed <= consumed) return;
+    consumed = math.min(newConsumed, sent);
+
+    int? sentAtUs;
+    while (_recordsHead < _records.length && _records[_recordsHead][0] <= consumed) {
+      sentAtUs = _records[_recordsHead][1];
+      _recordsHead++;
+    }
+    if (_recordsHead > 1024) {
+      _records.removeRange(0, _recordsHead);
+      _recordsHead = 0;
+    }
+    if (sentAtUs != null && nowUs >= sentAtUs) {
+      _updateRtt(math.max(1, nowUs - sentAtUs), nowUs);
+    }
+    _updateDeliveryRate(nowUs);
+    _updateWindow();
+  }
+
+  void _updateRtt(int sampleUs, int nowUs) {
+    srttUs = srttUs == 0 ? sampleUs : (7 * srttUs + sampleUs) ~/ 8;
+    if (minRttUs == 0 || sampleUs <= minRttUs || nowUs - _minRttStampUs > minRttExpiryUs) {
+      minRttUs = sampleUs;
+      _minRttStampUs = nowUs;
+    }
+  }
+
+  void _updateDeliveryRate(int nowUs) {
+    final stamp = _rateStampUs;
+    if (stamp == null) {
+      _rateStampUs = nowUs;
+      _rateConsumed = consumed;
+      return;
+    }
+    final interval = nowUs - stamp;
+    if (interval < math.max(minRttUs ~/ 2, 1000)) return;
+    _rates[_nextRate] = (consumed - _rateConsumed) * 1e6 / interval;
+    _nextRate = (_nextRate + 1) % rateSamples;
+    _rateConsumed = consumed;
+    _rateStampUs = nowUs;
+  }
+
+  void _updateWindow() {
+    final rate = _rates.reduce(math.max);
+    if (rate <= 0 || minRttUs == 0) return;
+    final target = (windowGain * rate * minRttUs / 1e6).round();
+    window = target.clamp(minWindow, maxWindow);
+  }
+}
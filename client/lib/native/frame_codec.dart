@@ -0,0 +1,153 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/native/payload_compressor.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+
+/// One decoded proto v2 binary file frame. [payload] is a view into the
+/// received message, not a copy, unless the frame was compressed.
+class FileFrame {
+  final int sessionId;
+  final int fileIndex;
+  final int offset;
+  final int flags;
+  final Uint8List payload;
+
+  FileFrame({
+    required this.sessionId,
+    required this.fileIndex,
+    required this.offset,
+    required this.flags,
+    required this.payload,
+  });
+
+  bool get isLast => (flags & FrameCodec.flagLast) != 0;
+}
+
+/// Encodes and decodes the binary file frames described in
+/// windows/runner/native/frame_codec.h.
+///
+/// Uses sc_native when it is loaded and an equivalent Dart codec otherwise,
+/// so peers without the native library still interoperate.
+class FrameCodec {
+  static const int headerSize = 32;
+  static const int flagLast = 0x01;
+  static const int flagCompressed = 0x02;
+
+  static const int _magic = 0x4353;
+  static const int _version = 1;
+
+  final ScNative? _native = ScNative.instance;
+  final PayloadCompressor? _compressor = PayloadCompressor.create();
+  Pointer<ScFrameHeader>? _header;
+  Pointer<Uint8>? _headerBytes;
+
+  FrameCodec() {
+    if (_native != null) {
+      _header = calloc<ScFrameHeader>();
+      _headerBytes = calloc<Uint8>(headerSize);
+    }
+  }
+
+  /// Whether frames can be compressed and decompressed here.
+  bool get supportsCompression => _compressor != null;
+
+  /// Builds a frame carrying [payload] at [offset] of file [fileIndex]. With
+  /// [compress] the payload is LZ4-compressed when that pays off; only set
+  /// it for peers that advertised the codec.
+  Uint8List encode({
+    required int sessionId,
+    required int fileIndex,
+    required int offset,
+    required List<int> payload,
+    int flags = 0,
+    bool compress = false,
+  }) {
+    var rawLength = 0;
+    final compressor = _compressor;
+    if (compress && compressor != null) {
+      final compressed = compressor.compressChunk(payload);
+      if (compressed != null) {
+        rawLength = payload.length;
+        payload = compressed;
+        flags |= flagCompressed;
+      }
+    }
+    final frame = Uint8List(headerSize + payload.length);
+    final native = _native;
+    if (native != null) {
+      _header!.ref
+        ..sessionId = sessionId
+        ..offset = offset
+        ..fileIndex = fileIndex
+        ..length = payload.length
+        ..flags = flags
+        ..rawLength = rawLength;
+      native.frameWriteHeader(_header!, _headerBytes!);
+      frame.setRange(0, headerSize, _headerBytes!.asTypedList(headerSize));
+    } else {
+      ByteData.sublistView(frame, 0, headerSize)
+        ..setUint16(0, _magic, Endian.little)
+        ..setUint8(2, _version)
+        ..setUint8(3, flags)
+        ..setUint32(4, fileIndex, Endian.little)
+        ..setUint64(8, sessionId, Endian.little)
+        ..setUint64(16, offset, Endian.little)
+        ..setUint32(24, payload.length, Endian.little)
+        ..setUint32(28, 0, Endian.little);
+    }
+    frame.setRange(headerSize, frame.length, payload);
+    return frame;
+  }
+
+  /// Parses a received frame. Returns null if [data] is not a well-formed frame.
+  FileFrame? decode(Uint8List data) {
+    if (data.length < headerSize) return null;
+    final native = _native;
+    if (native != null) {
+      _headerBytes!.asTypedList(headerSize).setRange(0, headerSize, data);
+      if (native.frameReadHeader(_headerBytes!, data.length, _header!) < 0) {
+        return null;
+      }
+      final h = _header!.ref;
+      var payload = Uint8List.sublistView(data, headerSize);
+      if ((h.flags & flagCompressed) != 0) {
+        final raw = _compressor?.decompress(payload, h.rawLength);
+        if (raw == null) return null;
+        payload = raw;
+      }
+      return FileFrame(
+        sessionId: h.sessionId,
+        fileIndex: h.fileIndex,
+        offset: h.offset,
+        flags: h.flags,
+        payload: payload,
+      );
+    }
+    // Compressed frames are never sent to peers without sc_native, so a
+    // nonzero raw length is malformed here.
+    final view = ByteData.sublistView(data, 0, headerSize);
+    if (view.getUint16(0, Endian.little) != _magic ||
+        view.getUint8(2) != _version ||
+        view.getUint32(28, Endian.little) != 0 ||
+        view.getUint32(24, Endian.little) != data.length - headerSize) {
+      return null;
+    }
+    return FileFrame(
+      sessionId: view.getUint64(8, Endian.little),
+      fileIndex: view.getUint32(4, Endian.little),
+      offset: view.getUint64(16, Endian.little),
+      flags: view.getUint8(3),
+      payload: Uint8List.sublistView(data, headerSize),
+    );
+  }
+
+  void dispose() {
+    _compressor?.dispose();
+    if (_header != null) calloc.free(_header!);
+    if (_headerBytes != null) calloc.free(_headerBytes!);
+    _header = null;
+    _headerBytes = null;
+  }
+}
@@ -0,0 +1,77 @@
+import 'dart:convert';
+import 'dart:ffi';
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/core/logger.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+
+/// Writes log lines to a rotating file through sc::RingLogger (see
+/// windows/runner/native/ring_logger.h).
+///
+/// [write] encodes the line into a reused native buffer and copies it into
+/// the logger's lock-free ring with one leaf FFI call; timestamping,
+/// formatting and file I/O happen in batches on the logger's own thread.
+/// Lines that find the ring full are dropped and counted in the file rather
+/// than blocking the UI thread.
+class NativeLogSink implements LogSink {
+  /// Longest line kept, in bytes; matches sc::RingLogger::kMaxMessageSize.
+  /// Longer lines are cut off at a UTF-8 boundary.
+  static const int maxLineBytes = 1000;
+
+  final ScNative _native;
+  Pointer<ScLogger> _handle;
+  final Pointer<Uint8> _buffer;
+
+  NativeLogSink._(this._native, this._handle) : _buffer = calloc<Uint8>(maxLineBytes);
+
+  /// Opens the log at [path], kept under [maxFileSize] bytes with [backups]
+  /// rotated files beside it. Returns null without sc_native or if the file
+  /// cannot be opened.
+  static NativeLogSink? open(String path, {int maxFileSize = 0, int backups = 3}) {
+    final native = ScNative.instance;
+    if (native == null) return null;
+    final nativePath = path.toNativeUtf8();
+    try {
+      final handle = native.loggerOpen(nativePath, maxFileSize, backups, 0);
+      if (handle == nullptr) return null;
+      // AppLogger filters by level before formatting; the native level only
+      // has to let through what it passes on.
+      native.loggerSetLevel(handle, LogLevel.debug);
+      return NativeLogSink._(native, handle);
+    } finally {
+      calloc.free(nativePath);
+    }
+  }
+
+  @override
+  void write(int level, String line) {
+    if (_handle == nullptr) return;
+    final bytes = utf8.encode(line);
+    var length = bytes.length;
+    if (length > maxLineBytes) {
+      // Cuts before a UTF-8 continuation byte, not through a code point.
+      length = maxLineBytes;
+      while (length > 0 && (bytes[length] & 0xC0) == 0x80) {
+        length--;
+      }
+    }
+    _buffer.asTypedList(length).setRange(0, length, bytes);
+    _native.loggerWrite(_handle, level, _buffer, length);
+  }
+
+  /// Lines dropped because the ring was full, in total.
+  int get dropped => _handle == nullptr ? 0 : _native.loggerDropped(_handle);
+
+  @override
+  void flush() {
+    if (_handle != nullptr) _native.loggerFlush(_handle);
+  }
+
+  @override
+  void close() {
+    if (_handle == nullptr) return;
+    _native.loggerClose(_handle);
+    _handle = nullptr;
+    calloc.free(_buffer);
+  }
+}
@@ -0,0 +1,133 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+
+/// LZ4 compression of transfer payloads, backed by sc_native (see
+/// windows/runner/native/compression.h).
+///
+/// There is no Dart fallback: without sc_native [isAvailable] is false, the
+/// peer does not advertise the codec and everything travels uncompressed.
+class PayloadCompressor {
+  /// Codec name exchanged in capability lists.
+  static const String codecLz4 = 'lz4';
+
+  // MIME types whose contents are already compressed, so another pass only
+  // costs CPU. Text-like image formats are compressible and not listed.
+  static const Set<String> _compressedTypes = {
+    'application/zip',
+    'application/gzip',
+    'application/x-gzip',
+    'application/x-7z-compressed',
+    'application/x-rar-compressed',
+    'application/vnd.rar',
+    'application/x-bzip2',
+    'application/x-xz',
+    'application/zstd',
+    'application/java-archive',
+    'application/vnd.android.package-archive',
+    'application/epub+zip',
+    'application/pdf',
+    'application/vnd.openxmlformats-officedocument.wordprocessingml.document',
+    'application/vnd.openxmlformats-officedocument.spreadsheetml.sheet',
+    'application/vnd.openxmlformats-officedocument.presentationml.presentation',
+  };
+  static const Set<String> _compressibleMedia = {
+    'image/bmp',
+    'image/svg+xml',
+    'image/x-icon',
+    'image/tiff',
+    'audio/wav',
+    'audio/x-wav',
+  };
+
+  static bool get isAvailable => ScNative.instance != null;
+
+  /// Whether a file of [mimeType] (from lookupMimeType) is worth compressing.
+  /// Unknown types are tried; the per-chunk entropy probe catches the rest.
+  static bool isCompressibleType(String? mimeType) {
+    if (mimeType == null) return true;
+    final type = mimeType.toLowerCase();
+    if (_compressibleMedia.contains(type)) return true;
+    if (type.startsWith('image/') || type.startsWith('video/') || type.startsWith('audio/')) {
+      return false;
+    }
+    return !_compressedTypes.contains(type);
+  }
+
+  final ScNative _native;
+  final int acceleration;
+  Pointer<Uint8> _input = nullptr;
+  int _inputSize = 0;
+  Pointer<Uint8> _output = nullptr;
+  int _outputSize = 0;
+
+  PayloadCompressor._(this._native, this.acceleration);
+
+  /// Returns null when sc_native is not loaded.
+  static PayloadCompressor? create({int acceleration = 1}) {
+    final native = ScNative.instance;
+    return native == null ? null : PayloadCompressor._(native, acceleration);
+  }
+
+  /// Compresses one file chunk, or returns null if it should be sent raw
+  /// because it looks incompressible or would barely shrink.
+  Uint8List? compressChunk(List<int> data) {
+    if (data.isEmpty) return null;
+    final input = _inputFor(data);
+    final capacity = _outputFor(data.length);
+    final size = _native.compressChunk(input, data.length, _output, capacity, acceleration);
+    return size == 0 ? null : Uint8List.fromList(_output.asTypedList(size));
+  }
+
+  /// Compresses [data] as one block, or returns null if that would not make
+  /// it smaller.
+  Uint8List? compress(List<int> data) {
+    final input = _inputFor(data);
+    final capacity = _outputFor(_native.lz4CompressBound(data.length));
+    final size = _native.lz4Compress(input, data.length, _output, capacity, acceleration);
+    return size == 0 || size >= data.length ? null : Uint8List.fromList(_output.asTypedList(size));
+  }
+
+  /// Decompresses a block that must expand to exactly [rawLength] bytes.
+  /// Returns null if it is malformed.
+  Uint8List? decompress(List<int> data, int rawLength) {
+    // rawLength comes from the peer; no LZ4 block expands more than 255-fold
+    if (data.isEmpty || rawLength < 0 || rawLength > data.length * 255) return null;
+    final input = _inputFor(data);
+    _outputFor(rawLength);
+    if (_native.lz4Decompress(input, data.length, _output, rawLength) != 0) {
+      return null;
+    }
+    return Uint8List.fromList(_output.asTypedList(rawLength));
+  }
+
+  void dispose() {
+    if (_input != nullptr) calloc.free(_input);
+    if (_output != nullptr) calloc.free(_output);
+    _input = nullptr;
+    _output = nullptr;
+    _inputSize = 0;
+    _outputSize = 0;
+  }
+
+  Pointer<Uint8> _inputFor(List<int> data) {
+    if (_inputSize < data.length || _input == nullptr) {
+      if (_input != nullptr) calloc.free(_input);
+      _inputSize = data.length < 1 ? 1 : data.length;
+      _input = calloc<Uint8>(_inputSize);
+    }
+    _input.asTypedList(data.length).setAll(0, data);
+    return _input;
+  }
+
+  int _outputFor(int size) {
+    if (_outputSize < size || _output == nullptr) {
+      if (_output != nullptr) calloc.free(_output);
+      _outputSize = size < 1 ? 1 : size;
+      _output = calloc<Uint8>(_outputSize);
+    }
+    return size;
+  }
+}
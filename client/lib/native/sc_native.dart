@@ -0,0 +1,440 @@
+import 'dart:ffi';
+import 'dart:io';
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/core/logger.dart';
+
+/// Mirrors `ScFrameHeader` in windows/runner/native/sc_native_api.h.
+class ScFrameHeader extends Struct {
+  @Uint64()
+  external int sessionId;
+  @Uint64()
+  external int offset;
+  @Uint32()
+  external int fileIndex;
+  @Uint32()
+  external int length;
+  @Uint32()
+  external int flags;
+  @Uint32()
+  external int rawLength;
+}
+
+/// Opaque `ScChunkSource` handle.
+class ScChunkSource extends Opaque {}
+
+/// Opaque `ScSha256` handle.
+class ScSha256 extends Opaque {}
+
+/// Opaque `ScCreditSender` handle.
+class ScCreditSender extends Opaque {}
+
+/// Opaque `ScCreditReceiver` handle.
+class ScCreditReceiver extends Opaque {}
+
+/// Mirrors `ScScheduledChunk` in windows/runner/native/sc_native_api.h.
+class ScScheduledChunk extends Struct {
+  @Uint64()
+  external int offset;
+  @Uint32()
+  external int fileIndex;
+  @Uint32()
+  external int length;
+  @Uint32()
+  external int flags;
+  @Uint32()
+  external int reserved;
+}
+
+/// Opaque `ScSendScheduler` handle.
+class ScSendScheduler extends Opaque {}
+
+/// Opaque `ScStripeScheduler` handle.
+class ScStripeScheduler extends Opaque {}
+
+/// Opaque `ScReassemblyBuffer` handle.
+class ScReassemblyBuffer extends Opaque {}
+
+/// Opaque `ScContentChunker` handle.
+class ScContentChunker extends Opaque {}
+
+/// Opaque `ScChunkStore` handle.
+class ScChunkStore extends Opaque {}
+
+/// Opaque `ScFileWriter` handle.
+class ScFileWriter extends Opaque {}
+
+/// Opaque `ScWriteWorker` handle.
+class ScWriteWorker extends Opaque {}
+
+/// Opaque `ScLogger` handle.
+class ScLogger extends Opaque {}
+
+/// Opaque `ScTracer` handle.
+class ScTracer extends Opaque {}
+
+/// Bindings to the sc_native library built from windows/runner/native.
+///
+/// [instance] is null when the library is not bundled with this build (for
+/// example on macOS); callers then use their pure Dart implementation.
+class ScNative {
+  /// Must match SC_NATIVE_ABI_VERSION in sc_native_api.h.
+  static const int abiVersion = 3;
+
+  static final AppLogger _logger = logTag('SC_NATIVE');
+  static final ScNative? instance = _load();
+
+  final DynamicLibrary _lib;
+  ScNative._(this._lib);
+
+  static ScNative? _load() {
+    final String name;
+    if (Platform.isWindows) {
+      name = 'sc_native.dll';
+    } else if (Platform.isMacOS) {
+      name = 'libsc_native.dylib';
+    } else {
+      name = 'libsc_native.so';
+    }
+    try {
+      final lib = DynamicLibrary.open(name);
+      final version = lib.lookupFunction<Uint32 Function(), int Function()>('sc_native_abi_version')();
+      if (version != abiVersion) {
+        _logger.w('sc_native ABI mismatch, using Dart fallbacks', {'expected': abiVersion, 'found': version});
+        return null;
+      }
+      _logger.i('sc_native loaded', name);
+      return ScNative._(lib);
+    } catch (e) {
+      _logger.w('sc_native not available, using Dart fallbacks', e.toString());
+      return null;
+    }
+  }
+
+  // ===== Frame codec =====
+  late final void Function(Pointer<ScFrameHeader>, Pointer<Uint8>) frameWriteHeader = _lib.lookupFunction<
+      Void Function(Pointer<ScFrameHeader>, Pointer<Uint8>),
+      void Function(Pointer<ScFrameHeader>, Pointer<Uint8>)>('sc_frame_write_header');
+
+  late final int Function(Pointer<Uint8>, int, Pointer<ScFrameHeader>) frameReadHeader = _lib.lookupFunction<
+      Int32 Function(Pointer<Uint8>, Uint64, Pointer<ScFrameHeader>),
+      int Function(Pointer<Uint8>, int, Pointer<ScFrameHeader>)>('sc_frame_read_header');
+
+  // ===== Chunk source =====
+  static const int chunkSourceNoMmap = 0x1;
+
+  late final Pointer<ScChunkSource> Function(Pointer<Utf8>, int) chunkSourceOpen = _lib.lookupFunction<
+      Pointer<ScChunkSource> Function(Pointer<Utf8>, Uint32),
+      Pointer<ScChunkSource> Function(Pointer<Utf8>, int)>('sc_chunk_source_open');
+
+  late final int Function(Pointer<ScChunkSource>) chunkSourceSize = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScChunkSource>),
+      int Function(Pointer<ScChunkSource>)>('sc_chunk_source_size');
+
+  late final Pointer<Uint8> Function(Pointer<ScChunkSource>, int, int, Pointer<Uint32>) chunkSourceView =
+      _lib.lookupFunction<
+          Pointer<Uint8> Function(Pointer<ScChunkSource>, Uint64, Uint32, Pointer<Uint32>),
+          Pointer<Uint8> Function(Pointer<ScChunkSource>, int, int, Pointer<Uint32>)>('sc_chunk_source_view');
+
+  late final void Function(Pointer<ScChunkSource>) chunkSourceClose = _lib.lookupFunction<
+      Void Function(Pointer<ScChunkSource>),
+      void Function(Pointer<ScChunkSource>)>('sc_chunk_source_close');
+
+  late final int Function(Pointer<ScChunkSource>, Pointer<Uint8>) chunkSourceDigest = _lib.lookupFunction<
+      Int32 Function(Pointer<ScChunkSource>, Pointer<Uint8>),
+      int Function(Pointer<ScChunkSource>, Pointer<Uint8>)>('sc_chunk_source_digest');
+
+  // ===== SHA-256 =====
+  static const int sha256DigestSize = 32;
+
+  late final Pointer<ScSha256> Function() sha256Create =
+      _lib.lookupFunction<Pointer<ScSha256> Function(), Pointer<ScSha256> Function()>('sc_sha256_create');
+
+  late final void Function(Pointer<ScSha256>, Pointer<Uint8>, int) sha256Update = _lib.lookupFunction<
+      Void Function(Pointer<ScSha256>, Pointer<Uint8>, Uint64),
+      void Function(Pointer<ScSha256>, Pointer<Uint8>, int)>('sc_sha256_update');
+
+  late final void Function(Pointer<ScSha256>, Pointer<Uint8>) sha256Finish = _lib.lookupFunction<
+      Void Function(Pointer<ScSha256>, Pointer<Uint8>),
+      void Function(Pointer<ScSha256>, Pointer<Uint8>)>('sc_sha256_finish');
+
+  late final void Function(Pointer<ScSha256>) sha256Destroy = _lib.lookupFunction<
+      Void Function(Pointer<ScSha256>),
+      void Function(Pointer<ScSha256>)>('sc_sha256_destroy');
+
+  // ===== Flow control =====
+  late final Pointer<ScCreditSender> Function() creditSenderCreate = _lib.lookupFunction<
+      Pointer<ScCreditSender> Function(), Pointer<ScCreditSender> Function()>('sc_credit_sender_create');
+
+  late final int Function(Pointer<ScCreditSender>, int) creditSenderAvailable = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScCreditSender>, Uint64),
+      int Function(Pointer<ScCreditSender>, int)>('sc_credit_sender_available');
+
+  late final void Function(Pointer<ScCreditSender>, int, int) creditSenderOnSent = _lib.lookupFunction<
+      Void Function(Pointer<ScCreditSender>, Uint64, Uint64),
+      void Function(Pointer<ScCreditSender>, int, int)>('sc_credit_sender_on_sent');
+
+  late final void Function(Pointer<ScCreditSender>, int, int, int) creditSenderOnCredit = _lib.lookupFunction<
+      Void Function(Pointer<ScCreditSender>, Uint64, Uint64, Uint64),
+      void Function(Pointer<ScCreditSender>, int, int, int)>('sc_credit_sender_on_credit');
+
+  late final int Function(Pointer<ScCreditSender>) creditSenderWindow = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScCreditSender>),
+      int Function(Pointer<ScCreditSender>)>('sc_credit_sender_window');
+
+  late final int Function(Pointer<ScCreditSender>) creditSenderRttUs = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScCreditSender>),
+      int Function(Pointer<ScCreditSender>)>('sc_credit_sender_rtt_us');
+
+  late final void Function(Pointer<ScCreditSender>) creditSenderDestroy = _lib.lookupFunction<
+      Void Function(Pointer<ScCreditSender>),
+      void Function(Pointer<ScCreditSender>)>('sc_credit_sender_destroy');
+
+  late final Pointer<ScCreditReceiver> Function(int, int) creditReceiverCreate = _lib.lookupFunction<
+      Pointer<ScCreditReceiver> Function(Uint64, Uint64),
+      Pointer<ScCreditReceiver> Function(int, int)>('sc_credit_receiver_create');
+
+  late final int Function(Pointer<ScCreditReceiver>, int) creditReceiverOnConsumed = _lib.lookupFunction<
+      Int32 Function(Pointer<ScCreditReceiver>, Uint64),
+      int Function(Pointer<ScCreditReceiver>, int)>('sc_credit_receiver_on_consumed');
+
+  late final int Function(Pointer<ScCreditReceiver>, int) creditReceiverOnReleased = _lib.lookupFunction<
+      Int32 Function(Pointer<ScCreditReceiver>, Uint64),
+      int Function(Pointer<ScCreditReceiver>, int)>('sc_credit_receiver_on_released');
+
+  late final int Function(Pointer<ScCreditReceiver>) creditReceiverConsumed = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScCreditReceiver>),
+      int Function(Pointer<ScCreditReceiver>)>('sc_credit_receiver_consumed');
+
+  late final int Function(Pointer<ScCreditReceiver>) creditReceiverLimit = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScCreditReceiver>),
+      int Function(Pointer<ScCreditReceiver>)>('sc_credit_receiver_limit');
+
+  late final void Function(Pointer<ScCreditReceiver>) creditReceiverDestroy = _lib.lookupFunction<
+      Void Function(Pointer<ScCreditReceiver>),
+      void Function(Pointer<ScCreditReceiver>)>('sc_credit_receiver_destroy');
+
+  // ===== Send scheduler =====
+  static const int scheduledChunkFirst = 0x1;
+  static const int scheduledChunkLast = 0x2;
+
+  late final Pointer<ScSendScheduler> Function(Pointer<Uint64>, int, int, int) sendSchedulerCreate =
+      _lib.lookupFunction<
+          Pointer<ScSendScheduler> Function(Pointer<Uint64>, Uint32, Uint32, Uint32),
+          Pointer<ScSendScheduler> Function(Pointer<Uint64>, int, int, int)>('sc_send_scheduler_create');
+
+  late final int Function(Pointer<ScSendScheduler>, Pointer<ScScheduledChunk>) sendSchedulerNext = _lib.lookupFunction<
+      Int32 Function(Pointer<ScSendScheduler>, Pointer<ScScheduledChunk>),
+      int Function(Pointer<ScSendScheduler>, Pointer<ScScheduledChunk>)>('sc_send_scheduler_next');
+
+  late final void Function(Pointer<ScSendScheduler>, int, int, int) sendSchedulerSkip = _lib.lookupFunction<
+      Void Function(Pointer<ScSendScheduler>, Uint32, Uint64, Uint64),
+      void Function(Pointer<ScSendScheduler>, int, int, int)>('sc_send_scheduler_skip');
+
+  late final void Function(Pointer<ScSendScheduler>) sendSchedulerDestroy = _lib.lookupFunction<
+      Void Function(Pointer<ScSendScheduler>),
+      void Function(Pointer<ScSendScheduler>)>('sc_send_scheduler_destroy');
+
+  // ===== Striping over parallel data channels =====
+  late final Pointer<ScStripeScheduler> Function(int) stripeSchedulerCreate = _lib.lookupFunction<
+      Pointer<ScStripeScheduler> Function(Uint32),
+      Pointer<ScStripeScheduler> Function(int)>('sc_stripe_scheduler_create');
+
+  late final int Function(Pointer<ScStripeScheduler>) stripeSchedulerPick = _lib.lookupFunction<
+      Uint32 Function(Pointer<ScStripeScheduler>),
+      int Function(Pointer<ScStripeScheduler>)>('sc_stripe_scheduler_pick');
+
+  late final void Function(Pointer<ScStripeScheduler>, int, int) stripeSchedulerOnSent = _lib.lookupFunction<
+      Void Function(Pointer<ScStripeScheduler>, Uint32, Uint64),
+      void Function(Pointer<ScStripeScheduler>, int, int)>('sc_stripe_scheduler_on_sent');
+
+  late final void Function(Pointer<ScStripeScheduler>, int, int) stripeSchedulerOnConsumed = _lib.lookupFunction<
+      Void Function(Pointer<ScStripeScheduler>, Uint32, Uint64),
+      void Function(Pointer<ScStripeScheduler>, int, int)>('sc_stripe_scheduler_on_consumed');
+
+  late final void Function(Pointer<ScStripeScheduler>) stripeSchedulerDestroy = _lib.lookupFunction<
+      Void Function(Pointer<ScStripeScheduler>),
+      void Function(Pointer<ScStripeScheduler>)>('sc_stripe_scheduler_destroy');
+
+  late final Pointer<ScReassemblyBuffer> Function() reassemblyCreate = _lib.lookupFunction<
+      Pointer<ScReassemblyBuffer> Function(),
+      Pointer<ScReassemblyBuffer> Function()>('sc_reassembly_create');
+
+  late final int Function(Pointer<ScReassemblyBuffer>, int, int) reassemblyAdvance = _lib.lookupFunction<
+      Int32 Function(Pointer<ScReassemblyBuffer>, Uint64, Uint32),
+      int Function(Pointer<ScReassemblyBuffer>, int, int)>('sc_reassembly_advance');
+
+  late final int Function(Pointer<ScReassemblyBuffer>, int, Pointer<Uint8>, int) reassemblyInsert = _lib.lookupFunction<
+      Int32 Function(Pointer<ScReassemblyBuffer>, Uint64, Pointer<Uint8>, Uint32),
+      int Function(Pointer<ScReassemblyBuffer>, int, Pointer<Uint8>, int)>('sc_reassembly_insert');
+
+  late final Pointer<Uint8> Function(Pointer<ScReassemblyBuffer>, Pointer<Uint32>) reassemblyFront = _lib.lookupFunction<
+      Pointer<Uint8> Function(Pointer<ScReassemblyBuffer>, Pointer<Uint32>),
+      Pointer<Uint8> Function(Pointer<ScReassemblyBuffer>, Pointer<Uint32>)>('sc_reassembly_front');
+
+  late final void Function(Pointer<ScReassemblyBuffer>) reassemblyPopFront = _lib.lookupFunction<
+      Void Function(Pointer<ScReassemblyBuffer>),
+      void Function(Pointer<ScReassemblyBuffer>)>('sc_reassembly_pop_front');
+
+  late final int Function(Pointer<ScReassemblyBuffer>) reassemblyHeldBytes = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScReassemblyBuffer>),
+      int Function(Pointer<ScReassemblyBuffer>)>('sc_reassembly_held_bytes');
+
+  late final void Function(Pointer<ScReassemblyBuffer>) reassemblyDestroy = _lib.lookupFunction<
+      Void Function(Pointer<ScReassemblyBuffer>),
+      void Function(Pointer<ScReassemblyBuffer>)>('sc_reassembly_destroy');
+
+  // ===== Content-defined chunking and chunk store =====
+  late final Pointer<ScContentChunker> Function(int, int, int) contentChunkerCreate = _lib.lookupFunction<
+      Pointer<ScContentChunker> Function(Uint32, Uint32, Uint32),
+      Pointer<ScContentChunker> Function(int, int, int)>('sc_content_chunker_create');
+
+  late final int Function(Pointer<ScContentChunker>, Pointer<ScChunkSource>, int, Pointer<Uint32>, Pointer<Uint8>)
+      contentChunkerNext = _lib.lookupFunction<
+          Int32 Function(Pointer<ScContentChunker>, Pointer<ScChunkSource>, Uint64, Pointer<Uint32>, Pointer<Uint8>),
+          int Function(Pointer<ScContentChunker>, Pointer<ScChunkSource>, int, Pointer<Uint32>,
+              Pointer<Uint8>)>('sc_content_chunker_next');
+
+  late final void Function(Pointer<ScContentChunker>) contentChunkerDestroy = _lib.lookupFunction<
+      Void Function(Pointer<ScContentChunker>),
+      void Function(Pointer<ScContentChunker>)>('sc_content_chunker_destroy');
+
+  late final Pointer<ScChunkStore> Function(Pointer<Utf8>, int) chunkStoreOpen = _lib.lookupFunction<
+      Pointer<ScChunkStore> Function(Pointer<Utf8>, Uint64),
+      Pointer<ScChunkStore> Function(Pointer<Utf8>, int)>('sc_chunk_store_open');
+
+  late final int Function(Pointer<ScChunkStore>, Pointer<Uint8>) chunkStoreContains = _lib.lookupFunction<
+      Int32 Function(Pointer<ScChunkStore>, Pointer<Uint8>),
+      int Function(Pointer<ScChunkStore>, Pointer<Uint8>)>('sc_chunk_store_contains');
+
+  late final int Function(Pointer<ScChunkStore>, Pointer<Uint8>) chunkStorePin = _lib.lookupFunction<
+      Int32 Function(Pointer<ScChunkStore>, Pointer<Uint8>),
+      int Function(Pointer<ScChunkStore>, Pointer<Uint8>)>('sc_chunk_store_pin');
+
+  late final void Function(Pointer<ScChunkStore>, Pointer<Uint8>) chunkStoreUnpin = _lib.lookupFunction<
+      Void Function(Pointer<ScChunkStore>, Pointer<Uint8>),
+      void Function(Pointer<ScChunkStore>, Pointer<Uint8>)>('sc_chunk_store_unpin');
+
+  late final int Function(Pointer<ScChunkStore>, Pointer<Uint8>, Pointer<Uint8>, int) chunkStorePut = _lib.lookupFunction<
+      Int32 Function(Pointer<ScChunkStore>, Pointer<Uint8>, Pointer<Uint8>, Uint64),
+      int Function(Pointer<ScChunkStore>, Pointer<Uint8>, Pointer<Uint8>, int)>('sc_chunk_store_put');
+
+  late final int Function(Pointer<ScChunkStore>, Pointer<Uint8>, Pointer<Uint8>, int) chunkStoreGet = _lib.lookupFunction<
+      Int64 Function(Pointer<ScChunkStore>, Pointer<Uint8>, Pointer<Uint8>, Uint64),
+      int Function(Pointer<ScChunkStore>, Pointer<Uint8>, Pointer<Uint8>, int)>('sc_chunk_store_get');
+
+  late final void Function(Pointer<ScChunkStore>) chunkStoreTrim = _lib.lookupFunction<
+      Void Function(Pointer<ScChunkStore>),
+      void Function(Pointer<ScChunkStore>)>('sc_chunk_store_trim');
+
+  late final void Function(Pointer<ScChunkStore>) chunkStoreClose = _lib.lookupFunction<
+      Void Function(Pointer<ScChunkStore>),
+      void Function(Pointer<ScChunkStore>)>('sc_chunk_store_close');
+
+  // ===== Compression =====
+  late final int Function(int) lz4CompressBound = _lib.lookupFunction<
+      Uint64 Function(Uint64),
+      int Function(int)>('sc_lz4_compress_bound');
+
+  late final int Function(Pointer<Uint8>, int, Pointer<Uint8>, int, int) lz4Compress = _lib.lookupFunction<
+      Uint64 Function(Pointer<Uint8>, Uint64, Pointer<Uint8>, Uint64, Int32),
+      int Function(Pointer<Uint8>, int, Pointer<Uint8>, int, int)>('sc_lz4_compress');
+
+  late final int Function(Pointer<Uint8>, int, Pointer<Uint8>, int, int) compressChunk = _lib.lookupFunction<
+      Uint64 Function(Pointer<Uint8>, Uint64, Pointer<Uint8>, Uint64, Int32),
+      int Function(Pointer<Uint8>, int, Pointer<Uint8>, int, int)>('sc_compress_chunk');
+
+  late final int Function(Pointer<Uint8>, int, Pointer<Uint8>, int) lz4Decompress = _lib.lookupFunction<
+      Int32 Function(Pointer<Uint8>, Uint64, Pointer<Uint8>, Uint64),
+      int Function(Pointer<Uint8>, int, Pointer<Uint8>, int)>('sc_lz4_decompress');
+
+  late final double Function(Pointer<Uint8>, int) estimateEntropy = _lib.lookupFunction<
+      Double Function(Pointer<Uint8>, Uint64),
+      double Function(Pointer<Uint8>, int)>('sc_estimate_entropy');
+
+  late final Pointer<ScFileWriter> Function(Pointer<Utf8>, int, int, int) fileWriterOpen = _lib.lookupFunction<
+      Pointer<ScFileWriter> Function(Pointer<Utf8>, Uint64, Uint64, Uint64),
+      Pointer<ScFileWriter> Function(Pointer<Utf8>, int, int, int)>('sc_file_writer_open');
+
+  late final Pointer<ScWriteWorker> Function(int) writeWorkerCreate = _lib.lookupFunction<
+      Pointer<ScWriteWorker> Function(Uint64),
+      Pointer<ScWriteWorker> Function(int)>('sc_write_worker_create');
+
+  late final void Function(Pointer<ScWriteWorker>) writeWorkerDestroy = _lib.lookupFunction<
+      Void Function(Pointer<ScWriteWorker>),
+      void Function(Pointer<ScWriteWorker>)>('sc_write_worker_destroy');
+
+  late final Pointer<ScFileWriter> Function(Pointer<ScWriteWorker>, Pointer<Utf8>, int, int) fileWriterOpenOn =
+      _lib.lookupFunction<
+          Pointer<ScFileWriter> Function(Pointer<ScWriteWorker>, Pointer<Utf8>, Uint64, Uint64),
+          Pointer<ScFileWriter> Function(Pointer<ScWriteWorker>, Pointer<Utf8>, int, int)>('sc_file_writer_open_on');
+
+  late final int Function(Pointer<ScFileWriter>, int, Pointer<Uint8>, int) fileWriterWrite = _lib.lookupFunction<
+      Int32 Function(Pointer<ScFileWriter>, Uint64, Pointer<Uint8>, Uint32),
+      int Function(Pointer<ScFileWriter>, int, Pointer<Uint8>, int)>('sc_file_writer_write');
+
+  late final int Function(Pointer<ScFileWriter>) fileWriterWritten = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScFileWriter>),
+      int Function(Pointer<ScFileWriter>)>('sc_file_writer_written');
+
+  late final int Function(Pointer<ScFileWriter>) fileWriterFailed = _lib.lookupFunction<
+      Int32 Function(Pointer<ScFileWriter>),
+      int Function(Pointer<ScFileWriter>)>('sc_file_writer_failed');
+
+  late final int Function(Pointer<ScFileWriter>) fileWriterClose = _lib.lookupFunction<
+      Int32 Function(Pointer<ScFileWriter>),
+      int Function(Pointer<ScFileWriter>)>('sc_file_writer_close');
+
+  // ===== Logging =====
+  late final Pointer<ScLogger> Function(Pointer<Utf8>, int, int, int) loggerOpen = _lib.lookupFunction<
+      Pointer<ScLogger> Function(Pointer<Utf8>, Uint64, Uint32, Uint32),
+      Pointer<ScLogger> Function(Pointer<Utf8>, int, int, int)>('sc_logger_open');
+
+  // A leaf call: it only copies into the ring, so it skips the VM's
+  // safepoint transition.
+  late final int Function(Pointer<ScLogger>, int, Pointer<Uint8>, int) loggerWrite = _lib.lookupFunction<
+      Int32 Function(Pointer<ScLogger>, Int32, Pointer<Uint8>, Uint32),
+      int Function(Pointer<ScLogger>, int, Pointer<Uint8>, int)>('sc_logger_write', isLeaf: true);
+
+  late final void Function(Pointer<ScLogger>, int) loggerSetLevel = _lib.lookupFunction<
+      Void Function(Pointer<ScLogger>, Int32),
+      void Function(Pointer<ScLogger>, int)>('sc_logger_set_level');
+
+  late final int Function(Pointer<ScLogger>) loggerDropped = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScLogger>),
+      int Function(Pointer<ScLogger>)>('sc_logger_dropped');
+
+  late final void Function(Pointer<ScLogger>) loggerFlush = _lib.lookupFunction<
+      Void Function(Pointer<ScLogger>),
+      void Function(Pointer<ScLogger>)>('sc_logger_flush');
+
+  late final void Function(Pointer<ScLogger>) loggerClose = _lib.lookupFunction<
+      Void Function(Pointer<ScLogger>),
+      void Function(Pointer<ScLogger>)>('sc_logger_close');
+
+  // ===== Tracing =====
+  late final Pointer<ScTracer> Function(int) tracerCreate = _lib.lookupFunction<
+      Pointer<ScTracer> Function(Uint32),
+      Pointer<ScTracer> Function(int)>('sc_tracer_create');
+
+  // Leaf calls: a clock read and a copy into the ring.
+  late final int Function() tracerNowNs = _lib.lookupFunction<
+      Int64 Function(),
+      int Function()>('sc_tracer_now_ns', isLeaf: true);
+
+  late final void Function(Pointer<ScTracer>, Pointer<Uint8>, int, int, int, int) tracerRecord = _lib.lookupFunction<
+      Void Function(Pointer<ScTracer>, Pointer<Uint8>, Uint32, Uint64, Int64, Int64),
+      void Function(Pointer<ScTracer>, Pointer<Uint8>, int, int, int, int)>('sc_tracer_record', isLeaf: true);
+
+  late final int Function(Pointer<ScTracer>) tracerRecorded = _lib.lookupFunction<
+      Uint64 Function(Pointer<ScTracer>),
+      int Function(Pointer<ScTracer>)>('sc_tracer_recorded');
+
+  late final int Function(Pointer<ScTracer>, Pointer<Utf8>, int) tracerWriteChromeTrace = _lib.lookupFunction<
+      Int32 Function(Pointer<ScTracer>, Pointer<Utf8>, Uint32),
+      int Function(Pointer<ScTracer>, Pointer<Utf8>, int)>('sc_tracer_write_chrome_trace');
+
+  late final void Function(Pointer<ScTracer>) tracerDestroy = _lib.lookupFunction<
+      Void Function(Pointer<ScTracer>),
+      void Function(Pointer<ScTracer>)>('sc_tracer_destroy');
+}
@@ -0,0 +1,143 @@
+import 'dart:ffi';
+import 'dart:math' as math;
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+
+/// One chunk picked by [SendScheduler].
+class ScheduledChunk {
+  final int fileIndex;
+  final int offset;
+  final int length;
+
+  /// First chunk of the file: open it.
+  final bool first;
+
+  /// Last chunk of the file: send its file_end.
+  final bool last;
+
+  const ScheduledChunk(this.fileIndex, this.offset, this.length, {required this.first, required this.last});
+}
+
+/// Picks the order in which a session's file chunks are sent.
+///
+/// Up to [maxActive] files stream at once, one chunk from each in turn, and
+/// the next file starts as soon as an active one finishes, so files no longer
+/// wait on a per-file round trip. See sc::SendScheduler in
+/// windows/runner/native/send_scheduler.h; without sc_native the same policy
+/// runs in Dart.
+class SendScheduler {
+  static const int defaultMaxActive = 4;
+
+  final ScNative? _native;
+  Pointer<ScSendScheduler> _handle = nullptr;
+  Pointer<ScScheduledChunk> _chunk = nullptr;
+
+  // Dart fallback state: [fileIndex, extent, offset, started] per active
+  // file, and the [offset, end) ranges still to send per file.
+  final List<int> _sizes;
+  final List<List<List<int>>> _extents;
+  final int _chunkSize;
+  final int _maxActive;
+  final List<List<int>> _active = [];
+  int _cursor = 0;
+  int _nextFile = 0;
+
+  SendScheduler(List<int> fileSizes, int chunkSize, {int maxActive = defaultMaxActive})
+      : _native = ScNative.instance,
+        _sizes = List<int>.unmodifiable(fileSizes),
+        _extents = [
+          for (final size in fileSizes)
+            [
+              [0, size]
+            ]
+        ],
+        _chunkSize = math.max(chunkSize, 1),
+        _maxActive = math.max(maxActive, 1) {
+    final native = _native;
+    if (native == null) return;
+    final sizes = calloc<Uint64>(math.max(fileSizes.length, 1));
+    try {
+      sizes.asTypedList(fileSizes.length).setAll(0, fileSizes);
+      _handle = native.sendSchedulerCreate(sizes, fileSizes.length, chunkSize, maxActive);
+    } finally {
+      calloc.free(sizes);
+    }
+    _chunk = calloc<ScScheduledChunk>();
+  }
+
+  /// Leaves [length] bytes at [offset] of a file out of the schedule, for data
+  /// the receiver already has. Call before [next] first reaches the file. A
+  /// file with nothing left to send still yields one empty chunk, flagged
+  /// first and last, so its file_end is sent.
+  void skip(int fileIndex, int offset, int length) {
+    final native = _native;
+    if (native != null) {
+      if (_handle == nullptr) throw StateError('SendScheduler is disposed');
+      native.sendSchedulerSkip(_handle, fileIndex, offset, length);
+      return;
+    }
+    if (fileIndex < _nextFile || fileIndex >= _extents.length || length <= 0) return;
+    final end = offset + length;
+    final remaining = <List<int>>[];
+    for (final extent in _extents[fileIndex]) {
+      if (extent[1] <= offset || extent[0] >= end) {
+        remaining.add(extent);
+        continue;
+      }
+      if (extent[0] < offset) remaining.add([extent[0], offset]);
+      if (extent[1] > end) remaining.add([end, extent[1]]);
+    }
+    _extents[fileIndex] = remaining;
+  }
+
+  /// Returns the next chunk, or null once every file has been scheduled.
+  ScheduledChunk? next() {
+    final native = _native;
+    if (native != null) {
+      if (_handle == nullptr) throw StateError('SendScheduler is disposed');
+      if (native.sendSchedulerNext(_handle, _chunk) == 0) return null;
+      final c = _chunk.ref;
+      return ScheduledChunk(c.fileIndex, c.offset, c.length,
+          first: c.flags & ScNative.scheduledChunkFirst != 0, last: c.flags & ScNative.scheduledChunkLast != 0);
+    }
+    while (_active.length < _maxActive && _nextFile < _sizes.length) {
+      final extents = _extents[_nextFile];
+      _active.add([_nextFile++, 0, extents.isEmpty ? 0 : extents.first[0], 0]);
+    }
+    if (_active.isEmpty) return null;
+    if (_cursor >= _active.length) _cursor = 0;
+    final file = _active[_cursor];
+    final extents = _extents[file[0]];
+    final offset = file[2];
+    final first = file[3] == 0;
+    file[3] = 1;
+    var length = 0;
+    if (file[1] < extents.length) {
+      final extent = extents[file[1]];
+      length = math.min(_chunkSize, extent[1] - offset);
+      file[2] = offset + length;
+      if (file[2] >= extent[1] && ++file[1] < extents.length) {
+        file[2] = extents[file[1]][0];
+      }
+    }
+    final last = file[1] >= extents.length;
+    if (last) {
+      _active.removeAt(_cursor);
+    } else {
+      _cursor++;
+    }
+    return ScheduledChunk(file[0], offset, length, first: first, last: last);
+  }
+
+  void dispose() {
+    if (_handle != nullptr) {
+      _native!.sendSchedulerDestroy(_handle);
+      _handle = nullptr;
+    }
+    if (_chunk != nullptr) {
+      calloc.free(_chunk);
+      _chunk = nullptr;
+    }
+  }
+}
@@ -0,0 +1,109 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:crypto/crypto.dart';
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+
+/// Incremental SHA-256 that is fed chunk by chunk as a file streams in, so
+/// the receiver never reads the file back just to verify it.
+///
+/// Uses sc_native's hasher (SHA-NI when the CPU has it) when the library is
+/// loaded, and package:crypto's chunked conversion otherwise. Both produce
+/// the same lower-case hex digest as `sha256.convert(bytes).toString()`.
+class StreamingSha256 {
+  final ScNative? _native;
+  Pointer<ScSha256> _handle = nullptr;
+  Pointer<Uint8> _scratch = nullptr;
+  int _scratchSize = 0;
+
+  _DigestSink? _sink;
+  ByteConversionSink? _input;
+
+  StreamingSha256() : _native = ScNative.instance {
+    final native = _native;
+    if (native != null) {
+      _handle = native.sha256Create();
+    } else {
+      final sink = _DigestSink();
+      _sink = sink;
+      _input = sha256.startChunkedConversion(sink);
+    }
+  }
+
+  void add(Uint8List bytes) {
+    if (bytes.isEmpty) return;
+    final native = _native;
+    if (native != null) {
+      if (_handle == nullptr) throw StateError('StreamingSha256 is closed');
+      // Dart heap memory cannot be handed to native code directly, so each
+      // chunk goes through one reusable native buffer.
+      if (_scratchSize < bytes.length) {
+        if (_scratch != nullptr) calloc.free(_scratch);
+        _scratch = calloc<Uint8>(bytes.length);
+        _scratchSize = bytes.length;
+      }
+      _scratch.asTypedList(bytes.length).setAll(0, bytes);
+      native.sha256Update(_handle, _scratch, bytes.length);
+      return;
+    }
+    final input = _input;
+    if (input == null) throw StateError('StreamingSha256 is closed');
+    input.add(bytes);
+  }
+
+  /// Returns the hex digest of everything added and releases the hasher.
+  String close() {
+    final native = _native;
+    if (native != null) {
+      if (_handle == nullptr) throw StateError('StreamingSha256 is closed');
+      final out = calloc<Uint8>(ScNative.sha256DigestSize);
+      try {
+        native.sha256Finish(_handle, out);
+        return digestToHex(out.asTypedList(ScNative.sha256DigestSize));
+      } finally {
+        calloc.free(out);
+        dispose();
+      }
+    }
+    final input = _input;
+    if (input == null) throw StateError('StreamingSha256 is closed');
+    input.close();
+    _input = null;
+    return _sink!.value.toString();
+  }
+
+  /// Releases native resources without producing a digest.
+  void dispose() {
+    if (_handle != nullptr) {
+      _native!.sha256Destroy(_handle);
+      _handle = nullptr;
+    }
+    if (_scratch != nullptr) {
+      calloc.free(_scratch);
+      _scratch = nullptr;
+      _scratchSize = 0;
+    }
+    _input = null;
+  }
+
+  static String digestToHex(List<int> digest) {
+    final buffer = StringBuffer();
+    for (final b in digest) {
+      buffer.write(b.toRadixString(16).padLeft(2, '0'));
+    }
+    return buffer.toString();
+  }
+}
+
+class _DigestSink implements Sink<Digest> {
+  late Digest value;
+
+  @override
+  void add(Digest data) {
+    value = data;
+  }
+
+  @override
+  void close() {}
+}
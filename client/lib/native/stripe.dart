@@ -0,0 +1,208 @@
+import 'dart:collection';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:shared_clipboard/native/sc_native.dart';
+
+/// Picks which of a session's parallel data channels carries the next frame.
+///
+/// Each frame goes to the channel with the least data in flight (sent but not
+/// yet reported consumed by the receiver), so a channel stalled behind a lost
+/// SCTP packet stops taking new frames until it drains. See
+/// sc::StripeScheduler in windows/runner/native/stripe.h; without sc_native
+/// the same policy runs in Dart.
+class StripeScheduler {
+  final ScNative? _native;
+  Pointer<ScStripeScheduler> _handle = nullptr;
+
+  final int channelCount;
+  final List<int> _sent;
+  final List<int> _consumed;
+  int _next = 0;
+
+  StripeScheduler(int channelCount)
+      : _native = ScNative.instance,
+        channelCount = channelCount < 1 ? 1 : channelCount,
+        _sent = List<int>.filled(channelCount < 1 ? 1 : channelCount, 0),
+        _consumed = List<int>.filled(channelCount < 1 ? 1 : channelCount, 0) {
+    _handle = _native?.stripeSchedulerCreate(this.channelCount) ?? nullptr;
+  }
+
+  /// Channel index for the next frame.
+  int pick() {
+    final native = _native;
+    if (native != null) return native.stripeSchedulerPick(_handle);
+    var best = _next;
+    for (var i = 0; i < channelCount; i++) {
+      final channel = (_next + i) % channelCount;
+      if (_inFlight(channel) < _inFlight(best)) best = channel;
+    }
+    _next = (best + 1) % channelCount;
+    return best;
+  }
+
+  void onSent(int channel, int bytes) {
+    final native = _native;
+    if (native != null) {
+      native.stripeSchedulerOnSent(_handle, channel, bytes);
+    } else if (channel >= 0 && channel < channelCount) {
+      _sent[channel] += bytes;
+    }
+  }
+
+  /// Applies the receiver's cumulative [consumed] count for [channel].
+  void onConsumed(int channel, int consumed) {
+    final native = _native;
+    if (native != null) {
+      native.stripeSchedulerOnConsumed(_handle, channel, consumed);
+    } else if (channel >= 0 && channel < channelCount && consumed > _consumed[channel]) {
+      _consumed[channel] = consumed > _sent[channel] ? _sent[channel] : consumed;
+    }
+  }
+
+  int _inFlight(int channel) => _sent[channel] - _consumed[channel];
+
+  void dispose() {
+    if (_handle != nullptr) {
+      _native!.stripeSchedulerDestroy(_handle);
+      _handle = nullptr;
+    }
+  }
+}
+
+/// Puts one file's chunks back in offset order.
+///
+/// Chunks striped over several channels can arrive out of order. [accept]
+/// returns the bytes that became contiguous, in order, and holds the rest
+/// until the gap before them fills. A chunk that overlaps data already seen
+/// throws a [StateError]. See sc::ReassemblyBuffer in
+/// windows/runner/native/stripe.h; without sc_native the same logic runs in
+/// Dart.
+class FileReassembler {
+  final ScNative? _native;
+  Pointer<ScReassemblyBuffer> _handle = nullptr;
+  Pointer<Uint32> _length = nullptr;
+
+  final SplayTreeMap<int, Uint8List> _held = SplayTreeMap<int, Uint8List>();
+  int _heldBytes = 0;
+  int _next = 0;
+
+  FileReassembler() : _native = ScNative.instance {
+    final native = _native;
+    if (native == null) return;
+    _handle = native.reassemblyCreate();
+    _length = calloc<Uint32>();
+  }
+
+  /// Next offset expected in order.
+  int get nextOffset => _next;
+
+  /// Bytes held back waiting for a gap to fill.
+  int get heldBytes {
+    final native = _native;
+    if (native != null) return native.reassemblyHeldBytes(_handle);
+    return _heldBytes;
+  }
+
+  /// Treats everything before [offset] as already delivered, for a transfer
+  /// that resumes part way through the file. Call before the first [accept].
+  void start(int offset) {
+    final native = _native;
+    if (native != null) {
+      // The native call takes 32-bit lengths.
+      for (var at = _next; at < offset; at += 1 << 30) {
+        final step = offset - at < 1 << 30 ? offset - at : 1 << 30;
+        native.reassemblyAdvance(_handle, at, step);
+      }
+    }
+    _next = offset;
+  }
+
+  /// Accepts the chunk at [offset]; returns the chunks now deliverable in
+  /// order (possibly none).
+  List<Uint8List> accept(int offset, Uint8List bytes) {
+    final native = _native;
+    if (native != null) return _acceptNative(native, offset, bytes);
+
+    if (offset == _next && (_held.isEmpty || _held.firstKey()! >= offset + bytes.length)) {
+      _next += bytes.length;
+      if (_held.isEmpty || _held.firstKey() != _next) return [bytes];
+      return [bytes, ..._drain()];
+    }
+    _checkOverlap(offset, bytes.length);
+    _held[offset] = bytes;
+    _heldBytes += bytes.length;
+    return _drain();
+  }
+
+  List<Uint8List> _acceptNative(ScNative native, int offset, Uint8List bytes) {
+    if (native.reassemblyAdvance(_handle, offset, bytes.length) != 0) {
+      _next += bytes.length;
+      if (native.reassemblyHeldBytes(_handle) == 0) return [bytes];
+      return [bytes, ..._drainNative(native)];
+    }
+    final data = calloc<Uint8>(bytes.isEmpty ? 1 : bytes.length);
+    try {
+      data.asTypedList(bytes.length).setAll(0, bytes);
+      if (native.reassemblyInsert(_handle, offset, data, bytes.length) != 0) {
+        throw StateError('Chunk at offset $offset overlaps received data');
+      }
+    } finally {
+      calloc.free(data);
+    }
+    return _drainNative(native);
+  }
+
+  List<Uint8List> _drainNative(ScNative native) {
+    final out = <Uint8List>[];
+    while (true) {
+      final front = native.reassemblyFront(_handle, _length);
+      if (front == nullptr) break;
+      final length = _length.value;
+      out.add(Uint8List.fromList(front.asTypedList(length)));
+      native.reassemblyPopFront(_handle);
+      _next += length;
+    }
+    return out;
+  }
+
+  List<Uint8List> _drain() {
+    final out = <Uint8List>[];
+    while (_held.isNotEmpty && _held.firstKey() == _next) {
+      final chunk = _held.remove(_next)!;
+      _heldBytes -= chunk.length;
+      _next += chunk.length;
+      out.add(chunk);
+    }
+    return out;
+  }
+
+  void _checkOverlap(int offset, int length) {
+    final end = offset + length;
+    if (offset < _next) {
+      throw StateError('Chunk at offset $offset was already received');
+    }
+    final before = _held.lastKeyBefore(offset + 1);
+    if (before != null && before + _held[before]!.length > offset) {
+      throw StateError('Chunk at offset $offset overlaps received data');
+    }
+    final after = _held.firstKeyAfter(offset);
+    if (after != null && after < end) {
+      throw StateError('Chunk at offset $offset overlaps received data');
+    }
+  }
+
+  void dispose() {
+    if (_handle != nullptr) {
+      _native!.reassemblyDestroy(_handle);
+      _handle = nullptr;
+    }
+    if (_length != nullptr) {
+      calloc.free(_length);
+      _length = nullptr;
+    }
+    _held.clear();
+    _heldBytes = 0;
+  }
+}
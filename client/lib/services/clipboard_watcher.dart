@@ -0,0 +1,97 @@
+import 'dart:async';
+import 'dart:io';
+
+import 'package:flutter/services.dart';
+import 'package:shared_clipboard/core/logger.dart';
+
+/// The clipboard as the native watcher last read it.
+class ClipboardSnapshot {
+  final int sequence;
+
+  /// 'text', 'files' or 'empty'.
+  final String kind;
+
+  /// SHA-256 of the kind and content, in hex; equal digests mean equal
+  /// content.
+  final String digest;
+
+  /// Only in snapshots from [ClipboardWatcher.current].
+  final String? text;
+  final int textLength;
+  final List<String> files;
+
+  ClipboardSnapshot._(this.sequence, this.kind, this.digest, this.text, this.textLength, this.files);
+
+  factory ClipboardSnapshot._fromMap(Map<dynamic, dynamic> map) {
+    return ClipboardSnapshot._(
+      map['sequence'] as int,
+      map['kind'] as String,
+      map['digest'] as String,
+      map['text'] as String?,
+      map['textLength'] as int? ?? 0,
+      (map['files'] as List<dynamic>? ?? const []).cast<String>(),
+    );
+  }
+
+  bool get isFiles => kind == 'files';
+  bool get isText => kind == 'text';
+}
+
+/// Clipboard changes as the runner's ClipboardWatcherPlugin sees them
+/// (windows/runner/clipboard_watcher_plugin.h), read and digested natively
+/// in the background as soon as something is copied.
+///
+/// Only the Windows runner has the watcher; elsewhere [available] is false
+/// and callers read the clipboard on demand.
+class ClipboardWatcher {
+  static const MethodChannel _channel = MethodChannel('clipboard_watcher');
+  static final ClipboardWatcher instance = ClipboardWatcher._();
+
+  final AppLogger _logger = logTag('CLIP_WATCH');
+  final StreamController<ClipboardSnapshot> _changes = StreamController.broadcast();
+  bool _started = false;
+
+  ClipboardWatcher._();
+
+  bool get available => Platform.isWindows;
+
+  /// Snapshots of new clipboard content, without their text.
+  Stream<ClipboardSnapshot> get changes {
+    _start();
+    return _changes.stream;
+  }
+
+  /// The snapshot of what the clipboard holds now, text included, or null
+  /// if the watcher has not caught up with it (or is not available).
+  Future<ClipboardSnapshot?> current() async {
+    if (!available) return null;
+    _start();
+    try {
+      final result = await _channel.invokeMethod<Map<dynamic, dynamic>>('current');
+      return result == null ? null : ClipboardSnapshot._fromMap(result);
+    } on MissingPluginException {
+      return null;
+    } on PlatformException catch (e) {
+      _logger.w('Clipboard snapshot failed', e.toString());
+      return null;
+    }
+  }
+
+  void _start() {
+    if (_started || !available) return;
+    _started = true;
+    _channel.setMethodCallHandler((call) async {
+      if (call.method == 'changed' && call.arguments is Map) {
+        final snapshot = ClipboardSnapshot._fromMap(call.arguments as Map<dynamic, dynamic>);
+        _logger.d('Clipboard changed', {
+          'sequence': snapshot.sequence,
+          'kind': snapshot.kind,
+          'files': snapshot.files.length,
+          'textLength': snapshot.textLength,
+        });
+        _changes.add(snapshot);
+      }
+      return null;
+    });
+  }
+}
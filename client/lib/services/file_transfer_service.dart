@@ -1,10 +1,10 @@
+import 'dart:async';
 import 'dart:convert';
 import 'dart:io';
-import 'package:crypto/crypto.dart';
 import 'package:mime/mime.dart';
 import 'package:flutter/services.dart';
 import 'package:file_picker/file_picker.dart';
-import 'package:shared_clipboard/services/windows_clipboard_debug.dart';
+import 'package:shared_clipboard/services/clipboard_watcher.dart';
 import 'package:shared_clipboard/services/windows_file_clipboard.dart';
 import 'package:shared_clipboard/services/native_file_clipboard.dart';
 import 'package:shared_clipboard/core/logger.dart';
@@ -13,6 +13,29 @@ import 'package:shared_clipboard/core/logger.dart';
 class FileTransferService {
   static const int maxFileSize = 1000000 * 1024 * 1024; // 50MB limit for safety
   final AppLogger _logger = logTag('FILE_TRANSFER');
+
+  // Files checked when they were copied (see ClipboardWatcher), for the
+  // snapshot with this digest, so a share of them starts straight away.
+  static String? _stagedDigest;
+  static Future<ClipboardContent>? _stagedFiles;
+  static StreamSubscription<ClipboardSnapshot>? _clipboardChanges;
+
+  /// Starts checking files as they are copied, where the native clipboard
+  /// watcher is available.
+  static void watchClipboard() {
+    final watcher = ClipboardWatcher.instance;
+    if (!watcher.available || _clipboardChanges != null) return;
+    final service = FileTransferService();
+    _clipboardChanges = watcher.changes.listen((snapshot) {
+      if (snapshot.isFiles) {
+        _stagedDigest = snapshot.digest;
+        _stagedFiles = service._processFilePaths(snapshot.files.join('\n'));
+      } else {
+        _stagedDigest = null;
+        _stagedFiles = null;
+      }
+    });
+  }
   
   // Helper function for timestamped logging
   void _log(String message, [dynamic data]) {
@@ -40,9 +63,8 @@ class FileTransferService {
       // We need to check platform-specific clipboard formats
       if (Platform.isWindows) {
         _log('🪟 CHECKING WINDOWS FILE CLIPBOARD');
-        // For now, we'll try a different approach - check if clipboard is empty of text
-        // but might contain files (this is a limitation of the basic Clipboard API)
-        return false; // We'll handle this in getClipboardContent
+        final filePaths = await WindowsFileClipboard.getFilePaths();
+        return filePaths != null && filePaths.isNotEmpty;
       }
       
       return false;
@@ -54,6 +76,9 @@ class FileTransferService {
 
   // Check if text contains file paths
   bool _looksLikeFilePaths(String text) {
+    // Ten paths of the longest Windows allows; don't split a large paste
+    // just to find it has too many lines
+    if (text.length > 10 * 32768) return false;
     final lines = text.split('\n').map((e) => e.trim()).where((e) => e.isNotEmpty).toList();
     
     _log('🔍 ANALYZING TEXT FOR FILE PATHS', {
@@ -124,9 +149,25 @@ class FileTransferService {
         }
       }
       
-      // First, let's investigate what's actually in the Windows clipboard
+      // On Windows, start from the watcher's snapshot while it is current
+      final snapshot = await ClipboardWatcher.instance.current();
+      if (snapshot != null) {
+        final content = await _contentFromSnapshot(snapshot);
+        if (content != null) return content;
+      }
+
+      // On Windows, read files and text in one clipboard open
       if (Platform.isWindows) {
-        WindowsClipboardDebug.investigateClipboard();
+        final formats = await WindowsFileClipboard.read(
+            WindowsFileClipboard.bit(WindowsFileClipboard.formatFiles) |
+                WindowsFileClipboard.bit(WindowsFileClipboard.formatText));
+        if (formats != null) {
+          _log('🪟 WINDOWS CLIPBOARD FORMATS', formats.summary);
+          if (formats.files.isNotEmpty) {
+            return await _processFilePaths(formats.files.join('\n'));
+          }
+          return await _contentFromText(formats.text);
+        }
       }
       
       final clipboardData = await Clipboard.getData(Clipboard.kTextPlain);
@@ -144,7 +185,7 @@ class FileTransferService {
         // On Windows, check if files are available in CF_HDROP format
         if (Platform.isWindows) {
           _log('🪟 WINDOWS: CHECKING FOR FILES IN CF_HDROP FORMAT');
-          final filePaths = WindowsFileClipboard.getFilePaths();
+          final filePaths = await WindowsFileClipboard.getFilePaths();
           
           if (filePaths != null && filePaths.isNotEmpty) {
             _log('✅ FOUND FILES IN WINDOWS CLIPBOARD', filePaths);
@@ -158,7 +199,52 @@ class FileTransferService {
         return ClipboardContent.text('');
       }
       
-      final text = clipboardData.text!;
+      return await _contentFromText(clipboardData.text!);
+    } catch (e) {
+      _log('❌ ERROR READING CLIPBOARD', e.toString());
+      return ClipboardContent.text('');
+    }
+  }
+
+  // Content for a watcher snapshot, or null to read the clipboard instead
+  Future<ClipboardContent?> _contentFromSnapshot(ClipboardSnapshot snapshot) async {
+    _log('⚡ USING CLIPBOARD SNAPSHOT', {'sequence': snapshot.sequence, 'kind': snapshot.kind});
+    if (snapshot.isFiles) {
+      final staged = _stagedDigest == snapshot.digest ? _stagedFiles : null;
+      var content = await (staged ?? _processFilePaths(snapshot.files.join('\n')));
+      // The digest covers the paths only: a file edited since it was copied
+      // must be checked again, or the send fails on its old size.
+      if (staged != null && !await _stillStaged(content)) {
+        _log('♻️ STAGED FILES CHANGED SINCE COPY, RECHECKING');
+        if (identical(_stagedFiles, staged)) {
+          _stagedDigest = null;
+          _stagedFiles = null;
+        }
+        content = await _processFilePaths(snapshot.files.join('\n'));
+      }
+      return content.isFiles ? content : null;
+    }
+    if (snapshot.isText && snapshot.text != null) {
+      return _contentFromText(snapshot.text!);
+    }
+    return ClipboardContent.text('');
+  }
+
+  // Whether the staged files are still regular files of the staged sizes
+  Future<bool> _stillStaged(ClipboardContent content) async {
+    for (final file in content.files) {
+      try {
+        final stat = await File(file.path).stat();
+        if (stat.type != FileSystemEntityType.file || stat.size != file.size) return false;
+      } catch (_) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  Future<ClipboardContent> _contentFromText(String text) async {
+    try {
       _log('📋 CLIPBOARD TEXT CONTENT', text.length > 100 ? '${text.substring(0, 100)}...' : text);
       
       // Check if it's file paths (works on Windows and macOS when paths are in text)
@@ -201,6 +287,10 @@ class FileTransferService {
         
         try {
           final stat = await file.stat();
+          if (stat.type != FileSystemEntityType.file) {
+            _log('⚠️ NOT A REGULAR FILE, SKIPPING', filePath);
+            continue;
+          }
           if (stat.size > maxFileSize) {
             _log('⚠️ FILE TOO LARGE, SKIPPING', '$filePath (${stat.size} bytes)');
             continue;
@@ -208,9 +298,8 @@ class FileTransferService {
           
           _log('📄 PROCESSING FILE', '$filePath (${stat.size} bytes)');
           
-          final bytes = await file.readAsBytes();
+          // Contents are streamed from disk at send time rather than read here
           final mimeType = lookupMimeType(file.path) ?? 'application/octet-stream';
-          final checksum = sha256.convert(bytes).toString();
           
           // Get just the filename for cross-platform compatibility
           final fileName = file.path.split(Platform.pathSeparator).last;
@@ -220,8 +309,7 @@ class FileTransferService {
             path: file.path,
             size: stat.size,
             mimeType: mimeType,
-            checksum: checksum,
-            content: bytes,
+            checksum: '',
           ));
           
           _log('✅ FILE PROCESSED', '$fileName ($mimeType)');
@@ -360,17 +448,15 @@ class FileTransferService {
         
         _log('📄 PROCESSING SELECTED FILE', '${platformFile.name} (${stat.size} bytes)');
         
-        final bytes = await file.readAsBytes();
+        // Contents are streamed from disk at send time rather than read here
         final mimeType = lookupMimeType(file.path) ?? 'application/octet-stream';
-        final checksum = sha256.convert(bytes).toString();
         
         files.add(FileData(
           name: platformFile.name,
           path: file.path,
           size: stat.size,
           mimeType: mimeType,
-          checksum: checksum,
-          content: bytes,
+          checksum: '',
         ));
         
         _log('✅ SELECTED FILE PROCESSED', '${platformFile.name} ($mimeType)');
@@ -413,7 +499,9 @@ class FileData {
   final int size;
   final String mimeType;
   final String checksum;
-  final Uint8List content;
+  // In-memory contents; only set for files received in a legacy JSON payload.
+  // Local files are streamed from [path] instead of being loaded here.
+  final Uint8List? content;
 
   FileData({
     required this.name,
@@ -421,7 +509,7 @@ class FileData {
     required this.size,
     required this.mimeType,
     required this.checksum,
-    required this.content,
+    this.content,
   });
 
   Map<String, dynamic> toJson() {
@@ -431,18 +519,19 @@ class FileData {
       'size': size,
       'mimeType': mimeType,
       'checksum': checksum,
-      'content': base64Encode(content),
+      if (content != null) 'content': base64Encode(content!),
     };
   }
 
   static FileData fromJson(Map<String, dynamic> json) {
+    final encoded = json['content'] as String?;
     return FileData(
       name: json['name'],
       path: json['path'],
       size: json['size'],
       mimeType: json['mimeType'],
       checksum: json['checksum'],
-      content: base64Decode(json['content']),
+      content: encoded != null ? base64Decode(encoded) : null,
     );
   }
   
@@ -81,7 +81,12 @@ class NativeFileClipboard {
       for (var fileData in files) {
         final filePath = '${clipboardDir.path}/${fileData.name}';
         final file = File(filePath);
-        await file.writeAsBytes(fileData.content);
+        final content = fileData.content;
+        if (content != null) {
+          await file.writeAsBytes(content);
+        } else {
+          await File(fileData.path).copy(filePath);
+        }
         filePaths.add(filePath);
         _log('✅ FILE WRITTEN FOR CLIPBOARD', '${fileData.name} at $filePath');
       }
@@ -8,9 +8,23 @@ class SettingsService with ChangeNotifier {
 
   static const _kDisplayPipKey = 'display_download_progress_indicator';
   static const _kSendProgressNotificationsKey = 'send_download_progress_notifications';
+  static const _kParallelDataChannelsKey = 'parallel_data_channels';
+  static const _kDeduplicateTransfersKey = 'deduplicate_transfers';
+  static const _kCompressTransfersKey = 'compress_transfers';
+  static const _kDeviceGroupKey = 'device_group';
+
+  /// Longest device group the signaling server accepts.
+  static const int maxDeviceGroupLength = 128;
+
+  /// Data channel counts offered in settings; 1 keeps a single channel.
+  static const List<int> parallelDataChannelOptions = [1, 2, 4, 8];
 
   bool _displayPip = true;
   bool _sendProgressNotifications = true;
+  int _parallelDataChannels = 1;
+  bool _deduplicateTransfers = true;
+  bool _compressTransfers = true;
+  String _deviceGroup = '';
   bool _initialized = false;
 
   bool get isInitialized => _initialized;
@@ -33,11 +47,63 @@ class SettingsService with ChangeNotifier {
     }
   }
 
+  /// Data channels used to stripe outgoing files. More than one helps on
+  /// lossy high-latency links, where a single ordered channel stalls behind
+  /// every retransmission.
+  int get parallelDataChannels => _parallelDataChannels;
+  set parallelDataChannels(int value) {
+    if (!parallelDataChannelOptions.contains(value)) return;
+    if (_parallelDataChannels != value) {
+      _parallelDataChannels = value;
+      _saveInt(_kParallelDataChannelsKey, value);
+      notifyListeners();
+    }
+  }
+
+  /// Skip file chunks the receiver already holds from earlier transfers.
+  bool get deduplicateTransfers => _deduplicateTransfers;
+  set deduplicateTransfers(bool value) {
+    if (_deduplicateTransfers != value) {
+      _deduplicateTransfers = value;
+      _saveBool(_kDeduplicateTransfersKey, value);
+      notifyListeners();
+    }
+  }
+
+  /// Compress text and compressible files on the fly when the receiver
+  /// supports it. Media and archives are always sent as they are.
+  bool get compressTransfers => _compressTransfers;
+  set compressTransfers(bool value) {
+    if (_compressTransfers != value) {
+      _compressTransfers = value;
+      _saveBool(_kCompressTransfersKey, value);
+      notifyListeners();
+    }
+  }
+
+  /// Pairing group sent to the signaling server. Devices only see and share
+  /// with devices in the same group; empty joins the default group.
+  String get deviceGroup => _deviceGroup;
+  set deviceGroup(String value) {
+    final group = value.trim();
+    if (group.length > maxDeviceGroupLength) return;
+    if (_deviceGroup != group) {
+      _deviceGroup = group;
+      _saveString(_kDeviceGroupKey, group);
+      notifyListeners();
+    }
+  }
+
   Future<void> init() async {
     if (_initialized) return;
     final prefs = await SharedPreferences.getInstance();
     _displayPip = prefs.getBool(_kDisplayPipKey) ?? true;
     _sendProgressNotifications = prefs.getBool(_kSendProgressNotificationsKey) ?? true;
+    final channels = prefs.getInt(_kParallelDataChannelsKey) ?? 1;
+    _parallelDataChannels = parallelDataChannelOptions.contains(channels) ? channels : 1;
+    _deduplicateTransfers = prefs.getBool(_kDeduplicateTransfersKey) ?? true;
+    _compressTransfers = prefs.getBool(_kCompressTransfersKey) ?? true;
+    _deviceGroup = (prefs.getString(_kDeviceGroupKey) ?? '').trim();
     _initialized = true;
     notifyListeners();
   }
@@ -46,4 +112,14 @@ class SettingsService with ChangeNotifier {
     final prefs = await SharedPreferences.getInstance();
     await prefs.setBool(key, value);
   }
+
+  Future<void> _saveInt(String key, int value) async {
+    final prefs = await SharedPreferences.getInstance();
+    await prefs.setInt(key, value);
+  }
+
+  Future<void> _saveString(String key, String value) async {
+    final prefs = await SharedPreferences.getInstance();
+    await prefs.setString(key, value);
+  }
 }
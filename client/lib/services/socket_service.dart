@@ -1,8 +1,10 @@
 import 'package:socket_io_client/socket_io_client.dart' as io;
 import 'package:shared_clipboard/services/webrtc_service.dart';
 import 'package:shared_clipboard/services/notification_service.dart';
+import 'package:shared_clipboard/services/settings_service.dart';
 import 'dart:io';
 import 'package:shared_clipboard/core/logger.dart';
+import 'package:shared_clipboard/core/tracing.dart';
 
 class SocketService {
   late io.Socket socket;
@@ -14,6 +16,17 @@ class SocketService {
   Function(Map<String, dynamic> device)? onDeviceDisconnected;
   Function(List<Map<String, dynamic>> devices)? onConnectedDevicesList;
 
+  // Device list kept from 'device-snapshot' and 'device-delta', by id, and
+  // the version it is at. -1 until a snapshot arrives; servers without
+  // device-list deltas never send one, and get the old discovery requests.
+  final Map<String, Map<String, dynamic>> _devices = {};
+  int _deviceListVersion = -1;
+  bool _deviceSyncRequested = false;
+
+  // Device group this connection registered with. The server only lists
+  // and pairs devices within a group, so changing it means reconnecting.
+  String _deviceGroup = '';
+
   // Helper function for timestamped logging
   void _log(String message, [dynamic data]) {
     if (data != null) {
@@ -51,12 +64,18 @@ class SocketService {
       _log('❌ SOCKET ERROR', error.toString());
     });
 
+    _deviceGroup = SettingsService.instance.deviceGroup;
+    SettingsService.instance.addListener(_onSettingsChanged);
+
     _log('🔌 ATTEMPTING TO CONNECT');
     socket.connect();
 
     socket.onConnect((_) async {
       _log('✅ CONNECTED TO SERVER');
       _log('🆔 OUR SOCKET ID', socket.id);
+      _devices.clear();
+      _deviceListVersion = -1;
+      _deviceSyncRequested = false;
       
       // Get hostname/computer name
       String deviceName = 'Unknown Device';
@@ -86,13 +105,20 @@ class SocketService {
       }
       
       _log('📝 REGISTERING WITH DEVICE NAME', deviceName);
+      _deviceGroup = SettingsService.instance.deviceGroup;
       socket.emit('register', {
         'deviceName': deviceName,
         'platform': Platform.operatingSystem,
+        'deltas': true,
+        if (_deviceGroup.isNotEmpty) 'group': _deviceGroup,
       });
       
       // Request existing connected devices with a delay to ensure we're registered
       Future.delayed(const Duration(milliseconds: 500), () {
+        if (_deviceListVersion >= 0) {
+          _log('📋 DEVICE LIST KEPT FROM SNAPSHOT, SKIPPING DISCOVERY');
+          return;
+        }
         _log('📋 REQUESTING EXISTING DEVICES');
         // Try multiple possible event names to request device list
         socket.emit('get-devices', {});
@@ -131,7 +157,7 @@ class SocketService {
       _log('📤 CREATING OFFER TO SEND CLIPBOARD TO REQUESTER', requesterId);
       
       try {
-        await _webrtcService.createOffer(requesterId);
+        await _webrtcService.createOffer(requesterId, traceId: data['traceId'] as String?);
         _log('✅ WEBRTC createOffer COMPLETED SUCCESSFULLY');
       } catch (e, stackTrace) {
         _log('❌ ERROR CALLING WEBRTC createOffer', e.toString());
@@ -190,6 +216,11 @@ class SocketService {
         await _webrtcService.handleAnswer(data['signal']);
       } else if (data['signal']['type'] == 'candidate') {
         await _webrtcService.handleCandidate(data['signal']);
+      } else if (data['signal']['type'] == 'candidates') {
+        await _webrtcService.handleCandidate(
+          data['signal']['candidates'] ?? const [],
+          end: data['signal']['end'] == true,
+        );
       }
     });
 
@@ -202,8 +233,9 @@ class SocketService {
           event.contains('room') || event.contains('list') || event.contains('hello')) {
         _log('🔍 POTENTIAL DEVICE INFO EVENT', {'event': event, 'data': data});
         
-        // Skip disconnection events here - they are handled by their specific handlers
-        if (event == 'device-disconnected') {
+        // Skip disconnection events and the versioned device list here -
+        // they are handled by their specific handlers
+        if (event == 'device-disconnected' || event == 'device-snapshot' || event == 'device-delta') {
           return;
         }
         
@@ -241,6 +273,18 @@ class SocketService {
       }
     });
 
+    socket.on('device-snapshot', (data) {
+      _log('📋 DEVICE SNAPSHOT', {
+        'version': data is Map ? data['version'] : null,
+        'devices': data is Map && data['devices'] is List ? data['devices'].length : null,
+      });
+      _applyDeviceSnapshot(data);
+    });
+
+    socket.on('device-delta', (data) {
+      _applyDeviceDelta(data);
+    });
+
     socket.on('device-connected', (data) {
       _log('📱 DEVICE CONNECTED EVENT', data);
       _log('📱 OUR ID WHEN DEVICE CONNECTED', socket.id);
@@ -258,6 +302,8 @@ class SocketService {
 
     socket.on('device-disconnected', (data) {
       _log('📱 DEVICE DISCONNECTED EVENT', data);
+      final deviceId = data is Map ? data['deviceId']?.toString() : null;
+      if (deviceId != null) _webrtcService.forgetPeer(deviceId);
       if (onDeviceDisconnected != null) {
         onDeviceDisconnected!(data);
       }
@@ -265,6 +311,13 @@ class SocketService {
 
     socket.on('share-available', (data) {
       _log('🚀 SHARE AVAILABLE', data);
+      final deviceId = data is Map ? data['deviceId']?.toString() : null;
+      if (deviceId == null || deviceId == socket.id) return;
+      final device = _devices[deviceId];
+      if (device != null) device['readyToShare'] = true;
+      if (onDeviceConnected != null) {
+        onDeviceConnected!(device ?? {'id': deviceId, 'readyToShare': true});
+      }
     });
 
     // Handle no-sharer-available from server
@@ -339,9 +392,17 @@ class SocketService {
     socket.emit('not-ready');
   }
 
-  void sendRequestShare() {
-    _log('📤 SENDING REQUEST-SHARE');
-    socket.emit('request-share', {});
+  /// Asks for a ready device's clipboard: [deviceId]'s if given and still
+  /// ready, else the server picks one. The share is traced under a new
+  /// trace id, which the server and the sharer pass along.
+  void sendRequestShare({String? deviceId}) {
+    final traceId = Tracing.newTraceId();
+    _log('📤 SENDING REQUEST-SHARE', {'deviceId': deviceId, 'traceId': traceId});
+    _webrtcService.expectShare(traceId);
+    socket.emit('request-share', {
+      if (deviceId != null) 'deviceId': deviceId,
+      'traceId': traceId,
+    });
   }
 
   void sendSignal(String to, dynamic signal) {
@@ -369,6 +430,16 @@ class SocketService {
     socket.disconnect();
     socket.connect();
   }
+
+  void _onSettingsChanged() {
+    final group = SettingsService.instance.deviceGroup;
+    if (group == _deviceGroup) return;
+    _log('👥 DEVICE GROUP CHANGED, RECONNECTING', {'group': group});
+    _deviceGroup = group;
+    if (socket.connected) {
+      reconnect();
+    }
+  }
   
   void _tryExtractDeviceInfo(String event, Map<String, dynamic> data) {
     final possibleIdKeys = ['id', 'socketId', 'clientId', 'deviceId', 'userId'];
@@ -393,6 +464,101 @@ class SocketService {
     }
   }
   
+  void _applyDeviceSnapshot(dynamic data) {
+    if (data is! Map || data['version'] is! int || data['devices'] is! List) {
+      return;
+    }
+    _devices.clear();
+    for (var item in data['devices']) {
+      if (item is Map && item['id'] != null) {
+        _devices[item['id'].toString()] = item.cast<String, dynamic>();
+      }
+    }
+    _deviceListVersion = data['version'];
+    _deviceSyncRequested = false;
+
+    // Unlike the old lists, an empty snapshot is passed on too, so devices
+    // that left while we were disconnected are dropped.
+    final devices = _devices.values.where((d) => d['id'] != socket.id).toList();
+    _log('📋 SENDING DEVICE LIST TO UI', devices);
+    if (onConnectedDevicesList != null) {
+      onConnectedDevicesList!(devices);
+    }
+  }
+
+  // Applies the changes of a 'device-delta' that continue our version, and
+  // asks for a new snapshot if some were missed.
+  void _applyDeviceDelta(dynamic data) {
+    if (data is! Map || _deviceListVersion < 0 || _deviceSyncRequested) {
+      return;
+    }
+    final from = data['from'];
+    final to = data['to'];
+    final changes = data['changes'];
+    if (from is! int || to is! int || changes is! List) {
+      return;
+    }
+    if (to <= _deviceListVersion) {
+      return; // already in our snapshot
+    }
+    if (from > _deviceListVersion + 1) {
+      _log('⚠️ DEVICE LIST VERSION GAP, RESYNCING', {
+        'have': _deviceListVersion,
+        'from': from,
+      });
+      _deviceSyncRequested = true;
+      socket.emit('sync-devices');
+      return;
+    }
+    for (var i = 0; i < changes.length; i++) {
+      final change = changes[i];
+      if (from + i > _deviceListVersion && change is Map) {
+        _applyDeviceChange(change.cast<String, dynamic>());
+      }
+    }
+    _deviceListVersion = to;
+  }
+
+  void _applyDeviceChange(Map<String, dynamic> change) {
+    final op = change['op'];
+    if (op == 'add' || op == 'update') {
+      final device = change['device'];
+      if (device is! Map || device['id'] == null) {
+        return;
+      }
+      final deviceId = device['id'].toString();
+      _devices[deviceId] = device.cast<String, dynamic>();
+      _log('📱 DEVICE ADDED', {'deviceId': deviceId, 'name': device['name']});
+      if (deviceId != socket.id && onDeviceConnected != null) {
+        onDeviceConnected!(_devices[deviceId]!);
+      }
+    } else if (op == 'remove') {
+      final deviceId = change['deviceId']?.toString();
+      if (deviceId == null || _devices.remove(deviceId) == null) {
+        return;
+      }
+      _log('📱 DEVICE REMOVED', deviceId);
+      _webrtcService.forgetPeer(deviceId);
+      if (deviceId != socket.id && onDeviceDisconnected != null) {
+        onDeviceDisconnected!({'deviceId': deviceId});
+      }
+    } else if (op == 'ready') {
+      final deviceId = change['deviceId']?.toString();
+      final device = _devices[deviceId];
+      if (device == null) {
+        return;
+      }
+      device['readyToShare'] = change['readyToShare'] == true;
+      if (device['readyToShare'] == true) {
+        _log('🚀 SHARE AVAILABLE', {'deviceId': deviceId});
+      }
+      // Passed on like an add, so the UI refreshes the device it already has.
+      if (deviceId != socket.id && onDeviceConnected != null) {
+        onDeviceConnected!(device);
+      }
+    }
+  }
+
   void _handleDeviceListResponse(dynamic data) {
     _log('📋 HANDLING DEVICE LIST RESPONSE', data);
     
@@ -0,0 +1,266 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:path_provider/path_provider.dart';
+import 'package:shared_clipboard/core/logger.dart';
+import 'package:shared_clipboard/native/sha256_hasher.dart';
+
+/// Receive-side checkpoint journal that lets an interrupted file transfer
+/// resume where it stopped instead of starting over.
+///
+/// While a large file streams in, its bytes go to `<savePath>.scpart`, and
+/// `<savePath>.scpart.json` records the SHA-256 of every completed
+/// [blockSize] block. When the same file (same name, size and modification
+/// time on the sender) is offered again, [resume] re-reads the part file and
+/// keeps the leading blocks whose digests still match; the receiver then asks
+/// the sender to continue from there. A small index in the application
+/// support directory maps files to their journals so the save dialog is not
+/// shown again.
+class TransferJournal {
+  static const int blockSize = 4 * 1024 * 1024;
+
+  /// Smaller files are cheap to resend and are written without a journal.
+  static const int minFileSize = 16 * 1024 * 1024;
+
+  static const String partSuffix = '.scpart';
+  static const String journalSuffix = '.scpart.json';
+  static const int _version = 1;
+
+  static final AppLogger _logger = logTag('JOURNAL');
+  static Future<void> _indexLock = Future.value();
+
+  final String targetPath;
+  final String identity;
+  final int size;
+  final List<String> _blocks;
+  StreamingSha256? _blockHasher;
+  StreamingSha256? _resumedHasher;
+  int _blockFill = 0;
+  Future<void> _saving = Future.value();
+  bool _savePending = false;
+
+  TransferJournal._(this.targetPath, this.identity, this.size, this._blocks);
+
+  /// File the data is written to until the transfer completes.
+  File get dataFile => File('$targetPath$partSuffix');
+
+  File get _journalFile => File('$targetPath$journalSuffix');
+
+  /// Bytes at the start of [dataFile] known to be intact.
+  int get verifiedOffset {
+    final offset = _blocks.length * blockSize;
+    return offset < size ? offset : size;
+  }
+
+  /// Key identifying the sender's file across connections, or null if the
+  /// file is too small to journal or the sender did not say when it was
+  /// modified.
+  static String? identityOf(Map<String, dynamic> meta) {
+    final name = meta['name'] as String?;
+    final size = (meta['size'] as num?)?.toInt() ?? 0;
+    final modified = (meta['modified'] as num?)?.toInt();
+    if (name == null || modified == null || size < minFileSize) return null;
+    return jsonEncode([name, size, modified, meta['checksum'] ?? '']);
+  }
+
+  /// Starts a new journal for a file about to be saved at [targetPath].
+  static Future<TransferJournal> create(String targetPath, String identity, int size) async {
+    final journal = TransferJournal._(targetPath, identity, size, []);
+    await journal.save();
+    await _updateIndex((index) => index[identity] = targetPath);
+    return journal;
+  }
+
+  /// Loads the journal left behind for [identity], if any, and checks the
+  /// recorded blocks against the part file, which is cut back to the last
+  /// intact block. Returns null if there is nothing to resume.
+  static Future<TransferJournal?> resume(String identity) async {
+    final index = await _readIndex();
+    final targetPath = index[identity];
+    if (targetPath == null) return null;
+    final journal = await _load(targetPath, identity);
+    if (journal == null || !await journal._verify()) {
+      await journal?.discard();
+      await _updateIndex((index) => index.remove(identity));
+      return null;
+    }
+    _logger.i('Resuming transfer', {'file': targetPath, 'verified': journal.verifiedOffset, 'of': journal.size});
+    return journal;
+  }
+
+  /// SHA-256 of the file so far, fed with the verified bytes by [resume].
+  /// Continue it with the rest of the file.
+  StreamingSha256 takeHasher() {
+    final hasher = _resumedHasher ?? StreamingSha256();
+    _resumedHasher = null;
+    return hasher;
+  }
+
+  /// Records bytes written to [dataFile] in order. Each completed block is
+  /// checkpointed.
+  void add(Uint8List data) {
+    var pos = 0;
+    while (pos < data.length) {
+      final hasher = _blockHasher ??= StreamingSha256();
+      final take = (blockSize - _blockFill) < data.length - pos ? blockSize - _blockFill : data.length - pos;
+      hasher.add(Uint8List.sublistView(data, pos, pos + take));
+      _blockFill += take;
+      pos += take;
+      if (_blockFill == blockSize || verifiedOffset + _blockFill == size) {
+        _blocks.add(hasher.close());
+        _blockHasher = null;
+        _blockFill = 0;
+        save();
+      }
+    }
+  }
+
+  /// Writes the journal, coalescing saves requested while one is running.
+  Future<void> save() {
+    if (_savePending) return _saving;
+    _savePending = true;
+    return _saving = _saving.then((_) async {
+      _savePending = false;
+      final temp = File('${_journalFile.path}.tmp');
+      try {
+        await temp.writeAsString(jsonEncode({
+          'version': _version,
+          'identity': identity,
+          'size': size,
+          'blockSize': blockSize,
+          'blocks': List<String>.from(_blocks),
+        }));
+        await temp.rename(_journalFile.path);
+      } on FileSystemException catch (e) {
+        _logger.w('Could not save journal', e.toString());
+      }
+    });
+  }
+
+  /// Moves the finished data into place and forgets the journal. Returns the
+  /// saved file.
+  Future<File> complete() async {
+    _disposeHashers();
+    await _saving;
+    final file = await dataFile.rename(targetPath);
+    await _deleteQuietly(_journalFile);
+    await _updateIndex((index) => index.remove(identity));
+    return file;
+  }
+
+  /// Deletes the part file and the journal.
+  Future<void> discard() async {
+    _disposeHashers();
+    await _saving;
+    await _deleteQuietly(dataFile);
+    await _deleteQuietly(_journalFile);
+    await _updateIndex((index) => index.remove(identity));
+  }
+
+  /// Stops recording without touching the files, keeping the transfer
+  /// resumable.
+  Future<void> suspend() async {
+    _disposeHashers();
+    _blockFill = 0;
+    await _saving;
+  }
+
+  void _disposeHashers() {
+    _blockHasher?.dispose();
+    _blockHasher = null;
+    _resumedHasher?.dispose();
+    _resumedHasher = null;
+  }
+
+  static Future<TransferJournal?> _load(String targetPath, String identity) async {
+    try {
+      final journalFile = File('$targetPath$journalSuffix');
+      if (!await journalFile.exists() || !await File('$targetPath$partSuffix').exists()) return null;
+      final json = jsonDecode(await journalFile.readAsString()) as Map<String, dynamic>;
+      if (json['version'] != _version || json['identity'] != identity || json['blockSize'] != blockSize) {
+        return null;
+      }
+      final size = (json['size'] as num).toInt();
+      final blocks = (json['blocks'] as List).cast<String>();
+      return TransferJournal._(targetPath, identity, size, List<String>.from(blocks));
+    } catch (e) {
+      _logger.w('Journal unreadable', {'file': targetPath, 'error': e.toString()});
+      return null;
+    }
+  }
+
+  // Keeps the leading blocks whose bytes on disk still match, feeding them to
+  // a fresh file hasher, and cuts the part file back to them. Returns false
+  // if the part file cannot be read.
+  Future<bool> _verify() async {
+    final hasher = StreamingSha256();
+    var kept = 0;
+    var verified = 0;
+    RandomAccessFile? file;
+    try {
+      file = await dataFile.open(mode: FileMode.append);
+      await file.setPosition(0);
+      final length = await file.length();
+      for (final expected in _blocks) {
+        final want = size - verified < blockSize ? size - verified : blockSize;
+        if (length - verified < want) break;
+        final data = await file.read(want);
+        if (data.length != want || (StreamingSha256()..add(data)).close() != expected) break;
+        hasher.add(data);
+        verified += want;
+        kept++;
+      }
+      await file.truncate(verified);
+    } on FileSystemException catch (e) {
+      _logger.w('Could not verify part file', e.toString());
+      hasher.dispose();
+      return false;
+    } finally {
+      await file?.close();
+    }
+    _blocks.removeRange(kept, _blocks.length);
+    _resumedHasher = hasher;
+    await save();
+    return true;
+  }
+
+  static Future<File> _indexFile() async {
+    final dir = await getApplicationSupportDirectory();
+    return File('${dir.path}${Platform.pathSeparator}resume_index.json');
+  }
+
+  static Future<Map<String, String>> _readIndex() async {
+    try {
+      final file = await _indexFile();
+      if (!await file.exists()) return {};
+      return (jsonDecode(await file.readAsString()) as Map<String, dynamic>).cast<String, String>();
+    } catch (e) {
+      _logger.w('Resume index unreadable', e.toString());
+      return {};
+    }
+  }
+
+  static Future<void> _updateIndex(void Function(Map<String, String> index) update) {
+    return _indexLock = _indexLock.then((_) async {
+      try {
+        final index = await _readIndex();
+        update(index);
+        final file = await _indexFile();
+        await file.parent.create(recursive: true);
+        await file.writeAsString(jsonEncode(index));
+      } catch (e) {
+        _logger.w('Could not update resume index', e.toString());
+      }
+    });
+  }
+
+  static Future<void> _deleteQuietly(File file) async {
+    try {
+      if (await file.exists()) await file.delete();
+    } on FileSystemException {
+      // Already gone
+    }
+  }
+}
@@ -3,6 +3,7 @@ import 'package:flutter/material.dart';
 import 'package:window_manager/window_manager.dart';
 import 'dart:io';
 import 'package:shared_clipboard/core/logger.dart';
+import 'package:shared_clipboard/core/tracing.dart';
 import 'package:shared_clipboard/core/navigation.dart';
 import 'package:shared_clipboard/ui/settings_page.dart';
 import 'package:shared_clipboard/core/constants.dart';
@@ -105,6 +106,8 @@ class TrayService {
     _logger.i('Exiting app via tray menu');
     try {
       await _systemTray.destroy();
+      Tracing.close();
+      AppLogger.closeSink();
       exit(0);
     } catch (e) {
       _logger.e('Failed to exit app', e);
@@ -0,0 +1,107 @@
+import 'dart:async';
+import 'dart:collection';
+
+/// Idle connections kept open for reuse, one per peer.
+///
+/// Entries are evicted least recently used first once their estimated cost
+/// passes [budgetBytes], and dropped once idle for [idleTimeout]; [onEvict]
+/// closes them. Taking an entry removes it: the caller owns it until it is
+/// put back.
+class WarmPeerPool<T> {
+  final int budgetBytes;
+  final Duration idleTimeout;
+  final void Function(T connection) onEvict;
+
+  // In order of use, least recent first.
+  final LinkedHashMap<String, _WarmEntry<T>> _entries = LinkedHashMap();
+  int _usedBytes = 0;
+  Timer? _sweepTimer;
+
+  WarmPeerPool({
+    required this.budgetBytes,
+    required this.idleTimeout,
+    required this.onEvict,
+  });
+
+  int get length => _entries.length;
+  int get usedBytes => _usedBytes;
+
+  /// Keeps [connection] for [peer], replacing (and evicting) any other one
+  /// kept for it. Returns false, having evicted it, if it alone is over
+  /// budget.
+  bool put(String peer, T connection, int costBytes) {
+    final replaced = _remove(peer);
+    if (replaced != null && !identical(replaced.connection, connection)) {
+      onEvict(replaced.connection);
+    }
+    if (costBytes > budgetBytes) {
+      onEvict(connection);
+      return false;
+    }
+    _entries[peer] = _WarmEntry(connection, costBytes, DateTime.now());
+    _usedBytes += costBytes;
+    while (_usedBytes > budgetBytes) {
+      onEvict(_remove(_entries.keys.first)!.connection);
+    }
+    _sweepTimer ??= Timer.periodic(_sweepInterval, (_) => _sweep());
+    return true;
+  }
+
+  /// Removes and returns the connection kept for [peer], if any.
+  T? take(String peer) => _remove(peer)?.connection;
+
+  /// Removes and returns the first kept connection that [test] accepts.
+  T? takeWhere(bool Function(T connection) test) {
+    for (final entry in _entries.entries) {
+      if (test(entry.value.connection)) return take(entry.key);
+    }
+    return null;
+  }
+
+  /// Evicts every connection.
+  void clear() {
+    final connections = _entries.values.map((e) => e.connection).toList();
+    _entries.clear();
+    _usedBytes = 0;
+    _stopSweeping();
+    connections.forEach(onEvict);
+  }
+
+  Duration get _sweepInterval {
+    final quarter = idleTimeout ~/ 4;
+    return quarter < const Duration(seconds: 1) ? const Duration(seconds: 1) : quarter;
+  }
+
+  void _sweep() {
+    final cutoff = DateTime.now().subtract(idleTimeout);
+    final idle = _entries.entries
+        .where((e) => e.value.parkedAt.isBefore(cutoff))
+        .map((e) => e.key)
+        .toList();
+    for (final peer in idle) {
+      onEvict(_remove(peer)!.connection);
+    }
+  }
+
+  _WarmEntry<T>? _remove(String peer) {
+    final entry = _entries.remove(peer);
+    if (entry != null) {
+      _usedBytes -= entry.costBytes;
+      if (_entries.isEmpty) _stopSweeping();
+    }
+    return entry;
+  }
+
+  void _stopSweeping() {
+    _sweepTimer?.cancel();
+    _sweepTimer = null;
+  }
+}
+
+class _WarmEntry<T> {
+  final T connection;
+  final int costBytes;
+  final DateTime parkedAt;
+
+  _WarmEntry(this.connection, this.costBytes, this.parkedAt);
+}
@@ -1,21 +1,37 @@
 import 'dart:io';
 import 'dart:async';
+import 'dart:collection';
 import 'dart:convert';
+import 'dart:math' as math;
 
-import 'package:crypto/crypto.dart';
 import 'package:flutter/services.dart';
 import 'package:flutter_webrtc/flutter_webrtc.dart';
 import 'package:shared_clipboard/services/file_transfer_service.dart';
 import 'package:shared_clipboard/services/notification_service.dart';
 import 'package:shared_clipboard/services/settings_service.dart';
+import 'package:shared_clipboard/services/transfer_journal.dart';
+import 'package:shared_clipboard/services/warm_peer_pool.dart';
 import 'package:file_picker/file_picker.dart';
 import 'package:shared_clipboard/core/logger.dart';
+import 'package:shared_clipboard/core/tracing.dart';
+import 'package:shared_clipboard/native/chunk_source.dart';
+import 'package:shared_clipboard/native/chunk_store.dart';
+import 'package:shared_clipboard/native/content_chunker.dart';
+import 'package:shared_clipboard/native/file_writer.dart';
+import 'package:shared_clipboard/native/flow_control.dart';
+import 'package:shared_clipboard/native/frame_codec.dart';
+import 'package:shared_clipboard/native/payload_compressor.dart';
+import 'package:shared_clipboard/native/send_scheduler.dart';
+import 'package:shared_clipboard/native/sha256_hasher.dart';
+import 'package:shared_clipboard/native/stripe.dart';
+import 'package:path_provider/path_provider.dart';
 import 'package:window_manager/window_manager.dart';
 
 
 class WebRTCService {
   RTCPeerConnection? _peerConnection;
   RTCDataChannel? _dataChannel;
+  final Map<int, RTCDataChannel> _stripeChannels = {}; // extra file data channels by index (1..)
   String? _peerId;
   bool _isInitialized = false;
   ClipboardContent? _pendingClipboardContent; // store structured content to allow streaming
@@ -23,23 +39,84 @@ class WebRTCService {
   final FileTransferService _fileTransferService = FileTransferService();
   final NotificationService _notificationService = NotificationService();
   final AppLogger _logger = logTag('WEBRTC');
+  final FrameCodec _frameCodec = FrameCodec(); // binary file frames (proto v2)
   
   // Queue for ICE candidates received before remote description is set
   final List<RTCIceCandidate> _pendingCandidates = [];
   bool _remoteDescriptionSet = false;
 
+  // The share being traced (see Tracing): its id, when this side started on
+  // it, when connection setup started, and whether the requester is still
+  // waiting for its first byte. Kept across resets, which happen mid-share.
+  String? _traceId;
+  int _traceStartNs = 0;
+  int _connectStartNs = 0;
+  bool _awaitingFirstByte = false;
+
+  // Connections to recent peers, kept open after their share so the next
+  // one skips ICE, DTLS and SCTP setup: the sharer sends straight over the
+  // open channel and the requester takes it up when data arrives on it.
+  // A connection is costed per data channel (SCTP buffers and DTLS state).
+  static const int _warmPeerBudgetBytes = 8 * 1024 * 1024;
+  static const int _warmChannelCostBytes = 512 * 1024;
+  static const Duration _warmPeerIdleTimeout = Duration(minutes: 10);
+  late final WarmPeerPool<_WarmPeer> _warmPeers = WarmPeerPool<_WarmPeer>(
+    budgetBytes: _warmPeerBudgetBytes,
+    idleTimeout: _warmPeerIdleTimeout,
+    onEvict: (warm) {
+      _log('♨️ CLOSING WARM CONNECTION', warm.peerId);
+      warm.close();
+    },
+  );
+
+  // Local ICE candidates waiting to go out together as one 'candidates'
+  // signal: gathering yields a burst of them within a few ms.
+  static const Duration _candidateFlushWindow = Duration(milliseconds: 20);
+  final List<Map<String, dynamic>> _outgoingCandidates = [];
+  String? _outgoingCandidatesPeer;
+  Timer? _candidateFlushTimer;
+  // Whether the peer takes 'candidates' batches, as it says with
+  // candidateBatches: true in its offer or answer. Until then each
+  // candidate goes out alone as a 'candidate' signal, as older clients
+  // expect.
+  bool _peerTakesCandidateBatches = false;
+  bool _localCandidatesEnded = false; // end: true sent for this connection
+
   // Chunking protocol settings and state - reduced for better reliability
   static const int _chunkSize = 8 * 1024; // 8 KB chunks for better SCTP compatibility
   static const int _bufferedLowThreshold = 32 * 1024; // 32 KB backpressure threshold
   final Map<String, StringBuffer> _rxBuffers = {};
   final Map<String, int> _rxReceivedBytes = {};
   final Map<String, int> _rxTotalBytes = {};
+  final PayloadCompressor? _textCompressor = PayloadCompressor.create(); // null without sc_native
+  final Map<String, Completer<Map<String, dynamic>?>> _textAcceptCompleters = {}; // sender: awaiting 'accept'
+  final Map<String, _IncomingText> _rxTexts = {}; // texts arriving as binary frames
+  static const int _compressTextMinSize = 64 * 1024; // smaller texts are not worth a round trip
+  static const int _binaryTextMinSize = 64 * 1024; // smaller texts go as one JSON envelope
+  static const int _textSegmentUnits = 64 * 1024; // UTF-16 units encoded to UTF-8 at a time
+  static const Duration _textAcceptTimeout = Duration(milliseconds: 500);
   Completer<void>? _bufferLowCompleter;
 
   // Streaming files state (proto v2)
   final Map<String, _FileSession> _fileSessions = {};
   final Map<String, Completer<void>> _sessionReadyCompleters = {};
-  Completer<void>? _ackCompleter; // legacy chunk ACK (every 100 chunks) for current active send
+  final Map<String, SendWindow> _sendWindows = {}; // credit window per outgoing session
+  Completer<void>? _sendWakeup; // completed on credit or buffer drain
+  final Map<String, int> _ackPacedSessions = {}; // JSON chunk sends: chunks sent so far
+  Completer<void>? _ackCompleter; // legacy chunk ACK (every 100 chunks) for a JSON chunk send
+  static const Duration _creditTimeout = Duration(seconds: 30);
+  final Set<String> _binarySessions = {}; // receivers that read binary file frames
+  final Set<String> _stripingSessions = {}; // receivers that reassemble by offset
+  final Map<String, _SendStripes> _sendStripes = {}; // data channels per outgoing session
+  static const String _stripeLabelPrefix = 'clipboard-data-';
+  final Set<String> _dedupSessions = {}; // receivers that keep a chunk store
+  final Set<String> _compressingSessions = {}; // receivers that accept LZ4 frames
+  final Map<String, Completer<List<dynamic>>> _haveCompleters = {}; // sender: awaiting 'have'
+  final Map<String, Map<int, int>> _resumeOffsets = {}; // sender: file index -> bytes the receiver kept
+  ChunkStore? _chunkStore; // receiver: chunks of earlier transfers
+  static const int _dedupMinFileSize = 1024 * 1024; // smaller files are just sent
+  static const int _manifestChunksPerMessage = 2048;
+  static const Duration _writerPollInterval = Duration(milliseconds: 5); // credit release while writes are queued
   // Per-session ACK waiters for critical boundaries
   final Map<String, Completer<void>> _ackWaiters = {}; // key: "sessionId:ackType"
 
@@ -71,6 +148,10 @@ class WebRTCService {
 
   }
 
+  // For per-message and per-chunk lines; pass data as a closure so nothing
+  // is built unless debug logging is on.
+  void _debug(String message, [Object? data]) => _logger.d(message, data);
+
   // Helper method to send "no content available" signal to requester
   Future<void> _sendNoContentAvailableSignal(String? requesterId) async {
     if (requesterId == null || onSignalGenerated == null) return;
@@ -94,14 +175,20 @@ class WebRTCService {
   // Streaming files protocol (proto v2)
   Future<void> _sendFilesStreaming(ClipboardContent content) async {
     if (_dataChannel == null) throw StateError('DataChannel not ready');
-    final sessionId = DateTime.now().microsecondsSinceEpoch.toString();
-    final filesMeta = content.files
-        .map((f) => {
-              'name': f.name,
-              'size': f.size,
-              'checksum': f.checksum,
-            })
-        .toList();
+    // Numeric so it fits the u64 session field of binary frames
+    final sessionNumber = DateTime.now().microsecondsSinceEpoch;
+    final sessionId = sessionNumber.toString();
+    _sendWindows[sessionId] = SendWindow();
+    final filesMeta = content.files.map((f) {
+      final modified = _modifiedMillis(f.path);
+      return {
+        'name': f.name,
+        'size': f.size,
+        'checksum': f.checksum,
+        // Lets the receiver match the file against an interrupted transfer
+        if (modified != null) 'modified': modified,
+      };
+    }).toList();
     // Start session with metadata so receiver can prompt immediately
     final startEnv = jsonEncode({
       '__sc_proto': 2,
@@ -109,6 +196,8 @@ class WebRTCService {
       'mode': 'start',
       'sessionId': sessionId,
       'files': filesMeta,
+      // We can continue files from a 'resume' offset
+      'resume': true,
     });
     _dataChannel!.send(RTCDataChannelMessage(startEnv));
 
@@ -122,123 +211,45 @@ class WebRTCService {
     } catch (e) {
       _log('⚠️ RECEIVER READY TIMEOUT, ABORTING STREAM', sessionId);
       _sessionReadyCompleters.remove(sessionId);
+      _binarySessions.remove(sessionId);
+      _stripingSessions.remove(sessionId);
+      _dedupSessions.remove(sessionId);
+      _compressingSessions.remove(sessionId);
+      _resumeOffsets.remove(sessionId);
+      _sendWindows.remove(sessionId)?.dispose();
+      _ackPacedSessions.remove(sessionId);
       return;
     }
 
-    // Stream each file with comprehensive diagnostics
-    for (int i = 0; i < content.files.length; i++) {
-      final f = content.files[i];
-      final bytes = f.content; // already read in FileTransferService
-      int offset = 0;
-      int chunkCount = 0;
-      final totalChunks = (bytes.length / _chunkSize).ceil();
-      
-      _log('🚀 STARTING FILE TRANSFER', {
-        'file': f.name,
-        'size': bytes.length,
-        'totalChunks': totalChunks,
-        'chunkSize': _chunkSize
-      });
-      
-      while (offset < bytes.length) {
-        final end = (offset + _chunkSize > bytes.length) ? bytes.length : offset + _chunkSize;
-        final chunkBytes = bytes.sublist(offset, end);
-        final env = jsonEncode({
-          '__sc_proto': 2,
-          'kind': 'files',
-          'mode': 'file_chunk',
-          'sessionId': sessionId,
-          'fileIndex': i,
-          'data': base64Encode(chunkBytes),
-        });
-        
-        try {
-          _dataChannel!.send(RTCDataChannelMessage(env));
-          chunkCount++;
-          
-          // Log progress every 100 chunks and show notifications at round percentages
-          if (chunkCount % 100 == 0) {
-            final progress = (offset / bytes.length * 100).toStringAsFixed(1);
-            _log('📤 SENDING PROGRESS', {
-              'file': f.name,
-              'chunk': chunkCount,
-              'of': totalChunks,
-              'progress': '$progress%',
-              'bytesRemaining': bytes.length - offset,
-              'bufferedAmount': _dataChannel!.bufferedAmount
-            });
-          }
-        } catch (e) {
-          _log('❌ ERROR SENDING CHUNK', {
-            'chunk': chunkCount,
-            'offset': offset,
-            'error': e.toString()
-          });
-          rethrow;
-        }
-        
-        offset = end;
-
-        // Wait for ACK from receiver every 100 chunks for flow control
-        if (chunkCount % 100 == 0) {
-          _log('⏳ WAITING FOR ACK');
-          _ackCompleter = Completer<void>();
-          try {
-            await _ackCompleter!.future.timeout(const Duration(seconds: 30));
-            _log('✅ ACK RECEIVED, CONTINUING TRANSFER');
-          } catch (e) {
-            _log('❌ ACK TIMEOUT, ABORTING TRANSFER', e.toString());
-            throw Exception('ACK timeout');
-          } finally {
-            _ackCompleter = null;
-          }
-        }
-      }
-      
-      // Note: Do not wait for an extra ACK here; the receiver sends ACKs every 100 chunks
-      // and will ACK upon file_end. We proceed to file_end immediately to avoid timeouts.
-
-      _log('✅ FINISHED SENDING FILE', {
-        'file': f.name,
-        'totalChunks': chunkCount,
-        'totalBytes': bytes.length,
-        'finalBufferedAmount': _dataChannel!.bufferedAmount
-      });
-      
-      // Ensure buffered data is flushed before signaling file end
-      while ((_dataChannel!.bufferedAmount ?? 0) > _bufferedLowThreshold) {
-        _log('⏳ WAITING BUFFER TO DRAIN BEFORE FILE_END', {'buffered': _dataChannel!.bufferedAmount});
-        _bufferLowCompleter = Completer<void>();
-        try {
-          await _bufferLowCompleter!.future;
-        } catch (_) {
-          await Future.delayed(const Duration(milliseconds: 100));
-        }
-      }
+    // Receivers that predate binary frames only read text messages
+    final binary = _binarySessions.remove(sessionId);
 
-      // End of this file
-      final fileEndAckKey = '$sessionId:file_end';
-      _ackWaiters[fileEndAckKey] = Completer<void>();
-      final fileEnd = jsonEncode({
-        '__sc_proto': 2,
-        'kind': 'files',
-        'mode': 'file_end',
-        'sessionId': sessionId,
-        'fileIndex': i,
+    // Stripe frames over the parallel channels that are open, if the
+    // receiver can put them back in order
+    final lanes = <int, RTCDataChannel>{0: _dataChannel!};
+    if (_stripingSessions.remove(sessionId) && binary) {
+      _stripeChannels.forEach((index, channel) {
+        if (channel.state == RTCDataChannelState.RTCDataChannelOpen) lanes[index] = channel;
       });
-      _dataChannel!.send(RTCDataChannelMessage(fileEnd));
+    }
+    _sendStripes[sessionId] = _SendStripes(lanes);
+    _log('🛤️ STREAMING OVER DATA CHANNELS', {'sessionId': sessionId, 'channels': lanes.keys.toList()});
 
-      // Wait for ACK confirming receiver processed file end
-      _log('⏳ WAITING FOR FILE_END ACK (scoped)');
-      try {
-        await _ackWaiters[fileEndAckKey]!.future.timeout(const Duration(seconds: 30));
-        _log('✅ FILE_END ACK RECEIVED');
-      } catch (e) {
-        _log('❌ FILE_END ACK TIMEOUT', e.toString());
-        throw Exception('File end ACK timeout');
-      } finally {
-        _ackWaiters.remove(fileEndAckKey);
-      }
+    // Stream the files, several at a time. file_end is sent as soon as a
+    // file's last frame is queued and is not awaited; the receiver completes a
+    // file once it has both the file_end and all of its bytes, since striped
+    // frames can arrive after it.
+    try {
+      final dedup = _dedupSessions.remove(sessionId) && SettingsService.instance.deduplicateTransfers;
+      final compress = _compressingSessions.remove(sessionId) && SettingsService.instance.compressTransfers;
+      final resumeFrom = _resumeOffsets.remove(sessionId) ?? const <int, int>{};
+      final manifests = dedup ? await _negotiateDedup(sessionId, content.files, resumeFrom.keys.toSet()) : <int, _OutgoingManifest>{};
+      await _sendScheduledChunks(sessionNumber, content.files, manifests,
+          binary: binary, compress: compress && binary, resumeFrom: resumeFrom);
+    } catch (_) {
+      _haveCompleters.remove(sessionId);
+      _sendStripes.remove(sessionId)?.dispose();
+      rethrow;
     }
 
     // Ensure buffer drains before session end
@@ -273,13 +284,336 @@ class WebRTCService {
       throw Exception('Session end ACK timeout');
     } finally {
       _ackWaiters.remove(endAckKey);
+      _sendWindows.remove(sessionId)?.dispose();
+      _ackPacedSessions.remove(sessionId);
+      _sendStripes.remove(sessionId)?.dispose();
       // Current send session finished
       _isSending = false;
       _currentTransferContent = null; // Clear current transfer tracking
     }
   }
 
-  Future<void> init() async {
+  // Modification time sent with file metadata, or null if it is unavailable.
+  static int? _modifiedMillis(String path) {
+    try {
+      return File(path).lastModifiedSync().millisecondsSinceEpoch;
+    } on FileSystemException {
+      return null;
+    }
+  }
+
+  // Sends the content-defined chunk lists of the larger files and returns
+  // them with the chunks the receiver says it already has. Each file is read
+  // once here; its source stays open so the send does not hash it again.
+  // Files in [resumed] are mostly on the receiver already and are left out.
+  Future<Map<int, _OutgoingManifest>> _negotiateDedup(
+      String sessionId, List<FileData> files, Set<int> resumed) async {
+    final manifests = <int, _OutgoingManifest>{};
+    try {
+      for (var i = 0; i < files.length; i++) {
+        final f = files[i];
+        if (f.size < _dedupMinFileSize || resumed.contains(i)) continue;
+        final source = FileChunkSource.open(f.path);
+        if (source.length != f.size) {
+          source.close();
+          throw FileSystemException('File changed size since it was offered', f.path);
+        }
+        final manifest = _OutgoingManifest(source, source.contentChunks());
+        manifests[i] = manifest;
+        for (var start = 0; start < manifest.chunks.length; start += _manifestChunksPerMessage) {
+          final part = manifest.chunks.skip(start).take(_manifestChunksPerMessage);
+          _dataChannel!.send(RTCDataChannelMessage(jsonEncode({
+            '__sc_proto': 2,
+            'kind': 'files',
+            'mode': 'manifest',
+            'sessionId': sessionId,
+            'fileIndex': i,
+            'chunks': [
+              for (final c in part) [c.length, c.digestHex]
+            ],
+          })));
+        }
+      }
+      if (manifests.isEmpty) return manifests;
+
+      final have = Completer<List<dynamic>>();
+      _haveCompleters[sessionId] = have;
+      _dataChannel!.send(RTCDataChannelMessage(jsonEncode({
+        '__sc_proto': 2,
+        'kind': 'files',
+        'mode': 'manifest_end',
+        'sessionId': sessionId,
+      })));
+      final ranges = await have.future.timeout(_creditTimeout);
+      var skipped = 0;
+      for (final range in ranges.cast<List<dynamic>>()) {
+        final manifest = manifests[(range[0] as num).toInt()];
+        final first = (range[1] as num).toInt();
+        final count = (range[2] as num).toInt();
+        if (manifest == null || first < 0 || count <= 0 || first + count > manifest.chunks.length) {
+          throw StateError('Invalid have range $range');
+        }
+        manifest.have.add([first, count]);
+        skipped += manifest.chunks[first + count - 1].end - manifest.chunks[first].offset;
+      }
+      _log('♻️ RECEIVER ALREADY HAS', {'sessionId': sessionId, 'bytes': skipped});
+      return manifests;
+    } catch (_) {
+      for (final manifest in manifests.values) {
+        manifest.source.close();
+      }
+      rethrow;
+    } finally {
+      _haveCompleters.remove(sessionId);
+    }
+  }
+
+  // Streams the session's files as binary frames, interleaving up to
+  // SendScheduler.defaultMaxActive files. Chunks are read on demand, so no
+  // file is held in memory as a whole, and each file's SHA-256 comes from the
+  // same reads rather than a second pass. Ranges the receiver already has,
+  // per [manifests], are skipped. With [compress], chunks of files that are
+  // not already compressed (judged by MIME type) go out LZ4-compressed when
+  // that makes them smaller; credit still counts uncompressed bytes. Files in
+  // [resumeFrom] start at the offset the receiver kept from an interrupted
+  // transfer. Without [binary], chunks go out as the base64 'file_chunk' JSON
+  // envelopes that receivers predating binary frames read.
+  Future<void> _sendScheduledChunks(
+      int sessionNumber, List<FileData> files, Map<int, _OutgoingManifest> manifests,
+      {bool binary = true, bool compress = false, Map<int, int> resumeFrom = const {}}) async {
+    final sessionId = sessionNumber.toString();
+    final scheduler = SendScheduler(files.map((f) => f.size).toList(), _chunkSize);
+    resumeFrom.forEach((i, offset) {
+      if (i < 0 || i >= files.length || offset <= 0 || offset > files[i].size) {
+        throw StateError('Invalid resume offset $offset for file $i');
+      }
+      scheduler.skip(i, 0, offset);
+    });
+    manifests.forEach((i, manifest) {
+      for (final range in manifest.have) {
+        final first = manifest.chunks[range[0]];
+        final last = manifest.chunks[range[0] + range[1] - 1];
+        scheduler.skip(i, first.offset, last.end - first.offset);
+      }
+    });
+    final open = <int, _OutgoingFile>{};
+    try {
+      for (var chunk = scheduler.next(); chunk != null; chunk = scheduler.next()) {
+        final i = chunk.fileIndex;
+        final f = files[i];
+        if (chunk.first) {
+          final source = manifests.remove(i)?.source ?? FileChunkSource.open(f.path);
+          if (source.length != f.size) {
+            source.close();
+            throw FileSystemException('File changed size since it was offered', f.path);
+          }
+          open[i] = _OutgoingFile(source, compress && PayloadCompressor.isCompressibleType(f.mimeType));
+          _log('🚀 STARTING FILE TRANSFER', {
+            'file': f.name,
+            'size': f.size,
+            'totalChunks': (f.size / _chunkSize).ceil(),
+            'chunkSize': _chunkSize,
+            'active': open.length,
+            'compress': open[i]!.compress,
+          });
+        }
+        final out = open[i]!;
+
+        if (chunk.length > 0) {
+          final window = await _waitForSendWindow(sessionId, chunk.length);
+          final stripes = _sendStripes[sessionId]!;
+          final lane = stripes.scheduler.pick();
+          final chunkBytes = out.source.read(chunk.offset, chunk.length);
+          if (chunkBytes.length != chunk.length) {
+            throw FileSystemException('File shrank while sending', f.path);
+          }
+          final RTCDataChannelMessage message;
+          var wireBytes = chunkBytes.length;
+          if (binary) {
+            // Raw bytes in a binary frame: no per-chunk JSON or base64
+            final frame = _frameCodec.encode(
+              sessionId: sessionNumber,
+              fileIndex: i,
+              offset: chunk.offset,
+              payload: chunkBytes,
+              flags: chunk.last ? FrameCodec.flagLast : 0,
+              compress: out.compress,
+            );
+            message = RTCDataChannelMessage.fromBinary(frame);
+            wireBytes = frame.length - FrameCodec.headerSize;
+          } else {
+            message = RTCDataChannelMessage(jsonEncode({
+              '__sc_proto': 2,
+              'kind': 'files',
+              'mode': 'file_chunk',
+              'sessionId': sessionId,
+              'fileIndex': i,
+              'data': base64Encode(chunkBytes),
+            }));
+          }
+
+          try {
+            stripes.channels[lane].send(message);
+            window.onSent(chunkBytes.length);
+            stripes.scheduler.onSent(lane, chunkBytes.length);
+            out.chunkCount++;
+            out.wireBytes += wireBytes;
+
+            // Log progress every 100 chunks
+            if (out.chunkCount % 100 == 0) {
+              final progress = (chunk.offset / f.size * 100).toStringAsFixed(1);
+              _log('📤 SENDING PROGRESS', {
+                'file': f.name,
+                'chunk': out.chunkCount,
+                'of': (f.size / _chunkSize).ceil(),
+                'progress': '$progress%',
+                'bytesRemaining': f.size - chunk.offset,
+                'bufferedAmount': stripes.bufferedAmount,
+                'window': window.window,
+                'rttMs': window.rttUs ~/ 1000,
+              });
+            }
+          } catch (e) {
+            _log('❌ ERROR SENDING CHUNK', {
+              'file': f.name,
+              'chunk': out.chunkCount,
+              'offset': chunk.offset,
+              'error': e.toString()
+            });
+            rethrow;
+          }
+          if (!binary) await _awaitLegacyAck(sessionId);
+        }
+
+        if (chunk.last) {
+          final checksum = out.source.digestHex();
+          out.source.close();
+          open.remove(i);
+          _dataChannel!.send(RTCDataChannelMessage(jsonEncode({
+            '__sc_proto': 2,
+            'kind': 'files',
+            'mode': 'file_end',
+            'sessionId': sessionId,
+            'fileIndex': i,
+            'size': f.size,
+            'checksum': checksum,
+          })));
+          _log('✅ FINISHED SENDING FILE', {
+            'file': f.name,
+            'totalChunks': out.chunkCount,
+            'totalBytes': f.size,
+            'wireBytes': out.wireBytes,
+            'finalBufferedAmount': _dataChannel!.bufferedAmount
+          });
+        }
+      }
+    } finally {
+      for (final out in open.values) {
+        out.source.close();
+      }
+      for (final manifest in manifests.values) {
+        manifest.source.close();
+      }
+      scheduler.dispose();
+    }
+  }
+
+  // Waits until the session's credit window has room for [bytes] and returns
+  // the window. Wakes on credit grants and buffer drain, polling in between
+  // since bufferedAmountLow only fires near empty.
+  Future<SendWindow> _waitForSendWindow(String sessionId, int bytes) async {
+    final stalledSince = DateTime.now();
+    while (true) {
+      final window = _sendWindows[sessionId];
+      if (window == null) throw StateError('Send session $sessionId was cancelled');
+      if (_ackPacedSessions.containsKey(sessionId)) return window;
+      final buffered = _sendStripes[sessionId]?.bufferedAmount ?? (_dataChannel!.bufferedAmount ?? 0);
+      if (window.available(buffered) >= bytes) return window;
+      if (DateTime.now().difference(stalledSince) > _creditTimeout) {
+        _log('❌ CREDIT TIMEOUT, ABORTING TRANSFER', {'sessionId': sessionId, 'window': window.window});
+        throw Exception('Credit timeout');
+      }
+      final wakeup = _sendWakeup ??= Completer<void>();
+      try {
+        await wakeup.future.timeout(const Duration(milliseconds: 20));
+      } on TimeoutException catch (_) {}
+    }
+  }
+
+  // Counts a JSON chunk sent to a receiver that predates binary frames or
+  // credit grants and, on every 100th, waits for the ACK it sends instead.
+  Future<void> _awaitLegacyAck(String sessionId) async {
+    final sent = _ackPacedSessions[sessionId];
+    if (sent == null) return;
+    _ackPacedSessions[sessionId] = sent + 1;
+    if ((sent + 1) % 100 != 0) return;
+    _ackCompleter = Completer<void>();
+    try {
+      await _ackCompleter!.future.timeout(const Duration(seconds: 30));
+    } on TimeoutException catch (_) {
+      _log('❌ ACK TIMEOUT, ABORTING TRANSFER', sessionId);
+      throw Exception('ACK timeout');
+    } finally {
+      _ackCompleter = null;
+    }
+  }
+
+  void _wakeSender() {
+    final wakeup = _sendWakeup;
+    _sendWakeup = null;
+    if (wakeup != null && !wakeup.isCompleted) wakeup.complete();
+  }
+
+  void _sendCredit(String sessionId, _FileSession session) {
+    _dataChannel?.send(RTCDataChannelMessage(jsonEncode({
+      '__sc_proto': 2,
+      'kind': 'credit',
+      'sessionId': sessionId,
+      'consumed': session.credit.consumed,
+      'limit': session.credit.limit,
+      // Bytes taken off each data channel, so the sender can steer away from
+      // a stalled one
+      if (session.channelConsumed.length > 1) 'channels': session.channelConsumed,
+    })));
+  }
+
+  // Index of a parallel file data channel from its label, or null for any
+  // other channel.
+  int? _stripeIndex(String? label) {
+    if (label == null || !label.startsWith(_stripeLabelPrefix)) return null;
+    final index = int.tryParse(label.substring(_stripeLabelPrefix.length));
+    return index != null && index > 0 ? index : null;
+  }
+
+  // Parallel channels only carry binary file frames; control messages stay on
+  // the main channel.
+  void _setupStripeChannel(RTCDataChannel channel, int index) {
+    _stripeChannels[index] = channel;
+    _log('🛤️ SETTING UP STRIPE CHANNEL', {'label': channel.label, 'index': index});
+    channel.onBufferedAmountLow = (int amount) => _wakeSender();
+    channel.bufferedAmountLowThreshold = _bufferedLowThreshold;
+    channel.onMessage = (message) {
+      // Frames left over on a parked connection belong to no active session
+      if (message.isBinary && identical(_stripeChannels[index], channel)) {
+        _handleBinaryFrame(message.binary, channel: index);
+      }
+    };
+  }
+
+  void _closeStripeChannels() {
+    for (final channel in _stripeChannels.values) {
+      try {
+        channel.close();
+      } catch (e) {
+        _log('⚠️ ERROR CLOSING STRIPE CHANNEL (IGNORING)', e.toString());
+      }
+    }
+    _stripeChannels.clear();
+  }
+
+  /// Creates the peer connection; its local ICE candidates go to [peerId],
+  /// the peer it is made for.
+  Future<void> init({String? peerId}) async {
     if (_isInitialized) {
       _log('⚠️ ALREADY INITIALIZED, SKIPPING');
       return;
@@ -309,26 +643,49 @@ class WebRTCService {
       ]);
       
       _isInitialized = true;
+      final connection = _peerConnection!;
 
+      // Candidates go to the peer the connection was made for, not the
+      // active one: a parked connection can still produce them.
       _peerConnection?.onIceCandidate = (candidate) {
-        _log('🧊 ICE CANDIDATE GENERATED');
-        if (_peerId != null && onSignalGenerated != null) {
-          onSignalGenerated!(_peerId!, {
-            'type': 'candidate',
-            'candidate': candidate.candidate,
-            'sdpMid': candidate.sdpMid,
-            'sdpMLineIndex': candidate.sdpMLineIndex,
-          });
+        _debug('🧊 ICE CANDIDATE GENERATED');
+        if (peerId == null) return;
+        // Some platforms report the end of gathering as an empty candidate.
+        if (candidate.candidate == null || candidate.candidate!.isEmpty) {
+          _flushLocalCandidates(end: true, to: peerId);
+          return;
+        }
+        _queueLocalCandidate(peerId, {
+          'candidate': candidate.candidate,
+          'sdpMid': candidate.sdpMid,
+          'sdpMLineIndex': candidate.sdpMLineIndex,
+        });
+      };
+
+      _peerConnection?.onIceGatheringState = (state) {
+        if (state == RTCIceGatheringState.RTCIceGatheringStateComplete && peerId != null) {
+          _flushLocalCandidates(end: true, to: peerId);
         }
       };
 
       _peerConnection?.onConnectionState = (state) {
         _log('🔗 CONNECTION STATE CHANGED', state.toString());
+        if (!identical(connection, _peerConnection) &&
+            (state == RTCPeerConnectionState.RTCPeerConnectionStateFailed ||
+                state == RTCPeerConnectionState.RTCPeerConnectionStateClosed ||
+                state == RTCPeerConnectionState.RTCPeerConnectionStateDisconnected)) {
+          _warmPeers.takeWhere((warm) => identical(warm.connection, connection))?.close();
+        }
       };
 
       _peerConnection?.onDataChannel = (channel) {
         _log('📡 DATA CHANNEL RECEIVED');
-        _setupDataChannel(channel);
+        final stripe = _stripeIndex(channel.label);
+        if (stripe != null) {
+          _setupStripeChannel(channel, stripe);
+        } else {
+          _setupDataChannel(channel);
+        }
       };
       
       _log('✅ WEBRTC SERVICE INITIALIZED');
@@ -340,6 +697,61 @@ class WebRTCService {
     }
   }
 
+  // Holds a local candidate for [peer] until the flush window closes, so a
+  // burst costs one signal instead of one each.
+  void _queueLocalCandidate(String peer, Map<String, dynamic> candidate) {
+    if (onSignalGenerated == null) return;
+    if (!_peerTakesCandidateBatches) {
+      onSignalGenerated!(peer, {'type': 'candidate', ...candidate});
+      return;
+    }
+    if (_outgoingCandidatesPeer != null && _outgoingCandidatesPeer != peer) {
+      _flushLocalCandidates();
+    }
+    _outgoingCandidatesPeer = peer;
+    _outgoingCandidates.add(candidate);
+    _candidateFlushTimer ??= Timer(_candidateFlushWindow, _flushLocalCandidates);
+  }
+
+  // Sends the held candidates as {type: 'candidates', candidates: [...]},
+  // with end: true once gathering is complete (even if none are held).
+  // Platforms may report the end twice; it goes out once, to [to].
+  void _flushLocalCandidates({bool end = false, String? to}) {
+    if (to != null && _outgoingCandidatesPeer != null && _outgoingCandidatesPeer != to) {
+      _flushLocalCandidates();
+    }
+    _candidateFlushTimer?.cancel();
+    _candidateFlushTimer = null;
+    if (end) {
+      end = _peerTakesCandidateBatches && !_localCandidatesEnded;
+      if (end) _localCandidatesEnded = true;
+    }
+    final peer = to ?? _outgoingCandidatesPeer;
+    _outgoingCandidatesPeer = null;
+    if (peer == null || onSignalGenerated == null || (_outgoingCandidates.isEmpty && !end)) {
+      _outgoingCandidates.clear();
+      return;
+    }
+    final batch = List<Map<String, dynamic>>.from(_outgoingCandidates);
+    _outgoingCandidates.clear();
+    _debug('🧊 SENDING ICE CANDIDATES', () => {'count': batch.length, 'end': end});
+    onSignalGenerated!(peer, {
+      'type': 'candidates',
+      'candidates': batch,
+      if (end) 'end': true,
+    });
+  }
+
+  // Drops held candidates, which belong to a connection being torn down.
+  void _discardLocalCandidates() {
+    _candidateFlushTimer?.cancel();
+    _candidateFlushTimer = null;
+    _outgoingCandidates.clear();
+    _outgoingCandidatesPeer = null;
+    _peerTakesCandidateBatches = false;
+    _localCandidatesEnded = false;
+  }
+
   void _setupDataChannel(RTCDataChannel channel) {
     _dataChannel = channel;
     _log('📡 SETTING UP DATA CHANNEL', {
@@ -360,20 +772,51 @@ class WebRTCService {
       _log('📉 DATA CHANNEL BUFFERED AMOUNT LOW', {'amount': amount});
       _bufferLowCompleter?.complete();
       _bufferLowCompleter = null;
+      _wakeSender();
     };
     _dataChannel?.bufferedAmountLowThreshold = _bufferedLowThreshold;
 
     _dataChannel?.onDataChannelState = (state) {
       _log('📡 DATA CHANNEL STATE CHANGED', state.toString());
+      if (!identical(channel, _dataChannel)) {
+        // A warm connection the peer closed
+        if (state == RTCDataChannelState.RTCDataChannelClosed) {
+          _warmPeers.takeWhere((warm) => identical(warm.channel, channel))?.close();
+        }
+        return;
+      }
       if (state == RTCDataChannelState.RTCDataChannelOpen) {
         _handleDataChannelOpen();
+      } else if (state == RTCDataChannelState.RTCDataChannelClosed && _fileSessions.isNotEmpty) {
+        if (onDownloadFailed != null) {
+          onDownloadFailed!('Connection interrupted during download');
+        }
+        _suspendFileSessions();
       }
     };
 
     _dataChannel?.onMessage = (message) {
+      // A peer sharing again over a warm connection. Only a new share brings
+      // it back; anything else left over from an earlier one is dropped.
+      if (!identical(channel, _dataChannel)) {
+        if (!_isShareStart(message)) return;
+        final warm = _warmPeers.takeWhere((w) => identical(w.channel, channel));
+        if (warm == null) return;
+        _log('♨️ SHARE ARRIVED OVER WARM CONNECTION', warm.peerId);
+        _activateWarmPeer(warm);
+      }
+      if (_awaitingFirstByte) {
+        _awaitingFirstByte = false;
+        Tracing.record('share.first-byte', _traceId, _traceStartNs);
+      }
+      // Proto v2 file data arrives as binary frames
+      if (message.isBinary) {
+        _handleBinaryFrame(message.binary);
+        return;
+      }
       // Support: proto v2 streaming (files), proto v1 chunked JSON payloads, and legacy single payload
       final text = message.text;
-      _log('📥 RECEIVED DATA MESSAGE (RECEIVER ROLE)', '${text.length} bytes');
+      _debug('📥 RECEIVED DATA MESSAGE (RECEIVER ROLE)', () => '${text.length} bytes');
       try {
         // Handle ACKs
         if (text.startsWith('{') && text.contains('"kind":"ack"')) {
@@ -391,12 +834,14 @@ class WebRTCService {
                   return;
                 }
               }
-              // Fallback: legacy chunk ACK without session scoping
-              if (_ackCompleter != null && !_ackCompleter!.isCompleted) {
-                _log('📬 ACK RECEIVED (legacy)');
+              // Legacy chunk ACK without session scoping
+              if (sid == null && _ackCompleter != null && !_ackCompleter!.isCompleted) {
                 _ackCompleter!.complete();
                 return;
               }
+              // Nothing waits on this ACK (e.g. file_end ACKs, which senders no
+              // longer await); it is still a control message, not content.
+              return;
             }
           } catch (_) {
             // Not a JSON ack we recognize; continue parsing below
@@ -407,6 +852,20 @@ class WebRTCService {
         final isJsonEnvelope = text.startsWith('{') && text.contains('"__sc_proto"');
         if (isJsonEnvelope) {
           final Map<String, dynamic> env = jsonDecode(text);
+          // Proto v2: credit grant for an outgoing file stream
+          if (env['__sc_proto'] == 2 && env['kind'] == 'credit') {
+            final sid = env['sessionId'] as String?;
+            final window = sid != null ? _sendWindows[sid] : null;
+            if (window != null) {
+              window.onCredit((env['consumed'] as num).toInt(), (env['limit'] as num).toInt());
+              final channels = env['channels'];
+              if (channels is List) {
+                _sendStripes[sid!]?.onConsumed(channels.map((c) => (c as num).toInt()).toList());
+              }
+              _wakeSender();
+            }
+            return;
+          }
           // Proto v2: streaming files
           if (env['__sc_proto'] == 2 && env['kind'] == 'files') {
             final mode = env['mode'] as String?;
@@ -416,7 +875,9 @@ class WebRTCService {
               final filesMeta = (env['files'] as List).cast<Map<String, dynamic>>();
               _log('🔰 START FILE STREAM SESSION', {'sessionId': sessionId, 'files': filesMeta.length});
               () async {
-                final prepared = await _promptDirectoryAndPrepareFiles(sessionId, filesMeta);
+                final prepared =
+                    await _promptDirectoryAndPrepareFiles(sessionId, filesMeta, resume: env['resume'] == true);
+                final store = prepared ? await _openChunkStore() : null;
                 if (!prepared) {
                   // Inform sender we cancelled so it can abort immediately
                   final cancelEnv = jsonEncode({
@@ -429,12 +890,39 @@ class WebRTCService {
                   _log('🚫 RECEIVER CANCELLED BEFORE READY', sessionId);
                   return;
                 }
+                // Files continued from an interrupted transfer start where
+                // their journals left off
+                final session = _fileSessions[sessionId];
+                final resumed = <List<int>>[];
+                for (var i = 0; i < (session?.files.length ?? 0); i++) {
+                  if (session!.files[i].received > 0) resumed.add([i, session.files[i].received]);
+                }
+                if (resumed.isNotEmpty) {
+                  _dataChannel?.send(RTCDataChannelMessage(jsonEncode({
+                    '__sc_proto': 2,
+                    'kind': 'files',
+                    'mode': 'resume',
+                    'sessionId': sessionId,
+                    'files': resumed,
+                  })));
+                  _log('⏯️ RESUMING FILES', {'sessionId': sessionId, 'files': resumed});
+                }
                 // Notify sender we are ready to receive chunks
                 final readyEnv = jsonEncode({
                   '__sc_proto': 2,
                   'kind': 'files',
                   'mode': 'ready',
                   'sessionId': sessionId,
+                  // Initial credit: bytes the sender may stream before the first grant
+                  'limit': _fileSessions[sessionId]?.credit.limit,
+                  // File data may come as binary frames
+                  'binary': true,
+                  // Frames may be striped over parallel channels
+                  'stripes': true,
+                  // Chunks kept from earlier transfers can be skipped
+                  'dedup': store != null,
+                  // Frame payload codecs this side can decode
+                  'codecs': [if (_frameCodec.supportsCompression) PayloadCompressor.codecLz4],
                 });
                 _dataChannel?.send(RTCDataChannelMessage(readyEnv));
                 _log('📨 SENT RECEIVER READY', sessionId);
@@ -442,30 +930,72 @@ class WebRTCService {
               return;
             }
             if (mode == 'ready' && sessionId != null) {
-              // Sender side receives readiness ack
+              // Sender side receives readiness ack with the initial credit.
+              // Receivers that predate binary frames or credit grants get
+              // JSON chunks and ACK every 100 of them instead.
+              final limit = (env['limit'] as num?)?.toInt();
+              if (limit != null && env['binary'] == true) {
+                _sendWindows[sessionId]?.onCredit(0, limit);
+                _binarySessions.add(sessionId);
+              } else {
+                _ackPacedSessions[sessionId] = 0;
+              }
+              if (env['stripes'] == true) _stripingSessions.add(sessionId);
+              if (env['dedup'] == true) _dedupSessions.add(sessionId);
+              if ((env['codecs'] as List?)?.contains(PayloadCompressor.codecLz4) == true) {
+                _compressingSessions.add(sessionId);
+              }
               final c = _sessionReadyCompleters.remove(sessionId);
               c?.complete();
               _log('📩 RECEIVED READY ACK', sessionId);
               return;
             }
+            if (mode == 'resume' && sessionId != null) {
+              // Sender side: bytes the receiver kept from an interrupted
+              // transfer, sent just before 'ready'
+              final offsets = <int, int>{};
+              for (final entry in ((env['files'] as List?) ?? const []).cast<List<dynamic>>()) {
+                offsets[(entry[0] as num).toInt()] = (entry[1] as num).toInt();
+              }
+              if (_sessionReadyCompleters.containsKey(sessionId)) _resumeOffsets[sessionId] = offsets;
+              _log('⏯️ RECEIVER RESUMES FILES', {'sessionId': sessionId, 'files': offsets});
+              return;
+            }
+            if (mode == 'manifest' && sessionId != null) {
+              _handleManifest(sessionId, env['fileIndex'] as int? ?? -1, (env['chunks'] as List?) ?? const []);
+              return;
+            }
+            if (mode == 'manifest_end' && sessionId != null) {
+              _handleManifestEnd(sessionId);
+              return;
+            }
+            if (mode == 'have' && sessionId != null) {
+              // Sender side: chunks the receiver already holds
+              _haveCompleters.remove(sessionId)?.complete((env['have'] as List?) ?? const []);
+              return;
+            }
             if (mode == 'cancel' && sessionId != null) {
               // Sender side receives cancellation; abort stream immediately
               final c = _sessionReadyCompleters.remove(sessionId);
               c?.completeError(StateError('Receiver cancelled'));
+              _sendWindows.remove(sessionId)?.dispose();
+              _ackPacedSessions.remove(sessionId);
               _abortFileSession(sessionId);
               _log('🛑 RECEIVED CANCEL, ABORTING SESSION', sessionId);
               return;
             }
             if (mode == 'file_chunk' && sessionId != null) {
+              // Legacy JSON chunk from peers that predate binary frames
               final idx = env['fileIndex'] as int? ?? 0;
               final dataB64 = env['data'] as String? ?? '';
-              _handleFileChunk(sessionId, idx, dataB64);
+              _handleFileChunk(sessionId, idx, base64Decode(dataB64));
               return;
             }
             if (mode == 'file_end' && sessionId != null) {
               final idx = env['fileIndex'] as int? ?? 0;
-              _handleFileEnd(sessionId, idx);
-              // Send scoped ACK for file_end
+              _handleFileEnd(sessionId, idx,
+                  size: (env['size'] as num?)?.toInt(), checksum: env['checksum'] as String?);
+              // Send scoped ACK for file_end; only senders that predate pipelining wait for it
               final ack = jsonEncode({
                 '__sc_proto': 2,
                 'kind': 'ack',
@@ -484,9 +1014,15 @@ class WebRTCService {
                 'ack': 'end',
               });
               _dataChannel?.send(RTCDataChannelMessage(ack));
-              () async {
-                await _finalizeFileSession(sessionId);
-              }();
+              // Striped frames may still be in flight on other channels;
+              // finalize once every file is complete
+              final session = _fileSessions[sessionId];
+              if (session != null && _stripeChannels.isNotEmpty) {
+                session.endSeen = true;
+                _maybeFinalizeFileSession(sessionId);
+              } else {
+                _finalizeFileSession(sessionId);
+              }
               return;
             }
           }
@@ -500,6 +1036,35 @@ class WebRTCService {
               _rxReceivedBytes[id] = 0;
               _rxTotalBytes[id] = total;
               _log('🔰 START CLIPBOARD TRANSFER', {'id': id, 'total': total});
+              final codecs = env['codecs'] as List?;
+              if (env['binary'] == true) {
+                // Take the text as binary UTF-8 frames. The JSON buffer stays
+                // in case the sender gave up waiting for this and sends chunks.
+                _rxTexts[id] = _IncomingText();
+                _dataChannel?.send(RTCDataChannelMessage(jsonEncode({
+                  '__sc_proto': 1,
+                  'kind': 'clipboard',
+                  'mode': 'accept',
+                  'id': id,
+                  'binary': true,
+                  if (_frameCodec.supportsCompression && codecs != null && codecs.contains(PayloadCompressor.codecLz4))
+                    'codec': PayloadCompressor.codecLz4,
+                })));
+              } else if (_textCompressor != null && codecs != null && codecs.contains(PayloadCompressor.codecLz4)) {
+                _dataChannel?.send(RTCDataChannelMessage(jsonEncode({
+                  '__sc_proto': 1,
+                  'kind': 'clipboard',
+                  'mode': 'accept',
+                  'id': id,
+                  'codec': PayloadCompressor.codecLz4,
+                })));
+              }
+              return;
+            }
+            if (mode == 'accept' && id != null) {
+              // Sender side: the receiver can take the text compressed or
+              // as binary frames
+              _textAcceptCompleters.remove(id)?.complete(env);
               return;
             }
             if (mode == 'chunk' && id != null) {
@@ -511,19 +1076,26 @@ class WebRTCService {
                 _rxReceivedBytes[id] = rec;
                 final total = _rxTotalBytes[id] ?? 0;
                 if (total > 0) {
-                  _log('📦 RECEIVED CHUNK', {'id': id, 'received': rec, 'total': total});
+                  _debug('📦 RECEIVED CHUNK', () => {'id': id, 'received': rec, 'total': total});
                 } else {
-                  _log('📦 RECEIVED CHUNK', {'id': id, 'received': rec});
+                  _debug('📦 RECEIVED CHUNK', () => {'id': id, 'received': rec});
                 }
               }
               return;
             }
             if (mode == 'end' && id != null) {
               final buf = _rxBuffers.remove(id);
+              final incoming = _rxTexts.remove(id);
               _rxTotalBytes.remove(id);
               _rxReceivedBytes.remove(id);
-              if (buf != null) {
-                final payload = buf.toString();
+              if (env['binary'] == true) {
+                _finishIncomingText(id, incoming, (env['bytes'] as num?)?.toInt());
+              } else if (buf != null) {
+                final payload = _unpackClipboardText(buf.toString(), env);
+                if (payload == null) {
+                  _log('❌ COULD NOT DECOMPRESS CLIPBOARD TRANSFER', {'id': id, 'codec': env['codec']});
+                  return;
+                }
                 _log('🏁 END CLIPBOARD TRANSFER', {'id': id, 'size': payload.length});
                 _handleClipboardPayload(payload);
               }
@@ -541,6 +1113,8 @@ class WebRTCService {
 
   void _handleDataChannelOpen() {
     _log('✅ DATA CHANNEL IS NOW OPEN');
+    Tracing.record('webrtc.connect', _traceId, _connectStartNs);
+    _connectStartNs = 0;
     
     // Only send content if we have pending content (i.e., we're the sender)
     if (_pendingClipboardContent != null) {
@@ -549,6 +1123,7 @@ class WebRTCService {
         _log('📤 SENDING FILES VIA STREAMING PROTOCOL', {'count': content.files.length});
         _sendFilesStreaming(content).then((_) {
           _log('✅ FILES STREAMED SUCCESSFULLY');
+          _endShareTrace('share.serve');
           _pendingClipboardContent = null;
           _isSending = false;
           _currentTransferContent = null; // Clear current transfer tracking
@@ -558,10 +1133,18 @@ class WebRTCService {
           _currentTransferContent = null; // Clear current transfer tracking
         });
       } else {
-        final payload = _fileTransferService.serializeClipboardContent(content);
-        _log('📤 SENDING TEXT/JSON VIA CHUNKING', {'bytes': payload.length});
-        _sendLargeMessage(payload).then((_) {
+        final Future<void> sent;
+        if (content.text.length >= _binaryTextMinSize) {
+          _log('📤 SENDING TEXT', {'length': content.text.length});
+          sent = _sendClipboardText(content);
+        } else {
+          final payload = _fileTransferService.serializeClipboardContent(content);
+          _log('📤 SENDING TEXT/JSON VIA CHUNKING', {'bytes': payload.length});
+          sent = _sendLargeMessage(payload);
+        }
+        sent.then((_) {
           _log('✅ CLIPBOARD CONTENT SENT SUCCESSFULLY');
+          _endShareTrace('share.serve');
           _pendingClipboardContent = null;
           _isSending = false;
           _currentTransferContent = null; // Clear current transfer tracking
@@ -576,21 +1159,92 @@ class WebRTCService {
     }
   }
 
-  // Send message with chunking and backpressure-safe logic
+  // Records the traced share as [name], from when this side started on it.
+  void _endShareTrace(String name) {
+    Tracing.record(name, _traceId, _traceStartNs);
+    _traceStartNs = 0;
+    _awaitingFirstByte = false;
+  }
+
+  // Send message with chunking and backpressure-safe logic. Large texts are
+  // offered LZ4-compressed; receivers that can decode it reply 'accept', and
+  // older ones do not, so after a short wait the text goes out as is.
   Future<void> _sendLargeMessage(String text) async {
     if (_dataChannel == null) throw StateError('DataChannel not ready');
     final id = DateTime.now().microsecondsSinceEpoch.toString();
-    final total = text.length;
+    final packed = _packClipboardText(text);
     // Start envelope
     final startEnv = jsonEncode({
       '__sc_proto': 1,
       'kind': 'clipboard',
       'mode': 'start',
       'id': id,
-      'total': total,
+      'total': text.length,
       'chunkSize': _chunkSize,
+      if (packed != null) 'codecs': [PayloadCompressor.codecLz4],
     });
+    String? codec;
+    if (packed != null) {
+      codec = (await _offerClipboardText(id, startEnv))?['codec'] as String?;
+    } else {
+      _dataChannel!.send(RTCDataChannelMessage(startEnv));
+    }
+    await _sendClipboardChunks(id, text, codec == PayloadCompressor.codecLz4 ? packed : null);
+  }
+
+  // Sends a clipboard text share. Large texts are offered as binary UTF-8
+  // frames, which skip the JSON content wrapper and per-chunk envelopes;
+  // receivers that do not accept them get the proto v1 chunks instead.
+  Future<void> _sendClipboardText(ClipboardContent content) async {
+    if (_dataChannel == null) throw StateError('DataChannel not ready');
+    final id = DateTime.now().microsecondsSinceEpoch.toString();
+    final offerLz4 = _frameCodec.supportsCompression && SettingsService.instance.compressTransfers;
+    final accept = await _offerClipboardText(id, jsonEncode({
+      '__sc_proto': 1,
+      'kind': 'clipboard',
+      'mode': 'start',
+      'id': id,
+      'total': content.text.length,
+      'chunkSize': _chunkSize,
+      'binary': true,
+      if (offerLz4) 'codecs': [PayloadCompressor.codecLz4],
+    }));
+    final codec = accept?['codec'] as String?;
+    if (accept?['binary'] == true) {
+      await _sendTextFrames(id, content.text, compress: offerLz4 && codec == PayloadCompressor.codecLz4);
+      return;
+    }
+    final payload = _fileTransferService.serializeClipboardContent(content);
+    final packed = codec == PayloadCompressor.codecLz4 ? _packClipboardText(payload) : null;
+    await _sendClipboardChunks(id, payload, packed);
+  }
+
+  // Sends [startEnv] and waits briefly for the receiver's 'accept', which
+  // older receivers never send.
+  Future<Map<String, dynamic>?> _offerClipboardText(String id, String startEnv) async {
+    final accept = Completer<Map<String, dynamic>?>();
+    _textAcceptCompleters[id] = accept;
     _dataChannel!.send(RTCDataChannelMessage(startEnv));
+    Map<String, dynamic>? reply;
+    try {
+      reply = await accept.future.timeout(_textAcceptTimeout);
+    } on TimeoutException catch (_) {
+      _log('ℹ️ RECEIVER DID NOT ACCEPT CLIPBOARD OFFER', id);
+    } finally {
+      _textAcceptCompleters.remove(id);
+    }
+    if (_dataChannel == null) throw StateError('DataChannel closed');
+    return reply;
+  }
+
+  // Sends [text] as proto v1 JSON chunks and the 'end' envelope, or its
+  // [packed] form when the receiver accepted compression.
+  Future<void> _sendClipboardChunks(String id, String text, _PackedText? packed) async {
+    if (packed != null) {
+      _log('🗜️ SENDING CLIPBOARD TEXT COMPRESSED', {'bytes': packed.rawLength, 'wireBytes': packed.data.length});
+      text = packed.data;
+    }
+    final total = text.length;
     // Chunks
     int offset = 0;
     while (offset < total) {
@@ -606,21 +1260,7 @@ class WebRTCService {
       });
       _dataChannel!.send(RTCDataChannelMessage(chunkEnv));
       offset = end;
-
-      // Backpressure: wait if buffered amount is high
-      while ((_dataChannel!.bufferedAmount ?? 0) > _bufferedLowThreshold) {
-        _log('⏳ WAITING BUFFER TO DRAIN (LARGE MESSAGE)', {'buffered': _dataChannel!.bufferedAmount});
-        _bufferLowCompleter = Completer<void>();
-        try {
-          // Wait for buffer to drain - no timeout to prevent data loss
-          await _bufferLowCompleter!.future;
-          _log('✅ BUFFER DRAINED, CONTINUING LARGE MESSAGE');
-        } catch (e) {
-          _log('❌ BUFFER DRAIN ERROR (LARGE MESSAGE)', e.toString());
-          // If there's an error, wait a bit and retry
-          await Future.delayed(const Duration(milliseconds: 100));
-        }
-      }
+      await _drainLargeMessage();
     }
     // End envelope
     final endEnv = jsonEncode({
@@ -628,10 +1268,134 @@ class WebRTCService {
       'kind': 'clipboard',
       'mode': 'end',
       'id': id,
+      if (packed != null) 'codec': PayloadCompressor.codecLz4,
+      if (packed != null) 'rawLength': packed.rawLength,
     });
     _dataChannel!.send(RTCDataChannelMessage(endEnv));
   }
 
+  // Sends [text] as binary frames of UTF-8, encoding a segment at a time so
+  // the sender never holds more than one segment's bytes, then the 'end'
+  // envelope with the byte count. Frame offsets are UTF-8 byte offsets.
+  Future<void> _sendTextFrames(String id, String text, {required bool compress}) async {
+    final session = int.parse(id);
+    var offset = 0;
+    var start = 0;
+    while (start < text.length) {
+      var end = math.min(start + _textSegmentUnits, text.length);
+      // Keep surrogate pairs within one segment
+      if (end < text.length && (text.codeUnitAt(end - 1) & 0xFC00) == 0xD800) end--;
+      final bytes = utf8.encoder.convert(text, start, end);
+      start = end;
+      for (var pos = 0; pos < bytes.length; pos += _chunkSize) {
+        final stop = math.min(pos + _chunkSize, bytes.length);
+        final last = start == text.length && stop == bytes.length;
+        final frame = _frameCodec.encode(
+          sessionId: session,
+          fileIndex: 0,
+          offset: offset,
+          payload: Uint8List.sublistView(bytes, pos, stop),
+          flags: last ? FrameCodec.flagLast : 0,
+          compress: compress,
+        );
+        if (_dataChannel == null) throw StateError('DataChannel closed');
+        _dataChannel!.send(RTCDataChannelMessage.fromBinary(frame));
+        offset += stop - pos;
+        await _drainLargeMessage();
+      }
+    }
+    _log('📤 CLIPBOARD TEXT SENT AS BINARY FRAMES', {'id': id, 'bytes': offset, 'compressed': compress});
+    _dataChannel!.send(RTCDataChannelMessage(jsonEncode({
+      '__sc_proto': 1,
+      'kind': 'clipboard',
+      'mode': 'end',
+      'id': id,
+      'binary': true,
+      'bytes': offset,
+    })));
+  }
+
+  // Backpressure: waits while the data channel buffers too much.
+  Future<void> _drainLargeMessage() async {
+    while ((_dataChannel?.bufferedAmount ?? 0) > _bufferedLowThreshold) {
+      _log('⏳ WAITING BUFFER TO DRAIN (LARGE MESSAGE)', {'buffered': _dataChannel!.bufferedAmount});
+      _bufferLowCompleter = Completer<void>();
+      try {
+        // Wait for buffer to drain - no timeout to prevent data loss
+        await _bufferLowCompleter!.future;
+        _log('✅ BUFFER DRAINED, CONTINUING LARGE MESSAGE');
+      } catch (e) {
+        _log('❌ BUFFER DRAIN ERROR (LARGE MESSAGE)', e.toString());
+        // If there's an error, wait a bit and retry
+        await Future.delayed(const Duration(milliseconds: 100));
+      }
+    }
+  }
+
+  // Decodes a binary text frame into its transfer. Frames arrive in order on
+  // the main channel, so a gap means the transfer is broken.
+  void _handleTextFrame(String id, FileFrame frame) {
+    final incoming = _rxTexts[id]!;
+    if (incoming.failed) return;
+    try {
+      if (frame.offset != incoming.received) {
+        throw StateError('Text frame at ${frame.offset}, expected ${incoming.received}');
+      }
+      incoming.add(frame.payload);
+      _debug('📦 RECEIVED TEXT FRAME', () => {'id': id, 'received': incoming.received});
+    } catch (e) {
+      incoming.failed = true;
+      _log('❌ CLIPBOARD TEXT FRAME REJECTED', {'id': id, 'error': e.toString()});
+    }
+  }
+
+  void _finishIncomingText(String id, _IncomingText? incoming, int? bytes) {
+    if (incoming == null || incoming.failed || bytes != incoming.received) {
+      _log('❌ CLIPBOARD TEXT TRANSFER INCOMPLETE', {'id': id, 'bytes': bytes, 'received': incoming?.received});
+      return;
+    }
+    final String text;
+    try {
+      text = incoming.finish();
+    } on FormatException catch (e) {
+      _log('❌ CLIPBOARD TEXT IS NOT UTF-8', {'id': id, 'error': e.message});
+      return;
+    }
+    _log('🏁 END CLIPBOARD TRANSFER', {'id': id, 'bytes': bytes, 'length': text.length});
+    _handleReceivedText(text);
+  }
+
+  // LZ4 + base64 form of [text], or null if it is small, compression is off
+  // or unavailable, or it would not save at least a tenth after base64.
+  _PackedText? _packClipboardText(String text) {
+    final compressor = _textCompressor;
+    if (compressor == null || text.length < _compressTextMinSize || !SettingsService.instance.compressTransfers) {
+      return null;
+    }
+    final raw = utf8.encode(text);
+    final compressed = compressor.compress(raw);
+    if (compressed == null) return null;
+    final encoded = base64Encode(compressed);
+    if (encoded.length > raw.length * 9 ~/ 10) return null;
+    return _PackedText(encoded, raw.length);
+  }
+
+  // The clipboard text carried by a finished proto v1 transfer, undoing the
+  // compression named in the 'end' envelope. Null if it cannot be decoded.
+  String? _unpackClipboardText(String received, Map<String, dynamic> endEnv) {
+    final codec = endEnv['codec'] as String?;
+    if (codec == null) return received;
+    final compressor = _textCompressor;
+    final rawLength = (endEnv['rawLength'] as num?)?.toInt();
+    if (codec != PayloadCompressor.codecLz4 || compressor == null || rawLength == null) return null;
+    try {
+      final raw = compressor.decompress(base64Decode(received), rawLength);
+      return raw == null ? null : utf8.decode(raw);
+    } on FormatException {
+      return null;
+    }
+  }
+
   void _handleClipboardPayload(String payload) {
     try {
       final clipboardContent = _fileTransferService.deserializeClipboardContent(payload);
@@ -644,29 +1408,38 @@ class WebRTCService {
         _notificationService.showClipboardReceiveSuccess(_peerId ?? 'Unknown Device', isFile: true);
         
         // Notify UI about received files
+        _endShareTrace('share.complete');
         if (onClipboardReceived != null) {
           final fileName = clipboardContent.files.isNotEmpty ? clipboardContent.files.first.name : 'files';
           onClipboardReceived!('file', fileName, _peerId ?? 'Unknown Device');
         }
       } else {
-        _log('📝 RECEIVED TEXT', clipboardContent.text);
-        Clipboard.setData(ClipboardData(text: clipboardContent.text));
-        _log('📋 TEXT CLIPBOARD UPDATED SUCCESSFULLY');
-        
-        // Show clipboard receive success notification for text
-        _notificationService.showClipboardReceiveSuccess(_peerId ?? 'Unknown Device', isFile: false);
-        
-        // Notify UI about received text
-        if (onClipboardReceived != null) {
-          onClipboardReceived!('text', clipboardContent.text, _peerId ?? 'Unknown Device');
-        }
+        _handleReceivedText(clipboardContent.text);
       }
     } catch (e) {
       _log('❌ ERROR PROCESSING RECEIVED DATA', e.toString());
     }
   }
 
-  Future<void> _resetConnection() async {
+  void _handleReceivedText(String text) {
+    _log('📝 RECEIVED TEXT', text);
+    Clipboard.setData(ClipboardData(text: text));
+    _log('📋 TEXT CLIPBOARD UPDATED SUCCESSFULLY');
+
+    // Show clipboard receive success notification for text
+    _notificationService.showClipboardReceiveSuccess(_peerId ?? 'Unknown Device', isFile: false);
+
+    // Notify UI about received text
+    _endShareTrace('share.complete');
+    if (onClipboardReceived != null) {
+      onClipboardReceived!('text', text, _peerId ?? 'Unknown Device');
+    }
+  }
+
+  // Replaces the active connection with a fresh one for [replacing]. The
+  // old one is kept warm for its peer unless it is down or [replacing] is
+  // that peer, which is negotiating a new one.
+  Future<void> _resetConnection({String? replacing}) async {
     // Prevent multiple simultaneous resets
     if (_isResetting) {
       _log('⚠️ RESET ALREADY IN PROGRESS, SKIPPING');
@@ -683,32 +1456,13 @@ class WebRTCService {
     _log('🔍 AFTER RESET - Remote desc set: $_remoteDescriptionSet, Queue size: ${_pendingCandidates.length}');
     
     try {
+      final previous = _detachActivePeer();
       // Quick synchronous cleanup first
       _forceCleanup();
-      
-      // Close connections with individual try-catch blocks
-      if (_dataChannel != null) {
-        _log('📡 CLOSING EXISTING DATA CHANNEL');
-        try {
-          _dataChannel?.close();
-        } catch (e) {
-          _log('⚠️ ERROR CLOSING DATA CHANNEL (IGNORING)', e.toString());
-        }
-        _dataChannel = null;
-      }
-      
-      if (_peerConnection != null) {
-        _log('🔗 CLOSING EXISTING PEER CONNECTION');
-        try {
-          _peerConnection?.close();
-        } catch (e) {
-          _log('⚠️ ERROR CLOSING PEER CONNECTION (IGNORING)', e.toString());
-        }
-        _peerConnection = null;
-      }
+      _parkOrClose(previous, replacing: replacing);
       
       // Reinitialize with timeout protection
-      await _initWithTimeout();
+      await _initWithTimeout(peerId: replacing);
       _log('✅ PEER CONNECTION RESET COMPLETE');
     } catch (e) {
       _log('❌ ERROR DURING RESET (FORCING CLEANUP)', e.toString());
@@ -716,7 +1470,7 @@ class WebRTCService {
       
       // Try to reinitialize anyway
       try {
-        await _initWithTimeout();
+        await _initWithTimeout(peerId: replacing);
         _log('✅ FORCED RESET RECOVERY SUCCESSFUL');
       } catch (recoveryError) {
         _log('❌ FORCED RESET RECOVERY FAILED', recoveryError.toString());
@@ -726,9 +1480,77 @@ class WebRTCService {
     }
   }
 
-  Future<void> _initWithTimeout() async {
+  // The active connection and its channels, for parking; closes a
+  // connection that never got a data channel, or one still carrying a
+  // transfer, so the peer sees it end instead of waiting on a parked channel.
+  _WarmPeer? _detachActivePeer() {
+    final connection = _peerConnection;
+    if (connection == null) return null;
+    final channel = _dataChannel;
+    final peer = _peerId;
+    final busy = _isSending || _fileSessions.isNotEmpty || _rxTexts.isNotEmpty;
+    if (channel == null || peer == null || busy) {
+      if (busy) _log('♨️ CLOSING BUSY CONNECTION INSTEAD OF KEEPING IT WARM', peer);
+      _closeStripeChannels();
+      try {
+        connection.close();
+      } catch (e) {
+        _log('⚠️ ERROR CLOSING PEER CONNECTION (IGNORING)', e.toString());
+      }
+      return null;
+    }
+    return _WarmPeer(peer, connection, channel, Map.of(_stripeChannels));
+  }
+
+  // Whether [message] opens a new share: a files or clipboard 'start'.
+  static bool _isShareStart(RTCDataChannelMessage message) {
+    if (message.isBinary) return false;
+    final text = message.text;
+    if (!text.startsWith('{') || !text.contains('"start"')) return false;
+    try {
+      final env = jsonDecode(text);
+      return env is Map && env['mode'] == 'start' && (env['kind'] == 'files' || env['kind'] == 'clipboard');
+    } on FormatException {
+      return false;
+    }
+  }
+
+  void _parkOrClose(_WarmPeer? warm, {String? replacing}) {
+    if (warm == null) return;
+    if (!warm.isOpen || warm.peerId == replacing) {
+      warm.close();
+      return;
+    }
+    if (_warmPeers.put(warm.peerId, warm, warm.channelCount * _warmChannelCostBytes)) {
+      _debug('♨️ KEEPING CONNECTION WARM', () => {'peer': warm.peerId, 'pooled': _warmPeers.length});
+    }
+  }
+
+  // Makes a pooled connection the active one, parking the active one.
+  void _activateWarmPeer(_WarmPeer warm) {
+    final previous = _detachActivePeer();
+    _forceCleanup();
+    _parkOrClose(previous);
+    _peerConnection = warm.connection;
+    _dataChannel = warm.channel;
+    _stripeChannels.addAll(warm.stripes);
+    _peerId = warm.peerId;
+    _isInitialized = true;
+    _remoteDescriptionSet = true;
+  }
+
+  /// Closes any warm connection to [peerId], e.g. once it disconnects.
+  void forgetPeer(String peerId) {
+    final warm = _warmPeers.take(peerId);
+    if (warm != null) {
+      _log('♨️ CLOSING WARM CONNECTION', peerId);
+      warm.close();
+    }
+  }
+
+  Future<void> _initWithTimeout({String? peerId}) async {
     return Future.any([
-      init(),
+      init(peerId: peerId),
       Future.delayed(const Duration(seconds: 3)).then((_) => throw TimeoutException('Init timeout', const Duration(seconds: 3))),
     ]);
   }
@@ -745,24 +1567,49 @@ class WebRTCService {
     _pendingClipboardContent = null;
     _currentTransferContent = null;
     _preparedOutgoingContent = null;
-    _fileSessions.clear();
+    _suspendFileSessions();
     _dataChannel = null;
+    _stripeChannels.clear();
+    _binarySessions.clear();
+    _stripingSessions.clear();
+    _dedupSessions.clear();
+    _compressingSessions.clear();
+    _resumeOffsets.clear();
+    _haveCompleters.clear();
+    for (final stripes in _sendStripes.values) {
+      stripes.dispose();
+    }
+    _sendStripes.clear();
     _peerConnection = null;
     _peerId = null;
     _isInitialized = false;
     _pendingCandidates.clear();
     _remoteDescriptionSet = false;
+    _discardLocalCandidates();
   }
 
-  Future<void> createOffer(String? peerId) async {
+  Future<void> createOffer(String? peerId, {String? traceId}) async {
+    _traceId = traceId;
+    _traceStartNs = Tracing.now();
+    _awaitingFirstByte = false;
+    final span = Tracing.start('webrtc.create-offer', traceId);
     try {
       _log('🎯 createOffer CALLED', peerId);
       
       // Note: Queue management is now handled by the requesting client
       // The sender always responds immediately if available
 
-      // Reset connection state for clean start of this send
-      await _resetConnection();
+      // Share over a warm connection to the peer if one is still open,
+      // else reset connection state for clean start of this send
+      final warm = peerId != null ? _warmPeers.take(peerId) : null;
+      final reuse = warm != null && warm.isOpen;
+      if (reuse) {
+        _log('♨️ REUSING WARM CONNECTION', peerId);
+        _activateWarmPeer(warm);
+      } else {
+        warm?.close();
+        await _resetConnection(replacing: peerId);
+      }
       
       if (_peerConnection == null) {
         _log('❌ ERROR: PeerConnection is null after reset, cannot create offer');
@@ -809,6 +1656,13 @@ class WebRTCService {
         }
         _preparedOutgoingContent = null;
       }
+
+      if (reuse) {
+        span.end();
+        _connectStartNs = 0;
+        _handleDataChannelOpen();
+        return;
+      }
       
       // Create data channel with proper configuration for large file transfers
       _log('📡 CREATING DATA CHANNEL');
@@ -828,6 +1682,13 @@ class WebRTCService {
       } else {
         _log('❌ FAILED TO CREATE DATA CHANNEL');
       }
+
+      // Optional parallel channels for striping file frames
+      final parallel = SettingsService.instance.parallelDataChannels;
+      for (var k = 1; k < parallel && _dataChannel != null; k++) {
+        final channel = await _peerConnection?.createDataChannel('$_stripeLabelPrefix$k', dataChannelInit);
+        if (channel != null) _setupStripeChannel(channel, k);
+      }
       
       // Create and send offer
       _log('📡 CREATING OFFER');
@@ -841,8 +1702,15 @@ class WebRTCService {
           'sdp_length': description.sdp?.length ?? 0,
           'callback_exists': onSignalGenerated != null
         });
-        onSignalGenerated!(_peerId!, {'type': 'offer', 'sdp': description.sdp});
+        onSignalGenerated!(_peerId!, {
+          'type': 'offer',
+          'sdp': description.sdp,
+          'candidateBatches': true,
+          if (_traceId != null) 'traceId': _traceId,
+        });
         _log('✅ OFFER SIGNAL SENT SUCCESSFULLY');
+        span.end();
+        _connectStartNs = Tracing.now();
       } else {
         _log('❌ ERROR: Cannot send offer signal', {
           'peerId': _peerId,
@@ -859,11 +1727,21 @@ class WebRTCService {
 
   Future<void> handleOffer(dynamic offer, String from) async {
     _log('📥 HANDLING OFFER FROM', from);
+    final traceId = offer['traceId'] as String?;
+    if (traceId != null && traceId != _traceId) {
+      // A share this side did not request, or whose request-share it lost
+      _traceId = traceId;
+      _traceStartNs = Tracing.now();
+      _awaitingFirstByte = true;
+    }
+    final span = Tracing.start('webrtc.handle-offer', _traceId);
     _log('🔍 CURRENT STATE - Remote desc set: $_remoteDescriptionSet, Queue size: ${_pendingCandidates.length}');
     
     try {
-      // Reset connection state for clean start
-      await _resetConnection();
+      // Reset connection state for clean start; the peer is replacing any
+      // warm connection it had with us
+      forgetPeer(from);
+      await _resetConnection(replacing: from);
       
       if (_peerConnection == null) {
         _log('❌ ERROR: PeerConnection is null after reset, cannot handle offer');
@@ -871,6 +1749,7 @@ class WebRTCService {
       }
       
       _peerId = from;
+      _peerTakesCandidateBatches = offer['candidateBatches'] == true;
       final offerSdp = offer['sdp'] as String?;
       final offerType = offer['type'] as String? ?? 'offer';
 
@@ -928,8 +1807,14 @@ class WebRTCService {
         await _peerConnection!.setLocalDescription(description);
         _log('📤 SENDING ANSWER');
         if (onSignalGenerated != null) {
-          onSignalGenerated!(_peerId!, {'type': 'answer', 'sdp': description.sdp});
+          onSignalGenerated!(_peerId!, {
+            'type': 'answer',
+            'sdp': description.sdp,
+            'candidateBatches': true,
+          });
         }
+        span.end();
+        _connectStartNs = Tracing.now();
       }
     } catch (e, stackTrace) {
       _log('❌ CRITICAL ERROR IN HANDLE OFFER', e.toString());
@@ -941,6 +1826,14 @@ class WebRTCService {
     }
   }
 
+  /// Starts tracing the share requested under [traceId], until its first
+  /// byte and its completion arrive.
+  void expectShare(String traceId) {
+    _traceId = traceId;
+    _traceStartNs = Tracing.now();
+    _awaitingFirstByte = true;
+  }
+
   Future<void> handleAnswer(dynamic answer) async {
     if (!_isInitialized) {
       await init();
@@ -967,6 +1860,7 @@ class WebRTCService {
       return;
     }
 
+    _peerTakesCandidateBatches = answer['candidateBatches'] == true;
     try {
       await _peerConnection!.setRemoteDescription(
         RTCSessionDescription(answer['sdp'], answer['type']),
@@ -983,39 +1877,39 @@ class WebRTCService {
     }
   }
 
-  Future<void> handleCandidate(dynamic candidate) async {
+  /// Takes one remote ICE candidate, or the list of them in a 'candidates'
+  /// signal, and adds them in order once the remote description is set.
+  /// [end] marks the peer's end of candidates.
+  Future<void> handleCandidate(dynamic candidate, {bool end = false}) async {
     if (!_isInitialized) {
       await init();
     }
-    
+
+    final received = candidate is List ? candidate : [candidate];
+    for (final c in received) {
+      _pendingCandidates.add(RTCIceCandidate(
+        c['candidate'],
+        c['sdpMid'],
+        c['sdpMLineIndex'],
+      ));
+    }
+    if (end) {
+      _log('🧊 REMOTE END OF CANDIDATES');
+    }
+
     if (_peerConnection == null || _isResetting) {
-      _log('❌ ERROR: PeerConnection is null or resetting, queueing candidate');
-      final iceCandidate = RTCIceCandidate(
-        candidate['candidate'],
-        candidate['sdpMid'],
-        candidate['sdpMLineIndex'],
-      );
-      _pendingCandidates.add(iceCandidate);
+      _log('❌ ERROR: PeerConnection is null or resetting, queueing candidates');
       return;
     }
-    
-    final iceCandidate = RTCIceCandidate(
-      candidate['candidate'],
-      candidate['sdpMid'],
-      candidate['sdpMLineIndex'],
-    );
-    
-    _log('🧊 HANDLING ICE CANDIDATE - Remote desc set: $_remoteDescriptionSet, Queue size: ${_pendingCandidates.length}');
-    
+
+    _debug('🧊 HANDLING ICE CANDIDATES - Remote desc set: $_remoteDescriptionSet, Queue size: ${_pendingCandidates.length}');
+
     // Always queue until remote description is confirmed ready; processing is batched
-    if (!_remoteDescriptionSet || _isResetting || _peerConnection?.getRemoteDescription() == null) {
-      _log('📦 QUEUEING ICE CANDIDATE (remote description not ready)');
-      _pendingCandidates.add(iceCandidate);
+    if (!_remoteDescriptionSet || _peerConnection?.getRemoteDescription() == null) {
+      _debug('📦 QUEUEING ICE CANDIDATES (remote description not ready)');
       return;
     }
-    
-    // If RD is ready, we'll still prefer processing through the queue to keep ordering
-    _pendingCandidates.add(iceCandidate);
+
     await _processQueuedCandidates();
   }
 
@@ -1096,18 +1990,43 @@ class WebRTCService {
   // ===== Streaming file receiver helpers (proto v2) =====
   // Returns true if files were prepared and we're ready to receive.
   // Returns false if the user cancelled any save dialog; in that case, the caller should send a 'cancel' control.
+  // Large files are written through a TransferJournal; with [resume] (the
+  // sender can skip ahead), a file whose journal survives from an interrupted
+  // transfer goes back to its earlier save path and continues from there.
   Future<bool> _promptDirectoryAndPrepareFiles(
-      String sessionId, List<Map<String, dynamic>> filesMeta) async {
+      String sessionId, List<Map<String, dynamic>> filesMeta, {bool resume = false}) async {
+    if (filesMeta.isEmpty) {
+      _log('⚠️ NO FILES META PROVIDED FOR SESSION', sessionId);
+      return false;
+    }
     final incomingFiles = <_IncomingFile>[];
+    // One writer thread and buffer pool for all of the session's files
+    final writeWorker = WriteWorker.create();
     try {
-      if (filesMeta.isEmpty) {
-        _log('⚠️ NO FILES META PROVIDED FOR SESSION', sessionId);
-        return false;
-      }
 
       String? sessionDir;
       for (final meta in filesMeta) {
         final name = (meta['name'] as String?) ?? 'file';
+        final size = (meta['size'] as num?)?.toInt() ?? 0;
+        final identity = TransferJournal.identityOf(meta);
+        final resumed = resume && identity != null ? await TransferJournal.resume(identity) : null;
+        if (resumed != null) {
+          sessionDir ??= File(resumed.targetPath).parent.path;
+          final offset = resumed.verifiedOffset;
+          final incoming = _IncomingFile(
+            name: name,
+            size: size,
+            checksum: (meta['checksum'] as String?) ?? '',
+            file: resumed.dataFile,
+            writer: await FileWriter.open(resumed.dataFile, size, keep: offset, worker: writeWorker),
+            hasher: resumed.takeHasher(),
+            journal: resumed,
+          );
+          incoming.received = offset;
+          incoming.reassembler.start(offset);
+          incomingFiles.add(incoming);
+          continue;
+        }
         
         // Notify UI that we're waiting for user to choose download location
         if (onWaitingForUserLocation != null) {
@@ -1135,27 +2054,26 @@ class WebRTCService {
           }
           
           // Clean up any files that were already created for this session
-          for (final created in incomingFiles) {
-            await created.sink.close();
-            await created.file.delete();
-          }
+          await _discardIncomingFiles(incomingFiles);
+          writeWorker?.dispose();
           return false;
         }
 
         sessionDir ??= File(savePath).parent.path;
         await File(savePath).parent.create(recursive: true);
-        final file = File(savePath);
-        final sink = file.openWrite();
+        final journal = identity != null ? await TransferJournal.create(savePath, identity, size) : null;
+        final file = journal?.dataFile ?? File(savePath);
         incomingFiles.add(_IncomingFile(
           name: name,
-          size: (meta['size'] as num?)?.toInt() ?? 0,
+          size: size,
           checksum: (meta['checksum'] as String?) ?? '',
           file: file,
-          sink: sink,
+          writer: await FileWriter.open(file, size, worker: writeWorker),
+          journal: journal,
         ));
       }
 
-      final session = _FileSession(sessionDir!, incomingFiles);
+      final session = _FileSession(sessionDir!, incomingFiles, writeWorker);
       _fileSessions[sessionId] = session;
       _log('📂 FILE SESSION PREPARED', {
         'sessionId': sessionId,
@@ -1179,15 +2097,45 @@ class WebRTCService {
     } catch (e) {
       _log('❌ ERROR PREPARING FILE SESSION', e.toString());
       // Clean up any files that were created before the error
-      for (final created in incomingFiles) {
-        await created.sink.close();
-        await created.file.delete();
-      }
+      await _discardIncomingFiles(incomingFiles);
+      writeWorker?.dispose();
       return false;
     }
   }
 
-  Future<void> _handleFileChunk(String sessionId, int fileIndex, String dataB64) async {
+  // Closes and deletes files of a session that never started, journals
+  // included; a resumed transfer the user backed out of starts over next time.
+  Future<void> _discardIncomingFiles(List<_IncomingFile> files) async {
+    for (final created in files) {
+      created.hasher.dispose();
+      created.reassembler.dispose();
+      try {
+        await created.writer.close();
+      } catch (_) {}
+      try {
+        if (await created.file.exists()) await created.file.delete();
+      } catch (_) {}
+      await created.journal?.discard();
+    }
+  }
+
+  void _handleBinaryFrame(Uint8List data, {int channel = 0}) {
+    final frame = _frameCodec.decode(data);
+    if (frame == null) {
+      _log('⚠️ DROPPING MALFORMED BINARY FRAME', '${data.length} bytes');
+      return;
+    }
+    final textId = frame.sessionId.toString();
+    if (_rxTexts.containsKey(textId)) {
+      _handleTextFrame(textId, frame);
+      return;
+    }
+    _handleFileChunk(frame.sessionId.toString(), frame.fileIndex, frame.payload,
+        offset: frame.offset, channel: channel);
+  }
+
+  Future<void> _handleFileChunk(String sessionId, int fileIndex, Uint8List bytes,
+      {int? offset, int channel = 0}) async {
     final session = _fileSessions[sessionId];
     if (session == null) {
       _log('⚠️ RECEIVED CHUNK FOR UNKNOWN SESSION', sessionId);
@@ -1198,10 +2146,30 @@ class WebRTCService {
       return;
     }
     try {
-      final bytes = base64Decode(dataB64);
       final incoming = session.files[fileIndex];
-      incoming.sink.add(bytes);
-      incoming.received += bytes.length;
+      if (incoming.actualChecksum != null) {
+        throw StateError('Chunk at offset $offset after ${incoming.name} completed');
+      }
+      while (session.channelConsumed.length <= channel) {
+        session.channelConsumed.add(0);
+      }
+      session.channelConsumed[channel] += bytes.length;
+      var grant = session.credit.onConsumed(bytes.length);
+      // Senders that predate credit grants wait for an ACK every 100 chunks
+      session.chunksReceived++;
+      if (session.chunksReceived % 100 == 0) {
+        _dataChannel?.send(RTCDataChannelMessage('{"__sc_proto":2,"kind":"ack"}'));
+      }
+
+      // Striped frames can arrive out of order; write whatever is contiguous.
+      // Bytes are released once on disk, so data held for reordering or
+      // queued behind a slow disk counts against the credit window.
+      for (final data in incoming.reassembler.accept(offset ?? incoming.received, bytes)) {
+        _writeIncoming(incoming, data);
+      }
+      _fillFromStore(incoming);
+      if (_releaseWritten(sessionId, session)) grant = true;
+      if (_fileSessions[sessionId] != session) return; // a write failed
 
       // Compute normalized progress [0.0, 1.0]
       final double progress = incoming.size > 0
@@ -1209,7 +2177,7 @@ class WebRTCService {
           : 0.0;
 
       // Log every data message progress for debugging
-      _log('⬇️ PROGRESS', {
+      _debug('⬇️ PROGRESS', () => {
         'file': incoming.name,
         'received': incoming.received,
         'of': incoming.size
@@ -1238,11 +2206,13 @@ class WebRTCService {
         }
       }
 
-      // Send ACK for flow control
-      session.chunksReceived++;
-      if (session.chunksReceived % 100 == 0) {
-        _log('📬 SENDING ACK');
-        _dataChannel?.send(RTCDataChannelMessage('{"__sc_proto":2,"kind":"ack"}'));
+      // Return credit so the sender can keep its window full
+      if (grant) {
+        _sendCredit(sessionId, session);
+      }
+      if (incoming.endSeen && incoming.received >= incoming.size) {
+        await _completeIncomingFile(incoming);
+        _maybeFinalizeFileSession(sessionId);
       }
     } catch (e) {
       _log('❌ ERROR WRITING FILE CHUNK', {'sessionId': sessionId, 'index': fileIndex, 'error': e.toString()});
@@ -1254,7 +2224,190 @@ class WebRTCService {
     }
   }
 
-  Future<void> _handleFileEnd(String sessionId, int fileIndex) async {
+  // Appends contiguous file data, keeping finished manifest chunks in the
+  // chunk store for later transfers.
+  void _writeIncoming(_IncomingFile incoming, Uint8List data) {
+    _keepChunks(incoming, incoming.received, data);
+    incoming.hasher.add(data);
+    incoming.writer.write(incoming.received, data);
+    incoming.journal?.add(data);
+    incoming.received += data.length;
+  }
+
+  void _keepChunks(_IncomingFile incoming, int offset, Uint8List data) {
+    final store = _chunkStore;
+    final manifest = incoming.manifest;
+    if (store == null || manifest.isEmpty) return;
+    var pos = 0;
+    while (pos < data.length && incoming.keepCursor < manifest.length) {
+      final chunk = manifest[incoming.keepCursor];
+      if (offset + pos < chunk.offset) {
+        // Resumed mid-chunk; the bytes before the next chunk are not kept
+        pos = math.min(data.length, chunk.offset - offset);
+        continue;
+      }
+      final stored = incoming.stored.contains(incoming.keepCursor);
+      final take = math.min(data.length - pos, chunk.end - (offset + pos));
+      if (!stored) incoming.keepBuffer.add(Uint8List.sublistView(data, pos, pos + take));
+      pos += take;
+      if (offset + pos < chunk.end) break;
+      if (!stored && !store.put(chunk.digestHex, incoming.keepBuffer.takeBytes())) {
+        _log('⚠️ CHUNK NOT KEPT', {'file': incoming.name, 'offset': chunk.offset});
+      }
+      incoming.keepCursor++;
+    }
+  }
+
+  // Writes stored chunks the sender skipped once the file reaches them, along
+  // with any received data held behind them. They are pinned in the store
+  // until then. Throws if a stored chunk has gone missing.
+  void _fillFromStore(_IncomingFile incoming) {
+    final pending = incoming.pendingStored;
+    while (pending.isNotEmpty && incoming.manifest[pending.first].offset == incoming.received) {
+      final chunk = incoming.manifest[pending.removeFirst()];
+      final data = _chunkStore?.get(chunk.digestHex, chunk.length);
+      _chunkStore?.unpin(chunk.digestHex);
+      if (data == null) {
+        throw StateError('Stored chunk at ${chunk.offset} of ${incoming.name} is missing');
+      }
+      final ready = incoming.reassembler.accept(chunk.offset, data);
+      // Only bytes that came over the channel count toward credit
+      incoming.uncredited += data.length;
+      for (final bytes in ready) {
+        _writeIncoming(incoming, bytes);
+      }
+    }
+  }
+
+  // Releases credit for bytes the file writers have put on disk. Returns true
+  // when a grant is due. While writes are queued it keeps checking on a
+  // timer, since no further chunks arrive once the sender runs out of credit.
+  bool _releaseWritten(String sessionId, _FileSession session) {
+    var grant = false;
+    var queued = false;
+    for (final f in session.files) {
+      var bytes = f.writer.takeWritten();
+      final own = math.min(bytes, f.uncredited);
+      f.uncredited -= own;
+      bytes -= own;
+      if (bytes > 0 && session.credit.onReleased(bytes)) grant = true;
+      if (f.writer.failed) {
+        _failWrite(sessionId, f);
+        return false;
+      }
+      if (f.writer.queued > 0) queued = true;
+    }
+    if (queued) {
+      session.releaseTimer ??= Timer(_writerPollInterval, () {
+        session.releaseTimer = null;
+        if (_fileSessions[sessionId] != session) return;
+        if (_releaseWritten(sessionId, session)) _sendCredit(sessionId, session);
+      });
+    }
+    return grant;
+  }
+
+  // A write to disk failed (e.g. the disk is full): stop the sender and
+  // drop the session.
+  void _failWrite(String sessionId, _IncomingFile incoming) {
+    _log('❌ FILE WRITE FAILED', {'sessionId': sessionId, 'file': incoming.name});
+    if (onDownloadFailed != null) {
+      onDownloadFailed!('Could not write ${incoming.name}');
+    }
+    _dataChannel?.send(RTCDataChannelMessage(jsonEncode({
+      '__sc_proto': 2,
+      'kind': 'files',
+      'mode': 'cancel',
+      'sessionId': sessionId,
+    })));
+    _abortFileSession(sessionId);
+  }
+
+  void _handleManifest(String sessionId, int fileIndex, List<dynamic> chunks) {
+    final session = _fileSessions[sessionId];
+    if (session == null || fileIndex < 0 || fileIndex >= session.files.length) return;
+    final manifest = session.files[fileIndex].manifest;
+    var offset = manifest.isEmpty ? 0 : manifest.last.end;
+    for (final entry in chunks.cast<List<dynamic>>()) {
+      final length = (entry[0] as num).toInt();
+      manifest.add(ContentChunk(offset, length, entry[1] as String));
+      offset += length;
+    }
+  }
+
+  // Replies with the manifest chunks already in the chunk store, then fills
+  // them in as the files reach them.
+  void _handleManifestEnd(String sessionId) {
+    final session = _fileSessions[sessionId];
+    if (session == null) return;
+    final store = _chunkStore;
+    final have = <List<int>>[];
+    for (var i = 0; i < session.files.length; i++) {
+      final incoming = session.files[i];
+      final manifest = incoming.manifest;
+      if (manifest.isEmpty) continue;
+      if (store == null || manifest.last.end != incoming.size) {
+        _log('⚠️ IGNORING CHUNK MANIFEST', {'file': incoming.name});
+        manifest.clear();
+        continue;
+      }
+      // Data before a resumed offset is already on disk
+      while (incoming.keepCursor < manifest.length && manifest[incoming.keepCursor].offset < incoming.received) {
+        incoming.keepCursor++;
+      }
+      for (var c = incoming.keepCursor; c < manifest.length; c++) {
+        // Pinned so that chunks kept meanwhile cannot evict it
+        if (!store.pin(manifest[c].digestHex)) continue;
+        incoming.stored.add(c);
+        incoming.pendingStored.add(c);
+        if (have.isNotEmpty && have.last[0] == i && have.last[1] + have.last[2] == c) {
+          have.last[2]++;
+        } else {
+          have.add([i, c, 1]);
+        }
+      }
+    }
+    _dataChannel?.send(RTCDataChannelMessage(jsonEncode({
+      '__sc_proto': 2,
+      'kind': 'files',
+      'mode': 'have',
+      'sessionId': sessionId,
+      'have': have,
+    })));
+    _log('♻️ SENT HAVE', {'sessionId': sessionId, 'ranges': have.length});
+    for (final incoming in session.files) {
+      try {
+        _fillFromStore(incoming);
+      } catch (e) {
+        _log('❌ ERROR FILLING FROM CHUNK STORE', e.toString());
+        if (onDownloadFailed != null) {
+          onDownloadFailed!('Chunk store error: ${e.toString()}');
+        }
+      }
+    }
+  }
+
+  // Unpins the stored chunks [incoming] will no longer write.
+  void _unpinStored(_IncomingFile incoming) {
+    for (final c in incoming.pendingStored) {
+      _chunkStore?.unpin(incoming.manifest[c].digestHex);
+    }
+    incoming.pendingStored.clear();
+  }
+
+  Future<ChunkStore?> _openChunkStore() async {
+    if (!SettingsService.instance.deduplicateTransfers) return null;
+    if (_chunkStore != null) return _chunkStore;
+    try {
+      final dir = await getApplicationSupportDirectory();
+      _chunkStore = ChunkStore.open('${dir.path}${Platform.pathSeparator}chunk_store');
+    } catch (e) {
+      _log('⚠️ CHUNK STORE UNAVAILABLE', e.toString());
+    }
+    return _chunkStore;
+  }
+
+  Future<void> _handleFileEnd(String sessionId, int fileIndex, {int? size, String? checksum}) async {
     final session = _fileSessions[sessionId];
     if (session == null) {
       _log('⚠️ RECEIVED END FOR UNKNOWN SESSION', sessionId);
@@ -1264,60 +2417,118 @@ class WebRTCService {
       _log('⚠️ INVALID FILE INDEX', {'sessionId': sessionId, 'index': fileIndex});
       return;
     }
-    if (fileIndex < 0 || fileIndex >= session.files.length) return;
+    final incoming = session.files[fileIndex];
+    if (incoming.endSeen) return; // duplicate file_end
+    incoming.endSeen = true;
+    // Prefer the checksum announced at start; senders that stream from disk
+    // only know it once the file is sent, so they put it in file_end.
+    incoming.expectedChecksum = incoming.checksum.isNotEmpty ? incoming.checksum : (checksum ?? '');
+    if (size != null && size != incoming.size) {
+      _log('⚠️ FILE SIZE CHANGED', {'file': incoming.name, 'announced': incoming.size, 'sent': size});
+    }
+    // Frames striped over other channels may still be on their way; on a
+    // single ordered channel everything sent has arrived by now
+    if (incoming.received >= incoming.size || _stripeChannels.isEmpty) {
+      await _completeIncomingFile(incoming);
+      _maybeFinalizeFileSession(sessionId);
+    }
+  }
+
+  // Closes a file once its file_end and all of its bytes have arrived. The
+  // digest covers exactly the bytes written, hashed as they arrived.
+  Future<void> _completeIncomingFile(_IncomingFile incoming) async {
+    if (incoming.actualChecksum != null) return;
+    final expected = incoming.expectedChecksum;
+    incoming.actualChecksum = incoming.hasher.close();
+    incoming.reassembler.dispose();
+    incoming.checksumOk = expected.isEmpty || expected == incoming.actualChecksum;
+    if (!incoming.checksumOk) {
+      _log('❌ CHECKSUM MISMATCH', {
+        'file': incoming.name,
+        'expected': expected,
+        'actual': incoming.actualChecksum,
+      });
+    }
     try {
-      final incoming = session.files[fileIndex];
-      await incoming.sink.flush();
-      await incoming.sink.close();
+      await incoming.writer.close();
       _log('✅ FILE STREAM CLOSED', {'file': incoming.name, 'bytes': incoming.received});
     } catch (e) {
-      _log('❌ ERROR CLOSING FILE SINK', e.toString());
+      _log('❌ ERROR CLOSING FILE WRITER', e.toString());
+      incoming.checksumOk = false; // not all of it reached the disk
     }
   }
 
+  void _maybeFinalizeFileSession(String sessionId) {
+    final session = _fileSessions[sessionId];
+    if (session == null || !session.endSeen) return;
+    if (session.files.any((f) => f.actualChecksum == null)) return;
+    () async {
+      await _finalizeFileSession(sessionId);
+    }();
+  }
+
   Future<void> _finalizeFileSession(String sessionId) async {
     final session = _fileSessions.remove(sessionId);
     if (session == null) return;
+    session.releaseTimer?.cancel();
+    session.credit.dispose();
     try {
       for (final f in session.files) {
+        _unpinStored(f);
         try {
-          await f.sink.flush();
-          await f.sink.close();
+          await f.writer.close();
         } catch (_) {}
       }
-      // Optional: verify checksums and sizes
-      bool allOk = true;
+      session.writeWorker?.dispose();
+      // Verify sizes and the checksums computed while streaming; the files
+      // are not read back from disk.
+      final failed = <_IncomingFile>[];
       for (final f in session.files) {
-        final sizeOk = f.size == 0 || f.file.lengthSync() == f.size;
-        // TODO: implement checksum verification if desired
-        const checksumOk = true;
-        if (!sizeOk || !checksumOk) {
-          allOk = false;
+        f.hasher.dispose(); // no-op unless file_end never arrived
+        f.reassembler.dispose();
+        final sizeOk = f.size == 0 || f.received == f.size;
+        if (!sizeOk || !f.checksumOk || f.actualChecksum == null) {
+          _log('⚠️ VERIFICATION FAILED', {
+            'file': f.name,
+            'sizeOk': sizeOk,
+            'checksumOk': f.checksumOk && f.actualChecksum != null,
+          });
+          failed.add(f);
         }
       }
-      if (!allOk) {
-        _log('⚠️ VERIFICATION FAILED', {
-          'file': session.files.isNotEmpty ? session.files.first.name : 'n/a',
-          'sizeOk': false,
-          'checksumOk': false,
-        });
+      if (failed.isNotEmpty) {
+        // Never hand corrupt data to the clipboard
+        for (final f in session.files) {
+          try {
+            if (await f.file.exists()) {
+              await f.file.delete();
+            }
+          } catch (_) {}
+          await f.journal?.discard();
+        }
+        if (onDownloadFailed != null) {
+          onDownloadFailed!('Checksum mismatch: ${failed.map((f) => f.name).join(', ')}');
+        }
+        return;
+      }
+      // Journaled files move from their part files into place
+      for (final f in session.files) {
+        final journal = f.journal;
+        if (journal != null) f.file = await journal.complete();
       }
       // Build clipboard file list from saved files
       final filesForClipboard = <FileData>[];
       for (final f in session.files) {
-        final bytes = await f.file.readAsBytes();
-        final checksum = sha256.convert(bytes).toString();
         filesForClipboard.add(FileData(
           name: f.name,
           path: f.file.path,
-          size: bytes.length,
+          size: f.received,
           mimeType: 'application/octet-stream',
-          checksum: checksum,
-          content: Uint8List.fromList(bytes),
+          checksum: f.actualChecksum!,
         ));
       }
       await _fileTransferService.setClipboardContent(ClipboardContent.files(filesForClipboard));
-      _log('🎉 FILE SESSION FINALIZED', {'sessionId': sessionId, 'files': filesForClipboard.length, 'verified': allOk});
+      _log('🎉 FILE SESSION FINALIZED', {'sessionId': sessionId, 'files': filesForClipboard.length, 'verified': true});
       
       // Optionally show download completion notifications for each file
       if (SettingsService.instance.sendDownloadProgressNotifications) {
@@ -1327,6 +2538,7 @@ class WebRTCService {
       }
       
       // Notify UI about received files for Last Retrieved Clipboard section
+      _endShareTrace('share.complete');
       if (onClipboardReceived != null && session.files.isNotEmpty) {
         final fileNames = session.files.map((f) => f.name).join(', ');
         onClipboardReceived!('file', fileNames, _peerId ?? 'Unknown Device');
@@ -1346,24 +2558,62 @@ class WebRTCService {
   Future<void> _abortFileSession(String sessionId) async {
     final session = _fileSessions.remove(sessionId);
     if (session == null) return;
+    session.releaseTimer?.cancel();
+    session.credit.dispose();
     try {
       for (final f in session.files) {
+        _unpinStored(f);
+        f.hasher.dispose();
+        f.reassembler.dispose();
         try {
-          await f.sink.flush();
-          await f.sink.close();
+          await f.writer.close();
         } catch (_) {}
         try {
           if (await f.file.exists()) {
             await f.file.delete();
           }
         } catch (_) {}
+        await f.journal?.discard();
       }
+      session.writeWorker?.dispose();
       _log('🧹 FILE SESSION ABORTED AND CLEANED', {'sessionId': sessionId});
     } catch (e) {
       _log('❌ ERROR ABORTING FILE SESSION', e.toString());
     }
   }
 
+  // Stops receiving after the connection dropped. Journaled files keep their
+  // part file and journal so the next transfer of the same file resumes;
+  // other partial files are deleted.
+  Future<void> _suspendFileSessions() async {
+    final sessions = List<_FileSession>.from(_fileSessions.values);
+    _fileSessions.clear();
+    for (final session in sessions) {
+      session.releaseTimer?.cancel();
+      session.credit.dispose();
+      for (final f in session.files) {
+        _unpinStored(f);
+        f.hasher.dispose();
+        f.reassembler.dispose();
+        try {
+          await f.writer.close();
+        } catch (_) {}
+        final journal = f.journal;
+        if (journal != null) {
+          await journal.suspend();
+          continue;
+        }
+        try {
+          if (await f.file.exists()) {
+            await f.file.delete();
+          }
+        } catch (_) {}
+      }
+      session.writeWorker?.dispose();
+    }
+    if (sessions.isNotEmpty) _log('⏸️ FILE SESSIONS SUSPENDED', {'sessions': sessions.length});
+  }
+
   void cancelCurrentDownload() {
     _log('🚫 CANCELLING CURRENT DOWNLOAD');
     
@@ -1376,11 +2626,28 @@ class WebRTCService {
     // Clear any pending completers
     _sessionReadyCompleters.clear();
     _ackWaiters.clear();
+    for (final window in _sendWindows.values) {
+      window.dispose();
+    }
+    _sendWindows.clear();
+    _ackPacedSessions.clear();
+    _binarySessions.clear();
+    _stripingSessions.clear();
+    _dedupSessions.clear();
+    _compressingSessions.clear();
+    _resumeOffsets.clear();
+    _haveCompleters.clear();
+    for (final stripes in _sendStripes.values) {
+      stripes.dispose();
+    }
+    _sendStripes.clear();
     
     // Clear receive buffers
     _rxBuffers.clear();
     _rxReceivedBytes.clear();
     _rxTotalBytes.clear();
+    _rxTexts.clear();
+    _textAcceptCompleters.clear();
     
     // Reset sending state
     _isSending = false;
@@ -1390,8 +2657,38 @@ class WebRTCService {
   }
 
   void dispose() {
+    _warmPeers.clear();
+    _closeStripeChannels();
+    _chunkStore?.close();
+    _chunkStore = null;
     _dataChannel?.close();
     _peerConnection?.close();
+    _frameCodec.dispose();
+    _textCompressor?.dispose();
+  }
+}
+
+// A connection parked in the warm pool, with the channels it carried.
+class _WarmPeer {
+  final String peerId;
+  final RTCPeerConnection connection;
+  final RTCDataChannel channel;
+  final Map<int, RTCDataChannel> stripes;
+
+  _WarmPeer(this.peerId, this.connection, this.channel, this.stripes);
+
+  bool get isOpen => channel.state == RTCDataChannelState.RTCDataChannelOpen;
+  int get channelCount => 1 + stripes.length;
+
+  void close() {
+    for (final c in [...stripes.values, channel]) {
+      try {
+        c.close();
+      } catch (_) {}
+    }
+    try {
+      connection.close();
+    } catch (_) {}
   }
 }
 
@@ -1399,18 +2696,107 @@ class WebRTCService {
 class _FileSession {
   final String dirPath;
   final List<_IncomingFile> files;
-  int chunksReceived = 0;
+  final ReceiveWindow credit = ReceiveWindow(); // grants to the sender
+  int chunksReceived = 0; // for the legacy ACK every 100 chunks
+  final List<int> channelConsumed = [0]; // bytes taken off each data channel
+  Timer? releaseTimer; // polls the file writers while writes are queued
+  bool endSeen = false;
+  final WriteWorker? writeWorker; // shared by the writers; disposed after they close
+
+  _FileSession(this.dirPath, this.files, this.writeWorker);
+}
+
+// The data channels one outgoing session stripes its frames over.
+class _SendStripes {
+  final List<int> indices; // channel index (0 = main) per lane
+  final List<RTCDataChannel> channels;
+  final StripeScheduler scheduler;
+
+  _SendStripes(Map<int, RTCDataChannel> lanes)
+      : indices = lanes.keys.toList(),
+        channels = lanes.values.toList(),
+        scheduler = StripeScheduler(lanes.length);
+
+  int get bufferedAmount => channels.fold(0, (sum, c) => sum + (c.bufferedAmount ?? 0));
+
+  /// Applies the receiver's per-channel consumed counts, indexed by channel.
+  void onConsumed(List<int> consumed) {
+    for (var lane = 0; lane < indices.length; lane++) {
+      final index = indices[lane];
+      if (index < consumed.length) scheduler.onConsumed(lane, consumed[index]);
+    }
+  }
+
+  void dispose() => scheduler.dispose();
+}
+
+class _PackedText {
+  final String data; // base64 of the LZ4 block
+  final int rawLength; // UTF-8 bytes before compression
+
+  _PackedText(this.data, this.rawLength);
+}
+
+// Clipboard text arriving as binary frames, decoded from UTF-8 as each
+// frame lands rather than buffered as bytes.
+class _IncomingText {
+  final StringBuffer _text = StringBuffer();
+  late final ByteConversionSink _decoder =
+      const Utf8Decoder().startChunkedConversion(StringConversionSink.fromStringSink(_text));
+  int received = 0; // UTF-8 bytes
+  bool failed = false;
+
+  void add(Uint8List bytes) {
+    _decoder.add(bytes);
+    received += bytes.length;
+  }
+
+  // Throws a FormatException if the text ended mid-sequence.
+  String finish() {
+    _decoder.close();
+    return _text.toString();
+  }
+}
+
+class _OutgoingFile {
+  final FileChunkSource source;
+  final bool compress;
+  int chunkCount = 0;
+  int wireBytes = 0; // payload bytes after compression
+
+  _OutgoingFile(this.source, this.compress);
+}
+
+// A file's content-defined chunks, sent ahead of its data, and the chunk
+// ranges ([first, count]) the receiver already has.
+class _OutgoingManifest {
+  final FileChunkSource source;
+  final List<ContentChunk> chunks;
+  final List<List<int>> have = [];
 
-  _FileSession(this.dirPath, this.files);
+  _OutgoingManifest(this.source, this.chunks);
 }
 
 class _IncomingFile {
   final String name;
   final int size;
   final String checksum;
-  final File file;
-  final IOSink sink;
+  File file; // the part file until a journaled transfer completes
+  final FileWriter writer;
+  final StreamingSha256 hasher; // fed as chunks arrive
+  final TransferJournal? journal; // large files only; makes the transfer resumable
+  final FileReassembler reassembler = FileReassembler(); // orders striped chunks
+  bool endSeen = false;
+  String expectedChecksum = '';
+  String? actualChecksum; // set once file_end and all bytes have arrived
+  final List<ContentChunk> manifest = []; // sender's chunks, when deduplicating
+  final Set<int> stored = {}; // manifest chunks taken from the chunk store
+  final Queue<int> pendingStored = Queue<int>(); // stored chunks not yet written
+  final BytesBuilder keepBuffer = BytesBuilder(); // current chunk, to keep
+  int keepCursor = 0;
+  bool checksumOk = true;
   int received = 0;
+  int uncredited = 0; // bytes written from the chunk store, not owed to the sender
   int? lastReportedMB;
   DateTime? lastNotificationTime;
   _IncomingFile({
@@ -1418,8 +2804,10 @@ class _IncomingFile {
     required this.size,
     required this.checksum,
     required this.file,
-    required this.sink,
-  });
+    required this.writer,
+    StreamingSha256? hasher,
+    this.journal,
+  }) : hasher = hasher ?? StreamingSha256();
 }
 
 
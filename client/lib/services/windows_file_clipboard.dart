@@ -1,101 +1,134 @@
-// ignore_for_file: constant_identifier_names
-import 'dart:ffi';
+import 'dart:convert';
 import 'dart:io';
-import 'package:ffi/ffi.dart';
-import 'package:shared_clipboard/core/logger.dart';
-
-// Windows API constants
-const int CF_HDROP = 15;
+import 'dart:typed_data';
 
-class WindowsFileClipboard {
-  static final AppLogger _logger = logTag('WIN_CLIP');
-  static List<String>? getFilePaths() {
-    if (!Platform.isWindows) return null;
-
-    try {
-      // Load required DLLs
-      final user32 = DynamicLibrary.open('user32.dll');
-      final kernel32 = DynamicLibrary.open('kernel32.dll');
-      final shell32 = DynamicLibrary.open('shell32.dll');
-
-      // Define function signatures
-      final openClipboard = user32.lookupFunction<Int32 Function(IntPtr), int Function(int)>('OpenClipboard');
-      final closeClipboard = user32.lookupFunction<Int32 Function(), int Function()>('CloseClipboard');
-      final getClipboardData = user32.lookupFunction<IntPtr Function(Int32), int Function(int)>('GetClipboardData');
-      final globalLock = kernel32.lookupFunction<Pointer Function(IntPtr), Pointer Function(int)>('GlobalLock');
-      final globalUnlock = kernel32.lookupFunction<Int32 Function(IntPtr), int Function(int)>('GlobalUnlock');
-      final dragQueryFileW = shell32.lookupFunction<
-          Int32 Function(IntPtr, Int32, Pointer<Uint16>, Int32),
-          int Function(int, int, Pointer<Uint16>, int)>('DragQueryFileW');
-
-      // Open clipboard
-      if (openClipboard(0) == 0) {
-        _logger.e('Failed to open clipboard for file reading');
-        return null;
-      }
+import 'package:flutter/services.dart';
+import 'package:shared_clipboard/core/logger.dart';
 
-      // Get HDROP handle
-      final hDrop = getClipboardData(CF_HDROP);
-      if (hDrop == 0) {
-        _logger.w('No HDROP data in clipboard');
-        closeClipboard();
-        return null;
-      }
+/// What one read of the Windows clipboard found; empty members were not
+/// there.
+class WindowsClipboardFormats {
+  final String text;
+  final List<String> files;
+  final String html;
+  final Uint8List png;
 
-      // Lock the global memory
-      final dropFiles = globalLock(hDrop);
-      if (dropFiles == nullptr) {
-        _logger.e('Failed to lock HDROP memory');
-        closeClipboard();
-        return null;
-      }
+  WindowsClipboardFormats({
+    this.text = '',
+    this.files = const [],
+    this.html = '',
+    Uint8List? png,
+  }) : png = png ?? Uint8List(0);
 
-      // Get number of files
-      final fileCount = dragQueryFileW(hDrop, 0xFFFFFFFF, nullptr, 0);
-      _logger.i('Found files in clipboard', {'count': fileCount});
+  Map<String, Object> get summary => {
+        'textLength': text.length,
+        'files': files.length,
+        'htmlLength': html.length,
+        'pngBytes': png.length,
+      };
+}
 
-      List<String> filePaths = [];
+/// Reads the Windows clipboard through the runner's ClipboardReaderPlugin
+/// (windows/runner/clipboard_reader_plugin.h), which takes every format
+/// asked for in one clipboard open and answers with one binary descriptor
+/// (windows/runner/native/clipboard_formats.h).
+class WindowsFileClipboard {
+  static const MethodChannel _channel = MethodChannel('clipboard_reader');
+  static final AppLogger _logger = logTag('WIN_CLIP');
 
-      // Get each file path
-      for (int i = 0; i < fileCount; i++) {
-        // Get required buffer size
-        final bufferSize = dragQueryFileW(hDrop, i, nullptr, 0);
-        if (bufferSize == 0) continue;
+  // Format tags of the descriptor, and their bits in a read mask.
+  static const int formatText = 1;
+  static const int formatFiles = 2;
+  static const int formatHtml = 3;
+  static const int formatPng = 4;
+  static const int _magic = 0x46434353;
+  static const int _version = 1;
 
-        // Allocate buffer and get file path
-        final pathBuffer = calloc<Uint16>(bufferSize + 1);
-        final actualSize = dragQueryFileW(hDrop, i, pathBuffer, bufferSize + 1);
-        
-        if (actualSize > 0) {
-          // Convert UTF-16 to Dart string
-          final filePath = _utf16ToString(pathBuffer, actualSize);
-          filePaths.add(filePath);
-          _logger.d('Clipboard file', {'index': i, 'path': filePath});
-        }
-        
-        calloc.free(pathBuffer);
-      }
+  static int bit(int format) => 1 << format;
 
-      // Cleanup
-      globalUnlock(hDrop);
-      closeClipboard();
+  /// Reads the formats in [mask] (of [bit]s), all by default. Returns null
+  /// off Windows or if the clipboard could not be read.
+  static Future<WindowsClipboardFormats?> read([int? mask]) async {
+    if (!Platform.isWindows) return null;
+    try {
+      final descriptor = await _channel.invokeMethod<Uint8List>('read', mask);
+      if (descriptor == null) return null;
+      final formats = decode(descriptor);
+      if (formats == null) _logger.w('Malformed clipboard descriptor', {'bytes': descriptor.length});
+      return formats;
+    } on PlatformException catch (e) {
+      _logger.w('Clipboard read failed', e.message);
+      return null;
+    } on MissingPluginException {
+      return null;
+    }
+  }
 
-      return filePaths;
+  /// Paths of the files on the clipboard (CF_HDROP), or null if it could
+  /// not be read.
+  static Future<List<String>?> getFilePaths() async {
+    final formats = await read(bit(formatFiles));
+    return formats?.files;
+  }
 
-    } catch (e, st) {
-      _logger.e('Error reading Windows file clipboard', e, st);
+  /// Parses a descriptor, skipping formats it does not know. Returns null
+  /// if it is malformed.
+  static WindowsClipboardFormats? decode(Uint8List descriptor) {
+    final data = ByteData.sublistView(descriptor);
+    if (data.lengthInBytes < 6 ||
+        data.getUint32(0, Endian.little) != _magic ||
+        data.getUint8(4) != _version) {
       return null;
     }
+    var text = '';
+    var files = <String>[];
+    var html = '';
+    Uint8List? png;
+    final count = data.getUint8(5);
+    var at = 6;
+    for (var i = 0; i < count; i++) {
+      if (data.lengthInBytes - at < 5) return null;
+      final format = data.getUint8(at);
+      final length = data.getUint32(at + 1, Endian.little);
+      at += 5;
+      if (data.lengthInBytes - at < length) return null;
+      final bytes = Uint8List.sublistView(descriptor, at, at + length);
+      at += length;
+      switch (format) {
+        case formatText:
+          text = utf8.decode(bytes, allowMalformed: true);
+          break;
+        case formatHtml:
+          html = utf8.decode(bytes, allowMalformed: true);
+          break;
+        case formatPng:
+          png = bytes;
+          break;
+        case formatFiles:
+          final parsed = _decodeFiles(bytes);
+          if (parsed == null) return null;
+          files = parsed;
+          break;
+      }
+    }
+    if (at != data.lengthInBytes) return null;
+    return WindowsClipboardFormats(text: text, files: files, html: html, png: png);
   }
 
-  // Helper function to convert UTF-16 pointer to Dart string
-  static String _utf16ToString(Pointer<Uint16> ptr, int length) {
-    final codeUnits = <int>[];
-    for (int i = 0; i < length; i++) {
-      final codeUnit = ptr[i];
-      if (codeUnit == 0) break; // Null terminator
-      codeUnits.add(codeUnit);
+  static List<String>? _decodeFiles(Uint8List bytes) {
+    if (bytes.length < 4) return null;
+    final data = ByteData.sublistView(bytes);
+    final count = data.getUint32(0, Endian.little);
+    final files = <String>[];
+    var at = 4;
+    for (var i = 0; i < count; i++) {
+      if (bytes.length - at < 4) return null;
+      final length = data.getUint32(at, Endian.little);
+      at += 4;
+      if (bytes.length - at < length) return null;
+      files.add(utf8.decode(Uint8List.sublistView(bytes, at, at + length), allowMalformed: true));
+      at += length;
     }
-    return String.fromCharCodes(codeUnits);
+    return files;
   }
 }
@@ -87,7 +87,7 @@ class _HomePageState extends State<HomePage> {
   String? _currentDownloadFileName;
   
   // Request queue management (requesting client side)
-  final List<String> _requestQueue = []; // queue of pending requests to process
+  final List<String?> _requestQueue = []; // pending requests, by the sharer id asked for (null: any)
   bool _isRequestingClipboard = false; // track if currently requesting
 
   // Helper function to truncate long text with ellipsis
@@ -413,7 +413,11 @@ class _HomePageState extends State<HomePage> {
                 'id': deviceId,
                 'name': device['name'] ?? device['deviceName'] ?? 'Unknown Device',
                 'connectedAt': DateTime.now(),
+                'readyToShare': device['readyToShare'] == true,
               });
+            } else if (device.containsKey('readyToShare')) {
+              // A ready change or share-available for a listed device.
+              _connectedDevices[existingIndex]['readyToShare'] = device['readyToShare'] == true;
             }
           }
           
@@ -442,6 +446,7 @@ class _HomePageState extends State<HomePage> {
                 'id': deviceId,
                 'name': device['name'] ?? device['deviceName'] ?? 'Unknown Device',
                 'connectedAt': DateTime.now(), // We don't know the actual connection time
+                'readyToShare': device['readyToShare'] == true,
               });
             }
           }
@@ -690,7 +695,9 @@ class _HomePageState extends State<HomePage> {
     }
   }
 
-  void _requestClipboard() {
+  // Asks the server for a clipboard, from |sharer| if given (a device from
+  // the connected devices list), else from whichever device it picks.
+  void _requestClipboard([Map<String, dynamic>? sharer]) {
     if (!_isInitialized) return;
     
     // Check if we have connected devices
@@ -700,12 +707,15 @@ class _HomePageState extends State<HomePage> {
       return;
     }
     
-    final deviceName = _connectedDevices.isNotEmpty ? _connectedDevices.first['name'] : 'device';
+    final deviceName = sharer != null
+        ? (sharer['name'] ?? 'device')
+        : (_connectedDevices.isNotEmpty ? _connectedDevices.first['name'] : 'device');
+    final sharerId = sharer?['id'] as String?;
     
     // If already downloading/requesting, queue this request locally
     if (_isRequestingClipboard || _isDownloading) {
       _logger.i('Already downloading/requesting, queueing request locally');
-      _requestQueue.add('Clipboard request from $deviceName');
+      _requestQueue.add(sharerId);
       _addPendingRequest(deviceName, ClipboardRequestStatus.waitingForRequestToComplete);
       
       // Show queued notification
@@ -714,10 +724,10 @@ class _HomePageState extends State<HomePage> {
     }
     
     // Process request immediately
-    _processClipboardRequest(deviceName);
+    _processClipboardRequest(deviceName, sharerId);
   }
   
-  void _processClipboardRequest(String deviceName) {
+  void _processClipboardRequest(String deviceName, [String? sharerId]) {
     _logger.i('Processing clipboard request to $deviceName');
     
     try {
@@ -732,7 +742,7 @@ class _HomePageState extends State<HomePage> {
         _addPendingRequest(deviceName, ClipboardRequestStatus.sendingRequest);
       }
       
-      _socketService.sendRequestShare();
+      _socketService.sendRequestShare(deviceId: sharerId);
       _logger.i('Clipboard request sent successfully');
       
       // Update status to waiting for response
@@ -752,11 +762,20 @@ class _HomePageState extends State<HomePage> {
     }
     
     _logger.i('Processing next queued request');
-    final nextRequest = _requestQueue.removeAt(0);
+    final sharerId = _requestQueue.removeAt(0);
     
-    // Extract device name from request string
-    final deviceName = _connectedDevices.isNotEmpty ? _connectedDevices.first['name'] : 'device';
-    _processClipboardRequest(deviceName);
+    // Name the request after the device it asks, if it is still connected
+    Map<String, dynamic>? sharer;
+    for (final device in _connectedDevices) {
+      if (sharerId != null && device['id'] == sharerId) {
+        sharer = device;
+        break;
+      }
+    }
+    final deviceName = sharer != null
+        ? (sharer['name'] ?? 'device')
+        : (_connectedDevices.isNotEmpty ? _connectedDevices.first['name'] : 'device');
+    _processClipboardRequest(deviceName, sharer != null ? sharerId : null);
   }
 
   void _cancelPendingRequest(int index) {
@@ -888,6 +907,11 @@ class _HomePageState extends State<HomePage> {
                           style: const TextStyle(fontSize: 14),
                         ),
                         subtitle: Text('Connected $durationText'),
+                        // Ask this device for its clipboard rather than
+                        // whichever one the server would pick.
+                        onTap: _isInitialized && device['readyToShare'] == true
+                            ? () => _requestClipboard(device)
+                            : null,
                       );
                     },
                   ),
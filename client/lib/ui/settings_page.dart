@@ -33,9 +33,77 @@ class SettingsPage extends StatelessWidget {
               onChanged: (v) => settings.sendDownloadProgressNotifications = v,
             ),
           );
+          tiles.addAll([
+            const Divider(height: 1),
+            SwitchListTile(
+              title: const Text('Skip data the receiver already has'),
+              subtitle: const Text('Keep received file chunks so re-shared or edited files only send what changed'),
+              value: settings.deduplicateTransfers,
+              onChanged: (v) => settings.deduplicateTransfers = v,
+            ),
+            const Divider(height: 1),
+            SwitchListTile(
+              title: const Text('Compress transfers'),
+              subtitle: const Text('Compress text and documents on the fly. Photos, video and archives are sent as they are'),
+              value: settings.compressTransfers,
+              onChanged: (v) => settings.compressTransfers = v,
+            ),
+            const Divider(height: 1),
+            ListTile(
+              title: const Text('Device group'),
+              subtitle: Text(settings.deviceGroup.isEmpty
+                  ? 'Default group. Set the same group on your devices to keep them apart from others on the server'
+                  : settings.deviceGroup),
+              trailing: const Icon(Icons.edit),
+              onTap: () => _editDeviceGroup(context, settings),
+            ),
+            const Divider(height: 1),
+            ListTile(
+              title: const Text('Parallel data channels'),
+              subtitle: const Text('Split large file transfers across several channels. Helps on lossy, high-latency links'),
+              trailing: DropdownButton<int>(
+                value: settings.parallelDataChannels,
+                items: SettingsService.parallelDataChannelOptions
+                    .map((n) => DropdownMenuItem<int>(value: n, child: Text('$n')))
+                    .toList(),
+                onChanged: (v) {
+                  if (v != null) settings.parallelDataChannels = v;
+                },
+              ),
+            ),
+          ]);
           return ListView(children: tiles);
         },
       ),
     );
   }
+
+  Future<void> _editDeviceGroup(BuildContext context, SettingsService settings) async {
+    final controller = TextEditingController(text: settings.deviceGroup);
+    final group = await showDialog<String>(
+      context: context,
+      builder: (context) => AlertDialog(
+        title: const Text('Device group'),
+        content: TextField(
+          controller: controller,
+          autofocus: true,
+          maxLength: SettingsService.maxDeviceGroupLength,
+          decoration: const InputDecoration(hintText: 'Leave empty for the default group'),
+          onSubmitted: (value) => Navigator.of(context).pop(value),
+        ),
+        actions: [
+          TextButton(
+            onPressed: () => Navigator.of(context).pop(),
+            child: const Text('Cancel'),
+          ),
+          TextButton(
+            onPressed: () => Navigator.of(context).pop(controller.text),
+            child: const Text('Save'),
+          ),
+        ],
+      ),
+    );
+    controller.dispose();
+    if (group != null) settings.deviceGroup = group;
+  }
 }
@@ -0,0 +1,126 @@
+#include "clipboard_reader_plugin.h"
+
+#include <flutter/standard_method_codec.h>
+#include <windows.h>
+
+#include <shellapi.h>
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "utils.h"
+
+namespace {
+
+// Runs |read| on the locked contents of clipboard format |format|, if the
+// clipboard holds it.
+template <typename Read>
+void WithClipboardData(UINT format, Read read) {
+  HANDLE handle = ::GetClipboardData(format);
+  if (handle == nullptr) {
+    return;
+  }
+  const void* data = ::GlobalLock(handle);
+  if (data == nullptr) {
+    return;
+  }
+  read(static_cast<const uint8_t*>(data), ::GlobalSize(handle));
+  ::GlobalUnlock(handle);
+}
+
+// Paths from DragQueryFileW, for drop lists sc::ParseDropFiles declines.
+std::vector<std::string> QueryDropFiles(HDROP drop) {
+  std::vector<std::string> files;
+  const UINT count = ::DragQueryFileW(drop, 0xFFFFFFFF, nullptr, 0);
+  std::wstring path;
+  for (UINT i = 0; i < count; i++) {
+    const UINT length = ::DragQueryFileW(drop, i, nullptr, 0);
+    path.resize(length + 1);
+    if (length == 0 ||
+        ::DragQueryFileW(drop, i, path.data(), length + 1) == 0) {
+      continue;
+    }
+    std::string utf8_path = Utf8FromUtf16(path.c_str());
+    if (!utf8_path.empty()) {
+      files.push_back(std::move(utf8_path));
+    }
+  }
+  return files;
+}
+
+}  // namespace
+
+ClipboardReaderPlugin::ClipboardReaderPlugin(
+    flutter::BinaryMessenger* messenger) {
+  channel_ = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
+      messenger, "clipboard_reader",
+      &flutter::StandardMethodCodec::GetInstance());
+  channel_->SetMethodCallHandler([this](const auto& call, auto result) {
+    HandleMethodCall(call, std::move(result));
+  });
+}
+
+ClipboardReaderPlugin::~ClipboardReaderPlugin() {}
+
+bool ClipboardReaderPlugin::Read(uint32_t mask,
+                                 sc::ClipboardFormats* formats) {
+  static const UINT html_format = ::RegisterClipboardFormatW(L"HTML Format");
+  static const UINT png_format = ::RegisterClipboardFormatW(L"PNG");
+
+  *formats = sc::ClipboardFormats();
+  if (!::OpenClipboard(nullptr)) {
+    return false;
+  }
+  if (mask & sc::ClipboardFormatBit(sc::ClipboardFormat::kFiles)) {
+    WithClipboardData(CF_HDROP, [&](const uint8_t* data, size_t size) {
+      if (!sc::ParseDropFiles(data, size, &formats->files)) {
+        formats->files = QueryDropFiles(
+            static_cast<HDROP>(::GetClipboardData(CF_HDROP)));
+      }
+    });
+  }
+  if (mask & sc::ClipboardFormatBit(sc::ClipboardFormat::kText)) {
+    WithClipboardData(CF_UNICODETEXT, [&](const uint8_t* data, size_t size) {
+      sc::AppendUtf8FromUtf16(reinterpret_cast<const char16_t*>(data),
+                              size / sizeof(char16_t), &formats->text);
+    });
+  }
+  if ((mask & sc::ClipboardFormatBit(sc::ClipboardFormat::kHtml)) &&
+      html_format != 0) {
+    WithClipboardData(html_format, [&](const uint8_t* data, size_t size) {
+      std::string_view cf_html(reinterpret_cast<const char*>(data), size);
+      cf_html = cf_html.substr(0, cf_html.find('\0'));
+      sc::ExtractHtmlFragment(cf_html, &formats->html);
+    });
+  }
+  if ((mask & sc::ClipboardFormatBit(sc::ClipboardFormat::kPng)) &&
+      png_format != 0) {
+    WithClipboardData(png_format, [&](const uint8_t* data, size_t size) {
+      formats->png.assign(data, data + size);
+    });
+  }
+  ::CloseClipboard();
+  return true;
+}
+
+void ClipboardReaderPlugin::HandleMethodCall(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (call.method_name() != "read") {
+    result->NotImplemented();
+    return;
+  }
+  uint32_t mask = sc::kAllClipboardFormats;
+  if (const auto* value = std::get_if<int32_t>(call.arguments())) {
+    mask = static_cast<uint32_t>(*value);
+  }
+  sc::ClipboardFormats formats;
+  if (!Read(mask, &formats)) {
+    result->Error("clipboard_busy", "The clipboard is open in another app.");
+    return;
+  }
+  result->Success(
+      flutter::EncodableValue(sc::EncodeClipboardDescriptor(formats)));
+}
@@ -0,0 +1,39 @@
+#ifndef RUNNER_CLIPBOARD_READER_PLUGIN_H_
+#define RUNNER_CLIPBOARD_READER_PLUGIN_H_
+
+#include <flutter/binary_messenger.h>
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "clipboard_formats.h"
+
+// Reads the clipboard for the Dart side over the "clipboard_reader" method
+// channel: "read" opens the clipboard once, takes CF_HDROP, CF_UNICODETEXT,
+// "HTML Format" and "PNG" from it, and returns them as one descriptor
+// (see clipboard_formats.h). An optional int argument is the mask of
+// sc::ClipboardFormatBit()s to read; all formats otherwise.
+class ClipboardReaderPlugin {
+ public:
+  explicit ClipboardReaderPlugin(flutter::BinaryMessenger* messenger);
+  ~ClipboardReaderPlugin();
+
+  // Prevent copying.
+  ClipboardReaderPlugin(ClipboardReaderPlugin const&) = delete;
+  ClipboardReaderPlugin& operator=(ClipboardReaderPlugin const&) = delete;
+
+  // Reads the formats in |mask| from the clipboard into |formats|. Returns
+  // false if the clipboard could not be opened. Safe from any thread.
+  static bool Read(uint32_t mask, sc::ClipboardFormats* formats);
+
+ private:
+  void HandleMethodCall(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_;
+};
+
+#endif  // RUNNER_CLIPBOARD_READER_PLUGIN_H_
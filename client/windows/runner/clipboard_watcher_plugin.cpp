@@ -0,0 +1,132 @@
+#include "clipboard_watcher_plugin.h"
+
+#include <flutter/standard_method_codec.h>
+
+#include <string>
+#include <utility>
+
+#include "clipboard_reader_plugin.h"
+
+namespace {
+
+// Posted by the watcher's thread when it has a new snapshot.
+constexpr UINT kSnapshotReadyMessage = WM_APP + 1;
+
+const char* KindName(sc::ClipboardSnapshot::Kind kind) {
+  switch (kind) {
+    case sc::ClipboardSnapshot::Kind::kText:
+      return "text";
+    case sc::ClipboardSnapshot::Kind::kFiles:
+      return "files";
+    default:
+      return "empty";
+  }
+}
+
+// The snapshot as a map for Dart, with its text only if |with_text|.
+flutter::EncodableValue SnapshotValue(const sc::ClipboardSnapshot& snapshot,
+                                      bool with_text) {
+  flutter::EncodableList files;
+  for (const std::string& file : snapshot.files) {
+    files.emplace_back(file);
+  }
+  flutter::EncodableMap map{
+      {flutter::EncodableValue("sequence"),
+       flutter::EncodableValue(static_cast<int64_t>(snapshot.sequence))},
+      {flutter::EncodableValue("kind"),
+       flutter::EncodableValue(KindName(snapshot.kind))},
+      {flutter::EncodableValue("digest"),
+       flutter::EncodableValue(sc::Sha256::ToHex(snapshot.digest))},
+      {flutter::EncodableValue("textLength"),
+       flutter::EncodableValue(static_cast<int64_t>(snapshot.text.size()))},
+      {flutter::EncodableValue("files"), flutter::EncodableValue(files)},
+  };
+  if (with_text) {
+    map[flutter::EncodableValue("text")] =
+        flutter::EncodableValue(snapshot.text);
+  }
+  return flutter::EncodableValue(map);
+}
+
+}  // namespace
+
+ClipboardWatcherPlugin::ClipboardWatcherPlugin(
+    flutter::BinaryMessenger* messenger, HWND window)
+    : window_(window) {
+  channel_ = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
+      messenger, "clipboard_watcher",
+      &flutter::StandardMethodCodec::GetInstance());
+  channel_->SetMethodCallHandler([this](const auto& call, auto result) {
+    HandleMethodCall(call, std::move(result));
+  });
+
+  watcher_ = std::make_unique<sc::ClipboardWatcher>(
+      &ClipboardWatcherPlugin::ReadClipboard,
+      [window](std::shared_ptr<const sc::ClipboardSnapshot>) {
+        // Channels are only used on the platform thread.
+        ::PostMessage(window, kSnapshotReadyMessage, 0, 0);
+      });
+  listening_ = ::AddClipboardFormatListener(window_) != FALSE;
+  // Stage whatever was copied before the app started.
+  watcher_->Notify(::GetClipboardSequenceNumber());
+}
+
+ClipboardWatcherPlugin::~ClipboardWatcherPlugin() {
+  if (listening_) {
+    ::RemoveClipboardFormatListener(window_);
+  }
+  watcher_ = nullptr;
+  channel_ = nullptr;
+}
+
+std::optional<LRESULT> ClipboardWatcherPlugin::HandleMessage(
+    UINT const message, WPARAM const wparam, LPARAM const lparam) {
+  switch (message) {
+    case WM_CLIPBOARDUPDATE:
+      watcher_->Notify(::GetClipboardSequenceNumber());
+      return 0;
+    case kSnapshotReadyMessage: {
+      auto snapshot = watcher_->Latest();
+      if (snapshot) {
+        channel_->InvokeMethod("changed",
+                               std::make_unique<flutter::EncodableValue>(
+                                   SnapshotValue(*snapshot, false)));
+      }
+      return 0;
+    }
+  }
+  return std::nullopt;
+}
+
+bool ClipboardWatcherPlugin::ReadClipboard(sc::ClipboardSnapshot* snapshot) {
+  sc::ClipboardFormats formats;
+  if (!ClipboardReaderPlugin::Read(
+          sc::ClipboardFormatBit(sc::ClipboardFormat::kFiles) |
+              sc::ClipboardFormatBit(sc::ClipboardFormat::kText),
+          &formats)) {
+    return false;
+  }
+  if (!formats.files.empty()) {
+    snapshot->kind = sc::ClipboardSnapshot::Kind::kFiles;
+    snapshot->files = std::move(formats.files);
+  } else if (!formats.text.empty()) {
+    snapshot->kind = sc::ClipboardSnapshot::Kind::kText;
+    snapshot->text = std::move(formats.text);
+  }
+  return true;
+}
+
+void ClipboardWatcherPlugin::HandleMethodCall(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (call.method_name() == "current") {
+    auto snapshot = watcher_->Current(::GetClipboardSequenceNumber());
+    if (snapshot) {
+      result->Success(SnapshotValue(*snapshot, true));
+    } else {
+      result->Success();
+    }
+  } else {
+    result->NotImplemented();
+  }
+}
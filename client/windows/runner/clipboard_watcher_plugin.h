@@ -0,0 +1,51 @@
+#ifndef RUNNER_CLIPBOARD_WATCHER_PLUGIN_H_
+#define RUNNER_CLIPBOARD_WATCHER_PLUGIN_H_
+
+#include <flutter/binary_messenger.h>
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+#include <windows.h>
+
+#include <memory>
+#include <optional>
+
+#include "clipboard_watcher.h"
+
+// Watches the clipboard for the Dart side over the "clipboard_watcher"
+// method channel, so a share starts from content read when it was copied.
+//
+// The host window is registered as a clipboard format listener and hands
+// WM_CLIPBOARDUPDATE to HandleMessage(), which wakes a sc::ClipboardWatcher
+// to read and digest the clipboard on its own thread. Each new snapshot is
+// announced to Dart with a "changed" call, without the text itself;
+// "current" returns the latest snapshot in full if it is still what the
+// clipboard holds, or null.
+class ClipboardWatcherPlugin {
+ public:
+  ClipboardWatcherPlugin(flutter::BinaryMessenger* messenger, HWND window);
+  ~ClipboardWatcherPlugin();
+
+  // Prevent copying.
+  ClipboardWatcherPlugin(ClipboardWatcherPlugin const&) = delete;
+  ClipboardWatcherPlugin& operator=(ClipboardWatcherPlugin const&) = delete;
+
+  // Handles the clipboard messages of the host window; returns a result
+  // for those it consumed.
+  std::optional<LRESULT> HandleMessage(UINT const message, WPARAM const wparam,
+                                       LPARAM const lparam);
+
+ private:
+  // Takes the files, or else the text, from the clipboard.
+  static bool ReadClipboard(sc::ClipboardSnapshot* snapshot);
+
+  void HandleMethodCall(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  HWND window_;
+  bool listening_ = false;
+  std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_;
+  std::unique_ptr<sc::ClipboardWatcher> watcher_;
+};
+
+#endif  // RUNNER_CLIPBOARD_WATCHER_PLUGIN_H_
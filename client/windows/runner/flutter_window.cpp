@@ -25,6 +25,10 @@ bool FlutterWindow::OnCreate() {
     return false;
   }
   RegisterPlugins(flutter_controller_->engine());
+  clipboard_reader_ = std::make_unique<ClipboardReaderPlugin>(
+      flutter_controller_->engine()->messenger());
+  clipboard_watcher_ = std::make_unique<ClipboardWatcherPlugin>(
+      flutter_controller_->engine()->messenger(), GetHandle());
   SetChildContent(flutter_controller_->view()->GetNativeWindow());
 
   // Do NOT show the window on startup; it will be shown via the system tray
@@ -34,6 +38,8 @@ bool FlutterWindow::OnCreate() {
 }
 
 void FlutterWindow::OnDestroy() {
+  clipboard_watcher_ = nullptr;
+  clipboard_reader_ = nullptr;
   if (flutter_controller_) {
     flutter_controller_ = nullptr;
   }
@@ -55,6 +61,14 @@ FlutterWindow::MessageHandler(HWND hwnd, UINT const message,
     }
   }
 
+  if (clipboard_watcher_) {
+    std::optional<LRESULT> result =
+        clipboard_watcher_->HandleMessage(message, wparam, lparam);
+    if (result) {
+      return *result;
+    }
+  }
+
   switch (message) {
     case WM_FONTCHANGE:
       flutter_controller_->engine()->ReloadSystemFonts();
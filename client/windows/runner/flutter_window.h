@@ -6,6 +6,8 @@
 
 #include <memory>
 
+#include "clipboard_reader_plugin.h"
+#include "clipboard_watcher_plugin.h"
 #include "win32_window.h"
 
 // A window that does nothing but host a Flutter view.
@@ -28,6 +30,12 @@ class FlutterWindow : public Win32Window {
 
   // The Flutter instance hosted by this window.
   std::unique_ptr<flutter::FlutterViewController> flutter_controller_;
+
+  // Reads every clipboard format the app uses in one go.
+  std::unique_ptr<ClipboardReaderPlugin> clipboard_reader_;
+
+  // Keeps a snapshot of the clipboard ready for the next share.
+  std::unique_ptr<ClipboardWatcherPlugin> clipboard_watcher_;
 };
 
 #endif  // RUNNER_FLUTTER_WINDOW_H_
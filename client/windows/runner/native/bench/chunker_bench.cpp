@@ -0,0 +1,72 @@
+// Content-defined chunking throughput.
+//
+// BM_Cut runs the two-byte rolling loop used by the sender, and
+// BM_CutReference the byte-wise loop it replaces; both find the same cut
+// points. BM_CutAndHash adds the per-chunk SHA-256 needed for a manifest.
+//
+//   ./sc_native_chunker_bench
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "content_chunker.h"
+#include "sha256.h"
+
+namespace sc {
+namespace {
+
+const std::vector<uint8_t>& Data() {
+  static const std::vector<uint8_t> data = [] {
+    std::mt19937 rng(7);
+    std::vector<uint8_t> bytes(64 << 20);
+    for (auto& byte : bytes) {
+      byte = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+  }();
+  return data;
+}
+
+template <bool kReference, bool kHash>
+void RunChunker(benchmark::State& state) {
+  const auto& data = Data();
+  const ContentChunker chunker;
+  uint8_t digest[Sha256::kDigestSize];
+  for (auto _ : state) {
+    size_t chunks = 0;
+    for (size_t offset = 0; offset < data.size();) {
+      const size_t remaining = data.size() - offset;
+      const size_t cut = kReference
+                             ? chunker.CutReference(data.data() + offset, remaining)
+                             : chunker.Cut(data.data() + offset, remaining);
+      if (kHash) {
+        Sha256 hasher;
+        hasher.Update(data.data() + offset, cut);
+        hasher.Finish(digest);
+      }
+      offset += cut;
+      chunks++;
+    }
+    benchmark::DoNotOptimize(chunks);
+    state.counters["chunks"] = static_cast<double>(chunks);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size()));
+}
+
+void BM_Cut(benchmark::State& state) { RunChunker<false, false>(state); }
+void BM_CutReference(benchmark::State& state) {
+  RunChunker<true, false>(state);
+}
+void BM_CutAndHash(benchmark::State& state) { RunChunker<false, true>(state); }
+
+BENCHMARK(BM_Cut)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CutReference)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CutAndHash)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace sc
+
+BENCHMARK_MAIN();
@@ -0,0 +1,185 @@
+// Per-chunk compression across the kinds of payload users share.
+//
+// Each corpus is compressed in 8 KiB chunks, the size of one file frame, the
+// way the sender does it. Besides throughput every run reports:
+//   ratio         compressed bytes / input bytes (1.0 when sent raw)
+//   crossover_MBps  link speed below which compressing is a net win
+//
+// Compressing costs 1/c seconds per byte and saves (1 - ratio)/link, so it
+// pays while link < c * (1 - ratio); on faster links the chunks should go
+// raw. Text and source code stay ahead of gigabit LAN speeds, while media
+// never crosses over because CompressChunk() skips it after the probe.
+//
+//   ./sc_native_compression_bench
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "compression.h"
+
+namespace sc {
+namespace {
+
+constexpr size_t kCorpusSize = 16 << 20;
+constexpr size_t kChunkSize = 8192;
+
+std::vector<uint8_t> Repeat(std::vector<uint8_t> seed) {
+  std::vector<uint8_t> data;
+  data.reserve(kCorpusSize);
+  while (!seed.empty() && data.size() < kCorpusSize) {
+    const size_t take = std::min(seed.size(), kCorpusSize - data.size());
+    data.insert(data.end(), seed.begin(), seed.begin() + take);
+  }
+  return data;
+}
+
+// Prose-like text from a small vocabulary with Zipf-ish word frequencies.
+const std::vector<uint8_t>& Text() {
+  static const std::vector<uint8_t> data = [] {
+    static const char* const kWords[] = {
+        "the",   "of",       "and",    "to",     "a",      "in",
+        "is",    "that",     "for",    "it",     "as",     "was",
+        "with",  "clipboard", "shared", "device", "network", "between",
+        "files", "quickly",  "window", "copied", "pasted", "transfer"};
+    std::mt19937 rng(11);
+    std::geometric_distribution<int> pick(0.18);
+    std::string text;
+    text.reserve(kCorpusSize);
+    while (text.size() < kCorpusSize) {
+      text += kWords[pick(rng) % (sizeof(kWords) / sizeof(kWords[0]))];
+      text += (rng() % 14 == 0) ? ".\n" : " ";
+    }
+    text.resize(kCorpusSize);
+    return std::vector<uint8_t>(text.begin(), text.end());
+  }();
+  return data;
+}
+
+// This library's own sources, repeated up to the corpus size.
+const std::vector<uint8_t>& Source() {
+  static const std::vector<uint8_t> data = [] {
+    namespace fs = std::filesystem;
+    std::vector<uint8_t> seed;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(SC_NATIVE_SOURCE_DIR, ec), end;
+         !ec && it != end; it.increment(ec)) {
+      const fs::path& path = it->path();
+      if (path.extension() != ".cpp" && path.extension() != ".h") {
+        continue;
+      }
+      std::ifstream in(path, std::ios::binary);
+      seed.insert(seed.end(), std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+    }
+    return Repeat(std::move(seed));
+  }();
+  return data;
+}
+
+// Stands in for JPEG, video and archives: already compressed, so uniformly
+// random at the byte level.
+const std::vector<uint8_t>& Media() {
+  static const std::vector<uint8_t> data = [] {
+    std::mt19937 rng(13);
+    std::vector<uint8_t> bytes(kCorpusSize);
+    for (auto& byte : bytes) {
+      byte = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+  }();
+  return data;
+}
+
+void RunCompress(benchmark::State& state, const std::vector<uint8_t>& data) {
+  const int acceleration = static_cast<int>(state.range(0));
+  std::vector<uint8_t> out(Lz4CompressBound(kChunkSize));
+  size_t sent = 0;
+  for (auto _ : state) {
+    sent = 0;
+    for (size_t offset = 0; offset < data.size(); offset += kChunkSize) {
+      const size_t length = std::min(kChunkSize, data.size() - offset);
+      const size_t size = CompressChunk(data.data() + offset, length,
+                                        out.data(), out.size(), acceleration);
+      sent += size != 0 ? size : length;
+    }
+    benchmark::DoNotOptimize(sent);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size()));
+  const double ratio =
+      static_cast<double>(sent) / static_cast<double>(data.size());
+  state.counters["ratio"] = ratio;
+  // Bytes per second scaled by the saved fraction; see the file comment.
+  state.counters["crossover_MBps"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) *
+          static_cast<double>(data.size()) * (1 - ratio) / 1e6,
+      benchmark::Counter::kIsRate);
+}
+
+void RunDecompress(benchmark::State& state, const std::vector<uint8_t>& data) {
+  std::vector<std::vector<uint8_t>> chunks;
+  for (size_t offset = 0; offset < data.size(); offset += kChunkSize) {
+    std::vector<uint8_t> out(Lz4CompressBound(kChunkSize));
+    out.resize(Lz4Compress(data.data() + offset,
+                           std::min(kChunkSize, data.size() - offset),
+                           out.data(), out.size()));
+    chunks.push_back(std::move(out));
+  }
+  std::vector<uint8_t> raw(kChunkSize);
+  for (auto _ : state) {
+    size_t offset = 0;
+    for (const auto& chunk : chunks) {
+      const size_t length = std::min(kChunkSize, data.size() - offset);
+      benchmark::DoNotOptimize(
+          Lz4Decompress(chunk.data(), chunk.size(), raw.data(), length));
+      offset += length;
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size()));
+}
+
+void BM_CompressText(benchmark::State& state) { RunCompress(state, Text()); }
+void BM_CompressSource(benchmark::State& state) {
+  RunCompress(state, Source());
+}
+void BM_CompressMedia(benchmark::State& state) { RunCompress(state, Media()); }
+void BM_DecompressText(benchmark::State& state) {
+  RunDecompress(state, Text());
+}
+void BM_DecompressSource(benchmark::State& state) {
+  RunDecompress(state, Source());
+}
+
+void BM_EntropyProbe(benchmark::State& state) {
+  const auto& data = Media();
+  for (auto _ : state) {
+    for (size_t offset = 0; offset < data.size(); offset += kChunkSize) {
+      benchmark::DoNotOptimize(
+          EstimateEntropy(data.data() + offset, kChunkSize));
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size()));
+}
+
+// The argument is the LZ4 acceleration.
+BENCHMARK(BM_CompressText)->Arg(1)->Arg(8)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompressSource)->Arg(1)->Arg(8)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompressMedia)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DecompressText)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DecompressSource)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EntropyProbe)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace sc
+
+BENCHMARK_MAIN();
@@ -0,0 +1,119 @@
+// Cost of a log call on the caller's thread.
+//
+// BM_Write queues batches of a typical line into the RingLogger, letting the
+// worker catch up between batches (untimed) so that none is dropped;
+// BM_WriteFull keeps writing into a ring the worker cannot keep up with, so
+// most lines take the counted-and-dropped path. BM_WriteBelowLevel writes
+// lines whose level is disabled. BM_WriteReference formats the timestamp
+// and writes the line to the file on the calling thread, as a synchronous
+// logger does. Times are per line.
+//
+//   ./sc_native_logger_bench
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+#include "ring_logger.h"
+
+namespace sc {
+namespace {
+
+const std::string& Line() {
+  static const std::string line =
+      "WEBRTC: \xe2\xac\x87\xef\xb8\x8f PROGRESS - {file: report.pdf, "
+      "received: 10485760, of: 104857600}";
+  return line;
+}
+
+std::string LogPath() {
+  return (std::string(std::getenv("TMPDIR") != nullptr ? std::getenv("TMPDIR")
+                                                       : "/tmp")) +
+         "/sc_native_logger_bench.log";
+}
+
+// Lines per timed batch, half the default ring.
+constexpr int kBatch = static_cast<int>(RingLogger::kDefaultCapacity / 2);
+
+void RunWrite(benchmark::State& state, RingLogger::Level level, bool flush) {
+  const std::string path = LogPath();
+  RingLogger logger;
+  if (!logger.Open(path, RingLogger::kDefaultMaxFileSize, 1)) {
+    state.SkipWithError("cannot open log file");
+    return;
+  }
+  logger.set_level(RingLogger::kInfo);
+  const std::string& line = Line();
+  for (auto _ : state) {
+    for (int i = 0; i < kBatch; i++) {
+      benchmark::DoNotOptimize(logger.Write(level, line.data(), line.size()));
+    }
+    if (flush) {
+      state.PauseTiming();
+      logger.Flush();
+      state.ResumeTiming();
+    }
+  }
+  logger.Close();
+  const double lines = static_cast<double>(state.iterations()) * kBatch;
+  state.SetItemsProcessed(static_cast<int64_t>(lines));
+  state.counters["ns_per_line"] = benchmark::Counter(
+      lines, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.counters["dropped"] =
+      benchmark::Counter(static_cast<double>(logger.dropped()) / lines);
+  std::remove(path.c_str());
+  std::remove((path + ".1").c_str());
+}
+
+void BM_Write(benchmark::State& state) {
+  RunWrite(state, RingLogger::kInfo, true);
+}
+void BM_WriteFull(benchmark::State& state) {
+  RunWrite(state, RingLogger::kInfo, false);
+}
+void BM_WriteBelowLevel(benchmark::State& state) {
+  RunWrite(state, RingLogger::kDebug, false);
+}
+
+void BM_WriteReference(benchmark::State& state) {
+  const std::string path = LogPath();
+  std::FILE* file = std::fopen(path.c_str(), "ab");
+  if (file == nullptr) {
+    state.SkipWithError("cannot open log file");
+    return;
+  }
+  const std::string& line = Line();
+  char buffer[1200];
+  for (auto _ : state) {
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    const int millis = static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch())
+            .count() %
+        1000);
+    char time[32];
+    std::strftime(time, sizeof(time), "%Y-%m-%dT%H:%M:%S",
+                  std::gmtime(&seconds));
+    const int length = std::snprintf(buffer, sizeof(buffer), "%s.%03dZ I %s\n",
+                                     time, millis, line.c_str());
+    std::fwrite(buffer, 1, static_cast<size_t>(length), file);
+    std::fflush(file);
+  }
+  std::fclose(file);
+  std::remove(path.c_str());
+}
+
+}  // namespace
+}  // namespace sc
+
+BENCHMARK(sc::BM_Write);
+BENCHMARK(sc::BM_WriteFull);
+BENCHMARK(sc::BM_WriteBelowLevel);
+BENCHMARK(sc::BM_WriteReference);
+
+BENCHMARK_MAIN();
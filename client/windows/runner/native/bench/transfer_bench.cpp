@@ -0,0 +1,147 @@
+// End-to-end file transfers over simulated links.
+//
+// Each run streams one file through the proto v2 data path as the app runs
+// it: SHA-256 and frame encoding on the sender, credit flow control and
+// stripe scheduling, then frame decoding, reassembly and SHA-256 on the
+// receiver. The link between them is simulated in-process, so the numbers
+// do not depend on the machine's network.
+//
+// Counters:
+//   sim_MBps        throughput reached in simulated time
+//   p50_ms, p99_ms  chunk latency from send to in-order delivery
+//   cpu_ms_per_MB   process CPU time spent per MB transferred
+//   rx_peak_KiB     peak receiver memory held for reassembly and writing
+//   rss_peak_MiB    peak resident set of the benchmark process so far
+//
+//   ./sc_native_transfer_bench --benchmark_counters_tabular=true
+//   ./sc_native_transfer_bench --benchmark_filter='/rtt_ms:80/'
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+
+#include "testing/transfer_simulation.h"
+
+namespace sc {
+namespace {
+
+using ::sc::testing::SimulateTransfer;
+using ::sc::testing::TransferSimulationConfig;
+using ::sc::testing::TransferSimulationResult;
+
+constexpr int64_t kKiB = 1024;
+constexpr int64_t kMiB = 1024 * kKiB;
+constexpr int64_t kGiB = 1024 * kMiB;
+
+double PeakResidentMiB() {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters,
+                              sizeof(counters))) {
+    return 0;
+  }
+  return static_cast<double>(counters.PeakWorkingSetSize) / kMiB;
+#else
+  struct rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  return static_cast<double>(usage.ru_maxrss) / kMiB;  // bytes
+#else
+  return static_cast<double>(usage.ru_maxrss) / kKiB;  // KiB
+#endif
+#endif
+}
+
+// Args: file size in bytes, round-trip time in ms, bandwidth in Mbit/s,
+// loss in tenths of a percent.
+void BM_FileTransfer(benchmark::State& state) {
+  TransferSimulationConfig config;
+  config.total_bytes = static_cast<uint64_t>(state.range(0));
+  config.link.one_way_delay_us = static_cast<uint64_t>(state.range(1)) * 500;
+  config.link.bandwidth_bytes_per_sec =
+      static_cast<double>(state.range(2)) * 1e6 / 8;
+  config.link.loss_rate = static_cast<double>(state.range(3)) / 1000.0;
+  // SCTP resends a lost message after a few round trips.
+  config.link.retransmit_delay_us =
+      std::max<uint64_t>(6 * config.link.one_way_delay_us, 10000);
+  config.carry_payload = true;
+  // Room for the slowest link, with head-of-line stalls on top.
+  config.time_limit_us = static_cast<uint64_t>(
+      4e6 * static_cast<double>(config.total_bytes) /
+          config.link.bandwidth_bytes_per_sec +
+      60e6);
+
+  TransferSimulationResult result;
+  const std::clock_t cpu_start = std::clock();
+  for (auto _ : state) {
+    result = SimulateTransfer(config);
+    benchmark::DoNotOptimize(result.frames);
+  }
+  const double cpu_seconds =
+      static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+  if (!result.completed || !result.data_intact) {
+    state.SkipWithError("transfer did not complete intact");
+    return;
+  }
+  const double megabytes = static_cast<double>(state.iterations()) *
+                            static_cast<double>(config.total_bytes) / 1e6;
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(config.total_bytes));
+  state.counters["sim_MBps"] = result.throughput() / 1e6;
+  state.counters["p50_ms"] = static_cast<double>(result.latency_p50_us) / 1e3;
+  state.counters["p99_ms"] = static_cast<double>(result.latency_p99_us) / 1e3;
+  state.counters["cpu_ms_per_MB"] = 1e3 * cpu_seconds / megabytes;
+  state.counters["rx_peak_KiB"] =
+      static_cast<double>(result.max_receive_buffer) / kKiB;
+  state.counters["rss_peak_MiB"] = PeakResidentMiB();
+}
+
+// Round-trip time in ms, bandwidth in Mbit/s, loss in tenths of a percent.
+constexpr int64_t kLinks[][3] = {
+    {1, 1000, 0},  // wired LAN
+    {10, 200, 5},  // Wi-Fi
+    {80, 50, 10},  // across the internet
+};
+
+void SmallFiles(benchmark::internal::Benchmark* bench) {
+  for (int64_t size : {kKiB, 64 * kKiB, kMiB, 16 * kMiB, 256 * kMiB}) {
+    for (const auto& link : kLinks) {
+      bench->Args({size, link[0], link[1], link[2]});
+    }
+  }
+}
+
+void LargeFiles(benchmark::internal::Benchmark* bench) {
+  for (int64_t size : {kGiB, 10 * kGiB}) {
+    for (const auto& link : kLinks) {
+      bench->Args({size, link[0], link[1], link[2]});
+    }
+  }
+}
+
+BENCHMARK(BM_FileTransfer)
+    ->Apply(SmallFiles)
+    ->ArgNames({"bytes", "rtt_ms", "Mbps", "loss_permille"})
+    ->Unit(benchmark::kMillisecond);
+// Seconds of CPU each, so one iteration is enough.
+BENCHMARK(BM_FileTransfer)
+    ->Apply(LargeFiles)
+    ->ArgNames({"bytes", "rtt_ms", "Mbps", "loss_permille"})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace sc
+
+BENCHMARK_MAIN();
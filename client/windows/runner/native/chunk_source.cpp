@@ -0,0 +1,281 @@
+#include "chunk_source.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+
+namespace sc {
+
+namespace {
+
+#if defined(_WIN32)
+// Converts a UTF-8 path to the UTF-16 form the wide Win32 APIs expect.
+std::wstring Utf16FromUtf8(const std::string& utf8_string) {
+  if (utf8_string.empty()) {
+    return std::wstring();
+  }
+  int target_length = ::MultiByteToWideChar(
+      CP_UTF8, MB_ERR_INVALID_CHARS, utf8_string.data(),
+      static_cast<int>(utf8_string.size()), nullptr, 0);
+  if (target_length <= 0) {
+    return std::wstring();
+  }
+  std::wstring utf16_string(target_length, L'\0');
+  ::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, utf8_string.data(),
+                        static_cast<int>(utf8_string.size()),
+                        utf16_string.data(), target_length);
+  return utf16_string;
+}
+
+size_t MapGranularity() {
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+}
+#else
+size_t MapGranularity() {
+  return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+#endif
+
+}  // namespace
+
+ChunkSource::ChunkSource() {}
+
+ChunkSource::~ChunkSource() { Close(); }
+
+bool ChunkSource::Open(const std::string& path, bool allow_mmap,
+                       size_t window_size) {
+  Close();
+  allow_mmap_ = allow_mmap && sizeof(void*) >= 8;
+  const size_t granularity = MapGranularity();
+  window_size_ = std::max(granularity,
+                          window_size / granularity * granularity);
+#if defined(_WIN32)
+  std::wstring wide_path = Utf16FromUtf8(path);
+  if (wide_path.empty()) {
+    return false;
+  }
+  HANDLE file = ::CreateFileW(wide_path.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                              nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!::GetFileSizeEx(file, &size)) {
+    ::CloseHandle(file);
+    return false;
+  }
+  file_ = file;
+  size_ = static_cast<uint64_t>(size.QuadPart);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    return false;
+  }
+  fd_ = fd;
+  size_ = static_cast<uint64_t>(st.st_size);
+#if defined(POSIX_FADV_SEQUENTIAL)
+  ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#endif
+  is_open_ = true;
+  return true;
+}
+
+void ChunkSource::Close() {
+  UnmapWindow();
+#if defined(_WIN32)
+  if (mapping_ != nullptr) {
+    ::CloseHandle(mapping_);
+    mapping_ = nullptr;
+  }
+  if (file_ != nullptr) {
+    ::CloseHandle(file_);
+    file_ = nullptr;
+  }
+#else
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+#endif
+  is_open_ = false;
+  size_ = 0;
+  std::vector<uint8_t>().swap(read_buffer_);
+  hasher_.Reset();
+  hashed_ = 0;
+}
+
+const uint8_t* ChunkSource::View(uint64_t offset, size_t length,
+                                 size_t* out_length) {
+  *out_length = 0;
+  if (!CatchUpHash(offset)) {
+    return nullptr;
+  }
+  const uint8_t* data = ViewUnhashed(offset, length, out_length);
+  if (data != nullptr && hashed_ >= offset &&
+      hashed_ < offset + *out_length) {
+    const size_t skip = static_cast<size_t>(hashed_ - offset);
+    hasher_.Update(data + skip, *out_length - skip);
+    hashed_ = offset + *out_length;
+  }
+  return data;
+}
+
+bool ChunkSource::Digest(uint8_t digest[Sha256::kDigestSize]) {
+  if (!is_open_ || !CatchUpHash(size_)) {
+    return false;
+  }
+  // Finish a copy so the running hash is left intact.
+  Sha256 copy = hasher_;
+  copy.Finish(digest);
+  return true;
+}
+
+bool ChunkSource::CatchUpHash(uint64_t offset) {
+  while (hashed_ < offset) {
+    size_t length = 0;
+    const size_t wanted = static_cast<size_t>(
+        std::min<uint64_t>(window_size_, offset - hashed_));
+    const uint8_t* data = ViewUnhashed(hashed_, wanted, &length);
+    if (data == nullptr) {
+      return false;
+    }
+    hasher_.Update(data, length);
+    hashed_ += length;
+  }
+  return true;
+}
+
+const uint8_t* ChunkSource::ViewUnhashed(uint64_t offset, size_t length,
+                                         size_t* out_length) {
+  *out_length = 0;
+  if (!is_open_ || offset >= size_ || length == 0) {
+    return nullptr;
+  }
+  length = static_cast<size_t>(
+      std::min<uint64_t>(length, size_ - offset));
+
+  if (allow_mmap_) {
+    const bool in_window =
+        window_ != nullptr && offset >= window_offset_ &&
+        offset + length <= window_offset_ + window_length_;
+    if (in_window || MapWindow(offset, length)) {
+      *out_length = length;
+      return window_ + (offset - window_offset_);
+    }
+    // Mapping failed (e.g. special file or exhausted address space).
+    allow_mmap_ = false;
+  }
+
+  const uint8_t* data = ReadChunk(offset, length);
+  if (data != nullptr) {
+    *out_length = length;
+  }
+  return data;
+}
+
+bool ChunkSource::MapWindow(uint64_t offset, size_t length) {
+  UnmapWindow();
+  const size_t granularity = MapGranularity();
+  const uint64_t start = offset / granularity * granularity;
+  const size_t slack = static_cast<size_t>(offset - start);
+  const size_t wanted = std::max(window_size_, slack + length);
+  const size_t map_length = static_cast<size_t>(
+      std::min<uint64_t>(wanted, size_ - start));
+#if defined(_WIN32)
+  if (mapping_ == nullptr) {
+    mapping_ = ::CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0,
+                                    nullptr);
+    if (mapping_ == nullptr) {
+      return false;
+    }
+  }
+  void* view = ::MapViewOfFile(mapping_, FILE_MAP_READ,
+                               static_cast<DWORD>(start >> 32),
+                               static_cast<DWORD>(start & 0xffffffffu),
+                               map_length);
+  if (view == nullptr) {
+    return false;
+  }
+#else
+  void* view = ::mmap(nullptr, map_length, PROT_READ, MAP_SHARED, fd_,
+                      static_cast<off_t>(start));
+  if (view == MAP_FAILED) {
+    return false;
+  }
+  ::madvise(view, map_length, MADV_SEQUENTIAL);
+#endif
+  window_ = static_cast<uint8_t*>(view);
+  window_offset_ = start;
+  window_length_ = map_length;
+  return true;
+}
+
+void ChunkSource::UnmapWindow() {
+  if (window_ == nullptr) {
+    return;
+  }
+#if defined(_WIN32)
+  ::UnmapViewOfFile(window_);
+#else
+  ::munmap(window_, window_length_);
+#endif
+  window_ = nullptr;
+  window_offset_ = 0;
+  window_length_ = 0;
+}
+
+const uint8_t* ChunkSource::ReadChunk(uint64_t offset, size_t length) {
+  UnmapWindow();
+  if (read_buffer_.size() < length) {
+    read_buffer_.resize(length);
+  }
+  size_t done = 0;
+  while (done < length) {
+#if defined(_WIN32)
+    OVERLAPPED overlapped = {};
+    const uint64_t position = offset + done;
+    overlapped.Offset = static_cast<DWORD>(position & 0xffffffffu);
+    overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+    DWORD read = 0;
+    const DWORD request = static_cast<DWORD>(
+        std::min<size_t>(length - done, 1u << 30));
+    if (!::ReadFile(file_, read_buffer_.data() + done, request, &read,
+                    &overlapped) ||
+        read == 0) {
+      return nullptr;
+    }
+#else
+    const ssize_t read = ::pread(fd_, read_buffer_.data() + done,
+                                 length - done,
+                                 static_cast<off_t>(offset + done));
+    if (read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (read <= 0) {
+      return nullptr;
+    }
+#endif
+    done += static_cast<size_t>(read);
+  }
+  return read_buffer_.data();
+}
+
+}  // namespace sc
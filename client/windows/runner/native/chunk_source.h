@@ -0,0 +1,102 @@
+#ifndef RUNNER_NATIVE_CHUNK_SOURCE_H_
+#define RUNNER_NATIVE_CHUNK_SOURCE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sha256.h"
+
+namespace sc {
+
+// Read-only, chunk-at-a-time view of a file for the sending side, so a file
+// never has to be loaded into memory as a whole.
+//
+// The file is mapped through a sliding window (mmap on POSIX, MapViewOfFile on
+// Windows) and chunks are handed out as views into the mapping without
+// copying. When mapping is unavailable or disabled, chunks are read with
+// positional reads into an internal buffer instead. Either way, resident
+// memory is bounded by the window size rather than by the file size.
+//
+// The source also keeps a running SHA-256 of the file. Bytes are hashed as
+// they are viewed in order, so a sequential sender gets the file digest
+// without a second pass over the data.
+class ChunkSource {
+ public:
+  // Default size of the mapped window. Must be a multiple of the 64 KiB
+  // Windows allocation granularity.
+  static constexpr size_t kDefaultWindowSize = 16 * 1024 * 1024;
+
+  ChunkSource();
+  ~ChunkSource();
+
+  // Prevent copying.
+  ChunkSource(ChunkSource const&) = delete;
+  ChunkSource& operator=(ChunkSource const&) = delete;
+
+  // Opens the file at |path|, which is encoded in UTF-8. When |allow_mmap| is
+  // false, chunks are always served by positional reads. Returns false on
+  // failure.
+  bool Open(const std::string& path, bool allow_mmap = true,
+            size_t window_size = kDefaultWindowSize);
+
+  // Closes the file and releases the mapping. Safe to call more than once.
+  void Close();
+
+  // Returns a view of up to |length| bytes starting at |offset|, and stores
+  // the actual number of bytes in |out_length| (shorter at end of file).
+  // The view stays valid until the next call to View() or Close(). Returns
+  // nullptr at end of file or on error.
+  const uint8_t* View(uint64_t offset, size_t length, size_t* out_length);
+
+  // Writes the SHA-256 of the whole file to |digest|. Parts of the file that
+  // were never viewed in order are read and hashed first. Returns false on a
+  // read error.
+  bool Digest(uint8_t digest[Sha256::kDigestSize]);
+
+  uint64_t size() const { return size_; }
+  bool is_open() const { return is_open_; }
+
+  // Whether the last view was served from the mapping rather than a read.
+  bool is_mapped() const { return window_ != nullptr; }
+
+ private:
+  // Maps the window covering [offset, offset + length). Returns false if the
+  // file cannot be mapped, in which case reads are used from then on.
+  bool MapWindow(uint64_t offset, size_t length);
+  void UnmapWindow();
+  const uint8_t* ReadChunk(uint64_t offset, size_t length);
+  const uint8_t* ViewUnhashed(uint64_t offset, size_t length,
+                              size_t* out_length);
+  // Hashes the file up to |offset| if the running hash is behind it.
+  bool CatchUpHash(uint64_t offset);
+
+#if defined(_WIN32)
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+  bool is_open_ = false;
+  bool allow_mmap_ = true;
+  uint64_t size_ = 0;
+  size_t window_size_ = kDefaultWindowSize;
+
+  // Current mapped window, covering [window_offset_, window_offset_ +
+  // window_length_) of the file.
+  uint8_t* window_ = nullptr;
+  uint64_t window_offset_ = 0;
+  size_t window_length_ = 0;
+
+  // Backing store for views served by positional reads.
+  std::vector<uint8_t> read_buffer_;
+
+  // Running hash of the file prefix [0, hashed_).
+  Sha256 hasher_;
+  uint64_t hashed_ = 0;
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_CHUNK_SOURCE_H_
@@ -0,0 +1,215 @@
+#include "chunk_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+namespace sc {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kHexDigestLength = Sha256::kDigestSize * 2;
+
+bool IsHexDigest(const std::string& name) {
+  return name.size() == kHexDigestLength &&
+         std::all_of(name.begin(), name.end(), [](char c) {
+           return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+         });
+}
+
+bool DigestMatches(const uint8_t digest[Sha256::kDigestSize],
+                   const uint8_t* data, size_t length) {
+  uint8_t actual[Sha256::kDigestSize];
+  Sha256 hasher;
+  hasher.Update(data, length);
+  hasher.Finish(actual);
+  return std::memcmp(actual, digest, Sha256::kDigestSize) == 0;
+}
+
+}  // namespace
+
+ChunkStore::ChunkStore() = default;
+
+ChunkStore::~ChunkStore() = default;
+
+bool ChunkStore::Open(const std::string& root, uint64_t capacity) {
+  std::error_code ec;
+  root_ = fs::u8path(root);
+  fs::create_directories(root_, ec);
+  if (ec || !fs::is_directory(root_, ec)) {
+    return false;
+  }
+  capacity_ = capacity;
+  entries_.clear();
+  size_bytes_ = 0;
+
+  struct Found {
+    std::string hex;
+    uint64_t size;
+    fs::file_time_type modified;
+  };
+  std::vector<Found> found;
+  for (fs::recursive_directory_iterator it(root_, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    if (!it->is_regular_file(ec)) {
+      continue;
+    }
+    const fs::path& path = it->path();
+    if (path.extension() == ".tmp") {
+      // Left behind by an interrupted Put().
+      fs::remove(path, ec);
+      continue;
+    }
+    const std::string name = path.filename().string();
+    if (!IsHexDigest(name)) {
+      continue;
+    }
+    const uint64_t size = it->file_size(ec);
+    const fs::file_time_type modified = it->last_write_time(ec);
+    if (!ec) {
+      found.push_back({name, size, modified});
+    }
+    ec.clear();
+  }
+  // Least recently used first, so older chunks get smaller ticks.
+  std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) {
+    return a.modified < b.modified;
+  });
+  for (const Found& chunk : found) {
+    entries_[chunk.hex] = {chunk.size, ++clock_, 0};
+    size_bytes_ += chunk.size;
+  }
+  is_open_ = true;
+  Trim();
+  return true;
+}
+
+bool ChunkStore::Contains(const uint8_t digest[Sha256::kDigestSize]) const {
+  return entries_.count(Sha256::ToHex(digest)) != 0;
+}
+
+bool ChunkStore::Pin(const uint8_t digest[Sha256::kDigestSize]) {
+  auto entry = entries_.find(Sha256::ToHex(digest));
+  if (entry == entries_.end()) {
+    return false;
+  }
+  entry->second.last_used = ++clock_;
+  entry->second.pins++;
+  return true;
+}
+
+void ChunkStore::Unpin(const uint8_t digest[Sha256::kDigestSize]) {
+  auto entry = entries_.find(Sha256::ToHex(digest));
+  if (entry != entries_.end() && entry->second.pins > 0) {
+    entry->second.pins--;
+  }
+}
+
+bool ChunkStore::Put(const uint8_t digest[Sha256::kDigestSize],
+                     const uint8_t* data, size_t length) {
+  if (!is_open_ || !DigestMatches(digest, data, length)) {
+    return false;
+  }
+  const std::string hex = Sha256::ToHex(digest);
+  auto existing = entries_.find(hex);
+  if (existing != entries_.end()) {
+    existing->second.last_used = ++clock_;
+    return true;
+  }
+
+  const fs::path path = PathFor(hex);
+  fs::path temp = path;
+  temp += ".tmp";
+  std::error_code ec;
+  fs::create_directories(path.parent_path(), ec);
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data),
+              static_cast<std::streamsize>(length));
+    if (!out) {
+      out.close();
+      fs::remove(temp, ec);
+      return false;
+    }
+  }
+  // Renaming makes the chunk appear whole or not at all.
+  fs::rename(temp, path, ec);
+  if (ec) {
+    fs::remove(temp, ec);
+    return false;
+  }
+  entries_[hex] = {length, ++clock_, 0};
+  size_bytes_ += length;
+  if (size_bytes_ > capacity_) {
+    Trim();
+  }
+  return true;
+}
+
+bool ChunkStore::Get(const uint8_t digest[Sha256::kDigestSize],
+                     std::vector<uint8_t>* out) {
+  const std::string hex = Sha256::ToHex(digest);
+  auto entry = entries_.find(hex);
+  if (entry == entries_.end()) {
+    return false;
+  }
+  const fs::path path = PathFor(hex);
+  std::ifstream in(path, std::ios::binary);
+  out->resize(entry->second.size);
+  in.read(reinterpret_cast<char*>(out->data()),
+          static_cast<std::streamsize>(out->size()));
+  if (!in || in.peek() != std::ifstream::traits_type::eof() ||
+      !DigestMatches(digest, out->data(), out->size())) {
+    // Damaged or changed on disk: forget it so it is fetched again.
+    in.close();
+    Remove(hex);
+    out->clear();
+    return false;
+  }
+  entry->second.last_used = ++clock_;
+  // Carry recency over to the next run.
+  std::error_code ec;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+  return true;
+}
+
+void ChunkStore::Trim() {
+  if (size_bytes_ <= capacity_) {
+    return;
+  }
+  std::vector<std::pair<uint64_t, std::string>> by_age;
+  by_age.reserve(entries_.size());
+  for (const auto& entry : entries_) {
+    if (entry.second.pins == 0) {
+      by_age.emplace_back(entry.second.last_used, entry.first);
+    }
+  }
+  std::sort(by_age.begin(), by_age.end());
+  for (const auto& chunk : by_age) {
+    if (size_bytes_ <= capacity_) {
+      break;
+    }
+    Remove(chunk.second);
+  }
+}
+
+fs::path ChunkStore::PathFor(const std::string& hex) const {
+  return root_ / hex.substr(0, 2) / hex;
+}
+
+void ChunkStore::Remove(const std::string& hex) {
+  auto entry = entries_.find(hex);
+  if (entry == entries_.end()) {
+    return;
+  }
+  std::error_code ec;
+  fs::remove(PathFor(hex), ec);
+  size_bytes_ -= entry->second.size;
+  entries_.erase(entry);
+}
+
+}  // namespace sc
@@ -0,0 +1,87 @@
+#ifndef RUNNER_NATIVE_CHUNK_STORE_H_
+#define RUNNER_NATIVE_CHUNK_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sha256.h"
+
+namespace sc {
+
+// Persistent, content-addressed store of file chunks on the receiving side.
+//
+// Each chunk is a file named after the hex SHA-256 of its contents, under a
+// two-character fan-out directory. Chunks of received files are kept so that
+// when the same or a slightly edited file is shared again, the sender can
+// skip the chunks listed here. The total size is bounded; the least recently
+// used chunks are evicted first, using file modification times across runs.
+// Pinned chunks are never evicted, so the store may exceed its capacity
+// while they are.
+//
+// Not thread-safe.
+class ChunkStore {
+ public:
+  static constexpr uint64_t kDefaultCapacity = 1024ull * 1024 * 1024;
+
+  ChunkStore();
+  ~ChunkStore();
+
+  // Prevent copying.
+  ChunkStore(ChunkStore const&) = delete;
+  ChunkStore& operator=(ChunkStore const&) = delete;
+
+  // Opens (creating if needed) the store rooted at |root|, encoded in UTF-8,
+  // and indexes the chunks already in it. Returns false on failure.
+  bool Open(const std::string& root, uint64_t capacity = kDefaultCapacity);
+
+  bool Contains(const uint8_t digest[Sha256::kDigestSize]) const;
+
+  // Marks the chunk under |digest| recently used and keeps it from eviction
+  // until a matching Unpin(). Pins nest. Returns false if it is not stored.
+  bool Pin(const uint8_t digest[Sha256::kDigestSize]);
+  void Unpin(const uint8_t digest[Sha256::kDigestSize]);
+
+  // Stores |length| bytes under |digest| after checking that the digest
+  // matches. Does nothing if the chunk is already stored. Returns false if
+  // the digest does not match or the chunk cannot be written.
+  bool Put(const uint8_t digest[Sha256::kDigestSize], const uint8_t* data,
+           size_t length);
+
+  // Reads the chunk stored under |digest| into |out| and marks it recently
+  // used. Returns false if it is missing, unreadable or corrupt.
+  bool Get(const uint8_t digest[Sha256::kDigestSize],
+           std::vector<uint8_t>* out);
+
+  // Evicts least recently used unpinned chunks until the store fits its
+  // capacity.
+  void Trim();
+
+  uint64_t size_bytes() const { return size_bytes_; }
+  size_t chunk_count() const { return entries_.size(); }
+  bool is_open() const { return is_open_; }
+
+ private:
+  struct Entry {
+    uint64_t size;
+    uint64_t last_used;  // ordering tick, larger is more recent
+    uint32_t pins = 0;
+  };
+
+  std::filesystem::path PathFor(const std::string& hex) const;
+  void Remove(const std::string& hex);
+
+  std::filesystem::path root_;
+  bool is_open_ = false;
+  uint64_t capacity_ = kDefaultCapacity;
+  uint64_t size_bytes_ = 0;
+  uint64_t clock_ = 0;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_CHUNK_STORE_H_
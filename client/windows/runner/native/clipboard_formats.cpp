@@ -0,0 +1,248 @@
+#include "clipboard_formats.h"
+
+#include <cstring>
+#include <utility>
+
+namespace sc {
+
+namespace {
+
+// DROPFILES: u32 offset of the list, a POINT, then BOOL fNC and fWide.
+constexpr size_t kDropFilesHeaderSize = 20;
+constexpr size_t kDropFilesWideOffset = 16;
+
+void StoreU32(std::vector<uint8_t>* out, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+uint32_t LoadU32(const uint8_t* in) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; i--) {
+    value = (value << 8) | in[i];
+  }
+  return value;
+}
+
+void AppendBytes(std::vector<uint8_t>* out, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  out->insert(out->end(), bytes, bytes + size);
+}
+
+void AppendFormat(std::vector<uint8_t>* out, ClipboardFormat format,
+                  const void* data, size_t size) {
+  out->push_back(static_cast<uint8_t>(format));
+  StoreU32(out, static_cast<uint32_t>(size));
+  AppendBytes(out, data, size);
+}
+
+void AppendCodePoint(uint32_t code_point, std::string* out) {
+  if (code_point < 0x80) {
+    out->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+// The decimal value of header |name| ("StartFragment:") in |cf_html|, or
+// -1 if it is missing or not a number.
+int64_t HeaderOffset(std::string_view cf_html, std::string_view name) {
+  const size_t at = cf_html.find(name);
+  if (at == std::string_view::npos) {
+    return -1;
+  }
+  size_t i = at + name.size();
+  int64_t value = 0;
+  bool digits = false;
+  while (i < cf_html.size() && cf_html[i] >= '0' && cf_html[i] <= '9' &&
+         value < (int64_t{1} << 40)) {
+    value = value * 10 + (cf_html[i] - '0');
+    digits = true;
+    i++;
+  }
+  return digits ? value : -1;
+}
+
+}  // namespace
+
+std::vector<uint8_t> EncodeClipboardDescriptor(
+    const ClipboardFormats& formats) {
+  std::vector<uint8_t> out;
+  StoreU32(&out, kClipboardDescriptorMagic);
+  out.push_back(kClipboardDescriptorVersion);
+  const size_t count_at = out.size();
+  out.push_back(0);
+  uint8_t count = 0;
+  if (!formats.text.empty()) {
+    AppendFormat(&out, ClipboardFormat::kText, formats.text.data(),
+                 formats.text.size());
+    count++;
+  }
+  if (!formats.files.empty()) {
+    out.push_back(static_cast<uint8_t>(ClipboardFormat::kFiles));
+    const size_t length_at = out.size();
+    StoreU32(&out, 0);
+    StoreU32(&out, static_cast<uint32_t>(formats.files.size()));
+    for (const std::string& file : formats.files) {
+      StoreU32(&out, static_cast<uint32_t>(file.size()));
+      AppendBytes(&out, file.data(), file.size());
+    }
+    const uint32_t length =
+        static_cast<uint32_t>(out.size() - length_at - 4);
+    for (int i = 0; i < 4; i++) {
+      out[length_at + i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+    count++;
+  }
+  if (!formats.html.empty()) {
+    AppendFormat(&out, ClipboardFormat::kHtml, formats.html.data(),
+                 formats.html.size());
+    count++;
+  }
+  if (!formats.png.empty()) {
+    AppendFormat(&out, ClipboardFormat::kPng, formats.png.data(),
+                 formats.png.size());
+    count++;
+  }
+  out[count_at] = count;
+  return out;
+}
+
+bool DecodeClipboardDescriptor(const uint8_t* data, size_t size,
+                               ClipboardFormats* formats) {
+  *formats = ClipboardFormats();
+  if (size < 6 || LoadU32(data) != kClipboardDescriptorMagic ||
+      data[4] != kClipboardDescriptorVersion) {
+    return false;
+  }
+  const uint8_t count = data[5];
+  size_t at = 6;
+  for (uint8_t i = 0; i < count; i++) {
+    if (size - at < 5) {
+      return false;
+    }
+    const uint8_t format = data[at];
+    const uint32_t length = LoadU32(data + at + 1);
+    at += 5;
+    if (size - at < length) {
+      return false;
+    }
+    const uint8_t* bytes = data + at;
+    at += length;
+    switch (static_cast<ClipboardFormat>(format)) {
+      case ClipboardFormat::kText:
+        formats->text.assign(reinterpret_cast<const char*>(bytes), length);
+        break;
+      case ClipboardFormat::kHtml:
+        formats->html.assign(reinterpret_cast<const char*>(bytes), length);
+        break;
+      case ClipboardFormat::kPng:
+        formats->png.assign(bytes, bytes + length);
+        break;
+      case ClipboardFormat::kFiles: {
+        if (length < 4) {
+          return false;
+        }
+        const uint32_t files = LoadU32(bytes);
+        size_t offset = 4;
+        for (uint32_t f = 0; f < files; f++) {
+          if (length - offset < 4) {
+            return false;
+          }
+          const uint32_t path_length = LoadU32(bytes + offset);
+          offset += 4;
+          if (length - offset < path_length) {
+            return false;
+          }
+          formats->files.emplace_back(
+              reinterpret_cast<const char*>(bytes + offset), path_length);
+          offset += path_length;
+        }
+        break;
+      }
+      default:
+        break;  // added by a later version
+    }
+  }
+  return at == size;
+}
+
+void AppendUtf8FromUtf16(const char16_t* text, size_t length,
+                         std::string* out) {
+  for (size_t i = 0; i < length && text[i] != 0; i++) {
+    uint32_t unit = text[i];
+    if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < length &&
+        text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF) {
+      unit = 0x10000 + ((unit - 0xD800) << 10) + (text[i + 1] - 0xDC00);
+      i++;
+    } else if (unit >= 0xD800 && unit <= 0xDFFF) {
+      unit = 0xFFFD;
+    }
+    AppendCodePoint(unit, out);
+  }
+}
+
+bool ParseDropFiles(const uint8_t* data, size_t size,
+                    std::vector<std::string>* files) {
+  files->clear();
+  if (size < kDropFilesHeaderSize) {
+    return false;
+  }
+  const uint32_t list_offset = LoadU32(data);
+  if (LoadU32(data + kDropFilesWideOffset) == 0) {
+    return false;  // ANSI
+  }
+  if (list_offset < kDropFilesHeaderSize || list_offset > size) {
+    return false;
+  }
+  // Paths are UTF-16 and may sit at an odd offset, so are copied out.
+  const size_t units = (size - list_offset) / 2;
+  std::u16string list(units, u'\0');
+  std::memcpy(&list[0], data + list_offset, units * 2);
+  size_t start = 0;
+  while (start < units && list[start] != 0) {
+    size_t end = start;
+    while (end < units && list[end] != 0) {
+      end++;
+    }
+    if (end == units) {
+      return false;  // unterminated
+    }
+    std::string path;
+    AppendUtf8FromUtf16(list.data() + start, end - start, &path);
+    files->push_back(std::move(path));
+    start = end + 1;
+  }
+  return true;
+}
+
+bool ExtractHtmlFragment(std::string_view cf_html, std::string* fragment) {
+  const std::string_view pairs[2][2] = {
+      {"StartFragment:", "EndFragment:"},
+      {"StartHTML:", "EndHTML:"},
+  };
+  for (const auto& pair : pairs) {
+    const int64_t start = HeaderOffset(cf_html, pair[0]);
+    const int64_t end = HeaderOffset(cf_html, pair[1]);
+    if (start >= 0 && end >= start &&
+        end <= static_cast<int64_t>(cf_html.size())) {
+      fragment->assign(cf_html.substr(static_cast<size_t>(start),
+                                      static_cast<size_t>(end - start)));
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace sc
@@ -0,0 +1,77 @@
+#ifndef RUNNER_NATIVE_CLIPBOARD_FORMATS_H_
+#define RUNNER_NATIVE_CLIPBOARD_FORMATS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sc {
+
+// Clipboard formats read together, as tagged in the descriptor.
+enum class ClipboardFormat : uint8_t {
+  kText = 1,   // UTF-8
+  kFiles = 2,  // UTF-8 paths
+  kHtml = 3,   // UTF-8 HTML fragment
+  kPng = 4,    // PNG file bytes
+};
+
+// Bit for |format| in a mask of formats to read.
+constexpr uint32_t ClipboardFormatBit(ClipboardFormat format) {
+  return 1u << static_cast<uint8_t>(format);
+}
+constexpr uint32_t kAllClipboardFormats =
+    ClipboardFormatBit(ClipboardFormat::kText) |
+    ClipboardFormatBit(ClipboardFormat::kFiles) |
+    ClipboardFormatBit(ClipboardFormat::kHtml) |
+    ClipboardFormatBit(ClipboardFormat::kPng);
+
+// What one read of the clipboard found; empty members were not there.
+struct ClipboardFormats {
+  std::string text;
+  std::vector<std::string> files;
+  std::string html;
+  std::vector<uint8_t> png;
+};
+
+// Compact binary description of ClipboardFormats, handed to Dart in one
+// message (all integers little-endian):
+//
+//    0  u32  magic 'SCCF' (kClipboardDescriptorMagic)
+//    4  u8   version (kClipboardDescriptorVersion)
+//    5  u8   number of formats that follow
+//    6       per format: u8 ClipboardFormat, u32 length, |length| bytes
+//
+// kFiles holds a u32 path count, then a u32 length and the bytes of each
+// path; every other format holds its bytes as they are. Formats not on the
+// clipboard are left out.
+constexpr uint32_t kClipboardDescriptorMagic = 0x46434353;
+constexpr uint8_t kClipboardDescriptorVersion = 1;
+
+std::vector<uint8_t> EncodeClipboardDescriptor(const ClipboardFormats& formats);
+
+// Parses a descriptor, skipping formats it does not know. Returns false if
+// it is malformed.
+bool DecodeClipboardDescriptor(const uint8_t* data, size_t size,
+                               ClipboardFormats* formats);
+
+// Appends |length| UTF-16 code units of |text| to |out| as UTF-8, stopping
+// at a NUL. Unpaired surrogates become U+FFFD.
+void AppendUtf8FromUtf16(const char16_t* text, size_t length,
+                         std::string* out);
+
+// Reads the paths of a CF_HDROP block (a DROPFILES header followed by a
+// double-NUL-terminated list) of |size| bytes. Returns false if it is
+// malformed or lists ANSI paths, which need the system code page.
+bool ParseDropFiles(const uint8_t* data, size_t size,
+                    std::vector<std::string>* files);
+
+// Extracts the fragment from a CF_HTML ("HTML Format") block, using its
+// StartFragment/EndFragment byte offsets, or StartHTML/EndHTML without
+// them. Returns false if neither pair is valid.
+bool ExtractHtmlFragment(std::string_view cf_html, std::string* fragment);
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_CLIPBOARD_FORMATS_H_
@@ -0,0 +1,146 @@
+#include "clipboard_watcher.h"
+
+#include <cstring>
+#include <utility>
+
+#include "condition_wait.h"
+
+namespace sc {
+
+namespace {
+
+void UpdateWithString(Sha256* hasher, const std::string& value) {
+  uint8_t length[8];
+  const uint64_t size = value.size();
+  for (int i = 0; i < 8; i++) {
+    length[i] = static_cast<uint8_t>(size >> (8 * i));
+  }
+  // Length-prefixed so that no two lists of strings hash alike.
+  hasher->Update(length, sizeof(length));
+  hasher->Update(reinterpret_cast<const uint8_t*>(value.data()), size);
+}
+
+}  // namespace
+
+ClipboardWatcher::ClipboardWatcher(Reader reader, Listener listener)
+    : reader_(std::move(reader)), listener_(std::move(listener)) {
+  worker_ = std::thread(&ClipboardWatcher::Run, this);
+}
+
+ClipboardWatcher::~ClipboardWatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  worker_.join();
+}
+
+void ClipboardWatcher::Notify(uint64_t sequence) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = true;
+    pending_sequence_ = sequence;
+  }
+  wake_.notify_one();
+}
+
+std::shared_ptr<const ClipboardSnapshot> ClipboardWatcher::Latest() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return latest_;
+}
+
+std::shared_ptr<const ClipboardSnapshot> ClipboardWatcher::Current(
+    uint64_t sequence) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_ || reading_ || read_sequence_ != sequence) {
+    return nullptr;
+  }
+  return latest_;
+}
+
+bool ClipboardWatcher::WaitIdle(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return idle_.wait_for(lock, timeout,
+                        [this] { return !pending_ && !reading_; });
+}
+
+void ClipboardWatcher::Digest(const ClipboardSnapshot& snapshot,
+                              uint8_t digest[Sha256::kDigestSize]) {
+  Sha256 hasher;
+  const uint8_t kind = static_cast<uint8_t>(snapshot.kind);
+  hasher.Update(&kind, 1);
+  if (snapshot.kind == ClipboardSnapshot::Kind::kText) {
+    UpdateWithString(&hasher, snapshot.text);
+  } else if (snapshot.kind == ClipboardSnapshot::Kind::kFiles) {
+    for (const std::string& file : snapshot.files) {
+      UpdateWithString(&hasher, file);
+    }
+  }
+  hasher.Finish(digest);
+}
+
+void ClipboardWatcher::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    WaitFor(wake_, lock, [this] { return stopping_ || pending_; });
+    if (stopping_) {
+      return;
+    }
+    const uint64_t sequence = pending_sequence_;
+    pending_ = false;
+    reading_ = true;
+    lock.unlock();
+    ReadAt(sequence);
+    lock.lock();
+    reading_ = false;
+    if (!pending_) {
+      idle_.notify_all();
+    }
+  }
+}
+
+void ClipboardWatcher::ReadAt(uint64_t sequence) {
+  auto snapshot = std::make_shared<ClipboardSnapshot>();
+  bool read = false;
+  std::chrono::milliseconds delay = kFirstRetryDelay;
+  for (int attempt = 0; attempt < kReadAttempts; attempt++) {
+    if (attempt > 0) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // A newer change or shutdown makes this read moot.
+      if (wake_.wait_for(lock, delay,
+                         [this] { return stopping_ || pending_; })) {
+        return;
+      }
+      delay *= 2;
+    }
+    *snapshot = ClipboardSnapshot();
+    snapshot->sequence = sequence;
+    if (reader_(snapshot.get())) {
+      read = true;
+      break;
+    }
+  }
+  if (!read) {
+    return;
+  }
+  Digest(*snapshot, snapshot->digest);
+
+  std::shared_ptr<const ClipboardSnapshot> changed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    read_sequence_ = sequence;
+    if (latest_ != nullptr &&
+        std::memcmp(latest_->digest, snapshot->digest,
+                    Sha256::kDigestSize) == 0) {
+      return;  // copied again; |latest_| still holds it
+    }
+    latest_ = snapshot;
+    changed = latest_;
+  }
+  if (listener_) {
+    listener_(std::move(changed));
+  }
+}
+
+}  // namespace sc
@@ -0,0 +1,108 @@
+#ifndef RUNNER_NATIVE_CLIPBOARD_WATCHER_H_
+#define RUNNER_NATIVE_CLIPBOARD_WATCHER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sha256.h"
+
+namespace sc {
+
+// The clipboard as read once, with a digest of what it held.
+struct ClipboardSnapshot {
+  enum class Kind : uint8_t {
+    kEmpty = 0,
+    kText = 1,
+    kFiles = 2,
+  };
+
+  // Clipboard sequence number it was first read at.
+  uint64_t sequence = 0;
+  Kind kind = Kind::kEmpty;
+  std::string text;                // UTF-8, for kText
+  std::vector<std::string> files;  // UTF-8 paths, for kFiles
+  // SHA-256 of the kind and content; equal digests mean equal content.
+  uint8_t digest[Sha256::kDigestSize] = {};
+};
+
+// Keeps a snapshot of the clipboard current as it changes, so a share can
+// start from content already read instead of reading it on demand.
+//
+// The platform layer calls Notify() whenever the system reports a change
+// (WM_CLIPBOARDUPDATE on Windows) with the clipboard's sequence number;
+// the call only records the number and wakes a worker thread, which reads
+// the clipboard through |reader| and digests it there. Changes that arrive
+// while a read is in progress are coalesced into one more read. A reader
+// that finds the clipboard held by another process returns false and is
+// retried a few times with backoff.
+//
+// |listener| is called on the worker thread when the content changes,
+// not when the same content is copied again.
+class ClipboardWatcher {
+ public:
+  // Fills in the kind and content of |snapshot|. Returns false if the
+  // clipboard could not be opened.
+  using Reader = std::function<bool(ClipboardSnapshot* snapshot)>;
+  using Listener =
+      std::function<void(std::shared_ptr<const ClipboardSnapshot> snapshot)>;
+
+  static constexpr int kReadAttempts = 5;
+  static constexpr std::chrono::milliseconds kFirstRetryDelay{10};
+
+  ClipboardWatcher(Reader reader, Listener listener);
+  ~ClipboardWatcher();
+
+  // Prevent copying.
+  ClipboardWatcher(ClipboardWatcher const&) = delete;
+  ClipboardWatcher& operator=(ClipboardWatcher const&) = delete;
+
+  // Records that the clipboard changed to |sequence|. Never blocks on a
+  // read; safe from any thread.
+  void Notify(uint64_t sequence);
+
+  // The last snapshot read, or null before the first.
+  std::shared_ptr<const ClipboardSnapshot> Latest() const;
+  // The last snapshot if it was read at |sequence| or holds what was read
+  // then, else null: the caller must read the clipboard itself.
+  std::shared_ptr<const ClipboardSnapshot> Current(uint64_t sequence) const;
+
+  // Blocks until everything notified before the call has been read, or
+  // |timeout| passes. Returns false on timeout.
+  bool WaitIdle(std::chrono::milliseconds timeout);
+
+  // Writes the digest of |snapshot|'s kind and content to |digest|.
+  static void Digest(const ClipboardSnapshot& snapshot,
+                     uint8_t digest[Sha256::kDigestSize]);
+
+ private:
+  void Run();
+  // Reads the clipboard at |sequence| and publishes it if it changed.
+  void ReadAt(uint64_t sequence);
+
+  Reader reader_;
+  Listener listener_;
+
+  std::thread worker_;
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  // Guarded by |mutex_|.
+  bool stopping_ = false;
+  bool pending_ = false;
+  bool reading_ = false;
+  uint64_t pending_sequence_ = 0;
+  uint64_t read_sequence_ = 0;  // last sequence read, whatever it held
+  std::shared_ptr<const ClipboardSnapshot> latest_;
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_CLIPBOARD_WATCHER_H_
@@ -0,0 +1,315 @@
+#include "compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace sc {
+
+namespace {
+
+// LZ4 block format limits.
+constexpr size_t kMinMatch = 4;
+// The last five bytes are always literals.
+constexpr size_t kLastLiterals = 5;
+// A match may not start within the last twelve bytes.
+constexpr size_t kMatchStartLimit = 12;
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashLog = 12;
+// Misses before the search step grows, as a power of two.
+constexpr int kSkipTrigger = 6;
+
+uint32_t Load32(const uint8_t* p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint64_t Load64(const uint8_t* p) {
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Index of the lowest set bit of a nonzero |value|.
+int LowestBit(uint64_t value) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+
+// Number of equal bytes at |a| and |b|, comparing no further than |limit|
+// from |a|. Assumes a little-endian host, as are all supported targets.
+size_t CountMatch(const uint8_t* a, const uint8_t* b, const uint8_t* limit) {
+  const uint8_t* const start = a;
+  while (a + 8 <= limit) {
+    const uint64_t diff = Load64(a) ^ Load64(b);
+    if (diff != 0) {
+      return static_cast<size_t>(a - start) + LowestBit(diff) / 8;
+    }
+    a += 8;
+    b += 8;
+  }
+  while (a < limit && *a == *b) {
+    a++;
+    b++;
+  }
+  return static_cast<size_t>(a - start);
+}
+
+uint32_t Hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashLog);
+}
+
+// Writes the extra bytes of a length whose 4-bit token field saturated.
+uint8_t* WriteLength(uint8_t* op, size_t length) {
+  for (; length >= 255; length -= 255) {
+    *op++ = 255;
+  }
+  *op++ = static_cast<uint8_t>(length);
+  return op;
+}
+
+// Reads the extra bytes of a saturated length. Returns false if the input
+// ends first or the length exceeds |limit|.
+bool ReadLength(const uint8_t** ip, const uint8_t* end, size_t limit,
+                size_t* length) {
+  uint8_t byte;
+  do {
+    if (*ip >= end) {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+    if (*length > limit) {
+      return false;
+    }
+  } while (byte == 255);
+  return true;
+}
+
+// Emits one sequence of |literal_length| literals followed by a match, or
+// only literals when |match_length| is zero. Returns nullptr if it would
+// overrun |out_end|.
+uint8_t* EmitSequence(uint8_t* op, uint8_t* out_end, const uint8_t* literals,
+                      size_t literal_length, size_t offset,
+                      size_t match_length) {
+  const size_t needed = 1 + literal_length + literal_length / 255 + 1 +
+                        (match_length != 0 ? 2 + match_length / 255 + 1 : 0);
+  if (needed > static_cast<size_t>(out_end - op)) {
+    return nullptr;
+  }
+  uint8_t* token = op++;
+  *token = 0;
+  if (literal_length >= 15) {
+    *token = 15 << 4;
+    op = WriteLength(op, literal_length - 15);
+  } else {
+    *token = static_cast<uint8_t>(literal_length << 4);
+  }
+  if (literal_length != 0) {
+    std::memcpy(op, literals, literal_length);
+    op += literal_length;
+  }
+  if (match_length == 0) {
+    return op;
+  }
+  *op++ = static_cast<uint8_t>(offset);
+  *op++ = static_cast<uint8_t>(offset >> 8);
+  const size_t code = match_length - kMinMatch;
+  if (code >= 15) {
+    *token |= 15;
+    op = WriteLength(op, code - 15);
+  } else {
+    *token |= static_cast<uint8_t>(code);
+  }
+  return op;
+}
+
+}  // namespace
+
+size_t Lz4CompressBound(size_t length) { return length + length / 255 + 16; }
+
+size_t Lz4Compress(const uint8_t* data, size_t length, uint8_t* out,
+                   size_t capacity, int acceleration) {
+  if (length > kLz4MaxInputSize || out == nullptr ||
+      (data == nullptr && length != 0)) {
+    return 0;
+  }
+  const uint8_t* const end = data + length;
+  const uint8_t* anchor = data;
+  uint8_t* op = out;
+  uint8_t* const out_end = out + capacity;
+
+  if (length > kMatchStartLimit) {
+    const uint8_t* const match_start_limit = end - kMatchStartLimit;
+    const uint8_t* const match_end_limit = end - kLastLiterals;
+    const uint32_t initial_skip =
+        static_cast<uint32_t>(std::max(acceleration, 1)) << kSkipTrigger;
+    uint32_t table[1 << kHashLog] = {};
+    uint32_t skip = initial_skip;
+    const uint8_t* ip = data + 1;
+    while (ip < match_start_limit) {
+      const uint32_t sequence = Load32(ip);
+      uint32_t& slot = table[Hash(sequence)];
+      const uint8_t* candidate = data + slot;
+      slot = static_cast<uint32_t>(ip - data);
+      if (static_cast<size_t>(ip - candidate) > kMaxOffset ||
+          Load32(candidate) != sequence) {
+        ip += skip++ >> kSkipTrigger;
+        continue;
+      }
+      // Stretch the match backwards over pending literals, then forwards.
+      while (ip > anchor && candidate > data && ip[-1] == candidate[-1]) {
+        ip--;
+        candidate--;
+      }
+      const size_t match_length =
+          kMinMatch + CountMatch(ip + kMinMatch, candidate + kMinMatch,
+                                 match_end_limit);
+      op = EmitSequence(op, out_end, anchor, static_cast<size_t>(ip - anchor),
+                        static_cast<size_t>(ip - candidate), match_length);
+      if (op == nullptr) {
+        return 0;
+      }
+      ip += match_length;
+      anchor = ip;
+      skip = initial_skip;
+      if (ip - 2 > data && ip < match_start_limit) {
+        table[Hash(Load32(ip - 2))] = static_cast<uint32_t>(ip - 2 - data);
+      }
+    }
+  }
+  op = EmitSequence(op, out_end, anchor, static_cast<size_t>(end - anchor), 0,
+                    0);
+  return op == nullptr ? 0 : static_cast<size_t>(op - out);
+}
+
+bool Lz4Decompress(const uint8_t* data, size_t length, uint8_t* out,
+                   size_t raw_length) {
+  if (data == nullptr || length == 0 || (out == nullptr && raw_length != 0)) {
+    return false;
+  }
+  const uint8_t* ip = data;
+  const uint8_t* const end = data + length;
+  uint8_t* op = out;
+  uint8_t* const out_end = out + raw_length;
+  for (;;) {
+    const uint8_t token = *ip++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 &&
+        !ReadLength(&ip, end, raw_length, &literal_length)) {
+      return false;
+    }
+    if (literal_length > static_cast<size_t>(end - ip) ||
+        literal_length > static_cast<size_t>(out_end - op)) {
+      return false;
+    }
+    if (literal_length <= 16 && end - ip >= 16 && out_end - op >= 16) {
+      // Short literals are the common case; a fixed-size copy beats a
+      // variable one, and the extra bytes are overwritten later.
+      std::memcpy(op, ip, 16);
+    } else if (literal_length != 0) {
+      std::memcpy(op, ip, literal_length);
+    }
+    ip += literal_length;
+    op += literal_length;
+    if (ip == end) {
+      // The last sequence carries literals only.
+      return op == out_end;
+    }
+    if (end - ip < 2) {
+      return false;
+    }
+    const size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > static_cast<size_t>(op - out)) {
+      return false;
+    }
+    size_t match_length = token & 15;
+    if (match_length == 15 &&
+        !ReadLength(&ip, end, raw_length, &match_length)) {
+      return false;
+    }
+    match_length += kMinMatch;
+    if (match_length > static_cast<size_t>(out_end - op)) {
+      return false;
+    }
+    const uint8_t* match = op - offset;
+    if (offset >= 8 && static_cast<size_t>(out_end - op) >= match_length + 8) {
+      // Copies in 8-byte steps may run up to 7 bytes past the match.
+      for (size_t i = 0; i < match_length; i += 8) {
+        std::memcpy(op + i, match + i, 8);
+      }
+      op += match_length;
+    } else if (offset >= match_length) {
+      std::memcpy(op, match, match_length);
+      op += match_length;
+    } else {
+      // Overlapping copy repeats the last |offset| bytes.
+      for (size_t i = 0; i < match_length; i++) {
+        *op++ = *match++;
+      }
+    }
+    if (ip >= end) {
+      return false;
+    }
+  }
+}
+
+double EstimateEntropy(const uint8_t* data, size_t length) {
+  if (data == nullptr || length == 0) {
+    return 0;
+  }
+  // Sample runs of 256 bytes rather than single bytes so that the estimate
+  // sees the same local structure the compressor would.
+  constexpr size_t kRun = 256;
+  uint32_t counts[256] = {};
+  size_t sampled = 0;
+  if (length <= kEntropySampleSize) {
+    for (size_t i = 0; i < length; i++) {
+      counts[data[i]]++;
+    }
+    sampled = length;
+  } else {
+    const size_t runs = kEntropySampleSize / kRun;
+    const size_t stride = (length - kRun) / (runs - 1);
+    for (size_t r = 0; r < runs; r++) {
+      const uint8_t* run = data + r * stride;
+      for (size_t i = 0; i < kRun; i++) {
+        counts[run[i]]++;
+      }
+    }
+    sampled = runs * kRun;
+  }
+  double entropy = 0;
+  const double total = static_cast<double>(sampled);
+  for (uint32_t count : counts) {
+    if (count != 0) {
+      const double p = count / total;
+      entropy -= p * std::log2(p);
+    }
+  }
+  return entropy;
+}
+
+size_t CompressChunk(const uint8_t* data, size_t length, uint8_t* out,
+                     size_t capacity, int acceleration) {
+  if (length == 0 || EstimateEntropy(data, length) > kIncompressibleEntropy) {
+    return 0;
+  }
+  // Anything that does not save at least 1/16 goes raw, which also bounds
+  // the output so a too-small buffer simply means "not worth it".
+  const size_t limit = std::min(capacity, length - length / 16);
+  return Lz4Compress(data, length, out, limit, acceleration);
+}
+
+}  // namespace sc
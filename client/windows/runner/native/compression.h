@@ -0,0 +1,54 @@
+#ifndef RUNNER_NATIVE_COMPRESSION_H_
+#define RUNNER_NATIVE_COMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sc {
+
+// Optional per-chunk compression of transfer payloads.
+//
+// Chunks are compressed with the LZ4 block format: no entropy coding, so
+// compression runs at several hundred MB/s and decompression at memory
+// speed, which keeps it ahead of a fast LAN link. Already compressed data
+// (media, archives) gains nothing, so CompressChunk() first samples the
+// byte distribution and sends such chunks as they are.
+
+// Order-0 entropies above this many bits per byte are treated as
+// incompressible. Random data sits just under 8.
+constexpr double kIncompressibleEntropy = 7.5;
+
+// Bytes sampled by EstimateEntropy(), spread across the input.
+constexpr size_t kEntropySampleSize = 4096;
+
+// Largest input accepted by Lz4Compress().
+constexpr size_t kLz4MaxInputSize = 0x7E000000;
+
+// Upper bound on the compressed size of |length| input bytes.
+size_t Lz4CompressBound(size_t length);
+
+// Compresses |length| bytes of |data| into |out| as one LZ4 block. Higher
+// |acceleration| trades ratio for speed; 1 is the reference default.
+// Returns the compressed size, or 0 if it does not fit in |capacity|.
+size_t Lz4Compress(const uint8_t* data, size_t length, uint8_t* out,
+                   size_t capacity, int acceleration = 1);
+
+// Decompresses one LZ4 block. Every read and write is bounds checked, so
+// corrupt or hostile input is rejected rather than trusted. Returns false
+// unless the block decodes to exactly |raw_length| bytes.
+bool Lz4Decompress(const uint8_t* data, size_t length, uint8_t* out,
+                   size_t raw_length);
+
+// Shannon entropy in bits per byte of up to kEntropySampleSize bytes sampled
+// evenly from |data|.
+double EstimateEntropy(const uint8_t* data, size_t length);
+
+// Compresses |data| into |out| if that is worthwhile: the entropy estimate
+// is below kIncompressibleEntropy and the result saves at least 1/16 of the
+// input. Returns the compressed size, or 0 if the chunk should be sent raw.
+size_t CompressChunk(const uint8_t* data, size_t length, uint8_t* out,
+                     size_t capacity, int acceleration = 1);
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_COMPRESSION_H_
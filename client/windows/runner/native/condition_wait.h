@@ -0,0 +1,22 @@
+#ifndef RUNNER_NATIVE_CONDITION_WAIT_H_
+#define RUNNER_NATIVE_CONDITION_WAIT_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace sc {
+
+// Waits on |cv| until |ready| holds. Timed waits are inline in libstdc++, so
+// the library still loads against runtimes older than the GCC 12 symbol
+// version of condition_variable::wait().
+template <typename Predicate>
+void WaitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+             Predicate ready) {
+  while (!cv.wait_for(lock, std::chrono::seconds(1), ready)) {
+  }
+}
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_CONDITION_WAIT_H_
@@ -0,0 +1,148 @@
+#include "content_chunker.h"
+
+#include <algorithm>
+#include <array>
+
+namespace sc {
+
+namespace {
+
+constexpr uint32_t kMinimumChunkSize = 64;
+
+// splitmix64, used to fill the Gear table with fixed pseudo-random values.
+// Senders and receivers must agree on the table for chunks to match.
+constexpr uint64_t SplitMix64(uint64_t* state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+constexpr std::array<uint64_t, 256> MakeGearTable(int shift) {
+  std::array<uint64_t, 256> table{};
+  uint64_t state = 0x5C0C11B0A4Dull;
+  for (auto& value : table) {
+    value = SplitMix64(&state) << shift;
+  }
+  return table;
+}
+
+constexpr std::array<uint64_t, 256> kGear = MakeGearTable(0);
+// kGear shifted left by one, for the first byte of each two-byte step.
+constexpr std::array<uint64_t, 256> kGearShifted = MakeGearTable(1);
+
+// |bits| ones just below the top bit. The high bits of the Gear hash depend
+// on the last 64 bytes, the low bits only on the last few. Bit 63 is left
+// out so the mask can be shifted left by one for the two-byte step.
+uint64_t MaskWithBits(int bits) {
+  bits = std::clamp(bits, 1, 48);
+  return ((uint64_t{1} << bits) - 1) << (63 - bits);
+}
+
+int Log2(uint32_t value) {
+  int bits = 0;
+  while (value > 1) {
+    value >>= 1;
+    bits++;
+  }
+  return bits;
+}
+
+// Rolls |hash| over data[*pos, limit) and returns the first cut point, or 0
+// if there is none. Two bytes per step: after the first byte the hash is
+// kept doubled, and a doubled hash masked with mask << 1 is zero exactly when
+// the plain hash masked with |mask| is.
+size_t Roll(const uint8_t* data, size_t* pos, size_t limit, uint64_t mask,
+            uint64_t* hash) {
+  const uint64_t mask_shifted = mask << 1;
+  uint64_t h = *hash;
+  size_t i = *pos;
+  for (; i + 2 <= limit; i += 2) {
+    h = (h << 2) + kGearShifted[data[i]];
+    if ((h & mask_shifted) == 0) {
+      return i + 1;
+    }
+    h += kGear[data[i + 1]];
+    if ((h & mask) == 0) {
+      return i + 2;
+    }
+  }
+  if (i < limit) {
+    h = (h << 1) + kGear[data[i]];
+    i++;
+    if ((h & mask) == 0) {
+      return i;
+    }
+  }
+  *hash = h;
+  *pos = i;
+  return 0;
+}
+
+}  // namespace
+
+ContentChunker::ContentChunker(uint32_t min_size, uint32_t average_size,
+                               uint32_t max_size)
+    : min_size_(std::max(min_size, kMinimumChunkSize)),
+      average_size_(std::max(average_size, min_size_)),
+      max_size_(std::max(max_size, average_size_)) {
+  const int bits = Log2(average_size_);
+  mask_small_ = MaskWithBits(bits + 2);
+  mask_large_ = MaskWithBits(bits - 2);
+}
+
+size_t ContentChunker::Cut(const uint8_t* data, size_t length) const {
+  if (length <= min_size_) {
+    return length;
+  }
+  const size_t end = std::min<size_t>(length, max_size_);
+  const size_t normal = std::min<size_t>(end, average_size_);
+  uint64_t hash = 0;
+  size_t pos = min_size_;
+  size_t cut = Roll(data, &pos, normal, mask_small_, &hash);
+  if (cut == 0) {
+    cut = Roll(data, &pos, end, mask_large_, &hash);
+  }
+  return cut != 0 ? cut : end;
+}
+
+size_t ContentChunker::CutReference(const uint8_t* data, size_t length) const {
+  if (length <= min_size_) {
+    return length;
+  }
+  const size_t end = std::min<size_t>(length, max_size_);
+  const size_t normal = std::min<size_t>(end, average_size_);
+  uint64_t hash = 0;
+  size_t i = min_size_;
+  for (; i < normal; i++) {
+    hash = (hash << 1) + kGear[data[i]];
+    if ((hash & mask_small_) == 0) {
+      return i + 1;
+    }
+  }
+  for (; i < end; i++) {
+    hash = (hash << 1) + kGear[data[i]];
+    if ((hash & mask_large_) == 0) {
+      return i + 1;
+    }
+  }
+  return end;
+}
+
+bool ContentChunker::Next(ChunkSource* source, uint64_t offset,
+                          uint32_t* out_length,
+                          uint8_t digest[Sha256::kDigestSize]) const {
+  size_t length = 0;
+  const uint8_t* data = source->View(offset, max_size_, &length);
+  if (data == nullptr || length == 0) {
+    return false;
+  }
+  const size_t cut = Cut(data, length);
+  Sha256 hasher;
+  hasher.Update(data, cut);
+  hasher.Finish(digest);
+  *out_length = static_cast<uint32_t>(cut);
+  return true;
+}
+
+}  // namespace sc
@@ -0,0 +1,60 @@
+#ifndef RUNNER_NATIVE_CONTENT_CHUNKER_H_
+#define RUNNER_NATIVE_CONTENT_CHUNKER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chunk_source.h"
+#include "sha256.h"
+
+namespace sc {
+
+// Splits data into content-defined chunks (FastCDC) so that an edit only
+// changes the chunks around it, and the rest of a re-shared file can be found
+// in the receiver's chunk store.
+//
+// Cut points come from a Gear rolling hash with normalized chunking: a
+// stricter mask before the average size and a looser one after it keeps
+// chunk sizes close to the average. The hash is rolled two bytes per step,
+// which gives the same cut points as the byte-wise loop with half the
+// branches.
+class ContentChunker {
+ public:
+  static constexpr uint32_t kDefaultMinSize = 16 * 1024;
+  static constexpr uint32_t kDefaultAverageSize = 64 * 1024;
+  static constexpr uint32_t kDefaultMaxSize = 256 * 1024;
+
+  // Sizes are clamped so that 64 <= min <= average <= max.
+  explicit ContentChunker(uint32_t min_size = kDefaultMinSize,
+                          uint32_t average_size = kDefaultAverageSize,
+                          uint32_t max_size = kDefaultMaxSize);
+
+  // Returns the length of the chunk that starts at |data|. |length| is the
+  // number of bytes available; pass at least max_size() bytes unless the
+  // data ends sooner.
+  size_t Cut(const uint8_t* data, size_t length) const;
+
+  // Byte-at-a-time reference for Cut(), used by the tests.
+  size_t CutReference(const uint8_t* data, size_t length) const;
+
+  // Finds the chunk of |source| starting at |offset|, and stores its length
+  // in |out_length| and its SHA-256 in |digest|. Returns false at end of
+  // file or on a read error.
+  bool Next(ChunkSource* source, uint64_t offset, uint32_t* out_length,
+            uint8_t digest[Sha256::kDigestSize]) const;
+
+  uint32_t min_size() const { return min_size_; }
+  uint32_t average_size() const { return average_size_; }
+  uint32_t max_size() const { return max_size_; }
+
+ private:
+  uint32_t min_size_;
+  uint32_t average_size_;
+  uint32_t max_size_;
+  uint64_t mask_small_;  // more bits: cuts are rarer before the average
+  uint64_t mask_large_;  // fewer bits: cuts are likelier after it
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_CONTENT_CHUNKER_H_
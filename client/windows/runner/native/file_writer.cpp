@@ -0,0 +1,349 @@
+#include "file_writer.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <utility>
+
+#include "condition_wait.h"
+
+namespace sc {
+
+FileWriter::FileWriter() {}
+
+FileWriter::~FileWriter() { Close(); }
+
+bool FileWriter::Open(const std::string& path, uint64_t size, uint64_t keep,
+                      size_t pool_size, WriteWorker* worker) {
+  Close();
+  uint64_t current_size = 0;
+#if defined(_WIN32)
+  HANDLE file = ::CreateFileW(std::filesystem::u8path(path).c_str(),
+                              GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER file_size;
+  if (!::GetFileSizeEx(file, &file_size)) {
+    ::CloseHandle(file);
+    return false;
+  }
+  file_ = file;
+  current_size = static_cast<uint64_t>(file_size.QuadPart);
+#else
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    return false;
+  }
+  fd_ = fd;
+  current_size = static_cast<uint64_t>(st.st_size);
+#endif
+  // The kept prefix must already be there.
+  if (keep > current_size || keep > size || !Truncate(keep)) {
+    CloseFile();
+    return false;
+  }
+  preallocated_ = size > keep && Preallocate(size);
+  is_open_ = true;
+  end_ = keep;
+  submitted_ = 0;
+  written_ = 0;
+  failed_ = false;
+  if (worker == nullptr) {
+    own_worker_ = std::make_unique<WriteWorker>(pool_size);
+    worker = own_worker_.get();
+  }
+  worker_ = worker;
+  return true;
+}
+
+bool FileWriter::Write(uint64_t offset, const uint8_t* data, size_t length) {
+  if (length == 0) {
+    return is_open_ && !failed();
+  }
+  if (data == nullptr) {
+    return false;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!is_open_ || failed_) {
+    return false;
+  }
+  // Check the whole write fits before copying any of it.
+  const bool appends = !filling_.data.empty() &&
+                       offset == filling_.offset + filling_.data.size();
+  const size_t room = appends ? kExtentSize - filling_.data.size() : 0;
+  const size_t extents_needed =
+      length > room ? (length - room + kExtentSize - 1) / kExtentSize : 0;
+  if (!worker_->Reserve(extents_needed)) {
+    return false;
+  }
+  if (!appends && !filling_.data.empty()) {
+    queue_.push_back(std::move(filling_));
+    filling_ = Extent();
+  }
+  size_t done = 0;
+  while (done < length) {
+    if (filling_.data.size() == kExtentSize) {
+      queue_.push_back(std::move(filling_));
+      filling_ = Extent();
+    }
+    if (filling_.data.empty()) {
+      filling_.data = worker_->TakeStorage();
+      filling_.offset = offset + done;
+    }
+    const size_t take =
+        std::min(length - done, kExtentSize - filling_.data.size());
+    filling_.data.insert(filling_.data.end(), data + done, data + done + take);
+    done += take;
+  }
+  submitted_ += length;
+  end_ = std::max(end_, offset + length);
+  // The worker takes the partly filled extent on the writer's next turn, so
+  // it grows while earlier extents are being written.
+  if (!scheduled_) {
+    scheduled_ = true;
+    worker_->Schedule(this);
+  }
+  return true;
+}
+
+bool FileWriter::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Unscheduled means nothing is queued, being written or left to fill.
+  WaitFor(work_done_, lock, [this] { return !is_open_ || !scheduled_; });
+  return !failed_;
+}
+
+bool FileWriter::Close() {
+  if (!is_open_) {
+    return !failed();
+  }
+  Flush();
+  own_worker_ = nullptr;
+  bool ok = !failed();
+  // Gives back reserved space past the data.
+  if (ok && preallocated_) {
+    ok = Truncate(end_);
+  }
+  CloseFile();
+  std::lock_guard<std::mutex> lock(mutex_);
+  is_open_ = false;
+  failed_ = !ok;
+  worker_ = nullptr;
+  return ok;
+}
+
+uint64_t FileWriter::written() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return written_;
+}
+
+uint64_t FileWriter::queued() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return submitted_ - written_;
+}
+
+bool FileWriter::failed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return failed_;
+}
+
+bool FileWriter::WriteNext() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Extent extent;
+  if (!queue_.empty()) {
+    extent = std::move(queue_.front());
+    queue_.pop_front();
+  } else if (!filling_.data.empty()) {
+    extent = std::move(filling_);
+    filling_ = Extent();
+  } else {
+    scheduled_ = false;
+    work_done_.notify_all();
+    return false;
+  }
+  writing_ = true;
+  const bool skip = failed_;
+  lock.unlock();
+  const bool ok =
+      skip || WriteAt(extent.offset, extent.data.data(), extent.data.size());
+  lock.lock();
+  writing_ = false;
+  if (skip || !ok) {
+    failed_ = true;
+  } else {
+    written_ += extent.data.size();
+  }
+  worker_->Recycle(std::move(extent.data));
+  // Once unscheduled, Close() may destroy the writer as soon as the lock is
+  // released, so nothing after this may touch it.
+  const bool more = !queue_.empty() || !filling_.data.empty();
+  scheduled_ = more;
+  work_done_.notify_all();
+  return more;
+}
+
+bool FileWriter::WriteAt(uint64_t offset, const uint8_t* data,
+                         size_t length) {
+  size_t done = 0;
+  while (done < length) {
+#if defined(_WIN32)
+    OVERLAPPED overlapped = {};
+    const uint64_t position = offset + done;
+    overlapped.Offset = static_cast<DWORD>(position & 0xffffffffu);
+    overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+    DWORD wrote = 0;
+    const DWORD request = static_cast<DWORD>(
+        std::min<size_t>(length - done, 1u << 30));
+    if (!::WriteFile(file_, data + done, request, &wrote, &overlapped) ||
+        wrote == 0) {
+      return false;
+    }
+#else
+    const ssize_t wrote = ::pwrite(fd_, data + done, length - done,
+                                   static_cast<off_t>(offset + done));
+    if (wrote < 0 && errno == EINTR) {
+      continue;
+    }
+    if (wrote <= 0) {
+      return false;
+    }
+#endif
+    done += static_cast<size_t>(wrote);
+  }
+  return true;
+}
+
+bool FileWriter::Preallocate(uint64_t size) {
+#if defined(_WIN32)
+  FILE_ALLOCATION_INFO info = {};
+  info.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+  return ::SetFileInformationByHandle(file_, FileAllocationInfo, &info,
+                                      sizeof(info)) != 0;
+#elif defined(__linux__)
+  // Unlike posix_fallocate(), fails instead of writing zeros on file
+  // systems that cannot reserve space.
+  return ::fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) ==
+         0;
+#elif defined(__APPLE__)
+  fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0,
+                    static_cast<off_t>(size), 0};
+  if (::fcntl(fd_, F_PREALLOCATE, &store) == 0) {
+    return true;
+  }
+  store.fst_flags = F_ALLOCATEALL;
+  return ::fcntl(fd_, F_PREALLOCATE, &store) == 0;
+#else
+  (void)size;
+  return false;
+#endif
+}
+
+bool FileWriter::Truncate(uint64_t size) {
+#if defined(_WIN32)
+  LARGE_INTEGER position;
+  position.QuadPart = static_cast<LONGLONG>(size);
+  return ::SetFilePointerEx(file_, position, nullptr, FILE_BEGIN) &&
+         ::SetEndOfFile(file_);
+#else
+  return ::ftruncate(fd_, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+void FileWriter::CloseFile() {
+#if defined(_WIN32)
+  if (file_ != nullptr) {
+    ::CloseHandle(file_);
+    file_ = nullptr;
+  }
+#else
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+#endif
+}
+
+WriteWorker::WriteWorker(size_t pool_size)
+    : max_extents_(std::max<size_t>(2, pool_size / FileWriter::kExtentSize)),
+      thread_(&WriteWorker::Run, this) {}
+
+WriteWorker::~WriteWorker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_one();
+  thread_.join();
+}
+
+bool WriteWorker::Reserve(size_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (extents_in_use_ + count > max_extents_) {
+    return false;
+  }
+  extents_in_use_ += count;
+  return true;
+}
+
+std::vector<uint8_t> WriteWorker::TakeStorage() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<uint8_t> storage;
+  if (!spare_.empty()) {
+    storage = std::move(spare_.back());
+    spare_.pop_back();
+  } else {
+    storage.reserve(FileWriter::kExtentSize);
+  }
+  return storage;
+}
+
+void WriteWorker::Recycle(std::vector<uint8_t> storage) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  storage.clear();
+  spare_.push_back(std::move(storage));
+  extents_in_use_--;
+}
+
+void WriteWorker::Schedule(FileWriter* writer) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writers_.push_back(writer);
+  }
+  ready_.notify_one();
+}
+
+void WriteWorker::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    WaitFor(ready_, lock, [this] { return stopping_ || !writers_.empty(); });
+    if (writers_.empty()) {
+      return;
+    }
+    FileWriter* writer = writers_.front();
+    writers_.pop_front();
+    lock.unlock();
+    const bool more = writer->WriteNext();
+    lock.lock();
+    if (more) {
+      writers_.push_back(writer);
+    }
+  }
+}
+
+}  // namespace sc
@@ -0,0 +1,160 @@
+#ifndef RUNNER_NATIVE_FILE_WRITER_H_
+#define RUNNER_NATIVE_FILE_WRITER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sc {
+
+class WriteWorker;
+
+// Writes a received file on a background thread, for the receiving side.
+//
+// Write() copies the bytes into a bounded pool of extents and returns at
+// once; a WriteWorker thread stores each extent at its offset with positional
+// writes (pwrite on POSIX, WriteFile with an offset on Windows). Bytes
+// arriving while the disk is busy are appended to the extent being filled,
+// so a slow disk sees fewer, larger writes. The file's space is reserved up
+// front, without changing its size, so it is laid out contiguously and a
+// full disk is noticed before the transfer starts rather than midway.
+//
+// The pool never grows. Callers release receive credit as written()
+// advances, which keeps the sender within the pool; a Write() that does not
+// fit is refused rather than blocking. Writers opened on a shared
+// WriteWorker share its thread and pool; otherwise each has its own.
+//
+// Write() and the accessors may be called from one thread at a time.
+class FileWriter {
+ public:
+  // Size of one pooled extent.
+  static constexpr size_t kExtentSize = 1024 * 1024;
+  // Covers the 16 MiB receive window plus the partly filled extents at
+  // either end of the queue.
+  static constexpr size_t kDefaultPoolSize = 20 * kExtentSize;
+
+  FileWriter();
+  ~FileWriter();
+
+  // Prevent copying.
+  FileWriter(FileWriter const&) = delete;
+  FileWriter& operator=(FileWriter const&) = delete;
+
+  // Opens the file at |path|, encoded in UTF-8, creating it if needed. The
+  // first |keep| bytes are left as they are, for a transfer that resumes;
+  // anything after them is cut off. Space for |size| bytes in total is
+  // reserved where the platform supports it. Writes go through |worker| if
+  // given, which must outlive the writer, and otherwise through a worker of
+  // the writer's own with a pool of |pool_size| bytes. Returns false on
+  // failure.
+  bool Open(const std::string& path, uint64_t size, uint64_t keep = 0,
+            size_t pool_size = kDefaultPoolSize,
+            WriteWorker* worker = nullptr);
+
+  // Queues |length| bytes to be written at |offset|. Returns false if the
+  // pool has no room for them or an earlier write failed.
+  bool Write(uint64_t offset, const uint8_t* data, size_t length);
+
+  // Waits until everything queued is on disk. Returns false if any write
+  // failed.
+  bool Flush();
+
+  // Flushes, trims the file to the end of the furthest write and closes it.
+  // Returns false if a write failed. Safe to call more than once.
+  bool Close();
+
+  // Bytes passed to Write() that have reached the file, in total.
+  uint64_t written() const;
+  // Bytes passed to Write() and not yet on disk.
+  uint64_t queued() const;
+  bool failed() const;
+  bool is_open() const { return is_open_; }
+  // Whether space for the whole file could be reserved.
+  bool preallocated() const { return preallocated_; }
+
+ private:
+  friend class WriteWorker;
+
+  struct Extent {
+    uint64_t offset = 0;
+    std::vector<uint8_t> data;  // capacity kExtentSize
+  };
+
+  // Writes the next queued extent, on the worker's thread. Returns whether
+  // more are queued; if not, the writer is no longer scheduled.
+  bool WriteNext();
+  bool WriteAt(uint64_t offset, const uint8_t* data, size_t length);
+  bool Preallocate(uint64_t size);
+  bool Truncate(uint64_t size);
+  void CloseFile();
+
+#if defined(_WIN32)
+  void* file_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+  bool is_open_ = false;
+  bool preallocated_ = false;
+  uint64_t end_ = 0;  // end of the furthest write, including kept bytes
+
+  WriteWorker* worker_ = nullptr;
+  std::unique_ptr<WriteWorker> own_worker_;  // without a shared one
+  mutable std::mutex mutex_;
+  std::condition_variable work_done_;
+  // Guarded by |mutex_|.
+  std::deque<Extent> queue_;      // full extents, in order of arrival
+  Extent filling_;                // extent Write() appends to
+  bool scheduled_ = false;        // queued with, or being served by, worker_
+  bool writing_ = false;
+  bool failed_ = false;
+  uint64_t submitted_ = 0;
+  uint64_t written_ = 0;
+};
+
+// The thread and extent pool behind one or more FileWriters. A session
+// receiving many files shares one, so it costs one thread and one bounded
+// pool however many files it has. Writers take turns, one extent each.
+//
+// Must outlive the writers opened on it.
+class WriteWorker {
+ public:
+  explicit WriteWorker(size_t pool_size = FileWriter::kDefaultPoolSize);
+  ~WriteWorker();
+
+  // Prevent copying.
+  WriteWorker(WriteWorker const&) = delete;
+  WriteWorker& operator=(WriteWorker const&) = delete;
+
+ private:
+  friend class FileWriter;
+
+  // Claims |count| extents of the pool. Returns false if it has too few.
+  bool Reserve(size_t count);
+  // Storage for a claimed extent, reusing a spare one if there is one.
+  std::vector<uint8_t> TakeStorage();
+  // Returns an extent's storage and its claim on the pool.
+  void Recycle(std::vector<uint8_t> storage);
+  // Gives |writer| a turn; it must not already be scheduled.
+  void Schedule(FileWriter* writer);
+  void Run();
+
+  const size_t max_extents_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  // Guarded by |mutex_|.
+  std::deque<FileWriter*> writers_;  // waiting for a turn
+  std::vector<std::vector<uint8_t>> spare_;
+  size_t extents_in_use_ = 0;  // queued, being written, or filling
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_FILE_WRITER_H_
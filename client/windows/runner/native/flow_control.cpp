@@ -0,0 +1,137 @@
+#include "flow_control.h"
+
+#include <algorithm>
+
+namespace sc {
+
+namespace {
+
+// Window = kWindowGain x bandwidth-delay product. Two BDPs absorb credit
+// batching and jitter while still letting the window double per round trip
+// during start-up.
+constexpr double kWindowGain = 2.0;
+
+}  // namespace
+
+CreditSender::CreditSender() : CreditSender(Options()) {}
+
+CreditSender::CreditSender(const Options& options)
+    : options_(options),
+      window_(std::clamp(options.initial_window, options.min_window,
+                         options.max_window)) {}
+
+uint64_t CreditSender::Available(uint64_t buffered_amount) const {
+  const uint64_t credit = limit_ > sent_ ? limit_ - sent_ : 0;
+  const uint64_t flight = in_flight();
+  const uint64_t window = window_ > flight ? window_ - flight : 0;
+  const uint64_t buffer = options_.max_buffered > buffered_amount
+                              ? options_.max_buffered - buffered_amount
+                              : 0;
+  return std::min({credit, window, buffer});
+}
+
+void CreditSender::OnSent(uint64_t bytes, uint64_t now_us) {
+  if (bytes == 0) {
+    return;
+  }
+  sent_ += bytes;
+  records_.push_back({sent_, now_us});
+}
+
+void CreditSender::OnCredit(uint64_t consumed, uint64_t limit,
+                            uint64_t now_us) {
+  limit_ = std::max(limit_, limit);
+  if (consumed <= consumed_) {
+    return;
+  }
+  consumed_ = std::min(consumed, sent_);
+
+  // RTT from the newest send fully covered by this grant.
+  bool have_sample = false;
+  uint64_t sent_at_us = 0;
+  while (!records_.empty() && records_.front().end <= consumed_) {
+    sent_at_us = records_.front().time_us;
+    have_sample = true;
+    records_.pop_front();
+  }
+  if (have_sample && now_us >= sent_at_us) {
+    UpdateRtt(now_us - sent_at_us, now_us);
+  }
+  UpdateDeliveryRate(now_us);
+  UpdateWindow();
+}
+
+double CreditSender::delivery_rate() const {
+  return *std::max_element(rate_samples_, rate_samples_ + kRateSamples);
+}
+
+void CreditSender::UpdateRtt(uint64_t sample_us, uint64_t now_us) {
+  sample_us = std::max<uint64_t>(sample_us, 1);
+  // RFC 6298 smoothing for the reported RTT.
+  srtt_us_ = srtt_us_ == 0 ? sample_us : (7 * srtt_us_ + sample_us) / 8;
+  if (min_rtt_us_ == 0 || sample_us <= min_rtt_us_ ||
+      now_us - min_rtt_stamp_us_ > kMinRttExpiryUs) {
+    min_rtt_us_ = sample_us;
+    min_rtt_stamp_us_ = now_us;
+  }
+}
+
+void CreditSender::UpdateDeliveryRate(uint64_t now_us) {
+  if (!has_rate_stamp_) {
+    rate_consumed_ = consumed_;
+    rate_stamp_us_ = now_us;
+    has_rate_stamp_ = true;
+    return;
+  }
+  // Measure over at least half a round trip so grants that arrive in a
+  // burst (for example after a retransmission) do not read as a spike.
+  const uint64_t interval = now_us - rate_stamp_us_;
+  if (interval < std::max<uint64_t>(min_rtt_us_ / 2, 1000)) {
+    return;
+  }
+  rate_samples_[next_rate_sample_] =
+      static_cast<double>(consumed_ - rate_consumed_) * 1e6 /
+      static_cast<double>(interval);
+  next_rate_sample_ = (next_rate_sample_ + 1) % kRateSamples;
+  rate_consumed_ = consumed_;
+  rate_stamp_us_ = now_us;
+}
+
+void CreditSender::UpdateWindow() {
+  const double rate = delivery_rate();
+  if (rate <= 0 || min_rtt_us_ == 0) {
+    return;
+  }
+  const double bdp = rate * static_cast<double>(min_rtt_us_) / 1e6;
+  const double target = kWindowGain * bdp;
+  window_ = std::clamp(static_cast<uint64_t>(target), options_.min_window,
+                       options_.max_window);
+}
+
+CreditReceiver::CreditReceiver()
+    : CreditReceiver(kDefaultWindow, kDefaultGrantInterval) {}
+
+CreditReceiver::CreditReceiver(uint64_t window, uint64_t grant_interval)
+    : window_(window), grant_interval_(std::max<uint64_t>(grant_interval, 1)) {}
+
+bool CreditReceiver::OnConsumed(uint64_t bytes) {
+  consumed_ += bytes;
+  return ShouldGrant();
+}
+
+bool CreditReceiver::OnReleased(uint64_t bytes) {
+  released_ += bytes;
+  return ShouldGrant();
+}
+
+bool CreditReceiver::ShouldGrant() {
+  if (consumed_ - granted_consumed_ < grant_interval_ &&
+      released_ - granted_released_ < grant_interval_) {
+    return false;
+  }
+  granted_consumed_ = consumed_;
+  granted_released_ = released_;
+  return true;
+}
+
+}  // namespace sc
@@ -0,0 +1,138 @@
+#ifndef RUNNER_NATIVE_FLOW_CONTROL_H_
+#define RUNNER_NATIVE_FLOW_CONTROL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace sc {
+
+// Sender half of the credit-based sliding window used by file streams.
+//
+// The receiver grants credit as a cumulative byte limit: the sender may have
+// sent at most |limit| bytes of the session in total. Within that limit the
+// sender keeps its own window, sized to twice the measured bandwidth-delay
+// product (highest recent delivery rate times the lowest recent round trip),
+// so long links stay full without queueing far more than the path carries.
+// The window starts at |initial_window| and roughly doubles per round trip
+// until the delivery rate stops growing.
+//
+// Times are caller-supplied microseconds from a monotonic clock, which keeps
+// the class deterministic under the link simulator used by the tests.
+class CreditSender {
+ public:
+  struct Options {
+    uint64_t initial_window = 512 * 1024;
+    uint64_t min_window = 256 * 1024;
+    uint64_t max_window = 16 * 1024 * 1024;
+    // Cap on the data channel's bufferedAmount. libwebrtc closes a channel
+    // whose send queue exceeds 16 MiB, so stay well below that.
+    uint64_t max_buffered = 8 * 1024 * 1024;
+  };
+
+  CreditSender();
+  explicit CreditSender(const Options& options);
+
+  // Number of bytes that may be sent now, given the channel's current
+  // bufferedAmount. Zero means wait for credit or for the buffer to drain.
+  uint64_t Available(uint64_t buffered_amount) const;
+
+  // Records |bytes| handed to the channel at |now_us|.
+  void OnSent(uint64_t bytes, uint64_t now_us);
+
+  // Applies a grant from the receiver: |consumed| bytes of the session have
+  // been processed and up to |limit| bytes may be sent in total. Grants are
+  // cumulative, so a stale or reordered grant is ignored.
+  void OnCredit(uint64_t consumed, uint64_t limit, uint64_t now_us);
+
+  uint64_t window() const { return window_; }
+  uint64_t sent() const { return sent_; }
+  uint64_t consumed() const { return consumed_; }
+  uint64_t limit() const { return limit_; }
+  uint64_t in_flight() const { return sent_ - consumed_; }
+  // Smoothed and minimum round trip between a send and the grant covering
+  // it; zero until the first sample.
+  uint64_t smoothed_rtt_us() const { return srtt_us_; }
+  uint64_t min_rtt_us() const { return min_rtt_us_; }
+  // Highest recent delivery rate in bytes per second; zero until measured.
+  double delivery_rate() const;
+
+ private:
+  static constexpr size_t kRateSamples = 8;
+  // A min RTT sample older than this is replaced by the next sample, so the
+  // window follows routes whose latency goes up.
+  static constexpr uint64_t kMinRttExpiryUs = 10 * 1000 * 1000;
+
+  struct SendRecord {
+    uint64_t end;  // session offset just past the send
+    uint64_t time_us;
+  };
+
+  void UpdateRtt(uint64_t sample_us, uint64_t now_us);
+  void UpdateDeliveryRate(uint64_t now_us);
+  void UpdateWindow();
+
+  Options options_;
+  uint64_t sent_ = 0;
+  uint64_t consumed_ = 0;
+  uint64_t limit_ = 0;
+  uint64_t window_ = 0;
+  std::deque<SendRecord> records_;
+
+  uint64_t srtt_us_ = 0;
+  uint64_t min_rtt_us_ = 0;
+  uint64_t min_rtt_stamp_us_ = 0;
+
+  uint64_t rate_consumed_ = 0;
+  uint64_t rate_stamp_us_ = 0;
+  bool has_rate_stamp_ = false;
+  double rate_samples_[kRateSamples] = {};
+  size_t next_rate_sample_ = 0;
+};
+
+// Receiver half: tracks what has been taken off the channel and what has
+// been released (written out), and decides when to send a fresh grant.
+//
+// A grant reports bytes consumed, which drives the sender's RTT and rate
+// estimates, and a limit of released bytes plus the window, which bounds
+// the receiver's memory. Bytes held back for reassembly or still queued for
+// writing count as consumed but not released. Grants are batched every
+// |grant_interval| bytes of progress to keep control traffic small; the
+// sender's minimum window is larger than the interval, so a stalled sender
+// always gets a grant eventually.
+class CreditReceiver {
+ public:
+  // Receive buffer the sender may fill ahead of release.
+  static constexpr uint64_t kDefaultWindow = 16 * 1024 * 1024;
+  static constexpr uint64_t kDefaultGrantInterval = 128 * 1024;
+
+  CreditReceiver();
+  CreditReceiver(uint64_t window, uint64_t grant_interval);
+
+  // Records |bytes| taken off the channel. Returns true when a grant should
+  // be sent now.
+  bool OnConsumed(uint64_t bytes);
+
+  // Records |bytes| released from the receive buffer. Returns true when a
+  // grant should be sent now.
+  bool OnReleased(uint64_t bytes);
+
+  uint64_t consumed() const { return consumed_; }
+  uint64_t released() const { return released_; }
+  // Cumulative byte limit to advertise in a grant.
+  uint64_t limit() const { return released_ + window_; }
+
+ private:
+  bool ShouldGrant();
+
+  uint64_t window_;
+  uint64_t grant_interval_;
+  uint64_t consumed_ = 0;
+  uint64_t released_ = 0;
+  uint64_t granted_consumed_ = 0;
+  uint64_t granted_released_ = 0;
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_FLOW_CONTROL_H_
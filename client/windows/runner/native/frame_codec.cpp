@@ -0,0 +1,111 @@
+#include "frame_codec.h"
+
+#include <cstring>
+
+namespace sc {
+
+namespace {
+
+void StoreU16(uint8_t* out, uint16_t value) {
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void StoreU32(uint8_t* out, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+void StoreU64(uint8_t* out, uint64_t value) {
+  for (int i = 0; i < 8; i++) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+uint16_t LoadU16(const uint8_t* in) {
+  return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t LoadU32(const uint8_t* in) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; i--) {
+    value = (value << 8) | in[i];
+  }
+  return value;
+}
+
+uint64_t LoadU64(const uint8_t* in) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; i--) {
+    value = (value << 8) | in[i];
+  }
+  return value;
+}
+
+}  // namespace
+
+void WriteFrameHeader(const FrameHeader& header, uint8_t* out) {
+  StoreU16(out, kFrameMagic);
+  out[2] = kFrameVersion;
+  out[3] = header.flags;
+  StoreU32(out + 4, header.file_index);
+  StoreU64(out + 8, header.session_id);
+  StoreU64(out + 16, header.offset);
+  StoreU32(out + 24, header.length);
+  StoreU32(out + 28,
+           (header.flags & kFrameFlagCompressed) != 0 ? header.raw_length : 0);
+}
+
+bool ReadFrameHeader(const uint8_t* data, size_t size, FrameHeader* header) {
+  if (data == nullptr || size < kFrameHeaderSize) {
+    return false;
+  }
+  if (LoadU16(data) != kFrameMagic || data[2] != kFrameVersion) {
+    return false;
+  }
+  const uint32_t raw_length = LoadU32(data + 28);
+  if (((data[3] & kFrameFlagCompressed) != 0) != (raw_length != 0) ||
+      raw_length > kMaxFrameRawLength) {
+    return false;
+  }
+  header->flags = data[3];
+  header->file_index = LoadU32(data + 4);
+  header->session_id = LoadU64(data + 8);
+  header->offset = LoadU64(data + 16);
+  header->length = LoadU32(data + 24);
+  header->raw_length = raw_length;
+  return true;
+}
+
+size_t EncodeFrame(const FrameHeader& header, const uint8_t* payload,
+                   uint8_t* out, size_t capacity) {
+  const size_t total = kFrameHeaderSize + header.length;
+  if (out == nullptr || capacity < total) {
+    return 0;
+  }
+  if (header.length > 0 && payload != out + kFrameHeaderSize) {
+    if (payload == nullptr) {
+      return 0;
+    }
+    std::memmove(out + kFrameHeaderSize, payload, header.length);
+  }
+  WriteFrameHeader(header, out);
+  return total;
+}
+
+bool DecodeFrame(const uint8_t* data, size_t size, FrameHeader* header,
+                 const uint8_t** payload) {
+  FrameHeader parsed;
+  if (!ReadFrameHeader(data, size, &parsed)) {
+    return false;
+  }
+  if (size - kFrameHeaderSize != parsed.length) {
+    return false;
+  }
+  *header = parsed;
+  *payload = data + kFrameHeaderSize;
+  return true;
+}
+
+}  // namespace sc
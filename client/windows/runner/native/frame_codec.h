@@ -0,0 +1,73 @@
+#ifndef RUNNER_NATIVE_FRAME_CODEC_H_
+#define RUNNER_NATIVE_FRAME_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sc {
+
+// Binary frame carrying one slice of a proto v2 file stream. It replaces the
+// base64-in-JSON 'file_chunk' envelope, so the payload travels as raw bytes.
+//
+// Wire layout (all integers little-endian):
+//    0  u16  magic 'SC' (kFrameMagic)
+//    2  u8   version (kFrameVersion)
+//    3  u8   flags (FrameFlags)
+//    4  u32  file index within the session
+//    8  u64  session id
+//   16  u64  byte offset of the payload within the file
+//   24  u32  payload length
+//   28  u32  uncompressed payload length if kFrameFlagCompressed is set,
+//            otherwise zero
+//   32       payload
+constexpr uint16_t kFrameMagic = 0x4353;
+constexpr uint8_t kFrameVersion = 1;
+constexpr size_t kFrameHeaderSize = 32;
+// Largest uncompressed payload a frame may claim. No data channel message is
+// larger, so anything above it is malformed rather than a buffer to allocate.
+constexpr uint32_t kMaxFrameRawLength = 256 * 1024;
+
+enum FrameFlags : uint8_t {
+  // The payload ends the file.
+  kFrameFlagLast = 0x01,
+  // The payload is one LZ4 block (see compression.h). Only sent to peers
+  // that listed the codec when the session was set up.
+  kFrameFlagCompressed = 0x02,
+};
+
+struct FrameHeader {
+  uint8_t flags = 0;
+  uint32_t file_index = 0;
+  uint64_t session_id = 0;
+  uint64_t offset = 0;
+  uint32_t length = 0;
+  // Payload length after decompression; zero unless compressed.
+  uint32_t raw_length = 0;
+};
+
+// Writes the wire header for |header| to |out|, which must have room for
+// kFrameHeaderSize bytes.
+void WriteFrameHeader(const FrameHeader& header, uint8_t* out);
+
+// Parses the wire header at the start of |data|. Returns false if |size| is
+// too small, the magic or version is wrong, or the raw length field does not
+// agree with the compressed flag or exceeds kMaxFrameRawLength. The payload
+// length is not checked against |size|; see DecodeFrame for that.
+bool ReadFrameHeader(const uint8_t* data, size_t size, FrameHeader* header);
+
+// Writes a complete frame (header followed by |header.length| bytes of
+// |payload|) to |out|. |payload| may already sit at out + kFrameHeaderSize, in
+// which case it is not copied. Returns the frame size, or 0 if |capacity| is
+// too small.
+size_t EncodeFrame(const FrameHeader& header, const uint8_t* payload,
+                   uint8_t* out, size_t capacity);
+
+// Parses a complete frame. On success fills |header| and points |payload| at
+// the payload inside |data|. Returns false if the frame is malformed or its
+// payload length does not match |size|.
+bool DecodeFrame(const uint8_t* data, size_t size, FrameHeader* header,
+                 const uint8_t** payload);
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_FRAME_CODEC_H_
@@ -0,0 +1,20 @@
+#ifndef RUNNER_NATIVE_RING_CAPACITY_H_
+#define RUNNER_NATIVE_RING_CAPACITY_H_
+
+#include <cstddef>
+
+namespace sc {
+
+// Rounds a ring's capacity up to a power of two, at least 2, so positions
+// map to slots with a mask.
+inline size_t RoundUpCapacity(size_t capacity) {
+  size_t rounded = 2;
+  while (rounded < capacity) {
+    rounded <<= 1;
+  }
+  return rounded;
+}
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_RING_CAPACITY_H_
@@ -0,0 +1,266 @@
+#include "ring_logger.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include "ring_capacity.h"
+
+namespace sc {
+
+namespace {
+
+constexpr char kLevelLetters[] = {'D', 'I', 'W', 'E'};
+
+int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+RingLogger::RingLogger() {}
+
+RingLogger::~RingLogger() { Close(); }
+
+bool RingLogger::Open(const std::string& path, uint64_t max_file_size,
+                      uint32_t backups, size_t capacity,
+                      std::chrono::milliseconds flush_interval) {
+  Close();
+  const std::filesystem::path file_path = std::filesystem::u8path(path);
+  file_.open(file_path, std::ios::binary | std::ios::app);
+  if (!file_) {
+    return false;
+  }
+  std::error_code error;
+  const uintmax_t size = std::filesystem::file_size(file_path, error);
+  file_size_ = error ? 0 : static_cast<uint64_t>(size);
+  path_ = path;
+  max_file_size_ = max_file_size;
+  backups_ = backups;
+  flush_interval_ = flush_interval;
+  const size_t slot_count = RoundUpCapacity(capacity);
+  slots_.reset(new Slot[slot_count]);
+  for (size_t i = 0; i < slot_count; i++) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  mask_ = slot_count - 1;
+  enqueue_.store(0, std::memory_order_relaxed);
+  dequeue_.store(0, std::memory_order_relaxed);
+  consumed_.store(0, std::memory_order_relaxed);
+  dropped_.store(0, std::memory_order_relaxed);
+  dropped_reported_ = 0;
+  time_second_ = -1;
+  stopping_ = false;
+  flush_requested_ = false;
+  is_open_ = true;
+  worker_ = std::thread(&RingLogger::Run, this);
+  return true;
+}
+
+bool RingLogger::Write(Level level, const char* message, size_t length) {
+  if (!enabled(level) || !is_open_) {
+    return false;
+  }
+  // Claims a slot as in Vyukov's bounded MPMC queue: a slot is free for
+  // position |pos| once its sequence equals |pos|.
+  uint64_t pos = enqueue_.load(std::memory_order_relaxed);
+  Slot* slot;
+  for (;;) {
+    slot = &slots_[pos & mask_];
+    const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const int64_t lag =
+        static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+    if (lag == 0) {
+      if (enqueue_.compare_exchange_weak(pos, pos + 1,
+                                         std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (lag < 0) {
+      // The worker has not freed this slot yet: the ring is full.
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = enqueue_.load(std::memory_order_relaxed);
+    }
+  }
+  slot->time_us = NowMicros();
+  slot->level = level;
+  if (length > kMaxMessageSize) {
+    // Cuts before a UTF-8 continuation byte, not through a code point.
+    length = kMaxMessageSize;
+    while (length > 0 &&
+           (static_cast<unsigned char>(message[length]) & 0xC0) == 0x80) {
+      length--;
+    }
+  }
+  slot->length = static_cast<uint32_t>(length);
+  std::memcpy(slot->message, message, slot->length);
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  // Wakes the worker early rather than let a burst fill the ring.
+  if (pos - dequeue_.load(std::memory_order_relaxed) == (mask_ + 1) / 2) {
+    wake_.notify_one();
+  }
+  return true;
+}
+
+void RingLogger::Flush() {
+  if (!is_open_) {
+    return;
+  }
+  const uint64_t target = enqueue_.load(std::memory_order_acquire);
+  while (consumed_.load(std::memory_order_acquire) < target) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      flush_requested_ = true;
+    }
+    wake_.notify_one();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void RingLogger::Close() {
+  if (!is_open_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  worker_.join();
+  file_.close();
+  is_open_ = false;
+  slots_.reset();
+}
+
+uint64_t RingLogger::dropped() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+void RingLogger::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    // Timed waits are inline in libstdc++; see condition_wait.h.
+    wake_.wait_for(lock, flush_interval_,
+                   [this] { return stopping_ || flush_requested_; });
+    const bool stopping = stopping_;
+    flush_requested_ = false;
+    lock.unlock();
+    Drain();
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != dropped_reported_) {
+      AppendTime(NowMicros());
+      batch_ += " W " + std::to_string(dropped - dropped_reported_) +
+                " log records dropped\n";
+      dropped_reported_ = dropped;
+    }
+    WriteBatch();
+    consumed_.store(dequeue_.load(std::memory_order_relaxed),
+                    std::memory_order_release);
+    lock.lock();
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+size_t RingLogger::Drain() {
+  uint64_t pos = dequeue_.load(std::memory_order_relaxed);
+  size_t count = 0;
+  for (;; pos++, count++) {
+    Slot& slot = slots_[pos & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+      break;
+    }
+    AppendTime(slot.time_us);
+    batch_ += ' ';
+    batch_ += kLevelLetters[slot.level];
+    batch_ += ' ';
+    batch_.append(slot.message, slot.length);
+    batch_ += '\n';
+    // Free for the producer that wraps around to it.
+    slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+  }
+  dequeue_.store(pos, std::memory_order_relaxed);
+  return count;
+}
+
+void RingLogger::AppendTime(int64_t time_us) {
+  int64_t second = time_us / 1000000;
+  int64_t micros = time_us % 1000000;
+  if (micros < 0) {
+    second--;
+    micros += 1000000;
+  }
+  if (second != time_second_) {
+    // Civil date from days since the epoch, after Howard Hinnant's
+    // civil_from_days().
+    int64_t days = second / 86400;
+    int64_t of_day = second % 86400;
+    if (of_day < 0) {
+      days--;
+      of_day += 86400;
+    }
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const int64_t day_of_era = days - era * 146097;
+    const int64_t year_of_era =
+        (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+         day_of_era / 146096) /
+        365;
+    const int64_t day_of_year =
+        day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const int64_t month_index = (5 * day_of_year + 2) / 153;
+    const int64_t day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    const int64_t month = month_index < 10 ? month_index + 3 : month_index - 9;
+    const int64_t year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+    char prefix[40];
+    std::snprintf(prefix, sizeof(prefix), "%04lld-%02d-%02dT%02d:%02d:%02d",
+                  static_cast<long long>(year), static_cast<int>(month),
+                  static_cast<int>(day), static_cast<int>(of_day / 3600),
+                  static_cast<int>(of_day / 60 % 60),
+                  static_cast<int>(of_day % 60));
+    time_prefix_ = prefix;
+    time_second_ = second;
+  }
+  char millis[8];
+  std::snprintf(millis, sizeof(millis), ".%03dZ",
+                static_cast<int>(micros / 1000));
+  batch_ += time_prefix_;
+  batch_ += millis;
+}
+
+void RingLogger::WriteBatch() {
+  if (batch_.empty()) {
+    return;
+  }
+  file_.write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+  file_.flush();
+  file_size_ += batch_.size();
+  batch_.clear();
+  if (max_file_size_ != 0 && file_size_ >= max_file_size_) {
+    Rotate();
+  }
+}
+
+void RingLogger::Rotate() {
+  namespace fs = std::filesystem;
+  file_.close();
+  std::error_code error;
+  for (uint32_t i = backups_; i >= 1; i--) {
+    const std::string from =
+        i == 1 ? path_ : path_ + "." + std::to_string(i - 1);
+    fs::rename(fs::u8path(from), fs::u8path(path_ + "." + std::to_string(i)),
+               error);
+  }
+  // With no backups kept, the file just starts over.
+  file_.clear();
+  file_.open(fs::u8path(path_), std::ios::binary | std::ios::trunc);
+  file_size_ = 0;
+}
+
+}  // namespace sc
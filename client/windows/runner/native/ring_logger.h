@@ -0,0 +1,139 @@
+#ifndef RUNNER_NATIVE_RING_LOGGER_H_
+#define RUNNER_NATIVE_RING_LOGGER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace sc {
+
+// Application log written to a rotating file on a background thread.
+//
+// Write() is lock-free and safe from any number of threads: it claims a
+// fixed-size slot in a bounded ring, copies the message and a timestamp
+// into it and returns. Nothing is formatted or written on the caller's
+// thread. A record below the level is refused after one relaxed load, and
+// one that finds the ring full is counted and dropped rather than waited
+// for; the file then says how many were lost.
+//
+// A worker thread wakes every flush interval, or sooner when the ring is
+// half full or Flush() is called, and writes everything queued as one
+// batch of lines:
+//
+//   2024-01-01T00:00:00.000Z I message
+//
+// When the file reaches its size limit it is renamed to "<path>.1", older
+// files move up one ("<path>.1" to "<path>.2" and so on) and the oldest
+// beyond the kept count is replaced.
+class RingLogger {
+ public:
+  enum Level : int32_t {
+    kDebug = 0,
+    kInfo = 1,
+    kWarn = 2,
+    kError = 3,
+  };
+
+  // Longest message kept; longer ones are cut off at a UTF-8 boundary.
+  static constexpr size_t kMaxMessageSize = 1000;
+  static constexpr size_t kDefaultCapacity = 4096;
+  static constexpr uint64_t kDefaultMaxFileSize = 4 * 1024 * 1024;
+  static constexpr uint32_t kDefaultBackups = 3;
+  static constexpr std::chrono::milliseconds kDefaultFlushInterval{100};
+
+  RingLogger();
+  ~RingLogger();
+
+  // Prevent copying.
+  RingLogger(RingLogger const&) = delete;
+  RingLogger& operator=(RingLogger const&) = delete;
+
+  // Appends to the file at |path|, encoded in UTF-8, creating it if needed.
+  // |capacity| records are held while the worker is busy; it is rounded up
+  // to a power of two. Returns false on failure.
+  bool Open(const std::string& path,
+            uint64_t max_file_size = kDefaultMaxFileSize,
+            uint32_t backups = kDefaultBackups,
+            size_t capacity = kDefaultCapacity,
+            std::chrono::milliseconds flush_interval = kDefaultFlushInterval);
+
+  // Queues |length| bytes of |message| at |level|. Returns false if the
+  // level is disabled, the logger is closed or the ring is full. May be
+  // called from any thread, but not while Open() or Close() runs.
+  bool Write(Level level, const char* message, size_t length);
+
+  bool enabled(Level level) const {
+    return level >= level_.load(std::memory_order_relaxed);
+  }
+  void set_level(Level level) {
+    level_.store(level, std::memory_order_relaxed);
+  }
+
+  // Waits until everything queued before the call is in the file.
+  void Flush();
+
+  // Flushes and closes the file. Safe to call more than once.
+  void Close();
+
+  // Records dropped because the ring was full, in total.
+  uint64_t dropped() const;
+  bool is_open() const { return is_open_; }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> sequence{0};
+    int64_t time_us = 0;
+    Level level = kInfo;
+    uint32_t length = 0;
+    char message[kMaxMessageSize];
+  };
+
+  void Run();
+  // Formats every published record into |batch_|. Returns how many.
+  size_t Drain();
+  void AppendTime(int64_t time_us);
+  void WriteBatch();
+  void Rotate();
+
+  std::string path_;
+  uint64_t max_file_size_ = 0;
+  uint32_t backups_ = 0;
+  std::chrono::milliseconds flush_interval_{0};
+  bool is_open_ = false;
+
+  std::atomic<int32_t> level_{kDebug};
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_ = 0;
+  // Producers claim slots at |enqueue_|; the worker alone advances
+  // |dequeue_| and then |consumed_| once the batch is written.
+  alignas(64) std::atomic<uint64_t> enqueue_{0};
+  alignas(64) std::atomic<uint64_t> dequeue_{0};
+  std::atomic<uint64_t> consumed_{0};
+  std::atomic<uint64_t> dropped_{0};
+
+  // Worker state.
+  std::ofstream file_;
+  uint64_t file_size_ = 0;
+  uint64_t dropped_reported_ = 0;
+  std::string batch_;
+  int64_t time_second_ = -1;  // second |time_prefix_| was formatted for
+  std::string time_prefix_;   // "YYYY-MM-DDTHH:MM:SS"
+
+  std::thread worker_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  // Guarded by |mutex_|.
+  bool stopping_ = false;
+  bool flush_requested_ = false;
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_RING_LOGGER_H_
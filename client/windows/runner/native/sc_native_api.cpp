@@ -0,0 +1,593 @@
+#include "sc_native_api.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "chunk_source.h"
+#include "chunk_store.h"
+#include "compression.h"
+#include "content_chunker.h"
+#include "file_writer.h"
+#include "flow_control.h"
+#include "frame_codec.h"
+#include "ring_logger.h"
+#include "send_scheduler.h"
+#include "sha256.h"
+#include "span_tracer.h"
+#include "stripe.h"
+
+struct ScChunkSource {
+  sc::ChunkSource source;
+};
+
+struct ScSha256 {
+  sc::Sha256 hasher;
+};
+
+struct ScCreditSender {
+  sc::CreditSender sender;
+};
+
+struct ScCreditReceiver {
+  explicit ScCreditReceiver(uint64_t window, uint64_t grant_interval)
+      : receiver(window, grant_interval) {}
+  sc::CreditReceiver receiver;
+};
+
+struct ScSendScheduler {
+  ScSendScheduler(std::vector<uint64_t> file_sizes, uint32_t chunk_size,
+                  size_t max_active)
+      : scheduler(std::move(file_sizes), chunk_size, max_active) {}
+  sc::SendScheduler scheduler;
+};
+
+struct ScStripeScheduler {
+  explicit ScStripeScheduler(size_t channel_count) : scheduler(channel_count) {}
+  sc::StripeScheduler scheduler;
+};
+
+struct ScReassemblyBuffer {
+  sc::ReassemblyBuffer buffer;
+};
+
+struct ScContentChunker {
+  ScContentChunker(uint32_t min_size, uint32_t average_size, uint32_t max_size)
+      : chunker(min_size, average_size, max_size) {}
+  sc::ContentChunker chunker;
+};
+
+struct ScChunkStore {
+  sc::ChunkStore store;
+  std::vector<uint8_t> buffer;
+};
+
+struct ScFileWriter {
+  sc::FileWriter writer;
+};
+
+struct ScWriteWorker {
+  explicit ScWriteWorker(size_t pool_size) : worker(pool_size) {}
+  sc::WriteWorker worker;
+};
+
+struct ScLogger {
+  sc::RingLogger logger;
+};
+
+struct ScTracer {
+  explicit ScTracer(size_t capacity) : tracer(capacity) {}
+  sc::SpanTracer tracer;
+};
+
+namespace {
+
+sc::RingLogger::Level ToLogLevel(int32_t level) {
+  return static_cast<sc::RingLogger::Level>(
+      std::clamp<int32_t>(level, SC_LOG_DEBUG, SC_LOG_ERROR));
+}
+
+sc::FrameHeader ToFrameHeader(const ScFrameHeader* header) {
+  sc::FrameHeader result;
+  result.flags = static_cast<uint8_t>(header->flags);
+  result.file_index = header->file_index;
+  result.session_id = header->session_id;
+  result.offset = header->offset;
+  result.length = header->length;
+  result.raw_length = header->raw_length;
+  return result;
+}
+
+}  // namespace
+
+uint32_t sc_native_abi_version(void) { return SC_NATIVE_ABI_VERSION; }
+
+void sc_frame_write_header(const ScFrameHeader* header, uint8_t* out) {
+  sc::WriteFrameHeader(ToFrameHeader(header), out);
+}
+
+int64_t sc_frame_encode(const ScFrameHeader* header, const uint8_t* payload,
+                        uint8_t* out, uint64_t capacity) {
+  const size_t written = sc::EncodeFrame(ToFrameHeader(header), payload, out,
+                                         static_cast<size_t>(capacity));
+  return written == 0 ? -1 : static_cast<int64_t>(written);
+}
+
+int32_t sc_frame_read_header(const uint8_t* data, uint64_t frame_size,
+                             ScFrameHeader* header) {
+  sc::FrameHeader parsed;
+  if (frame_size < sc::kFrameHeaderSize ||
+      !sc::ReadFrameHeader(data, sc::kFrameHeaderSize, &parsed) ||
+      frame_size - sc::kFrameHeaderSize != parsed.length) {
+    return -1;
+  }
+  header->session_id = parsed.session_id;
+  header->offset = parsed.offset;
+  header->file_index = parsed.file_index;
+  header->length = parsed.length;
+  header->flags = parsed.flags;
+  header->raw_length = parsed.raw_length;
+  return static_cast<int32_t>(sc::kFrameHeaderSize);
+}
+
+ScChunkSource* sc_chunk_source_open(const char* path_utf8, uint32_t flags) {
+  if (path_utf8 == nullptr) {
+    return nullptr;
+  }
+  ScChunkSource* handle = new ScChunkSource();
+  const bool allow_mmap = (flags & SC_CHUNK_SOURCE_NO_MMAP) == 0;
+  if (!handle->source.Open(path_utf8, allow_mmap)) {
+    delete handle;
+    return nullptr;
+  }
+  return handle;
+}
+
+uint64_t sc_chunk_source_size(const ScChunkSource* source) {
+  return source == nullptr ? 0 : source->source.size();
+}
+
+const uint8_t* sc_chunk_source_view(ScChunkSource* source, uint64_t offset,
+                                    uint32_t length, uint32_t* out_length) {
+  size_t viewed = 0;
+  const uint8_t* data =
+      source == nullptr ? nullptr
+                        : source->source.View(offset, length, &viewed);
+  if (out_length != nullptr) {
+    *out_length = static_cast<uint32_t>(viewed);
+  }
+  return data;
+}
+
+int32_t sc_chunk_source_digest(ScChunkSource* source, uint8_t* digest) {
+  if (source == nullptr || digest == nullptr) {
+    return -1;
+  }
+  return source->source.Digest(digest) ? 0 : -1;
+}
+
+void sc_chunk_source_close(ScChunkSource* source) { delete source; }
+
+ScSha256* sc_sha256_create(void) { return new ScSha256(); }
+
+void sc_sha256_update(ScSha256* hasher, const uint8_t* data,
+                      uint64_t length) {
+  hasher->hasher.Update(data, static_cast<size_t>(length));
+}
+
+void sc_sha256_finish(ScSha256* hasher, uint8_t* digest) {
+  hasher->hasher.Finish(digest);
+}
+
+void sc_sha256_destroy(ScSha256* hasher) { delete hasher; }
+
+int32_t sc_sha256_is_accelerated(void) {
+  return sc::Sha256::IsAccelerated() ? 1 : 0;
+}
+
+ScCreditSender* sc_credit_sender_create(void) { return new ScCreditSender(); }
+
+uint64_t sc_credit_sender_available(ScCreditSender* sender,
+                                    uint64_t buffered_amount) {
+  return sender->sender.Available(buffered_amount);
+}
+
+void sc_credit_sender_on_sent(ScCreditSender* sender, uint64_t bytes,
+                              uint64_t now_us) {
+  sender->sender.OnSent(bytes, now_us);
+}
+
+void sc_credit_sender_on_credit(ScCreditSender* sender, uint64_t consumed,
+                                uint64_t limit, uint64_t now_us) {
+  sender->sender.OnCredit(consumed, limit, now_us);
+}
+
+uint64_t sc_credit_sender_window(ScCreditSender* sender) {
+  return sender->sender.window();
+}
+
+uint64_t sc_credit_sender_rtt_us(ScCreditSender* sender) {
+  return sender->sender.smoothed_rtt_us();
+}
+
+void sc_credit_sender_destroy(ScCreditSender* sender) { delete sender; }
+
+ScCreditReceiver* sc_credit_receiver_create(uint64_t window,
+                                            uint64_t grant_interval) {
+  return new ScCreditReceiver(
+      window != 0 ? window : sc::CreditReceiver::kDefaultWindow,
+      grant_interval != 0 ? grant_interval
+                          : sc::CreditReceiver::kDefaultGrantInterval);
+}
+
+int32_t sc_credit_receiver_on_consumed(ScCreditReceiver* receiver,
+                                       uint64_t bytes) {
+  return receiver->receiver.OnConsumed(bytes) ? 1 : 0;
+}
+
+int32_t sc_credit_receiver_on_released(ScCreditReceiver* receiver,
+                                       uint64_t bytes) {
+  return receiver->receiver.OnReleased(bytes) ? 1 : 0;
+}
+
+uint64_t sc_credit_receiver_consumed(ScCreditReceiver* receiver) {
+  return receiver->receiver.consumed();
+}
+
+uint64_t sc_credit_receiver_limit(ScCreditReceiver* receiver) {
+  return receiver->receiver.limit();
+}
+
+void sc_credit_receiver_destroy(ScCreditReceiver* receiver) {
+  delete receiver;
+}
+
+ScSendScheduler* sc_send_scheduler_create(const uint64_t* file_sizes,
+                                          uint32_t file_count,
+                                          uint32_t chunk_size,
+                                          uint32_t max_active) {
+  if (file_sizes == nullptr && file_count != 0) {
+    return nullptr;
+  }
+  std::vector<uint64_t> sizes(file_sizes, file_sizes + file_count);
+  return new ScSendScheduler(
+      std::move(sizes), chunk_size,
+      max_active != 0 ? max_active
+                      : sc::SendScheduler::kDefaultMaxActiveFiles);
+}
+
+int32_t sc_send_scheduler_next(ScSendScheduler* scheduler,
+                               ScScheduledChunk* chunk) {
+  sc::SendScheduler::Chunk next;
+  if (!scheduler->scheduler.Next(&next)) {
+    return 0;
+  }
+  chunk->offset = next.offset;
+  chunk->file_index = next.file_index;
+  chunk->length = next.length;
+  chunk->flags = (next.first ? SC_SCHEDULED_CHUNK_FIRST : 0) |
+                 (next.last ? SC_SCHEDULED_CHUNK_LAST : 0);
+  chunk->reserved = 0;
+  return 1;
+}
+
+void sc_send_scheduler_skip(ScSendScheduler* scheduler, uint32_t file_index,
+                            uint64_t offset, uint64_t length) {
+  scheduler->scheduler.Skip(file_index, offset, length);
+}
+
+void sc_send_scheduler_destroy(ScSendScheduler* scheduler) {
+  delete scheduler;
+}
+
+ScStripeScheduler* sc_stripe_scheduler_create(uint32_t channel_count) {
+  return new ScStripeScheduler(channel_count);
+}
+
+uint32_t sc_stripe_scheduler_pick(ScStripeScheduler* scheduler) {
+  return static_cast<uint32_t>(scheduler->scheduler.Pick());
+}
+
+void sc_stripe_scheduler_on_sent(ScStripeScheduler* scheduler,
+                                 uint32_t channel, uint64_t bytes) {
+  scheduler->scheduler.OnSent(channel, bytes);
+}
+
+void sc_stripe_scheduler_on_consumed(ScStripeScheduler* scheduler,
+                                     uint32_t channel, uint64_t consumed) {
+  scheduler->scheduler.OnConsumed(channel, consumed);
+}
+
+void sc_stripe_scheduler_destroy(ScStripeScheduler* scheduler) {
+  delete scheduler;
+}
+
+ScReassemblyBuffer* sc_reassembly_create(void) {
+  return new ScReassemblyBuffer();
+}
+
+int32_t sc_reassembly_advance(ScReassemblyBuffer* buffer, uint64_t offset,
+                              uint32_t length) {
+  return buffer->buffer.Advance(offset, length) ? 1 : 0;
+}
+
+int32_t sc_reassembly_insert(ScReassemblyBuffer* buffer, uint64_t offset,
+                             const uint8_t* data, uint32_t length) {
+  if (data == nullptr && length != 0) {
+    return -1;
+  }
+  return buffer->buffer.Insert(offset, data, length) ? 0 : -1;
+}
+
+const uint8_t* sc_reassembly_front(ScReassemblyBuffer* buffer,
+                                   uint32_t* out_length) {
+  size_t length = 0;
+  const uint8_t* front = buffer->buffer.Front(&length);
+  *out_length = static_cast<uint32_t>(length);
+  return front;
+}
+
+void sc_reassembly_pop_front(ScReassemblyBuffer* buffer) {
+  buffer->buffer.PopFront();
+}
+
+uint64_t sc_reassembly_next_offset(ScReassemblyBuffer* buffer) {
+  return buffer->buffer.next_offset();
+}
+
+uint64_t sc_reassembly_held_bytes(ScReassemblyBuffer* buffer) {
+  return buffer->buffer.held_bytes();
+}
+
+void sc_reassembly_destroy(ScReassemblyBuffer* buffer) { delete buffer; }
+
+ScContentChunker* sc_content_chunker_create(uint32_t min_size,
+                                            uint32_t average_size,
+                                            uint32_t max_size) {
+  return new ScContentChunker(
+      min_size != 0 ? min_size : sc::ContentChunker::kDefaultMinSize,
+      average_size != 0 ? average_size
+                        : sc::ContentChunker::kDefaultAverageSize,
+      max_size != 0 ? max_size : sc::ContentChunker::kDefaultMaxSize);
+}
+
+int32_t sc_content_chunker_next(ScContentChunker* chunker,
+                                ScChunkSource* source, uint64_t offset,
+                                uint32_t* out_length, uint8_t* digest) {
+  if (source == nullptr || out_length == nullptr || digest == nullptr) {
+    return -1;
+  }
+  if (offset >= source->source.size()) {
+    return 0;
+  }
+  return chunker->chunker.Next(&source->source, offset, out_length, digest)
+             ? 1
+             : -1;
+}
+
+void sc_content_chunker_destroy(ScContentChunker* chunker) { delete chunker; }
+
+ScChunkStore* sc_chunk_store_open(const char* root_utf8, uint64_t capacity) {
+  if (root_utf8 == nullptr) {
+    return nullptr;
+  }
+  ScChunkStore* handle = new ScChunkStore();
+  if (!handle->store.Open(root_utf8, capacity != 0
+                                         ? capacity
+                                         : sc::ChunkStore::kDefaultCapacity)) {
+    delete handle;
+    return nullptr;
+  }
+  return handle;
+}
+
+int32_t sc_chunk_store_contains(ScChunkStore* store, const uint8_t* digest) {
+  return digest != nullptr && store->store.Contains(digest) ? 1 : 0;
+}
+
+int32_t sc_chunk_store_pin(ScChunkStore* store, const uint8_t* digest) {
+  return digest != nullptr && store->store.Pin(digest) ? 1 : 0;
+}
+
+void sc_chunk_store_unpin(ScChunkStore* store, const uint8_t* digest) {
+  if (digest != nullptr) {
+    store->store.Unpin(digest);
+  }
+}
+
+int32_t sc_chunk_store_put(ScChunkStore* store, const uint8_t* digest,
+                           const uint8_t* data, uint64_t length) {
+  if (digest == nullptr || (data == nullptr && length != 0)) {
+    return -1;
+  }
+  return store->store.Put(digest, data, static_cast<size_t>(length)) ? 0 : -1;
+}
+
+int64_t sc_chunk_store_get(ScChunkStore* store, const uint8_t* digest,
+                           uint8_t* buffer, uint64_t capacity) {
+  if (digest == nullptr || !store->store.Get(digest, &store->buffer) ||
+      store->buffer.size() > capacity ||
+      (buffer == nullptr && !store->buffer.empty())) {
+    return -1;
+  }
+  std::copy(store->buffer.begin(), store->buffer.end(), buffer);
+  return static_cast<int64_t>(store->buffer.size());
+}
+
+void sc_chunk_store_trim(ScChunkStore* store) { store->store.Trim(); }
+
+void sc_chunk_store_close(ScChunkStore* store) { delete store; }
+
+uint64_t sc_lz4_compress_bound(uint64_t length) {
+  return sc::Lz4CompressBound(static_cast<size_t>(length));
+}
+
+uint64_t sc_lz4_compress(const uint8_t* data, uint64_t length, uint8_t* out,
+                         uint64_t capacity, int32_t acceleration) {
+  return sc::Lz4Compress(data, static_cast<size_t>(length), out,
+                         static_cast<size_t>(capacity), acceleration);
+}
+
+uint64_t sc_compress_chunk(const uint8_t* data, uint64_t length, uint8_t* out,
+                           uint64_t capacity, int32_t acceleration) {
+  if (data == nullptr || out == nullptr) {
+    return 0;
+  }
+  return sc::CompressChunk(data, static_cast<size_t>(length), out,
+                           static_cast<size_t>(capacity), acceleration);
+}
+
+int32_t sc_lz4_decompress(const uint8_t* data, uint64_t length, uint8_t* out,
+                          uint64_t raw_length) {
+  return sc::Lz4Decompress(data, static_cast<size_t>(length), out,
+                           static_cast<size_t>(raw_length))
+             ? 0
+             : -1;
+}
+
+double sc_estimate_entropy(const uint8_t* data, uint64_t length) {
+  return sc::EstimateEntropy(data, static_cast<size_t>(length));
+}
+
+ScFileWriter* sc_file_writer_open(const char* path_utf8, uint64_t size,
+                                  uint64_t keep, uint64_t pool_size) {
+  if (path_utf8 == nullptr) {
+    return nullptr;
+  }
+  ScFileWriter* handle = new ScFileWriter();
+  if (!handle->writer.Open(path_utf8, size, keep,
+                           pool_size != 0
+                               ? static_cast<size_t>(pool_size)
+                               : sc::FileWriter::kDefaultPoolSize)) {
+    delete handle;
+    return nullptr;
+  }
+  return handle;
+}
+
+ScWriteWorker* sc_write_worker_create(uint64_t pool_size) {
+  return new ScWriteWorker(pool_size != 0 ? static_cast<size_t>(pool_size)
+                                          : sc::FileWriter::kDefaultPoolSize);
+}
+
+void sc_write_worker_destroy(ScWriteWorker* worker) { delete worker; }
+
+ScFileWriter* sc_file_writer_open_on(ScWriteWorker* worker,
+                                     const char* path_utf8, uint64_t size,
+                                     uint64_t keep) {
+  if (worker == nullptr || path_utf8 == nullptr) {
+    return nullptr;
+  }
+  ScFileWriter* handle = new ScFileWriter();
+  if (!handle->writer.Open(path_utf8, size, keep,
+                           sc::FileWriter::kDefaultPoolSize,
+                           &worker->worker)) {
+    delete handle;
+    return nullptr;
+  }
+  return handle;
+}
+
+int32_t sc_file_writer_write(ScFileWriter* writer, uint64_t offset,
+                             const uint8_t* data, uint32_t length) {
+  return writer != nullptr && writer->writer.Write(offset, data, length) ? 0
+                                                                         : -1;
+}
+
+uint64_t sc_file_writer_written(const ScFileWriter* writer) {
+  return writer == nullptr ? 0 : writer->writer.written();
+}
+
+int32_t sc_file_writer_failed(const ScFileWriter* writer) {
+  return writer == nullptr || writer->writer.failed() ? 1 : 0;
+}
+
+int32_t sc_file_writer_close(ScFileWriter* writer) {
+  if (writer == nullptr) {
+    return -1;
+  }
+  const bool ok = writer->writer.Close();
+  delete writer;
+  return ok ? 0 : -1;
+}
+
+ScLogger* sc_logger_open(const char* path_utf8, uint64_t max_file_size,
+                         uint32_t backups, uint32_t capacity) {
+  if (path_utf8 == nullptr) {
+    return nullptr;
+  }
+  ScLogger* handle = new ScLogger();
+  if (!handle->logger.Open(
+          path_utf8,
+          max_file_size != 0 ? max_file_size
+                             : sc::RingLogger::kDefaultMaxFileSize,
+          backups,
+          capacity != 0 ? capacity : sc::RingLogger::kDefaultCapacity)) {
+    delete handle;
+    return nullptr;
+  }
+  return handle;
+}
+
+int32_t sc_logger_write(ScLogger* logger, int32_t level,
+                        const uint8_t* message, uint32_t length) {
+  if (logger == nullptr || (message == nullptr && length != 0)) {
+    return -1;
+  }
+  return logger->logger.Write(ToLogLevel(level),
+                              reinterpret_cast<const char*>(message), length)
+             ? 0
+             : -1;
+}
+
+void sc_logger_set_level(ScLogger* logger, int32_t level) {
+  if (logger != nullptr) {
+    logger->logger.set_level(ToLogLevel(level));
+  }
+}
+
+uint64_t sc_logger_dropped(const ScLogger* logger) {
+  return logger == nullptr ? 0 : logger->logger.dropped();
+}
+
+void sc_logger_flush(ScLogger* logger) {
+  if (logger != nullptr) {
+    logger->logger.Flush();
+  }
+}
+
+void sc_logger_close(ScLogger* logger) {
+  delete logger;
+}
+
+ScTracer* sc_tracer_create(uint32_t capacity) {
+  return new ScTracer(capacity != 0 ? capacity
+                                    : sc::SpanTracer::kDefaultCapacity);
+}
+
+int64_t sc_tracer_now_ns(void) { return sc::SpanTracer::NowNs(); }
+
+void sc_tracer_record(ScTracer* tracer, const uint8_t* name,
+                      uint32_t name_length, uint64_t trace_id,
+                      int64_t start_ns, int64_t end_ns) {
+  if (tracer == nullptr || (name == nullptr && name_length != 0)) {
+    return;
+  }
+  tracer->tracer.Record(
+      std::string_view(reinterpret_cast<const char*>(name), name_length),
+      trace_id, start_ns, end_ns);
+}
+
+uint64_t sc_tracer_recorded(const ScTracer* tracer) {
+  return tracer == nullptr ? 0 : tracer->tracer.recorded();
+}
+
+int32_t sc_tracer_write_chrome_trace(const ScTracer* tracer,
+                                     const char* path_utf8, uint32_t pid) {
+  if (tracer == nullptr || path_utf8 == nullptr) {
+    return -1;
+  }
+  return tracer->tracer.WriteChromeTrace(path_utf8, pid) ? 0 : -1;
+}
+
+void sc_tracer_destroy(ScTracer* tracer) { delete tracer; }
@@ -0,0 +1,377 @@
+#ifndef RUNNER_NATIVE_SC_NATIVE_API_H_
+#define RUNNER_NATIVE_SC_NATIVE_API_H_
+
+// C ABI of the sc_native library. Every function here is looked up by name
+// from lib/native/sc_native.dart, so signatures must be kept in sync with the
+// Dart typedefs there.
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(SC_NATIVE_IMPLEMENTATION)
+#define SC_NATIVE_EXPORT __declspec(dllexport)
+#else
+#define SC_NATIVE_EXPORT __declspec(dllimport)
+#endif
+#else
+#define SC_NATIVE_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bumped whenever the ABI below changes incompatibly.
+#define SC_NATIVE_ABI_VERSION 3
+
+// Mirrors sc::FrameHeader with a layout that is easy to describe as a Dart
+// ffi.Struct.
+typedef struct ScFrameHeader {
+  uint64_t session_id;
+  uint64_t offset;
+  uint32_t file_index;
+  uint32_t length;
+  uint32_t flags;
+  // Uncompressed payload length when flags has the compressed bit, else 0.
+  uint32_t raw_length;
+} ScFrameHeader;
+
+SC_NATIVE_EXPORT uint32_t sc_native_abi_version(void);
+
+// Writes the 32-byte wire header for |header| to |out|.
+SC_NATIVE_EXPORT void sc_frame_write_header(const ScFrameHeader* header,
+                                            uint8_t* out);
+
+// Encodes a full frame into |out|. Returns the frame size, or -1 if
+// |capacity| is too small.
+SC_NATIVE_EXPORT int64_t sc_frame_encode(const ScFrameHeader* header,
+                                         const uint8_t* payload, uint8_t* out,
+                                         uint64_t capacity);
+
+// Parses the 32-byte wire header at |data| of a frame that is |frame_size|
+// bytes long in total. Only the header has to be readable at |data|, so
+// callers can pass a copy of it. Returns the payload offset, or -1 if the
+// header is malformed or disagrees with |frame_size|.
+SC_NATIVE_EXPORT int32_t sc_frame_read_header(const uint8_t* data,
+                                              uint64_t frame_size,
+                                              ScFrameHeader* header);
+
+// ===== Chunk source =====
+
+// Opaque handle to an sc::ChunkSource.
+typedef struct ScChunkSource ScChunkSource;
+
+// Forces positional reads instead of memory mapping.
+#define SC_CHUNK_SOURCE_NO_MMAP 0x1
+
+// Opens the file at |path_utf8| for chunked reading. Returns null on failure.
+SC_NATIVE_EXPORT ScChunkSource* sc_chunk_source_open(const char* path_utf8,
+                                                     uint32_t flags);
+
+SC_NATIVE_EXPORT uint64_t sc_chunk_source_size(const ScChunkSource* source);
+
+// Returns a zero-copy view of up to |length| bytes at |offset| and stores the
+// actual length in |out_length|. The view is valid until the next call on
+// |source|. Returns null at end of file or on error.
+SC_NATIVE_EXPORT const uint8_t* sc_chunk_source_view(ScChunkSource* source,
+                                                     uint64_t offset,
+                                                     uint32_t length,
+                                                     uint32_t* out_length);
+
+// Writes the SHA-256 of the whole file to |digest| (32 bytes). Bytes already
+// viewed in order are not read again. Returns 0 on success, -1 on error.
+SC_NATIVE_EXPORT int32_t sc_chunk_source_digest(ScChunkSource* source,
+                                                uint8_t* digest);
+
+SC_NATIVE_EXPORT void sc_chunk_source_close(ScChunkSource* source);
+
+// ===== SHA-256 =====
+
+// Opaque handle to an incremental sc::Sha256.
+typedef struct ScSha256 ScSha256;
+
+SC_NATIVE_EXPORT ScSha256* sc_sha256_create(void);
+SC_NATIVE_EXPORT void sc_sha256_update(ScSha256* hasher, const uint8_t* data,
+                                       uint64_t length);
+// Writes the 32-byte digest to |digest| and resets |hasher|.
+SC_NATIVE_EXPORT void sc_sha256_finish(ScSha256* hasher, uint8_t* digest);
+SC_NATIVE_EXPORT void sc_sha256_destroy(ScSha256* hasher);
+// Returns 1 when the SHA-NI fast path is in use.
+SC_NATIVE_EXPORT int32_t sc_sha256_is_accelerated(void);
+
+// ===== Flow control =====
+
+// Opaque handles to sc::CreditSender and sc::CreditReceiver. Times are
+// microseconds from a monotonic clock.
+typedef struct ScCreditSender ScCreditSender;
+typedef struct ScCreditReceiver ScCreditReceiver;
+
+SC_NATIVE_EXPORT ScCreditSender* sc_credit_sender_create(void);
+// Bytes that may be sent now given the channel's bufferedAmount.
+SC_NATIVE_EXPORT uint64_t sc_credit_sender_available(ScCreditSender* sender,
+                                                     uint64_t buffered_amount);
+SC_NATIVE_EXPORT void sc_credit_sender_on_sent(ScCreditSender* sender,
+                                               uint64_t bytes, uint64_t now_us);
+SC_NATIVE_EXPORT void sc_credit_sender_on_credit(ScCreditSender* sender,
+                                                 uint64_t consumed,
+                                                 uint64_t limit,
+                                                 uint64_t now_us);
+SC_NATIVE_EXPORT uint64_t sc_credit_sender_window(ScCreditSender* sender);
+SC_NATIVE_EXPORT uint64_t sc_credit_sender_rtt_us(ScCreditSender* sender);
+SC_NATIVE_EXPORT void sc_credit_sender_destroy(ScCreditSender* sender);
+
+// Zero |window| or |grant_interval| selects the default.
+SC_NATIVE_EXPORT ScCreditReceiver* sc_credit_receiver_create(
+    uint64_t window, uint64_t grant_interval);
+// Returns 1 when a grant should be sent after taking |bytes| off the
+// channel.
+SC_NATIVE_EXPORT int32_t sc_credit_receiver_on_consumed(
+    ScCreditReceiver* receiver, uint64_t bytes);
+// Returns 1 when a grant should be sent after releasing (writing out)
+// |bytes|.
+SC_NATIVE_EXPORT int32_t sc_credit_receiver_on_released(
+    ScCreditReceiver* receiver, uint64_t bytes);
+SC_NATIVE_EXPORT uint64_t sc_credit_receiver_consumed(
+    ScCreditReceiver* receiver);
+SC_NATIVE_EXPORT uint64_t sc_credit_receiver_limit(ScCreditReceiver* receiver);
+SC_NATIVE_EXPORT void sc_credit_receiver_destroy(ScCreditReceiver* receiver);
+
+// ===== Send scheduler =====
+
+// Opaque handle to an sc::SendScheduler.
+typedef struct ScSendScheduler ScSendScheduler;
+
+#define SC_SCHEDULED_CHUNK_FIRST 0x1
+#define SC_SCHEDULED_CHUNK_LAST 0x2
+
+typedef struct ScScheduledChunk {
+  uint64_t offset;
+  uint32_t file_index;
+  uint32_t length;
+  uint32_t flags;  // SC_SCHEDULED_CHUNK_* bits
+  uint32_t reserved;
+} ScScheduledChunk;
+
+// Zero |max_active| selects the default.
+SC_NATIVE_EXPORT ScSendScheduler* sc_send_scheduler_create(
+    const uint64_t* file_sizes, uint32_t file_count, uint32_t chunk_size,
+    uint32_t max_active);
+// Returns 1 and fills |chunk|, or 0 once every file has been scheduled.
+SC_NATIVE_EXPORT int32_t sc_send_scheduler_next(ScSendScheduler* scheduler,
+                                                ScScheduledChunk* chunk);
+// Leaves a byte range of a file out of the schedule. Call before the file is
+// first returned by sc_send_scheduler_next().
+SC_NATIVE_EXPORT void sc_send_scheduler_skip(ScSendScheduler* scheduler,
+                                             uint32_t file_index,
+                                             uint64_t offset, uint64_t length);
+SC_NATIVE_EXPORT void sc_send_scheduler_destroy(ScSendScheduler* scheduler);
+
+// ===== Striping over parallel data channels =====
+
+// Opaque handles to sc::StripeScheduler and sc::ReassemblyBuffer.
+typedef struct ScStripeScheduler ScStripeScheduler;
+typedef struct ScReassemblyBuffer ScReassemblyBuffer;
+
+SC_NATIVE_EXPORT ScStripeScheduler* sc_stripe_scheduler_create(
+    uint32_t channel_count);
+SC_NATIVE_EXPORT uint32_t sc_stripe_scheduler_pick(
+    ScStripeScheduler* scheduler);
+SC_NATIVE_EXPORT void sc_stripe_scheduler_on_sent(ScStripeScheduler* scheduler,
+                                                  uint32_t channel,
+                                                  uint64_t bytes);
+SC_NATIVE_EXPORT void sc_stripe_scheduler_on_consumed(
+    ScStripeScheduler* scheduler, uint32_t channel, uint64_t consumed);
+SC_NATIVE_EXPORT void sc_stripe_scheduler_destroy(
+    ScStripeScheduler* scheduler);
+
+SC_NATIVE_EXPORT ScReassemblyBuffer* sc_reassembly_create(void);
+// Returns 1 if |offset| is the next expected offset and the chunk was
+// delivered without copying, 0 otherwise.
+SC_NATIVE_EXPORT int32_t sc_reassembly_advance(ScReassemblyBuffer* buffer,
+                                               uint64_t offset,
+                                               uint32_t length);
+// Copies a chunk in. Returns 0 on success, -1 if it overlaps known data.
+SC_NATIVE_EXPORT int32_t sc_reassembly_insert(ScReassemblyBuffer* buffer,
+                                              uint64_t offset,
+                                              const uint8_t* data,
+                                              uint32_t length);
+// Returns the held chunk at the next expected offset, or nullptr. The view
+// is valid until sc_reassembly_pop_front().
+SC_NATIVE_EXPORT const uint8_t* sc_reassembly_front(ScReassemblyBuffer* buffer,
+                                                    uint32_t* out_length);
+SC_NATIVE_EXPORT void sc_reassembly_pop_front(ScReassemblyBuffer* buffer);
+SC_NATIVE_EXPORT uint64_t sc_reassembly_next_offset(
+    ScReassemblyBuffer* buffer);
+SC_NATIVE_EXPORT uint64_t sc_reassembly_held_bytes(ScReassemblyBuffer* buffer);
+SC_NATIVE_EXPORT void sc_reassembly_destroy(ScReassemblyBuffer* buffer);
+
+// ===== Content-defined chunking and chunk store =====
+
+// Opaque handles to sc::ContentChunker and sc::ChunkStore.
+typedef struct ScContentChunker ScContentChunker;
+typedef struct ScChunkStore ScChunkStore;
+
+// Zero sizes select the defaults.
+SC_NATIVE_EXPORT ScContentChunker* sc_content_chunker_create(
+    uint32_t min_size, uint32_t average_size, uint32_t max_size);
+// Finds the chunk of |source| starting at |offset| and stores its length and
+// 32-byte SHA-256. Returns 1 on success, 0 at end of file and -1 on error.
+SC_NATIVE_EXPORT int32_t sc_content_chunker_next(ScContentChunker* chunker,
+                                                 ScChunkSource* source,
+                                                 uint64_t offset,
+                                                 uint32_t* out_length,
+                                                 uint8_t* digest);
+SC_NATIVE_EXPORT void sc_content_chunker_destroy(ScContentChunker* chunker);
+
+// Opens the store rooted at |root_utf8|. Zero |capacity| selects the
+// default. Returns nullptr on failure.
+SC_NATIVE_EXPORT ScChunkStore* sc_chunk_store_open(const char* root_utf8,
+                                                   uint64_t capacity);
+// Returns 1 if the chunk with this SHA-256 is stored, 0 otherwise.
+SC_NATIVE_EXPORT int32_t sc_chunk_store_contains(ScChunkStore* store,
+                                                 const uint8_t* digest);
+// Keeps the chunk from eviction until unpinned. Returns 1 if it is stored
+// and now pinned, 0 otherwise.
+SC_NATIVE_EXPORT int32_t sc_chunk_store_pin(ScChunkStore* store,
+                                            const uint8_t* digest);
+SC_NATIVE_EXPORT void sc_chunk_store_unpin(ScChunkStore* store,
+                                           const uint8_t* digest);
+// Returns 0 on success, -1 if the digest does not match or writing failed.
+SC_NATIVE_EXPORT int32_t sc_chunk_store_put(ScChunkStore* store,
+                                            const uint8_t* digest,
+                                            const uint8_t* data,
+                                            uint64_t length);
+// Copies the chunk into |buffer| of |capacity| bytes. Returns its length, or
+// -1 if it is missing, corrupt or does not fit.
+SC_NATIVE_EXPORT int64_t sc_chunk_store_get(ScChunkStore* store,
+                                            const uint8_t* digest,
+                                            uint8_t* buffer,
+                                            uint64_t capacity);
+SC_NATIVE_EXPORT void sc_chunk_store_trim(ScChunkStore* store);
+SC_NATIVE_EXPORT void sc_chunk_store_close(ScChunkStore* store);
+
+// ===== Compression =====
+
+// Upper bound on the LZ4 compressed size of |length| bytes.
+SC_NATIVE_EXPORT uint64_t sc_lz4_compress_bound(uint64_t length);
+// Compresses |length| bytes into |out| as one LZ4 block. Returns the
+// compressed size, or 0 if it does not fit in |capacity|.
+SC_NATIVE_EXPORT uint64_t sc_lz4_compress(const uint8_t* data,
+                                          uint64_t length, uint8_t* out,
+                                          uint64_t capacity,
+                                          int32_t acceleration);
+// Like sc_lz4_compress, but returns 0 when the data looks incompressible or
+// would not shrink by at least 1/16, in which case it should be sent raw.
+SC_NATIVE_EXPORT uint64_t sc_compress_chunk(const uint8_t* data,
+                                            uint64_t length, uint8_t* out,
+                                            uint64_t capacity,
+                                            int32_t acceleration);
+// Decompresses one LZ4 block into |out|. Returns 0 on success, -1 if the
+// block is malformed or does not decode to exactly |raw_length| bytes.
+SC_NATIVE_EXPORT int32_t sc_lz4_decompress(const uint8_t* data,
+                                           uint64_t length, uint8_t* out,
+                                           uint64_t raw_length);
+// Estimated bits of entropy per byte of |data|, between 0 and 8.
+SC_NATIVE_EXPORT double sc_estimate_entropy(const uint8_t* data,
+                                            uint64_t length);
+
+// ===== File writer =====
+
+// Opaque handle to an sc::FileWriter.
+typedef struct ScFileWriter ScFileWriter;
+
+// Opens |path_utf8| for writing a received file of |size| bytes, keeping its
+// first |keep| bytes. Zero |pool_size| selects the default. Returns null on
+// failure.
+SC_NATIVE_EXPORT ScFileWriter* sc_file_writer_open(const char* path_utf8,
+                                                   uint64_t size,
+                                                   uint64_t keep,
+                                                   uint64_t pool_size);
+// Opaque handle to an sc::WriteWorker: one thread and pool shared by the
+// writers of a session.
+typedef struct ScWriteWorker ScWriteWorker;
+
+// Zero |pool_size| selects the default.
+SC_NATIVE_EXPORT ScWriteWorker* sc_write_worker_create(uint64_t pool_size);
+// Every writer opened on |worker| must be closed first.
+SC_NATIVE_EXPORT void sc_write_worker_destroy(ScWriteWorker* worker);
+// Like sc_file_writer_open, but writes on |worker| and from its pool.
+SC_NATIVE_EXPORT ScFileWriter* sc_file_writer_open_on(ScWriteWorker* worker,
+                                                      const char* path_utf8,
+                                                      uint64_t size,
+                                                      uint64_t keep);
+// Queues |length| bytes for writing at |offset| on the writer's thread.
+// Returns 0 on success, -1 if the pool is full or a write failed.
+SC_NATIVE_EXPORT int32_t sc_file_writer_write(ScFileWriter* writer,
+                                              uint64_t offset,
+                                              const uint8_t* data,
+                                              uint32_t length);
+// Total bytes queued so far that have reached the file.
+SC_NATIVE_EXPORT uint64_t sc_file_writer_written(const ScFileWriter* writer);
+// Returns 1 if a write failed, 0 otherwise.
+SC_NATIVE_EXPORT int32_t sc_file_writer_failed(const ScFileWriter* writer);
+// Waits for queued writes, closes the file and frees the writer. Returns 0
+// on success, -1 if any write failed.
+SC_NATIVE_EXPORT int32_t sc_file_writer_close(ScFileWriter* writer);
+
+// ===== Logging =====
+
+// Opaque handle to an sc::RingLogger.
+typedef struct ScLogger ScLogger;
+
+// Levels for sc_logger_write() and sc_logger_set_level().
+#define SC_LOG_DEBUG 0
+#define SC_LOG_INFO 1
+#define SC_LOG_WARN 2
+#define SC_LOG_ERROR 3
+
+// Opens the log at |path_utf8|, rotated once it reaches |max_file_size|
+// bytes with |backups| older files kept. Zero |max_file_size| or |capacity|
+// selects the default. Returns null on failure.
+SC_NATIVE_EXPORT ScLogger* sc_logger_open(const char* path_utf8,
+                                          uint64_t max_file_size,
+                                          uint32_t backups, uint32_t capacity);
+// Queues one line of |length| UTF-8 bytes, timestamped now, for the
+// logger's thread to write. Never blocks. Returns 0 on success, -1 if the
+// level is disabled or the ring is full.
+SC_NATIVE_EXPORT int32_t sc_logger_write(ScLogger* logger, int32_t level,
+                                         const uint8_t* message,
+                                         uint32_t length);
+SC_NATIVE_EXPORT void sc_logger_set_level(ScLogger* logger, int32_t level);
+// Records dropped because the ring was full, in total.
+SC_NATIVE_EXPORT uint64_t sc_logger_dropped(const ScLogger* logger);
+// Waits until every queued line is in the file.
+SC_NATIVE_EXPORT void sc_logger_flush(ScLogger* logger);
+// Flushes, closes the file and frees the logger.
+SC_NATIVE_EXPORT void sc_logger_close(ScLogger* logger);
+
+// ===== Tracing =====
+
+// Opaque handle to an sc::SpanTracer.
+typedef struct ScTracer ScTracer;
+
+// Keeps the last |capacity| spans; zero selects the default.
+SC_NATIVE_EXPORT ScTracer* sc_tracer_create(uint32_t capacity);
+// Nanoseconds on the monotonic clock spans are timed with.
+SC_NATIVE_EXPORT int64_t sc_tracer_now_ns(void);
+// Records the span |name| (|name_length| UTF-8 bytes) from |start_ns| to
+// |end_ns| in trace |trace_id|, or in none if zero. Lock-free; overwrites
+// the oldest span when full.
+SC_NATIVE_EXPORT void sc_tracer_record(ScTracer* tracer, const uint8_t* name,
+                                       uint32_t name_length,
+                                       uint64_t trace_id, int64_t start_ns,
+                                       int64_t end_ns);
+// Spans recorded in total, including those since overwritten.
+SC_NATIVE_EXPORT uint64_t sc_tracer_recorded(const ScTracer* tracer);
+// Writes the spans held to |path_utf8| as Chrome trace JSON, attributed to
+// process |pid|. Returns 0 on success, -1 on failure.
+SC_NATIVE_EXPORT int32_t sc_tracer_write_chrome_trace(const ScTracer* tracer,
+                                                      const char* path_utf8,
+                                                      uint32_t pid);
+SC_NATIVE_EXPORT void sc_tracer_destroy(ScTracer* tracer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // RUNNER_NATIVE_SC_NATIVE_API_H_
@@ -0,0 +1,87 @@
+#include "send_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace sc {
+
+SendScheduler::SendScheduler(std::vector<uint64_t> file_sizes,
+                             uint32_t chunk_size, size_t max_active)
+    : file_sizes_(std::move(file_sizes)),
+      chunk_size_(std::max<uint32_t>(chunk_size, 1)),
+      max_active_(std::max<size_t>(max_active, 1)) {
+  extents_.reserve(file_sizes_.size());
+  for (uint64_t size : file_sizes_) {
+    extents_.push_back({{0, size}});
+  }
+}
+
+void SendScheduler::Skip(uint32_t file_index, uint64_t offset,
+                         uint64_t length) {
+  if (file_index >= extents_.size() || file_index < next_file_ ||
+      length == 0) {
+    return;
+  }
+  const uint64_t end = offset + length;
+  std::vector<Extent> remaining;
+  for (const Extent& extent : extents_[file_index]) {
+    if (extent.end <= offset || extent.offset >= end) {
+      remaining.push_back(extent);
+      continue;
+    }
+    if (extent.offset < offset) {
+      remaining.push_back({extent.offset, offset});
+    }
+    if (extent.end > end) {
+      remaining.push_back({end, extent.end});
+    }
+  }
+  extents_[file_index] = std::move(remaining);
+}
+
+bool SendScheduler::Next(Chunk* chunk) {
+  while (active_.size() < max_active_ && next_file_ < file_sizes_.size()) {
+    const std::vector<Extent>& extents = extents_[next_file_];
+    const uint64_t start = extents.empty() ? 0 : extents.front().offset;
+    active_.push_back({next_file_++, 0, start, false});
+  }
+  if (active_.empty()) {
+    return false;
+  }
+  if (cursor_ >= active_.size()) {
+    cursor_ = 0;
+  }
+
+  ActiveFile& file = active_[cursor_];
+  const std::vector<Extent>& extents = extents_[file.file_index];
+  chunk->file_index = file.file_index;
+  chunk->offset = file.offset;
+  chunk->first = !file.started;
+  file.started = true;
+  if (file.extent < extents.size()) {
+    const Extent& extent = extents[file.extent];
+    chunk->length = static_cast<uint32_t>(
+        std::min<uint64_t>(chunk_size_, extent.end - file.offset));
+    file.offset += chunk->length;
+    if (file.offset >= extent.end && ++file.extent < extents.size()) {
+      file.offset = extents[file.extent].offset;
+    }
+  } else {
+    chunk->length = 0;  // empty file, or nothing left to send
+  }
+  chunk->last = file.extent >= extents.size();
+
+  if (chunk->last) {
+    // The file after it moves into its slot, so the rotation continues.
+    active_.erase(active_.begin() + static_cast<std::ptrdiff_t>(cursor_));
+  } else {
+    cursor_++;
+  }
+  return true;
+}
+
+bool SendScheduler::done() const {
+  return active_.empty() && next_file_ >= file_sizes_.size();
+}
+
+}  // namespace sc
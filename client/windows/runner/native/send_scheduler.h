@@ -0,0 +1,69 @@
+#ifndef RUNNER_NATIVE_SEND_SCHEDULER_H_
+#define RUNNER_NATIVE_SEND_SCHEDULER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sc {
+
+// Decides which file chunk a session sends next.
+//
+// Up to |max_active| files are streamed at once, one chunk from each in
+// turn, and a new file starts as soon as an active one finishes. Files no
+// longer wait for the previous file's end to be acknowledged, and a small
+// file queued behind a large one completes without waiting for it. Each
+// file's chunks are still produced in offset order.
+class SendScheduler {
+ public:
+  static constexpr size_t kDefaultMaxActiveFiles = 4;
+
+  struct Chunk {
+    uint32_t file_index = 0;
+    uint64_t offset = 0;
+    uint32_t length = 0;  // zero only for an empty file
+    bool first = false;   // first chunk of the file: open it
+    bool last = false;    // last chunk of the file: send its end marker
+  };
+
+  SendScheduler(std::vector<uint64_t> file_sizes, uint32_t chunk_size,
+                size_t max_active = kDefaultMaxActiveFiles);
+
+  // Leaves [offset, offset + length) of a file out of the schedule, for
+  // data the receiver already has. Must be called before Next() first
+  // reaches the file. A file with nothing left to send still yields one
+  // empty chunk, flagged first and last, so its end marker is sent.
+  void Skip(uint32_t file_index, uint64_t offset, uint64_t length);
+
+  // Stores the next chunk in |chunk|. Returns false once every file has
+  // been fully scheduled.
+  bool Next(Chunk* chunk);
+
+  bool done() const;
+
+ private:
+  // Byte range of a file still to be sent.
+  struct Extent {
+    uint64_t offset;
+    uint64_t end;
+  };
+
+  struct ActiveFile {
+    uint32_t file_index;
+    size_t extent;
+    uint64_t offset;
+    bool started;
+  };
+
+  std::vector<uint64_t> file_sizes_;
+  std::vector<std::vector<Extent>> extents_;
+  uint32_t chunk_size_;
+  size_t max_active_;
+  std::vector<ActiveFile> active_;
+  size_t cursor_ = 0;
+  uint32_t next_file_ = 0;
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_SEND_SCHEDULER_H_
@@ -0,0 +1,286 @@
+#include "sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define SC_SHA256_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace sc {
+
+namespace {
+
+constexpr uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+constexpr uint32_t kInitialState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                       0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                       0x1f83d9ab, 0x5be0cd19};
+
+// Compresses |count| consecutive 64-byte blocks into |state|.
+using BlockFunction = void (*)(uint32_t state[8], const uint8_t* blocks,
+                               size_t count);
+
+inline uint32_t RotateRight(uint32_t value, int bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+inline uint32_t LoadBigEndian32(const uint8_t* in) {
+  return (static_cast<uint32_t>(in[0]) << 24) |
+         (static_cast<uint32_t>(in[1]) << 16) |
+         (static_cast<uint32_t>(in[2]) << 8) | static_cast<uint32_t>(in[3]);
+}
+
+void CompressBlocksScalar(uint32_t state[8], const uint8_t* blocks,
+                          size_t count) {
+  uint32_t w[64];
+  for (; count > 0; count--, blocks += Sha256::kBlockSize) {
+    for (int i = 0; i < 16; i++) {
+      w[i] = LoadBigEndian32(blocks + 4 * i);
+    }
+    for (int i = 16; i < 64; i++) {
+      const uint32_t s0 = RotateRight(w[i - 15], 7) ^
+                          RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      const uint32_t s1 = RotateRight(w[i - 2], 17) ^
+                          RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+      const uint32_t s1 =
+          RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+      const uint32_t choice = (e & f) ^ (~e & g);
+      const uint32_t t1 = h + s1 + choice + kRoundConstants[i] + w[i];
+      const uint32_t s0 =
+          RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+      const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+      const uint32_t t2 = s0 + majority;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+#if defined(SC_SHA256_X86)
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SC_TARGET_SHA
+#else
+#define SC_TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+
+bool CpuHasShaExtensions() {
+  unsigned int leaf1_ecx = 0;
+  unsigned int leaf7_ebx = 0;
+#if defined(_MSC_VER)
+  int regs[4];
+  __cpuid(regs, 0);
+  if (regs[0] < 7) {
+    return false;
+  }
+  __cpuid(regs, 1);
+  leaf1_ecx = static_cast<unsigned int>(regs[2]);
+  __cpuidex(regs, 7, 0);
+  leaf7_ebx = static_cast<unsigned int>(regs[1]);
+#else
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0, nullptr) < 7) {
+    return false;
+  }
+  __cpuid(1, eax, ebx, ecx, edx);
+  leaf1_ecx = ecx;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  leaf7_ebx = ebx;
+#endif
+  const bool ssse3 = (leaf1_ecx & (1u << 9)) != 0;
+  const bool sse41 = (leaf1_ecx & (1u << 19)) != 0;
+  const bool sha = (leaf7_ebx & (1u << 29)) != 0;
+  return ssse3 && sse41 && sha;
+}
+
+// SHA-NI block function. Each iteration of the round loop performs four
+// rounds; the message schedule for later groups is computed in flight with
+// sha256msg1/sha256msg2.
+SC_TARGET_SHA void CompressBlocksShaNi(uint32_t state[8],
+                                       const uint8_t* blocks, size_t count) {
+  const __m128i byte_swap =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  // Rearrange the state into the ABEF/CDGH layout the instructions use.
+  __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+  __m128i state1 =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);        // CDAB
+  state1 = _mm_shuffle_epi32(state1, 0x1B);  // EFGH
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);       // CDGH
+
+  for (; count > 0; count--, blocks += Sha256::kBlockSize) {
+    const __m128i abef_save = state0;
+    const __m128i cdgh_save = state1;
+    __m128i w[4];
+    for (int i = 0; i < 4; i++) {
+      w[i] = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * i)),
+          byte_swap);
+    }
+    for (int group = 0; group < 16; group++) {
+      __m128i& current = w[group & 3];
+      __m128i& previous = w[(group + 3) & 3];
+      __m128i& next = w[(group + 1) & 3];
+      __m128i message = _mm_add_epi32(
+          current, _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                       &kRoundConstants[4 * group])));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+      if (group >= 3 && group <= 14) {
+        next = _mm_add_epi32(next, _mm_alignr_epi8(current, previous, 4));
+        next = _mm_sha256msg2_epu32(next, current);
+      }
+      message = _mm_shuffle_epi32(message, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+      if (group >= 1 && group <= 12) {
+        previous = _mm_sha256msg1_epu32(previous, current);
+      }
+    }
+    state0 = _mm_add_epi32(state0, abef_save);
+    state1 = _mm_add_epi32(state1, cdgh_save);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);        // FEBA
+  state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+  state1 = _mm_alignr_epi8(state1, tmp, 8);     // ABEF
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+#endif  // SC_SHA256_X86
+
+BlockFunction SelectBlockFunction() {
+#if defined(SC_SHA256_X86)
+  if (CpuHasShaExtensions()) {
+    return CompressBlocksShaNi;
+  }
+#endif
+  return CompressBlocksScalar;
+}
+
+bool g_acceleration_disabled = false;
+
+BlockFunction GetBlockFunction() {
+  static const BlockFunction function = SelectBlockFunction();
+  return g_acceleration_disabled ? CompressBlocksScalar : function;
+}
+
+}  // namespace
+
+Sha256::Sha256() { Reset(); }
+
+void Sha256::Reset() {
+  std::memcpy(state_, kInitialState, sizeof(state_));
+  length_ = 0;
+  buffered_ = 0;
+}
+
+void Sha256::Update(const uint8_t* data, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  length_ += length;
+  const BlockFunction compress = GetBlockFunction();
+  if (buffered_ > 0) {
+    const size_t take = std::min(kBlockSize - buffered_, length);
+    std::memcpy(buffer_ + buffered_, data, take);
+    buffered_ += take;
+    data += take;
+    length -= take;
+    if (buffered_ < kBlockSize) {
+      return;
+    }
+    compress(state_, buffer_, 1);
+    buffered_ = 0;
+  }
+  const size_t blocks = length / kBlockSize;
+  if (blocks > 0) {
+    compress(state_, data, blocks);
+    data += blocks * kBlockSize;
+    length -= blocks * kBlockSize;
+  }
+  if (length > 0) {
+    std::memcpy(buffer_, data, length);
+    buffered_ = length;
+  }
+}
+
+void Sha256::Finish(uint8_t digest[kDigestSize]) {
+  const uint64_t bit_length = length_ * 8;
+  uint8_t padding[2 * kBlockSize] = {0x80};
+  const size_t pad_length =
+      (buffered_ < 56 ? 56 - buffered_ : 120 - buffered_);
+  uint8_t length_bytes[8];
+  for (int i = 0; i < 8; i++) {
+    length_bytes[i] = static_cast<uint8_t>(bit_length >> (56 - 8 * i));
+  }
+  Update(padding, pad_length);
+  Update(length_bytes, sizeof(length_bytes));
+  for (int i = 0; i < 8; i++) {
+    digest[4 * i] = static_cast<uint8_t>(state_[i] >> 24);
+    digest[4 * i + 1] = static_cast<uint8_t>(state_[i] >> 16);
+    digest[4 * i + 2] = static_cast<uint8_t>(state_[i] >> 8);
+    digest[4 * i + 3] = static_cast<uint8_t>(state_[i]);
+  }
+  Reset();
+}
+
+bool Sha256::IsAccelerated() {
+  return GetBlockFunction() != CompressBlocksScalar;
+}
+
+void Sha256::DisableAccelerationForTesting(bool disabled) {
+  g_acceleration_disabled = disabled;
+}
+
+std::string Sha256::ToHex(const uint8_t digest[kDigestSize]) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  std::string hex(2 * kDigestSize, '0');
+  for (size_t i = 0; i < kDigestSize; i++) {
+    hex[2 * i] = kHexDigits[digest[i] >> 4];
+    hex[2 * i + 1] = kHexDigits[digest[i] & 0xf];
+  }
+  return hex;
+}
+
+}  // namespace sc
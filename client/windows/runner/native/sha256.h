@@ -0,0 +1,52 @@
+#ifndef RUNNER_NATIVE_SHA256_H_
+#define RUNNER_NATIVE_SHA256_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sc {
+
+// Incremental SHA-256, fed chunk by chunk as data streams through the send
+// and receive paths so files never need a second read just for hashing.
+//
+// Uses the x86 SHA extensions (SHA-NI) when the CPU has them and a portable
+// scalar implementation otherwise; the choice is made once per process.
+class Sha256 {
+ public:
+  static constexpr size_t kDigestSize = 32;
+  static constexpr size_t kBlockSize = 64;
+
+  Sha256();
+
+  // Starts a new message.
+  void Reset();
+
+  void Update(const uint8_t* data, size_t length);
+
+  // Writes the digest of everything passed to Update() since the last
+  // Reset() to |digest|, then resets.
+  void Finish(uint8_t digest[kDigestSize]);
+
+  // Total number of bytes passed to Update() for the current message.
+  uint64_t length() const { return length_; }
+
+  // Whether the SHA-NI fast path is in use on this machine.
+  static bool IsAccelerated();
+
+  // Forces the scalar implementation so tests can cover both paths.
+  static void DisableAccelerationForTesting(bool disabled);
+
+  // Lower-case hex encoding of |digest|, as produced by package:crypto.
+  static std::string ToHex(const uint8_t digest[kDigestSize]);
+
+ private:
+  uint32_t state_[8];
+  uint64_t length_ = 0;
+  uint8_t buffer_[kBlockSize];
+  size_t buffered_ = 0;
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_SHA256_H_
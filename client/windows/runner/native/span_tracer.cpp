@@ -0,0 +1,139 @@
+#include "span_tracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "ring_capacity.h"
+
+namespace sc {
+
+namespace {
+
+void AppendJsonString(std::string* out, std::string_view text) {
+  out->push_back('"');
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out->append(escaped);
+    } else {
+      out->push_back(c);
+    }
+  }
+  out->push_back('"');
+}
+
+// Microseconds with nanosecond precision, as trace viewers accept.
+void AppendMicros(std::string* out, int64_t ns) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%lld.%03lld",
+                static_cast<long long>(ns / 1000),
+                static_cast<long long>(ns % 1000));
+  out->append(text);
+}
+
+}  // namespace
+
+SpanTracer::SpanTracer(size_t capacity) {
+  const size_t slot_count = RoundUpCapacity(capacity);
+  slots_.reset(new Slot[slot_count]);
+  mask_ = slot_count - 1;
+  const int64_t wall_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  wall_offset_ns_ = wall_ns - NowNs();
+}
+
+SpanTracer::~SpanTracer() {}
+
+int64_t SpanTracer::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void SpanTracer::Record(std::string_view name, uint64_t trace_id,
+                        int64_t start_ns, int64_t end_ns, uint32_t thread) {
+  const uint64_t index = next_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[index & mask_];
+  // A seqlock per slot: odd while written, then even and unique to |index|.
+  slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.trace_id = trace_id;
+  slot.start_ns = start_ns;
+  slot.end_ns = std::max(end_ns, start_ns);
+  slot.thread = thread;
+  const size_t length = std::min(name.size(), kMaxNameSize);
+  std::memcpy(slot.name, name.data(), length);
+  slot.name_length = static_cast<uint8_t>(length);
+  slot.sequence.store(index * 2 + 2, std::memory_order_release);
+}
+
+void SpanTracer::AppendChromeTrace(std::string* out, uint32_t pid) const {
+  const uint64_t end = next_.load(std::memory_order_acquire);
+  const uint64_t begin = end > capacity() ? end - capacity() : 0;
+  out->append("{\"traceEvents\":[");
+  bool first = true;
+  for (uint64_t index = begin; index < end; index++) {
+    const Slot& slot = slots_[index & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != index * 2 + 2) {
+      continue;  // being written, or already overwritten
+    }
+    const uint64_t trace_id = slot.trace_id;
+    const int64_t start_ns = slot.start_ns;
+    const int64_t end_ns = slot.end_ns;
+    const uint32_t thread = slot.thread;
+    char name[kMaxNameSize];
+    const size_t name_length = std::min<size_t>(slot.name_length, kMaxNameSize);
+    std::memcpy(name, slot.name, name_length);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != index * 2 + 2) {
+      continue;
+    }
+
+    if (!first) {
+      out->push_back(',');
+    }
+    first = false;
+    out->append("{\"name\":");
+    AppendJsonString(out, std::string_view(name, name_length));
+    out->append(",\"ph\":\"X\",\"ts\":");
+    AppendMicros(out, start_ns + wall_offset_ns_);
+    out->append(",\"dur\":");
+    AppendMicros(out, end_ns - start_ns);
+    char ids[96];
+    std::snprintf(ids, sizeof(ids), ",\"pid\":%u,\"tid\":%u", pid, thread);
+    out->append(ids);
+    if (trace_id != 0) {
+      std::snprintf(ids, sizeof(ids), ",\"args\":{\"trace\":\"%016llx\"}",
+                    static_cast<unsigned long long>(trace_id));
+      out->append(ids);
+    }
+    out->push_back('}');
+  }
+  out->append("],\"displayTimeUnit\":\"ms\"}");
+}
+
+bool SpanTracer::WriteChromeTrace(const std::string& path,
+                                  uint32_t pid) const {
+  std::string json;
+  AppendChromeTrace(&json, pid);
+  std::ofstream file(std::filesystem::u8path(path),
+                     std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+  file.write(json.data(), static_cast<std::streamsize>(json.size()));
+  file.close();
+  return !file.fail();
+}
+
+}  // namespace sc
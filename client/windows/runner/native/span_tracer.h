@@ -0,0 +1,78 @@
+#ifndef RUNNER_NATIVE_SPAN_TRACER_H_
+#define RUNNER_NATIVE_SPAN_TRACER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace sc {
+
+// Spans of work timed on a monotonic clock, kept in memory until exported.
+//
+// Record() is lock-free and safe from any number of threads: one atomic
+// increment claims the next slot of a fixed ring, overwriting the oldest
+// span, so tracing never blocks or allocates and always holds the most
+// recent spans. A slot's sequence number is odd while it is written, and
+// export skips slots caught mid-write.
+//
+// Spans export in the Chrome trace event format (chrome://tracing or
+// Perfetto) as complete ("X") events, timestamped on the wall clock so
+// traces from several devices line up, each carrying its trace id in
+// args.trace.
+class SpanTracer {
+ public:
+  // Longest span name kept; longer ones are cut off.
+  static constexpr size_t kMaxNameSize = 47;
+  static constexpr size_t kDefaultCapacity = 4096;
+
+  // Keeps the last |capacity| spans, rounded up to a power of two.
+  explicit SpanTracer(size_t capacity = kDefaultCapacity);
+  ~SpanTracer();
+
+  // Prevent copying.
+  SpanTracer(SpanTracer const&) = delete;
+  SpanTracer& operator=(SpanTracer const&) = delete;
+
+  // Nanoseconds on the monotonic clock spans are timed with.
+  static int64_t NowNs();
+
+  // Records |name| as running from |start_ns| to |end_ns| (NowNs() values)
+  // as part of trace |trace_id|, or of none if zero, on thread |thread|.
+  void Record(std::string_view name, uint64_t trace_id, int64_t start_ns,
+              int64_t end_ns, uint32_t thread = 0);
+
+  // Appends {"traceEvents":[...]} for every span held, oldest first,
+  // attributed to process |pid|.
+  void AppendChromeTrace(std::string* out, uint32_t pid) const;
+  // Writes AppendChromeTrace() to |path|, encoded in UTF-8. Returns false
+  // on failure.
+  bool WriteChromeTrace(const std::string& path, uint32_t pid) const;
+
+  // Spans recorded in total, including those since overwritten.
+  uint64_t recorded() const { return next_.load(std::memory_order_relaxed); }
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> sequence{0};
+    uint64_t trace_id = 0;
+    int64_t start_ns = 0;
+    int64_t end_ns = 0;
+    uint32_t thread = 0;
+    uint8_t name_length = 0;
+    char name[kMaxNameSize];
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_ = 0;
+  // Wall clock minus the monotonic clock, in nanoseconds, at construction.
+  int64_t wall_offset_ns_ = 0;
+  alignas(64) std::atomic<uint64_t> next_{0};
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_SPAN_TRACER_H_
@@ -0,0 +1,111 @@
+#include "stripe.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace sc {
+
+namespace {
+
+// Pooled buffers beyond this many are freed instead of kept.
+constexpr size_t kMaxPooledBuffers = 64;
+
+}  // namespace
+
+StripeScheduler::StripeScheduler(size_t channel_count)
+    : channels_(std::max<size_t>(channel_count, 1)) {}
+
+size_t StripeScheduler::Pick() {
+  const size_t count = channels_.size();
+  size_t best = next_ % count;
+  for (size_t i = 1; i < count; i++) {
+    const size_t channel = (next_ + i) % count;
+    if (in_flight(channel) < in_flight(best)) {
+      best = channel;
+    }
+  }
+  next_ = best + 1;
+  return best;
+}
+
+void StripeScheduler::OnSent(size_t channel, uint64_t bytes) {
+  if (channel < channels_.size()) {
+    channels_[channel].sent += bytes;
+  }
+}
+
+void StripeScheduler::OnConsumed(size_t channel, uint64_t consumed) {
+  if (channel < channels_.size()) {
+    Channel& target = channels_[channel];
+    target.consumed =
+        std::min(std::max(target.consumed, consumed), target.sent);
+  }
+}
+
+uint64_t StripeScheduler::in_flight(size_t channel) const {
+  return channels_[channel].sent - channels_[channel].consumed;
+}
+
+ReassemblyBuffer::ReassemblyBuffer() = default;
+
+bool ReassemblyBuffer::Advance(uint64_t offset, size_t length) {
+  if (offset != next_offset_ || (!chunks_.empty() &&
+                                 chunks_.begin()->first < offset + length)) {
+    return false;
+  }
+  next_offset_ += length;
+  return true;
+}
+
+bool ReassemblyBuffer::Insert(uint64_t offset, const uint8_t* data,
+                              size_t length) {
+  if (offset < next_offset_) {
+    return false;
+  }
+  auto next = chunks_.lower_bound(offset);
+  if (next != chunks_.end() && next->first < offset + length) {
+    return false;
+  }
+  if (next != chunks_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second.size() > offset) {
+      return false;
+    }
+  }
+
+  std::vector<uint8_t> buffer;
+  if (!pool_.empty()) {
+    buffer = std::move(pool_.back());
+    pool_.pop_back();
+  }
+  buffer.assign(data, data + length);
+  chunks_.emplace_hint(next, offset, std::move(buffer));
+  held_bytes_ += length;
+  return true;
+}
+
+const uint8_t* ReassemblyBuffer::Front(size_t* length) const {
+  if (chunks_.empty() || chunks_.begin()->first != next_offset_) {
+    *length = 0;
+    return nullptr;
+  }
+  *length = chunks_.begin()->second.size();
+  return chunks_.begin()->second.data();
+}
+
+void ReassemblyBuffer::PopFront() {
+  if (chunks_.empty() || chunks_.begin()->first != next_offset_) {
+    return;
+  }
+  auto front = chunks_.begin();
+  const size_t length = front->second.size();
+  next_offset_ += length;
+  held_bytes_ -= length;
+  if (pool_.size() < kMaxPooledBuffers) {
+    pool_.push_back(std::move(front->second));
+  }
+  chunks_.erase(front);
+}
+
+}  // namespace sc
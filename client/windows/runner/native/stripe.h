@@ -0,0 +1,93 @@
+#ifndef RUNNER_NATIVE_STRIPE_H_
+#define RUNNER_NATIVE_STRIPE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace sc {
+
+// Spreads a session's frames over several data channels.
+//
+// Each channel is a separate SCTP stream, so a retransmission only stalls
+// the frames on its own stream. Frames go to the channel with the least
+// unacknowledged data: bytes sent on it minus the bytes the receiver has
+// reported consuming from it. A stalled channel stops being picked about
+// one round trip after it stalls, instead of collecting its share of every
+// frame until the retransmission lands. Ties rotate, so idle channels are
+// filled evenly.
+class StripeScheduler {
+ public:
+  explicit StripeScheduler(size_t channel_count);
+
+  // Returns the channel for the next frame.
+  size_t Pick();
+
+  void OnSent(size_t channel, uint64_t bytes);
+
+  // Applies the receiver's cumulative count of bytes consumed from
+  // |channel|. Stale counts are ignored.
+  void OnConsumed(size_t channel, uint64_t consumed);
+
+  uint64_t in_flight(size_t channel) const;
+  size_t channel_count() const { return channels_.size(); }
+
+ private:
+  struct Channel {
+    uint64_t sent = 0;
+    uint64_t consumed = 0;
+  };
+
+  std::vector<Channel> channels_;
+  size_t next_ = 0;
+};
+
+// Puts one file's chunks back in offset order when they arrive over
+// several channels.
+//
+// In-order chunks are the common case and need not be copied: when a chunk
+// starts at next_offset() and nothing is held, the caller consumes it
+// directly and calls Advance(). Anything else is copied in and held until
+// the gap before it is filled. Memory is bounded by the sender's credit
+// window, since held bytes do not extend the receiver's grants.
+class ReassemblyBuffer {
+ public:
+  ReassemblyBuffer();
+
+  // Prevent copying.
+  ReassemblyBuffer(ReassemblyBuffer const&) = delete;
+  ReassemblyBuffer& operator=(ReassemblyBuffer const&) = delete;
+
+  // Offset of the first byte not yet delivered.
+  uint64_t next_offset() const { return next_offset_; }
+  // Bytes held waiting for an earlier gap to be filled.
+  uint64_t held_bytes() const { return held_bytes_; }
+  bool empty() const { return chunks_.empty(); }
+
+  // Marks |length| bytes at |offset| as delivered without holding them.
+  // Returns false unless |offset| is next_offset().
+  bool Advance(uint64_t offset, size_t length);
+
+  // Copies a chunk in. Returns false if it overlaps data already delivered
+  // or held.
+  bool Insert(uint64_t offset, const uint8_t* data, size_t length);
+
+  // Returns the held chunk that starts at next_offset() and stores its size
+  // in |length|, or returns nullptr while there is still a gap.
+  const uint8_t* Front(size_t* length) const;
+
+  // Delivers the chunk returned by Front().
+  void PopFront();
+
+ private:
+  std::map<uint64_t, std::vector<uint8_t>> chunks_;
+  // Recycled chunk buffers, to avoid an allocation per out-of-order chunk.
+  std::vector<std::vector<uint8_t>> pool_;
+  uint64_t next_offset_ = 0;
+  uint64_t held_bytes_ = 0;
+};
+
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_STRIPE_H_
@@ -0,0 +1,109 @@
+#include "chunk_source.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "sc_native_api.h"
+#include "testing/temp_path.h"
+
+namespace sc {
+namespace {
+
+class ChunkSourceTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    path_ = testing::UniqueTempPath("chunk_source_test", ".bin");
+    // Not a multiple of the page size, so the tail chunk is short.
+    contents_.resize(3 * 65536 + 1234);
+    for (size_t i = 0; i < contents_.size(); i++) {
+      contents_[i] = static_cast<uint8_t>((i * 131) ^ (i >> 9));
+    }
+    std::ofstream out(path_, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(contents_.data()),
+              static_cast<std::streamsize>(contents_.size()));
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  std::string path_;
+  std::vector<uint8_t> contents_;
+};
+
+TEST_P(ChunkSourceTest, StreamsWholeFileInChunks) {
+  ChunkSource source;
+  // A window smaller than the file forces remapping as the reader advances.
+  ASSERT_TRUE(source.Open(path_, GetParam(), 65536));
+  ASSERT_EQ(contents_.size(), source.size());
+
+  std::vector<uint8_t> copy;
+  const size_t chunk = 8192 + 17;  // Deliberately straddles window borders.
+  uint64_t offset = 0;
+  while (true) {
+    size_t length = 0;
+    const uint8_t* view = source.View(offset, chunk, &length);
+    if (view == nullptr) {
+      break;
+    }
+    ASSERT_GT(length, 0u);
+    EXPECT_EQ(GetParam(), source.is_mapped());
+    copy.insert(copy.end(), view, view + length);
+    offset += length;
+  }
+  EXPECT_EQ(contents_, copy);
+}
+
+TEST_P(ChunkSourceTest, ClampsAtEndOfFile) {
+  ChunkSource source;
+  ASSERT_TRUE(source.Open(path_, GetParam()));
+  size_t length = 0;
+  const uint8_t* view = source.View(contents_.size() - 10, 4096, &length);
+  ASSERT_NE(nullptr, view);
+  EXPECT_EQ(10u, length);
+  EXPECT_EQ(contents_.back(), view[9]);
+
+  EXPECT_EQ(nullptr, source.View(contents_.size(), 4096, &length));
+  EXPECT_EQ(0u, length);
+}
+
+TEST_P(ChunkSourceTest, SupportsRandomAccess) {
+  ChunkSource source;
+  ASSERT_TRUE(source.Open(path_, GetParam(), 65536));
+  for (uint64_t offset : {150000ull, 10ull, 131072ull, 65530ull}) {
+    size_t length = 0;
+    const uint8_t* view = source.View(offset, 100, &length);
+    ASSERT_NE(nullptr, view);
+    ASSERT_EQ(100u, length);
+    EXPECT_EQ(0, std::memcmp(contents_.data() + offset, view, length));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(MappedAndRead, ChunkSourceTest, ::testing::Bool());
+
+TEST(ChunkSourceOpenTest, FailsForMissingFile) {
+  ChunkSource source;
+  EXPECT_FALSE(source.Open(::testing::TempDir() + "does_not_exist.bin"));
+  EXPECT_FALSE(source.is_open());
+  EXPECT_EQ(nullptr, sc_chunk_source_open(nullptr, 0));
+}
+
+TEST(ChunkSourceOpenTest, HandlesEmptyFile) {
+  const std::string path =
+      testing::UniqueTempPath("chunk_source_empty", ".bin");
+  { std::ofstream out(path, std::ios::binary); }
+  ScChunkSource* source = sc_chunk_source_open(path.c_str(), 0);
+  ASSERT_NE(nullptr, source);
+  EXPECT_EQ(0u, sc_chunk_source_size(source));
+  uint32_t length = 1;
+  EXPECT_EQ(nullptr, sc_chunk_source_view(source, 0, 8192, &length));
+  EXPECT_EQ(0u, length);
+  sc_chunk_source_close(source);
+  std::remove(path.c_str());
+}
+
+}  // namespace
+}  // namespace sc
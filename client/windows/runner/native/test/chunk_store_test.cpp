@@ -0,0 +1,162 @@
+#include "chunk_store.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "testing/temp_path.h"
+
+namespace sc {
+namespace {
+
+std::vector<uint8_t> Bytes(size_t size, uint8_t seed) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = static_cast<uint8_t>(seed + i * 7);
+  }
+  return data;
+}
+
+std::vector<uint8_t> DigestOf(const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> digest(Sha256::kDigestSize);
+  Sha256 hasher;
+  hasher.Update(data.data(), data.size());
+  hasher.Finish(digest.data());
+  return digest;
+}
+
+class ChunkStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    root_ = testing::UniqueTempPath("chunk_store_test");
+    std::filesystem::remove_all(root_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(root_); }
+
+  std::string root_;
+};
+
+TEST_F(ChunkStoreTest, StoresAndReadsChunks) {
+  ChunkStore store;
+  ASSERT_TRUE(store.Open(root_));
+  const auto data = Bytes(5000, 1);
+  const auto digest = DigestOf(data);
+  EXPECT_FALSE(store.Contains(digest.data()));
+  ASSERT_TRUE(store.Put(digest.data(), data.data(), data.size()));
+  EXPECT_TRUE(store.Contains(digest.data()));
+  // Storing it again is a no-op.
+  ASSERT_TRUE(store.Put(digest.data(), data.data(), data.size()));
+  EXPECT_EQ(1u, store.chunk_count());
+  EXPECT_EQ(data.size(), store.size_bytes());
+
+  std::vector<uint8_t> read;
+  ASSERT_TRUE(store.Get(digest.data(), &read));
+  EXPECT_EQ(data, read);
+}
+
+TEST_F(ChunkStoreTest, RejectsWrongDigest) {
+  ChunkStore store;
+  ASSERT_TRUE(store.Open(root_));
+  const auto data = Bytes(100, 2);
+  const auto other = DigestOf(Bytes(100, 3));
+  EXPECT_FALSE(store.Put(other.data(), data.data(), data.size()));
+  EXPECT_FALSE(store.Contains(other.data()));
+}
+
+TEST_F(ChunkStoreTest, PersistsAcrossOpens) {
+  const auto data = Bytes(4096, 4);
+  const auto digest = DigestOf(data);
+  {
+    ChunkStore store;
+    ASSERT_TRUE(store.Open(root_));
+    ASSERT_TRUE(store.Put(digest.data(), data.data(), data.size()));
+  }
+  ChunkStore store;
+  ASSERT_TRUE(store.Open(root_));
+  EXPECT_TRUE(store.Contains(digest.data()));
+  std::vector<uint8_t> read;
+  ASSERT_TRUE(store.Get(digest.data(), &read));
+  EXPECT_EQ(data, read);
+}
+
+TEST_F(ChunkStoreTest, DropsCorruptChunk) {
+  ChunkStore store;
+  ASSERT_TRUE(store.Open(root_));
+  const auto data = Bytes(4096, 5);
+  const auto digest = DigestOf(data);
+  ASSERT_TRUE(store.Put(digest.data(), data.data(), data.size()));
+
+  const std::string hex = Sha256::ToHex(digest.data());
+  {
+    std::ofstream out(root_ + "/" + hex.substr(0, 2) + "/" + hex,
+                      std::ios::binary | std::ios::in);
+    out.put('x');
+  }
+  std::vector<uint8_t> read;
+  EXPECT_FALSE(store.Get(digest.data(), &read));
+  EXPECT_FALSE(store.Contains(digest.data()));
+  EXPECT_EQ(0u, store.size_bytes());
+}
+
+TEST_F(ChunkStoreTest, EvictsLeastRecentlyUsed) {
+  ChunkStore store;
+  ASSERT_TRUE(store.Open(root_, 3 * 1000));
+  std::vector<std::vector<uint8_t>> digests;
+  for (uint8_t i = 0; i < 3; i++) {
+    const auto data = Bytes(1000, static_cast<uint8_t>(10 + i));
+    digests.push_back(DigestOf(data));
+    ASSERT_TRUE(store.Put(digests.back().data(), data.data(), data.size()));
+  }
+  // Touch the oldest chunk so the second one becomes least recently used.
+  std::vector<uint8_t> read;
+  ASSERT_TRUE(store.Get(digests[0].data(), &read));
+
+  const auto data = Bytes(1000, 20);
+  const auto digest = DigestOf(data);
+  ASSERT_TRUE(store.Put(digest.data(), data.data(), data.size()));
+  EXPECT_LE(store.size_bytes(), 3000u);
+  EXPECT_TRUE(store.Contains(digests[0].data()));
+  EXPECT_FALSE(store.Contains(digests[1].data()));
+  EXPECT_TRUE(store.Contains(digests[2].data()));
+  EXPECT_TRUE(store.Contains(digest.data()));
+}
+
+TEST_F(ChunkStoreTest, KeepsPinnedChunks) {
+  ChunkStore store;
+  ASSERT_TRUE(store.Open(root_, 2 * 1000));
+  const auto first = Bytes(1000, 30);
+  const auto first_digest = DigestOf(first);
+  ASSERT_TRUE(store.Put(first_digest.data(), first.data(), first.size()));
+  const auto second = Bytes(1000, 31);
+  const auto second_digest = DigestOf(second);
+  ASSERT_TRUE(store.Put(second_digest.data(), second.data(), second.size()));
+  ASSERT_TRUE(store.Pin(first_digest.data()));
+  ASSERT_TRUE(store.Pin(second_digest.data()));
+  const auto missing = DigestOf(Bytes(10, 32));
+  EXPECT_FALSE(store.Pin(missing.data()));
+
+  // Nothing can be evicted while both are pinned.
+  const auto third = Bytes(1000, 33);
+  const auto third_digest = DigestOf(third);
+  ASSERT_TRUE(store.Put(third_digest.data(), third.data(), third.size()));
+  EXPECT_TRUE(store.Contains(first_digest.data()));
+  EXPECT_TRUE(store.Contains(second_digest.data()));
+  EXPECT_FALSE(store.Contains(third_digest.data()));
+
+  store.Unpin(first_digest.data());
+  const auto fourth = Bytes(1000, 34);
+  const auto fourth_digest = DigestOf(fourth);
+  ASSERT_TRUE(store.Put(fourth_digest.data(), fourth.data(), fourth.size()));
+  EXPECT_FALSE(store.Contains(first_digest.data()));
+  EXPECT_TRUE(store.Contains(second_digest.data()));
+  std::vector<uint8_t> read;
+  ASSERT_TRUE(store.Get(second_digest.data(), &read));
+  EXPECT_EQ(second, read);
+}
+
+}  // namespace
+}  // namespace sc
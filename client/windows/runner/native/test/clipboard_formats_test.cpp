@@ -0,0 +1,154 @@
+#include "clipboard_formats.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sc {
+namespace {
+
+// A CF_HDROP block as Explorer writes it: DROPFILES, then the paths.
+std::vector<uint8_t> DropFiles(const std::vector<std::u16string>& paths,
+                               bool wide = true) {
+  std::vector<uint8_t> block(20, 0);
+  block[0] = 20;             // pFiles
+  block[16] = wide ? 1 : 0;  // fWide
+  for (const std::u16string& path : paths) {
+    for (char16_t unit : path) {
+      block.push_back(static_cast<uint8_t>(unit));
+      block.push_back(static_cast<uint8_t>(unit >> 8));
+    }
+    block.push_back(0);
+    block.push_back(0);
+  }
+  block.push_back(0);
+  block.push_back(0);
+  return block;
+}
+
+TEST(ClipboardFormatsTest, ConvertsUtf16ToUtf8) {
+  std::string out;
+  const std::u16string text = u"a\u00e9\u4e2d\U0001F600";
+  AppendUtf8FromUtf16(text.data(), text.size(), &out);
+  EXPECT_EQ("a\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80", out);
+
+  // Stops at a NUL; unpaired surrogates are replaced.
+  out.clear();
+  const char16_t broken[] = {u'x', 0xD800, u'y', 0xDC00, 0, u'z'};
+  AppendUtf8FromUtf16(broken, 6, &out);
+  EXPECT_EQ("x\xef\xbf\xbdy\xef\xbf\xbd", out);
+}
+
+TEST(ClipboardFormatsTest, ParsesDropFiles) {
+  const auto block = DropFiles({u"C:\\a.txt", u"D:\\\u00fcber\\b.png"});
+  std::vector<std::string> files;
+  ASSERT_TRUE(ParseDropFiles(block.data(), block.size(), &files));
+  EXPECT_EQ(std::vector<std::string>(
+                {"C:\\a.txt", "D:\\\xc3\xbc" "ber\\b.png"}),
+            files);
+}
+
+TEST(ClipboardFormatsTest, RejectsMalformedDropFiles) {
+  std::vector<std::string> files;
+  const auto ansi = DropFiles({u"C:\\a.txt"}, false);
+  EXPECT_FALSE(ParseDropFiles(ansi.data(), ansi.size(), &files));
+
+  auto block = DropFiles({u"C:\\a.txt"});
+  EXPECT_FALSE(ParseDropFiles(block.data(), 10, &files));
+  // Cut off before the path's terminator.
+  EXPECT_FALSE(ParseDropFiles(block.data(), 24, &files));
+  block[0] = 200;  // list past the end
+  EXPECT_FALSE(ParseDropFiles(block.data(), block.size(), &files));
+}
+
+TEST(ClipboardFormatsTest, ExtractsHtmlFragment) {
+  const std::string header =
+      "Version:0.9\r\n"
+      "StartHTML:0000000000\r\n"
+      "EndHTML:0000000000\r\n"
+      "StartFragment:0000000000\r\n"
+      "EndFragment:0000000000\r\n";
+  const std::string before = "<html><body><!--StartFragment-->";
+  const std::string fragment = "<b>bold</b>";
+  const std::string after = "<!--EndFragment--></body></html>";
+  auto number = [](size_t value) {
+    std::string text = std::to_string(value);
+    return std::string(10 - text.size(), '0') + text;
+  };
+  std::string cf_html = header + before + fragment + after;
+  const size_t start_html = header.size();
+  const size_t start_fragment = start_html + before.size();
+  const size_t end_fragment = start_fragment + fragment.size();
+  cf_html.replace(cf_html.find("StartHTML:") + 10, 10, number(start_html));
+  cf_html.replace(cf_html.find("EndHTML:") + 8, 10, number(cf_html.size()));
+  cf_html.replace(cf_html.find("StartFragment:") + 14, 10,
+                  number(start_fragment));
+  cf_html.replace(cf_html.find("EndFragment:") + 12, 10,
+                  number(end_fragment));
+
+  std::string extracted;
+  ASSERT_TRUE(ExtractHtmlFragment(cf_html, &extracted));
+  EXPECT_EQ(fragment, extracted);
+
+  // Without fragment offsets, the whole document.
+  std::string document = cf_html;
+  document.replace(document.find("StartFragment:"), 14, "StartFragmenX:");
+  ASSERT_TRUE(ExtractHtmlFragment(document, &extracted));
+  EXPECT_EQ(before + fragment + after, extracted);
+
+  EXPECT_FALSE(ExtractHtmlFragment("Version:0.9\r\n<b>x</b>", &extracted));
+  EXPECT_FALSE(ExtractHtmlFragment("StartHTML:5\r\nEndHTML:999\r\n",
+                                   &extracted));
+}
+
+TEST(ClipboardFormatsTest, RoundTripsDescriptor) {
+  ClipboardFormats formats;
+  formats.text = "hello";
+  formats.files = {"C:\\a.txt", ""};
+  formats.html = "<b>hello</b>";
+  formats.png = {0x89, 'P', 'N', 'G'};
+  const std::vector<uint8_t> descriptor = EncodeClipboardDescriptor(formats);
+
+  ClipboardFormats decoded;
+  ASSERT_TRUE(DecodeClipboardDescriptor(descriptor.data(), descriptor.size(),
+                                        &decoded));
+  EXPECT_EQ(formats.text, decoded.text);
+  EXPECT_EQ(formats.files, decoded.files);
+  EXPECT_EQ(formats.html, decoded.html);
+  EXPECT_EQ(formats.png, decoded.png);
+}
+
+TEST(ClipboardFormatsTest, DescribesAnEmptyClipboardInSixBytes) {
+  const std::vector<uint8_t> descriptor =
+      EncodeClipboardDescriptor(ClipboardFormats());
+  EXPECT_EQ(std::vector<uint8_t>({'S', 'C', 'C', 'F', 1, 0}), descriptor);
+}
+
+TEST(ClipboardFormatsTest, RejectsMalformedDescriptors) {
+  ClipboardFormats formats;
+  formats.text = "hello";
+  formats.files = {"C:\\a.txt"};
+  const std::vector<uint8_t> descriptor = EncodeClipboardDescriptor(formats);
+  ClipboardFormats decoded;
+  for (size_t size = 0; size < descriptor.size(); size++) {
+    EXPECT_FALSE(DecodeClipboardDescriptor(descriptor.data(), size, &decoded))
+        << size;
+  }
+  std::vector<uint8_t> wrong_version = descriptor;
+  wrong_version[4] = 2;
+  EXPECT_FALSE(DecodeClipboardDescriptor(wrong_version.data(),
+                                         wrong_version.size(), &decoded));
+
+  // Formats from a later version are skipped.
+  std::vector<uint8_t> extended = descriptor;
+  extended[5]++;
+  extended.insert(extended.end(), {99, 1, 0, 0, 0, 'x'});
+  ASSERT_TRUE(
+      DecodeClipboardDescriptor(extended.data(), extended.size(), &decoded));
+  EXPECT_EQ("hello", decoded.text);
+}
+
+}  // namespace
+}  // namespace sc
@@ -0,0 +1,192 @@
+#include "clipboard_watcher.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sc {
+namespace {
+
+constexpr std::chrono::milliseconds kTimeout{5000};
+
+// A clipboard the test sets, read through the watcher's Reader.
+class FakeClipboard {
+ public:
+  void SetText(const std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    kind_ = ClipboardSnapshot::Kind::kText;
+    text_ = text;
+    files_.clear();
+  }
+
+  void SetFiles(const std::vector<std::string>& files) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    kind_ = ClipboardSnapshot::Kind::kFiles;
+    text_.clear();
+    files_ = files;
+  }
+
+  // The next |count| reads fail as if another process held the clipboard.
+  void Lock(int count) { locked_reads_ = count; }
+
+  bool Read(ClipboardSnapshot* snapshot) {
+    reads_++;
+    if (locked_reads_ > 0) {
+      locked_reads_--;
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot->kind = kind_;
+    snapshot->text = text_;
+    snapshot->files = files_;
+    return true;
+  }
+
+  int reads() const { return reads_; }
+
+ private:
+  std::mutex mutex_;
+  ClipboardSnapshot::Kind kind_ = ClipboardSnapshot::Kind::kEmpty;
+  std::string text_;
+  std::vector<std::string> files_;
+  std::atomic<int> locked_reads_{0};
+  std::atomic<int> reads_{0};
+};
+
+class ClipboardWatcherTest : public ::testing::Test {
+ protected:
+  ClipboardWatcherTest()
+      : watcher_(
+            [this](ClipboardSnapshot* snapshot) {
+              return clipboard_.Read(snapshot);
+            },
+            [this](std::shared_ptr<const ClipboardSnapshot> snapshot) {
+              std::lock_guard<std::mutex> lock(mutex_);
+              changes_.push_back(std::move(snapshot));
+            }) {}
+
+  std::vector<std::shared_ptr<const ClipboardSnapshot>> changes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return changes_;
+  }
+
+  FakeClipboard clipboard_;
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<const ClipboardSnapshot>> changes_;
+  ClipboardWatcher watcher_;
+};
+
+TEST_F(ClipboardWatcherTest, SnapshotsEachChange) {
+  EXPECT_EQ(nullptr, watcher_.Latest());
+
+  clipboard_.SetText("hello");
+  watcher_.Notify(1);
+  ASSERT_TRUE(watcher_.WaitIdle(kTimeout));
+  auto text = watcher_.Current(1);
+  ASSERT_NE(nullptr, text);
+  EXPECT_EQ(ClipboardSnapshot::Kind::kText, text->kind);
+  EXPECT_EQ("hello", text->text);
+  EXPECT_EQ(1u, text->sequence);
+
+  clipboard_.SetFiles({"C:\\a.txt", "C:\\b.txt"});
+  watcher_.Notify(2);
+  ASSERT_TRUE(watcher_.WaitIdle(kTimeout));
+  auto files = watcher_.Current(2);
+  ASSERT_NE(nullptr, files);
+  EXPECT_EQ(ClipboardSnapshot::Kind::kFiles, files->kind);
+  EXPECT_EQ(std::vector<std::string>({"C:\\a.txt", "C:\\b.txt"}),
+            files->files);
+
+  ASSERT_EQ(2u, changes().size());
+  EXPECT_EQ(text, changes()[0]);
+  EXPECT_EQ(files, changes()[1]);
+}
+
+TEST_F(ClipboardWatcherTest, IsNotCurrentForALaterSequence) {
+  clipboard_.SetText("hello");
+  watcher_.Notify(1);
+  ASSERT_TRUE(watcher_.WaitIdle(kTimeout));
+  EXPECT_NE(nullptr, watcher_.Current(1));
+  // The system has a newer change the watcher has not heard of yet.
+  EXPECT_EQ(nullptr, watcher_.Current(2));
+}
+
+TEST_F(ClipboardWatcherTest, SameContentIsNotAChange) {
+  clipboard_.SetText("hello");
+  watcher_.Notify(1);
+  ASSERT_TRUE(watcher_.WaitIdle(kTimeout));
+  watcher_.Notify(2);
+  ASSERT_TRUE(watcher_.WaitIdle(kTimeout));
+
+  EXPECT_EQ(1u, changes().size());
+  // Still current: sequence 2 held what was snapshotted at 1.
+  auto snapshot = watcher_.Current(2);
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_EQ(1u, snapshot->sequence);
+}
+
+TEST_F(ClipboardWatcherTest, RetriesWhileTheClipboardIsHeld) {
+  clipboard_.SetText("held");
+  clipboard_.Lock(2);
+  watcher_.Notify(1);
+  ASSERT_TRUE(watcher_.WaitIdle(kTimeout));
+  EXPECT_EQ(3, clipboard_.reads());
+  auto snapshot = watcher_.Current(1);
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_EQ("held", snapshot->text);
+}
+
+TEST_F(ClipboardWatcherTest, GivesUpOnAClipboardHeldTooLong) {
+  clipboard_.SetText("held");
+  clipboard_.Lock(ClipboardWatcher::kReadAttempts);
+  watcher_.Notify(1);
+  ASSERT_TRUE(watcher_.WaitIdle(kTimeout));
+  EXPECT_EQ(ClipboardWatcher::kReadAttempts, clipboard_.reads());
+  EXPECT_EQ(nullptr, watcher_.Current(1));
+  EXPECT_TRUE(changes().empty());
+
+  // The next change is read as usual.
+  watcher_.Notify(2);
+  ASSERT_TRUE(watcher_.WaitIdle(kTimeout));
+  EXPECT_NE(nullptr, watcher_.Current(2));
+}
+
+TEST_F(ClipboardWatcherTest, CoalescesBurstsOfChanges) {
+  clipboard_.SetText("last");
+  for (uint64_t sequence = 1; sequence <= 100; sequence++) {
+    watcher_.Notify(sequence);
+  }
+  ASSERT_TRUE(watcher_.WaitIdle(kTimeout));
+  EXPECT_LT(clipboard_.reads(), 100);
+  auto snapshot = watcher_.Current(100);
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_EQ("last", snapshot->text);
+}
+
+TEST(ClipboardWatcherDigestTest, DistinguishesKindAndBoundaries) {
+  auto digest = [](ClipboardSnapshot::Kind kind, const std::string& text,
+                   const std::vector<std::string>& files) {
+    ClipboardSnapshot snapshot;
+    snapshot.kind = kind;
+    snapshot.text = text;
+    snapshot.files = files;
+    ClipboardWatcher::Digest(snapshot, snapshot.digest);
+    return Sha256::ToHex(snapshot.digest);
+  };
+  using Kind = ClipboardSnapshot::Kind;
+  EXPECT_EQ(digest(Kind::kText, "a", {}), digest(Kind::kText, "a", {}));
+  EXPECT_NE(digest(Kind::kText, "a", {}), digest(Kind::kText, "b", {}));
+  EXPECT_NE(digest(Kind::kText, "a", {}), digest(Kind::kFiles, "", {"a"}));
+  EXPECT_NE(digest(Kind::kFiles, "", {"ab", "c"}),
+            digest(Kind::kFiles, "", {"a", "bc"}));
+  EXPECT_NE(digest(Kind::kEmpty, "", {}), digest(Kind::kText, "", {}));
+}
+
+}  // namespace
+}  // namespace sc
@@ -0,0 +1,190 @@
+#include "compression.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "frame_codec.h"
+
+namespace sc {
+namespace {
+
+std::vector<uint8_t> RandomBytes(size_t size, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> data(size);
+  for (auto& byte : data) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  return data;
+}
+
+std::vector<uint8_t> TextBytes(size_t size) {
+  static const char* const kWords[] = {
+      "clipboard", "share", "the", "device", "file", "transfer", "peer",
+      "channel",   "of",    "a",   "signal", "and",  "chunk",    "to"};
+  std::mt19937 rng(3);
+  std::string text;
+  while (text.size() < size) {
+    text += kWords[rng() % (sizeof(kWords) / sizeof(kWords[0]))];
+    text += (rng() % 12 == 0) ? ".\n" : " ";
+  }
+  text.resize(size);
+  return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+std::vector<uint8_t> RoundTrip(const std::vector<uint8_t>& input) {
+  std::vector<uint8_t> compressed(Lz4CompressBound(input.size()));
+  const size_t size = Lz4Compress(input.data(), input.size(),
+                                  compressed.data(), compressed.size());
+  EXPECT_NE(0u, size);
+  std::vector<uint8_t> output(input.size());
+  EXPECT_TRUE(Lz4Decompress(compressed.data(), size, output.data(),
+                            output.size()));
+  return output;
+}
+
+TEST(CompressionTest, RoundTripsSmallInputs) {
+  for (size_t size = 0; size <= 20; size++) {
+    const auto input = RandomBytes(size, static_cast<uint32_t>(size));
+    EXPECT_EQ(input, RoundTrip(input)) << "size " << size;
+  }
+}
+
+TEST(CompressionTest, RoundTripsTextRandomAndRuns) {
+  const auto text = TextBytes(200000);
+  EXPECT_EQ(text, RoundTrip(text));
+  const auto random = RandomBytes(100000, 9);
+  EXPECT_EQ(random, RoundTrip(random));
+  // Long runs exercise overlapping matches and extended lengths.
+  std::vector<uint8_t> runs(70000, 'a');
+  for (size_t i = 0; i < runs.size(); i += 1000) {
+    runs[i] = static_cast<uint8_t>(i);
+  }
+  EXPECT_EQ(runs, RoundTrip(runs));
+}
+
+TEST(CompressionTest, AccelerationTradesRatio) {
+  const auto text = TextBytes(100000);
+  std::vector<uint8_t> out(Lz4CompressBound(text.size()));
+  const size_t normal = Lz4Compress(text.data(), text.size(), out.data(),
+                                    out.size(), 1);
+  const size_t fast = Lz4Compress(text.data(), text.size(), out.data(),
+                                  out.size(), 16);
+  EXPECT_LT(normal, text.size() / 2);
+  EXPECT_GE(fast, normal);
+  std::vector<uint8_t> back(text.size());
+  ASSERT_TRUE(Lz4Decompress(out.data(), fast, back.data(), back.size()));
+  EXPECT_EQ(text, back);
+}
+
+TEST(CompressionTest, RejectsSmallCapacity) {
+  const auto random = RandomBytes(4096, 1);
+  std::vector<uint8_t> out(4096);
+  EXPECT_EQ(0u, Lz4Compress(random.data(), random.size(), out.data(),
+                            out.size()));
+}
+
+TEST(CompressionTest, RejectsCorruptInput) {
+  const auto text = TextBytes(10000);
+  std::vector<uint8_t> compressed(Lz4CompressBound(text.size()));
+  compressed.resize(Lz4Compress(text.data(), text.size(), compressed.data(),
+                                compressed.size()));
+  ASSERT_FALSE(compressed.empty());
+  std::vector<uint8_t> out(text.size());
+
+  // Wrong raw length either way.
+  EXPECT_FALSE(Lz4Decompress(compressed.data(), compressed.size(),
+                             out.data(), out.size() - 1));
+  std::vector<uint8_t> larger(text.size() + 1);
+  EXPECT_FALSE(Lz4Decompress(compressed.data(), compressed.size(),
+                             larger.data(), larger.size()));
+  // Truncated block.
+  EXPECT_FALSE(Lz4Decompress(compressed.data(), compressed.size() - 1,
+                             out.data(), out.size()));
+  // A match reaching back before the start of the output.
+  const uint8_t bad_offset[] = {0x10, 'x', 0x05, 0x00, 0x00};
+  EXPECT_FALSE(Lz4Decompress(bad_offset, sizeof(bad_offset), out.data(), 10));
+  // A literal length running past the end of the input.
+  const uint8_t bad_length[] = {0xf0, 0xff, 0xff};
+  EXPECT_FALSE(Lz4Decompress(bad_length, sizeof(bad_length), out.data(),
+                             out.size()));
+
+  // Random damage is either rejected or decodes within bounds; run under a
+  // sanitizer to catch out-of-range access.
+  std::mt19937 rng(5);
+  for (int i = 0; i < 500; i++) {
+    std::vector<uint8_t> damaged = compressed;
+    damaged[rng() % damaged.size()] ^= static_cast<uint8_t>(1 + rng() % 255);
+    Lz4Decompress(damaged.data(), damaged.size(), out.data(), out.size());
+  }
+}
+
+TEST(CompressionTest, DecodesReferenceBlock) {
+  // "abcabcabcabcabcabcabcab!" as produced by the reference lz4 tool: three
+  // literals, a 16-byte match at offset 3, then five literals.
+  const uint8_t block[] = {0x3c, 'a', 'b', 'c', 0x03, 0x00,
+                           0x50, 'b', 'c', 'a', 'b',  '!'};
+  const std::string expected = "abcabcabcabcabcabcabcab!";
+  std::vector<uint8_t> out(expected.size());
+  ASSERT_TRUE(Lz4Decompress(block, sizeof(block), out.data(), out.size()));
+  EXPECT_EQ(expected, std::string(out.begin(), out.end()));
+}
+
+TEST(CompressionTest, EntropyProbeSeparatesTextFromNoise) {
+  const auto text = TextBytes(1 << 20);
+  const auto random = RandomBytes(1 << 20, 2);
+  const std::vector<uint8_t> zeros(1 << 20, 0);
+  EXPECT_LT(EstimateEntropy(text.data(), text.size()), 5.0);
+  EXPECT_GT(EstimateEntropy(random.data(), random.size()),
+            kIncompressibleEntropy);
+  EXPECT_EQ(0.0, EstimateEntropy(zeros.data(), zeros.size()));
+}
+
+TEST(CompressionTest, CompressChunkSkipsIncompressibleData) {
+  const auto random = RandomBytes(8192, 4);
+  std::vector<uint8_t> out(Lz4CompressBound(random.size()));
+  EXPECT_EQ(0u, CompressChunk(random.data(), random.size(), out.data(),
+                              out.size()));
+
+  const auto text = TextBytes(8192);
+  const size_t size =
+      CompressChunk(text.data(), text.size(), out.data(), out.size());
+  ASSERT_NE(0u, size);
+  EXPECT_LE(size, text.size() - text.size() / 16);
+  std::vector<uint8_t> back(text.size());
+  ASSERT_TRUE(Lz4Decompress(out.data(), size, back.data(), back.size()));
+  EXPECT_EQ(text, back);
+}
+
+TEST(CompressionTest, FrameCarriesRawLength) {
+  const auto text = TextBytes(8192);
+  std::vector<uint8_t> frame(kFrameHeaderSize + text.size());
+  FrameHeader header;
+  header.flags = kFrameFlagCompressed;
+  header.raw_length = static_cast<uint32_t>(text.size());
+  header.length = static_cast<uint32_t>(
+      CompressChunk(text.data(), text.size(), frame.data() + kFrameHeaderSize,
+                    text.size()));
+  ASSERT_NE(0u, header.length);
+  frame.resize(kFrameHeaderSize + header.length);
+  ASSERT_EQ(frame.size(), EncodeFrame(header, frame.data() + kFrameHeaderSize,
+                                      frame.data(), frame.size()));
+
+  FrameHeader decoded;
+  const uint8_t* payload = nullptr;
+  ASSERT_TRUE(DecodeFrame(frame.data(), frame.size(), &decoded, &payload));
+  EXPECT_EQ(text.size(), decoded.raw_length);
+  std::vector<uint8_t> back(decoded.raw_length);
+  ASSERT_TRUE(Lz4Decompress(payload, decoded.length, back.data(),
+                            back.size()));
+  EXPECT_EQ(text, back);
+
+  // The raw length must be present exactly when the flag is.
+  frame[3] &= static_cast<uint8_t>(~kFrameFlagCompressed);
+  EXPECT_FALSE(DecodeFrame(frame.data(), frame.size(), &decoded, &payload));
+}
+
+}  // namespace
+}  // namespace sc
@@ -0,0 +1,138 @@
+#include "content_chunker.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "testing/temp_path.h"
+
+namespace sc {
+namespace {
+
+std::vector<uint8_t> RandomBytes(size_t size, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> data(size);
+  for (auto& byte : data) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  return data;
+}
+
+std::vector<size_t> Split(const ContentChunker& chunker,
+                          const std::vector<uint8_t>& data) {
+  std::vector<size_t> lengths;
+  for (size_t offset = 0; offset < data.size();) {
+    const size_t length =
+        chunker.Cut(data.data() + offset, data.size() - offset);
+    lengths.push_back(length);
+    offset += length;
+  }
+  return lengths;
+}
+
+// Chunk boundaries as absolute offsets.
+std::set<size_t> Boundaries(const std::vector<size_t>& lengths) {
+  std::set<size_t> boundaries;
+  size_t offset = 0;
+  for (size_t length : lengths) {
+    offset += length;
+    boundaries.insert(offset);
+  }
+  return boundaries;
+}
+
+TEST(ContentChunkerTest, MatchesByteWiseReference) {
+  const auto data = RandomBytes(4 << 20, 1);
+  // Odd sizes exercise the single-byte tail of the two-byte loop.
+  for (const ContentChunker& chunker :
+       {ContentChunker(), ContentChunker(2048, 8192, 32768),
+        ContentChunker(1001, 4001, 16001)}) {
+    for (size_t offset = 0; offset < data.size();) {
+      const size_t remaining = data.size() - offset;
+      const size_t cut = chunker.Cut(data.data() + offset, remaining);
+      ASSERT_EQ(chunker.CutReference(data.data() + offset, remaining), cut)
+          << "offset " << offset;
+      offset += cut;
+    }
+  }
+}
+
+TEST(ContentChunkerTest, RespectsSizeLimits) {
+  const ContentChunker chunker;
+  const auto data = RandomBytes(16 << 20, 2);
+  const auto lengths = Split(chunker, data);
+  for (size_t i = 0; i + 1 < lengths.size(); i++) {
+    EXPECT_GE(lengths[i], chunker.min_size());
+    EXPECT_LE(lengths[i], chunker.max_size());
+  }
+  // Normalized chunking keeps the mean near the target.
+  const double mean = static_cast<double>(data.size()) / lengths.size();
+  EXPECT_GT(mean, 0.75 * chunker.average_size());
+  EXPECT_LT(mean, 1.5 * chunker.average_size());
+
+  // Data without any cut points is split at the maximum size.
+  const std::vector<uint8_t> zeros(1 << 20, 0);
+  for (size_t length : Split(chunker, zeros)) {
+    EXPECT_EQ(chunker.max_size(), length);
+  }
+}
+
+TEST(ContentChunkerTest, EditOnlyChangesNearbyChunks) {
+  const ContentChunker chunker;
+  auto original = RandomBytes(8 << 20, 3);
+  auto edited = original;
+  // Insert a few bytes in the middle, shifting everything after them.
+  const size_t edit_at = 3 << 20;
+  const std::vector<uint8_t> inserted = {1, 2, 3, 4, 5, 6, 7};
+  edited.insert(edited.begin() + edit_at, inserted.begin(), inserted.end());
+
+  const auto before = Boundaries(Split(chunker, original));
+  std::set<size_t> after;
+  for (size_t boundary : Boundaries(Split(chunker, edited))) {
+    after.insert(boundary > edit_at ? boundary - inserted.size() : boundary);
+  }
+  size_t shared = 0;
+  for (size_t boundary : before) {
+    shared += after.count(boundary);
+  }
+  // All but the chunks around the edit line up again.
+  EXPECT_GE(shared + 3, before.size());
+}
+
+TEST(ContentChunkerTest, ChunksFileWithDigests) {
+  const std::string path =
+      testing::UniqueTempPath("content_chunker_test", ".bin");
+  const auto data = RandomBytes(1 << 20, 4);
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(data.data()),
+              static_cast<std::streamsize>(data.size()));
+  }
+  ChunkSource source;
+  ASSERT_TRUE(source.Open(path));
+  const ContentChunker chunker;
+
+  uint64_t offset = 0;
+  uint32_t length = 0;
+  uint8_t digest[Sha256::kDigestSize];
+  while (chunker.Next(&source, offset, &length, digest)) {
+    EXPECT_EQ(chunker.Cut(data.data() + offset, data.size() - offset), length);
+    uint8_t expected[Sha256::kDigestSize];
+    Sha256 hasher;
+    hasher.Update(data.data() + offset, length);
+    hasher.Finish(expected);
+    EXPECT_EQ(Sha256::ToHex(expected), Sha256::ToHex(digest));
+    offset += length;
+  }
+  EXPECT_EQ(data.size(), offset);
+  source.Close();
+  std::remove(path.c_str());
+}
+
+}  // namespace
+}  // namespace sc
@@ -0,0 +1,210 @@
+#include "file_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sc_native_api.h"
+#include "testing/temp_path.h"
+
+namespace sc {
+namespace {
+
+class FileWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = testing::UniqueTempPath("file_writer_test", ".bin");
+    std::remove(path_.c_str());
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  std::vector<uint8_t> ReadBack() const {
+    std::ifstream in(path_, std::ios::binary | std::ios::ate);
+    std::vector<uint8_t> data(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+    return data;
+  }
+
+  void WriteFile(const std::vector<uint8_t>& data) const {
+    std::ofstream out(path_, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(data.data()),
+              static_cast<std::streamsize>(data.size()));
+  }
+
+  std::string path_;
+};
+
+std::vector<uint8_t> Pattern(size_t size) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = static_cast<uint8_t>((i * 131) ^ (i >> 11));
+  }
+  return data;
+}
+
+TEST_F(FileWriterTest, WritesSequentialChunks) {
+  const auto contents = Pattern(3 * FileWriter::kExtentSize + 4321);
+  FileWriter writer;
+  ASSERT_TRUE(writer.Open(path_, contents.size()));
+  for (size_t offset = 0; offset < contents.size(); offset += 8192) {
+    const size_t length = std::min<size_t>(8192, contents.size() - offset);
+    // A conforming sender waits for credit; here, wait for the disk.
+    while (!writer.Write(offset, contents.data() + offset, length)) {
+      ASSERT_FALSE(writer.failed());
+      writer.Flush();
+    }
+  }
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_EQ(contents.size(), writer.written());
+  EXPECT_EQ(0u, writer.queued());
+  EXPECT_TRUE(writer.Close());
+  EXPECT_EQ(contents, ReadBack());
+}
+
+TEST_F(FileWriterTest, WritesOutOfOrder) {
+  const auto contents = Pattern(200000);
+  std::vector<size_t> offsets;
+  for (size_t offset = 0; offset < contents.size(); offset += 10000) {
+    offsets.push_back(offset);
+  }
+  std::shuffle(offsets.begin(), offsets.end(), std::mt19937(7));
+  FileWriter writer;
+  ASSERT_TRUE(writer.Open(path_, contents.size()));
+  for (size_t offset : offsets) {
+    ASSERT_TRUE(writer.Write(offset, contents.data() + offset,
+                             std::min<size_t>(10000, contents.size() - offset)));
+  }
+  EXPECT_TRUE(writer.Close());
+  EXPECT_EQ(contents, ReadBack());
+}
+
+TEST_F(FileWriterTest, KeepsResumedPrefix) {
+  const auto contents = Pattern(100000);
+  // The prefix is intact; the tail after it is stale and must go.
+  std::vector<uint8_t> partial(contents.begin(), contents.begin() + 60000);
+  partial.resize(80000, 0xee);
+  WriteFile(partial);
+
+  FileWriter writer;
+  EXPECT_FALSE(writer.Open(path_, contents.size(), 90000));
+  ASSERT_TRUE(writer.Open(path_, contents.size(), 60000));
+  ASSERT_TRUE(writer.Write(60000, contents.data() + 60000, 40000));
+  EXPECT_TRUE(writer.Close());
+  EXPECT_EQ(contents, ReadBack());
+}
+
+TEST_F(FileWriterTest, ReservesSpaceWithoutGrowingTheFile) {
+  FileWriter writer;
+  ASSERT_TRUE(writer.Open(path_, 64 * 1024 * 1024));
+  const auto head = Pattern(1000);
+  ASSERT_TRUE(writer.Write(0, head.data(), head.size()));
+  ASSERT_TRUE(writer.Flush());
+  // Readers see only what was written, whether or not space was reserved.
+  EXPECT_EQ(head, ReadBack());
+  EXPECT_TRUE(writer.Close());
+  EXPECT_EQ(head, ReadBack());
+}
+
+TEST_F(FileWriterTest, RefusesWritesBeyondThePool) {
+  const auto extent = Pattern(FileWriter::kExtentSize);
+  FileWriter writer;
+  ASSERT_TRUE(writer.Open(path_, 0, 0, 2 * FileWriter::kExtentSize));
+  // Non-adjacent writes each take an extent of their own, so the third
+  // cannot be queued until the disk catches up.
+  size_t accepted = 0;
+  for (int i = 0; i < 3; i++) {
+    if (writer.Write(static_cast<uint64_t>(i) * 3 * extent.size(),
+                     extent.data(), extent.size())) {
+      accepted++;
+    }
+  }
+  EXPECT_GE(accepted, 2u);
+  ASSERT_TRUE(writer.Flush());
+  EXPECT_TRUE(writer.Write(9 * extent.size(), extent.data(), extent.size()));
+  EXPECT_TRUE(writer.Close());
+  EXPECT_EQ(10 * extent.size(), ReadBack().size());
+}
+
+TEST_F(FileWriterTest, SharesOneWorkerAcrossWriters) {
+  constexpr int kFiles = 6;
+  WriteWorker worker(4 * FileWriter::kExtentSize);
+  std::vector<std::vector<uint8_t>> contents;
+  std::vector<std::unique_ptr<FileWriter>> writers;
+  for (int i = 0; i < kFiles; i++) {
+    contents.push_back(Pattern(FileWriter::kExtentSize + 5000 * (i + 1)));
+    writers.push_back(std::make_unique<FileWriter>());
+    ASSERT_TRUE(writers.back()->Open(path_ + std::to_string(i),
+                                     contents.back().size(), 0,
+                                     FileWriter::kDefaultPoolSize, &worker));
+  }
+  // Interleave the files as a sender does, waiting for the disk when the
+  // shared pool is full.
+  for (size_t offset = 0;; offset += 8192) {
+    bool any = false;
+    for (int i = 0; i < kFiles; i++) {
+      if (offset >= contents[i].size()) {
+        continue;
+      }
+      any = true;
+      const size_t length =
+          std::min<size_t>(8192, contents[i].size() - offset);
+      while (!writers[i]->Write(offset, contents[i].data() + offset, length)) {
+        ASSERT_FALSE(writers[i]->failed());
+        for (auto& writer : writers) {
+          writer->Flush();
+        }
+      }
+    }
+    if (!any) {
+      break;
+    }
+  }
+  for (int i = 0; i < kFiles; i++) {
+    EXPECT_TRUE(writers[i]->Close());
+    std::ifstream in(path_ + std::to_string(i), std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents[i], data);
+    std::remove((path_ + std::to_string(i)).c_str());
+  }
+}
+
+TEST_F(FileWriterTest, CApiRoundTrip) {
+  const auto contents = Pattern(50000);
+  ScFileWriter* writer =
+      sc_file_writer_open(path_.c_str(), contents.size(), 0, 0);
+  ASSERT_NE(nullptr, writer);
+  EXPECT_EQ(0, sc_file_writer_write(writer, 25000, contents.data() + 25000,
+                                    25000));
+  EXPECT_EQ(0, sc_file_writer_write(writer, 0, contents.data(), 25000));
+  EXPECT_EQ(0, sc_file_writer_failed(writer));
+  EXPECT_EQ(0, sc_file_writer_close(writer));
+  EXPECT_EQ(contents, ReadBack());
+  EXPECT_EQ(nullptr, sc_file_writer_open("/nonexistent/dir/file", 1, 0, 0));
+}
+
+TEST_F(FileWriterTest, CApiSharedWorker) {
+  const auto contents = Pattern(50000);
+  ScWriteWorker* worker = sc_write_worker_create(0);
+  ASSERT_NE(nullptr, worker);
+  ScFileWriter* writer =
+      sc_file_writer_open_on(worker, path_.c_str(), contents.size(), 0);
+  ASSERT_NE(nullptr, writer);
+  EXPECT_EQ(0, sc_file_writer_write(writer, 0, contents.data(), 50000));
+  EXPECT_EQ(0, sc_file_writer_close(writer));
+  sc_write_worker_destroy(worker);
+  EXPECT_EQ(contents, ReadBack());
+}
+
+}  // namespace
+}  // namespace sc
@@ -0,0 +1,137 @@
+#include "flow_control.h"
+
+#include <gtest/gtest.h>
+
+#include "testing/link_simulator.h"
+#include "testing/transfer_simulation.h"
+
+namespace sc {
+namespace {
+
+using ::sc::testing::LinkSimulator;
+using ::sc::testing::SimulateTransfer;
+using ::sc::testing::TransferSimulationConfig;
+using ::sc::testing::TransferSimulationResult;
+
+TransferSimulationResult RunTransfer(const LinkSimulator::Config& link,
+                                     uint64_t total, double write_rate = 0) {
+  TransferSimulationConfig config;
+  config.link = link;
+  config.total_bytes = total;
+  config.write_rate = write_rate;
+  return SimulateTransfer(config);
+}
+
+TEST(CreditSenderTest, RespectsCreditWindowAndBufferCap) {
+  CreditSender::Options options;
+  options.initial_window = 512 * 1024;
+  options.max_buffered = 300 * 1024;
+  CreditSender sender(options);
+
+  EXPECT_EQ(0u, sender.Available(0));  // no credit yet
+  sender.OnCredit(0, 100 * 1024, 0);
+  EXPECT_EQ(100u * 1024, sender.Available(0));
+  sender.OnCredit(0, 10 * 1024 * 1024, 0);
+  EXPECT_EQ(300u * 1024, sender.Available(0));
+  EXPECT_EQ(200u * 1024, sender.Available(100 * 1024));
+  sender.OnSent(400 * 1024, 0);
+  EXPECT_EQ(112u * 1024, sender.Available(0));
+  sender.OnSent(112 * 1024, 0);
+  EXPECT_EQ(0u, sender.Available(0));
+}
+
+TEST(CreditSenderTest, IgnoresStaleGrants) {
+  CreditSender sender;
+  sender.OnCredit(0, 4 * 1024 * 1024, 0);
+  sender.OnSent(512 * 1024, 0);
+  sender.OnSent(512 * 1024, 0);
+  sender.OnCredit(512 * 1024, 5 * 1024 * 1024, 10000);
+  sender.OnCredit(256 * 1024, 4 * 1024 * 1024, 11000);
+  EXPECT_EQ(512u * 1024, sender.consumed());
+  EXPECT_EQ(5u * 1024 * 1024, sender.limit());
+  EXPECT_EQ(10000u, sender.min_rtt_us());
+}
+
+TEST(CreditReceiverTest, BatchesGrants) {
+  CreditReceiver receiver(1024 * 1024, 64 * 1024);
+  EXPECT_EQ(1024u * 1024, receiver.limit());
+  EXPECT_FALSE(receiver.OnConsumed(32 * 1024));
+  EXPECT_TRUE(receiver.OnConsumed(32 * 1024));
+  EXPECT_FALSE(receiver.OnConsumed(63 * 1024));
+  EXPECT_TRUE(receiver.OnConsumed(1024));
+  // Consumed but not yet released bytes do not extend the limit.
+  EXPECT_EQ(1024u * 1024, receiver.limit());
+  EXPECT_FALSE(receiver.OnReleased(60 * 1024));
+  EXPECT_TRUE(receiver.OnReleased(68 * 1024));
+  EXPECT_EQ(1024u * 1024 + 128 * 1024, receiver.limit());
+}
+
+TEST(FlowControlSimulationTest, FillsHighLatencyLink) {
+  LinkSimulator::Config link;
+  link.bandwidth_bytes_per_sec = 12.5e6;
+  link.one_way_delay_us = 50000;  // 100 ms round trip
+  const TransferSimulationResult result = RunTransfer(link, 64ull * 1024 * 1024);
+  ASSERT_TRUE(result.completed);
+  EXPECT_TRUE(result.data_intact);
+  // Stop-and-wait every 100 chunks peaks at 800 KiB per round trip, about
+  // 65% of this link.
+  EXPECT_GT(result.throughput(), 0.85 * link.bandwidth_bytes_per_sec);
+  EXPECT_GE(result.sender.min_rtt_us(), 100000u);
+  EXPECT_LT(result.sender.min_rtt_us(), 130000u);
+  EXPECT_EQ(0u, result.max_in_flight_over_window);
+}
+
+TEST(FlowControlSimulationTest, KeepsWindowSmallOnShortLink) {
+  LinkSimulator::Config link;
+  link.one_way_delay_us = 500;
+  const TransferSimulationResult result = RunTransfer(link, 16ull * 1024 * 1024);
+  ASSERT_TRUE(result.completed);
+  EXPECT_GT(result.throughput(), 0.85 * link.bandwidth_bytes_per_sec);
+  // The BDP here is ~12 KB. Grant batching adds about one grant interval
+  // of delay, so the window settles a little above its floor instead of
+  // queueing megabytes in the channel.
+  EXPECT_LT(result.sender.window(), 2 * CreditSender::Options().min_window);
+}
+
+TEST(FlowControlSimulationTest, SlowReceiverBoundsBuffering) {
+  LinkSimulator::Config link;
+  link.one_way_delay_us = 10000;
+  const double write_rate = 2e6;
+  const uint64_t total = 40ull * 1024 * 1024;
+  const TransferSimulationResult result = RunTransfer(link, total, write_rate);
+  ASSERT_TRUE(result.completed);
+  EXPECT_LE(result.max_receive_buffer, CreditReceiver::kDefaultWindow);
+  EXPECT_GT(result.throughput(), 0.9 * write_rate);
+}
+
+TEST(FlowControlSimulationTest, CompletesOverLossyLink) {
+  LinkSimulator::Config link;
+  link.one_way_delay_us = 40000;
+  link.loss_rate = 0.02;
+  link.retransmit_delay_us = 200000;
+  const TransferSimulationResult result = RunTransfer(link, 32ull * 1024 * 1024);
+  ASSERT_TRUE(result.completed);
+  EXPECT_TRUE(result.data_intact);
+  EXPECT_GT(result.throughput(), 0.3 * link.bandwidth_bytes_per_sec);
+}
+
+TEST(FlowControlSimulationTest, CarriesPayloadIntactOverStripedLossyLink) {
+  TransferSimulationConfig config;
+  config.link.one_way_delay_us = 5000;
+  config.link.loss_rate = 0.01;
+  config.link.retransmit_delay_us = 30000;
+  config.total_bytes = 8ull * 1024 * 1024 + 123;
+  config.channels = 4;
+  config.carry_payload = true;
+  const TransferSimulationResult result = SimulateTransfer(config);
+  ASSERT_TRUE(result.completed);
+  EXPECT_TRUE(result.data_intact);
+  EXPECT_GE(result.latency_p50_us, config.link.one_way_delay_us);
+  EXPECT_LE(result.latency_p50_us, result.latency_p99_us);
+  EXPECT_LE(result.latency_p99_us, result.latency_max_us);
+  // Some chunk waited out a retransmission.
+  EXPECT_GE(result.latency_max_us, config.link.retransmit_delay_us);
+}
+
+}  // namespace
+}  // namespace sc
@@ -0,0 +1,146 @@
+#include "frame_codec.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "sc_native_api.h"
+
+namespace sc {
+namespace {
+
+FrameHeader MakeHeader(uint32_t length) {
+  FrameHeader header;
+  header.flags = kFrameFlagLast;
+  header.file_index = 3;
+  header.session_id = 1717171717171717ull;
+  header.offset = (1ull << 40) + 8192;
+  header.length = length;
+  return header;
+}
+
+TEST(FrameCodecTest, RoundTripsHeaderAndPayload) {
+  const std::vector<uint8_t> payload = {1, 2, 3, 4, 5, 250, 251};
+  std::vector<uint8_t> frame(kFrameHeaderSize + payload.size());
+  const FrameHeader header = MakeHeader(static_cast<uint32_t>(payload.size()));
+
+  ASSERT_EQ(frame.size(),
+            EncodeFrame(header, payload.data(), frame.data(), frame.size()));
+
+  FrameHeader decoded;
+  const uint8_t* decoded_payload = nullptr;
+  ASSERT_TRUE(DecodeFrame(frame.data(), frame.size(), &decoded,
+                          &decoded_payload));
+  EXPECT_EQ(header.flags, decoded.flags);
+  EXPECT_EQ(header.file_index, decoded.file_index);
+  EXPECT_EQ(header.session_id, decoded.session_id);
+  EXPECT_EQ(header.offset, decoded.offset);
+  EXPECT_EQ(header.length, decoded.length);
+  EXPECT_EQ(payload, std::vector<uint8_t>(decoded_payload,
+                                          decoded_payload + decoded.length));
+}
+
+TEST(FrameCodecTest, HeaderIsLittleEndian) {
+  uint8_t out[kFrameHeaderSize];
+  FrameHeader header;
+  header.file_index = 0x01020304;
+  header.length = 0x0a0b0c0d;
+  WriteFrameHeader(header, out);
+  EXPECT_EQ('S', out[0]);
+  EXPECT_EQ('C', out[1]);
+  EXPECT_EQ(kFrameVersion, out[2]);
+  EXPECT_EQ(0x04, out[4]);
+  EXPECT_EQ(0x01, out[7]);
+  EXPECT_EQ(0x0d, out[24]);
+  EXPECT_EQ(0x0a, out[27]);
+}
+
+TEST(FrameCodecTest, EncodesInPlacePayload) {
+  std::vector<uint8_t> frame(kFrameHeaderSize + 4, 0);
+  frame[kFrameHeaderSize] = 9;
+  frame[kFrameHeaderSize + 3] = 7;
+  const FrameHeader header = MakeHeader(4);
+  ASSERT_EQ(frame.size(), EncodeFrame(header, frame.data() + kFrameHeaderSize,
+                                      frame.data(), frame.size()));
+  EXPECT_EQ(9, frame[kFrameHeaderSize]);
+  EXPECT_EQ(7, frame[kFrameHeaderSize + 3]);
+}
+
+TEST(FrameCodecTest, RejectsSmallCapacity) {
+  std::vector<uint8_t> payload(16, 1);
+  std::vector<uint8_t> frame(kFrameHeaderSize + 15);
+  EXPECT_EQ(0u, EncodeFrame(MakeHeader(16), payload.data(), frame.data(),
+                            frame.size()));
+}
+
+TEST(FrameCodecTest, RejectsMalformedFrames) {
+  std::vector<uint8_t> frame(kFrameHeaderSize + 8);
+  const std::vector<uint8_t> payload(8, 0x55);
+  ASSERT_NE(0u, EncodeFrame(MakeHeader(8), payload.data(), frame.data(),
+                            frame.size()));
+  FrameHeader header;
+  const uint8_t* out_payload = nullptr;
+
+  // Truncated payload.
+  EXPECT_FALSE(DecodeFrame(frame.data(), frame.size() - 1, &header,
+                           &out_payload));
+  // Shorter than a header.
+  EXPECT_FALSE(DecodeFrame(frame.data(), kFrameHeaderSize - 1, &header,
+                           &out_payload));
+
+  std::vector<uint8_t> bad_magic = frame;
+  bad_magic[0] ^= 0xff;
+  EXPECT_FALSE(DecodeFrame(bad_magic.data(), bad_magic.size(), &header,
+                           &out_payload));
+
+  std::vector<uint8_t> bad_version = frame;
+  bad_version[2] = kFrameVersion + 1;
+  EXPECT_FALSE(DecodeFrame(bad_version.data(), bad_version.size(), &header,
+                           &out_payload));
+
+  std::vector<uint8_t> bad_reserved = frame;
+  bad_reserved[30] = 1;
+  EXPECT_FALSE(DecodeFrame(bad_reserved.data(), bad_reserved.size(), &header,
+                           &out_payload));
+
+  // Compressed, but claiming more than any frame can expand to.
+  FrameHeader huge = MakeHeader(8);
+  huge.flags |= kFrameFlagCompressed;
+  huge.raw_length = kMaxFrameRawLength + 1;
+  std::vector<uint8_t> oversized(kFrameHeaderSize + 8);
+  ASSERT_NE(0u, EncodeFrame(huge, payload.data(), oversized.data(),
+                            oversized.size()));
+  EXPECT_FALSE(DecodeFrame(oversized.data(), oversized.size(), &header,
+                           &out_payload));
+  huge.raw_length = kMaxFrameRawLength;
+  ASSERT_NE(0u, EncodeFrame(huge, payload.data(), oversized.data(),
+                            oversized.size()));
+  EXPECT_TRUE(DecodeFrame(oversized.data(), oversized.size(), &header,
+                          &out_payload));
+}
+
+TEST(FrameCodecTest, CApiReadsCopiedHeader) {
+  ScFrameHeader in = {};
+  in.session_id = 42;
+  in.offset = 65536;
+  in.file_index = 2;
+  in.length = 100;
+  in.flags = kFrameFlagLast;
+  uint8_t header_bytes[kFrameHeaderSize];
+  sc_frame_write_header(&in, header_bytes);
+
+  ScFrameHeader out = {};
+  EXPECT_EQ(static_cast<int32_t>(kFrameHeaderSize),
+            sc_frame_read_header(header_bytes, kFrameHeaderSize + 100, &out));
+  EXPECT_EQ(42u, out.session_id);
+  EXPECT_EQ(65536u, out.offset);
+  EXPECT_EQ(2u, out.file_index);
+  EXPECT_EQ(100u, out.length);
+  EXPECT_EQ(static_cast<uint32_t>(kFrameFlagLast), out.flags);
+
+  EXPECT_EQ(-1, sc_frame_read_header(header_bytes, kFrameHeaderSize + 99,
+                                     &out));
+}
+
+}  // namespace
+}  // namespace sc
@@ -0,0 +1,232 @@
+#include "ring_logger.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sc_native_api.h"
+#include "testing/temp_path.h"
+
+namespace sc {
+namespace {
+
+class RingLoggerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = testing::UniqueTempPath("ring_logger_test", ".log");
+    RemoveAll();
+  }
+
+  void TearDown() override { RemoveAll(); }
+
+  void RemoveAll() const {
+    std::remove(path_.c_str());
+    for (int i = 1; i <= 4; i++) {
+      std::remove((path_ + "." + std::to_string(i)).c_str());
+    }
+  }
+
+  static std::vector<std::string> ReadLines(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+      lines.push_back(line);
+    }
+    return lines;
+  }
+
+  // The line without its "YYYY-MM-DDTHH:MM:SS.mmmZ " timestamp.
+  static std::string Body(const std::string& line) {
+    return line.size() > 25 ? line.substr(25) : std::string();
+  }
+
+  std::string path_;
+};
+
+bool Write(RingLogger* logger, RingLogger::Level level,
+           const std::string& message) {
+  return logger->Write(level, message.data(), message.size());
+}
+
+TEST_F(RingLoggerTest, WritesTimestampedLines) {
+  RingLogger logger;
+  ASSERT_TRUE(logger.Open(path_));
+  EXPECT_TRUE(Write(&logger, RingLogger::kInfo, "TAG: hello"));
+  EXPECT_TRUE(Write(&logger, RingLogger::kError, "TAG: failed - {x: 1}"));
+  logger.Flush();
+
+  const auto lines = ReadLines(path_);
+  ASSERT_EQ(lines.size(), 2u);
+  EXPECT_EQ(Body(lines[0]), "I TAG: hello");
+  EXPECT_EQ(Body(lines[1]), "E TAG: failed - {x: 1}");
+  // 2024-01-01T00:00:00.000Z
+  const std::string& line = lines[0];
+  EXPECT_EQ(line[4], '-');
+  EXPECT_EQ(line[10], 'T');
+  EXPECT_EQ(line[19], '.');
+  EXPECT_EQ(line[23], 'Z');
+  EXPECT_GE(line.substr(0, 4), "2024");
+}
+
+TEST_F(RingLoggerTest, AppendsToAnExistingFile) {
+  {
+    std::ofstream out(path_, std::ios::binary);
+    out << "earlier\n";
+  }
+  RingLogger logger;
+  ASSERT_TRUE(logger.Open(path_));
+  Write(&logger, RingLogger::kWarn, "later");
+  logger.Close();
+
+  const auto lines = ReadLines(path_);
+  ASSERT_EQ(lines.size(), 2u);
+  EXPECT_EQ(lines[0], "earlier");
+  EXPECT_EQ(Body(lines[1]), "W later");
+}
+
+TEST_F(RingLoggerTest, SkipsRecordsBelowTheLevel) {
+  RingLogger logger;
+  ASSERT_TRUE(logger.Open(path_));
+  logger.set_level(RingLogger::kInfo);
+  EXPECT_FALSE(logger.enabled(RingLogger::kDebug));
+  EXPECT_FALSE(Write(&logger, RingLogger::kDebug, "hidden"));
+  EXPECT_TRUE(Write(&logger, RingLogger::kInfo, "shown"));
+  logger.Close();
+
+  const auto lines = ReadLines(path_);
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_EQ(Body(lines[0]), "I shown");
+  EXPECT_EQ(logger.dropped(), 0u);
+}
+
+TEST_F(RingLoggerTest, CutsOffLongMessages) {
+  RingLogger logger;
+  ASSERT_TRUE(logger.Open(path_));
+  Write(&logger, RingLogger::kInfo,
+        std::string(RingLogger::kMaxMessageSize + 500, 'x'));
+  logger.Close();
+
+  const auto lines = ReadLines(path_);
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_EQ(Body(lines[0]),
+            "I " + std::string(RingLogger::kMaxMessageSize, 'x'));
+}
+
+TEST_F(RingLoggerTest, CutsOffLongMessagesBetweenCodePoints) {
+  RingLogger logger;
+  ASSERT_TRUE(logger.Open(path_));
+  // A two-byte "\xC3\xA9" straddles the limit.
+  const std::string prefix(RingLogger::kMaxMessageSize - 1, 'x');
+  Write(&logger, RingLogger::kInfo, prefix + "\xC3\xA9" + "tail");
+  logger.Close();
+
+  const auto lines = ReadLines(path_);
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_EQ(Body(lines[0]), "I " + prefix);
+}
+
+TEST_F(RingLoggerTest, DropsAndReportsRecordsWhenFull) {
+  RingLogger logger;
+  // The worker only wakes on its own after an hour, or when the ring is
+  // half full, which it cannot drain before the burst ends.
+  ASSERT_TRUE(logger.Open(path_, RingLogger::kDefaultMaxFileSize, 0, 8,
+                          std::chrono::hours(1)));
+  size_t written = 0;
+  for (int i = 0; i < 1000; i++) {
+    if (Write(&logger, RingLogger::kInfo, "record " + std::to_string(i))) {
+      written++;
+    }
+  }
+  EXPECT_EQ(written + logger.dropped(), 1000u);
+  EXPECT_GT(logger.dropped(), 0u);
+  logger.Close();
+
+  const auto lines = ReadLines(path_);
+  ASSERT_EQ(lines.size(), written + 1);
+  EXPECT_EQ(Body(lines.back()),
+            "W " + std::to_string(logger.dropped()) + " log records dropped");
+}
+
+TEST_F(RingLoggerTest, RotatesFullFiles) {
+  RingLogger logger;
+  ASSERT_TRUE(logger.Open(path_, 100, 2));
+  const std::string message(80, 'a');  // one line is 109 bytes
+  for (int i = 0; i < 4; i++) {
+    Write(&logger, RingLogger::kInfo, message + std::to_string(i));
+    // One batch per line, so each fills a file.
+    logger.Flush();
+  }
+  logger.Close();
+
+  // Lines 0 and 1 went into files that rotated away; the oldest fell off.
+  const auto current = ReadLines(path_);
+  const auto first = ReadLines(path_ + ".1");
+  const auto second = ReadLines(path_ + ".2");
+  EXPECT_TRUE(current.empty());
+  ASSERT_EQ(first.size(), 1u);
+  ASSERT_EQ(second.size(), 1u);
+  EXPECT_EQ(Body(first[0]), "I " + message + "3");
+  EXPECT_EQ(Body(second[0]), "I " + message + "2");
+  EXPECT_FALSE(std::ifstream(path_ + ".3").good());
+}
+
+TEST_F(RingLoggerTest, KeepsEveryRecordFromConcurrentWriters) {
+  RingLogger logger;
+  ASSERT_TRUE(logger.Open(path_, 0, 0, 1 << 16));
+  constexpr int kThreads = 4;
+  constexpr int kRecords = 5000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&logger, t] {
+      for (int i = 0; i < kRecords; i++) {
+        Write(&logger, RingLogger::kDebug,
+              std::to_string(t) + ":" + std::to_string(i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  logger.Close();
+  ASSERT_EQ(logger.dropped(), 0u);
+
+  std::set<std::string> seen;
+  for (const auto& line : ReadLines(path_)) {
+    seen.insert(Body(line));
+  }
+  ASSERT_EQ(seen.size(), static_cast<size_t>(kThreads * kRecords));
+  EXPECT_EQ(seen.count("D 3:4999"), 1u);
+}
+
+TEST_F(RingLoggerTest, CApiWritesAndClamps) {
+  ScLogger* logger = sc_logger_open(path_.c_str(), 0, 0, 0);
+  ASSERT_NE(logger, nullptr);
+  sc_logger_set_level(logger, SC_LOG_WARN);
+  const std::string info = "info";
+  const std::string warn = "warn";
+  EXPECT_EQ(sc_logger_write(logger, SC_LOG_INFO,
+                            reinterpret_cast<const uint8_t*>(info.data()),
+                            static_cast<uint32_t>(info.size())),
+            -1);
+  EXPECT_EQ(sc_logger_write(logger, 99,
+                            reinterpret_cast<const uint8_t*>(warn.data()),
+                            static_cast<uint32_t>(warn.size())),
+            0);
+  sc_logger_flush(logger);
+  EXPECT_EQ(sc_logger_dropped(logger), 0u);
+  sc_logger_close(logger);
+
+  const auto lines = ReadLines(path_);
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_EQ(Body(lines[0]), "E warn");
+  EXPECT_EQ(sc_logger_open(nullptr, 0, 0, 0), nullptr);
+}
+
+}  // namespace
+}  // namespace sc
@@ -0,0 +1,106 @@
+#include "send_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+namespace sc {
+namespace {
+
+std::vector<SendScheduler::Chunk> Drain(SendScheduler* scheduler) {
+  std::vector<SendScheduler::Chunk> chunks;
+  SendScheduler::Chunk chunk;
+  while (scheduler->Next(&chunk)) {
+    chunks.push_back(chunk);
+  }
+  return chunks;
+}
+
+TEST(SendSchedulerTest, CoversEveryFileInOrder) {
+  const std::vector<uint64_t> sizes = {10000, 0, 8192, 1, 30000};
+  SendScheduler scheduler(sizes, 8192, 3);
+  const auto chunks = Drain(&scheduler);
+  EXPECT_TRUE(scheduler.done());
+
+  std::vector<uint64_t> next_offset(sizes.size(), 0);
+  std::vector<int> firsts(sizes.size(), 0);
+  std::vector<int> lasts(sizes.size(), 0);
+  for (const auto& chunk : chunks) {
+    ASSERT_LT(chunk.file_index, sizes.size());
+    EXPECT_EQ(next_offset[chunk.file_index], chunk.offset);
+    EXPECT_EQ(chunk.offset == 0, chunk.first);
+    EXPECT_EQ(0, lasts[chunk.file_index]) << "chunk after last";
+    next_offset[chunk.file_index] += chunk.length;
+    firsts[chunk.file_index] += chunk.first;
+    lasts[chunk.file_index] += chunk.last;
+  }
+  for (size_t i = 0; i < sizes.size(); i++) {
+    EXPECT_EQ(sizes[i], next_offset[i]);
+    EXPECT_EQ(1, firsts[i]);
+    EXPECT_EQ(1, lasts[i]);
+  }
+}
+
+TEST(SendSchedulerTest, InterleavesActiveFiles) {
+  SendScheduler scheduler({3 * 100, 3 * 100, 100}, 100, 2);
+  const auto chunks = Drain(&scheduler);
+  std::vector<uint32_t> order;
+  for (const auto& chunk : chunks) {
+    order.push_back(chunk.file_index);
+  }
+  // File 2 takes file 0's slot as soon as file 0 completes.
+  EXPECT_EQ((std::vector<uint32_t>{0, 1, 0, 1, 0, 1, 2}), order);
+}
+
+TEST(SendSchedulerTest, SmallFileDoesNotWaitBehindLargeOne) {
+  SendScheduler scheduler({1000 * 1000, 50}, 1000, 2);
+  SendScheduler::Chunk chunk;
+  std::set<uint32_t> finished;
+  for (int i = 0; i < 3 && scheduler.Next(&chunk); i++) {
+    if (chunk.last) {
+      finished.insert(chunk.file_index);
+    }
+  }
+  EXPECT_EQ(1u, finished.count(1));
+}
+
+TEST(SendSchedulerTest, SingleActiveFileIsSequential) {
+  SendScheduler scheduler({250, 250}, 100, 1);
+  const auto chunks = Drain(&scheduler);
+  ASSERT_EQ(6u, chunks.size());
+  for (size_t i = 0; i < chunks.size(); i++) {
+    EXPECT_EQ(i < 3 ? 0u : 1u, chunks[i].file_index);
+  }
+  EXPECT_EQ(50u, chunks[2].length);
+}
+
+TEST(SendSchedulerTest, SkipsRangesTheReceiverHas) {
+  SendScheduler scheduler({1000, 300, 400}, 100, 1);
+  scheduler.Skip(0, 150, 300);  // middle of file 0
+  scheduler.Skip(0, 900, 500);  // tail of file 0, clamped to its end
+  scheduler.Skip(1, 0, 300);    // all of file 1
+  scheduler.Skip(2, 0, 50);     // head of file 2
+  const auto chunks = Drain(&scheduler);
+
+  std::vector<std::vector<std::pair<uint64_t, uint32_t>>> sent(3);
+  std::vector<int> firsts(3, 0);
+  std::vector<int> lasts(3, 0);
+  for (const auto& chunk : chunks) {
+    sent[chunk.file_index].emplace_back(chunk.offset, chunk.length);
+    firsts[chunk.file_index] += chunk.first;
+    lasts[chunk.file_index] += chunk.last;
+  }
+  using Ranges = std::vector<std::pair<uint64_t, uint32_t>>;
+  EXPECT_EQ((Ranges{{0, 100}, {100, 50}, {450, 100}, {550, 100},
+                    {650, 100}, {750, 100}, {850, 50}}),
+            sent[0]);
+  // A fully skipped file still gets a first and last chunk for its end.
+  EXPECT_EQ((Ranges{{0, 0}}), sent[1]);
+  EXPECT_EQ((Ranges{{50, 100}, {150, 100}, {250, 100}, {350, 50}}), sent[2]);
+  EXPECT_EQ((std::vector<int>{1, 1, 1}), firsts);
+  EXPECT_EQ((std::vector<int>{1, 1, 1}), lasts);
+}
+
+}  // namespace
+}  // namespace sc
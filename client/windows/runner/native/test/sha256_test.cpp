@@ -0,0 +1,116 @@
+#include "sha256.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "chunk_source.h"
+
+namespace sc {
+namespace {
+
+std::string HexDigest(const std::string& message, size_t piece = 0) {
+  Sha256 hasher;
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(message.data());
+  if (piece == 0) {
+    hasher.Update(data, message.size());
+  } else {
+    for (size_t i = 0; i < message.size(); i += piece) {
+      hasher.Update(data + i, std::min(piece, message.size() - i));
+    }
+  }
+  uint8_t digest[Sha256::kDigestSize];
+  hasher.Finish(digest);
+  return Sha256::ToHex(digest);
+}
+
+class Sha256Test : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override { Sha256::DisableAccelerationForTesting(GetParam()); }
+  void TearDown() override { Sha256::DisableAccelerationForTesting(false); }
+};
+
+TEST_P(Sha256Test, MatchesKnownVectors) {
+  EXPECT_EQ(
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+      HexDigest(""));
+  EXPECT_EQ(
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+      HexDigest("abc"));
+  EXPECT_EQ(
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+      HexDigest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+  EXPECT_EQ(
+      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+      HexDigest(std::string(1000000, 'a'), 8191));
+}
+
+TEST_P(Sha256Test, SplitUpdatesMatchSingleUpdate) {
+  std::mt19937 random(1234);
+  std::string message(100000, '\0');
+  for (char& c : message) {
+    c = static_cast<char>(random());
+  }
+  const std::string whole = HexDigest(message);
+  for (size_t piece : {1u, 63u, 64u, 65u, 8192u}) {
+    EXPECT_EQ(whole, HexDigest(message, piece)) << "piece " << piece;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ScalarAndAccelerated, Sha256Test, ::testing::Bool());
+
+TEST(Sha256PathsTest, AcceleratedAndScalarAgree) {
+  if (!Sha256::IsAccelerated()) {
+    GTEST_SKIP() << "SHA extensions not available on this CPU";
+  }
+  std::mt19937 random(99);
+  std::string message(12345, '\0');
+  for (char& c : message) {
+    c = static_cast<char>(random());
+  }
+  const std::string accelerated = HexDigest(message);
+  Sha256::DisableAccelerationForTesting(true);
+  const std::string scalar = HexDigest(message);
+  Sha256::DisableAccelerationForTesting(false);
+  EXPECT_EQ(scalar, accelerated);
+}
+
+TEST(ChunkSourceDigestTest, HashesWhileStreamingAndCatchesUp) {
+  const std::string path = ::testing::TempDir() + "chunk_source_digest.bin";
+  std::string contents(300000, '\0');
+  for (size_t i = 0; i < contents.size(); i++) {
+    contents[i] = static_cast<char>(i * 7);
+  }
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+  }
+  const std::string expected = HexDigest(contents);
+  uint8_t digest[Sha256::kDigestSize];
+
+  // Sequential reader: digest comes from the running hash.
+  ChunkSource sequential;
+  ASSERT_TRUE(sequential.Open(path, true, 65536));
+  size_t length = 0;
+  for (uint64_t offset = 0;
+       sequential.View(offset, 8192, &length) != nullptr; offset += length) {
+  }
+  ASSERT_TRUE(sequential.Digest(digest));
+  EXPECT_EQ(expected, Sha256::ToHex(digest));
+
+  // Reader that starts midway (e.g. resuming) and stops early.
+  ChunkSource partial;
+  ASSERT_TRUE(partial.Open(path, false));
+  ASSERT_NE(nullptr, partial.View(100000, 8192, &length));
+  ASSERT_TRUE(partial.Digest(digest));
+  EXPECT_EQ(expected, Sha256::ToHex(digest));
+
+  std::remove(path.c_str());
+}
+
+}  // namespace
+}  // namespace sc
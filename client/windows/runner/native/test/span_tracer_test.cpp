@@ -0,0 +1,129 @@
+#include "span_tracer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sc_native_api.h"
+
+namespace sc {
+namespace {
+
+size_t Count(const std::string& text, const std::string& needle) {
+  size_t count = 0;
+  for (size_t at = text.find(needle); at != std::string::npos;
+       at = text.find(needle, at + needle.size())) {
+    count++;
+  }
+  return count;
+}
+
+TEST(SpanTracerTest, ExportsCompleteEvents) {
+  SpanTracer tracer(8);
+  tracer.Record("share.request", 0xabcdef, 1000, 251500, 3);
+  tracer.Record("idle", 0, 5000, 5000);
+  std::string json;
+  tracer.AppendChromeTrace(&json, 42);
+
+  EXPECT_EQ(0u, json.find("{\"traceEvents\":[{\"name\":\"share.request\","
+                          "\"ph\":\"X\",\"ts\":"));
+  EXPECT_NE(std::string::npos,
+            json.find(",\"dur\":250.500,\"pid\":42,\"tid\":3,"
+                      "\"args\":{\"trace\":\"0000000000abcdef\"}}"));
+  EXPECT_NE(std::string::npos,
+            json.find("{\"name\":\"idle\",\"ph\":\"X\",\"ts\":"));
+  EXPECT_NE(std::string::npos,
+            json.find(",\"dur\":0.000,\"pid\":42,\"tid\":0}"));
+  EXPECT_EQ(1u, Count(json, "\"args\""));
+  EXPECT_EQ(2u, tracer.recorded());
+}
+
+TEST(SpanTracerTest, TimestampsOnTheWallClock) {
+  SpanTracer tracer;
+  tracer.Record("now", 0, SpanTracer::NowNs(), SpanTracer::NowNs());
+  std::string json;
+  tracer.AppendChromeTrace(&json, 1);
+  const size_t at = json.find("\"ts\":");
+  ASSERT_NE(std::string::npos, at);
+  // Microseconds since 1970: after 2020.
+  EXPECT_GT(std::stoll(json.substr(at + 5)), 1577836800000000LL);
+}
+
+TEST(SpanTracerTest, KeepsTheMostRecentSpans) {
+  SpanTracer tracer(4);
+  for (int i = 0; i < 10; i++) {
+    tracer.Record("span" + std::to_string(i), 0, i, i + 1);
+  }
+  std::string json;
+  tracer.AppendChromeTrace(&json, 1);
+  EXPECT_EQ(4u, Count(json, "\"ph\":\"X\""));
+  EXPECT_EQ(std::string::npos, json.find("\"span5\""));
+  EXPECT_LT(json.find("\"span6\""), json.find("\"span9\""));
+  EXPECT_EQ(10u, tracer.recorded());
+}
+
+TEST(SpanTracerTest, CutsOffAndEscapesNames) {
+  SpanTracer tracer(2);
+  tracer.Record(std::string(100, 'n'), 0, 0, 1);
+  tracer.Record("a\"b\\c\n", 0, 0, 1);
+  std::string json;
+  tracer.AppendChromeTrace(&json, 1);
+  EXPECT_NE(std::string::npos,
+            json.find("\"" + std::string(SpanTracer::kMaxNameSize, 'n') +
+                      "\""));
+  EXPECT_NE(std::string::npos, json.find("\"a\\\"b\\\\c\\u000a\""));
+}
+
+TEST(SpanTracerTest, RecordsFromConcurrentThreads) {
+  SpanTracer tracer(1 << 14);
+  constexpr int kThreads = 4;
+  constexpr int kSpans = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&tracer, t] {
+      for (int i = 0; i < kSpans; i++) {
+        const int64_t start = SpanTracer::NowNs();
+        tracer.Record("work", t + 1, start, SpanTracer::NowNs(), t);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::string json;
+  tracer.AppendChromeTrace(&json, 1);
+  EXPECT_EQ(static_cast<size_t>(kThreads * kSpans), Count(json, "\"work\""));
+  EXPECT_EQ(static_cast<size_t>(kSpans),
+            Count(json, "\"trace\":\"0000000000000004\""));
+}
+
+TEST(SpanTracerTest, CApiWritesATraceFile) {
+  const std::string path = ::testing::TempDir() + "span_tracer_test.json";
+  ScTracer* tracer = sc_tracer_create(0);
+  ASSERT_NE(tracer, nullptr);
+  const std::string name = "datachannel.open";
+  const int64_t start = sc_tracer_now_ns();
+  sc_tracer_record(tracer, reinterpret_cast<const uint8_t*>(name.data()),
+                   static_cast<uint32_t>(name.size()), 7, start,
+                   sc_tracer_now_ns());
+  EXPECT_EQ(sc_tracer_recorded(tracer), 1u);
+  ASSERT_EQ(sc_tracer_write_chrome_trace(tracer, path.c_str(), 9), 0);
+  EXPECT_EQ(sc_tracer_write_chrome_trace(tracer, nullptr, 9), -1);
+  sc_tracer_destroy(tracer);
+
+  std::ifstream in(path, std::ios::binary);
+  const std::string json((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"datachannel.open\""));
+  EXPECT_NE(std::string::npos, json.find("\"pid\":9"));
+  EXPECT_EQ('}', json.back());
+  std::remove(path.c_str());
+}
+
+}  // namespace
+}  // namespace sc
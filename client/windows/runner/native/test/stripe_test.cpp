@@ -0,0 +1,125 @@
+#include "stripe.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "testing/transfer_simulation.h"
+
+namespace sc {
+namespace {
+
+using ::sc::testing::SimulateTransfer;
+using ::sc::testing::TransferSimulationConfig;
+
+TEST(StripeSchedulerTest, RotatesBetweenIdleChannels) {
+  StripeScheduler scheduler(4);
+  std::vector<size_t> picks;
+  for (int i = 0; i < 8; i++) {
+    const size_t channel = scheduler.Pick();
+    scheduler.OnSent(channel, 1000);
+    scheduler.OnConsumed(channel, (i / 4 + 1) * 1000);
+    picks.push_back(channel);
+  }
+  EXPECT_EQ((std::vector<size_t>{0, 1, 2, 3, 0, 1, 2, 3}), picks);
+}
+
+TEST(StripeSchedulerTest, AvoidsStalledChannel) {
+  StripeScheduler scheduler(3);
+  for (size_t channel = 0; channel < 3; channel++) {
+    scheduler.OnSent(channel, 5000);
+  }
+  // Channel 1 is stuck behind a retransmission; the others drain.
+  scheduler.OnConsumed(0, 5000);
+  scheduler.OnConsumed(2, 4000);
+  for (int i = 0; i < 4; i++) {
+    const size_t channel = scheduler.Pick();
+    EXPECT_NE(1u, channel);
+    scheduler.OnSent(channel, 1000);
+  }
+  scheduler.OnConsumed(2, 1000);  // stale
+  EXPECT_EQ(5000u, scheduler.in_flight(1));
+}
+
+TEST(ReassemblyBufferTest, InOrderChunksAreNotHeld) {
+  ReassemblyBuffer buffer;
+  EXPECT_TRUE(buffer.Advance(0, 100));
+  EXPECT_TRUE(buffer.Advance(100, 50));
+  EXPECT_FALSE(buffer.Advance(200, 10));
+  EXPECT_EQ(150u, buffer.next_offset());
+  EXPECT_EQ(0u, buffer.held_bytes());
+}
+
+TEST(ReassemblyBufferTest, ReordersShuffledChunks) {
+  std::vector<uint8_t> file(64 * 1000);
+  for (size_t i = 0; i < file.size(); i++) {
+    file[i] = static_cast<uint8_t>(i * 13 + (i >> 8));
+  }
+  std::vector<size_t> order(64);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+  ReassemblyBuffer buffer;
+  std::vector<uint8_t> output;
+  for (size_t index : order) {
+    const uint64_t offset = index * 1000;
+    if (!buffer.Advance(offset, 1000)) {
+      ASSERT_TRUE(buffer.Insert(offset, file.data() + offset, 1000));
+    } else {
+      output.insert(output.end(), file.begin() + static_cast<long>(offset),
+                    file.begin() + static_cast<long>(offset) + 1000);
+    }
+    size_t length = 0;
+    while (const uint8_t* front = buffer.Front(&length)) {
+      output.insert(output.end(), front, front + length);
+      buffer.PopFront();
+    }
+  }
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(0u, buffer.held_bytes());
+  EXPECT_EQ(file, output);
+}
+
+TEST(ReassemblyBufferTest, RejectsOverlaps) {
+  ReassemblyBuffer buffer;
+  const uint8_t data[100] = {};
+  ASSERT_TRUE(buffer.Advance(0, 100));
+  EXPECT_FALSE(buffer.Insert(50, data, 100));  // already delivered
+  ASSERT_TRUE(buffer.Insert(300, data, 100));
+  EXPECT_FALSE(buffer.Insert(300, data, 100));  // duplicate
+  EXPECT_FALSE(buffer.Insert(250, data, 100));  // overlaps the start
+  EXPECT_FALSE(buffer.Insert(350, data, 100));  // overlaps the end
+  EXPECT_TRUE(buffer.Insert(200, data, 100));
+  // Delivering in order must not skip over held data.
+  EXPECT_FALSE(buffer.Advance(100, 150));
+  EXPECT_EQ(200u, buffer.held_bytes());
+}
+
+TEST(StripeSimulationTest, StripedTransferSurvivesLoss) {
+  TransferSimulationConfig config;
+  config.link.bandwidth_bytes_per_sec = 125e6;  // 1 Gbit/s LAN
+  config.link.one_way_delay_us = 2000;
+  config.link.loss_rate = 0.01;
+  config.link.retransmit_delay_us = 12000;
+  config.total_bytes = 32ull * 1024 * 1024;
+
+  config.channels = 1;
+  const auto single = SimulateTransfer(config);
+  config.channels = 4;
+  const auto striped = SimulateTransfer(config);
+
+  ASSERT_TRUE(single.completed);
+  ASSERT_TRUE(striped.completed);
+  EXPECT_TRUE(striped.data_intact);
+  // A retransmission stalls only its own channel, so the others keep the
+  // window moving.
+  EXPECT_GT(striped.throughput(), 1.1 * single.throughput());
+  EXPECT_LE(striped.max_receive_buffer, CreditReceiver::kDefaultWindow);
+}
+
+}  // namespace
+}  // namespace sc
@@ -0,0 +1,94 @@
+#include "testing/link_simulator.h"
+
+#include <algorithm>
+
+namespace sc {
+namespace testing {
+
+LinkSimulator::LinkSimulator(const Config& config)
+    : config_(config), random_(config.seed) {}
+
+void LinkSimulator::Send(uint64_t now_us, uint64_t tag, size_t size,
+                         size_t stream) {
+  if (stream >= streams_.size()) {
+    streams_.resize(stream + 1);
+  }
+  Stream& target = streams_[stream];
+
+  const uint64_t start = std::max(now_us, wire_free_us_);
+  const uint64_t serialization = static_cast<uint64_t>(
+      static_cast<double>(size) * 1e6 / config_.bandwidth_bytes_per_sec);
+  wire_free_us_ = start + serialization;
+
+  uint64_t arrival = wire_free_us_ + config_.one_way_delay_us;
+  if (config_.loss_rate > 0 && uniform_(random_) < config_.loss_rate) {
+    arrival += config_.retransmit_delay_us;
+    lost_messages_++;
+  }
+  // Ordered delivery: nothing overtakes a message still being retransmitted
+  // on the same stream.
+  arrival = std::max(arrival, target.last_arrival_us);
+  target.last_arrival_us = arrival;
+
+  InFlight message;
+  message.delivery.tag = tag;
+  message.delivery.size = size;
+  message.delivery.stream = stream;
+  message.delivery.time_us = arrival;
+  message.transmitted_us = wire_free_us_;
+  target.messages.push_back(message);
+}
+
+bool LinkSimulator::Poll(uint64_t now_us, Delivery* out) {
+  const int stream = NextStream();
+  if (stream < 0) {
+    return false;
+  }
+  auto& messages = streams_[static_cast<size_t>(stream)].messages;
+  if (messages.front().delivery.time_us > now_us) {
+    return false;
+  }
+  *out = messages.front().delivery;
+  messages.pop_front();
+  return true;
+}
+
+uint64_t LinkSimulator::NextDeliveryTime() const {
+  const int stream = NextStream();
+  return stream < 0
+             ? kNever
+             : streams_[static_cast<size_t>(stream)]
+                   .messages.front()
+                   .delivery.time_us;
+}
+
+uint64_t LinkSimulator::QueuedBytes(uint64_t now_us, size_t stream) const {
+  if (stream >= streams_.size()) {
+    return 0;
+  }
+  const auto& messages = streams_[stream].messages;
+  uint64_t queued = 0;
+  for (auto it = messages.rbegin(); it != messages.rend(); ++it) {
+    if (it->transmitted_us <= now_us) {
+      break;
+    }
+    queued += it->delivery.size;
+  }
+  return queued;
+}
+
+int LinkSimulator::NextStream() const {
+  int best = -1;
+  uint64_t best_time = kNever;
+  for (size_t i = 0; i < streams_.size(); i++) {
+    if (!streams_[i].messages.empty() &&
+        streams_[i].messages.front().delivery.time_us < best_time) {
+      best = static_cast<int>(i);
+      best_time = streams_[i].messages.front().delivery.time_us;
+    }
+  }
+  return best;
+}
+
+}  // namespace testing
+}  // namespace sc
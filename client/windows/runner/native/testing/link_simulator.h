@@ -0,0 +1,86 @@
+#ifndef RUNNER_NATIVE_TESTING_LINK_SIMULATOR_H_
+#define RUNNER_NATIVE_TESTING_LINK_SIMULATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace sc {
+namespace testing {
+
+// One direction of a simulated data channel: a bottleneck of fixed
+// bandwidth followed by a fixed propagation delay. Like SCTP in reliable
+// ordered mode, a lost message is retransmitted after |retransmit_delay_us|
+// and everything behind it on the same stream waits (head-of-line
+// blocking), so loss shows up as latency spikes and bursts rather than as
+// missing data. Streams model several data channels sharing one
+// association: they share the bandwidth but are ordered independently.
+//
+// Time is simulated microseconds supplied by the caller.
+class LinkSimulator {
+ public:
+  static constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+
+  struct Config {
+    double bandwidth_bytes_per_sec = 12.5e6;  // 100 Mbit/s
+    uint64_t one_way_delay_us = 20000;
+    double loss_rate = 0.0;
+    uint64_t retransmit_delay_us = 200000;
+    uint32_t seed = 1;
+  };
+
+  struct Delivery {
+    uint64_t tag = 0;
+    size_t size = 0;
+    size_t stream = 0;
+    uint64_t time_us = 0;
+  };
+
+  explicit LinkSimulator(const Config& config);
+
+  // Queues a message of |size| bytes on |stream| at |now_us|. |tag| is
+  // returned with it on delivery.
+  void Send(uint64_t now_us, uint64_t tag, size_t size, size_t stream = 0);
+
+  // Pops the earliest message that has arrived by |now_us|. Messages on
+  // one stream arrive in send order.
+  bool Poll(uint64_t now_us, Delivery* out);
+
+  // Arrival time of the next message, or kNever when the link is idle.
+  uint64_t NextDeliveryTime() const;
+
+  // Bytes of |stream| not yet on the wire at |now_us|, i.e. what a data
+  // channel would report as bufferedAmount.
+  uint64_t QueuedBytes(uint64_t now_us, size_t stream = 0) const;
+
+  uint64_t lost_messages() const { return lost_messages_; }
+
+ private:
+  struct InFlight {
+    Delivery delivery;
+    uint64_t transmitted_us;  // when the last byte left the sender
+  };
+
+  struct Stream {
+    std::deque<InFlight> messages;
+    uint64_t last_arrival_us = 0;
+  };
+
+  Config config_;
+  std::mt19937 random_;
+  std::uniform_real_distribution<double> uniform_{0.0, 1.0};
+  std::vector<Stream> streams_;
+  uint64_t wire_free_us_ = 0;
+  uint64_t lost_messages_ = 0;
+
+  // Stream whose next message arrives first, or -1 when idle.
+  int NextStream() const;
+};
+
+}  // namespace testing
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_TESTING_LINK_SIMULATOR_H_
@@ -0,0 +1,44 @@
+#ifndef RUNNER_NATIVE_TESTING_TEMP_PATH_H_
+#define RUNNER_NATIVE_TESTING_TEMP_PATH_H_
+
+#include <gtest/gtest.h>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <string>
+
+namespace sc {
+namespace testing {
+
+// A path under the gtest temp directory for the running test: |stem|, the
+// test's suite and name, the process id, then |extension|. No other test
+// or concurrent run uses it, so tests can run in parallel (ctest -j).
+inline std::string UniqueTempPath(const std::string& stem,
+                                  const std::string& extension = "") {
+  std::string path = ::testing::TempDir() + stem;
+  const ::testing::TestInfo* test =
+      ::testing::UnitTest::GetInstance()->current_test_info();
+  if (test != nullptr) {
+    // Parameterized suites and tests carry '/' in their names.
+    std::string name =
+        std::string(test->test_suite_name()) + "_" + test->name();
+    std::replace(name.begin(), name.end(), '/', '_');
+    path += "_" + name;
+  }
+#if defined(_WIN32)
+  path += "_" + std::to_string(::_getpid());
+#else
+  path += "_" + std::to_string(::getpid());
+#endif
+  return path + extension;
+}
+
+}  // namespace testing
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_TESTING_TEMP_PATH_H_
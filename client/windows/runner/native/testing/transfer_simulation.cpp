@@ -0,0 +1,272 @@
+#include "testing/transfer_simulation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "frame_codec.h"
+#include "sha256.h"
+#include "stripe.h"
+
+namespace sc {
+namespace testing {
+
+namespace {
+
+constexpr size_t kGrantMessageSize = 96;  // JSON credit envelope
+// Poll interval while the sender waits for its buffer to drain, matching
+// the Dart sender.
+constexpr uint64_t kPollIntervalUs = 1000;
+// Carried file bytes repeat with this period at most.
+constexpr uint64_t kPatternSize = 1024 * 1024;
+
+// Value below which |fraction| of |samples| fall. Reorders |samples|.
+uint64_t Percentile(std::vector<uint32_t>* samples, double fraction) {
+  if (samples->empty()) {
+    return 0;
+  }
+  const size_t rank = std::min(
+      samples->size() - 1,
+      static_cast<size_t>(fraction * static_cast<double>(samples->size())));
+  std::nth_element(samples->begin(), samples->begin() + rank, samples->end());
+  return (*samples)[rank];
+}
+
+}  // namespace
+
+double TransferSimulationResult::throughput() const {
+  return duration_us == 0 ? 0
+                          : 1e6 * static_cast<double>(total_bytes) /
+                                static_cast<double>(duration_us);
+}
+
+TransferSimulationResult SimulateTransfer(
+    const TransferSimulationConfig& config) {
+  const size_t channels = std::max<size_t>(config.channels, 1);
+  LinkSimulator data(config.link);
+  LinkSimulator::Config reverse = config.link;
+  reverse.seed = config.link.seed + 1;
+  LinkSimulator grants(reverse);
+  struct Grant {
+    uint64_t consumed;
+    uint64_t limit;
+    std::vector<uint64_t> channel_consumed;
+  };
+  std::vector<Grant> grant_log;
+
+  TransferSimulationResult result;
+  result.total_bytes = config.total_bytes;
+  CreditSender& sender = result.sender;
+  StripeScheduler stripes(channels);
+  std::vector<uint64_t> channel_consumed(channels, 0);
+
+  CreditReceiver receiver;
+  ReassemblyBuffer reassembly;
+  const std::vector<uint8_t> payload(config.chunk_size, 0);
+  uint64_t write_queue = 0;
+
+  // File contents and frames on the wire, when payload is carried.
+  std::vector<uint8_t> pattern;
+  std::unordered_map<uint64_t, std::vector<uint8_t>> frames_in_flight;
+  std::vector<std::vector<uint8_t>> spare_frames;
+  Sha256 sent_digest;
+  Sha256 received_digest;
+  const size_t period =
+      static_cast<size_t>(std::min(kPatternSize, config.total_bytes + 1));
+  if (config.carry_payload) {
+    pattern.resize(period + config.chunk_size);
+    std::mt19937 random(config.link.seed);
+    for (size_t i = 0; i < pattern.size(); i += sizeof(uint32_t)) {
+      const uint32_t word = random();
+      std::memcpy(pattern.data() + i, &word,
+                  std::min(sizeof(word), pattern.size() - i));
+    }
+  }
+
+  // End offset and send time of each chunk not yet delivered in order.
+  std::deque<std::pair<uint64_t, uint64_t>> unconfirmed;
+  std::vector<uint32_t> latencies;
+  latencies.reserve(static_cast<size_t>(
+      std::min<uint64_t>(config.total_bytes / config.chunk_size + 1, 1 << 24)));
+  double write_budget = 0;
+  uint64_t write_stamp = 0;
+
+  // The initial grant travels with the receiver's 'ready' message.
+  sender.OnCredit(0, receiver.limit(), 0);
+
+  const uint64_t total = config.total_bytes;
+  uint64_t now = 0;
+  uint64_t sent = 0;
+  auto send_grant = [&]() {
+    grants.Send(now, grant_log.size(), kGrantMessageSize);
+    grant_log.push_back(
+        {receiver.consumed(), receiver.limit(), channel_consumed});
+  };
+
+  while (receiver.released() < total) {
+    if (now > config.time_limit_us) {
+      break;
+    }
+
+    // Sender: fill the window, striping frames over the channels.
+    while (sent < total) {
+      const size_t chunk = static_cast<size_t>(
+          std::min<uint64_t>(config.chunk_size, total - sent));
+      uint64_t queued = 0;
+      for (size_t i = 0; i < channels; i++) {
+        queued += data.QueuedBytes(now, i);
+      }
+      if (sender.Available(queued) < chunk) {
+        break;
+      }
+      if (config.carry_payload) {
+        const uint8_t* bytes = pattern.data() + sent % period;
+        sent_digest.Update(bytes, chunk);
+        std::vector<uint8_t> frame;
+        if (!spare_frames.empty()) {
+          frame = std::move(spare_frames.back());
+          spare_frames.pop_back();
+        }
+        frame.resize(kFrameHeaderSize + chunk);
+        FrameHeader header;
+        header.flags = sent + chunk == total ? kFrameFlagLast : 0;
+        header.session_id = 1;
+        header.offset = sent;
+        header.length = static_cast<uint32_t>(chunk);
+        EncodeFrame(header, bytes, frame.data(), frame.size());
+        frames_in_flight[sent] = std::move(frame);
+      }
+      unconfirmed.emplace_back(sent + chunk, now);
+      const size_t channel = stripes.Pick();
+      data.Send(now, sent, chunk + kFrameHeaderSize, channel);
+      stripes.OnSent(channel, chunk);
+      sender.OnSent(chunk, now);
+      sent += chunk;
+      result.frames++;
+      if (sender.in_flight() > sender.window()) {
+        result.max_in_flight_over_window =
+            std::max(result.max_in_flight_over_window,
+                     sender.in_flight() - sender.window());
+      }
+    }
+
+    // Receiver: reassemble arrivals into the write queue.
+    LinkSimulator::Delivery delivery;
+    while (data.Poll(now, &delivery)) {
+      const uint64_t offset = delivery.tag;
+      const size_t length = delivery.size - kFrameHeaderSize;
+      channel_consumed[delivery.stream] += length;
+      if (receiver.OnConsumed(length)) {
+        send_grant();
+      }
+      const uint8_t* bytes = payload.data();
+      std::vector<uint8_t> frame;
+      if (config.carry_payload) {
+        auto it = frames_in_flight.find(offset);
+        if (it != frames_in_flight.end()) {
+          frame = std::move(it->second);
+          frames_in_flight.erase(it);
+        }
+        FrameHeader header;
+        const uint8_t* frame_payload = nullptr;
+        if (DecodeFrame(frame.data(), frame.size(), &header, &frame_payload) &&
+            header.offset == offset && header.length == length) {
+          bytes = frame_payload;
+        } else {
+          result.data_intact = false;
+        }
+      }
+      if (reassembly.Advance(offset, length)) {
+        write_queue += length;
+        if (config.carry_payload) {
+          received_digest.Update(bytes, length);
+        }
+      } else if (!reassembly.Insert(offset, bytes, length)) {
+        result.data_intact = false;
+      }
+      if (config.carry_payload) {
+        frame.clear();
+        spare_frames.push_back(std::move(frame));
+      }
+      size_t front_length = 0;
+      while (const uint8_t* front = reassembly.Front(&front_length)) {
+        write_queue += front_length;
+        if (config.carry_payload) {
+          received_digest.Update(front, front_length);
+        }
+        reassembly.PopFront();
+      }
+    }
+    while (!unconfirmed.empty() &&
+           unconfirmed.front().first <= reassembly.next_offset()) {
+      latencies.push_back(static_cast<uint32_t>(std::min<uint64_t>(
+          now - unconfirmed.front().second,
+          std::numeric_limits<uint32_t>::max())));
+      unconfirmed.pop_front();
+    }
+    result.max_held = std::max(result.max_held, reassembly.held_bytes());
+    result.max_receive_buffer = std::max(
+        result.max_receive_buffer, reassembly.held_bytes() + write_queue);
+
+    // Writer: drain the queue, at |write_rate| if set.
+    uint64_t writable = write_queue;
+    if (config.write_rate > 0) {
+      write_budget +=
+          config.write_rate * static_cast<double>(now - write_stamp) / 1e6;
+      writable = std::min(writable, static_cast<uint64_t>(write_budget));
+      write_budget -= static_cast<double>(writable);
+    }
+    write_stamp = now;
+    if (writable > 0) {
+      write_queue -= writable;
+      if (receiver.OnReleased(writable) || receiver.released() == total) {
+        send_grant();
+      }
+    }
+
+    while (grants.Poll(now, &delivery)) {
+      const Grant& grant = grant_log[delivery.tag];
+      sender.OnCredit(grant.consumed, grant.limit, now);
+      for (size_t i = 0; i < channels; i++) {
+        stripes.OnConsumed(i, grant.channel_consumed[i]);
+      }
+    }
+
+    uint64_t next =
+        std::min(data.NextDeliveryTime(), grants.NextDeliveryTime());
+    if (sent < total || write_queue > 0) {
+      next = std::min(next, now + kPollIntervalUs);
+    }
+    if (next == LinkSimulator::kNever) {
+      break;
+    }
+    now = std::max(now + 1, next);
+  }
+
+  result.completed = receiver.released() == total;
+  result.data_intact = result.data_intact && reassembly.empty() &&
+                       reassembly.next_offset() == total;
+  if (config.carry_payload) {
+    uint8_t sent_hash[Sha256::kDigestSize];
+    uint8_t received_hash[Sha256::kDigestSize];
+    sent_digest.Finish(sent_hash);
+    received_digest.Finish(received_hash);
+    result.data_intact =
+        result.data_intact &&
+        std::memcmp(sent_hash, received_hash, sizeof(sent_hash)) == 0;
+  }
+  result.duration_us = now;
+  result.lost_messages = data.lost_messages();
+  result.latency_p50_us = Percentile(&latencies, 0.5);
+  result.latency_p99_us = Percentile(&latencies, 0.99);
+  result.latency_max_us = Percentile(&latencies, 1.0);
+  return result;
+}
+
+}  // namespace testing
+}  // namespace sc
@@ -0,0 +1,66 @@
+#ifndef RUNNER_NATIVE_TESTING_TRANSFER_SIMULATION_H_
+#define RUNNER_NATIVE_TESTING_TRANSFER_SIMULATION_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "flow_control.h"
+#include "testing/link_simulator.h"
+
+namespace sc {
+namespace testing {
+
+struct TransferSimulationConfig {
+  LinkSimulator::Config link;
+  uint64_t total_bytes = 64ull * 1024 * 1024;
+  size_t chunk_size = 8 * 1024;
+  // Data channels the frames are striped over.
+  size_t channels = 1;
+  // How fast the receiver writes data out, in bytes per second. Zero writes
+  // on arrival.
+  double write_rate = 0;
+  // Sends real file bytes: the sender hashes each chunk and encodes it as a
+  // proto v2 frame, and the receiver decodes, reassembles and hashes it
+  // again. Otherwise only frame sizes travel, and wall time covers the flow
+  // control alone.
+  bool carry_payload = false;
+  uint64_t time_limit_us = 600ull * 1000 * 1000;
+};
+
+struct TransferSimulationResult {
+  uint64_t total_bytes = 0;
+  bool completed = false;
+  // Every byte reached the writer exactly once and in order.
+  bool data_intact = true;
+  uint64_t duration_us = 0;
+  // High-water marks of receiver memory: bytes held for reassembly plus
+  // bytes waiting to be written, and the reassembly part alone.
+  uint64_t max_receive_buffer = 0;
+  uint64_t max_held = 0;
+  // How far in-flight data ever exceeded the sender's window (should be 0).
+  uint64_t max_in_flight_over_window = 0;
+  uint64_t frames = 0;
+  uint64_t lost_messages = 0;
+  // Chunk latency percentiles in simulated time, from a chunk being sent to
+  // it reaching the writer in order.
+  uint64_t latency_p50_us = 0;
+  uint64_t latency_p99_us = 0;
+  uint64_t latency_max_us = 0;
+  // Final sender state, for its window and RTT estimates.
+  CreditSender sender;
+
+  // Bytes per second from the first send to the last byte written.
+  double throughput() const;
+};
+
+// Streams one file of |total_bytes| through the real flow control, stripe
+// scheduler and reassembly code over a simulated link, in simulated time.
+// With |carry_payload| the frame codec and SHA-256 run on every chunk too,
+// and |data_intact| also means the digests on both ends match.
+TransferSimulationResult SimulateTransfer(
+    const TransferSimulationConfig& config);
+
+}  // namespace testing
+}  // namespace sc
+
+#endif  // RUNNER_NATIVE_TESTING_TRANSFER_SIMULATION_H_
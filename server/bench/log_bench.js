@@ -0,0 +1,95 @@
+// Cost of logging one signaling event, old and new.
+//
+//   node bench/log_bench.js [records]
+//
+// "call" is the time the event loop spends per record in the logging call
+// itself; "total" adds the time to get every record written. Output goes to
+// /dev/null, so the numbers are CPU, not disk.
+
+const fs = require('fs');
+const { Logger, streamWriter } = require('../logger');
+
+const RECORDS = Number(process.argv[2]) || 200000;
+
+// A webrtc-signal record as server.js logs it.
+function signalRecord(i) {
+  return {
+    from: 'AbCdEfGh...',
+    to: 'IjKlMnOp...',
+    recipientExists: true,
+    signalType: i % 10 === 0 ? 'offer' : 'candidate',
+    hasCandidate: i % 10 !== 0
+  };
+}
+
+// What server.js did before: a pretty-printed line per record, written
+// synchronously.
+function legacyLog(fd, message, data) {
+  const timestamp = new Date().toISOString();
+  fs.writeSync(fd, `[${timestamp}] ${message} ${JSON.stringify(data, null, 2)}\n`);
+}
+
+function runLegacy() {
+  const fd = fs.openSync('/dev/null', 'w');
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < RECORDS; i++) {
+    legacyLog(fd, '🔄 WEBRTC SIGNAL RECEIVED', signalRecord(i));
+  }
+  const elapsed = Number(process.hrtime.bigint() - start);
+  fs.closeSync(fd);
+  return Promise.resolve({ call: elapsed, total: elapsed });
+}
+
+function runLogger(options, level) {
+  return new Promise(resolve => {
+    const stream = fs.createWriteStream('/dev/null');
+    const logger = new Logger(Object.assign({ write: streamWriter(stream) }, options));
+    const start = process.hrtime.bigint();
+    let call = 0n;
+    let i = 0;
+    // In slices, as a server handles events, so the writer gets turns.
+    const slice = () => {
+      const sliceStart = process.hrtime.bigint();
+      for (const end = Math.min(i + 1000, RECORDS); i < end; i++) {
+        logger.log(level, 'webrtc-signal', () => signalRecord(i));
+      }
+      call += process.hrtime.bigint() - sliceStart;
+      if (i < RECORDS) {
+        setImmediate(slice);
+        return;
+      }
+      const finish = () => {
+        if (logger.count > 0 || logger.writing || logger.scheduled) {
+          setImmediate(finish);
+          return;
+        }
+        stream.end(() => resolve({
+          call: Number(call),
+          total: Number(process.hrtime.bigint() - start),
+          dropped: logger.dropped
+        }));
+      };
+      finish();
+    };
+    slice();
+  });
+}
+
+async function main() {
+  const cases = [
+    ['legacy, sync pretty JSON', runLegacy],
+    ['ndjson, every record', () => runLogger({ level: 'debug' }, 'debug')],
+    ['ndjson, sampled 1%', () => runLogger({ level: 'debug', sample: { 'webrtc-signal': 0.01 } }, 'debug')],
+    ['ndjson, below level', () => runLogger({ level: 'info' }, 'debug')]
+  ];
+  console.log(`${RECORDS} webrtc-signal records`);
+  console.log('case                         call ns/rec  total ns/rec');
+  for (const [name, run] of cases) {
+    const result = await run();
+    console.log(name.padEnd(28) +
+      (result.call / RECORDS).toFixed(0).padStart(12) +
+      (result.total / RECORDS).toFixed(0).padStart(14));
+  }
+}
+
+main();
@@ -0,0 +1,307 @@
+const EventEmitter = require('events');
+const net = require('net');
+const os = require('os');
+const crypto = require('crypto');
+
+// Message buses that let several signaling servers act as one.
+//
+// Each server is a node with its own sockets. Nodes keep a replica of the
+// whole device registry, owning the entries for their own sockets and
+// publishing every change to them; an event for a device on another node
+// is sent to that node, which emits it to the socket. A bus carries those
+// messages:
+//
+//   bus.publish(msg)       to every other node
+//   bus.send(node, msg)    to one node
+//
+// and emits:
+//   'connected'            joined the cluster, again after a reconnect
+//   'disconnected'         lost it; remote state is no longer known
+//   'node-joined' (node)   another node joined
+//   'node-left' (node)     another node left or was cut off
+//   'message' (msg, from)  a message from another node
+//
+// Two buses are provided. MemoryHub connects nodes in one process, for a
+// single server (the default) and for tests. TcpBus connects to a hub
+// (hub.js) over TCP, for nodes in other processes or on other hosts.
+// Anything with the same methods and events can replace them, e.g. a bus
+// over Redis pub/sub.
+
+// Messages are one JSON object per line; a longer line is a broken peer.
+const MAX_LINE = 1024 * 1024;
+
+function newNodeId() {
+  return `${os.hostname()}-${process.pid}-${crypto.randomBytes(3).toString('hex')}`;
+}
+
+// Splits a stream into JSON messages, one per line.
+function readLines(stream, onMessage, onError) {
+  let pending = '';
+  stream.setEncoding('utf8');
+  stream.on('data', (chunk) => {
+    pending += chunk;
+    let start = 0;
+    let end;
+    while ((end = pending.indexOf('\n', start)) !== -1) {
+      const line = pending.slice(start, end);
+      start = end + 1;
+      if (line.length === 0) continue;
+      let msg;
+      try {
+        msg = JSON.parse(line);
+      } catch (err) {
+        onError(err);
+        return;
+      }
+      onMessage(msg);
+    }
+    pending = pending.slice(start);
+    if (pending.length > MAX_LINE) onError(new Error('message too long'));
+  });
+}
+
+// Writes JSON lines, coalescing those written in one turn of the event loop
+// into one write.
+function lineWriter(stream) {
+  let corked = false;
+  return (msg) => {
+    if (!corked) {
+      corked = true;
+      stream.cork();
+      process.nextTick(() => {
+        corked = false;
+        stream.uncork();
+      });
+    }
+    stream.write(JSON.stringify(msg) + '\n');
+  };
+}
+
+// Connects buses in one process. Delivery is asynchronous, as over a
+// network, and in order.
+class MemoryHub {
+  constructor() {
+    this.buses = new Map();
+  }
+
+  bus(nodeId = newNodeId()) {
+    return new MemoryBus(this, nodeId);
+  }
+
+  _deliver(to, msg, from) {
+    const bus = this.buses.get(to);
+    if (bus) setImmediate(() => bus.emit('message', msg, from));
+  }
+
+  _announce(event, nodeId) {
+    for (const [id, bus] of this.buses) {
+      if (id !== nodeId) setImmediate(() => bus.emit(event, nodeId));
+    }
+  }
+}
+
+class MemoryBus extends EventEmitter {
+  constructor(hub, nodeId) {
+    super();
+    this.hub = hub;
+    this.nodeId = nodeId;
+    this.connected = false;
+  }
+
+  connect() {
+    this.hub.buses.set(this.nodeId, this);
+    this.connected = true;
+    setImmediate(() => this.emit('connected'));
+    this.hub._announce('node-joined', this.nodeId);
+    return this;
+  }
+
+  publish(msg) {
+    for (const id of this.hub.buses.keys()) {
+      if (id !== this.nodeId) this.hub._deliver(id, msg, this.nodeId);
+    }
+  }
+
+  send(node, msg) {
+    this.hub._deliver(node, msg, this.nodeId);
+  }
+
+  close() {
+    if (!this.connected) return;
+    this.connected = false;
+    this.hub.buses.delete(this.nodeId);
+    this.hub._announce('node-left', this.nodeId);
+  }
+}
+
+// Connects to a hub (see hub.js) at host:port with the hub's secret, and
+// reconnects with backoff when the connection drops. Messages sent while disconnected are dropped:
+// clients retry signaling that does not complete.
+class TcpBus extends EventEmitter {
+  constructor(host, port, secret, nodeId = newNodeId()) {
+    super();
+    this.host = host;
+    this.port = port;
+    this.secret = secret;
+    this.nodeId = nodeId;
+    this.connected = false;
+    this.closed = false;
+    this.socket = null;
+    this.write = null;
+    this.retryMs = 250;
+  }
+
+  connect() {
+    const socket = net.connect(this.port, this.host);
+    this.socket = socket;
+    socket.setNoDelay(true);
+    socket.on('connect', () => {
+      this.write = lineWriter(socket);
+      this.write({ type: 'hello', node: this.nodeId, secret: this.secret });
+    });
+    readLines(socket, (msg) => this._receive(msg), () => socket.destroy());
+    socket.on('error', () => {});
+    socket.on('close', () => {
+      this.socket = null;
+      this.write = null;
+      if (this.connected) {
+        this.connected = false;
+        this.emit('disconnected');
+      }
+      if (!this.closed) {
+        setTimeout(() => this.connect(), this.retryMs).unref();
+        this.retryMs = Math.min(this.retryMs * 2, 10000);
+      }
+    });
+    return this;
+  }
+
+  _receive(msg) {
+    switch (msg.type) {
+      case 'welcome':
+        this.connected = true;
+        this.retryMs = 250;
+        this.emit('connected');
+        break;
+      case 'node-joined':
+      case 'node-left':
+        this.emit(msg.type, msg.node);
+        break;
+      case 'message':
+        this.emit('message', msg.msg, msg.from);
+        break;
+    }
+  }
+
+  publish(msg) {
+    if (this.connected) this.write({ type: 'publish', msg: msg });
+  }
+
+  send(node, msg) {
+    if (this.connected) this.write({ type: 'send', to: node, msg: msg });
+  }
+
+  close() {
+    this.closed = true;
+    if (this.socket) this.socket.end();
+  }
+}
+
+// Keeps a node's replica of the device registry in step with the other
+// nodes' over `bus`. `registry` is this node's replica:
+//
+//   registry.localDevices()        this node's devices, as sent to others
+//   registry.nodeOf(id)            the node device `id` is on, if known
+//   registry.put(device, node)     adds or replaces a device of `node`
+//   registry.setReady(id, ready)
+//   registry.remove(id)
+//   registry.dropNode(node)        removes the devices of `node`, or of
+//                                  every other node when null
+//   registry.emitLocal(to, event, payload)  emits to a socket on this node
+//
+// A joining node learns the others' devices from them, and they learn its
+// devices from it. Returns what the node calls as its own devices change:
+//
+//   put(device), ready(id, ready), remove(id)
+//   emit(to, event, payload)       to device `to` on whichever node it is;
+//                                  true if it went to another node
+function replicate(bus, registry) {
+  function putDevices(list, node) {
+    if (!Array.isArray(list)) return;
+    for (const device of list) {
+      if (!device || typeof device.id !== 'string' || typeof device.group !== 'string') continue;
+      const owner = registry.nodeOf(device.id);
+      if (owner !== undefined && owner !== node) continue;
+      registry.put(device, node);
+    }
+  }
+
+  bus.on('message', (msg, from) => {
+    if (!msg) return;
+    const owned = typeof msg.id === 'string' && registry.nodeOf(msg.id) === from;
+    switch (msg.type) {
+      case 'put':
+        putDevices([msg.device], from);
+        break;
+      case 'ready':
+        if (owned) registry.setReady(msg.id, !!msg.ready);
+        break;
+      case 'remove':
+        if (owned) registry.remove(msg.id);
+        break;
+      case 'devices':
+        putDevices(msg.devices, from);
+        break;
+      case 'emit':
+        if (typeof msg.to === 'string' && typeof msg.event === 'string') {
+          registry.emitLocal(msg.to, msg.event, msg.payload);
+        }
+        break;
+    }
+  });
+  bus.on('connected', () => {
+    bus.publish({ type: 'devices', devices: registry.localDevices() });
+  });
+  bus.on('node-joined', (node) => {
+    bus.send(node, { type: 'devices', devices: registry.localDevices() });
+  });
+  bus.on('node-left', (node) => registry.dropNode(node));
+  bus.on('disconnected', () => registry.dropNode(null));
+
+  return {
+    put(device) {
+      bus.publish({ type: 'put', device: device });
+    },
+    ready(id, ready) {
+      bus.publish({ type: 'ready', id: id, ready: ready });
+    },
+    remove(id) {
+      bus.publish({ type: 'remove', id: id });
+    },
+    emit(to, event, payload) {
+      const node = registry.nodeOf(to);
+      if (node === undefined || node === bus.nodeId) {
+        registry.emitLocal(to, event, payload);
+        return false;
+      }
+      bus.send(node, { type: 'emit', to: to, event: event, payload: payload });
+      return true;
+    }
+  };
+}
+
+// The bus from the environment:
+//   SIGNALING_HUB      host:port of a hub to join; a single node without it
+//   SIGNALING_HUB_SECRET  the hub's secret (see hub.js)
+//   SIGNALING_NODE_ID  this node's id; a unique one by default
+function fromEnv(env = process.env) {
+  const nodeId = env.SIGNALING_NODE_ID || newNodeId();
+  const hub = env.SIGNALING_HUB;
+  if (!hub) return new MemoryHub().bus(nodeId);
+  const at = hub.lastIndexOf(':');
+  const host = at > 0 ? hub.slice(0, at) : '127.0.0.1';
+  const port = Number(at >= 0 ? hub.slice(at + 1) : hub);
+  return new TcpBus(host, port, env.SIGNALING_HUB_SECRET || '', nodeId);
+}
+
+module.exports = { MemoryHub, TcpBus, replicate, fromEnv, readLines, lineWriter, newNodeId };
@@ -0,0 +1,104 @@
+const crypto = require('crypto');
+const net = require('net');
+const logger = require('./logger').fromEnv();
+const { readLines, lineWriter } = require('./cluster');
+
+// Relays messages between signaling server nodes (see cluster.js), so
+// that several server.js processes, on one host or many, serve one set of
+// devices. Run it once and start each node with SIGNALING_HUB=host:port
+// and the hub's secret:
+//
+//   SIGNALING_HUB_SECRET=... HUB_PORT=3100 node hub.js
+//   SIGNALING_HUB_SECRET=... SIGNALING_HUB=hub-host:3100 PORT=3000 node server.js
+//   SIGNALING_HUB_SECRET=... SIGNALING_HUB=hub-host:3100 PORT=3001 node server.js
+//
+// A node can put devices into any group and emit to any device, so the hub
+// only admits nodes whose hello carries SIGNALING_HUB_SECRET, and refuses
+// to start without one. It listens on HUB_HOST, 127.0.0.1 by default; set
+// it to reach nodes on other hosts, over a network you trust, as the
+// connection is not encrypted.
+//
+// Clients may connect to any node. Socket.IO's polling transport needs a
+// load balancer with sticky sessions in front of the nodes; websocket
+// clients do not.
+//
+// The hub keeps no device state, only which nodes are connected: nodes
+// sync their registries with each other when one joins, and drop a node's
+// devices when the hub says it left.
+//
+// Node to hub:  {type: 'hello', node, secret}, then {type: 'publish', msg} or
+//               {type: 'send', to, msg}
+// Hub to node:  {type: 'welcome'}, {type: 'node-joined' | 'node-left', node}
+//               and {type: 'message', from, msg}
+
+// Compares secrets in time independent of where they differ.
+function secretMatches(given, secret) {
+  if (typeof given !== 'string') return false;
+  const digest = (value) => crypto.createHash('sha256').update(value).digest();
+  return crypto.timingSafeEqual(digest(given), digest(secret));
+}
+
+function startHub(port, host, secret, onListening) {
+  if (typeof secret !== 'string' || secret.length === 0) {
+    throw new Error('the hub needs a secret');
+  }
+  const nodes = new Map();
+
+  const server = net.createServer((socket) => {
+    socket.setNoDelay(true);
+    const write = lineWriter(socket);
+    let nodeId = null;
+
+    readLines(socket, (msg) => {
+      if (nodeId === null) {
+        if (msg.type !== 'hello' || typeof msg.node !== 'string' || nodes.has(msg.node) ||
+            !secretMatches(msg.secret, secret)) {
+          logger.warn('node-refused', { remoteAddress: socket.remoteAddress });
+          socket.destroy();
+          return;
+        }
+        nodeId = msg.node;
+        for (const other of nodes.values()) other({ type: 'node-joined', node: nodeId });
+        nodes.set(nodeId, write);
+        write({ type: 'welcome' });
+        logger.info('node-joined', { node: nodeId, nodes: nodes.size });
+        return;
+      }
+      if (msg.type === 'publish') {
+        const relayed = { type: 'message', from: nodeId, msg: msg.msg };
+        for (const [id, other] of nodes) {
+          if (id !== nodeId) other(relayed);
+        }
+      } else if (msg.type === 'send') {
+        const other = nodes.get(msg.to);
+        if (other) other({ type: 'message', from: nodeId, msg: msg.msg });
+      }
+    }, () => socket.destroy());
+
+    socket.on('error', () => {});
+    socket.on('close', () => {
+      if (nodeId === null || nodes.get(nodeId) !== write) return;
+      nodes.delete(nodeId);
+      for (const other of nodes.values()) other({ type: 'node-left', node: nodeId });
+      logger.info('node-left', { node: nodeId, nodes: nodes.size });
+    });
+  });
+
+  server.listen(port, host, onListening);
+  return server;
+}
+
+module.exports = { startHub };
+
+if (require.main === module) {
+  const port = Number(process.env.HUB_PORT || 3100);
+  const host = process.env.HUB_HOST || '127.0.0.1';
+  const secret = process.env.SIGNALING_HUB_SECRET;
+  if (!secret) {
+    logger.error('hub-refused-to-start', { reason: 'SIGNALING_HUB_SECRET is not set' });
+    process.exit(1);
+  }
+  startHub(port, host, secret, () => {
+    logger.info('hub-started', { host: host, port: port });
+  });
+}
@@ -0,0 +1,236 @@
+const fs = require('fs');
+const os = require('os');
+
+// Structured logging that stays off the event loop's back.
+//
+// Each record is one line of NDJSON:
+//   {"time":"2024-01-01T00:00:00.000Z","level":"info","event":"register",...}
+//
+// Records below the level, or not picked by their event's sample rate, are
+// dropped before anything is formatted; `data` may be a function so that
+// even building the fields is skipped. Kept records wait in a bounded ring
+// and are written in batches, one write per turn of the event loop, by an
+// asynchronous writer: file writes on libuv's thread pool when a path is
+// given, else stdout. When the writer falls behind and the ring fills,
+// new records are counted and dropped rather than queued without bound,
+// and a 'log-dropped' record says how many.
+//
+// What is still queued is written synchronously when the process exits,
+// including on SIGINT and SIGTERM, which fromEnv() turns into an exit.
+//
+// Configured from the environment by fromEnv():
+//   LOG_LEVEL   debug, info (default), warn or error
+//   LOG_SAMPLE  per-event sample rates, e.g. "webrtc-signal=0.01,register=0.1"
+//   LOG_FILE    append to this file instead of stdout
+
+const LEVELS = { debug: 10, info: 20, warn: 30, error: 40 };
+const DEFAULT_CAPACITY = 16384;
+
+// Parses "event=rate,event=rate". Rates are clamped to [0, 1].
+function parseSampleRates(spec) {
+  const rates = {};
+  for (const part of (spec || '').split(',')) {
+    const at = part.indexOf('=');
+    if (at <= 0) continue;
+    const rate = Number(part.slice(at + 1));
+    if (!Number.isNaN(rate)) {
+      rates[part.slice(0, at).trim()] = Math.min(1, Math.max(0, rate));
+    }
+  }
+  return rates;
+}
+
+class Logger {
+  // options:
+  //   level     lowest level written
+  //   sample    { event: rate } for info and debug records; warnings and
+  //             errors are always kept
+  //   capacity  records held while the writer is busy
+  //   write     (chunk, done) => bool: writes a string, returns false if
+  //             the caller should wait for done() before writing again
+  constructor(options = {}) {
+    this.threshold = LEVELS[options.level] || LEVELS.info;
+    // Keep one record in `every` for sampled events, deterministically.
+    this.every = new Map();
+    this.seen = new Map();
+    for (const [event, rate] of Object.entries(options.sample || {})) {
+      this.every.set(event, rate > 0 ? Math.round(1 / rate) : Infinity);
+      this.seen.set(event, 0);
+    }
+    this.capacity = options.capacity || DEFAULT_CAPACITY;
+    this.ring = new Array(this.capacity);
+    this.head = 0;
+    this.count = 0;
+    this.dropped = 0;
+    this.write = options.write;
+    this.writing = false;
+    this.scheduled = false;
+    this.drain = this.drain.bind(this);
+  }
+
+  debug(event, data) { this.log('debug', event, data); }
+  info(event, data) { this.log('info', event, data); }
+  warn(event, data) { this.log('warn', event, data); }
+  error(event, data) { this.log('error', event, data); }
+
+  // Whether records at `level` are written at all, before sampling.
+  enabled(level) {
+    return LEVELS[level] >= this.threshold;
+  }
+
+  log(level, event, data) {
+    const value = LEVELS[level];
+    if (value < this.threshold) return;
+    if (value < LEVELS.warn) {
+      const every = this.every.get(event);
+      if (every !== undefined) {
+        const seen = this.seen.get(event);
+        this.seen.set(event, seen + 1);
+        if (every === Infinity || seen % every !== 0) return;
+      }
+    }
+    if (this.count === this.capacity) {
+      this.dropped++;
+      return;
+    }
+    if (typeof data === 'function') data = data();
+    this.ring[(this.head + this.count) % this.capacity] = format(level, event, data);
+    this.count++;
+    if (!this.scheduled && !this.writing) {
+      this.scheduled = true;
+      setImmediate(this.drain);
+    }
+  }
+
+  // Hands everything in the ring to the writer as one chunk.
+  drain() {
+    this.scheduled = false;
+    if (this.writing || (this.count === 0 && this.dropped === 0)) return;
+    const chunk = this.take();
+    this.writing = true;
+    const done = () => {
+      this.writing = false;
+      if (this.count > 0 || this.dropped > 0) this.drain();
+    };
+    if (this.write(chunk, done) !== false) {
+      // Accepted without waiting; let other work run before the next batch.
+      this.writing = false;
+      if ((this.count > 0 || this.dropped > 0) && !this.scheduled) {
+        this.scheduled = true;
+        setImmediate(this.drain);
+      }
+    }
+  }
+
+  // Hands what is left to `writeSync`, for process exit.
+  flushSync(writeSync) {
+    if (this.count > 0 || this.dropped > 0) {
+      try {
+        writeSync(this.take());
+      } catch (e) {
+        // Nowhere left to report it.
+      }
+    }
+  }
+
+  take() {
+    let chunk = '';
+    if (this.dropped > 0) {
+      chunk = format('warn', 'log-dropped', { records: this.dropped }) + '\n';
+      this.dropped = 0;
+    }
+    for (; this.count > 0; this.count--) {
+      chunk += this.ring[this.head] + '\n';
+      this.ring[this.head] = undefined;
+      this.head = (this.head + 1) % this.capacity;
+    }
+    this.head = 0;
+    return chunk;
+  }
+}
+
+// Records in the same millisecond share one timestamp string.
+let lastTime = 0;
+let lastTimeString = '';
+
+function timestamp() {
+  const now = Date.now();
+  if (now !== lastTime) {
+    lastTime = now;
+    lastTimeString = new Date(now).toISOString();
+  }
+  return lastTimeString;
+}
+
+function format(level, event, data) {
+  let line = '{"time":"' + timestamp() + '","level":"' + level +
+    '","event":' + JSON.stringify(event);
+  if (data !== undefined && data !== null) {
+    const fields = JSON.stringify(data);
+    if (fields.length > 2 && fields[0] === '{') {
+      line += ',' + fields.slice(1);
+      return line;
+    }
+    if (fields[0] !== '{') line += ',"data":' + fields;
+  }
+  return line + '}';
+}
+
+// A writer for a Node stream that honours its backpressure.
+function streamWriter(stream) {
+  return (chunk, done) => {
+    if (stream.write(chunk)) return true;
+    stream.once('drain', done);
+    return false;
+  };
+}
+
+// A writer that appends to the file at `path` with one write in flight at
+// a time. Nothing waits behind it in a stream's buffer, so a synchronous
+// write to `writer.fd` at exit follows everything handed over before.
+function fileWriter(path) {
+  const fd = fs.openSync(path, 'a');
+  const writer = (chunk, done) => {
+    const buffer = Buffer.from(chunk);
+    const writeFrom = (offset) => {
+      fs.write(fd, buffer, offset, buffer.length - offset, null, (err, written) => {
+        if (!err && offset + written < buffer.length) {
+          writeFrom(offset + written);
+        } else {
+          done();
+        }
+      });
+    };
+    writeFrom(0);
+    return false;
+  };
+  writer.fd = fd;
+  return writer;
+}
+
+// Node skips 'exit' when SIGINT or SIGTERM ends the process, so a normal
+// stop would lose the queued records; exiting from the signal flushes them.
+let exitsOnSignals = false;
+
+function exitOnSignals() {
+  if (exitsOnSignals) return;
+  exitsOnSignals = true;
+  for (const signal of ['SIGINT', 'SIGTERM']) {
+    process.once(signal, () => process.exit(128 + os.constants.signals[signal]));
+  }
+}
+
+function fromEnv(env = process.env) {
+  const write = env.LOG_FILE ? fileWriter(env.LOG_FILE) : streamWriter(process.stdout);
+  const logger = new Logger({
+    level: env.LOG_LEVEL,
+    sample: parseSampleRates(env.LOG_SAMPLE),
+    write: write
+  });
+  const fd = env.LOG_FILE ? write.fd : 1;
+  process.on('exit', () => logger.flushSync(chunk => fs.writeSync(fd, chunk)));
+  exitOnSignals();
+  return logger;
+}
+
+module.exports = { Logger, fromEnv, parseSampleRates, streamWriter, fileWriter };
@@ -0,0 +1,202 @@
+// Counters, gauges and histograms for the Prometheus text format.
+//
+// Every metric is kept as it changes; rendering walks the metrics, never the
+// devices or sockets they describe, so a scrape costs the same for ten
+// devices as for ten thousand. Label values are fixed when the child is
+// created with labels(...), and the returned child is cheap to keep.
+//
+//   const registry = new Registry();
+//   const events = registry.counter('events_total', 'Events.', ['event']);
+//   events.labels('register').inc();
+//   res.type(CONTENT_TYPE).send(registry.render());
+
+const CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8';
+
+function escapeLabel(value) {
+  return String(value).replace(/\\/g, '\\\\').replace(/\n/g, '\\n').replace(/"/g, '\\"');
+}
+
+function labelText(names, values, extra) {
+  const parts = names.map((name, i) => `${name}="${escapeLabel(values[i])}"`);
+  if (extra) parts.push(extra);
+  return parts.length > 0 ? `{${parts.join(',')}}` : '';
+}
+
+function formatValue(value) {
+  if (value === Infinity) return '+Inf';
+  if (value === -Infinity) return '-Inf';
+  return String(value);
+}
+
+// Base for metrics with labelled children. Unlabelled metrics have one
+// child, used through the metric itself.
+class Metric {
+  constructor(type, name, help, labelNames) {
+    this.type = type;
+    this.name = name;
+    this.help = help;
+    this.labelNames = labelNames || [];
+    this.children = new Map();
+    this.only = null;
+  }
+
+  // Called at the end of subclass constructors, once createChild() works.
+  ready() {
+    if (this.labelNames.length === 0) this.only = this.labels();
+    return this;
+  }
+
+  labels(...values) {
+    const key = values.join('\u0000');
+    let child = this.children.get(key);
+    if (!child) {
+      if (values.length !== this.labelNames.length) {
+        throw new Error(`${this.name} takes labels ${this.labelNames.join(', ')}`);
+      }
+      child = this.createChild();
+      child.values = values;
+      this.children.set(key, child);
+    }
+    return child;
+  }
+
+  render(lines) {
+    lines.push(`# HELP ${this.name} ${this.help}`);
+    lines.push(`# TYPE ${this.name} ${this.type}`);
+    for (const child of this.children.values()) {
+      this.renderChild(lines, child, child.values);
+    }
+  }
+}
+
+class Counter extends Metric {
+  constructor(name, help, labelNames) {
+    super('counter', name, help, labelNames);
+    this.ready();
+  }
+
+  createChild() {
+    return { value: 0, inc(n = 1) { this.value += n; } };
+  }
+
+  inc(n = 1) { this.only.value += n; }
+
+  renderChild(lines, child, values) {
+    lines.push(`${this.name}${labelText(this.labelNames, values)} ${formatValue(child.value)}`);
+  }
+}
+
+// A gauge is either set as things change or, given `collect`, read when
+// rendered; `collect` must then be cheap, e.g. a counter kept elsewhere.
+class Gauge extends Metric {
+  constructor(name, help, labelNames, collect) {
+    super('gauge', name, help, labelNames);
+    this.collect = collect;
+    this.ready();
+  }
+
+  createChild() {
+    return {
+      value: 0,
+      set(v) { this.value = v; },
+      inc(n = 1) { this.value += n; },
+      dec(n = 1) { this.value -= n; }
+    };
+  }
+
+  set(v) { this.only.value = v; }
+  inc(n = 1) { this.only.value += n; }
+  dec(n = 1) { this.only.value -= n; }
+
+  renderChild(lines, child, values) {
+    const value = this.collect && values.length === 0 ? this.collect() : child.value;
+    lines.push(`${this.name}${labelText(this.labelNames, values)} ${formatValue(value)}`);
+  }
+}
+
+class Histogram extends Metric {
+  // `buckets` are upper bounds in ascending order; +Inf is implied.
+  constructor(name, help, labelNames, buckets) {
+    super('histogram', name, help, labelNames);
+    this.bounds = buckets.slice();
+    this.ready();
+  }
+
+  createChild() {
+    const bounds = this.bounds;
+    return {
+      counts: new Array(bounds.length + 1).fill(0),
+      sum: 0,
+      count: 0,
+      observe(v) {
+        let i = 0;
+        while (i < bounds.length && v > bounds[i]) i++;
+        this.counts[i]++;
+        this.sum += v;
+        this.count++;
+      }
+    };
+  }
+
+  observe(v) { this.only.observe(v); }
+
+  renderChild(lines, child, values) {
+    let cumulative = 0;
+    for (let i = 0; i <= this.bounds.length; i++) {
+      cumulative += child.counts[i];
+      const le = i < this.bounds.length ? formatValue(this.bounds[i]) : '+Inf';
+      lines.push(`${this.name}_bucket${labelText(this.labelNames, values, `le="${le}"`)} ${cumulative}`);
+    }
+    const labels = labelText(this.labelNames, values);
+    lines.push(`${this.name}_sum${labels} ${formatValue(child.sum)}`);
+    lines.push(`${this.name}_count${labels} ${child.count}`);
+  }
+}
+
+class Registry {
+  constructor() {
+    this.metrics = [];
+  }
+
+  counter(name, help, labelNames) {
+    return this.add(new Counter(name, help, labelNames));
+  }
+
+  gauge(name, help, labelNames, collect) {
+    return this.add(new Gauge(name, help, labelNames, collect));
+  }
+
+  histogram(name, help, labelNames, buckets) {
+    return this.add(new Histogram(name, help, labelNames, buckets));
+  }
+
+  add(metric) {
+    this.metrics.push(metric);
+    return metric;
+  }
+
+  render() {
+    const lines = [];
+    for (const metric of this.metrics) metric.render(lines);
+    return lines.join('\n') + '\n';
+  }
+}
+
+// Samples how late timers fire, which is how long the event loop was busy
+// with other work, into `histogram` (in seconds) every `intervalMs`. The
+// timer does not keep the process alive.
+function monitorEventLoopLag(histogram, intervalMs = 100) {
+  let expected = 0;
+  let timer = null;
+  const tick = () => {
+    const now = Number(process.hrtime.bigint()) / 1e6;
+    if (expected > 0) histogram.observe(Math.max(0, now - expected) / 1000);
+    expected = now + intervalMs;
+    timer = setTimeout(tick, intervalMs);
+    timer.unref();
+  };
+  tick();
+  return () => clearTimeout(timer);
+}
+
+module.exports = { CONTENT_TYPE, Registry, Counter, Gauge, Histogram, monitorEventLoopLag };
@@ -0,0 +1,316 @@
+#include "device_registry.h"
+
+#include <mutex>
+
+#include "json.h"
+
+namespace sc {
+namespace signaling {
+
+DeviceRegistry::DeviceRegistry(SharerPolicy policy) : policy_(policy) {}
+
+DeviceRegistry::~DeviceRegistry() {}
+
+bool DeviceRegistry::Register(const DeviceInfo& device,
+                              DeviceChange* change) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Entry* entry = FindLocked(device.id);
+  if (entry != nullptr && entry->info.group == device.group) {
+    Group* group = FindGroupLocked(device.group);
+    if (entry->info.ready_to_share) {
+      group->ready.Remove(device.id);
+      ready_total_--;
+    }
+    entry->info = device;
+    if (device.ready_to_share) {
+      group->ready.MarkReady(device.id);
+      ready_total_++;
+    }
+    RecordLocked(group, DeviceChange::Kind::kUpdate, device, change);
+    UpdateCountsLocked();
+    return false;
+  }
+  const bool added = entry == nullptr;
+  if (entry != nullptr) {
+    LeaveGroupLocked(*entry);
+  } else {
+    entry = &devices_[device.id];
+    entry->order = next_order_++;
+  }
+  entry->info = device;
+  auto inserted = groups_.try_emplace(device.group, policy_);
+  Group& group = inserted.first->second;
+  if (inserted.second) {
+    // Past every version this group may have had before.
+    group.version = version_.load(std::memory_order_relaxed);
+  }
+  group.by_order.emplace(entry->order, entry);
+  if (device.ready_to_share) {
+    group.ready.MarkReady(device.id);
+    ready_total_++;
+  }
+  RecordLocked(&group, DeviceChange::Kind::kAdd, device, change);
+  UpdateCountsLocked();
+  return added;
+}
+
+bool DeviceRegistry::Unregister(std::string_view id, DeviceChange* change) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto it = devices_.find(std::string(id));
+  if (it == devices_.end()) {
+    if (change != nullptr) {
+      change->version = 0;
+    }
+    return false;
+  }
+  RecordLocked(FindGroupLocked(it->second.info.group),
+               DeviceChange::Kind::kRemove, it->second.info, change);
+  LeaveGroupLocked(it->second);
+  devices_.erase(it);
+  UpdateCountsLocked();
+  return true;
+}
+
+bool DeviceRegistry::SetReady(std::string_view id, bool ready,
+                              DeviceChange* change) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  if (change != nullptr) {
+    change->version = 0;
+  }
+  Entry* entry = FindLocked(id);
+  if (entry == nullptr) {
+    return false;
+  }
+  Group* group = FindGroupLocked(entry->info.group);
+  if (ready) {
+    group->ready.MarkReady(entry->info.id);
+  }
+  if (entry->info.ready_to_share != ready) {
+    entry->info.ready_to_share = ready;
+    if (ready) {
+      ready_total_++;
+    } else {
+      group->ready.Remove(entry->info.id);
+      ready_total_--;
+    }
+    RecordLocked(group, DeviceChange::Kind::kReady, entry->info, change);
+    UpdateCountsLocked();
+  }
+  return true;
+}
+
+bool DeviceRegistry::Find(std::string_view id, DeviceInfo* device) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  const Entry* entry = FindLocked(id);
+  if (entry == nullptr) {
+    return false;
+  }
+  *device = entry->info;
+  return true;
+}
+
+bool DeviceRegistry::InGroup(std::string_view id,
+                             std::string_view group) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  const Entry* entry = FindLocked(id);
+  return entry != nullptr && entry->info.group == group;
+}
+
+bool DeviceRegistry::PickSharer(std::string_view group_name,
+                                std::string_view requester,
+                                std::string_view preferred,
+                                std::string* id) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Group* group = FindGroupLocked(group_name);
+  if (group == nullptr) {
+    return false;
+  }
+  if (!preferred.empty() && preferred != requester &&
+      group->ready.Contains(preferred)) {
+    *id = preferred;
+  } else if (!group->ready.Pick(requester, id)) {
+    return false;
+  }
+  group->ready.CountRequest(*id);
+  return true;
+}
+
+std::vector<DeviceInfo> DeviceRegistry::List(
+    std::string_view group_name) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::vector<DeviceInfo> devices;
+  const Group* group = FindGroupLocked(group_name);
+  if (group == nullptr) {
+    return devices;
+  }
+  devices.reserve(group->by_order.size());
+  for (const auto& entry : group->by_order) {
+    devices.push_back(entry.second->info);
+  }
+  return devices;
+}
+
+std::shared_ptr<const std::string> DeviceRegistry::ListJson(
+    std::string_view group_name) const {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Group* group = FindGroupLocked(group_name);
+    if (group == nullptr) {
+      static const auto* const kEmpty =
+          new std::shared_ptr<const std::string>(
+              std::make_shared<std::string>("[]"));
+      return *kEmpty;
+    }
+    if (group->list_json) {
+      return group->list_json;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Group* group = FindGroupLocked(group_name);
+  if (group == nullptr) {
+    lock.unlock();
+    return ListJson(group_name);
+  }
+  if (!group->list_json) {
+    auto json = std::make_shared<std::string>("[");
+    for (const auto& entry : group->by_order) {
+      if (json->size() > 1) {
+        *json += ',';
+      }
+      AppendDeviceJson(json.get(), entry.second->info);
+    }
+    *json += ']';
+    group->list_json = std::move(json);
+  }
+  return group->list_json;
+}
+
+std::shared_ptr<const std::string> DeviceRegistry::SnapshotJson(
+    std::string_view group_name) const {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Group* group = FindGroupLocked(group_name);
+    if (group != nullptr && group->snapshot_json) {
+      return group->snapshot_json;
+    }
+  }
+  const std::shared_ptr<const std::string> list = ListJson(group_name);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Group* group = FindGroupLocked(group_name);
+  if (group == nullptr) {
+    return std::make_shared<std::string>(
+        "{\"version\":0,\"devices\":[]}");
+  }
+  // The list may be from an older version by now; only one that is still
+  // current is cached.
+  if (!group->snapshot_json && list == group->list_json) {
+    group->snapshot_json = std::make_shared<std::string>(
+        "{\"version\":" + std::to_string(group->version) +
+        ",\"devices\":" + *list + "}");
+  }
+  if (group->snapshot_json) {
+    return group->snapshot_json;
+  }
+  lock.unlock();
+  return SnapshotJson(group_name);
+}
+
+uint64_t DeviceRegistry::Version(std::string_view group_name) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  const Group* group = FindGroupLocked(group_name);
+  return group == nullptr ? 0 : group->version;
+}
+
+void DeviceRegistry::LeaveGroupLocked(const Entry& entry) {
+  auto it = groups_.find(entry.info.group);
+  Group& group = it->second;
+  group.by_order.erase(entry.order);
+  if (group.ready.Remove(entry.info.id)) {
+    ready_total_--;
+  }
+  group.list_json.reset();
+  group.snapshot_json.reset();
+  if (group.by_order.empty()) {
+    groups_.erase(it);
+  }
+}
+
+void DeviceRegistry::RecordLocked(Group* group, DeviceChange::Kind kind,
+                                  const DeviceInfo& info,
+                                  DeviceChange* change) {
+  group->list_json.reset();
+  group->snapshot_json.reset();
+  group->version++;
+  version_.store(version_.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+  if (change != nullptr) {
+    change->kind = kind;
+    change->version = group->version;
+    change->device = info;
+  }
+}
+
+void DeviceRegistry::UpdateCountsLocked() {
+  size_.store(devices_.size(), std::memory_order_relaxed);
+  ready_count_.store(ready_total_, std::memory_order_relaxed);
+  group_count_.store(groups_.size(), std::memory_order_relaxed);
+}
+
+DeviceRegistry::Entry* DeviceRegistry::FindLocked(std::string_view id) {
+  auto it = devices_.find(std::string(id));
+  return it == devices_.end() ? nullptr : &it->second;
+}
+
+const DeviceRegistry::Entry* DeviceRegistry::FindLocked(
+    std::string_view id) const {
+  auto it = devices_.find(std::string(id));
+  return it == devices_.end() ? nullptr : &it->second;
+}
+
+DeviceRegistry::Group* DeviceRegistry::FindGroupLocked(
+    std::string_view group) const {
+  auto it = groups_.find(std::string(group));
+  return it == groups_.end() ? nullptr : &it->second;
+}
+
+void AppendDeviceJson(std::string* out, const DeviceInfo& device) {
+  *out += "{\"id\":";
+  json::AppendString(out, device.id);
+  *out += ",\"deviceId\":";
+  json::AppendString(out, device.id);
+  *out += ",\"socketId\":";
+  json::AppendString(out, device.id);
+  *out += ",\"name\":";
+  json::AppendString(out, device.name);
+  *out += ",\"readyToShare\":";
+  *out += device.ready_to_share ? "true" : "false";
+  *out += '}';
+}
+
+void AppendChangeJson(std::string* out, const DeviceChange& change) {
+  switch (change.kind) {
+    case DeviceChange::Kind::kAdd:
+    case DeviceChange::Kind::kUpdate:
+      *out += change.kind == DeviceChange::Kind::kAdd
+                  ? "{\"op\":\"add\",\"device\":"
+                  : "{\"op\":\"update\",\"device\":";
+      AppendDeviceJson(out, change.device);
+      *out += '}';
+      return;
+    case DeviceChange::Kind::kRemove:
+      *out += "{\"op\":\"remove\",\"deviceId\":";
+      json::AppendString(out, change.device.id);
+      *out += '}';
+      return;
+    case DeviceChange::Kind::kReady:
+      *out += "{\"op\":\"ready\",\"deviceId\":";
+      json::AppendString(out, change.device.id);
+      *out += ",\"readyToShare\":";
+      *out += change.device.ready_to_share ? "true" : "false";
+      *out += '}';
+      return;
+  }
+}
+
+}  // namespace signaling
+}  // namespace sc
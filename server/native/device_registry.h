@@ -0,0 +1,183 @@
+#ifndef SERVER_NATIVE_DEVICE_REGISTRY_H_
+#define SERVER_NATIVE_DEVICE_REGISTRY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "sharer_index.h"
+
+namespace sc {
+namespace signaling {
+
+// Longest group key accepted at registration.
+constexpr size_t kMaxGroupSize = 128;
+
+struct DeviceInfo {
+  std::string id;  // the device's Socket.IO id
+  // Pairing group the device registered with. Devices see, and share with,
+  // only the devices in their own group. Empty is the group of every device
+  // that sent none.
+  std::string group;
+  std::string name;
+  std::string platform;
+  bool ready_to_share = false;
+};
+
+// One change to a group, numbered with the version of the group it
+// produced. Clients that register with "deltas" receive these, in version
+// order, instead of whole lists.
+struct DeviceChange {
+  enum class Kind { kAdd, kUpdate, kRemove, kReady };
+
+  Kind kind = Kind::kAdd;
+  uint64_t version = 0;  // 0 when nothing changed
+  DeviceInfo device;  // as it is after the change, or was before kRemove
+};
+
+// Devices that have sent 'register', shared by all shards, by group.
+//
+// Within a group, devices keep the order they first registered in, which is
+// the order the Node server lists them in. Ready devices are indexed by the
+// sharer policy so request-share picks one in O(1) rather than scanning the
+// group, the counts are kept as they change, and each group's JSON device
+// list is encoded once per change rather than once per request.
+//
+// Every change to a group bumps its version by one and is described by a
+// DeviceChange, so a client holding the group's snapshot of version V stays
+// current by applying the changes numbered V+1, V+2 and so on. A group is
+// dropped with its last device; if it comes back, its versions start past
+// any it had before, so late changes from its earlier life are never taken
+// for new ones.
+//
+// Thread-safe.
+class DeviceRegistry {
+ public:
+  explicit DeviceRegistry(SharerPolicy policy = SharerPolicy::kMostRecent);
+  ~DeviceRegistry();
+
+  // Prevent copying.
+  DeviceRegistry(DeviceRegistry const&) = delete;
+  DeviceRegistry& operator=(DeviceRegistry const&) = delete;
+
+  // Adds |device|, or replaces the registration with the same id while
+  // keeping its place in the order. Returns true if the id was new.
+  // |change|, if given, receives what changed. A device that moves to
+  // another group leaves its old one unannounced, so callers unregister it
+  // first.
+  bool Register(const DeviceInfo& device, DeviceChange* change = nullptr);
+
+  // Returns false if |id| was not registered.
+  bool Unregister(std::string_view id, DeviceChange* change = nullptr);
+
+  // Returns false if |id| is not registered. Setting the state a device
+  // already has changes nothing, and leaves |change->version| zero, but a
+  // ready device that says so again counts as the most recently ready.
+  bool SetReady(std::string_view id, bool ready,
+                DeviceChange* change = nullptr);
+
+  bool Find(std::string_view id, DeviceInfo* device) const;
+
+  // Whether |id| is registered in |group|.
+  bool InGroup(std::string_view id, std::string_view group) const;
+
+  // Picks the device in |group| to ask for its clipboard on a request-share
+  // from |requester|: |preferred| if it names another ready device in the
+  // group, else the one the sharer policy picks. The request counts
+  // against the device's load. Returns false if no other device in the
+  // group is ready.
+  bool PickSharer(std::string_view group, std::string_view requester,
+                  std::string_view preferred, std::string* id);
+
+  // Devices in |group|, in registration order.
+  std::vector<DeviceInfo> List(std::string_view group) const;
+
+  // JSON array of the devices in |group| as sent in the 'devices' event.
+  // Shared until the group changes.
+  std::shared_ptr<const std::string> ListJson(std::string_view group) const;
+
+  // JSON object holding the group's version and device list, as sent in
+  // the 'device-snapshot' event. Shared until the group changes.
+  std::shared_ptr<const std::string> SnapshotJson(
+      std::string_view group) const;
+
+  // Version of |group|, or 0 if it has no devices.
+  uint64_t Version(std::string_view group) const;
+
+  // Number of changes made so far, in all groups.
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+  size_t ready_count() const {
+    return ready_count_.load(std::memory_order_relaxed);
+  }
+  size_t group_count() const {
+    return group_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Entry {
+    DeviceInfo info;
+    uint64_t order = 0;
+  };
+
+  struct Group {
+    explicit Group(SharerPolicy policy) : ready(policy) {}
+
+    std::map<uint64_t, const Entry*> by_order;
+    SharerIndex ready;
+    uint64_t version = 0;
+    // Null when stale.
+    std::shared_ptr<const std::string> list_json;
+    std::shared_ptr<const std::string> snapshot_json;
+  };
+
+  // Removes |entry| from its group, dropping the group if it empties.
+  void LeaveGroupLocked(const Entry& entry);
+
+  // Bumps the versions and fills |change| for a change to |info| in
+  // |group|.
+  void RecordLocked(Group* group, DeviceChange::Kind kind,
+                    const DeviceInfo& info, DeviceChange* change);
+
+  void UpdateCountsLocked();
+
+  Entry* FindLocked(std::string_view id);
+  const Entry* FindLocked(std::string_view id) const;
+  Group* FindGroupLocked(std::string_view group) const;
+
+  const SharerPolicy policy_;
+  mutable std::shared_mutex mutex_;
+  // Guarded by |mutex_|.
+  std::unordered_map<std::string, Entry> devices_;
+  // Mutable for the JSON caches.
+  mutable std::unordered_map<std::string, Group> groups_;
+  uint64_t next_order_ = 0;
+  size_t ready_total_ = 0;
+
+  std::atomic<size_t> size_{0};
+  std::atomic<size_t> ready_count_{0};
+  std::atomic<size_t> group_count_{0};
+  std::atomic<uint64_t> version_{0};  // written under |mutex_|
+};
+
+// Appends the JSON object describing |device| in device lists.
+void AppendDeviceJson(std::string* out, const DeviceInfo& device);
+
+// Appends the JSON object describing |change| in 'device-delta' events:
+//   {"op":"add","device":{...}}, also "update" for a re-registration
+//   {"op":"remove","deviceId":"..."}
+//   {"op":"ready","deviceId":"...","readyToShare":true}
+void AppendChangeJson(std::string* out, const DeviceChange& change);
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_DEVICE_REGISTRY_H_
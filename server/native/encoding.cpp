@@ -0,0 +1,163 @@
+#include "encoding.h"
+
+#include <cstring>
+
+namespace sc {
+namespace signaling {
+
+namespace {
+
+constexpr char kBase64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr char kBase64Url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+uint32_t RotateLeft(uint32_t value, int bits) {
+  return (value << bits) | (value >> (32 - bits));
+}
+
+void Sha1Block(uint32_t state[5], const uint8_t block[64]) {
+  uint32_t w[80];
+  for (int i = 0; i < 16; i++) {
+    w[i] = static_cast<uint32_t>(block[4 * i]) << 24 |
+           static_cast<uint32_t>(block[4 * i + 1]) << 16 |
+           static_cast<uint32_t>(block[4 * i + 2]) << 8 |
+           static_cast<uint32_t>(block[4 * i + 3]);
+  }
+  for (int i = 16; i < 80; i++) {
+    w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+  }
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3],
+           e = state[4];
+  for (int i = 0; i < 80; i++) {
+    uint32_t f, k;
+    if (i < 20) {
+      f = (b & c) | (~b & d);
+      k = 0x5a827999;
+    } else if (i < 40) {
+      f = b ^ c ^ d;
+      k = 0x6ed9eba1;
+    } else if (i < 60) {
+      f = (b & c) | (b & d) | (c & d);
+      k = 0x8f1bbcdc;
+    } else {
+      f = b ^ c ^ d;
+      k = 0xca62c1d6;
+    }
+    const uint32_t temp = RotateLeft(a, 5) + f + e + k + w[i];
+    e = d;
+    d = c;
+    c = RotateLeft(b, 30);
+    b = a;
+    a = temp;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+}
+
+std::string Encode(const uint8_t* data, size_t length, const char* alphabet,
+                   bool pad) {
+  std::string out;
+  out.reserve((length + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 3 <= length; i += 3) {
+    const uint32_t n = data[i] << 16 | data[i + 1] << 8 | data[i + 2];
+    out += alphabet[n >> 18];
+    out += alphabet[(n >> 12) & 63];
+    out += alphabet[(n >> 6) & 63];
+    out += alphabet[n & 63];
+  }
+  if (i + 1 == length) {
+    const uint32_t n = data[i] << 16;
+    out += alphabet[n >> 18];
+    out += alphabet[(n >> 12) & 63];
+    if (pad) {
+      out += "==";
+    }
+  } else if (i + 2 == length) {
+    const uint32_t n = data[i] << 16 | data[i + 1] << 8;
+    out += alphabet[n >> 18];
+    out += alphabet[(n >> 12) & 63];
+    out += alphabet[(n >> 6) & 63];
+    if (pad) {
+      out += '=';
+    }
+  }
+  return out;
+}
+
+int UrlValue(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '-') return 62;
+  if (c == '_') return 63;
+  return -1;
+}
+
+}  // namespace
+
+void Sha1(const void* data, size_t length, uint8_t digest[kSha1DigestSize]) {
+  uint32_t state[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476,
+                       0xc3d2e1f0};
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  size_t done = 0;
+  for (; done + 64 <= length; done += 64) {
+    Sha1Block(state, bytes + done);
+  }
+  uint8_t tail[128] = {};
+  const size_t rest = length - done;
+  std::memcpy(tail, bytes + done, rest);
+  tail[rest] = 0x80;
+  const size_t tail_size = rest + 9 <= 64 ? 64 : 128;
+  const uint64_t bits = static_cast<uint64_t>(length) * 8;
+  for (int i = 0; i < 8; i++) {
+    tail[tail_size - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+  }
+  Sha1Block(state, tail);
+  if (tail_size == 128) {
+    Sha1Block(state, tail + 64);
+  }
+  for (int i = 0; i < 5; i++) {
+    digest[4 * i] = static_cast<uint8_t>(state[i] >> 24);
+    digest[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+    digest[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+    digest[4 * i + 3] = static_cast<uint8_t>(state[i]);
+  }
+}
+
+std::string Base64Encode(const uint8_t* data, size_t length) {
+  return Encode(data, length, kBase64, true);
+}
+
+std::string Base64UrlEncode(const uint8_t* data, size_t length) {
+  return Encode(data, length, kBase64Url, false);
+}
+
+bool Base64UrlDecode(std::string_view text, uint8_t* out) {
+  if (text.size() % 4 == 1) {
+    return false;
+  }
+  uint32_t bits = 0;
+  int count = 0;
+  size_t written = 0;
+  for (char c : text) {
+    const int value = UrlValue(c);
+    if (value < 0) {
+      return false;
+    }
+    bits = bits << 6 | static_cast<uint32_t>(value);
+    count += 6;
+    if (count >= 8) {
+      count -= 8;
+      out[written++] = static_cast<uint8_t>(bits >> count);
+    }
+  }
+  return true;
+}
+
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,31 @@
+#ifndef SERVER_NATIVE_ENCODING_H_
+#define SERVER_NATIVE_ENCODING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sc {
+namespace signaling {
+
+constexpr size_t kSha1DigestSize = 20;
+
+// SHA-1 of |data|. Only used for the WebSocket handshake, which requires it.
+void Sha1(const void* data, size_t length, uint8_t digest[kSha1DigestSize]);
+
+// Standard base64 with padding.
+std::string Base64Encode(const uint8_t* data, size_t length);
+
+// URL-safe base64 without padding, as used for Socket.IO ids.
+std::string Base64UrlEncode(const uint8_t* data, size_t length);
+
+// Decodes URL-safe base64 without padding into |out|, which must have room
+// for text.size() * 3 / 4 bytes. Returns false on characters outside the
+// alphabet or an impossible length.
+bool Base64UrlDecode(std::string_view text, uint8_t* out);
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_ENCODING_H_
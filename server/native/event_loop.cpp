@@ -0,0 +1,163 @@
+#include "event_loop.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+
+namespace sc {
+namespace signaling {
+
+namespace {
+
+constexpr int kMaxEvents = 256;
+
+}  // namespace
+
+EventLoop::EventLoop() {}
+
+EventLoop::~EventLoop() {
+  if (wake_fd_ >= 0) {
+    ::close(wake_fd_);
+  }
+  if (epoll_fd_ >= 0) {
+    ::close(epoll_fd_);
+  }
+}
+
+bool EventLoop::Init() {
+  epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_fd_ < 0 || wake_fd_ < 0) {
+    return false;
+  }
+  // The wake-up descriptor is the only one registered without a handler.
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.ptr = nullptr;
+  return ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) == 0;
+}
+
+bool EventLoop::Add(int fd, uint32_t events, Handler* handler) {
+  epoll_event event = {};
+  event.events = events;
+  event.data.ptr = handler;
+  return ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+bool EventLoop::Modify(int fd, uint32_t events, Handler* handler) {
+  epoll_event event = {};
+  event.events = events;
+  event.data.ptr = handler;
+  return ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void EventLoop::Remove(int fd) {
+  ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void EventLoop::Post(Task task) {
+  bool wake;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    posted_.push_back(std::move(task));
+    wake = !wake_pending_;
+    wake_pending_ = true;
+  }
+  // One write per batch of posts; the loop drains them all at once.
+  if (wake) {
+    Wake();
+  }
+}
+
+void EventLoop::SetTicker(int interval_ms, Task tick) {
+  tick_interval_ms_ = interval_ms;
+  tick_ = std::move(tick);
+  next_tick_ms_ = NowMs() + interval_ms;
+}
+
+void EventLoop::SetAfterBatch(Task after_batch) {
+  after_batch_ = std::move(after_batch);
+}
+
+void EventLoop::Run() {
+  epoll_event events[kMaxEvents];
+  while (!stopping_.load(std::memory_order_acquire)) {
+    int timeout = -1;
+    if (tick_) {
+      timeout = static_cast<int>(
+          std::max<int64_t>(0, next_tick_ms_ - NowMs()));
+    }
+    const int count = ::epoll_wait(epoll_fd_, events, kMaxEvents, timeout);
+    if (count < 0 && errno != EINTR) {
+      break;
+    }
+    batch_started_ns_ = NowNs();
+    bool woken = false;
+    for (int i = 0; i < count; i++) {
+      Handler* handler = static_cast<Handler*>(events[i].data.ptr);
+      if (handler == nullptr) {
+        woken = true;
+      } else {
+        handler->OnReady(events[i].events);
+      }
+    }
+    if (woken) {
+      uint64_t value;
+      while (::read(wake_fd_, &value, sizeof(value)) > 0) {
+      }
+      RunPosted();
+    }
+    if (tick_ && NowMs() >= next_tick_ms_) {
+      tick_lag_ns_ = NowNs() - next_tick_ms_ * 1000000;
+      next_tick_ms_ = NowMs() + tick_interval_ms_;
+      tick_();
+    }
+    if (after_batch_) {
+      after_batch_();
+    }
+  }
+}
+
+void EventLoop::Stop() {
+  stopping_.store(true, std::memory_order_release);
+  Wake();
+}
+
+int64_t EventLoop::NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t EventLoop::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void EventLoop::Wake() {
+  const uint64_t one = 1;
+  // Fails only when the counter would overflow, and then a wake-up is
+  // pending anyway.
+  const ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+  (void)written;
+}
+
+void EventLoop::RunPosted() {
+  std::vector<Task> tasks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks.swap(posted_);
+    wake_pending_ = false;
+  }
+  for (Task& task : tasks) {
+    task();
+  }
+}
+
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,94 @@
+#ifndef SERVER_NATIVE_EVENT_LOOP_H_
+#define SERVER_NATIVE_EVENT_LOOP_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace sc {
+namespace signaling {
+
+// Single-threaded epoll loop. Each shard of the server runs one on its own
+// thread; other threads hand it work through Post().
+//
+// Linux only.
+class EventLoop {
+ public:
+  class Handler {
+   public:
+    virtual ~Handler() {}
+    // |events| is a mask of EPOLLIN, EPOLLOUT, EPOLLERR, EPOLLHUP, ...
+    virtual void OnReady(uint32_t events) = 0;
+  };
+
+  using Task = std::function<void()>;
+
+  EventLoop();
+  ~EventLoop();
+
+  // Prevent copying.
+  EventLoop(EventLoop const&) = delete;
+  EventLoop& operator=(EventLoop const&) = delete;
+
+  // Creates the epoll instance. Returns false on failure.
+  bool Init();
+
+  // Calls |handler| when |fd| is ready for |events|. Level-triggered unless
+  // EPOLLET is included.
+  bool Add(int fd, uint32_t events, Handler* handler);
+  bool Modify(int fd, uint32_t events, Handler* handler);
+  // Events for |fd| already collected may still be handled in the current
+  // batch, so its handler must stay alive until the batch ends.
+  void Remove(int fd);
+
+  // Runs |task| on the loop's thread. May be called from any thread.
+  void Post(Task task);
+
+  // Calls |tick| on the loop's thread about every |interval_ms|.
+  void SetTicker(int interval_ms, Task tick);
+
+  // Called on the loop's thread after each batch of events and posted
+  // tasks, e.g. to flush output gathered while handling them.
+  void SetAfterBatch(Task after_batch);
+
+  // Handles events until Stop() is called.
+  void Run();
+
+  // Makes Run() return. May be called from any thread.
+  void Stop();
+
+  // Milliseconds and nanoseconds on a monotonic clock.
+  static int64_t NowMs();
+  static int64_t NowNs();
+
+  // When the current batch began, as the wait for events returned.
+  int64_t batch_started_ns() const { return batch_started_ns_; }
+  // How much later than scheduled the last tick ran.
+  int64_t tick_lag_ns() const { return tick_lag_ns_; }
+
+ private:
+  void Wake();
+  void RunPosted();
+
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  std::atomic<bool> stopping_{false};
+
+  std::mutex mutex_;
+  std::vector<Task> posted_;  // guarded by |mutex_|
+  bool wake_pending_ = false;  // guarded by |mutex_|
+
+  int tick_interval_ms_ = 0;
+  int64_t next_tick_ms_ = 0;
+  int64_t tick_lag_ns_ = 0;
+  int64_t batch_started_ns_ = 0;
+  Task tick_;
+  Task after_batch_;
+};
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_EVENT_LOOP_H_
@@ -0,0 +1,152 @@
+#include "http.h"
+
+#include <cctype>
+
+namespace sc {
+namespace signaling {
+
+namespace {
+
+std::string_view Trim(std::string_view text) {
+  while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (std::tolower(static_cast<unsigned char>(a[i])) !=
+        std::tolower(static_cast<unsigned char>(b[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const char* StatusText(int status) {
+  switch (status) {
+    case 200:
+      return "OK";
+    case 400:
+      return "Bad Request";
+    case 404:
+      return "Not Found";
+    case 405:
+      return "Method Not Allowed";
+    case 503:
+      return "Service Unavailable";
+    default:
+      return "Error";
+  }
+}
+
+}  // namespace
+
+std::string_view HttpRequest::Header(std::string_view name) const {
+  for (const auto& header : headers) {
+    if (header.first == name) {
+      return header.second;
+    }
+  }
+  return {};
+}
+
+ptrdiff_t ParseHttpRequest(std::string_view data, HttpRequest* request) {
+  const size_t end = data.find("\r\n\r\n");
+  if (end == std::string_view::npos) {
+    return data.size() > kMaxRequestHeadSize ? -1 : 0;
+  }
+  if (end + 4 > kMaxRequestHeadSize) {
+    return -1;
+  }
+  std::string_view head = data.substr(0, end + 2);
+  size_t line_end = head.find("\r\n");
+  const std::string_view line = head.substr(0, line_end);
+  const size_t method_end = line.find(' ');
+  const size_t target_end = line.rfind(' ');
+  if (method_end == std::string_view::npos || target_end <= method_end ||
+      line.substr(target_end + 1, 5) != "HTTP/") {
+    return -1;
+  }
+  request->method = std::string(line.substr(0, method_end));
+  const std::string_view target =
+      line.substr(method_end + 1, target_end - method_end - 1);
+  const size_t question = target.find('?');
+  request->path = std::string(target.substr(0, question));
+  request->query = question == std::string_view::npos
+                       ? std::string()
+                       : std::string(target.substr(question + 1));
+  request->headers.clear();
+  head.remove_prefix(line_end + 2);
+  while (!head.empty()) {
+    line_end = head.find("\r\n");
+    const std::string_view header = head.substr(0, line_end);
+    head.remove_prefix(line_end + 2);
+    const size_t colon = header.find(':');
+    if (colon == std::string_view::npos || colon == 0) {
+      return -1;
+    }
+    std::string name(header.substr(0, colon));
+    for (char& c : name) {
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    request->headers.emplace_back(std::move(name),
+                                  std::string(Trim(header.substr(colon + 1))));
+  }
+  return static_cast<ptrdiff_t>(end + 4);
+}
+
+std::string_view QueryParameter(std::string_view query,
+                                std::string_view name) {
+  while (!query.empty()) {
+    const size_t amp = query.find('&');
+    const std::string_view pair = query.substr(0, amp);
+    const size_t equals = pair.find('=');
+    if (pair.substr(0, equals) == name) {
+      return equals == std::string_view::npos ? std::string_view()
+                                              : pair.substr(equals + 1);
+    }
+    if (amp == std::string_view::npos) {
+      break;
+    }
+    query.remove_prefix(amp + 1);
+  }
+  return {};
+}
+
+bool HeaderHasToken(std::string_view value, std::string_view token) {
+  while (!value.empty()) {
+    const size_t comma = value.find(',');
+    if (EqualsIgnoreCase(Trim(value.substr(0, comma)), token)) {
+      return true;
+    }
+    if (comma == std::string_view::npos) {
+      break;
+    }
+    value.remove_prefix(comma + 1);
+  }
+  return false;
+}
+
+std::string HttpResponse(int status, std::string_view content_type,
+                         std::string_view body) {
+  std::string response = "HTTP/1.1 " + std::to_string(status) + " " +
+                         StatusText(status) + "\r\n";
+  response += "Content-Type: ";
+  response += content_type;
+  response += "\r\nContent-Length: " + std::to_string(body.size()) +
+              "\r\nAccess-Control-Allow-Origin: *\r\n"
+              "Connection: close\r\n\r\n";
+  response += body;
+  return response;
+}
+
+}  // namespace signaling
+}  // namespace sc
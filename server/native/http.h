@@ -0,0 +1,51 @@
+#ifndef SERVER_NATIVE_HTTP_H_
+#define SERVER_NATIVE_HTTP_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sc {
+namespace signaling {
+
+// The HTTP/1.1 the server needs: request heads for the health check and the
+// WebSocket upgrade, and complete responses with a body. Request bodies are
+// not supported.
+
+// Requests with a longer head are refused.
+constexpr size_t kMaxRequestHeadSize = 16 * 1024;
+
+struct HttpRequest {
+  std::string method;
+  std::string path;
+  std::string query;  // without the '?'
+  // Names are lower-cased.
+  std::vector<std::pair<std::string, std::string>> headers;
+
+  // Value of header |name| (lower case), or empty.
+  std::string_view Header(std::string_view name) const;
+};
+
+// Parses the request head at the start of |data|. Returns its length up to
+// and including the blank line, 0 if it is incomplete, or -1 if it is
+// malformed or longer than kMaxRequestHeadSize.
+ptrdiff_t ParseHttpRequest(std::string_view data, HttpRequest* request);
+
+// Value of |name| in a query string, undecoded, or empty.
+std::string_view QueryParameter(std::string_view query, std::string_view name);
+
+// Whether the comma-separated header |value| lists |token|, ignoring case,
+// as in "Connection: keep-alive, Upgrade".
+bool HeaderHasToken(std::string_view value, std::string_view token);
+
+// A complete response that closes the connection. CORS is open, like the
+// Node server's.
+std::string HttpResponse(int status, std::string_view content_type,
+                         std::string_view body);
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_HTTP_H_
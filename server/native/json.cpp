@@ -0,0 +1,395 @@
+#include "json.h"
+
+#include <cstdint>
+
+namespace sc {
+namespace signaling {
+namespace json {
+
+namespace {
+
+void SkipSpace(std::string_view text, size_t* pos) {
+  while (*pos < text.size() &&
+         (text[*pos] == ' ' || text[*pos] == '\t' || text[*pos] == '\n' ||
+          text[*pos] == '\r')) {
+    (*pos)++;
+  }
+}
+
+bool SkipString(std::string_view text, size_t* pos) {
+  if (*pos >= text.size() || text[*pos] != '"') {
+    return false;
+  }
+  for (size_t i = *pos + 1; i < text.size(); i++) {
+    const char c = text[i];
+    if (c == '"') {
+      *pos = i + 1;
+      return true;
+    }
+    if (c == '\\') {
+      i++;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      return false;
+    }
+  }
+  return false;
+}
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool SkipNumber(std::string_view text, size_t* pos) {
+  size_t i = *pos;
+  if (i < text.size() && text[i] == '-') {
+    i++;
+  }
+  const size_t digits = i;
+  while (i < text.size() && IsDigit(text[i])) {
+    i++;
+  }
+  if (i == digits) {
+    return false;
+  }
+  if (i < text.size() && text[i] == '.') {
+    i++;
+    const size_t fraction = i;
+    while (i < text.size() && IsDigit(text[i])) {
+      i++;
+    }
+    if (i == fraction) {
+      return false;
+    }
+  }
+  if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+    i++;
+    if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+      i++;
+    }
+    const size_t exponent = i;
+    while (i < text.size() && IsDigit(text[i])) {
+      i++;
+    }
+    if (i == exponent) {
+      return false;
+    }
+  }
+  *pos = i;
+  return true;
+}
+
+bool SkipLiteral(std::string_view text, size_t* pos, std::string_view word) {
+  if (text.substr(*pos, word.size()) != word) {
+    return false;
+  }
+  *pos += word.size();
+  return true;
+}
+
+bool Skip(std::string_view text, size_t* pos, int depth) {
+  SkipSpace(text, pos);
+  if (*pos >= text.size()) {
+    return false;
+  }
+  switch (text[*pos]) {
+    case '"':
+      return SkipString(text, pos);
+    case 't':
+      return SkipLiteral(text, pos, "true");
+    case 'f':
+      return SkipLiteral(text, pos, "false");
+    case 'n':
+      return SkipLiteral(text, pos, "null");
+    case '[':
+    case '{': {
+      if (depth >= kMaxDepth) {
+        return false;
+      }
+      const bool object = text[*pos] == '{';
+      const char close = object ? '}' : ']';
+      (*pos)++;
+      SkipSpace(text, pos);
+      if (*pos < text.size() && text[*pos] == close) {
+        (*pos)++;
+        return true;
+      }
+      for (;;) {
+        if (object) {
+          SkipSpace(text, pos);
+          if (!SkipString(text, pos)) {
+            return false;
+          }
+          SkipSpace(text, pos);
+          if (*pos >= text.size() || text[*pos] != ':') {
+            return false;
+          }
+          (*pos)++;
+        }
+        if (!Skip(text, pos, depth + 1)) {
+          return false;
+        }
+        SkipSpace(text, pos);
+        if (*pos >= text.size()) {
+          return false;
+        }
+        if (text[*pos] == close) {
+          (*pos)++;
+          return true;
+        }
+        if (text[*pos] != ',') {
+          return false;
+        }
+        (*pos)++;
+      }
+    }
+    default:
+      return SkipNumber(text, pos);
+  }
+}
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool ReadHex4(std::string_view text, size_t pos, uint32_t* value) {
+  if (pos + 4 > text.size()) {
+    return false;
+  }
+  *value = 0;
+  for (size_t i = pos; i < pos + 4; i++) {
+    const int digit = HexValue(text[i]);
+    if (digit < 0) {
+      return false;
+    }
+    *value = *value << 4 | static_cast<uint32_t>(digit);
+  }
+  return true;
+}
+
+void AppendUtf8(std::string* out, uint32_t code_point) {
+  if (code_point < 0x80) {
+    *out += static_cast<char>(code_point);
+  } else if (code_point < 0x800) {
+    *out += static_cast<char>(0xc0 | (code_point >> 6));
+    *out += static_cast<char>(0x80 | (code_point & 0x3f));
+  } else if (code_point < 0x10000) {
+    *out += static_cast<char>(0xe0 | (code_point >> 12));
+    *out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+    *out += static_cast<char>(0x80 | (code_point & 0x3f));
+  } else {
+    *out += static_cast<char>(0xf0 | (code_point >> 18));
+    *out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+    *out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+    *out += static_cast<char>(0x80 | (code_point & 0x3f));
+  }
+}
+
+}  // namespace
+
+bool SkipValue(std::string_view text, size_t* pos) {
+  return Skip(text, pos, 0);
+}
+
+bool IsValid(std::string_view text) {
+  size_t pos = 0;
+  if (!SkipValue(text, &pos)) {
+    return false;
+  }
+  SkipSpace(text, &pos);
+  return pos == text.size();
+}
+
+bool ArrayElements(std::string_view text,
+                   std::vector<std::string_view>* elements) {
+  elements->clear();
+  size_t pos = 0;
+  SkipSpace(text, &pos);
+  if (pos >= text.size() || text[pos] != '[') {
+    return false;
+  }
+  pos++;
+  SkipSpace(text, &pos);
+  if (pos < text.size() && text[pos] == ']') {
+    return true;
+  }
+  for (;;) {
+    SkipSpace(text, &pos);
+    const size_t start = pos;
+    if (!Skip(text, &pos, 1)) {
+      return false;
+    }
+    elements->push_back(text.substr(start, pos - start));
+    SkipSpace(text, &pos);
+    if (pos >= text.size()) {
+      return false;
+    }
+    if (text[pos] == ']') {
+      return true;
+    }
+    if (text[pos] != ',') {
+      return false;
+    }
+    pos++;
+  }
+}
+
+bool FindMember(std::string_view text, std::string_view key,
+                std::string_view* value) {
+  size_t pos = 0;
+  SkipSpace(text, &pos);
+  if (pos >= text.size() || text[pos] != '{') {
+    return false;
+  }
+  pos++;
+  SkipSpace(text, &pos);
+  if (pos < text.size() && text[pos] == '}') {
+    return false;
+  }
+  std::string decoded;
+  for (;;) {
+    SkipSpace(text, &pos);
+    const size_t key_start = pos;
+    if (!SkipString(text, &pos)) {
+      return false;
+    }
+    const std::string_view raw_key =
+        text.substr(key_start + 1, pos - key_start - 2);
+    bool match = raw_key == key;
+    if (!match && raw_key.find('\\') != std::string_view::npos) {
+      match = DecodeString(text.substr(key_start, pos - key_start),
+                           &decoded) &&
+              decoded == key;
+    }
+    SkipSpace(text, &pos);
+    if (pos >= text.size() || text[pos] != ':') {
+      return false;
+    }
+    pos++;
+    SkipSpace(text, &pos);
+    const size_t value_start = pos;
+    if (!Skip(text, &pos, 1)) {
+      return false;
+    }
+    if (match) {
+      *value = text.substr(value_start, pos - value_start);
+      return true;
+    }
+    SkipSpace(text, &pos);
+    if (pos >= text.size() || text[pos] != ',') {
+      return false;
+    }
+    pos++;
+  }
+}
+
+bool DecodeString(std::string_view text, std::string* out) {
+  out->clear();
+  if (text.size() < 2 || text.front() != '"' || text.back() != '"') {
+    return false;
+  }
+  for (size_t i = 1; i + 1 < text.size(); i++) {
+    const char c = text[i];
+    if (c != '\\') {
+      *out += c;
+      continue;
+    }
+    if (++i + 1 >= text.size()) {
+      return false;
+    }
+    switch (text[i]) {
+      case '"':
+      case '\\':
+      case '/':
+        *out += text[i];
+        break;
+      case 'b':
+        *out += '\b';
+        break;
+      case 'f':
+        *out += '\f';
+        break;
+      case 'n':
+        *out += '\n';
+        break;
+      case 'r':
+        *out += '\r';
+        break;
+      case 't':
+        *out += '\t';
+        break;
+      case 'u': {
+        uint32_t code_point;
+        if (!ReadHex4(text, i + 1, &code_point)) {
+          return false;
+        }
+        i += 4;
+        if (code_point >= 0xd800 && code_point < 0xdc00) {
+          uint32_t low;
+          if (i + 2 < text.size() && text[i + 1] == '\\' &&
+              text[i + 2] == 'u' && ReadHex4(text, i + 3, &low) &&
+              low >= 0xdc00 && low < 0xe000) {
+            code_point = 0x10000 + ((code_point - 0xd800) << 10) +
+                         (low - 0xdc00);
+            i += 6;
+          } else {
+            code_point = 0xfffd;
+          }
+        } else if (code_point >= 0xdc00 && code_point < 0xe000) {
+          code_point = 0xfffd;
+        }
+        AppendUtf8(out, code_point);
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+std::string StringMember(std::string_view text, std::string_view key) {
+  std::string_view raw;
+  std::string value;
+  if (!FindMember(text, key, &raw) || !DecodeString(raw, &value)) {
+    value.clear();
+  }
+  return value;
+}
+
+void AppendString(std::string* out, std::string_view value) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  *out += '"';
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        *out += "\\\"";
+        break;
+      case '\\':
+        *out += "\\\\";
+        break;
+      case '\n':
+        *out += "\\n";
+        break;
+      case '\r':
+        *out += "\\r";
+        break;
+      case '\t':
+        *out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          *out += "\\u00";
+          *out += kHex[(c >> 4) & 0xf];
+          *out += kHex[c & 0xf];
+        } else {
+          *out += c;
+        }
+    }
+  }
+  *out += '"';
+}
+
+}  // namespace json
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,50 @@
+#ifndef SERVER_NATIVE_JSON_H_
+#define SERVER_NATIVE_JSON_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sc {
+namespace signaling {
+namespace json {
+
+// Just enough JSON for the signaling protocol. Event arguments are relayed
+// as the raw text the client sent, so the server only has to find values
+// inside a document, decode the few strings it reads and quote its own; it
+// never builds a tree.
+
+// Maximum nesting of arrays and objects accepted.
+constexpr int kMaxDepth = 64;
+
+// Skips leading whitespace and one value starting at |*pos| and leaves
+// |*pos| just after it. Returns false if the value is malformed, truncated
+// or nested deeper than kMaxDepth.
+bool SkipValue(std::string_view text, size_t* pos);
+
+// Whether |text| is exactly one value, with optional surrounding whitespace.
+bool IsValid(std::string_view text);
+
+// Splits the array |text| into the raw text of its elements.
+bool ArrayElements(std::string_view text,
+                   std::vector<std::string_view>* elements);
+
+// Points |value| at the raw text of member |key| of the object |text|.
+// Returns false if |text| is not an object or has no such member.
+bool FindMember(std::string_view text, std::string_view key,
+                std::string_view* value);
+
+// Decodes the string literal |text|, quotes included, to UTF-8.
+bool DecodeString(std::string_view text, std::string* out);
+
+// Member |key| of the object |text| if it is a string; empty otherwise.
+std::string StringMember(std::string_view text, std::string_view key);
+
+// Appends |value| as a string literal.
+void AppendString(std::string* out, std::string_view value);
+
+}  // namespace json
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_JSON_H_
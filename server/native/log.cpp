@@ -0,0 +1,36 @@
+#include "log.h"
+
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+
+namespace sc {
+namespace signaling {
+
+void Log(const char* format, ...) {
+  timeval now;
+  ::gettimeofday(&now, nullptr);
+  tm utc;
+  ::gmtime_r(&now.tv_sec, &utc);
+  char line[1024];
+  int length = static_cast<int>(std::strftime(line, sizeof(line),
+                                              "[%Y-%m-%dT%H:%M:%S", &utc));
+  length += std::snprintf(line + length, sizeof(line) - length, ".%03dZ] ",
+                          static_cast<int>(now.tv_usec / 1000));
+  va_list args;
+  va_start(args, format);
+  const int body =
+      std::vsnprintf(line + length, sizeof(line) - length - 1, format, args);
+  va_end(args);
+  length = body < 0 ? length
+                    : std::min<int>(length + body, sizeof(line) - 2);
+  line[length++] = '\n';
+  // One write per line keeps lines from different shards whole.
+  std::fwrite(line, 1, length, stderr);
+}
+
+}  // namespace signaling
+}  // namespace sc
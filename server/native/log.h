@@ -0,0 +1,17 @@
+#ifndef SERVER_NATIVE_LOG_H_
+#define SERVER_NATIVE_LOG_H_
+
+namespace sc {
+namespace signaling {
+
+// Writes one line, prefixed with the UTC time, to stderr.
+void Log(const char* format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 1, 2)))
+#endif
+    ;
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_LOG_H_
@@ -0,0 +1,113 @@
+// Shared Clipboard signaling server.
+//
+//   sc_signaling_server [--host 0.0.0.0] [--port 3000] [--shards N]
+//                       [--ping-interval MS] [--ping-timeout MS]
+//                       [--sharer-policy recent|least-loaded] [--verbose]
+//
+// The port defaults to $PORT, then 3000, like server.js.
+
+#include <pthread.h>
+#include <signal.h>
+#include <sys/resource.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "log.h"
+#include "signaling_server.h"
+
+namespace {
+
+constexpr int kStatusIntervalSeconds = 30;
+
+void PrintUsage() {
+  std::fprintf(stderr,
+               "usage: sc_signaling_server [--host HOST] [--port PORT] "
+               "[--shards N]\n"
+               "                           [--ping-interval MS] "
+               "[--ping-timeout MS]\n"
+               "                           [--sharer-policy "
+               "recent|least-loaded] [--verbose]\n");
+}
+
+// Lets the process hold as many connections as the hard limit allows.
+void RaiseFileLimit() {
+  rlimit limit;
+  if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+      limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  using sc::signaling::Log;
+  sc::signaling::ServerOptions options;
+  if (const char* port = std::getenv("PORT")) {
+    options.port = static_cast<uint16_t>(std::atoi(port));
+  }
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "--host" && has_value) {
+      options.host = argv[++i];
+    } else if (arg == "--port" && has_value) {
+      options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+    } else if (arg == "--shards" && has_value) {
+      options.shards = static_cast<size_t>(std::atoi(argv[++i]));
+    } else if (arg == "--ping-interval" && has_value) {
+      options.ping_interval_ms = std::atoi(argv[++i]);
+    } else if (arg == "--ping-timeout" && has_value) {
+      options.ping_timeout_ms = std::atoi(argv[++i]);
+    } else if (arg == "--sharer-policy" && has_value &&
+               sc::signaling::ParseSharerPolicy(argv[i + 1],
+                                                &options.sharer_policy)) {
+      i++;
+    } else if (arg == "--verbose") {
+      options.verbose = true;
+    } else {
+      PrintUsage();
+      return arg == "--help" ? 0 : 2;
+    }
+  }
+
+  RaiseFileLimit();
+  // Shard threads inherit the mask, so only this thread sees the signals.
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  sc::signaling::SignalingServer server(options);
+  if (!server.Start()) {
+    Log("cannot listen on %s:%u: %s", options.host.c_str(), options.port,
+        std::strerror(errno));
+    return 1;
+  }
+  Log("listening on %s:%u with %zu shards", options.host.c_str(),
+      server.port(), server.shard_count());
+
+  const timespec interval = {kStatusIntervalSeconds, 0};
+  for (;;) {
+    const int signal = sigtimedwait(&signals, nullptr, &interval);
+    if (signal == SIGINT || signal == SIGTERM) {
+      break;
+    }
+    if (server.connection_count() > 0) {
+      Log("status: %zu connections, %zu devices, %zu ready to share",
+          server.connection_count(), server.registry().size(),
+          server.registry().ready_count());
+    }
+  }
+  Log("shutting down");
+  server.Stop();
+  return 0;
+}
@@ -0,0 +1,104 @@
+#include "metrics.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace sc {
+namespace signaling {
+
+Histogram::Histogram(std::initializer_list<double> bounds)
+    : bounds_(bounds),
+      counts_(new std::atomic<uint64_t>[bounds.size() + 1]) {
+  for (size_t i = 0; i <= bounds_.size(); i++) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+Histogram::~Histogram() {}
+
+void Histogram::Observe(double value) {
+  size_t i = 0;
+  while (i < bounds_.size() && value > bounds_[i]) {
+    i++;
+  }
+  counts_[i].store(counts_[i].load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+  count_.store(count_.load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+  sum_.store(sum_.load(std::memory_order_relaxed) + value,
+             std::memory_order_relaxed);
+}
+
+void MetricsWriter::Begin(std::string_view name, std::string_view help,
+                          std::string_view type) {
+  text_ += "# HELP ";
+  text_ += name;
+  text_ += ' ';
+  text_ += help;
+  text_ += "\n# TYPE ";
+  text_ += name;
+  text_ += ' ';
+  text_ += type;
+  text_ += '\n';
+}
+
+void MetricsWriter::Sample(std::string_view name, std::string_view labels,
+                           double value) {
+  text_ += name;
+  if (!labels.empty()) {
+    text_ += '{';
+    text_ += labels;
+    text_ += '}';
+  }
+  text_ += ' ';
+  text_ += FormatMetricValue(value);
+  text_ += '\n';
+}
+
+void MetricsWriter::WriteHistogram(
+    std::string_view name, std::string_view help,
+    const std::vector<const Histogram*>& histograms) {
+  Begin(name, help, "histogram");
+  if (histograms.empty()) {
+    return;
+  }
+  const std::vector<double>& bounds = histograms.front()->bounds();
+  const std::string bucket_name = std::string(name) + "_bucket";
+  uint64_t cumulative = 0;
+  uint64_t count = 0;
+  double sum = 0;
+  for (size_t i = 0; i <= bounds.size(); i++) {
+    for (const Histogram* histogram : histograms) {
+      cumulative += histogram->bucket(i);
+    }
+    const std::string le =
+        "le=\"" +
+        (i < bounds.size() ? FormatMetricValue(bounds[i]) : "+Inf") + "\"";
+    Sample(bucket_name, le, static_cast<double>(cumulative));
+  }
+  for (const Histogram* histogram : histograms) {
+    count += histogram->count();
+    sum += histogram->sum();
+  }
+  Sample(std::string(name) + "_sum", {}, sum);
+  Sample(std::string(name) + "_count", {}, static_cast<double>(count));
+}
+
+std::string FormatMetricValue(double value) {
+  if (std::isinf(value)) {
+    return value > 0 ? "+Inf" : "-Inf";
+  }
+  if (std::isnan(value)) {
+    return "NaN";
+  }
+  char text[32];
+  if (value == std::floor(value) && std::fabs(value) < 1e15) {
+    std::snprintf(text, sizeof(text), "%.0f", value);
+  } else {
+    std::snprintf(text, sizeof(text), "%.9g", value);
+  }
+  return text;
+}
+
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,104 @@
+#ifndef SERVER_NATIVE_METRICS_H_
+#define SERVER_NATIVE_METRICS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sc {
+namespace signaling {
+
+// Metrics for /metrics, in the Prometheus text format.
+//
+// Each shard keeps its own, updated only from its thread and read by
+// whichever thread renders a scrape. Updates are relaxed loads and stores
+// of a single writer, not read-modify-write, so they cost no more than
+// plain increments; a scrape sums the shards.
+
+class Counter {
+ public:
+  void Add(uint64_t n = 1) {
+    value_.store(value_.load(std::memory_order_relaxed) + n,
+                 std::memory_order_relaxed);
+  }
+  uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+ public:
+  void Add(int64_t n) {
+    value_.store(value_.load(std::memory_order_relaxed) + n,
+                 std::memory_order_relaxed);
+  }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+// Counts observations in buckets with fixed upper bounds.
+class Histogram {
+ public:
+  // |bounds| are upper bounds in ascending order; +Inf is implied.
+  explicit Histogram(std::initializer_list<double> bounds);
+  ~Histogram();
+
+  // Prevent copying.
+  Histogram(Histogram const&) = delete;
+  Histogram& operator=(Histogram const&) = delete;
+
+  void Observe(double value);
+
+  const std::vector<double>& bounds() const { return bounds_; }
+  // Observations in bucket |i|, not cumulative; bucket bounds().size() is
+  // +Inf.
+  uint64_t bucket(size_t i) const {
+    return counts_[i].load(std::memory_order_relaxed);
+  }
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  double sum() const { return sum_.load(std::memory_order_relaxed); }
+
+ private:
+  const std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+  std::atomic<uint64_t> count_{0};
+  std::atomic<double> sum_{0};
+};
+
+// Builds a scrape response.
+class MetricsWriter {
+ public:
+  // Writes the HELP and TYPE lines that start a metric.
+  void Begin(std::string_view name, std::string_view help,
+             std::string_view type);
+
+  // One sample of the current metric. |labels| is the inside of the
+  // braces, e.g. event="register", or empty.
+  void Sample(std::string_view name, std::string_view labels, double value);
+
+  // A whole histogram metric: the sum of |histograms|, which share bounds.
+  void WriteHistogram(std::string_view name, std::string_view help,
+                      const std::vector<const Histogram*>& histograms);
+
+  const std::string& text() const { return text_; }
+
+ private:
+  std::string text_;
+};
+
+// Formats a sample value as Prometheus expects: integers without a point,
+// infinities as +Inf and -Inf.
+std::string FormatMetricValue(double value);
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_METRICS_H_
@@ -0,0 +1,97 @@
+#include "sharer_index.h"
+
+#include <iterator>
+
+namespace sc {
+namespace signaling {
+
+bool ParseSharerPolicy(std::string_view name, SharerPolicy* policy) {
+  if (name == "recent") {
+    *policy = SharerPolicy::kMostRecent;
+  } else if (name == "least-loaded") {
+    *policy = SharerPolicy::kLeastLoaded;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+SharerIndex::SharerIndex(SharerPolicy policy) : policy_(policy) {}
+
+SharerIndex::~SharerIndex() {}
+
+void SharerIndex::MarkReady(const std::string& id) {
+  auto it = positions_.find(id);
+  if (it != positions_.end()) {
+    Move(&it->second, it->second.bucket, /*front=*/true);
+    return;
+  }
+  if (buckets_.empty() || buckets_.front().load != 0) {
+    buckets_.emplace_front();
+  }
+  Bucket& bucket = buckets_.front();
+  bucket.ids.push_front(id);
+  positions_.emplace(id, Position{buckets_.begin(), bucket.ids.begin()});
+}
+
+bool SharerIndex::Remove(std::string_view id) {
+  auto it = positions_.find(std::string(id));
+  if (it == positions_.end()) {
+    return false;
+  }
+  const BucketIterator bucket = it->second.bucket;
+  bucket->ids.erase(it->second.id);
+  if (bucket->ids.empty()) {
+    buckets_.erase(bucket);
+  }
+  positions_.erase(it);
+  return true;
+}
+
+bool SharerIndex::Contains(std::string_view id) const {
+  return positions_.count(std::string(id)) > 0;
+}
+
+bool SharerIndex::Pick(std::string_view exclude, std::string* id) const {
+  // At most two steps: the excluded device is skipped once.
+  for (const Bucket& bucket : buckets_) {
+    for (const std::string& candidate : bucket.ids) {
+      if (candidate != exclude) {
+        *id = candidate;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void SharerIndex::CountRequest(std::string_view id) {
+  if (policy_ != SharerPolicy::kLeastLoaded) {
+    return;
+  }
+  auto it = positions_.find(std::string(id));
+  if (it == positions_.end()) {
+    return;
+  }
+  Position& position = it->second;
+  const uint64_t load = position.bucket->load + 1;
+  BucketIterator next = std::next(position.bucket);
+  if (next == buckets_.end() || next->load != load) {
+    next = buckets_.insert(next, Bucket{load, {}});
+  }
+  Move(&position, next, /*front=*/false);
+}
+
+void SharerIndex::Move(Position* position, BucketIterator bucket,
+                       bool front) {
+  const BucketIterator from = position->bucket;
+  bucket->ids.splice(front ? bucket->ids.begin() : bucket->ids.end(),
+                     from->ids, position->id);
+  position->bucket = bucket;
+  if (from->ids.empty()) {
+    buckets_.erase(from);
+  }
+}
+
+}  // namespace signaling
+}  // namespace sc
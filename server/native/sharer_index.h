@@ -0,0 +1,85 @@
+#ifndef SERVER_NATIVE_SHARER_INDEX_H_
+#define SERVER_NATIVE_SHARER_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace sc {
+namespace signaling {
+
+// How request-share picks among the ready devices of a group when the
+// requester names none.
+enum class SharerPolicy {
+  // The device that most recently sent share-ready, which holds the
+  // freshest clipboard.
+  kMostRecent,
+  // The device sent the fewest share requests since it became ready, so
+  // requests spread over the ready devices. Ties go to the device that
+  // became ready most recently, then to the one asked longest ago.
+  kLeastLoaded,
+};
+
+// Parses "recent" or "least-loaded". Returns false for anything else.
+bool ParseSharerPolicy(std::string_view name, SharerPolicy* policy);
+
+// The ready devices of one group, ordered for request-share. Every
+// operation is O(1): devices sit in buckets by load, in ascending order,
+// and each bucket lists its devices in the order they are picked in.
+//
+// Not thread-safe.
+class SharerIndex {
+ public:
+  explicit SharerIndex(SharerPolicy policy);
+  ~SharerIndex();
+
+  // Prevent copying.
+  SharerIndex(SharerIndex const&) = delete;
+  SharerIndex& operator=(SharerIndex const&) = delete;
+
+  // Adds |id| with no load, or makes it the most recently ready device
+  // again, keeping its load.
+  void MarkReady(const std::string& id);
+
+  // Returns false if |id| was not in the index. Its load is forgotten.
+  bool Remove(std::string_view id);
+
+  bool Contains(std::string_view id) const;
+
+  // The device to ask next, other than |exclude|, which the caller then
+  // passes to CountRequest(). Returns false if there is none.
+  bool Pick(std::string_view exclude, std::string* id) const;
+
+  // Counts a share request sent to |id|.
+  void CountRequest(std::string_view id);
+
+  size_t size() const { return positions_.size(); }
+
+ private:
+  struct Bucket {
+    uint64_t load = 0;
+    std::list<std::string> ids;
+  };
+  using BucketIterator = std::list<Bucket>::iterator;
+
+  struct Position {
+    BucketIterator bucket;
+    std::list<std::string>::iterator id;
+  };
+
+  // Moves the device at |position| to |bucket|, at the front or the back,
+  // and drops the bucket it leaves if that empties.
+  void Move(Position* position, BucketIterator bucket, bool front);
+
+  const SharerPolicy policy_;
+  std::list<Bucket> buckets_;  // by ascending load, none empty
+  std::unordered_map<std::string, Position> positions_;
+};
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_SHARER_INDEX_H_
@@ -0,0 +1,1246 @@
+#include "signaling_server.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <utility>
+
+#include "encoding.h"
+#include "event_loop.h"
+#include "http.h"
+#include "json.h"
+#include "log.h"
+#include "metrics.h"
+#include "socket_io.h"
+#include "websocket.h"
+
+namespace sc {
+namespace signaling {
+
+namespace {
+
+constexpr int kTickIntervalMs = 1000;
+// Time allowed for the HTTP request, and then for the Socket.IO connect
+// (socket.io's connectTimeout).
+constexpr int64_t kRequestTimeoutMs = 10000;
+constexpr int64_t kConnectTimeoutMs = 45000;
+// Bytes read from one connection per wake-up, so one busy client cannot
+// starve the rest of its shard.
+constexpr size_t kReadBudget = 256 * 1024;
+constexpr size_t kReadSize = 64 * 1024;
+
+// Socket.IO ids are 15 bytes in URL-safe base64: the shard, a 24-bit slot
+// on that shard, and 11 random bytes.
+constexpr size_t kIdBytes = 15;
+constexpr size_t kMaxSlots = 1u << 24;
+
+// Events counted by name in signaling_events_total, as server.js counts
+// them. Any other name counts as "other", so clients cannot grow the label
+// set.
+constexpr std::string_view kCountedEvents[] = {
+    "connection",    "disconnect",  "register",
+    "share-ready",   "share-not-ready", "not-ready",
+    "request-share", "webrtc-signal",   "sync-devices",
+    "get-devices",   "list-devices",    "get-connected-devices",
+    "devices",       "clients",         "room-info",
+    "other"};
+constexpr size_t kEventKinds = std::size(kCountedEvents);
+constexpr size_t kConnectionEvent = 0;
+constexpr size_t kDisconnectEvent = 1;
+
+size_t EventIndex(std::string_view name) {
+  for (size_t i = 0; i + 1 < kEventKinds; i++) {
+    if (kCountedEvents[i] == name) {
+      return i;
+    }
+  }
+  return kEventKinds - 1;
+}
+
+// What a shard measures about its own work, for /metrics.
+struct ShardMetrics {
+  Counter events[kEventKinds];
+  // webrtc-signals whose recipient is not in the sender's group.
+  Counter signals_dropped;
+  // From the batch a webrtc-signal arrived in to its queueing for the
+  // recipient, on the recipient's shard.
+  Histogram signal_forward{0.00001, 0.000025, 0.00005, 0.0001, 0.00025,
+                           0.0005,  0.001,    0.0025,  0.005,  0.01,
+                           0.05};
+  // Bytes waiting to be sent to a connection, as each message is queued.
+  Histogram outbound_queue{256,    1024,    4096,    16384,   65536,
+                           262144, 1048576, 4194304, 16777216};
+  Gauge outbound_bytes;
+  // How late the once-a-second tick ran, and how long each batch of events
+  // took to handle.
+  Histogram loop_lag{0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5};
+  Histogram batch{0.00001, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1,
+                  0.5};
+};
+
+std::shared_ptr<const std::string> EventFrame(std::string_view name,
+                                              std::string_view arg) {
+  auto frame = std::make_shared<std::string>();
+  AppendWebSocketFrame(frame.get(), WebSocketOpcode::kText,
+                       EncodeEventPacket(name, arg));
+  return frame;
+}
+
+std::string IdObject(std::string_view key, std::string_view id) {
+  std::string object = "{";
+  json::AppendString(&object, key);
+  object += ':';
+  json::AppendString(&object, id);
+  object += '}';
+  return object;
+}
+
+// Name for a device that registered without one, as server.js derives it.
+std::string FallbackName(std::string_view id, std::string_view user_agent) {
+  if (user_agent.find("Macintosh") != std::string_view::npos) {
+    return "Mac Computer";
+  }
+  if (user_agent.find("Windows") != std::string_view::npos) {
+    return "Windows PC";
+  }
+  if (user_agent.find("iPhone") != std::string_view::npos) {
+    return "iPhone";
+  }
+  if (user_agent.find("Android") != std::string_view::npos) {
+    return "Android Device";
+  }
+  if (user_agent.find("Linux") != std::string_view::npos) {
+    return "Linux PC";
+  }
+  return "Device " + std::string(id.substr(0, 8));
+}
+
+std::string EngineError(int code, std::string_view message) {
+  std::string body = "{\"code\":" + std::to_string(code) + ",\"message\":";
+  json::AppendString(&body, message);
+  body += '}';
+  return HttpResponse(400, "application/json", body);
+}
+
+}  // namespace
+
+struct SignalingServer::Connection : EventLoop::Handler {
+  enum class State { kHttp, kWebSocket, kClosed };
+
+  Shard* shard = nullptr;
+  int fd = -1;
+  uint32_t slot = 0;
+  std::string id;
+  std::string user_agent;
+  std::string group;  // once registered
+  size_t member_index = 0;  // in its shard's list of group members
+  State state = State::kHttp;
+  bool connected = false;  // to the main Socket.IO namespace
+  bool registered = false;
+  bool deltas = false;  // gets device-snapshot and device-delta
+  bool list_requested = false;
+  bool snapshot_requested = false;
+  bool close_after_write = false;
+  bool dirty = false;
+  bool watching_writable = false;
+
+  std::string in;
+  std::string out;
+  size_t out_offset = 0;
+  std::string fragments;
+  bool in_fragment = false;
+  bool fragment_is_text = false;
+
+  int64_t opened_ms = 0;
+  int64_t last_ping_ms = 0;
+  bool awaiting_pong = false;
+
+  void OnReady(uint32_t events) override;
+};
+
+class SignalingServer::Shard {
+ public:
+  Shard(SignalingServer* server, size_t index)
+      : server_(server), index_(index), listener_(this) {}
+
+  bool Init(int listen_fd) {
+    listen_fd_ = listen_fd;
+    if (!loop_.Init()) {
+      return false;
+    }
+    loop_.SetTicker(kTickIntervalMs, [this] { Tick(); });
+    loop_.SetAfterBatch([this] {
+      SendChanges();
+      FlushAll();
+      metrics_.batch.Observe(
+          static_cast<double>(EventLoop::NowNs() - loop_.batch_started_ns()) /
+          1e9);
+    });
+    // Every shard waits on the same socket; EPOLLEXCLUSIVE wakes one of
+    // them per connection instead of all.
+    listening_ = loop_.Add(listen_fd_, EPOLLIN | EPOLLEXCLUSIVE, &listener_);
+    return listening_;
+  }
+
+  void Run() {
+    loop_.Run();
+    for (auto& connection : slots_) {
+      if (connection) {
+        Close(connection.get(), "server stopping");
+      }
+    }
+    closed_.clear();
+  }
+
+  void Stop() { loop_.Stop(); }
+
+  void Post(EventLoop::Task task) { loop_.Post(std::move(task)); }
+
+  const ShardMetrics& metrics() const { return metrics_; }
+
+  // Queues |frame| for the connection in |slot| if it is still |id|. A
+  // nonzero |received_ns| is when the webrtc-signal being forwarded
+  // arrived.
+  void Deliver(uint32_t slot, std::string_view id,
+               const std::shared_ptr<const std::string>& frame,
+               int64_t received_ns) {
+    if (slot >= slots_.size() || !slots_[slot]) {
+      return;
+    }
+    Connection* connection = slots_[slot].get();
+    if (connection->id == id && connection->connected) {
+      Queue(connection, *frame);
+      if (received_ns != 0) {
+        metrics_.signal_forward.Observe(
+            static_cast<double>(EventLoop::NowNs() - received_ns) / 1e9);
+      }
+    }
+  }
+
+  // Queues |frame| for this shard's members of |group| in |audience|,
+  // except |except_id|.
+  void DeliverToGroup(const std::shared_ptr<const std::string>& frame,
+                      const std::string& group, const std::string& except_id,
+                      Audience audience) {
+    auto it = groups_.find(group);
+    if (it == groups_.end()) {
+      return;
+    }
+    // Queue() may close a connection, which leaves the group.
+    std::vector<Connection*> members = it->second.members;
+    for (Connection* connection : members) {
+      if (connection->connected && connection->id != except_id &&
+          (audience == Audience::kEveryone || !connection->deltas)) {
+        Queue(connection, *frame);
+      }
+    }
+  }
+
+  // Takes the change that produced |version| of |group|. Shards publish
+  // changes concurrently, so they may arrive out of order; each is held
+  // until the ones before it are in, and the changes of one batch go out
+  // together. Shards without members in the group ignore it.
+  void DeliverChange(const std::string& group, uint64_t version,
+                     std::shared_ptr<const std::string> change_json) {
+    auto found = groups_.find(group);
+    if (found == groups_.end() || version <= found->second.delivered_version) {
+      return;
+    }
+    GroupState& state = found->second;
+    state.early_changes.emplace(version, std::move(change_json));
+    for (auto it = state.early_changes.begin();
+         it != state.early_changes.end() &&
+         it->first == state.delivered_version + 1;
+         it = state.early_changes.erase(it)) {
+      state.delivered_version = it->first;
+      if (state.pending_changes.empty()) {
+        state.pending_from = it->first;
+        state.pending_changes = "[";
+        changed_groups_.push_back(group);
+      } else {
+        state.pending_changes += ',';
+      }
+      state.pending_changes += *it->second;
+    }
+  }
+
+  void OnConnectionReady(Connection* connection, uint32_t events) {
+    if (connection->state == Connection::State::kClosed) {
+      return;  // closed earlier in this batch
+    }
+    if (events & (EPOLLERR | EPOLLHUP)) {
+      Close(connection, "connection lost");
+      return;
+    }
+    if (events & EPOLLOUT) {
+      Flush(connection);
+    }
+    if ((events & EPOLLIN) && connection->state != Connection::State::kClosed) {
+      Read(connection);
+    }
+  }
+
+ private:
+  struct Listener : EventLoop::Handler {
+    explicit Listener(Shard* shard) : shard(shard) {}
+    void OnReady(uint32_t) override { shard->Accept(); }
+    Shard* shard;
+  };
+
+  void Accept() {
+    for (;;) {
+      const int fd = ::accept4(listen_fd_, nullptr, nullptr,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) {
+        if (errno == EMFILE || errno == ENFILE) {
+          // Out of descriptors: stop accepting until the next tick rather
+          // than spin on a listener that stays readable.
+          Log("shard %zu: out of file descriptors, pausing accept", index_);
+          loop_.Remove(listen_fd_);
+          listening_ = false;
+        }
+        return;
+      }
+      const int one = 1;
+      ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      uint32_t slot;
+      if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+      } else if (slots_.size() < kMaxSlots) {
+        slot = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+      } else {
+        ::close(fd);
+        continue;
+      }
+      auto connection = std::make_unique<Connection>();
+      connection->shard = this;
+      connection->fd = fd;
+      connection->slot = slot;
+      connection->id = NewId(slot);
+      connection->opened_ms = EventLoop::NowMs();
+      if (!loop_.Add(fd, EPOLLIN | EPOLLRDHUP, connection.get())) {
+        ::close(fd);
+        free_slots_.push_back(slot);
+        continue;
+      }
+      slots_[slot] = std::move(connection);
+      server_->connections_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  std::string NewId(uint32_t slot) {
+    uint8_t bytes[kIdBytes];
+    bytes[0] = static_cast<uint8_t>(index_);
+    bytes[1] = static_cast<uint8_t>(slot >> 16);
+    bytes[2] = static_cast<uint8_t>(slot >> 8);
+    bytes[3] = static_cast<uint8_t>(slot);
+    for (size_t i = 4; i < kIdBytes; i += 4) {
+      const uint32_t word = random_();
+      std::memcpy(bytes + i, &word, std::min<size_t>(4, kIdBytes - i));
+    }
+    return Base64UrlEncode(bytes, sizeof(bytes));
+  }
+
+  void Read(Connection* connection) {
+    size_t budget = kReadBudget;
+    while (budget > 0) {
+      const size_t old_size = connection->in.size();
+      connection->in.resize(old_size + kReadSize);
+      const ssize_t count =
+          ::recv(connection->fd, &connection->in[old_size], kReadSize, 0);
+      connection->in.resize(old_size + (count > 0 ? count : 0));
+      if (count > 0) {
+        budget -= std::min(budget, static_cast<size_t>(count));
+        continue;
+      }
+      if (count == 0) {
+        Process(connection);
+        Close(connection, "client closed the connection");
+        return;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      if (errno != EINTR) {
+        Close(connection, "read failed");
+        return;
+      }
+    }
+    Process(connection);
+  }
+
+  void Process(Connection* connection) {
+    if (connection->close_after_write) {
+      connection->in.clear();  // nothing more is read once closing
+      return;
+    }
+    if (connection->state == Connection::State::kHttp) {
+      HandleHttp(connection);
+    }
+    if (connection->state == Connection::State::kWebSocket) {
+      HandleWebSocket(connection);
+    }
+    // Clients ask for the list under several names at once; they all get
+    // one copy, under the name the client listens for.
+    if (connection->list_requested && connection->connected) {
+      connection->list_requested = false;
+      SendEvent(connection, "devices",
+                *server_->registry_.ListJson(connection->group));
+    }
+    // Changes already in the snapshot that reach this shard later are
+    // skipped by the client, which goes by version.
+    if (connection->snapshot_requested && connection->connected) {
+      connection->snapshot_requested = false;
+      SendEvent(connection, "device-snapshot",
+                *server_->registry_.SnapshotJson(connection->group));
+    }
+  }
+
+  void HandleHttp(Connection* connection) {
+    HttpRequest request;
+    const ptrdiff_t length = ParseHttpRequest(connection->in, &request);
+    if (length == 0) {
+      return;
+    }
+    if (length < 0) {
+      Respond(connection, HttpResponse(400, "text/plain", "Bad request"));
+      return;
+    }
+    connection->in.erase(0, static_cast<size_t>(length));
+    if (request.path == "/health") {
+      Respond(connection, HttpResponse(200, "application/json",
+                                       server_->HealthJson()));
+      return;
+    }
+    if (request.path == "/metrics") {
+      Respond(connection,
+              HttpResponse(200, "text/plain; version=0.0.4; charset=utf-8",
+                           server_->MetricsText()));
+      return;
+    }
+    if (request.path != "/socket.io/" && request.path != "/socket.io") {
+      Respond(connection, HttpResponse(404, "text/plain", "Not found"));
+      return;
+    }
+    if (QueryParameter(request.query, "EIO") != "4") {
+      Respond(connection, EngineError(5, "Unsupported protocol version"));
+      return;
+    }
+    // Long polling is not offered; clients fall back to it only when
+    // WebSocket fails.
+    if (QueryParameter(request.query, "transport") != "websocket") {
+      Respond(connection, EngineError(0, "Transport unknown"));
+      return;
+    }
+    const std::string_view key = request.Header("sec-websocket-key");
+    if (request.method != "GET" ||
+        !HeaderHasToken(request.Header("upgrade"), "websocket") ||
+        !HeaderHasToken(request.Header("connection"), "upgrade") ||
+        request.Header("sec-websocket-version") != "13" || key.empty()) {
+      Respond(connection, EngineError(3, "Bad request"));
+      return;
+    }
+    connection->user_agent = std::string(request.Header("user-agent"));
+    Queue(connection,
+          "HTTP/1.1 101 Switching Protocols\r\n"
+          "Upgrade: websocket\r\n"
+          "Connection: Upgrade\r\n"
+          "Sec-WebSocket-Accept: " +
+              WebSocketAccept(key) + "\r\n\r\n");
+    connection->state = Connection::State::kWebSocket;
+    connection->last_ping_ms = EventLoop::NowMs();
+    const ServerOptions& options = server_->options_;
+    SendText(connection,
+             EncodeOpenPacket(connection->id, options.ping_interval_ms,
+                              options.ping_timeout_ms, options.max_payload));
+  }
+
+  void Respond(Connection* connection, const std::string& response) {
+    Queue(connection, response);
+    connection->close_after_write = true;
+  }
+
+  void HandleWebSocket(Connection* connection) {
+    const size_t max_payload = server_->options_.max_payload;
+    size_t consumed = 0;
+    while (connection->state == Connection::State::kWebSocket &&
+           !connection->close_after_write) {
+      WebSocketFrame frame;
+      const ptrdiff_t length = ParseWebSocketFrame(
+          &connection->in[consumed], connection->in.size() - consumed, true,
+          max_payload, &frame);
+      if (length == 0) {
+        break;
+      }
+      if (length < 0) {
+        CloseWebSocket(connection, 1002);
+        break;
+      }
+      consumed += static_cast<size_t>(length);
+      switch (frame.opcode) {
+        case WebSocketOpcode::kPing: {
+          std::string pong;
+          AppendWebSocketFrame(&pong, WebSocketOpcode::kPong, frame.payload);
+          Queue(connection, pong);
+          break;
+        }
+        case WebSocketOpcode::kPong:
+          break;
+        case WebSocketOpcode::kClose:
+          CloseWebSocket(connection, 1000);
+          break;
+        case WebSocketOpcode::kText:
+        case WebSocketOpcode::kBinary:
+          if (connection->in_fragment) {
+            CloseWebSocket(connection, 1002);
+            break;
+          }
+          if (frame.fin) {
+            if (frame.opcode == WebSocketOpcode::kText) {
+              HandleMessage(connection, frame.payload);
+            }
+          } else {
+            connection->in_fragment = true;
+            connection->fragment_is_text =
+                frame.opcode == WebSocketOpcode::kText;
+            connection->fragments.assign(frame.payload);
+          }
+          break;
+        case WebSocketOpcode::kContinuation:
+          if (!connection->in_fragment ||
+              connection->fragments.size() + frame.payload.size() >
+                  max_payload) {
+            CloseWebSocket(connection, 1009);
+            break;
+          }
+          connection->fragments.append(frame.payload);
+          if (frame.fin) {
+            connection->in_fragment = false;
+            std::string message;
+            message.swap(connection->fragments);
+            if (connection->fragment_is_text) {
+              HandleMessage(connection, message);
+            }
+          }
+          break;
+      }
+    }
+    if (connection->state != Connection::State::kClosed) {
+      connection->in.erase(0, consumed);
+    }
+  }
+
+  // Sends a close frame with |status| and closes once it is out.
+  void CloseWebSocket(Connection* connection, uint16_t status) {
+    const char payload[2] = {static_cast<char>(status >> 8),
+                             static_cast<char>(status)};
+    std::string frame;
+    AppendWebSocketFrame(&frame, WebSocketOpcode::kClose,
+                         std::string_view(payload, 2));
+    Queue(connection, frame);
+    connection->close_after_write = true;
+    Disconnect(connection);
+  }
+
+  // Takes |connection| out of the Socket.IO namespace.
+  void Disconnect(Connection* connection) {
+    if (connection->connected) {
+      connection->connected = false;
+      metrics_.events[kDisconnectEvent].Add();
+    }
+  }
+
+  void HandleMessage(Connection* connection, std::string_view message) {
+    if (message.empty()) {
+      return;
+    }
+    switch (static_cast<EnginePacket>(message[0])) {
+      case EnginePacket::kPing:
+        SendText(connection, "3" + std::string(message.substr(1)));
+        break;
+      case EnginePacket::kPong:
+        connection->awaiting_pong = false;
+        break;
+      case EnginePacket::kMessage:
+        HandleSocketIo(connection, message.substr(1));
+        break;
+      case EnginePacket::kClose:
+        CloseWebSocket(connection, 1000);
+        break;
+      default:
+        break;
+    }
+  }
+
+  void HandleSocketIo(Connection* connection, std::string_view text) {
+    SocketIoPacket packet;
+    if (!ParseSocketIoPacket(text, &packet)) {
+      CloseWebSocket(connection, 1003);
+      return;
+    }
+    if (packet.nsp != "/") {
+      if (packet.type == SocketPacket::kConnect) {
+        SendText(connection, "44" + std::string(packet.nsp) +
+                                 ",{\"message\":\"Invalid namespace\"}");
+      }
+      return;
+    }
+    switch (packet.type) {
+      case SocketPacket::kConnect:
+        if (!connection->connected) {
+          connection->connected = true;
+          metrics_.events[kConnectionEvent].Add();
+          SendText(connection, EncodeConnectPacket(connection->id));
+          if (server_->options_.verbose) {
+            Log("connect %s", connection->id.c_str());
+          }
+        }
+        break;
+      case SocketPacket::kDisconnect:
+        CloseWebSocket(connection, 1000);
+        break;
+      case SocketPacket::kEvent: {
+        SocketIoEvent event;
+        if (connection->connected && ParseSocketIoEvent(packet.data, &event)) {
+          HandleEvent(connection, event);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  void HandleEvent(Connection* connection, const SocketIoEvent& event) {
+    const std::string& name = event.name;
+    metrics_.events[EventIndex(name)].Add();
+    if (server_->options_.verbose) {
+      Log("event %s from %s", name.c_str(), connection->id.c_str());
+    }
+    DeviceRegistry& registry = server_->registry_;
+    if (name == "register") {
+      DeviceInfo device;
+      device.id = connection->id;
+      device.name = json::StringMember(event.arg, "deviceName");
+      if (device.name.empty()) {
+        device.name = FallbackName(connection->id, connection->user_agent);
+      }
+      device.platform = json::StringMember(event.arg, "platform");
+      if (device.platform.empty()) {
+        device.platform = "unknown";
+      }
+      device.group = json::StringMember(event.arg, "group");
+      if (device.group.size() > kMaxGroupSize) {
+        Log("refusing registration of %s: group key too long",
+            connection->id.c_str());
+        return;
+      }
+      if (connection->registered && connection->group != device.group) {
+        Unregister(connection);
+      }
+      DeviceChange change;
+      registry.Register(device, &change);
+      if (!connection->registered) {
+        connection->registered = true;
+        JoinGroup(connection, device.group);
+      }
+      std::string_view deltas;
+      connection->deltas = json::FindMember(event.arg, "deltas", &deltas) &&
+                           deltas == "true";
+      std::string announcement = "{\"deviceId\":";
+      json::AppendString(&announcement, device.id);
+      announcement += ",\"id\":";
+      json::AppendString(&announcement, device.id);
+      announcement += ",\"socketId\":";
+      json::AppendString(&announcement, device.id);
+      announcement += ",\"name\":";
+      json::AppendString(&announcement, device.name);
+      announcement += '}';
+      server_->Broadcast(EventFrame("device-connected", announcement),
+                         device.group, connection->id, Audience::kLegacyList);
+      server_->PublishChange(change);
+      if (connection->deltas) {
+        connection->snapshot_requested = true;
+      } else {
+        connection->list_requested = true;
+      }
+    } else if (name == "share-ready") {
+      if (connection->registered) {
+        DeviceChange change;
+        registry.SetReady(connection->id, true, &change);
+        server_->Broadcast(
+            EventFrame("share-available",
+                       IdObject("deviceId", connection->id)),
+            connection->group, {}, Audience::kLegacyList);
+        server_->PublishChange(change);
+      }
+    } else if (name == "share-not-ready" || name == "not-ready") {
+      DeviceChange change;
+      registry.SetReady(connection->id, false, &change);
+      server_->PublishChange(change);
+    } else if (name == "sync-devices") {
+      connection->snapshot_requested = connection->registered;
+    } else if (name == "request-share") {
+      // The app may name the device to ask, from its device list.
+      const std::string preferred = json::StringMember(event.arg, "deviceId");
+      std::string sharer;
+      if (registry.PickSharer(connection->group, connection->id, preferred,
+                              &sharer)) {
+        // The requester's trace id, if any, goes on to the sharer so both
+        // ends trace the share under it.
+        std::string request = IdObject("from", connection->id);
+        const std::string trace_id = json::StringMember(event.arg, "traceId");
+        if (!trace_id.empty()) {
+          request.pop_back();
+          request += ",\"traceId\":";
+          json::AppendString(&request, trace_id);
+          request += '}';
+        }
+        server_->SendTo(sharer, EventFrame("share-request", request), this,
+                        0);
+      } else {
+        SendEvent(connection, "no-sharer-available",
+                  "{\"message\":\"No other device is ready to share right "
+                  "now.\"}");
+      }
+    } else if (name == "webrtc-signal") {
+      // One {to, signal} object, or an array of them sent together.
+      std::vector<std::string_view> signals;
+      if (json::ArrayElements(event.arg, &signals)) {
+        for (std::string_view signal : signals) {
+          RelaySignal(connection, signal);
+        }
+      } else {
+        RelaySignal(connection, event.arg);
+      }
+    } else if (name == "get-devices" || name == "list-devices" ||
+               name == "get-connected-devices" || name == "devices" ||
+               name == "clients" || name == "room-info") {
+      connection->list_requested = true;
+    }
+  }
+
+  // Forwards one {to, signal} from |connection| to its recipient.
+  void RelaySignal(Connection* connection, std::string_view arg) {
+    std::string to = json::StringMember(arg, "to");
+    if (to.empty()) {
+      return;
+    }
+    // Groups are isolated by more than the secrecy of socket ids.
+    if (!connection->registered ||
+        !server_->registry_.InGroup(to, connection->group)) {
+      metrics_.signals_dropped.Add();
+      return;
+    }
+    std::string relayed = "{\"from\":";
+    json::AppendString(&relayed, connection->id);
+    std::string_view signal;
+    if (json::FindMember(arg, "signal", &signal)) {
+      relayed += ",\"signal\":";
+      relayed += signal;
+    }
+    relayed += '}';
+    server_->SendTo(to, EventFrame("webrtc-signal", relayed), this,
+                    loop_.batch_started_ns());
+  }
+
+  void SendEvent(Connection* connection, std::string_view name,
+                 std::string_view arg) {
+    SendText(connection, EncodeEventPacket(name, arg));
+  }
+
+  void SendText(Connection* connection, std::string_view packet) {
+    std::string frame;
+    AppendWebSocketFrame(&frame, WebSocketOpcode::kText, packet);
+    Queue(connection, frame);
+  }
+
+  void Queue(Connection* connection, std::string_view bytes) {
+    if (connection->state == Connection::State::kClosed) {
+      return;
+    }
+    connection->out.append(bytes);
+    const size_t pending = connection->out.size() - connection->out_offset;
+    metrics_.outbound_bytes.Add(static_cast<int64_t>(bytes.size()));
+    metrics_.outbound_queue.Observe(static_cast<double>(pending));
+    if (pending > server_->options_.max_outbound) {
+      Close(connection, "client is not reading");
+      return;
+    }
+    if (!connection->dirty) {
+      connection->dirty = true;
+      dirty_.push_back(connection);
+    }
+  }
+
+  void Flush(Connection* connection) {
+    while (connection->out_offset < connection->out.size()) {
+      const ssize_t sent =
+          ::send(connection->fd, connection->out.data() + connection->out_offset,
+                 connection->out.size() - connection->out_offset,
+                 MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (sent > 0) {
+        connection->out_offset += static_cast<size_t>(sent);
+        metrics_.outbound_bytes.Add(-sent);
+        continue;
+      }
+      if (sent < 0 && errno == EINTR) {
+        continue;
+      }
+      if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        if (!connection->watching_writable) {
+          connection->watching_writable = true;
+          loop_.Modify(connection->fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP,
+                       connection);
+        }
+        return;
+      }
+      Close(connection, "write failed");
+      return;
+    }
+    connection->out.clear();
+    connection->out_offset = 0;
+    if (connection->close_after_write) {
+      Close(connection, nullptr);
+      return;
+    }
+    if (connection->watching_writable) {
+      connection->watching_writable = false;
+      loop_.Modify(connection->fd, EPOLLIN | EPOLLRDHUP, connection);
+    }
+  }
+
+  void FlushAll() {
+    for (size_t i = 0; i < dirty_.size(); i++) {
+      Connection* connection = dirty_[i];
+      connection->dirty = false;
+      if (connection->state != Connection::State::kClosed &&
+          !connection->watching_writable) {
+        Flush(connection);
+      }
+    }
+    dirty_.clear();
+    closed_.clear();
+  }
+
+  // Makes |connection| a member of |group| on this shard. A shard with no
+  // members in the group starts at the group's current version: changes up
+  // to it are in the list or snapshot the new member is sent.
+  void JoinGroup(Connection* connection, const std::string& group) {
+    GroupState& state = groups_[group];
+    if (state.members.empty()) {
+      state.delivered_version = server_->registry_.Version(group);
+      state.early_changes.clear();
+      state.pending_changes.clear();
+    }
+    connection->group = group;
+    connection->member_index = state.members.size();
+    state.members.push_back(connection);
+  }
+
+  void LeaveGroup(Connection* connection) {
+    auto it = groups_.find(connection->group);
+    std::vector<Connection*>& members = it->second.members;
+    Connection* last = members.back();
+    members[connection->member_index] = last;
+    last->member_index = connection->member_index;
+    members.pop_back();
+    if (members.empty()) {
+      emptied_groups_.push_back(connection->group);
+    }
+  }
+
+  // Removes the device of |connection| from the registry and its group,
+  // and tells the rest of the group.
+  void Unregister(Connection* connection) {
+    DeviceChange change;
+    if (server_->registry_.Unregister(connection->id, &change)) {
+      server_->Broadcast(EventFrame("device-disconnected",
+                                    IdObject("deviceId", connection->id)),
+                         connection->group, {}, Audience::kLegacyList);
+      server_->PublishChange(change);
+    }
+    LeaveGroup(connection);
+    connection->registered = false;
+  }
+
+  // Sends the changes delivered in this batch to the delta clients, as one
+  // frame per group shared by its members.
+  void SendChanges() {
+    for (const std::string& group : changed_groups_) {
+      auto it = groups_.find(group);
+      if (it == groups_.end() || it->second.pending_changes.empty()) {
+        continue;
+      }
+      GroupState& state = it->second;
+      state.pending_changes += ']';
+      std::string arg = "{\"from\":" + std::to_string(state.pending_from) +
+                        ",\"to\":" + std::to_string(state.delivered_version) +
+                        ",\"changes\":" + state.pending_changes + "}";
+      state.pending_changes.clear();
+      const auto frame = EventFrame("device-delta", arg);
+      std::vector<Connection*> members = state.members;
+      for (Connection* connection : members) {
+        if (connection->connected && connection->deltas) {
+          Queue(connection, *frame);
+        }
+      }
+    }
+    changed_groups_.clear();
+    for (const std::string& group : emptied_groups_) {
+      auto it = groups_.find(group);
+      if (it != groups_.end() && it->second.members.empty()) {
+        groups_.erase(it);
+      }
+    }
+    emptied_groups_.clear();
+  }
+
+  void Tick() {
+    metrics_.loop_lag.Observe(static_cast<double>(loop_.tick_lag_ns()) / 1e9);
+    const int64_t now = EventLoop::NowMs();
+    if (!listening_) {
+      listening_ = loop_.Add(listen_fd_, EPOLLIN | EPOLLEXCLUSIVE, &listener_);
+    }
+    const ServerOptions& options = server_->options_;
+    for (size_t i = 0; i < slots_.size(); i++) {
+      Connection* connection = slots_[i].get();
+      if (connection == nullptr || connection->close_after_write) {
+        continue;
+      }
+      if (connection->state == Connection::State::kHttp) {
+        if (now - connection->opened_ms > kRequestTimeoutMs) {
+          Close(connection, "request timeout");
+        }
+        continue;
+      }
+      if (!connection->connected &&
+          now - connection->opened_ms > kConnectTimeoutMs) {
+        Close(connection, "connect timeout");
+      } else if (connection->awaiting_pong) {
+        if (now - connection->last_ping_ms > options.ping_timeout_ms) {
+          Close(connection, "ping timeout");
+        }
+      } else if (now - connection->last_ping_ms >= options.ping_interval_ms) {
+        connection->awaiting_pong = true;
+        connection->last_ping_ms = now;
+        SendText(connection, "2");
+      }
+    }
+  }
+
+  // Closes the socket at once. The connection object lives on until the
+  // end of the batch, since events for it may still be pending.
+  void Close(Connection* connection, const char* reason) {
+    if (connection->state == Connection::State::kClosed) {
+      return;
+    }
+    connection->state = Connection::State::kClosed;
+    Disconnect(connection);
+    metrics_.outbound_bytes.Add(-static_cast<int64_t>(
+        connection->out.size() - connection->out_offset));
+    loop_.Remove(connection->fd);
+    ::close(connection->fd);
+    server_->connections_.fetch_sub(1, std::memory_order_relaxed);
+    if (server_->options_.verbose && reason != nullptr) {
+      Log("close %s: %s", connection->id.c_str(), reason);
+    }
+    if (connection->registered) {
+      Unregister(connection);
+    }
+    const uint32_t slot = connection->slot;
+    closed_.push_back(std::move(slots_[slot]));
+    free_slots_.push_back(slot);
+  }
+
+  SignalingServer* server_;
+  size_t index_;
+  int listen_fd_ = -1;
+  bool listening_ = false;
+  EventLoop loop_;
+  Listener listener_;
+  std::vector<std::unique_ptr<Connection>> slots_;
+  std::vector<uint32_t> free_slots_;
+  std::vector<Connection*> dirty_;
+  std::vector<std::unique_ptr<Connection>> closed_;
+  std::random_device random_;
+  ShardMetrics metrics_;
+
+  // This shard's registered connections in one group, and the group's
+  // changes by version: the last one passed on to them, those that arrived
+  // ahead of it, and the JSON array of those passed on in this batch,
+  // starting at |pending_from|.
+  struct GroupState {
+    std::vector<Connection*> members;
+    uint64_t delivered_version = 0;
+    std::map<uint64_t, std::shared_ptr<const std::string>> early_changes;
+    std::string pending_changes;
+    uint64_t pending_from = 0;
+  };
+
+  std::unordered_map<std::string, GroupState> groups_;
+  // Groups with changes to send, and groups left without members here, in
+  // this batch.
+  std::vector<std::string> changed_groups_;
+  std::vector<std::string> emptied_groups_;
+};
+
+void SignalingServer::Connection::OnReady(uint32_t events) {
+  shard->OnConnectionReady(this, events);
+}
+
+SignalingServer::SignalingServer(const ServerOptions& options)
+    : options_(options), registry_(options.sharer_policy) {}
+
+SignalingServer::~SignalingServer() { Stop(); }
+
+bool SignalingServer::Start() {
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+  addrinfo* addresses = nullptr;
+  const std::string port = std::to_string(options_.port);
+  if (::getaddrinfo(options_.host.empty() ? nullptr : options_.host.c_str(),
+                    port.c_str(), &hints, &addresses) != 0) {
+    return false;
+  }
+  for (addrinfo* address = addresses; address != nullptr;
+       address = address->ai_next) {
+    const int fd = ::socket(address->ai_family,
+                            address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                            address->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    const int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::bind(fd, address->ai_addr, address->ai_addrlen) == 0 &&
+        ::listen(fd, SOMAXCONN) == 0) {
+      listen_fd_ = fd;
+      break;
+    }
+    ::close(fd);
+  }
+  ::freeaddrinfo(addresses);
+  if (listen_fd_ < 0) {
+    return false;
+  }
+  sockaddr_storage bound = {};
+  socklen_t bound_size = sizeof(bound);
+  ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&bound), &bound_size);
+  port_ = ntohs(bound.ss_family == AF_INET6
+                    ? reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port
+                    : reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+
+  size_t count = options_.shards;
+  if (count == 0) {
+    count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  count = std::min<size_t>(count, 256);  // the shard is one byte of the id
+  for (size_t i = 0; i < count; i++) {
+    shards_.push_back(std::make_unique<Shard>(this, i));
+    if (!shards_.back()->Init(listen_fd_)) {
+      shards_.clear();
+      ::close(listen_fd_);
+      listen_fd_ = -1;
+      return false;
+    }
+  }
+  started_ms_ = EventLoop::NowMs();
+  for (auto& shard : shards_) {
+    threads_.emplace_back([&shard] { shard->Run(); });
+  }
+  return true;
+}
+
+void SignalingServer::Stop() {
+  for (auto& shard : shards_) {
+    shard->Stop();
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+  shards_.clear();
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+  }
+}
+
+std::string SignalingServer::HealthJson() const {
+  timespec now;
+  ::clock_gettime(CLOCK_REALTIME, &now);
+  tm utc;
+  ::gmtime_r(&now.tv_sec, &utc);
+  char timestamp[40];
+  const size_t length =
+      std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &utc);
+  std::snprintf(timestamp + length, sizeof(timestamp) - length, ".%03ldZ",
+                now.tv_nsec / 1000000);
+  const double uptime =
+      static_cast<double>(EventLoop::NowMs() - started_ms_) / 1000.0;
+  char body[512];
+  std::snprintf(body, sizeof(body),
+                "{\"status\":\"OK\",\"timestamp\":\"%s\",\"uptime\":%.3f,"
+                "\"server\":\"shared_clipboard_server\",\"version\":\"1.0.0\","
+                "\"connectedDevices\":%zu,\"devicesReadyToShare\":%zu,"
+                "\"groups\":%zu,\"connections\":%zu,\"shards\":%zu}",
+                timestamp, uptime, registry_.size(), registry_.ready_count(),
+                registry_.group_count(), connection_count(), shards_.size());
+  return body;
+}
+
+std::string SignalingServer::MetricsText() const {
+  MetricsWriter out;
+  out.Begin("signaling_events_total",
+            "Socket.IO events received, by event name.", "counter");
+  for (size_t i = 0; i < kEventKinds; i++) {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+      total += shard->metrics().events[i].value();
+    }
+    out.Sample("signaling_events_total",
+               "event=\"" + std::string(kCountedEvents[i]) + "\"",
+               static_cast<double>(total));
+  }
+  uint64_t signals_dropped = 0;
+  for (const auto& shard : shards_) {
+    signals_dropped += shard->metrics().signals_dropped.value();
+  }
+  out.Begin("signaling_webrtc_signals_dropped_total",
+            "webrtc-signals dropped because the recipient is not in the "
+            "sender's group.",
+            "counter");
+  out.Sample("signaling_webrtc_signals_dropped_total", {},
+             static_cast<double>(signals_dropped));
+  std::vector<const Histogram*> forward;
+  std::vector<const Histogram*> queue;
+  std::vector<const Histogram*> lag;
+  std::vector<const Histogram*> batch;
+  int64_t outbound_bytes = 0;
+  for (const auto& shard : shards_) {
+    const ShardMetrics& metrics = shard->metrics();
+    forward.push_back(&metrics.signal_forward);
+    queue.push_back(&metrics.outbound_queue);
+    lag.push_back(&metrics.loop_lag);
+    batch.push_back(&metrics.batch);
+    outbound_bytes += metrics.outbound_bytes.value();
+  }
+  out.WriteHistogram(
+      "signaling_webrtc_signal_forward_seconds",
+      "Time to forward one webrtc-signal to its recipient, in seconds.",
+      forward);
+  const struct {
+    const char* name;
+    const char* help;
+    double value;
+  } gauges[] = {
+      {"signaling_connected_sockets", "Open connections.",
+       static_cast<double>(connection_count())},
+      {"signaling_connected_devices", "Registered devices.",
+       static_cast<double>(registry_.size())},
+      {"signaling_ready_devices", "Devices ready to share.",
+       static_cast<double>(registry_.ready_count())},
+      {"signaling_groups", "Groups with at least one device.",
+       static_cast<double>(registry_.group_count())},
+      {"signaling_outbound_queued_bytes",
+       "Bytes queued on all connections and not yet sent.",
+       static_cast<double>(outbound_bytes)},
+  };
+  for (const auto& gauge : gauges) {
+    out.Begin(gauge.name, gauge.help, "gauge");
+    out.Sample(gauge.name, {}, gauge.value);
+  }
+  out.WriteHistogram("signaling_outbound_queue_bytes",
+                     "Bytes queued on a connection, including the new "
+                     "message, as each is queued.",
+                     queue);
+  out.WriteHistogram("signaling_event_loop_lag_seconds",
+                     "How late a shard's 1 s tick ran, in seconds.", lag);
+  out.WriteHistogram("signaling_event_loop_batch_seconds",
+                     "Time a shard took to handle one batch of events, in "
+                     "seconds.",
+                     batch);
+  out.Begin("process_uptime_seconds", "Seconds since the server started.",
+            "gauge");
+  out.Sample("process_uptime_seconds", {},
+             static_cast<double>(EventLoop::NowMs() - started_ms_) / 1000.0);
+  return out.text();
+}
+
+void SignalingServer::Broadcast(std::shared_ptr<const std::string> frame,
+                                std::string_view group,
+                                std::string_view except_id,
+                                Audience audience) {
+  // Posted even to the calling shard, so a broadcast never runs in the
+  // middle of handling another connection.
+  auto target_group = std::make_shared<const std::string>(group);
+  const std::string except(except_id);
+  for (auto& shard : shards_) {
+    Shard* target = shard.get();
+    target->Post([target, frame, target_group, except, audience] {
+      target->DeliverToGroup(frame, *target_group, except, audience);
+    });
+  }
+}
+
+void SignalingServer::PublishChange(const DeviceChange& change) {
+  if (change.version == 0) {
+    return;
+  }
+  auto change_json = std::make_shared<std::string>();
+  AppendChangeJson(change_json.get(), change);
+  const uint64_t version = change.version;
+  auto group = std::make_shared<const std::string>(change.device.group);
+  for (auto& shard : shards_) {
+    Shard* target = shard.get();
+    target->Post([target, group, version, change_json] {
+      target->DeliverChange(*group, version, change_json);
+    });
+  }
+}
+
+bool SignalingServer::SendTo(std::string_view id,
+                             std::shared_ptr<const std::string> frame,
+                             Shard* from, int64_t received_ns) {
+  uint8_t route[6];
+  if (id.size() != (kIdBytes * 4 + 2) / 3 ||
+      !Base64UrlDecode(id.substr(0, 8), route)) {
+    return false;
+  }
+  const size_t index = route[0];
+  const uint32_t slot = static_cast<uint32_t>(route[1]) << 16 |
+                        static_cast<uint32_t>(route[2]) << 8 | route[3];
+  if (index >= shards_.size()) {
+    return false;
+  }
+  Shard* target = shards_[index].get();
+  if (target == from) {
+    target->Deliver(slot, id, frame, received_ns);
+  } else {
+    target->Post([target, slot, id = std::string(id), frame, received_ns] {
+      target->Deliver(slot, id, frame, received_ns);
+    });
+  }
+  return true;
+}
+
+}  // namespace signaling
+}  // namespace sc
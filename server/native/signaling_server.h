@@ -0,0 +1,128 @@
+#ifndef SERVER_NATIVE_SIGNALING_SERVER_H_
+#define SERVER_NATIVE_SIGNALING_SERVER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "device_registry.h"
+
+namespace sc {
+namespace signaling {
+
+struct ServerOptions {
+  std::string host = "0.0.0.0";
+  uint16_t port = 3000;  // 0 picks a free port
+  // Event loops, each on its own thread. Zero runs one per CPU core.
+  size_t shards = 0;
+  int ping_interval_ms = 25000;
+  int ping_timeout_ms = 20000;
+  // Largest message accepted from a client (Engine.IO's maxPayload).
+  size_t max_payload = 1000000;
+  // A client that lets more output than this pile up is dropped.
+  size_t max_outbound = 16 * 1024 * 1024;
+  // Logs every event, not just the server's own lifecycle.
+  bool verbose = false;
+  // Picks the device a request-share goes to when it names none.
+  SharerPolicy sharer_policy = SharerPolicy::kMostRecent;
+};
+
+// Signaling server speaking the same Socket.IO events as server/server.js,
+// over WebSocket only (Engine.IO 4, the transport the client tries first).
+//
+// Connections are spread over shards, one epoll loop per core, that all
+// accept from one listening socket. A connection lives on the shard that
+// accepted it, and its Socket.IO id encodes that shard and the
+// connection's slot there, so a signal for a device is routed to it without
+// a lookup. Shards reach each other's connections only by posting tasks to
+// the owning loop. The registry of devices is the one structure they share.
+//
+// Messages to many clients are framed once and shared, and output is
+// flushed once per loop iteration, so a broadcast costs one append per
+// recipient plus one send per connection per batch.
+//
+// Devices register with an optional "group" key, per user or team, and
+// only ever see and share with devices in the same group: announcements,
+// lists, deltas and request-share are all scoped to it. Each shard keeps
+// its connections by group, so an event costs in proportion to the group,
+// not the fleet. Devices that send no group share one.
+//
+// Devices that register with {"deltas": true} get the device list once, as
+// a versioned 'device-snapshot', and then one 'device-delta' per loop
+// iteration with the registry changes made since, in version order. They
+// ask for a new snapshot with 'sync-devices' if they see a gap. The legacy
+// events (device-connected, device-disconnected, share-available and the
+// full 'devices' list) then go only to clients that did not opt in.
+//
+// Linux only.
+class SignalingServer {
+ public:
+  explicit SignalingServer(const ServerOptions& options);
+  ~SignalingServer();
+
+  // Prevent copying.
+  SignalingServer(SignalingServer const&) = delete;
+  SignalingServer& operator=(SignalingServer const&) = delete;
+
+  // Binds the listening socket and starts the shards. Returns false if the
+  // address cannot be bound.
+  bool Start();
+
+  // Stops the shards and closes every connection.
+  void Stop();
+
+  // Port actually bound, once started.
+  uint16_t port() const { return port_; }
+  size_t shard_count() const { return shards_.size(); }
+  const DeviceRegistry& registry() const { return registry_; }
+  // Open connections, registered or not.
+  size_t connection_count() const {
+    return connections_.load(std::memory_order_relaxed);
+  }
+
+  // Body of the /health response.
+  std::string HealthJson() const;
+  // Body of the /metrics response, in the Prometheus text format.
+  std::string MetricsText() const;
+
+ private:
+  class Shard;
+  struct Connection;
+
+  // Clients a broadcast is for.
+  enum class Audience { kEveryone, kLegacyList };
+
+  // Queues |frame| for every connected member of |group| in |audience|
+  // except |except_id|.
+  void Broadcast(std::shared_ptr<const std::string> frame,
+                 std::string_view group, std::string_view except_id,
+                 Audience audience = Audience::kEveryone);
+  // Sends |change| to every shard, which passes it on to the delta clients
+  // in its group in version order.
+  void PublishChange(const DeviceChange& change);
+  // Queues |frame| for the client with Socket.IO id |id|. A nonzero
+  // |received_ns| (EventLoop::NowNs()) is when the webrtc-signal being
+  // forwarded arrived, for its latency metric. Returns false if the id
+  // cannot belong to this server.
+  bool SendTo(std::string_view id, std::shared_ptr<const std::string> frame,
+              Shard* from, int64_t received_ns);
+
+  ServerOptions options_;
+  int listen_fd_ = -1;
+  uint16_t port_ = 0;
+  int64_t started_ms_ = 0;
+  DeviceRegistry registry_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> connections_{0};
+};
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_SIGNALING_SERVER_H_
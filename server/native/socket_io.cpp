@@ -0,0 +1,83 @@
+#include "socket_io.h"
+
+#include <vector>
+
+#include "json.h"
+
+namespace sc {
+namespace signaling {
+
+bool ParseSocketIoPacket(std::string_view text, SocketIoPacket* packet) {
+  if (text.empty() || text[0] < '0' || text[0] > '6') {
+    return false;
+  }
+  packet->type = static_cast<SocketPacket>(text[0]);
+  if (packet->type == SocketPacket::kBinaryEvent ||
+      packet->type == SocketPacket::kBinaryAck) {
+    return false;
+  }
+  text.remove_prefix(1);
+  packet->nsp = "/";
+  if (!text.empty() && text[0] == '/') {
+    const size_t comma = text.find(',');
+    packet->nsp = text.substr(0, comma);
+    text.remove_prefix(comma == std::string_view::npos ? text.size()
+                                                       : comma + 1);
+  }
+  packet->ack_id = -1;
+  size_t digits = 0;
+  while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9') {
+    if (++digits > 9) {
+      return false;
+    }
+    packet->ack_id = (packet->ack_id < 0 ? 0 : packet->ack_id * 10) +
+                     (text[digits - 1] - '0');
+  }
+  text.remove_prefix(digits);
+  packet->data = text;
+  return true;
+}
+
+bool ParseSocketIoEvent(std::string_view data, SocketIoEvent* event) {
+  std::vector<std::string_view> elements;
+  if (!json::ArrayElements(data, &elements) || elements.empty() ||
+      !json::DecodeString(elements[0], &event->name)) {
+    return false;
+  }
+  event->arg = elements.size() > 1 ? elements[1] : std::string_view();
+  return true;
+}
+
+std::string EncodeOpenPacket(std::string_view sid, int ping_interval_ms,
+                             int ping_timeout_ms, size_t max_payload) {
+  std::string packet = "0{\"sid\":";
+  json::AppendString(&packet, sid);
+  packet += ",\"upgrades\":[],\"pingInterval\":" +
+            std::to_string(ping_interval_ms) +
+            ",\"pingTimeout\":" + std::to_string(ping_timeout_ms) +
+            ",\"maxPayload\":" + std::to_string(max_payload) + "}";
+  return packet;
+}
+
+std::string EncodeConnectPacket(std::string_view sid) {
+  std::string packet = "40{\"sid\":";
+  json::AppendString(&packet, sid);
+  packet += '}';
+  return packet;
+}
+
+std::string EncodeEventPacket(std::string_view name, std::string_view arg) {
+  std::string packet;
+  packet.reserve(name.size() + arg.size() + 8);
+  packet += "42[";
+  json::AppendString(&packet, name);
+  if (!arg.empty()) {
+    packet += ',';
+    packet += arg;
+  }
+  packet += ']';
+  return packet;
+}
+
+}  // namespace signaling
+}  // namespace sc
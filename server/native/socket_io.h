@@ -0,0 +1,70 @@
+#ifndef SERVER_NATIVE_SOCKET_IO_H_
+#define SERVER_NATIVE_SOCKET_IO_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace sc {
+namespace signaling {
+
+// Engine.IO 4 and Socket.IO 5 packets, as spoken by socket.io 4.x servers
+// and socket_io_client 2.x. Over WebSocket every text message is one
+// Engine.IO packet: a type digit followed by data. A Socket.IO packet rides
+// in an Engine.IO message, e.g. `42["register",{"deviceName":"pc"}]`.
+
+enum class EnginePacket : char {
+  kOpen = '0',
+  kClose = '1',
+  kPing = '2',
+  kPong = '3',
+  kMessage = '4',
+  kUpgrade = '5',
+  kNoop = '6',
+};
+
+enum class SocketPacket : char {
+  kConnect = '0',
+  kDisconnect = '1',
+  kEvent = '2',
+  kAck = '3',
+  kConnectError = '4',
+  kBinaryEvent = '5',
+  kBinaryAck = '6',
+};
+
+struct SocketIoPacket {
+  SocketPacket type = SocketPacket::kEvent;
+  std::string_view nsp = "/";
+  long ack_id = -1;  // -1 when no acknowledgement is requested
+  std::string_view data;  // JSON, possibly empty
+};
+
+// Parses a Socket.IO packet, i.e. an Engine.IO message without its leading
+// '4'. Binary packets are refused.
+bool ParseSocketIoPacket(std::string_view text, SocketIoPacket* packet);
+
+struct SocketIoEvent {
+  std::string name;
+  std::string_view arg;  // raw JSON of the first argument, or empty
+};
+
+// Reads an event from the data of an kEvent packet: a JSON array holding
+// the event name and its arguments.
+bool ParseSocketIoEvent(std::string_view data, SocketIoEvent* event);
+
+// Engine.IO open packet sent first on a new connection.
+std::string EncodeOpenPacket(std::string_view sid, int ping_interval_ms,
+                             int ping_timeout_ms, size_t max_payload);
+
+// Reply to a client's connect to the main namespace.
+std::string EncodeConnectPacket(std::string_view sid);
+
+// Engine.IO message carrying event |name| with the single JSON argument
+// |arg|.
+std::string EncodeEventPacket(std::string_view name, std::string_view arg);
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_SOCKET_IO_H_
@@ -0,0 +1,276 @@
+#include "device_registry.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json.h"
+
+namespace sc {
+namespace signaling {
+namespace {
+
+DeviceInfo Device(const std::string& id, const std::string& name = "",
+                  const std::string& group = "") {
+  DeviceInfo device;
+  device.id = id;
+  device.group = group;
+  device.name = name.empty() ? "Device " + id : name;
+  device.platform = "windows";
+  return device;
+}
+
+TEST(DeviceRegistryTest, KeepsRegistrationOrder) {
+  DeviceRegistry registry;
+  EXPECT_TRUE(registry.Register(Device("b")));
+  EXPECT_TRUE(registry.Register(Device("a")));
+  EXPECT_TRUE(registry.Register(Device("c")));
+  // Registering again renames in place.
+  EXPECT_FALSE(registry.Register(Device("b", "Renamed")));
+  const std::vector<DeviceInfo> devices = registry.List("");
+  ASSERT_EQ(3u, devices.size());
+  EXPECT_EQ("b", devices[0].id);
+  EXPECT_EQ("Renamed", devices[0].name);
+  EXPECT_EQ("a", devices[1].id);
+  EXPECT_EQ("c", devices[2].id);
+  EXPECT_EQ(3u, registry.size());
+
+  EXPECT_TRUE(registry.Unregister("a"));
+  EXPECT_FALSE(registry.Unregister("a"));
+  EXPECT_EQ(2u, registry.size());
+  DeviceInfo found;
+  EXPECT_FALSE(registry.Find("a", &found));
+  ASSERT_TRUE(registry.Find("c", &found));
+  EXPECT_EQ("Device c", found.name);
+}
+
+TEST(DeviceRegistryTest, PicksMostRecentlyReadyDevice) {
+  DeviceRegistry registry;
+  for (const char* id : {"a", "b", "c", "d"}) {
+    registry.Register(Device(id));
+  }
+  std::string sharer;
+  EXPECT_FALSE(registry.PickSharer("", "a", "", &sharer));
+  EXPECT_FALSE(registry.SetReady("missing", true));
+  EXPECT_TRUE(registry.SetReady("b", true));
+  EXPECT_TRUE(registry.SetReady("c", true));
+  EXPECT_EQ(2u, registry.ready_count());
+  ASSERT_TRUE(registry.PickSharer("", "a", "", &sharer));
+  EXPECT_EQ("c", sharer);
+  ASSERT_TRUE(registry.PickSharer("", "c", "", &sharer));
+  EXPECT_EQ("b", sharer);
+  // Ready again, without a new version.
+  DeviceChange change;
+  registry.SetReady("b", true, &change);
+  EXPECT_EQ(0u, change.version);
+  ASSERT_TRUE(registry.PickSharer("", "a", "", &sharer));
+  EXPECT_EQ("b", sharer);
+
+  registry.SetReady("b", false);
+  EXPECT_EQ(1u, registry.ready_count());
+  ASSERT_TRUE(registry.PickSharer("", "a", "", &sharer));
+  EXPECT_EQ("c", sharer);
+  EXPECT_FALSE(registry.PickSharer("", "c", "", &sharer));
+
+  // Readiness goes with the registration.
+  registry.Unregister("c");
+  EXPECT_EQ(0u, registry.ready_count());
+  EXPECT_FALSE(registry.PickSharer("", "a", "", &sharer));
+}
+
+TEST(DeviceRegistryTest, PrefersTheNamedSharer) {
+  DeviceRegistry registry(SharerPolicy::kLeastLoaded);
+  for (const char* id : {"a", "b", "c"}) {
+    registry.Register(Device(id));
+    registry.SetReady(id, true);
+  }
+  registry.Register(Device("x", "", "other"));
+  registry.SetReady("x", true);
+  std::string sharer;
+  ASSERT_TRUE(registry.PickSharer("", "a", "b", &sharer));
+  EXPECT_EQ("b", sharer);
+  // b now has a request, so the policy goes elsewhere.
+  ASSERT_TRUE(registry.PickSharer("", "a", "", &sharer));
+  EXPECT_EQ("c", sharer);
+  // Not ready, in another group, missing, or the requester itself: the
+  // policy picks instead.
+  registry.SetReady("c", false);
+  for (const char* preferred : {"c", "x", "missing", "a"}) {
+    ASSERT_TRUE(registry.PickSharer("", "a", preferred, &sharer));
+    EXPECT_EQ("b", sharer) << preferred;
+  }
+}
+
+TEST(DeviceRegistryTest, CachesListJsonUntilChanged) {
+  DeviceRegistry registry;
+  registry.Register(Device("a", "Laptop \"1\""));
+  const auto first = registry.ListJson("");
+  EXPECT_EQ(first, registry.ListJson(""));
+  std::vector<std::string_view> elements;
+  ASSERT_TRUE(json::ArrayElements(*first, &elements));
+  ASSERT_EQ(1u, elements.size());
+  EXPECT_EQ("a", json::StringMember(elements[0], "id"));
+  EXPECT_EQ("a", json::StringMember(elements[0], "deviceId"));
+  EXPECT_EQ("Laptop \"1\"", json::StringMember(elements[0], "name"));
+  std::string_view ready;
+  ASSERT_TRUE(json::FindMember(elements[0], "readyToShare", &ready));
+  EXPECT_EQ("false", ready);
+
+  registry.SetReady("a", true);
+  const auto second = registry.ListJson("");
+  EXPECT_NE(first, second);
+  ASSERT_TRUE(json::ArrayElements(*second, &elements));
+  ASSERT_TRUE(json::FindMember(elements[0], "readyToShare", &ready));
+  EXPECT_EQ("true", ready);
+}
+
+TEST(DeviceRegistryTest, NumbersEveryChange) {
+  DeviceRegistry registry;
+  EXPECT_EQ(0u, registry.version());
+  DeviceChange change;
+  registry.Register(Device("a"), &change);
+  EXPECT_EQ(DeviceChange::Kind::kAdd, change.kind);
+  EXPECT_EQ(1u, change.version);
+  EXPECT_EQ("a", change.device.id);
+
+  registry.SetReady("a", true, &change);
+  EXPECT_EQ(DeviceChange::Kind::kReady, change.kind);
+  EXPECT_EQ(2u, change.version);
+  EXPECT_TRUE(change.device.ready_to_share);
+  // Already ready: nothing to send.
+  registry.SetReady("a", true, &change);
+  EXPECT_EQ(0u, change.version);
+  EXPECT_EQ(2u, registry.version());
+
+  registry.Register(Device("a", "Renamed"), &change);
+  EXPECT_EQ(DeviceChange::Kind::kUpdate, change.kind);
+  EXPECT_EQ(3u, change.version);
+  registry.Unregister("a", &change);
+  EXPECT_EQ(DeviceChange::Kind::kRemove, change.kind);
+  EXPECT_EQ(4u, change.version);
+  EXPECT_FALSE(registry.Unregister("a", &change));
+  EXPECT_EQ(0u, change.version);
+  EXPECT_EQ(4u, registry.version());
+}
+
+TEST(DeviceRegistryTest, DescribesChangesAsJson) {
+  DeviceChange change;
+  change.device = Device("a", "Laptop");
+  change.device.ready_to_share = true;
+  std::string out;
+  AppendChangeJson(&out, change);
+  EXPECT_EQ("add", json::StringMember(out, "op"));
+  std::string_view device;
+  ASSERT_TRUE(json::FindMember(out, "device", &device));
+  EXPECT_EQ("Laptop", json::StringMember(device, "name"));
+
+  change.kind = DeviceChange::Kind::kReady;
+  out.clear();
+  AppendChangeJson(&out, change);
+  EXPECT_EQ("{\"op\":\"ready\",\"deviceId\":\"a\",\"readyToShare\":true}",
+            out);
+  change.kind = DeviceChange::Kind::kRemove;
+  out.clear();
+  AppendChangeJson(&out, change);
+  EXPECT_EQ("{\"op\":\"remove\",\"deviceId\":\"a\"}", out);
+}
+
+TEST(DeviceRegistryTest, SnapshotsCarryTheirVersion) {
+  DeviceRegistry registry;
+  registry.Register(Device("a"));
+  registry.Register(Device("b"));
+  const auto snapshot = registry.SnapshotJson("");
+  EXPECT_EQ(snapshot, registry.SnapshotJson(""));
+  std::string_view value;
+  ASSERT_TRUE(json::FindMember(*snapshot, "version", &value));
+  EXPECT_EQ("2", value);
+  ASSERT_TRUE(json::FindMember(*snapshot, "devices", &value));
+  EXPECT_EQ(*registry.ListJson(""), value);
+
+  registry.Unregister("a");
+  ASSERT_TRUE(json::FindMember(*registry.SnapshotJson(""), "version", &value));
+  EXPECT_EQ("3", value);
+}
+
+TEST(DeviceRegistryTest, KeepsGroupsApart) {
+  DeviceRegistry registry;
+  registry.Register(Device("a", "", "home"));
+  registry.Register(Device("b", "", "work"));
+  registry.Register(Device("c", "", "home"));
+  registry.Register(Device("d"));
+  EXPECT_EQ(3u, registry.group_count());
+  const std::vector<DeviceInfo> home = registry.List("home");
+  ASSERT_EQ(2u, home.size());
+  EXPECT_EQ("a", home[0].id);
+  EXPECT_EQ("c", home[1].id);
+  ASSERT_EQ(1u, registry.List("").size());
+  EXPECT_EQ("d", registry.List("")[0].id);
+
+  registry.SetReady("b", true);
+  std::string sharer;
+  EXPECT_FALSE(registry.PickSharer("home", "a", "", &sharer));
+  ASSERT_TRUE(registry.PickSharer("work", "x", "", &sharer));
+  EXPECT_EQ("b", sharer);
+
+  // Changes to one group leave the others' lists and versions alone.
+  const auto work = registry.ListJson("work");
+  const uint64_t work_version = registry.Version("work");
+  DeviceChange change;
+  registry.SetReady("c", true, &change);
+  EXPECT_EQ("home", change.device.group);
+  EXPECT_EQ(registry.Version("home"), change.version);
+  EXPECT_EQ(work, registry.ListJson("work"));
+  EXPECT_EQ(work_version, registry.Version("work"));
+  EXPECT_EQ("[]", *registry.ListJson("nobody"));
+  EXPECT_EQ(0u, registry.Version("nobody"));
+}
+
+TEST(DeviceRegistryTest, RecreatedGroupsNumberPastTheirOldVersions) {
+  DeviceRegistry registry;
+  DeviceChange change;
+  registry.Register(Device("a", "", "home"), &change);
+  registry.SetReady("a", true, &change);
+  registry.Unregister("a", &change);
+  const uint64_t last = change.version;
+  EXPECT_EQ(0u, registry.Version("home"));
+  EXPECT_EQ(0u, registry.group_count());
+
+  registry.Register(Device("b", "", "home"), &change);
+  EXPECT_GT(change.version, last);
+  EXPECT_EQ(change.version, registry.Version("home"));
+}
+
+TEST(DeviceRegistryTest, HandlesConcurrentUpdates) {
+  DeviceRegistry registry;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&registry, t] {
+      for (int i = 0; i < 1000; i++) {
+        const std::string id = std::to_string(t) + "-" + std::to_string(i);
+        registry.Register(Device(id));
+        registry.SetReady(id, i % 2 == 0);
+        std::string sharer;
+        registry.PickSharer("", id, "", &sharer);
+        registry.ListJson("");
+        registry.SnapshotJson("");
+        if (i % 4 == 0) {
+          registry.Unregister(id);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(3000u, registry.size());
+  EXPECT_EQ(1000u, registry.ready_count());
+  EXPECT_EQ(3000u, registry.List("").size());
+  // Register, SetReady on even i, Unregister on every fourth.
+  EXPECT_EQ(4u * (1000 + 500 + 250), registry.version());
+}
+
+}  // namespace
+}  // namespace signaling
+}  // namespace sc
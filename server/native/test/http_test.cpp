@@ -0,0 +1,65 @@
+#include "http.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace sc {
+namespace signaling {
+namespace {
+
+TEST(HttpTest, ParsesRequestHeads) {
+  const std::string data =
+      "GET /socket.io/?EIO=4&transport=websocket HTTP/1.1\r\n"
+      "Host: localhost:3000\r\n"
+      "Upgrade: websocket\r\n"
+      "Connection: keep-alive, Upgrade\r\n"
+      "Sec-WebSocket-Key:   dGhlIHNhbXBsZSBub25jZQ==  \r\n"
+      "\r\n"
+      "leftover";
+  HttpRequest request;
+  ASSERT_EQ(static_cast<ptrdiff_t>(data.size() - 8),
+            ParseHttpRequest(data, &request));
+  EXPECT_EQ("GET", request.method);
+  EXPECT_EQ("/socket.io/", request.path);
+  EXPECT_EQ("EIO=4&transport=websocket", request.query);
+  EXPECT_EQ("websocket", request.Header("upgrade"));
+  EXPECT_EQ("dGhlIHNhbXBsZSBub25jZQ==", request.Header("sec-websocket-key"));
+  EXPECT_EQ("", request.Header("origin"));
+  EXPECT_TRUE(HeaderHasToken(request.Header("connection"), "upgrade"));
+  EXPECT_FALSE(HeaderHasToken(request.Header("connection"), "close"));
+  EXPECT_EQ("4", QueryParameter(request.query, "EIO"));
+  EXPECT_EQ("websocket", QueryParameter(request.query, "transport"));
+  EXPECT_EQ("", QueryParameter(request.query, "sid"));
+}
+
+TEST(HttpTest, WaitsForWholeHead) {
+  HttpRequest request;
+  EXPECT_EQ(0, ParseHttpRequest("GET /health HTTP/1.1\r\nHost: x\r\n",
+                                &request));
+  EXPECT_EQ(0, ParseHttpRequest("", &request));
+}
+
+TEST(HttpTest, RefusesMalformedHeads) {
+  HttpRequest request;
+  EXPECT_EQ(-1, ParseHttpRequest("GET\r\n\r\n", &request));
+  EXPECT_EQ(-1, ParseHttpRequest("GET /health HTTP/1.1\r\nNoColon\r\n\r\n",
+                                 &request));
+  EXPECT_EQ(-1, ParseHttpRequest(
+                    "GET /" + std::string(kMaxRequestHeadSize, 'a'), &request));
+}
+
+TEST(HttpTest, FormatsResponses) {
+  const std::string response = HttpResponse(200, "application/json", "{}");
+  EXPECT_EQ(0u, response.find("HTTP/1.1 200 OK\r\n"));
+  EXPECT_NE(std::string::npos,
+            response.find("Content-Type: application/json\r\n"));
+  EXPECT_NE(std::string::npos, response.find("Content-Length: 2\r\n"));
+  EXPECT_NE(std::string::npos,
+            response.find("Access-Control-Allow-Origin: *\r\n"));
+  EXPECT_EQ(response.size() - 6, response.find("\r\n\r\n{}"));
+}
+
+}  // namespace
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,92 @@
+#include "json.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sc {
+namespace signaling {
+namespace {
+
+TEST(JsonTest, ValidatesValues) {
+  EXPECT_TRUE(json::IsValid("{}"));
+  EXPECT_TRUE(json::IsValid(" [1, -2.5e3, true, false, null, \"x\"] "));
+  EXPECT_TRUE(json::IsValid("{\"a\":{\"b\":[{}]}}"));
+  EXPECT_FALSE(json::IsValid(""));
+  EXPECT_FALSE(json::IsValid("{"));
+  EXPECT_FALSE(json::IsValid("[1,]"));
+  EXPECT_FALSE(json::IsValid("{\"a\" 1}"));
+  EXPECT_FALSE(json::IsValid("\"unterminated"));
+  EXPECT_FALSE(json::IsValid("[1] 2"));
+  EXPECT_FALSE(json::IsValid("tru"));
+}
+
+TEST(JsonTest, LimitsNesting) {
+  const std::string shallow =
+      std::string(json::kMaxDepth, '[') + std::string(json::kMaxDepth, ']');
+  const std::string deep = std::string(json::kMaxDepth + 1, '[') +
+                           std::string(json::kMaxDepth + 1, ']');
+  EXPECT_TRUE(json::IsValid(shallow));
+  EXPECT_FALSE(json::IsValid(deep));
+}
+
+TEST(JsonTest, SplitsArrays) {
+  std::vector<std::string_view> elements;
+  ASSERT_TRUE(json::ArrayElements("[\"a\", {\"b\":[1,2]} ,3]", &elements));
+  ASSERT_EQ(3u, elements.size());
+  EXPECT_EQ("\"a\"", elements[0]);
+  EXPECT_EQ("{\"b\":[1,2]}", elements[1]);
+  EXPECT_EQ("3", elements[2]);
+  ASSERT_TRUE(json::ArrayElements("[]", &elements));
+  EXPECT_TRUE(elements.empty());
+  EXPECT_FALSE(json::ArrayElements("{}", &elements));
+}
+
+TEST(JsonTest, FindsMembers) {
+  const std::string_view object =
+      "{\"to\":\"abc\",\"signal\":{\"type\":\"offer\",\"to\":1}}";
+  std::string_view value;
+  ASSERT_TRUE(json::FindMember(object, "signal", &value));
+  EXPECT_EQ("{\"type\":\"offer\",\"to\":1}", value);
+  ASSERT_TRUE(json::FindMember(object, "to", &value));
+  EXPECT_EQ("\"abc\"", value);
+  EXPECT_FALSE(json::FindMember(object, "type", &value));
+  EXPECT_FALSE(json::FindMember("[1]", "to", &value));
+  // Keys with escapes compare by their decoded text.
+  ASSERT_TRUE(json::FindMember("{\"t\\u006f\":2}", "to", &value));
+  EXPECT_EQ("2", value);
+}
+
+TEST(JsonTest, DecodesStrings) {
+  std::string out;
+  ASSERT_TRUE(json::DecodeString("\"a\\\"b\\\\c\\n\\u00e9\"", &out));
+  EXPECT_EQ("a\"b\\c\n\xc3\xa9", out);
+  ASSERT_TRUE(json::DecodeString("\"\\ud83d\\ude00\"", &out));
+  EXPECT_EQ("\xf0\x9f\x98\x80", out);
+  // A lone surrogate decodes to U+FFFD, as JavaScript would show it.
+  ASSERT_TRUE(json::DecodeString("\"\\ud83d\"", &out));
+  EXPECT_EQ("\xef\xbf\xbd", out);
+  EXPECT_FALSE(json::DecodeString("abc", &out));
+}
+
+TEST(JsonTest, ReadsStringMembers) {
+  EXPECT_EQ("Laptop", json::StringMember("{\"deviceName\":\"Laptop\"}",
+                                         "deviceName"));
+  EXPECT_EQ("", json::StringMember("{\"deviceName\":3}", "deviceName"));
+  EXPECT_EQ("", json::StringMember("{}", "deviceName"));
+}
+
+TEST(JsonTest, AppendsEscapedStrings) {
+  std::string out;
+  json::AppendString(&out, "a\"b\\c\n\x01\xc3\xa9");
+  EXPECT_EQ("\"a\\\"b\\\\c\\n\\u0001\xc3\xa9\"", out);
+  std::string decoded;
+  ASSERT_TRUE(json::DecodeString(out, &decoded));
+  EXPECT_EQ("a\"b\\c\n\x01\xc3\xa9", decoded);
+}
+
+}  // namespace
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,70 @@
+#include "metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace sc {
+namespace signaling {
+namespace {
+
+TEST(MetricsTest, FormatsValues) {
+  EXPECT_EQ("0", FormatMetricValue(0));
+  EXPECT_EQ("42", FormatMetricValue(42));
+  EXPECT_EQ("-3", FormatMetricValue(-3));
+  EXPECT_EQ("0.25", FormatMetricValue(0.25));
+  EXPECT_EQ("1e-05", FormatMetricValue(0.00001));
+  EXPECT_EQ("+Inf", FormatMetricValue(1.0 / 0.0));
+}
+
+TEST(MetricsTest, CountsAndGauges) {
+  Counter counter;
+  counter.Add();
+  counter.Add(4);
+  EXPECT_EQ(5u, counter.value());
+  Gauge gauge;
+  gauge.Add(10);
+  gauge.Add(-3);
+  EXPECT_EQ(7, gauge.value());
+}
+
+TEST(MetricsTest, BucketsObservations) {
+  Histogram histogram{1, 10};
+  histogram.Observe(0.5);
+  histogram.Observe(1);
+  histogram.Observe(5);
+  histogram.Observe(50);
+  EXPECT_EQ(2u, histogram.bucket(0));
+  EXPECT_EQ(1u, histogram.bucket(1));
+  EXPECT_EQ(1u, histogram.bucket(2));
+  EXPECT_EQ(4u, histogram.count());
+  EXPECT_DOUBLE_EQ(56.5, histogram.sum());
+}
+
+TEST(MetricsTest, WritesSummedHistograms) {
+  Histogram a{0.5, 2};
+  Histogram b{0.5, 2};
+  a.Observe(0.25);
+  b.Observe(1);
+  b.Observe(3);
+  MetricsWriter writer;
+  writer.Begin("requests_total", "Requests.", "counter");
+  writer.Sample("requests_total", "path=\"/\"", 3);
+  writer.WriteHistogram("latency_seconds", "Latency.", {&a, &b});
+  EXPECT_EQ(
+      "# HELP requests_total Requests.\n"
+      "# TYPE requests_total counter\n"
+      "requests_total{path=\"/\"} 3\n"
+      "# HELP latency_seconds Latency.\n"
+      "# TYPE latency_seconds histogram\n"
+      "latency_seconds_bucket{le=\"0.5\"} 1\n"
+      "latency_seconds_bucket{le=\"2\"} 2\n"
+      "latency_seconds_bucket{le=\"+Inf\"} 3\n"
+      "latency_seconds_sum 4.25\n"
+      "latency_seconds_count 3\n",
+      writer.text());
+}
+
+}  // namespace
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,92 @@
+#include "sharer_index.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace sc {
+namespace signaling {
+namespace {
+
+std::string PickAndCount(SharerIndex* index, std::string_view exclude = "") {
+  std::string id;
+  if (!index->Pick(exclude, &id)) {
+    return "";
+  }
+  index->CountRequest(id);
+  return id;
+}
+
+TEST(SharerIndexTest, ParsesPolicies) {
+  SharerPolicy policy = SharerPolicy::kLeastLoaded;
+  ASSERT_TRUE(ParseSharerPolicy("recent", &policy));
+  EXPECT_EQ(SharerPolicy::kMostRecent, policy);
+  ASSERT_TRUE(ParseSharerPolicy("least-loaded", &policy));
+  EXPECT_EQ(SharerPolicy::kLeastLoaded, policy);
+  EXPECT_FALSE(ParseSharerPolicy("first", &policy));
+}
+
+TEST(SharerIndexTest, PicksMostRecentlyReady) {
+  SharerIndex index(SharerPolicy::kMostRecent);
+  std::string id;
+  EXPECT_FALSE(index.Pick("", &id));
+  index.MarkReady("a");
+  index.MarkReady("b");
+  index.MarkReady("c");
+  EXPECT_EQ(3u, index.size());
+  EXPECT_EQ("c", PickAndCount(&index));
+  // Requests do not move a device down.
+  EXPECT_EQ("c", PickAndCount(&index));
+  EXPECT_EQ("b", PickAndCount(&index, "c"));
+
+  // Saying ready again makes a device the most recent.
+  index.MarkReady("a");
+  EXPECT_EQ(3u, index.size());
+  EXPECT_EQ("a", PickAndCount(&index));
+  EXPECT_TRUE(index.Remove("a"));
+  EXPECT_FALSE(index.Remove("a"));
+  EXPECT_FALSE(index.Contains("a"));
+  EXPECT_EQ("c", PickAndCount(&index));
+}
+
+TEST(SharerIndexTest, SpreadsRequestsByLoad) {
+  SharerIndex index(SharerPolicy::kLeastLoaded);
+  index.MarkReady("a");
+  index.MarkReady("b");
+  index.MarkReady("c");
+  EXPECT_EQ("c", PickAndCount(&index));
+  EXPECT_EQ("b", PickAndCount(&index));
+  EXPECT_EQ("a", PickAndCount(&index));
+  // All at one request: the one asked longest ago goes first.
+  EXPECT_EQ("c", PickAndCount(&index));
+  EXPECT_EQ("b", PickAndCount(&index));
+
+  // A device that just became ready has no load.
+  index.MarkReady("d");
+  EXPECT_EQ("d", PickAndCount(&index));
+  EXPECT_EQ("a", PickAndCount(&index));
+  // The requester is never picked, even when it is the least loaded.
+  EXPECT_EQ("c", PickAndCount(&index, "d"));
+
+  // Leaving forgets the load.
+  EXPECT_TRUE(index.Remove("c"));
+  index.MarkReady("c");
+  EXPECT_EQ("c", PickAndCount(&index));
+  index.CountRequest("missing");
+  EXPECT_EQ(4u, index.size());
+}
+
+TEST(SharerIndexTest, SkipsOnlyTheExcludedDevice) {
+  SharerIndex index(SharerPolicy::kLeastLoaded);
+  index.MarkReady("a");
+  std::string id;
+  EXPECT_FALSE(index.Pick("a", &id));
+  index.MarkReady("b");
+  index.CountRequest("b");
+  ASSERT_TRUE(index.Pick("a", &id));
+  EXPECT_EQ("b", id);
+}
+
+}  // namespace
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,644 @@
+#include "signaling_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json.h"
+#include "socket_io.h"
+#include "websocket.h"
+
+namespace sc {
+namespace signaling {
+namespace {
+
+int ConnectTo(uint16_t port) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  timeval timeout = {5, 0};
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) !=
+      0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool SendAll(int fd, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    const ssize_t count =
+        ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (count <= 0) {
+      return false;
+    }
+    sent += static_cast<size_t>(count);
+  }
+  return true;
+}
+
+// Sends a plain HTTP request and returns the whole response.
+std::string HttpGet(uint16_t port, const std::string& target) {
+  const int fd = ConnectTo(port);
+  if (fd < 0) {
+    return {};
+  }
+  SendAll(fd, "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  std::string response;
+  char buffer[4096];
+  ssize_t count;
+  while ((count = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, static_cast<size_t>(count));
+  }
+  ::close(fd);
+  return response;
+}
+
+// Blocking Socket.IO client, enough to drive the server from a test.
+class TestClient {
+ public:
+  ~TestClient() { Close(); }
+
+  bool Connect(uint16_t port) {
+    fd_ = ConnectTo(port);
+    if (fd_ < 0 ||
+        !SendAll(fd_,
+                 "GET /socket.io/?EIO=4&transport=websocket HTTP/1.1\r\n"
+                 "Host: localhost\r\n"
+                 "Upgrade: websocket\r\n"
+                 "Connection: Upgrade\r\n"
+                 "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                 "Sec-WebSocket-Version: 13\r\n\r\n")) {
+      return false;
+    }
+    size_t end;
+    while ((end = in_.find("\r\n\r\n")) == std::string::npos) {
+      if (!Receive()) {
+        return false;
+      }
+    }
+    if (in_.compare(0, 12, "HTTP/1.1 101") != 0 ||
+        in_.find("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") > end) {
+      return false;
+    }
+    in_.erase(0, end + 4);
+    std::string message;
+    if (!Next(&message) || message[0] != '0') {
+      return false;
+    }
+    SendText("40");
+    if (!Next(&message) || message.compare(0, 2, "40") != 0) {
+      return false;
+    }
+    id_ = json::StringMember(message.substr(2), "sid");
+    return !id_.empty();
+  }
+
+  void Emit(const std::string& name, const std::string& arg = "") {
+    SendText(EncodeEventPacket(name, arg));
+  }
+
+  void SendText(const std::string& packet) {
+    std::string frame;
+    AppendWebSocketFrame(&frame, WebSocketOpcode::kText, packet, 0x5a5a5a5a);
+    SendAll(fd_, frame);
+  }
+
+  // Reads messages until event |name| arrives and returns its argument.
+  // The names of other events are kept in skipped().
+  bool WaitFor(const std::string& name, std::string* arg) {
+    std::string message;
+    while (Next(&message)) {
+      const std::string_view body = std::string_view(message).substr(1);
+      SocketIoPacket packet;
+      SocketIoEvent event;
+      if (message[0] == '4' && ParseSocketIoPacket(body, &packet) &&
+          packet.type == SocketPacket::kEvent &&
+          ParseSocketIoEvent(packet.data, &event) && event.name == name) {
+        *arg = std::string(event.arg);
+        return true;
+      }
+      if (!event.name.empty()) {
+        skipped_.push_back(event.name);
+      }
+    }
+    return false;
+  }
+
+  // Next Engine.IO message, answering pings on the way.
+  bool Next(std::string* message) {
+    for (;;) {
+      WebSocketFrame frame;
+      const ptrdiff_t length =
+          ParseWebSocketFrame(&in_[0], in_.size(), false, 1 << 24, &frame);
+      if (length < 0) {
+        return false;
+      }
+      if (length > 0) {
+        const bool text = frame.opcode == WebSocketOpcode::kText;
+        *message = std::string(frame.payload);
+        in_.erase(0, static_cast<size_t>(length));
+        if (!text || message->empty()) {
+          continue;
+        }
+        if (*message == "2") {
+          SendText("3");
+          continue;
+        }
+        return true;
+      }
+      if (!Receive()) {
+        return false;
+      }
+    }
+  }
+
+  void Close() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  const std::string& id() const { return id_; }
+  std::vector<std::string>& skipped() { return skipped_; }
+
+ private:
+  bool Receive() {
+    char buffer[16384];
+    const ssize_t count = ::recv(fd_, buffer, sizeof(buffer), 0);
+    if (count <= 0) {
+      return false;
+    }
+    in_.append(buffer, static_cast<size_t>(count));
+    return true;
+  }
+
+  int fd_ = -1;
+  std::string in_;
+  std::string id_;
+  std::vector<std::string> skipped_;
+};
+
+// Device list kept up to date from device-snapshot and device-delta, as the
+// app keeps it.
+struct DeviceList {
+  uint64_t version = 0;
+  std::vector<std::string> ids;
+  std::vector<std::string> ops;  // applied so far, e.g. "add:<id>"
+
+  void Reset(const std::string& snapshot) {
+    std::string_view value;
+    ASSERT_TRUE(json::FindMember(snapshot, "version", &value));
+    version = std::stoull(std::string(value));
+    ASSERT_TRUE(json::FindMember(snapshot, "devices", &value));
+    std::vector<std::string_view> devices;
+    ASSERT_TRUE(json::ArrayElements(value, &devices));
+    ids.clear();
+    for (std::string_view device : devices) {
+      ids.push_back(json::StringMember(device, "id"));
+    }
+  }
+
+  // Applies a device-delta, which must continue from |version|.
+  void Apply(const std::string& delta) {
+    std::string_view value;
+    ASSERT_TRUE(json::FindMember(delta, "from", &value));
+    const uint64_t from = std::stoull(std::string(value));
+    ASSERT_TRUE(json::FindMember(delta, "to", &value));
+    const uint64_t to = std::stoull(std::string(value));
+    ASSERT_TRUE(json::FindMember(delta, "changes", &value));
+    std::vector<std::string_view> changes;
+    ASSERT_TRUE(json::ArrayElements(value, &changes));
+    ASSERT_EQ(to - from + 1, changes.size());
+    ASSERT_LE(from, version + 1) << "gap in device versions";
+    for (size_t i = 0; i < changes.size(); i++) {
+      if (from + i <= version) {
+        continue;  // already in the snapshot
+      }
+      const std::string op = json::StringMember(changes[i], "op");
+      std::string id = json::StringMember(changes[i], "deviceId");
+      std::string_view device;
+      if (json::FindMember(changes[i], "device", &device)) {
+        id = json::StringMember(device, "id");
+      }
+      if (op == "add") {
+        ids.push_back(id);
+      } else if (op == "remove") {
+        ids.erase(std::find(ids.begin(), ids.end(), id));
+      }
+      ops.push_back(op + ":" + id);
+    }
+    version = to;
+  }
+};
+
+class SignalingServerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ServerOptions options;
+    options.host = "127.0.0.1";
+    options.port = 0;
+    options.shards = 2;
+    server_ = std::make_unique<SignalingServer>(options);
+    ASSERT_TRUE(server_->Start());
+  }
+
+  void TearDown() override { server_->Stop(); }
+
+  // Connects and registers a device named |name| in |group|, and reads the
+  // device list sent back.
+  std::unique_ptr<TestClient> Join(const std::string& name,
+                                   const std::string& group = "") {
+    auto client = std::make_unique<TestClient>();
+    if (!client->Connect(server_->port())) {
+      ADD_FAILURE() << "cannot connect";
+      return client;
+    }
+    std::string arg = "{\"deviceName\":";
+    json::AppendString(&arg, name);
+    arg += ",\"platform\":\"windows\",\"group\":";
+    json::AppendString(&arg, group);
+    arg += '}';
+    client->Emit("register", arg);
+    std::string devices;
+    EXPECT_TRUE(client->WaitFor("devices", &devices));
+    return client;
+  }
+
+  // Connects and registers a device that takes device-list deltas, and
+  // reads the snapshot sent back into |list|.
+  std::unique_ptr<TestClient> JoinWithDeltas(const std::string& name,
+                                             DeviceList* list,
+                                             const std::string& group = "") {
+    auto client = std::make_unique<TestClient>();
+    if (!client->Connect(server_->port())) {
+      ADD_FAILURE() << "cannot connect";
+      return client;
+    }
+    std::string arg = "{\"deviceName\":";
+    json::AppendString(&arg, name);
+    arg += ",\"platform\":\"windows\",\"deltas\":true,\"group\":";
+    json::AppendString(&arg, group);
+    arg += '}';
+    client->Emit("register", arg);
+    std::string snapshot;
+    EXPECT_TRUE(client->WaitFor("device-snapshot", &snapshot));
+    list->Reset(snapshot);
+    return client;
+  }
+
+  std::unique_ptr<SignalingServer> server_;
+};
+
+TEST_F(SignalingServerTest, ServesHealth) {
+  const std::string response = HttpGet(server_->port(), "/health");
+  ASSERT_EQ(0u, response.find("HTTP/1.1 200 OK\r\n"));
+  const std::string body = response.substr(response.find("\r\n\r\n") + 4);
+  EXPECT_TRUE(json::IsValid(body));
+  EXPECT_EQ("OK", json::StringMember(body, "status"));
+  std::string_view devices;
+  ASSERT_TRUE(json::FindMember(body, "connectedDevices", &devices));
+  EXPECT_EQ("0", devices);
+
+  EXPECT_EQ(0u, HttpGet(server_->port(), "/missing").find("HTTP/1.1 404"));
+  EXPECT_EQ(0u, HttpGet(server_->port(),
+                        "/socket.io/?EIO=4&transport=polling")
+                    .find("HTTP/1.1 400"));
+}
+
+TEST_F(SignalingServerTest, ServesMetrics) {
+  auto a = Join("Laptop");
+  auto b = Join("Phone");
+  // The signal arriving shows that the event sent before it was handled.
+  a->Emit("no-such-event");
+  std::string arg = "{\"to\":";
+  json::AppendString(&arg, b->id());
+  arg += ",\"signal\":{\"type\":\"offer\"}}";
+  a->Emit("webrtc-signal", arg);
+  std::string received;
+  ASSERT_TRUE(b->WaitFor("webrtc-signal", &received));
+
+  const std::string response = HttpGet(server_->port(), "/metrics");
+  ASSERT_EQ(0u, response.find("HTTP/1.1 200 OK\r\n"));
+  EXPECT_NE(std::string::npos, response.find("Content-Type: text/plain"));
+  const std::string body = response.substr(response.find("\r\n\r\n") + 4);
+  for (const char* line : {
+           "# TYPE signaling_events_total counter\n",
+           "signaling_events_total{event=\"connection\"} 2\n",
+           "signaling_events_total{event=\"register\"} 2\n",
+           "signaling_events_total{event=\"webrtc-signal\"} 1\n",
+           "signaling_events_total{event=\"other\"} 1\n",
+           "signaling_connected_devices 2\n",
+           "signaling_groups 1\n",
+           "signaling_webrtc_signal_forward_seconds_count 1\n",
+           "signaling_webrtc_signal_forward_seconds_bucket{le=\"+Inf\"} 1\n",
+           "# TYPE signaling_event_loop_lag_seconds histogram\n",
+       }) {
+    EXPECT_NE(std::string::npos, body.find(line)) << line;
+  }
+}
+
+TEST_F(SignalingServerTest, ListsAndAnnouncesDevices) {
+  auto a = Join("Laptop");
+  auto b = std::make_unique<TestClient>();
+  ASSERT_TRUE(b->Connect(server_->port()));
+  b->Emit("register", "{\"deviceName\":\"Phone\",\"platform\":\"android\"}");
+
+  std::string arg;
+  ASSERT_TRUE(a->WaitFor("device-connected", &arg));
+  EXPECT_EQ(b->id(), json::StringMember(arg, "deviceId"));
+  EXPECT_EQ("Phone", json::StringMember(arg, "name"));
+
+  ASSERT_TRUE(b->WaitFor("devices", &arg));
+  std::vector<std::string_view> devices;
+  ASSERT_TRUE(json::ArrayElements(arg, &devices));
+  ASSERT_EQ(2u, devices.size());
+  EXPECT_EQ(a->id(), json::StringMember(devices[0], "id"));
+  EXPECT_EQ("Laptop", json::StringMember(devices[0], "name"));
+  EXPECT_EQ(b->id(), json::StringMember(devices[1], "id"));
+
+  // Any of the list aliases gets one 'devices' reply.
+  a->Emit("get-devices");
+  ASSERT_TRUE(a->WaitFor("devices", &arg));
+  ASSERT_TRUE(json::ArrayElements(arg, &devices));
+  EXPECT_EQ(2u, devices.size());
+  EXPECT_EQ(2u, server_->registry().size());
+}
+
+TEST_F(SignalingServerTest, RoutesSignalsBetweenEveryPair) {
+  // Enough clients that both shards hold some.
+  std::vector<std::unique_ptr<TestClient>> clients;
+  for (int i = 0; i < 6; i++) {
+    clients.push_back(Join("Device " + std::to_string(i)));
+  }
+  for (auto& from : clients) {
+    for (auto& to : clients) {
+      if (from == to) {
+        continue;
+      }
+      std::string arg = "{\"to\":";
+      json::AppendString(&arg, to->id());
+      arg += ",\"signal\":{\"type\":\"offer\",\"sdp\":\"v=0\"}}";
+      from->Emit("webrtc-signal", arg);
+      std::string received;
+      ASSERT_TRUE(to->WaitFor("webrtc-signal", &received));
+      EXPECT_EQ(from->id(), json::StringMember(received, "from"));
+      std::string_view signal;
+      ASSERT_TRUE(json::FindMember(received, "signal", &signal));
+      EXPECT_EQ("{\"type\":\"offer\",\"sdp\":\"v=0\"}", signal);
+    }
+  }
+}
+
+TEST_F(SignalingServerTest, RoutesSignalBatches) {
+  auto a = Join("Laptop");
+  auto b = Join("Phone");
+  auto c = Join("Tablet");
+  std::string batch = "[";
+  for (const auto* to : {b.get(), c.get(), b.get()}) {
+    if (batch.size() > 1) {
+      batch += ',';
+    }
+    batch += "{\"to\":";
+    json::AppendString(&batch, to->id());
+    batch += ",\"signal\":{\"type\":\"candidates\",\"n\":";
+    batch += std::to_string(batch.size());
+    batch += "}}";
+  }
+  batch += ']';
+  a->Emit("webrtc-signal", batch);
+
+  std::string received;
+  ASSERT_TRUE(b->WaitFor("webrtc-signal", &received));
+  EXPECT_EQ(a->id(), json::StringMember(received, "from"));
+  std::string_view signal;
+  ASSERT_TRUE(json::FindMember(received, "signal", &signal));
+  const std::string first(signal);
+  ASSERT_TRUE(b->WaitFor("webrtc-signal", &received));
+  ASSERT_TRUE(json::FindMember(received, "signal", &signal));
+  EXPECT_NE(first, signal);
+  ASSERT_TRUE(c->WaitFor("webrtc-signal", &received));
+  EXPECT_EQ(a->id(), json::StringMember(received, "from"));
+}
+
+TEST_F(SignalingServerTest, SendsShareRequestToChosenSharer) {
+  auto a = Join("A");
+  auto b = Join("B");
+  auto c = Join("C");
+  std::string arg;
+  a->Emit("request-share");
+  ASSERT_TRUE(a->WaitFor("no-sharer-available", &arg));
+  EXPECT_FALSE(json::StringMember(arg, "message").empty());
+
+  c->Emit("share-ready");
+  ASSERT_TRUE(a->WaitFor("share-available", &arg));
+  EXPECT_EQ(c->id(), json::StringMember(arg, "deviceId"));
+  b->Emit("share-ready");
+  ASSERT_TRUE(a->WaitFor("share-available", &arg));
+  EXPECT_EQ(b->id(), json::StringMember(arg, "deviceId"));
+
+  // B said it was ready after C, so it is asked first.
+  a->Emit("request-share");
+  ASSERT_TRUE(b->WaitFor("share-request", &arg));
+  EXPECT_EQ(a->id(), json::StringMember(arg, "from"));
+
+  // A device is never asked to share with itself.
+  b->Emit("request-share");
+  ASSERT_TRUE(c->WaitFor("share-request", &arg));
+  EXPECT_EQ(b->id(), json::StringMember(arg, "from"));
+
+  // The requester may name the device to ask.
+  std::string request = "{\"deviceId\":";
+  json::AppendString(&request, c->id());
+  request += '}';
+  a->Emit("request-share", request);
+  ASSERT_TRUE(c->WaitFor("share-request", &arg));
+  EXPECT_EQ(a->id(), json::StringMember(arg, "from"));
+  EXPECT_TRUE(json::StringMember(arg, "traceId").empty());
+
+  // Its trace id goes on to the sharer.
+  a->Emit("request-share", "{\"traceId\":\"00c0ffee00c0ffee\"}");
+  ASSERT_TRUE(b->WaitFor("share-request", &arg));
+  EXPECT_EQ(a->id(), json::StringMember(arg, "from"));
+  EXPECT_EQ("00c0ffee00c0ffee", json::StringMember(arg, "traceId"));
+}
+
+TEST_F(SignalingServerTest, AnnouncesDisconnects) {
+  auto a = Join("A");
+  auto b = Join("B");
+  const std::string b_id = b->id();
+  std::string arg;
+  ASSERT_TRUE(a->WaitFor("device-connected", &arg));
+  b->Close();
+  ASSERT_TRUE(a->WaitFor("device-disconnected", &arg));
+  EXPECT_EQ(b_id, json::StringMember(arg, "deviceId"));
+  EXPECT_EQ(1u, server_->registry().size());
+}
+
+TEST_F(SignalingServerTest, SendsSnapshotThenDeltas) {
+  auto a = Join("A");
+  DeviceList list;
+  auto b = JoinWithDeltas("B", &list);
+  ASSERT_EQ(2u, list.ids.size());
+  EXPECT_EQ(a->id(), list.ids[0]);
+  EXPECT_EQ(b->id(), list.ids[1]);
+
+  auto c = Join("C");
+  c->Emit("share-ready");
+  std::string delta;
+  while (list.ops.size() < 2) {
+    ASSERT_TRUE(b->WaitFor("device-delta", &delta));
+    list.Apply(delta);
+  }
+  // Only now, as A and C may be on different shards.
+  a->Close();
+  while (list.ids.size() != 2) {
+    ASSERT_TRUE(b->WaitFor("device-delta", &delta));
+    list.Apply(delta);
+  }
+  EXPECT_EQ((std::vector<std::string>{"add:" + c->id(), "ready:" + c->id(),
+                                      "remove:" + a->id()}),
+            list.ops);
+  EXPECT_EQ(b->id(), list.ids[0]);
+  EXPECT_EQ(c->id(), list.ids[1]);
+  // The legacy events and lists went to the other clients only.
+  for (const std::string& name : b->skipped()) {
+    EXPECT_NE("device-connected", name);
+    EXPECT_NE("device-disconnected", name);
+    EXPECT_NE("share-available", name);
+    EXPECT_NE("devices", name);
+  }
+  std::string arg;
+  ASSERT_TRUE(c->WaitFor("device-disconnected", &arg));
+  for (const std::string& name : c->skipped()) {
+    EXPECT_NE("device-delta", name);
+  }
+
+  b->Emit("sync-devices");
+  ASSERT_TRUE(b->WaitFor("device-snapshot", &arg));
+  DeviceList resynced;
+  resynced.Reset(arg);
+  EXPECT_EQ(list.version, resynced.version);
+  EXPECT_EQ(list.ids, resynced.ids);
+}
+
+TEST_F(SignalingServerTest, KeepsDeltasInOrderAcrossShards) {
+  DeviceList list;
+  auto watcher = JoinWithDeltas("Watcher", &list);
+  // Connect first, then register all at once, so both shards change the
+  // registry at the same time.
+  std::vector<std::unique_ptr<TestClient>> clients;
+  for (int i = 0; i < 16; i++) {
+    clients.push_back(std::make_unique<TestClient>());
+    ASSERT_TRUE(clients.back()->Connect(server_->port()));
+  }
+  for (auto& client : clients) {
+    client->Emit("register", "{\"deviceName\":\"D\",\"deltas\":true}");
+    client->Emit("share-ready");
+  }
+  std::string delta;
+  while (list.ids.size() < 17 || list.ops.size() < 32) {
+    ASSERT_TRUE(watcher->WaitFor("device-delta", &delta));
+    list.Apply(delta);
+  }
+  EXPECT_EQ(server_->registry().Version(""), list.version);
+}
+
+TEST_F(SignalingServerTest, ScopesDevicesToTheirGroup) {
+  auto home = Join("Home", "home");
+  DeviceList list;
+  auto work = JoinWithDeltas("Work", &list, "work");
+  EXPECT_EQ(std::vector<std::string>{work->id()}, list.ids);
+  auto phone = Join("Phone", "home");
+  std::string arg;
+  ASSERT_TRUE(home->WaitFor("device-connected", &arg));
+  EXPECT_EQ(phone->id(), json::StringMember(arg, "deviceId"));
+
+  // A ready device in another group is never offered.
+  work->Emit("share-ready");
+  ASSERT_TRUE(work->WaitFor("device-delta", &arg));
+  list.Apply(arg);
+  home->Emit("request-share");
+  ASSERT_TRUE(home->WaitFor("no-sharer-available", &arg));
+  phone->Emit("share-ready");
+  ASSERT_TRUE(home->WaitFor("share-available", &arg));
+  EXPECT_EQ(phone->id(), json::StringMember(arg, "deviceId"));
+  home->Emit("request-share");
+  ASSERT_TRUE(phone->WaitFor("share-request", &arg));
+  EXPECT_EQ(home->id(), json::StringMember(arg, "from"));
+  home->Emit("get-devices");
+  ASSERT_TRUE(home->WaitFor("devices", &arg));
+  std::vector<std::string_view> devices;
+  ASSERT_TRUE(json::ArrayElements(arg, &devices));
+  EXPECT_EQ(2u, devices.size());
+  EXPECT_EQ(std::vector<std::string>{"ready:" + work->id()}, list.ops);
+  for (const std::string& name : home->skipped()) {
+    EXPECT_NE("device-connected", name);
+  }
+
+  // Registering again under another group moves the device.
+  work->Emit("register",
+             "{\"deviceName\":\"Work\",\"deltas\":true,"
+             "\"group\":\"home\"}");
+  ASSERT_TRUE(home->WaitFor("device-connected", &arg));
+  EXPECT_EQ(work->id(), json::StringMember(arg, "deviceId"));
+  ASSERT_TRUE(work->WaitFor("device-snapshot", &arg));
+  list.Reset(arg);
+  EXPECT_EQ(3u, list.ids.size());
+  EXPECT_EQ(0u, server_->registry().Version("work"));
+  EXPECT_EQ(1u, server_->registry().group_count());
+}
+
+TEST_F(SignalingServerTest, DropsSignalsAcrossGroups) {
+  auto home = Join("Home", "home");
+  auto phone = Join("Phone", "home");
+  auto work = Join("Work", "work");
+  auto desk = Join("Desk", "work");
+  const auto signal_to = [](const TestClient& to) {
+    std::string arg = "{\"to\":";
+    json::AppendString(&arg, to.id());
+    arg += ",\"signal\":{\"type\":\"offer\"}}";
+    return arg;
+  };
+  // The signal within the group shows the one before it was handled.
+  work->Emit("webrtc-signal", signal_to(*home));
+  work->Emit("webrtc-signal", signal_to(*desk));
+  std::string received;
+  ASSERT_TRUE(desk->WaitFor("webrtc-signal", &received));
+  EXPECT_EQ(work->id(), json::StringMember(received, "from"));
+  phone->Emit("webrtc-signal", signal_to(*home));
+  ASSERT_TRUE(home->WaitFor("webrtc-signal", &received));
+  EXPECT_EQ(phone->id(), json::StringMember(received, "from"));
+
+  const std::string response = HttpGet(server_->port(), "/metrics");
+  EXPECT_NE(std::string::npos,
+            response.find("signaling_webrtc_signals_dropped_total 1\n"));
+}
+
+TEST_F(SignalingServerTest, AnswersEnginePings) {
+  TestClient client;
+  ASSERT_TRUE(client.Connect(server_->port()));
+  client.SendText("2");
+  std::string message;
+  ASSERT_TRUE(client.Next(&message));
+  EXPECT_EQ("3", message);
+}
+
+}  // namespace
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,68 @@
+#include "socket_io.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "json.h"
+
+namespace sc {
+namespace signaling {
+namespace {
+
+TEST(SocketIoTest, ParsesEventPackets) {
+  SocketIoPacket packet;
+  ASSERT_TRUE(ParseSocketIoPacket("2[\"register\",{\"deviceName\":\"A\"}]",
+                                  &packet));
+  EXPECT_EQ(SocketPacket::kEvent, packet.type);
+  EXPECT_EQ("/", packet.nsp);
+  EXPECT_EQ(-1, packet.ack_id);
+  SocketIoEvent event;
+  ASSERT_TRUE(ParseSocketIoEvent(packet.data, &event));
+  EXPECT_EQ("register", event.name);
+  EXPECT_EQ("{\"deviceName\":\"A\"}", event.arg);
+
+  ASSERT_TRUE(ParseSocketIoEvent("[\"share-ready\"]", &event));
+  EXPECT_EQ("share-ready", event.name);
+  EXPECT_TRUE(event.arg.empty());
+  EXPECT_FALSE(ParseSocketIoEvent("[]", &event));
+  EXPECT_FALSE(ParseSocketIoEvent("[1]", &event));
+  EXPECT_FALSE(ParseSocketIoEvent("{\"a\":1}", &event));
+}
+
+TEST(SocketIoTest, ParsesNamespacesAndAcks) {
+  SocketIoPacket packet;
+  ASSERT_TRUE(ParseSocketIoPacket("0", &packet));
+  EXPECT_EQ(SocketPacket::kConnect, packet.type);
+  EXPECT_TRUE(packet.data.empty());
+  ASSERT_TRUE(ParseSocketIoPacket("2/admin,12[\"x\"]", &packet));
+  EXPECT_EQ("/admin", packet.nsp);
+  EXPECT_EQ(12, packet.ack_id);
+  EXPECT_EQ("[\"x\"]", packet.data);
+  EXPECT_FALSE(ParseSocketIoPacket("21234567890[\"x\"]", &packet));
+}
+
+TEST(SocketIoTest, RefusesBinaryAndUnknownPackets) {
+  SocketIoPacket packet;
+  EXPECT_FALSE(ParseSocketIoPacket("51-[\"x\",{\"_placeholder\":true}]",
+                                   &packet));
+  EXPECT_FALSE(ParseSocketIoPacket("9", &packet));
+  EXPECT_FALSE(ParseSocketIoPacket("", &packet));
+}
+
+TEST(SocketIoTest, EncodesPackets) {
+  EXPECT_EQ("40{\"sid\":\"abc\"}", EncodeConnectPacket("abc"));
+  EXPECT_EQ("42[\"devices\",[]]", EncodeEventPacket("devices", "[]"));
+  EXPECT_EQ("42[\"ping\"]", EncodeEventPacket("ping", ""));
+  const std::string open = EncodeOpenPacket("abc", 25000, 20000, 1000000);
+  ASSERT_EQ('0', open[0]);
+  EXPECT_TRUE(json::IsValid(open.substr(1)));
+  EXPECT_EQ("abc", json::StringMember(open.substr(1), "sid"));
+  std::string_view interval;
+  ASSERT_TRUE(json::FindMember(open.substr(1), "pingInterval", &interval));
+  EXPECT_EQ("25000", interval);
+}
+
+}  // namespace
+}  // namespace signaling
+}  // namespace sc
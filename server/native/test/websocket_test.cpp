@@ -0,0 +1,89 @@
+#include "websocket.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace sc {
+namespace signaling {
+namespace {
+
+TEST(WebSocketTest, ComputesAcceptKey) {
+  // RFC 6455, section 1.3.
+  EXPECT_EQ("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=",
+            WebSocketAccept("dGhlIHNhbXBsZSBub25jZQ=="));
+}
+
+TEST(WebSocketTest, RoundTripsMaskedFrames) {
+  for (size_t size : {0u, 5u, 125u, 126u, 65535u, 65536u, 200000u}) {
+    std::string payload(size, 'x');
+    for (size_t i = 0; i < size; i++) {
+      payload[i] = static_cast<char>(i * 31);
+    }
+    std::string wire;
+    AppendWebSocketFrame(&wire, WebSocketOpcode::kText, payload, 0x12345678);
+    if (size > 0) {
+      EXPECT_NE(payload, wire.substr(wire.size() - size));
+    }
+
+    WebSocketFrame frame;
+    ASSERT_EQ(static_cast<ptrdiff_t>(wire.size()),
+              ParseWebSocketFrame(&wire[0], wire.size(), true, 1 << 20,
+                                  &frame))
+        << size;
+    EXPECT_TRUE(frame.fin);
+    EXPECT_EQ(WebSocketOpcode::kText, frame.opcode);
+    EXPECT_EQ(payload, frame.payload);
+  }
+}
+
+TEST(WebSocketTest, ParsesUnmaskedServerFrames) {
+  std::string wire;
+  AppendWebSocketFrame(&wire, WebSocketOpcode::kPing, "hi");
+  EXPECT_EQ(std::string("\x89\x02hi", 4), wire);
+  WebSocketFrame frame;
+  ASSERT_EQ(4, ParseWebSocketFrame(&wire[0], wire.size(), false, 100, &frame));
+  EXPECT_EQ(WebSocketOpcode::kPing, frame.opcode);
+  EXPECT_EQ("hi", frame.payload);
+}
+
+TEST(WebSocketTest, WaitsForWholeFrames) {
+  std::string wire;
+  AppendWebSocketFrame(&wire, WebSocketOpcode::kText, std::string(300, 'a'),
+                       7);
+  WebSocketFrame frame;
+  for (size_t size = 0; size < wire.size(); size++) {
+    std::string partial = wire.substr(0, size);
+    EXPECT_EQ(0, ParseWebSocketFrame(&partial[0], size, true, 1000, &frame))
+        << size;
+  }
+}
+
+TEST(WebSocketTest, RefusesBadFrames) {
+  WebSocketFrame frame;
+  std::string masked;
+  AppendWebSocketFrame(&masked, WebSocketOpcode::kText, "abc", 7);
+  std::string copy = masked;
+  // Masking must match the direction.
+  EXPECT_EQ(-1, ParseWebSocketFrame(&copy[0], copy.size(), false, 100, &frame));
+  std::string unmasked;
+  AppendWebSocketFrame(&unmasked, WebSocketOpcode::kText, "abc");
+  EXPECT_EQ(-1, ParseWebSocketFrame(&unmasked[0], unmasked.size(), true, 100,
+                                    &frame));
+  // Too large.
+  copy = masked;
+  EXPECT_EQ(-1, ParseWebSocketFrame(&copy[0], copy.size(), true, 2, &frame));
+  // Reserved bits set.
+  copy = masked;
+  copy[0] = static_cast<char>(copy[0] | 0x40);
+  EXPECT_EQ(-1, ParseWebSocketFrame(&copy[0], copy.size(), true, 100, &frame));
+  // Fragmented control frame.
+  std::string ping;
+  AppendWebSocketFrame(&ping, WebSocketOpcode::kPing, "", 7);
+  ping[0] = static_cast<char>(ping[0] & 0x7f);
+  EXPECT_EQ(-1, ParseWebSocketFrame(&ping[0], ping.size(), true, 100, &frame));
+}
+
+}  // namespace
+}  // namespace signaling
+}  // namespace sc
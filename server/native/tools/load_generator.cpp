@@ -0,0 +1,792 @@
+// Load generator for the signaling server.
+//
+// Opens --devices WebSocket connections and registers each one the way the
+// app does, then marks --ready-fraction of them ready to share. For
+// --duration seconds it then sends webrtc-signal messages between random
+// pairs and request-share from random devices, at the given rates. It
+// reports connection setup time, signal and share-request latency
+// percentiles, and what the server sent back. It works against server.js
+// as well as the native server.
+//
+// With --group-size N, devices register in groups of N consecutive devices,
+// as the devices of one user or team would, and signal only within their
+// group.
+//
+//   sc_signaling_loadgen --port 3000 --devices 10000 --threads 4
+//       --signal-rate 5000 --share-rate 100 --duration 30
+//
+// One source address can open about 28k connections to a server port;
+// --source-addresses N spreads them over 127.0.0.1 to 127.0.0.N when the
+// server is on the loopback interface. Each connection needs a descriptor,
+// so raise `ulimit -n` to match.
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "encoding.h"
+#include "event_loop.h"
+#include "json.h"
+#include "socket_io.h"
+#include "websocket.h"
+
+namespace sc {
+namespace signaling {
+namespace {
+
+constexpr int kTickMs = 10;
+// Connections a worker has in setup at once, so the server's accept queue
+// is not flooded.
+constexpr size_t kMaxPendingPerWorker = 256;
+constexpr size_t kMaxFrame = 64 * 1024 * 1024;
+
+struct Options {
+  std::string host = "127.0.0.1";
+  uint16_t port = 3000;
+  size_t devices = 1000;
+  size_t threads = 0;
+  double ramp = 2000;  // connections per second
+  double ready_fraction = 0.1;
+  double signal_rate = 1000;  // per second, all workers together
+  double share_rate = 10;
+  double duration = 10;  // seconds of load after every device joined
+  size_t source_addresses = 1;
+  // Register for device-list deltas, as the app does, rather than full
+  // lists and per-device announcements.
+  bool deltas = true;
+  size_t group_size = 0;  // 0 puts every device in one group
+};
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+class Worker;
+
+struct Client : EventLoop::Handler {
+  enum class State { kConnecting, kUpgrading, kOpening, kJoining, kReady,
+                     kClosed };
+
+  Worker* worker = nullptr;
+  size_t index = 0;
+  int fd = -1;
+  State state = State::kConnecting;
+  std::string id;
+  bool ready_to_share = false;
+  std::string in;
+  std::string out;
+  size_t out_offset = 0;
+  bool watching_writable = false;
+  int64_t started_ns = 0;
+  // Set by the requesting worker, read by the sharer's.
+  std::atomic<int64_t> share_requested_ns{0};
+
+  void OnReady(uint32_t events) override;
+};
+
+// Devices that finished joining, readable by every worker once published.
+struct Directory {
+  std::vector<Client*> clients;
+  std::vector<Client*> by_index;  // null for devices that failed to join
+  std::unordered_map<std::string, Client*> by_id;
+};
+
+struct Stats {
+  std::vector<int64_t> connect_ns;
+  std::vector<int64_t> signal_ns;
+  std::vector<int64_t> share_ns;
+  uint64_t signals_sent = 0;
+  uint64_t shares_sent = 0;
+  uint64_t no_sharer = 0;
+  uint64_t events_received = 0;
+  uint64_t bytes_received = 0;
+  uint64_t failures = 0;
+
+  void Merge(const Stats& other) {
+    connect_ns.insert(connect_ns.end(), other.connect_ns.begin(),
+                      other.connect_ns.end());
+    signal_ns.insert(signal_ns.end(), other.signal_ns.begin(),
+                     other.signal_ns.end());
+    share_ns.insert(share_ns.end(), other.share_ns.begin(),
+                    other.share_ns.end());
+    signals_sent += other.signals_sent;
+    shares_sent += other.shares_sent;
+    no_sharer += other.no_sharer;
+    events_received += other.events_received;
+    bytes_received += other.bytes_received;
+    failures += other.failures;
+  }
+};
+
+struct Shared {
+  Options options;
+  sockaddr_storage server_address = {};
+  socklen_t server_address_size = 0;
+  std::mutex mutex;
+  std::vector<Client*> joined;  // guarded by |mutex|
+  std::atomic<size_t> joined_count{0};
+  std::atomic<size_t> failed_count{0};
+  std::atomic<const Directory*> directory{nullptr};
+  std::atomic<bool> load_running{false};
+  std::atomic<uint64_t> events_received{0};
+};
+
+class Worker {
+ public:
+  Worker(Shared* shared, size_t index, size_t first, size_t count)
+      : shared_(shared),
+        index_(index),
+        next_client_(first),
+        end_client_(first + count),
+        random_(static_cast<uint32_t>(index * 7919 + 17)) {}
+
+  bool Init() {
+    if (!loop_.Init()) {
+      return false;
+    }
+    last_tick_ns_ = NowNs();
+    loop_.SetTicker(kTickMs, [this] { Tick(); });
+    return true;
+  }
+
+  void Run() { loop_.Run(); }
+  void Stop() { loop_.Stop(); }
+  const Stats& stats() const { return stats_; }
+
+  void OnClientReady(Client* client, uint32_t events) {
+    if (client->state == Client::State::kClosed) {
+      return;
+    }
+    if (events & (EPOLLERR | EPOLLHUP)) {
+      Fail(client);
+      return;
+    }
+    if (client->state == Client::State::kConnecting && (events & EPOLLOUT)) {
+      int error = 0;
+      socklen_t size = sizeof(error);
+      ::getsockopt(client->fd, SOL_SOCKET, SO_ERROR, &error, &size);
+      if (error != 0) {
+        Fail(client);
+        return;
+      }
+      client->state = Client::State::kUpgrading;
+      SendUpgrade(client);
+    } else if (events & EPOLLOUT) {
+      Flush(client);
+    }
+    if ((events & EPOLLIN) && client->state != Client::State::kClosed) {
+      Read(client);
+    }
+  }
+
+ private:
+  void Tick() {
+    const int64_t now = NowNs();
+    const double elapsed = static_cast<double>(now - last_tick_ns_) / 1e9;
+    last_tick_ns_ = now;
+    const Options& options = shared_->options;
+    const double workers = static_cast<double>(
+        std::max<size_t>(options.threads, 1));
+
+    // Ramp up.
+    connect_budget_ += options.ramp / workers * elapsed;
+    while (connect_budget_ >= 1 && next_client_ < end_client_ &&
+           pending_ < kMaxPendingPerWorker) {
+      connect_budget_ -= 1;
+      Connect(next_client_++);
+    }
+    if (next_client_ == end_client_) {
+      connect_budget_ = 0;
+    }
+
+    // Steady load once every device has joined.
+    if (!shared_->load_running.load(std::memory_order_acquire)) {
+      return;
+    }
+    const Directory* directory =
+        shared_->directory.load(std::memory_order_acquire);
+    if (directory == nullptr || directory->clients.size() < 2 ||
+        ready_.empty()) {
+      return;
+    }
+    signal_budget_ += options.signal_rate / workers * elapsed;
+    while (signal_budget_ >= 1) {
+      signal_budget_ -= 1;
+      Client* from = ready_[random_() % ready_.size()];
+      Client* to = PickPeer(*directory, from);
+      if (to == nullptr || to == from ||
+          from->state != Client::State::kReady) {
+        continue;
+      }
+      SendSignal(from, to->id);
+    }
+    share_budget_ += options.share_rate / workers * elapsed;
+    while (share_budget_ >= 1) {
+      share_budget_ -= 1;
+      Client* from = ready_[random_() % ready_.size()];
+      if (from->state != Client::State::kReady) {
+        continue;
+      }
+      from->share_requested_ns.store(NowNs(), std::memory_order_relaxed);
+      SendEvent(from, "request-share", "{}");
+      stats_.shares_sent++;
+    }
+  }
+
+  void Connect(size_t index) {
+    auto owned = std::make_unique<Client>();
+    Client* client = owned.get();
+    clients_.push_back(std::move(owned));
+    client->worker = this;
+    client->index = index;
+    client->started_ns = NowNs();
+    const sockaddr* address =
+        reinterpret_cast<const sockaddr*>(&shared_->server_address);
+    client->fd = ::socket(address->sa_family,
+                          SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (client->fd < 0) {
+      Fail(client);
+      return;
+    }
+    const int one = 1;
+    ::setsockopt(client->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    const size_t sources = shared_->options.source_addresses;
+    if (sources > 1 && address->sa_family == AF_INET) {
+      sockaddr_in source = {};
+      source.sin_family = AF_INET;
+      source.sin_addr.s_addr =
+          htonl(INADDR_LOOPBACK + static_cast<uint32_t>(index % sources));
+      ::bind(client->fd, reinterpret_cast<sockaddr*>(&source), sizeof(source));
+    }
+    pending_++;
+    if (::connect(client->fd, address, shared_->server_address_size) != 0 &&
+        errno != EINPROGRESS) {
+      Fail(client);
+      return;
+    }
+    loop_.Add(client->fd, EPOLLIN | EPOLLOUT, client);
+    client->watching_writable = true;
+  }
+
+  void SendUpgrade(Client* client) {
+    uint8_t key[16];
+    for (uint8_t& byte : key) {
+      byte = static_cast<uint8_t>(random_());
+    }
+    std::string request =
+        "GET /socket.io/?EIO=4&transport=websocket HTTP/1.1\r\n"
+        "Host: " +
+        shared_->options.host + ":" + std::to_string(shared_->options.port) +
+        "\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: " +
+        Base64Encode(key, sizeof(key)) +
+        "\r\n"
+        "Sec-WebSocket-Version: 13\r\n"
+        "User-Agent: sc_signaling_loadgen\r\n\r\n";
+    Send(client, request);
+  }
+
+  void Read(Client* client) {
+    char buffer[64 * 1024];
+    for (;;) {
+      const ssize_t count = ::recv(client->fd, buffer, sizeof(buffer), 0);
+      if (count > 0) {
+        client->in.append(buffer, static_cast<size_t>(count));
+        stats_.bytes_received += static_cast<uint64_t>(count);
+        if (static_cast<size_t>(count) < sizeof(buffer)) {
+          break;
+        }
+        continue;
+      }
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        break;
+      }
+      Fail(client);
+      return;
+    }
+    if (client->state == Client::State::kUpgrading) {
+      const size_t end = client->in.find("\r\n\r\n");
+      if (end == std::string::npos) {
+        return;
+      }
+      if (client->in.compare(0, 12, "HTTP/1.1 101") != 0) {
+        Fail(client);
+        return;
+      }
+      client->in.erase(0, end + 4);
+      client->state = Client::State::kOpening;
+    }
+    size_t consumed = 0;
+    while (client->state != Client::State::kClosed) {
+      WebSocketFrame frame;
+      const ptrdiff_t length =
+          ParseWebSocketFrame(&client->in[consumed], client->in.size() - consumed,
+                              false, kMaxFrame, &frame);
+      if (length == 0) {
+        break;
+      }
+      if (length < 0 || frame.opcode == WebSocketOpcode::kClose) {
+        Fail(client);
+        return;
+      }
+      consumed += static_cast<size_t>(length);
+      if (frame.opcode == WebSocketOpcode::kText) {
+        HandleMessage(client, frame.payload);
+      }
+    }
+    if (client->state != Client::State::kClosed) {
+      client->in.erase(0, consumed);
+    }
+  }
+
+  void HandleMessage(Client* client, std::string_view message) {
+    if (message.empty()) {
+      return;
+    }
+    switch (static_cast<EnginePacket>(message[0])) {
+      case EnginePacket::kOpen:
+        SendText(client, "40");
+        client->state = Client::State::kJoining;
+        return;
+      case EnginePacket::kPing:
+        SendText(client, "3");
+        return;
+      case EnginePacket::kMessage:
+        break;
+      default:
+        return;
+    }
+    SocketIoPacket packet;
+    if (!ParseSocketIoPacket(message.substr(1), &packet)) {
+      return;
+    }
+    if (packet.type == SocketPacket::kConnect &&
+        client->state == Client::State::kJoining) {
+      client->id = json::StringMember(packet.data, "sid");
+      Join(client);
+      return;
+    }
+    SocketIoEvent event;
+    if (packet.type != SocketPacket::kEvent ||
+        !ParseSocketIoEvent(packet.data, &event)) {
+      return;
+    }
+    stats_.events_received++;
+    shared_->events_received.fetch_add(1, std::memory_order_relaxed);
+    if (event.name == "webrtc-signal") {
+      std::string_view signal;
+      std::string_view sent;
+      if (json::FindMember(event.arg, "signal", &signal) &&
+          json::FindMember(signal, "sent", &sent)) {
+        stats_.signal_ns.push_back(NowNs() -
+                                   std::atoll(std::string(sent).c_str()));
+      }
+    } else if (event.name == "share-request") {
+      const Directory* directory =
+          shared_->directory.load(std::memory_order_acquire);
+      const std::string from = json::StringMember(event.arg, "from");
+      if (directory != nullptr) {
+        auto it = directory->by_id.find(from);
+        if (it != directory->by_id.end()) {
+          const int64_t requested =
+              it->second->share_requested_ns.exchange(0);
+          if (requested != 0) {
+            stats_.share_ns.push_back(NowNs() - requested);
+          }
+        }
+      }
+    } else if (event.name == "no-sharer-available") {
+      stats_.no_sharer++;
+    }
+  }
+
+  // A random device to signal |from|, in its group when there are groups.
+  Client* PickPeer(const Directory& directory, const Client* from) {
+    const size_t group_size = shared_->options.group_size;
+    if (group_size == 0) {
+      return directory.clients[random_() % directory.clients.size()];
+    }
+    const size_t first = from->index / group_size * group_size;
+    const size_t count =
+        std::min(group_size, directory.by_index.size() - first);
+    return directory.by_index[first + random_() % count];
+  }
+
+  void Join(Client* client) {
+    std::string registration = "{\"deviceName\":";
+    json::AppendString(&registration,
+                       "loadgen-" + std::to_string(client->index));
+    registration += ",\"platform\":\"linux\"";
+    if (shared_->options.group_size > 0) {
+      registration += ",\"group\":";
+      json::AppendString(
+          &registration,
+          "g" + std::to_string(client->index / shared_->options.group_size));
+    }
+    if (shared_->options.deltas) {
+      registration += ",\"deltas\":true";
+    }
+    registration += '}';
+    SendEvent(client, "register", registration);
+    if (!shared_->options.deltas) {
+      // What the app asks for after registering when the server sends no
+      // snapshot.
+      for (const char* name : {"get-devices", "list-devices",
+                               "get-connected-devices", "devices", "clients",
+                               "room-info"}) {
+        SendEvent(client, name, "{}");
+      }
+    }
+    // Fraction of devices that are ready, spread evenly over the indexes.
+    const double fraction = shared_->options.ready_fraction;
+    client->ready_to_share =
+        static_cast<size_t>(static_cast<double>(client->index + 1) * fraction) !=
+        static_cast<size_t>(static_cast<double>(client->index) * fraction);
+    if (client->ready_to_share) {
+      SendEvent(client, "share-ready", "");
+    }
+    client->state = Client::State::kReady;
+    ready_.push_back(client);
+    pending_--;
+    stats_.connect_ns.push_back(NowNs() - client->started_ns);
+    {
+      std::lock_guard<std::mutex> lock(shared_->mutex);
+      shared_->joined.push_back(client);
+    }
+    shared_->joined_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void SendSignal(Client* from, const std::string& to) {
+    std::string arg = "{\"to\":";
+    json::AppendString(&arg, to);
+    arg +=
+        ",\"signal\":{\"type\":\"candidate\",\"candidate\":{\"candidate\":"
+        "\"candidate:1 1 UDP 2122252543 192.0.2.1 54321 typ host\","
+        "\"sdpMid\":\"0\",\"sdpMLineIndex\":0},\"sent\":" +
+        std::to_string(NowNs()) + "}}";
+    SendEvent(from, "webrtc-signal", arg);
+    stats_.signals_sent++;
+  }
+
+  void SendEvent(Client* client, std::string_view name, std::string_view arg) {
+    SendText(client, EncodeEventPacket(name, arg));
+  }
+
+  void SendText(Client* client, std::string_view packet) {
+    std::string frame;
+    AppendWebSocketFrame(&frame, WebSocketOpcode::kText, packet,
+                         random_() | 1);
+    Send(client, frame);
+  }
+
+  void Send(Client* client, std::string_view bytes) {
+    client->out.append(bytes);
+    if (!client->watching_writable) {
+      Flush(client);
+    }
+  }
+
+  void Flush(Client* client) {
+    while (client->out_offset < client->out.size()) {
+      const ssize_t sent =
+          ::send(client->fd, client->out.data() + client->out_offset,
+                 client->out.size() - client->out_offset, MSG_NOSIGNAL);
+      if (sent > 0) {
+        client->out_offset += static_cast<size_t>(sent);
+        continue;
+      }
+      if (sent < 0 && errno == EINTR) {
+        continue;
+      }
+      if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        if (!client->watching_writable) {
+          client->watching_writable = true;
+          loop_.Modify(client->fd, EPOLLIN | EPOLLOUT, client);
+        }
+        return;
+      }
+      Fail(client);
+      return;
+    }
+    client->out.clear();
+    client->out_offset = 0;
+    if (client->watching_writable) {
+      client->watching_writable = false;
+      loop_.Modify(client->fd, EPOLLIN, client);
+    }
+  }
+
+  void Fail(Client* client) {
+    if (client->state == Client::State::kClosed) {
+      return;
+    }
+    if (client->state != Client::State::kReady) {
+      pending_--;
+    }
+    client->state = Client::State::kClosed;
+    if (client->fd >= 0) {
+      loop_.Remove(client->fd);
+      ::close(client->fd);
+      client->fd = -1;
+    }
+    stats_.failures++;
+    shared_->failed_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Shared* shared_;
+  size_t index_;
+  size_t next_client_;
+  size_t end_client_;
+  size_t pending_ = 0;
+  EventLoop loop_;
+  std::mt19937 random_;
+  int64_t last_tick_ns_ = 0;
+  double connect_budget_ = 0;
+  double signal_budget_ = 0;
+  double share_budget_ = 0;
+  // Clients are never freed while the load runs, so other workers can keep
+  // pointers to them.
+  std::vector<std::unique_ptr<Client>> clients_;
+  std::vector<Client*> ready_;
+  Stats stats_;
+};
+
+void Client::OnReady(uint32_t events) { worker->OnClientReady(this, events); }
+
+void PrintLatency(const char* name, std::vector<int64_t>* samples) {
+  if (samples->empty()) {
+    std::printf("%-16s no samples\n", name);
+    return;
+  }
+  std::sort(samples->begin(), samples->end());
+  auto at = [&](double fraction) {
+    const size_t rank = std::min(
+        samples->size() - 1,
+        static_cast<size_t>(fraction * static_cast<double>(samples->size())));
+    return static_cast<double>((*samples)[rank]) / 1e6;
+  };
+  std::printf("%-16s n=%zu  p50=%.3f ms  p90=%.3f ms  p99=%.3f ms  "
+              "p99.9=%.3f ms  max=%.3f ms\n",
+              name, samples->size(), at(0.5), at(0.9), at(0.99), at(0.999),
+              static_cast<double>(samples->back()) / 1e6);
+}
+
+void PrintUsage() {
+  std::fprintf(
+      stderr,
+      "usage: sc_signaling_loadgen [--host HOST] [--port PORT]\n"
+      "    [--devices N] [--threads N] [--ramp CONNECTIONS_PER_S]\n"
+      "    [--ready-fraction F] [--signal-rate PER_S] [--share-rate PER_S]\n"
+      "    [--duration S] [--source-addresses N] [--deltas 0|1]\n"
+      "    [--group-size N]\n");
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const char* value = argv[++i];
+    if (arg == "--host") {
+      options->host = value;
+    } else if (arg == "--port") {
+      options->port = static_cast<uint16_t>(std::atoi(value));
+    } else if (arg == "--devices") {
+      options->devices = static_cast<size_t>(std::atoll(value));
+    } else if (arg == "--threads") {
+      options->threads = static_cast<size_t>(std::atoi(value));
+    } else if (arg == "--ramp") {
+      options->ramp = std::atof(value);
+    } else if (arg == "--ready-fraction") {
+      options->ready_fraction = std::atof(value);
+    } else if (arg == "--signal-rate") {
+      options->signal_rate = std::atof(value);
+    } else if (arg == "--share-rate") {
+      options->share_rate = std::atof(value);
+    } else if (arg == "--duration") {
+      options->duration = std::atof(value);
+    } else if (arg == "--group-size") {
+      options->group_size = static_cast<size_t>(std::atoll(value));
+    } else if (arg == "--deltas") {
+      options->deltas = std::atoi(value) != 0;
+    } else if (arg == "--source-addresses") {
+      options->source_addresses =
+          std::max<size_t>(1, static_cast<size_t>(std::atoi(value)));
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+int Run(int argc, char** argv) {
+  Shared shared;
+  Options& options = shared.options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage();
+    return 2;
+  }
+  if (options.threads == 0) {
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  options.threads = std::min(options.threads, std::max<size_t>(options.devices, 1));
+
+  rlimit limit;
+  if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_cur < options.devices + 64) {
+      std::fprintf(stderr,
+                   "warning: descriptor limit %llu is below --devices %zu\n",
+                   static_cast<unsigned long long>(limit.rlim_cur),
+                   options.devices);
+    }
+  }
+
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  if (::getaddrinfo(options.host.c_str(), std::to_string(options.port).c_str(),
+                    &hints, &addresses) != 0 ||
+      addresses == nullptr) {
+    std::fprintf(stderr, "cannot resolve %s\n", options.host.c_str());
+    return 1;
+  }
+  std::memcpy(&shared.server_address, addresses->ai_addr,
+              addresses->ai_addrlen);
+  shared.server_address_size = addresses->ai_addrlen;
+  ::freeaddrinfo(addresses);
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads;
+  size_t first = 0;
+  for (size_t i = 0; i < options.threads; i++) {
+    const size_t count = options.devices / options.threads +
+                         (i < options.devices % options.threads ? 1 : 0);
+    workers.push_back(std::make_unique<Worker>(&shared, i, first, count));
+    first += count;
+    if (!workers.back()->Init()) {
+      std::fprintf(stderr, "cannot create event loop\n");
+      return 1;
+    }
+  }
+  for (auto& worker : workers) {
+    threads.emplace_back([&worker] { worker->Run(); });
+  }
+
+  // Ramp up until every device joined or failed, or progress stalls.
+  const int64_t start_ns = NowNs();
+  size_t last_joined = 0;
+  int64_t last_progress_ns = start_ns;
+  for (;;) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const size_t joined = shared.joined_count.load();
+    const size_t failed = shared.failed_count.load();
+    std::printf("ramp: %zu joined, %zu failed, %.1f s\n", joined, failed,
+                static_cast<double>(NowNs() - start_ns) / 1e9);
+    std::fflush(stdout);
+    if (joined != last_joined) {
+      last_joined = joined;
+      last_progress_ns = NowNs();
+    }
+    if (joined + failed >= options.devices ||
+        NowNs() - last_progress_ns > 10'000'000'000) {
+      break;
+    }
+  }
+  const double ramp_seconds = static_cast<double>(NowNs() - start_ns) / 1e9;
+
+  Directory directory;
+  {
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    directory.clients = shared.joined;
+  }
+  directory.by_index.resize(options.devices);
+  for (Client* client : directory.clients) {
+    directory.by_index[client->index] = client;
+    directory.by_id.emplace(client->id, client);
+  }
+  shared.directory.store(&directory, std::memory_order_release);
+  shared.load_running.store(true, std::memory_order_release);
+
+  const uint64_t events_before = shared.events_received.load();
+  const int64_t load_start_ns = NowNs();
+  while (NowNs() - load_start_ns <
+         static_cast<int64_t>(options.duration * 1e9)) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    std::printf("load: %llu events received, %zu failed, %.1f s\n",
+                static_cast<unsigned long long>(shared.events_received.load() -
+                                                events_before),
+                shared.failed_count.load(),
+                static_cast<double>(NowNs() - load_start_ns) / 1e9);
+    std::fflush(stdout);
+  }
+  const double load_seconds =
+      static_cast<double>(NowNs() - load_start_ns) / 1e9;
+  const uint64_t load_events = shared.events_received.load() - events_before;
+
+  for (auto& worker : workers) {
+    worker->Stop();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  Stats total;
+  for (auto& worker : workers) {
+    total.Merge(worker->stats());
+  }
+
+  std::printf("\ndevices: %zu joined of %zu in %.1f s, %llu failures\n",
+              directory.clients.size(), options.devices, ramp_seconds,
+              static_cast<unsigned long long>(total.failures));
+  std::printf("sent: %llu signals (%.0f/s), %llu share requests\n",
+              static_cast<unsigned long long>(total.signals_sent),
+              static_cast<double>(total.signals_sent) / load_seconds,
+              static_cast<unsigned long long>(total.shares_sent));
+  std::printf("received: %llu events, %.0f/s during load, %.1f MB in total, "
+              "%llu no-sharer-available\n",
+              static_cast<unsigned long long>(total.events_received),
+              static_cast<double>(load_events) / load_seconds,
+              static_cast<double>(total.bytes_received) / 1e6,
+              static_cast<unsigned long long>(total.no_sharer));
+  PrintLatency("connect+join", &total.connect_ns);
+  PrintLatency("webrtc-signal", &total.signal_ns);
+  PrintLatency("share-request", &total.share_ns);
+  return directory.clients.size() == options.devices ? 0 : 1;
+}
+
+}  // namespace
+}  // namespace signaling
+}  // namespace sc
+
+int main(int argc, char** argv) { return sc::signaling::Run(argc, argv); }
@@ -0,0 +1,123 @@
+#include "websocket.h"
+
+#include "encoding.h"
+
+namespace sc {
+namespace signaling {
+
+namespace {
+
+constexpr std::string_view kHandshakeGuid =
+    "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+bool IsControl(WebSocketOpcode opcode) {
+  return static_cast<uint8_t>(opcode) >= 0x8;
+}
+
+bool IsKnown(uint8_t opcode) {
+  return opcode <= 0x2 || (opcode >= 0x8 && opcode <= 0xa);
+}
+
+}  // namespace
+
+std::string WebSocketAccept(std::string_view key) {
+  std::string input(key);
+  input += kHandshakeGuid;
+  uint8_t digest[kSha1DigestSize];
+  Sha1(input.data(), input.size(), digest);
+  return Base64Encode(digest, sizeof(digest));
+}
+
+ptrdiff_t ParseWebSocketFrame(char* data, size_t size, bool expect_masked,
+                              size_t max_payload, WebSocketFrame* frame) {
+  if (size < 2) {
+    return 0;
+  }
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t opcode = bytes[0] & 0x0f;
+  // No extensions are negotiated, so the reserved bits must be clear.
+  if ((bytes[0] & 0x70) != 0 || !IsKnown(opcode)) {
+    return -1;
+  }
+  const bool masked = (bytes[1] & 0x80) != 0;
+  if (masked != expect_masked) {
+    return -1;
+  }
+  uint64_t length = bytes[1] & 0x7f;
+  size_t header = 2;
+  if (length == 126) {
+    if (size < 4) {
+      return 0;
+    }
+    length = static_cast<uint64_t>(bytes[2]) << 8 | bytes[3];
+    header = 4;
+  } else if (length == 127) {
+    if (size < 10) {
+      return 0;
+    }
+    length = 0;
+    for (int i = 2; i < 10; i++) {
+      length = length << 8 | bytes[i];
+    }
+    header = 10;
+  }
+  frame->fin = (bytes[0] & 0x80) != 0;
+  frame->opcode = static_cast<WebSocketOpcode>(opcode);
+  if (IsControl(frame->opcode) && (length > 125 || !frame->fin)) {
+    return -1;
+  }
+  if (length > max_payload) {
+    return -1;
+  }
+  const size_t mask_at = header;
+  if (masked) {
+    header += 4;
+  }
+  if (size < header + length) {
+    return 0;
+  }
+  char* payload = data + header;
+  if (masked) {
+    const uint8_t* mask = bytes + mask_at;
+    for (size_t i = 0; i < length; i++) {
+      payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+    }
+  }
+  frame->payload = std::string_view(payload, static_cast<size_t>(length));
+  return static_cast<ptrdiff_t>(header + length);
+}
+
+void AppendWebSocketFrame(std::string* out, WebSocketOpcode opcode,
+                          std::string_view payload, uint32_t mask_key) {
+  const uint8_t mask_bit = mask_key != 0 ? 0x80 : 0;
+  *out += static_cast<char>(0x80 | static_cast<uint8_t>(opcode));
+  const uint64_t length = payload.size();
+  if (length < 126) {
+    *out += static_cast<char>(mask_bit | length);
+  } else if (length <= 0xffff) {
+    *out += static_cast<char>(mask_bit | 126);
+    *out += static_cast<char>(length >> 8);
+    *out += static_cast<char>(length);
+  } else {
+    *out += static_cast<char>(mask_bit | 127);
+    for (int i = 7; i >= 0; i--) {
+      *out += static_cast<char>(length >> (8 * i));
+    }
+  }
+  if (mask_key == 0) {
+    out->append(payload);
+    return;
+  }
+  const uint8_t mask[4] = {
+      static_cast<uint8_t>(mask_key >> 24), static_cast<uint8_t>(mask_key >> 16),
+      static_cast<uint8_t>(mask_key >> 8), static_cast<uint8_t>(mask_key)};
+  out->append(reinterpret_cast<const char*>(mask), 4);
+  const size_t start = out->size();
+  out->append(payload);
+  for (size_t i = 0; i < payload.size(); i++) {
+    (*out)[start + i] = static_cast<char>((*out)[start + i] ^ mask[i & 3]);
+  }
+}
+
+}  // namespace signaling
+}  // namespace sc
@@ -0,0 +1,48 @@
+#ifndef SERVER_NATIVE_WEBSOCKET_H_
+#define SERVER_NATIVE_WEBSOCKET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sc {
+namespace signaling {
+
+// RFC 6455 framing. The server sends unmasked frames and requires masked
+// ones from clients; the load generator does the reverse.
+
+enum class WebSocketOpcode : uint8_t {
+  kContinuation = 0x0,
+  kText = 0x1,
+  kBinary = 0x2,
+  kClose = 0x8,
+  kPing = 0x9,
+  kPong = 0xa,
+};
+
+struct WebSocketFrame {
+  bool fin = true;
+  WebSocketOpcode opcode = WebSocketOpcode::kText;
+  std::string_view payload;  // unmasked in place
+};
+
+// Sec-WebSocket-Accept value for the client's Sec-WebSocket-Key.
+std::string WebSocketAccept(std::string_view key);
+
+// Parses the frame at the start of |data| of |size| bytes, unmasking its
+// payload in place. Returns the frame's length, 0 if more bytes are needed,
+// or -1 if the frame is malformed, masked when it should not be or the
+// other way round, or its payload exceeds |max_payload|.
+ptrdiff_t ParseWebSocketFrame(char* data, size_t size, bool expect_masked,
+                              size_t max_payload, WebSocketFrame* frame);
+
+// Appends a final frame carrying |payload|, masked with |mask_key| unless
+// it is zero.
+void AppendWebSocketFrame(std::string* out, WebSocketOpcode opcode,
+                          std::string_view payload, uint32_t mask_key = 0);
+
+}  // namespace signaling
+}  // namespace sc
+
+#endif  // SERVER_NATIVE_WEBSOCKET_H_
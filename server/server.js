@@ -1,6 +1,10 @@
 const express = require('express');
 const http = require('http');
 const socketIo = require('socket.io');
+const logger = require('./logger').fromEnv();
+const metrics = require('./metrics');
+const cluster = require('./cluster');
+const tracing = require('./tracing');
 
 const app = express();
 const server = http.createServer(app);
@@ -13,19 +17,36 @@ app.get('/health', (req, res) => {
     uptime: process.uptime(),
     server: 'shared_clipboard_server',
     version: '1.0.0',
-    connectedDevices: Object.keys(devices || {}).length,
-    devicesReadyToShare: Object.keys(devices || {}).filter(id => devices[id].readyToShare).length
+    node: NODE_ID,
+    connectedDevices: deviceCount,
+    devicesReadyToShare: readyCount,
+    groups: groupCount
   };
   
-  log('🏥 HEALTH CHECK REQUEST', {
+  logger.debug('health-check', () => ({
     remoteAddress: req.ip || req.connection.remoteAddress,
     userAgent: req.get('User-Agent'),
-    healthData
-  });
+    connectedDevices: healthData.connectedDevices
+  }));
   
   res.status(200).json(healthData);
 });
 
+// Prometheus metrics, kept as things happen so a scrape never walks the
+// devices or sockets
+const registry = new metrics.Registry();
+
+app.get('/metrics', (req, res) => {
+  res.type(metrics.CONTENT_TYPE).send(registry.render());
+});
+
+// The last spans of traced shares, as Chrome trace JSON (see tracing.js)
+const tracer = new tracing.Tracer();
+
+app.get('/trace', (req, res) => {
+  res.status(200).json(tracer.chromeTrace());
+});
+
 const io = socketIo(server, {
   cors: {
     origin: "*",
@@ -33,11 +54,222 @@ const io = socketIo(server, {
   }
 });
 
+// Other signaling servers may share the load (see cluster.js and hub.js).
+// `devices` then also holds theirs, each entry naming the node its socket
+// is on, and every count below is of the whole cluster.
+const bus = cluster.fromEnv();
+const NODE_ID = bus.nodeId;
+
 let devices = {};
+// Kept with `devices` and `groupVersions`, for /health and /metrics
+let deviceCount = 0;
+let readyCount = 0;
+let groupCount = 0;
+
+// Devices register with an optional group key, per user or team, and only
+// see and share with devices in the same group. Devices that send none
+// share the '' group. Every device is in its group's room; delta clients
+// are also in its delta room, and legacy events skip them.
+const MAX_GROUP_LENGTH = 128;
+const groupRoom = (group) => `group:${group}`;
+const deltaRoom = (group) => `deltas:${group}`;
+
+// Device ids by group, kept with `devices` so no lookup scans them all.
+const groupMembers = new Map();
+
+function devicesInGroup(group) {
+  const members = groupMembers.get(group);
+  return members ? Array.from(members) : [];
+}
+
+// Clients that register with { deltas: true } get their group's device list
+// once, as a versioned 'device-snapshot', then a 'device-delta' for every
+// change instead of full lists and per-device announcements. A client that
+// sees a gap in the versions asks for a new snapshot with 'sync-devices'.
+//
+// Each group is versioned on its own. A new group starts from the count of
+// changes made in all groups, so a group that empties and comes back never
+// reuses a version.
+let deviceListVersion = 0;
+let groupVersions = {};
+
+// request-share goes to the device the requester names, if it is ready in
+// the same group, else to the one SHARER_POLICY picks:
+//   recent        the device that most recently sent share-ready (default)
+//   least-loaded  the device sent the fewest share requests since it
+//                 became ready, counting the requests this node routed
+const SHARER_POLICY = process.env.SHARER_POLICY === 'least-loaded' ? 'least-loaded' : 'recent';
+
+// Minimal doubly linked list, so moving an entry costs O(1).
+class LinkedList {
+  constructor() {
+    this.head = null;
+    this.tail = null;
+  }
+
+  insert(node, front) {
+    node.prev = front ? null : this.tail;
+    node.next = front ? this.head : null;
+    if (node.prev) node.prev.next = node; else this.head = node;
+    if (node.next) node.next.prev = node; else this.tail = node;
+  }
+
+  insertAfter(node, after) {
+    node.prev = after;
+    node.next = after.next;
+    after.next = node;
+    if (node.next) node.next.prev = node; else this.tail = node;
+  }
+
+  remove(node) {
+    if (node.prev) node.prev.next = node.next; else this.head = node.next;
+    if (node.next) node.next.prev = node.prev; else this.tail = node.prev;
+    node.prev = node.next = null;
+  }
+}
+
+// The ready devices of one group, ordered for request-share in O(1):
+// buckets by load, in ascending order, each listing its devices in the
+// order they are picked in.
+class SharerIndex {
+  constructor(policy) {
+    this.policy = policy;
+    this.buckets = new LinkedList();
+    this.positions = new Map();
+  }
+
+  get size() {
+    return this.positions.size;
+  }
+
+  // Adds a device with no load, or makes it the most recently ready again.
+  markReady(deviceId) {
+    const node = this.positions.get(deviceId);
+    if (node) {
+      node.bucket.ids.remove(node);
+      node.bucket.ids.insert(node, true);
+      return;
+    }
+    let bucket = this.buckets.head;
+    if (!bucket || bucket.load !== 0) {
+      bucket = { load: 0, ids: new LinkedList() };
+      this.buckets.insert(bucket, true);
+    }
+    const added = { id: deviceId, bucket: bucket };
+    bucket.ids.insert(added, true);
+    this.positions.set(deviceId, added);
+  }
+
+  remove(deviceId) {
+    const node = this.positions.get(deviceId);
+    if (!node) return false;
+    this._take(node);
+    this.positions.delete(deviceId);
+    return true;
+  }
+
+  has(deviceId) {
+    return this.positions.has(deviceId);
+  }
+
+  // The device to ask next other than `exclude`, or null. At most two
+  // steps: the excluded device is skipped once.
+  pick(exclude) {
+    for (let bucket = this.buckets.head; bucket; bucket = bucket.next) {
+      for (let node = bucket.ids.head; node; node = node.next) {
+        if (node.id !== exclude) return node.id;
+      }
+    }
+    return null;
+  }
+
+  countRequest(deviceId) {
+    const node = this.positions.get(deviceId);
+    if (!node || this.policy !== 'least-loaded') return;
+    const from = node.bucket;
+    const load = from.load + 1;
+    let bucket = from.next;
+    if (!bucket || bucket.load !== load) {
+      bucket = { load: load, ids: new LinkedList() };
+      this.buckets.insertAfter(bucket, from);
+    }
+    this._take(node);
+    node.bucket = bucket;
+    bucket.ids.insert(node, false);
+  }
+
+  _take(node) {
+    const bucket = node.bucket;
+    bucket.ids.remove(node);
+    if (!bucket.ids.head) this.buckets.remove(bucket);
+  }
+}
+
+// Ready devices by group.
+let readySharers = {};
+
+function sharersOf(group) {
+  if (!readySharers[group]) readySharers[group] = new SharerIndex(SHARER_POLICY);
+  return readySharers[group];
+}
+
+function dropSharer(deviceId, group) {
+  const sharers = readySharers[group];
+  if (sharers && sharers.remove(deviceId) && sharers.size === 0) {
+    delete readySharers[group];
+  }
+}
+
+function deviceListEntry(deviceId) {
+  const deviceInfo = devices[deviceId];
+  return {
+    id: deviceId,
+    deviceId: deviceId,
+    socketId: deviceId,
+    name: deviceInfo.deviceName || `Device ${deviceId.substring(0, 8)}`,
+    readyToShare: deviceInfo.readyToShare
+  };
+}
+
+// Numbers a change to a group's device list and sends it to the group's
+// delta clients.
+function publishDeviceChange(group, change) {
+  deviceListVersion++;
+  if (groupVersions[group] === undefined) {
+    groupVersions[group] = deviceListVersion - 1;
+    groupCount++;
+  }
+  const version = ++groupVersions[group];
+  io.to(deltaRoom(group)).emit('device-delta', {
+    from: version,
+    to: version,
+    changes: [change]
+  });
+  if (!groupMembers.has(group)) {
+    delete groupVersions[group];
+    groupCount--;
+  }
+}
+
+function sendDeviceSnapshot(socket) {
+  const group = devices[socket.id].group;
+  const snapshot = {
+    version: groupVersions[group] || 0,
+    devices: devicesInGroup(group).map(deviceListEntry)
+  };
+  logger.debug('send-device-snapshot', () => ({
+    to: socket.id.substring(0, 8) + '...',
+    groupLength: group.length,
+    version: snapshot.version,
+    devicesCount: snapshot.devices.length
+  }));
+  socket.emit('device-snapshot', snapshot);
+}
 
 // Helper function to send devices list to a specific client
 function sendDevicesList(socket) {
-  const otherDevices = Object.keys(devices).filter(id => id !== socket.id);
+  const group = devices[socket.id] ? devices[socket.id].group : '';
+  const otherDevices = devicesInGroup(group).filter(id => id !== socket.id);
   const devicesList = otherDevices.map(deviceId => {
     const deviceInfo = devices[deviceId];
     
@@ -53,15 +285,10 @@ function sendDevicesList(socket) {
     };
   });
   
-  log('📤 SENDING DEVICES LIST', {
+  logger.debug('send-devices-list', () => ({
     to: socket.id.substring(0, 8) + '...',
-    devicesCount: devicesList.length,
-    devices: devicesList.map(d => ({
-      id: d.id.substring(0, 8) + '...',
-      name: d.name,
-      readyToShare: d.readyToShare
-    }))
-  });
+    devicesCount: devicesList.length
+  }));
   
   // Send the list using multiple event names to match what the client is listening for
   socket.emit('devices', devicesList);
@@ -71,11 +298,6 @@ function sendDevicesList(socket) {
   // Also emit individual device-connected events for each existing device
   otherDevices.forEach(deviceId => {
     const deviceInfo = devicesList.find(d => d.id === deviceId);
-    log('📱 SENDING INDIVIDUAL device-connected', {
-      to: socket.id.substring(0, 8) + '...',
-      deviceId: deviceId.substring(0, 8) + '...',
-      deviceName: deviceInfo.name
-    });
     socket.emit('device-connected', { 
       id: deviceId, 
       deviceId: deviceId,
@@ -85,47 +307,255 @@ function sendDevicesList(socket) {
   });
 }
 
-// Helper function for timestamped logging
-function log(message, data = null) {
-  const timestamp = new Date().toISOString();
-  if (data) {
-    console.log(`[${timestamp}] ${message}`, JSON.stringify(data, null, 2));
+// Registry changes, made here for this node's sockets and when another
+// node reports one for its own. Each tells the device's group on this node.
+
+// Adds or replaces device `id`; `entry` is its new devices[] value.
+function putDevice(id, entry) {
+  if (devices[id] && devices[id].group !== entry.group) {
+    removeDevice(id);
+  }
+  const wasRegistered = !!devices[id];
+  if (wasRegistered) {
+    dropSharer(id, entry.group);
+    if (devices[id].readyToShare) readyCount--;
   } else {
-    console.log(`[${timestamp}] ${message}`);
+    deviceCount++;
   }
+  const group = entry.group;
+  devices[id] = entry;
+  if (!groupMembers.has(group)) groupMembers.set(group, new Set());
+  groupMembers.get(group).add(id);
+  io.to(groupRoom(group)).except([deltaRoom(group), id]).emit('device-connected', {
+    deviceId: id,
+    id: id,
+    socketId: id,
+    name: entry.deviceName
+  });
+  publishDeviceChange(group, {
+    op: wasRegistered ? 'update' : 'add',
+    device: deviceListEntry(id)
+  });
+}
+
+function markReady(deviceId) {
+  const wasReady = devices[deviceId].readyToShare;
+  devices[deviceId].readyToShare = true;
+  if (!wasReady) readyCount++;
+  const group = devices[deviceId].group;
+  sharersOf(group).markReady(deviceId);
+  if (!wasReady) {
+    publishDeviceChange(group, { op: 'ready', deviceId: deviceId, readyToShare: true });
+  }
+
+  // Notify other devices that a device is ready to share
+  io.to(groupRoom(group)).except(deltaRoom(group)).emit('share-available', { deviceId: deviceId });
 }
 
+function clearReady(deviceId) {
+  if (devices[deviceId].readyToShare) {
+    devices[deviceId].readyToShare = false;
+    readyCount--;
+    dropSharer(deviceId, devices[deviceId].group);
+    publishDeviceChange(devices[deviceId].group,
+                        { op: 'ready', deviceId: deviceId, readyToShare: false });
+  }
+}
+
+function removeDevice(deviceId) {
+  const group = devices[deviceId].group;
+  dropSharer(deviceId, group);
+  if (devices[deviceId].readyToShare) readyCount--;
+  delete devices[deviceId];
+  deviceCount--;
+  const members = groupMembers.get(group);
+  members.delete(deviceId);
+  if (members.size === 0) groupMembers.delete(group);
+  publishDeviceChange(group, { op: 'remove', deviceId: deviceId });
+  io.to(groupRoom(group)).except(deltaRoom(group))
+    .emit('device-disconnected', { deviceId: deviceId });
+}
+
+// Takes a registered device out of its group and tells the rest of it.
+function leaveGroup(socket) {
+  const group = devices[socket.id].group;
+  socket.leave(groupRoom(group));
+  socket.leave(deltaRoom(group));
+  removeDevice(socket.id);
+  replica.remove(socket.id);
+}
+
+// A device as other nodes are told of it.
+function wireDevice(deviceId) {
+  const device = devices[deviceId];
+  return {
+    id: deviceId,
+    deviceName: device.deviceName,
+    platform: device.platform,
+    group: device.group,
+    readyToShare: device.readyToShare
+  };
+}
+
+function localDevices() {
+  return Object.keys(devices)
+    .filter(id => devices[id].node === NODE_ID)
+    .map(wireDevice);
+}
+
+// Emits to a device's socket, on whichever node it is.
+function emitToDevice(deviceId, event, payload) {
+  if (replica.emit(deviceId, event, payload)) clusterSent.inc();
+}
+
+// ICE candidates carried by a signal: one, or a batch (see
+// WebRTCService._queueLocalCandidate in the client).
+function candidateCount(signal) {
+  if (!signal) return 0;
+  if (Array.isArray(signal.candidates)) return signal.candidates.length;
+  return signal.candidate ? 1 : 0;
+}
+
+// Events another node may emit to a socket here.
+const REMOTE_EVENTS = new Set(['share-request', 'webrtc-signal']);
+
+// Drops the devices of `node`, or of every other node when null.
+function dropRemoteDevices(node) {
+  for (const id of Object.keys(devices)) {
+    const owner = devices[id].node;
+    if (node === null ? owner !== NODE_ID : owner === node) removeDevice(id);
+  }
+}
+
+// This node's side of the registry other nodes replicate (see cluster.js).
+const replica = cluster.replicate(bus, {
+  localDevices: localDevices,
+  nodeOf: (id) => devices[id] ? devices[id].node : undefined,
+  // Adds a device another node reports, as it joins or as we do.
+  put: (device, node) => {
+    putDevice(device.id, {
+      readyToShare: false,
+      signalingData: null,
+      deviceName: device.deviceName,
+      platform: device.platform,
+      group: device.group,
+      node: node
+    });
+    if (device.readyToShare) markReady(device.id);
+  },
+  setReady: (id, ready) => {
+    if (ready) markReady(id); else clearReady(id);
+  },
+  remove: removeDevice,
+  dropNode: dropRemoteDevices,
+  emitLocal: (to, event, payload) => {
+    if (REMOTE_EVENTS.has(event)) io.to(to).emit(event, payload);
+  }
+});
+
+bus.on('message', () => clusterReceived.inc());
+bus.on('connected', () => {
+  logger.info('cluster-connected', { node: NODE_ID });
+});
+bus.on('node-joined', (node) => {
+  logger.info('cluster-node-joined', { node: node });
+});
+bus.on('node-left', (node) => {
+  logger.info('cluster-node-left', { node: node });
+});
+bus.on('disconnected', () => {
+  logger.warn('cluster-disconnected', { node: NODE_ID });
+});
+
 // Log server startup
-log('=== SERVER STARTING ===');
-log('CORS configuration:', {
-  origin: "*",
-  methods: ["GET", "POST"]
+logger.info('server-starting', {
+  cors: { origin: "*", methods: ["GET", "POST"] }
 });
 
+const HANDLED_EVENTS = new Set([
+  'register', 'share-ready', 'share-not-ready', 'not-ready', 'request-share',
+  'webrtc-signal', 'disconnect', 'get-devices', 'list-devices',
+  'get-connected-devices', 'devices', 'clients', 'room-info', 'sync-devices'
+]);
+
+// Incoming events by name. Unknown names share 'other', so clients cannot
+// grow the label set; children are looked up once, not per event.
+const eventsTotal = registry.counter('signaling_events_total',
+  'Socket.IO events received, by event name.', ['event']);
+const eventCounters = new Map();
+for (const name of ['connection', ...HANDLED_EVENTS]) {
+  eventCounters.set(name, eventsTotal.labels(name));
+}
+const otherEvents = eventsTotal.labels('other');
+
+const signalsDropped = registry.counter('signaling_webrtc_signals_dropped_total',
+  'webrtc-signals dropped because the recipient is not in the sender\'s group.', []);
+
+// Messages exchanged with other nodes
+const clusterMessages = registry.counter('signaling_cluster_messages_total',
+  'Messages exchanged with other signaling nodes, by direction.', ['direction']);
+const clusterSent = clusterMessages.labels('sent');
+const clusterReceived = clusterMessages.labels('received');
+
+// Time to route and queue one webrtc-signal for its recipient
+const signalForwardSeconds = registry.histogram('signaling_webrtc_signal_forward_seconds',
+  'Time to forward one webrtc-signal to its recipient, in seconds.', [],
+  [0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.05]);
+
+registry.gauge('signaling_connected_sockets', 'Open Socket.IO connections.', [],
+  () => io.engine.clientsCount);
+registry.gauge('signaling_connected_devices', 'Registered devices.', [], () => deviceCount);
+registry.gauge('signaling_ready_devices', 'Devices ready to share.', [], () => readyCount);
+registry.gauge('signaling_groups', 'Groups with at least one device.', [], () => groupCount);
+
+// Engine.IO packets waiting in a socket's write buffer for its transport.
+// Each new packet records the depth it joins; the gauge sums all sockets.
+const outboundQueueDepth = registry.histogram('signaling_outbound_queue_depth',
+  'Packets queued on a socket, including the new one, as each is queued.', [],
+  [1, 2, 4, 8, 16, 32, 64, 128, 256, 1024]);
+const outboundQueued = registry.gauge('signaling_outbound_queued_packets',
+  'Packets queued on all sockets and not yet handed to their transport.');
+
+const eventLoopLag = registry.histogram('signaling_event_loop_lag_seconds',
+  'How late a 100 ms timer fired, in seconds.', [],
+  [0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5]);
+metrics.monitorEventLoopLag(eventLoopLag, 100);
+
+registry.gauge('process_resident_memory_bytes', 'Resident memory size in bytes.', [],
+  () => process.memoryUsage.rss ? process.memoryUsage.rss() : process.memoryUsage().rss);
+registry.gauge('process_uptime_seconds', 'Seconds since the process started.', [],
+  () => process.uptime());
+
+function trackOutboundQueue(conn) {
+  conn.on('packetCreate', () => {
+    outboundQueued.inc();
+    outboundQueueDepth.observe(conn.writeBuffer.length + 1);
+  });
+  conn.on('flush', (buffer) => outboundQueued.dec(buffer.length));
+  conn.on('close', () => outboundQueued.dec(conn.writeBuffer.length));
+}
+
 io.on('connection', (socket) => {
-  log('🔌 NEW CONNECTION', {
+  eventCounters.get('connection').inc();
+  trackOutboundQueue(socket.conn);
+  logger.debug('connection', () => ({
     socketId: socket.id,
     remoteAddress: socket.request.connection.remoteAddress,
-    userAgent: socket.request.headers['user-agent'],
-    totalConnections: Object.keys(devices).length + 1
-  });
-
-  // Log current state
-  log('📊 CURRENT DEVICES STATE', {
-    totalDevices: Object.keys(devices).length,
-    devices: Object.keys(devices).map(id => ({
-      id: id.substring(0, 8) + '...',
-      readyToShare: devices[id].readyToShare
-    }))
-  });
+    userAgent: socket.request.headers['user-agent']
+  }));
 
   socket.on('register', (data) => {
-    log('📝 DEVICE REGISTRATION', {
+    logger.info('register', () => ({
       socketId: socket.id.substring(0, 8) + '...',
-      data: data,
+      // Not the group key: it is all that keeps one group's devices from
+      // another's, so it stays out of the logs.
+      deviceName: data ? data.deviceName : undefined,
+      platform: data ? data.platform : undefined,
+      groupLength: data && typeof data.group === 'string' ? data.group.length : 0,
+      deltas: !!(data && data.deltas === true),
       previouslyRegistered: !!devices[socket.id],
       userAgent: socket.request.headers['user-agent']
-    });
+    }));
     
     // Use device name from client data if available, otherwise extract from user agent
     let deviceName = data && data.deviceName ? data.deviceName : `Device ${socket.id.substring(0, 8)}`;
@@ -150,68 +580,53 @@ io.on('connection', (socket) => {
       }
     }
     
-    devices[socket.id] = { 
-      readyToShare: false, 
+    const group = data && typeof data.group === 'string' ? data.group : '';
+    if (group.length > MAX_GROUP_LENGTH) {
+      logger.warn('register-refused', {
+        socketId: socket.id.substring(0, 8) + '...',
+        reason: 'group key too long'
+      });
+      return;
+    }
+    if (devices[socket.id] && devices[socket.id].group !== group) {
+      leaveGroup(socket);
+    }
+    const wantsDeltas = !!(data && data.deltas === true);
+    socket.join(groupRoom(group));
+    if (wantsDeltas) {
+      socket.join(deltaRoom(group));
+    } else {
+      socket.leave(deltaRoom(group));
+    }
+
+    putDevice(socket.id, {
+      readyToShare: false,
       signalingData: null,
       deviceName: deviceName,
-      platform: data && data.platform ? data.platform : 'unknown'
-    };
-    
-    log('📢 BROADCASTING device-connected', {
-      newDeviceId: socket.id.substring(0, 8) + '...',
-      deviceName: deviceName,
-      broadcastingTo: Object.keys(devices).filter(id => id !== socket.id).length + ' other clients'
-    });
-    
-    socket.broadcast.emit('device-connected', { 
-      deviceId: socket.id,
-      id: socket.id,
-      socketId: socket.id,
-      name: deviceName
+      platform: data && data.platform ? data.platform : 'unknown',
+      group: group,
+      node: NODE_ID
     });
+    replica.put(wireDevice(socket.id));
     
     // Immediately send existing devices list to the newly registered client
-    log('📋 SENDING EXISTING DEVICES TO NEW CLIENT', {
-      newClient: socket.id.substring(0, 8) + '...'
-    });
-    sendDevicesList(socket);
-    
-    log('📊 UPDATED DEVICES STATE AFTER REGISTRATION', {
-      totalDevices: Object.keys(devices).length,
-      devices: Object.keys(devices).map(id => ({
-        id: id.substring(0, 8) + '...',
-        readyToShare: devices[id].readyToShare
-      }))
-    });
+    if (wantsDeltas) {
+      sendDeviceSnapshot(socket);
+    } else {
+      sendDevicesList(socket);
+    }
   });
 
   socket.on('share-ready', () => {
-    log('🚀 SHARE-READY RECEIVED', {
-      socketId: socket.id.substring(0, 8) + '...',
-      deviceExists: !!devices[socket.id]
-    });
+    logger.info('share-ready', () => ({
+      socketId: socket.id.substring(0, 8) + '...'
+    }));
     
     if (devices[socket.id]) {
-      devices[socket.id].readyToShare = true;
-      log('✅ DEVICE MARKED AS READY TO SHARE', {
-        socketId: socket.id.substring(0, 8) + '...',
-        devicesReadyToShare: Object.keys(devices).filter(id => devices[id].readyToShare).length
-      });
-      
-      // Notify other devices that a device is ready to share
-      log('📢 BROADCASTING share-available', {
-        sharingDeviceId: socket.id.substring(0, 8) + '...',
-        broadcastingToAll: Object.keys(devices).length + ' clients'
-      });
-      
-      io.emit('share-available', { deviceId: socket.id });
-      
-      log('📊 CURRENT SHARING STATE', {
-        totalDevices: Object.keys(devices).length,
-        devicesReadyToShare: Object.keys(devices).filter(id => devices[id].readyToShare).map(id => id.substring(0, 8) + '...')
-      });
+      markReady(socket.id);
+      replica.ready(socket.id, true);
     } else {
-      log('❌ ERROR: Device not found when trying to mark as ready', {
+      logger.warn('share-ready-unregistered', {
         socketId: socket.id.substring(0, 8) + '...'
       });
     }
@@ -219,200 +634,213 @@ io.on('connection', (socket) => {
 
   // Allow clients to explicitly clear their ready-to-share state
   socket.on('share-not-ready', () => {
-    log('🧹 SHARE-NOT-READY RECEIVED', {
+    logger.info('share-not-ready', () => ({
       socketId: socket.id.substring(0, 8) + '...',
       deviceExists: !!devices[socket.id]
-    });
+    }));
     if (devices[socket.id]) {
-      devices[socket.id].readyToShare = false;
-      log('✅ DEVICE CLEARED FROM READY STATE', {
-        socketId: socket.id.substring(0, 8) + '...',
-        devicesReadyToShare: Object.keys(devices).filter(id => devices[id].readyToShare).length
-      });
+      clearReady(socket.id);
+      replica.ready(socket.id, false);
     }
   });
 
   // Alias some clients may emit
   socket.on('not-ready', () => {
-    log('🧹 NOT-READY RECEIVED (alias)');
+    logger.info('share-not-ready', () => ({
+      socketId: socket.id.substring(0, 8) + '...',
+      alias: 'not-ready'
+    }));
     if (devices[socket.id]) {
-      devices[socket.id].readyToShare = false;
+      clearReady(socket.id);
+      replica.ready(socket.id, false);
+    }
+  });
+
+  // Delta clients ask for a new snapshot when they miss a version
+  socket.on('sync-devices', () => {
+    logger.info('sync-devices', () => ({
+      requester: socket.id.substring(0, 8) + '...',
+      version: devices[socket.id] ? groupVersions[devices[socket.id].group] : null
+    }));
+    if (devices[socket.id]) {
+      sendDeviceSnapshot(socket);
     }
   });
 
   socket.on('request-share', (data) => {
-    log('📥 SHARE REQUEST RECEIVED', {
-      requesterSocketId: socket.id.substring(0, 8) + '...',
-      requestData: data
-    });
-    
-    // Build list of ready devices EXCLUDING the requester
-    const availableDevices = Object
-      .keys(devices)
-      .filter(id => devices[id].readyToShare && id !== socket.id);
-    log('🔍 LOOKING FOR SHARING DEVICES', {
-      totalDevices: Object.keys(devices).length,
-      devicesReadyToShare: availableDevices.length,
-      readyDevices: availableDevices.map(id => id.substring(0, 8) + '...')
-    });
-    
-    const sharingDevice = availableDevices[0]; // Get the first available device
+    const started = tracer.now();
+    const traceId = tracing.traceIdOf(data && data.traceId);
+    // Pick from the ready devices in the requester's group, EXCLUDING the
+    // requester: the one it names if it can, else by SHARER_POLICY
+    const group = devices[socket.id] ? devices[socket.id].group : '';
+    const sharers = readySharers[group];
+    const preferred = data && typeof data.deviceId === 'string' ? data.deviceId : null;
+    let sharingDevice = null;
+    if (sharers) {
+      sharingDevice = preferred && preferred !== socket.id && sharers.has(preferred)
+        ? preferred
+        : sharers.pick(socket.id);
+    }
+    logger.info('request-share', () => ({
+      requester: socket.id.substring(0, 8) + '...',
+      preferred: preferred ? preferred.substring(0, 8) + '...' : null,
+      sharer: sharingDevice ? sharingDevice.substring(0, 8) + '...' : null,
+      devicesReadyToShare: sharers ? sharers.size : 0,
+      policy: SHARER_POLICY,
+      traceId
+    }));
     
     if (sharingDevice) {
-      log('✅ FOUND SHARING DEVICE', {
-        requester: socket.id.substring(0, 8) + '...',
-        sharingDevice: sharingDevice.substring(0, 8) + '...'
-      });
-      
-      log('📤 SENDING share-request TO SHARING DEVICE', {
-        to: sharingDevice.substring(0, 8) + '...',
-        from: socket.id.substring(0, 8) + '...'
-      });
+      sharers.countRequest(sharingDevice);
       
       // Send request to the sharing device
-      io.to(sharingDevice).emit('share-request', { from: socket.id });
-    } else {
-      log('❌ NO SHARING DEVICE AVAILABLE', {
-        requester: socket.id.substring(0, 8) + '...',
-        totalDevices: Object.keys(devices).length,
-        message: 'No devices are currently ready to share (excluding requester)'
+      emitToDevice(sharingDevice, 'share-request', {
+        from: socket.id,
+        ...(traceId && { traceId })
       });
+    } else {
       // Optionally notify requester so they can provide UI feedback
       io.to(socket.id).emit('no-sharer-available', {
         message: 'No other device is ready to share right now.'
       });
     }
+    if (traceId) tracer.record('server.request-share', traceId, started);
   });
 
+  // One { to, signal }, or an array of them sent together, e.g. a batch of
+  // ICE candidates; each is forwarded as its own webrtc-signal.
   socket.on('webrtc-signal', (data) => {
-    log('🔄 WEBRTC SIGNAL RECEIVED', {
-      from: socket.id.substring(0, 8) + '...',
-      to: data.to ? data.to.substring(0, 8) + '...' : 'undefined',
-      signalType: data.signal ? data.signal.type : 'unknown',
-      hasCandidate: data.signal && data.signal.candidate ? 'yes' : 'no'
-    });
-    
-    if (!data.to) {
-      log('❌ ERROR: No recipient specified for WebRTC signal', {
-        from: socket.id.substring(0, 8) + '...',
-        signal: data.signal
-      });
-      return;
+    const started = process.hrtime.bigint();
+    const signals = Array.isArray(data) ? data : [data];
+    const group = devices[socket.id] ? devices[socket.id].group : null;
+    for (const item of signals) {
+      if (!item || typeof item.to !== 'string') {
+        logger.warn('webrtc-signal-unaddressed', {
+          from: socket.id.substring(0, 8) + '...'
+        });
+        continue;
+      }
+      // Groups are isolated by more than the secrecy of socket ids.
+      const recipient = devices[item.to];
+      if (group === null || !recipient || recipient.group !== group) {
+        signalsDropped.inc();
+        continue;
+      }
+      emitToDevice(item.to, 'webrtc-signal', { from: socket.id, signal: item.signal });
+      const traceId = tracing.traceIdOf(item.signal && item.signal.traceId);
+      if (traceId) tracer.record('server.webrtc-signal', traceId, started);
     }
-    
-    const recipientExists = devices[data.to];
-    log('📡 FORWARDING WEBRTC SIGNAL', {
+
+    logger.debug('webrtc-signal', () => ({
       from: socket.id.substring(0, 8) + '...',
-      to: data.to.substring(0, 8) + '...',
-      recipientExists: !!recipientExists,
-      signalType: data.signal ? data.signal.type : 'unknown'
-    });
-    
-    io.to(data.to).emit('webrtc-signal', { from: socket.id, signal: data.signal });
+      to: signals.map(item => item && typeof item.to === 'string' ? item.to.substring(0, 8) + '...' : null),
+      signalTypes: signals.map(item => item && item.signal ? item.signal.type : 'unknown'),
+      candidates: signals.reduce((n, item) => n + candidateCount(item && item.signal), 0)
+    }));
+    signalForwardSeconds.observe(Number(process.hrtime.bigint() - started) / 1e9);
   });
 
   socket.on('disconnect', () => {
-    log('❌ CLIENT DISCONNECTED', {
+    eventCounters.get('disconnect').inc();
+    logger.info('disconnect', () => ({
       socketId: socket.id.substring(0, 8) + '...',
       wasRegistered: !!devices[socket.id],
       wasReadyToShare: devices[socket.id] ? devices[socket.id].readyToShare : false
-    });
-    
-    delete devices[socket.id];
-    
-    log('📢 BROADCASTING device-disconnected', {
-      disconnectedDevice: socket.id.substring(0, 8) + '...',
-      remainingDevices: Object.keys(devices).length
-    });
+    }));
     
-    io.emit('device-disconnected', { deviceId: socket.id });
-    
-    log('📊 UPDATED DEVICES STATE AFTER DISCONNECT', {
-      totalDevices: Object.keys(devices).length,
-      devices: Object.keys(devices).map(id => ({
-        id: id.substring(0, 8) + '...',
-        readyToShare: devices[id].readyToShare
-      }))
-    });
+    if (devices[socket.id]) {
+      leaveGroup(socket);
+    }
   });
 
   // Handle requests for connected devices list
   socket.on('get-devices', () => {
-    log('📋 GET-DEVICES REQUEST', {
-      requester: socket.id.substring(0, 8) + '...'
-    });
+    logger.debug('list-devices', () => ({
+      requester: socket.id.substring(0, 8) + '...',
+      alias: 'get-devices'
+    }));
     sendDevicesList(socket);
   });
 
   socket.on('list-devices', () => {
-    log('📋 LIST-DEVICES REQUEST', {
-      requester: socket.id.substring(0, 8) + '...'
-    });
+    logger.debug('list-devices', () => ({
+      requester: socket.id.substring(0, 8) + '...',
+      alias: 'list-devices'
+    }));
     sendDevicesList(socket);
   });
 
   socket.on('get-connected-devices', () => {
-    log('📋 GET-CONNECTED-DEVICES REQUEST', {
-      requester: socket.id.substring(0, 8) + '...'
-    });
+    logger.debug('list-devices', () => ({
+      requester: socket.id.substring(0, 8) + '...',
+      alias: 'get-connected-devices'
+    }));
     sendDevicesList(socket);
   });
 
   socket.on('devices', () => {
-    log('📋 DEVICES REQUEST', {
-      requester: socket.id.substring(0, 8) + '...'
-    });
+    logger.debug('list-devices', () => ({
+      requester: socket.id.substring(0, 8) + '...',
+      alias: 'devices'
+    }));
     sendDevicesList(socket);
   });
 
   socket.on('clients', () => {
-    log('📋 CLIENTS REQUEST', {
-      requester: socket.id.substring(0, 8) + '...'
-    });
+    logger.debug('list-devices', () => ({
+      requester: socket.id.substring(0, 8) + '...',
+      alias: 'clients'
+    }));
     sendDevicesList(socket);
   });
 
   socket.on('room-info', () => {
-    log('📋 ROOM-INFO REQUEST', {
-      requester: socket.id.substring(0, 8) + '...'
-    });
+    logger.debug('list-devices', () => ({
+      requester: socket.id.substring(0, 8) + '...',
+      alias: 'room-info'
+    }));
     sendDevicesList(socket);
   });
 
-  // Log any unhandled events
+  // Count every event by name, and log the ones nothing handles
   socket.onAny((eventName, ...args) => {
-    if (!['register', 'share-ready', 'request-share', 'webrtc-signal', 'disconnect', 
-          'get-devices', 'list-devices', 'get-connected-devices', 'devices', 'clients', 'room-info'].includes(eventName)) {
-      log('🔍 UNHANDLED EVENT', {
-        event: eventName,
+    const counter = eventCounters.get(eventName);
+    if (counter) {
+      counter.inc();
+    } else {
+      otherEvents.inc();
+      // Names and sizes only: raw arguments can be large, and are the
+      // client's to log.
+      logger.debug('unhandled-event', () => ({
+        name: eventName,
         from: socket.id.substring(0, 8) + '...',
-        args: args
-      });
+        args: args.length
+      }));
     }
   });
 });
 
 const PORT = process.env.PORT || 3000;
 server.listen(PORT, () => {
-  log('=== SERVER STARTED SUCCESSFULLY ===');
-  log('Server configuration:', {
+  logger.info('server-started', {
     port: PORT,
     environment: process.env.NODE_ENV || 'development',
-    corsOrigin: '*'
+    corsOrigin: '*',
+    sharerPolicy: SHARER_POLICY,
+    node: NODE_ID,
+    hub: process.env.SIGNALING_HUB || null
   });
-  log('Waiting for client connections...');
+  bus.connect();
 });
 
-// Add periodic status logging
+// Add periodic status logging: counts only, as listing every device costs
+// in proportion to the fleet
 setInterval(() => {
-  if (Object.keys(devices).length > 0) {
-    log('📊 PERIODIC STATUS CHECK', {
-      totalConnectedDevices: Object.keys(devices).length,
-      devicesReadyToShare: Object.keys(devices).filter(id => devices[id].readyToShare).length,
-      devices: Object.keys(devices).map(id => ({
-        id: id.substring(0, 8) + '...',
-        readyToShare: devices[id].readyToShare
-      }))
+  if (deviceCount > 0) {
+    logger.info('status', {
+      totalConnectedDevices: deviceCount,
+      devicesReadyToShare: readyCount,
+      groups: groupCount
     });
   }
 }, 30000); // Log every 30 seconds if there are connected devices
@@ -0,0 +1,156 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { MemoryHub, TcpBus, replicate } = require('../cluster');
+const { startHub } = require('../hub');
+
+// A node's device registry, reduced to what replication touches: device
+// ids with their node, group and ready state, and the events emitted to
+// sockets on the node.
+function startNode(bus) {
+  const devices = new Map();
+  const emitted = [];
+  const registry = {
+    localDevices: () => Array.from(devices)
+      .filter(([, device]) => device.node === bus.nodeId)
+      .map(([id, device]) => ({ id: id, group: device.group, readyToShare: device.readyToShare })),
+    nodeOf: (id) => devices.has(id) ? devices.get(id).node : undefined,
+    put: (device, node) => {
+      devices.set(device.id, { node: node, group: device.group, readyToShare: !!device.readyToShare });
+    },
+    setReady: (id, ready) => { devices.get(id).readyToShare = ready; },
+    remove: (id) => { devices.delete(id); },
+    dropNode: (node) => {
+      for (const [id, device] of devices) {
+        if (node === null ? device.node !== bus.nodeId : device.node === node) devices.delete(id);
+      }
+    },
+    emitLocal: (to, event, payload) => { emitted.push({ to: to, event: event, payload: payload }); }
+  };
+  const replica = replicate(bus, registry);
+  return {
+    bus: bus,
+    devices: devices,
+    emitted: emitted,
+    replica: replica,
+    // Registers a device whose socket is on this node.
+    register(id, group = '') {
+      devices.set(id, { node: bus.nodeId, group: group, readyToShare: false });
+      replica.put({ id: id, group: group, readyToShare: false });
+    }
+  };
+}
+
+// Resolves once `done()` holds, polling as delivery is asynchronous.
+async function until(done, timeoutMs = 2000) {
+  const deadline = Date.now() + timeoutMs;
+  while (!done()) {
+    if (Date.now() > deadline) throw new Error('timed out');
+    await new Promise((resolve) => setTimeout(resolve, 5));
+  }
+}
+
+test('a joining node and the cluster learn each other\'s devices', async () => {
+  const hub = new MemoryHub();
+  const a = startNode(hub.bus('a').connect());
+  a.register('a1', 'team');
+  a.register('a2');
+  a.devices.get('a2').readyToShare = true;
+
+  const b = startNode(hub.bus('b').connect());
+  b.register('b1', 'team');
+
+  await until(() => b.devices.size === 3 && a.devices.size === 3);
+  assert.deepEqual(b.devices.get('a1'), { node: 'a', group: 'team', readyToShare: false });
+  assert.deepEqual(b.devices.get('a2'), { node: 'a', group: '', readyToShare: true });
+  assert.deepEqual(a.devices.get('b1'), { node: 'b', group: 'team', readyToShare: false });
+});
+
+test('ready changes and removals follow the owning node', async () => {
+  const hub = new MemoryHub();
+  const a = startNode(hub.bus('a').connect());
+  const b = startNode(hub.bus('b').connect());
+  a.register('a1');
+  await until(() => b.devices.has('a1'));
+
+  a.replica.ready('a1', true);
+  await until(() => b.devices.get('a1').readyToShare);
+
+  // Only the node a device is on may change it.
+  b.replica.remove('a1');
+  a.replica.remove('a1');
+  await until(() => !b.devices.has('a1'));
+  assert.ok(a.devices.has('a1'));
+});
+
+test('webrtc-signal reaches a device on another node', async () => {
+  const hub = new MemoryHub();
+  const a = startNode(hub.bus('a').connect());
+  const b = startNode(hub.bus('b').connect());
+  a.register('a1');
+  await until(() => b.devices.has('a1'));
+
+  const signal = { from: 'b1', signal: { type: 'offer', sdp: 'v=0' } };
+  assert.equal(b.replica.emit('a1', 'webrtc-signal', signal), true);
+  await until(() => a.emitted.length === 1);
+  assert.deepEqual(a.emitted[0], { to: 'a1', event: 'webrtc-signal', payload: signal });
+  assert.deepEqual(b.emitted, []);
+
+  // A device on the same node, or one no node reported, is emitted to here.
+  assert.equal(a.replica.emit('a1', 'webrtc-signal', signal), false);
+  assert.equal(a.emitted.length, 2);
+});
+
+test('a node that leaves takes its devices with it', async () => {
+  const hub = new MemoryHub();
+  const a = startNode(hub.bus('a').connect());
+  const b = startNode(hub.bus('b').connect());
+  a.register('a1');
+  b.register('b1');
+  await until(() => b.devices.has('a1') && a.devices.has('b1'));
+
+  a.bus.close();
+  await until(() => !b.devices.has('a1'));
+  assert.deepEqual(Array.from(b.devices.keys()), ['b1']);
+});
+
+test('nodes sync, signal and leave through the hub', async (t) => {
+  const hub = await new Promise((resolve) => {
+    const server = startHub(0, '127.0.0.1', 'hub secret', () => resolve(server));
+  });
+  t.after(() => hub.close());
+  const port = hub.address().port;
+
+  const a = startNode(new TcpBus('127.0.0.1', port, 'hub secret', 'a').connect());
+  await until(() => a.bus.connected);
+  a.register('a1');
+  const b = startNode(new TcpBus('127.0.0.1', port, 'hub secret', 'b').connect());
+  b.register('b1');
+  await until(() => b.devices.has('a1') && a.devices.has('b1'));
+
+  b.replica.emit('a1', 'webrtc-signal', { from: 'b1', signal: { type: 'answer' } });
+  await until(() => a.emitted.length === 1);
+  assert.equal(a.emitted[0].payload.signal.type, 'answer');
+
+  a.bus.close();
+  await until(() => !b.devices.has('a1'));
+  b.bus.close();
+});
+
+test('the hub refuses nodes without its secret', async (t) => {
+  const hub = await new Promise((resolve) => {
+    const server = startHub(0, '127.0.0.1', 'hub secret', () => resolve(server));
+  });
+  t.after(() => hub.close());
+  const port = hub.address().port;
+
+  const a = startNode(new TcpBus('127.0.0.1', port, 'hub secret', 'a').connect());
+  await until(() => a.bus.connected);
+  a.register('a1');
+  // The hub hangs up on a wrong secret; the bus would retry.
+  const intruder = new TcpBus('127.0.0.1', port, 'guess', 'x').connect();
+  await until(() => intruder.socket === null);
+  intruder.close();
+  assert.equal(intruder.connected, false);
+  assert.throws(() => startHub(0, '127.0.0.1', ''));
+  a.bus.close();
+});
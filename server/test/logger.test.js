@@ -0,0 +1,40 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { spawn } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+// Logs `count` records from a child process, then has it stopped by
+// `signal` while they may still be queued; resolves with the log file.
+function logThenStop(signal, count) {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'logger-test-'));
+  const file = path.join(dir, 'server.log');
+  const script = `
+    const logger = require(${JSON.stringify(path.join(__dirname, '..', 'logger'))}).fromEnv();
+    for (let i = 0; i < ${count}; i++) logger.info('record', { i: i });
+    process.kill(process.pid, ${JSON.stringify(signal)});
+    setTimeout(() => {}, 10000);
+  `;
+  return new Promise((resolve, reject) => {
+    const child = spawn(process.execPath, ['-e', script], {
+      env: Object.assign({}, process.env, { LOG_FILE: file, LOG_LEVEL: 'info' }),
+      stdio: 'inherit'
+    });
+    child.on('error', reject);
+    child.on('exit', (code) => {
+      const lines = fs.readFileSync(file, 'utf8').split('\n').filter(line => line.length > 0);
+      fs.rmSync(dir, { recursive: true, force: true });
+      resolve({ code: code, lines: lines });
+    });
+  });
+}
+
+for (const [signal, code] of [['SIGTERM', 143], ['SIGINT', 130]]) {
+  test(`records queued at ${signal} are written, in order`, async () => {
+    const result = await logThenStop(signal, 5000);
+    assert.equal(result.code, code);
+    assert.equal(result.lines.length, 5000);
+    result.lines.forEach((line, i) => assert.equal(JSON.parse(line).i, i));
+  });
+}
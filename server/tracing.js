@@ -0,0 +1,66 @@
+// Spans of server work for one share, in the Chrome trace event format.
+//
+// The requesting client picks a trace id for each share and sends it with
+// request-share; spans recorded under it here line up with the clients'
+// (lib/core/tracing.dart) by args.trace once the exports are merged. Spans
+// are timed on the monotonic clock, timestamped on the wall clock, and kept
+// in a fixed ring that drops the oldest, so tracing never grows.
+//
+//   const tracer = new Tracer();
+//   const started = tracer.now();
+//   ...
+//   tracer.record('server.request-share', traceId, started);
+//   res.json(tracer.chromeTrace());
+
+const DEFAULT_CAPACITY = 4096;
+
+// Trace ids are 16 hex digits; anything else is not traced.
+const TRACE_ID = /^[0-9a-f]{16}$/;
+
+function traceIdOf(value) {
+  return typeof value === 'string' && TRACE_ID.test(value) ? value : null;
+}
+
+class Tracer {
+  constructor(capacity = DEFAULT_CAPACITY) {
+    this.capacity = Math.max(1, capacity);
+    this.spans = new Array(this.capacity);
+    this.next = 0;
+    // Wall clock minus the monotonic clock, in nanoseconds
+    this.wallOffset = BigInt(Date.now()) * 1000000n - process.hrtime.bigint();
+  }
+
+  // Nanoseconds on the monotonic clock spans are timed with.
+  now() {
+    return process.hrtime.bigint();
+  }
+
+  // Records `name` from `start` to `end` (now if omitted), both from now(),
+  // as part of trace `traceId`, or of none if null.
+  record(name, traceId, start, end = process.hrtime.bigint()) {
+    this.spans[this.next % this.capacity] = { name, traceId, start, end: end > start ? end : start };
+    this.next++;
+  }
+
+  // {"traceEvents":[...]} for every span held, oldest first.
+  chromeTrace(pid = process.pid) {
+    const begin = Math.max(0, this.next - this.capacity);
+    const traceEvents = [];
+    for (let i = begin; i < this.next; i++) {
+      const span = this.spans[i % this.capacity];
+      const event = {
+        name: span.name,
+        ph: 'X',
+        ts: Number(span.start + this.wallOffset) / 1000,
+        dur: Number(span.end - span.start) / 1000,
+        pid,
+        tid: 0
+      };
+      if (span.traceId) event.args = { trace: span.traceId };
+      traceEvents.push(event);
+    }
+    return { traceEvents, displayTimeUnit: 'ms' };
+  }
+}
+
+module.exports = { Tracer, traceIdOf, DEFAULT_CAPACITY };